@@ -0,0 +1,60 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+
+#include "../test/common.h"
+
+namespace benchmark {
+
+/**
+ * Generates deterministic model and motion data for benchmarks.
+ *
+ * Every value is derived from object indices only, so the same description always produces byte-identical data
+ * and results of each benchmark can be compared between commits.
+ */
+class Fixture {
+public:
+    struct ModelDescription {
+        ModelDescription();
+        nanoem_rsize_t m_numBones;
+        nanoem_rsize_t m_numBonesPerChain;
+        nanoem_rsize_t m_numVertices;
+        nanoem_rsize_t m_numMaterials;
+        nanoem_rsize_t m_numRigidBodies;
+        nanoem_rsize_t m_numConstraints;
+    };
+    struct MotionDescription {
+        MotionDescription();
+        nanoem_frame_index_t m_duration;
+        nanoem_frame_index_t m_interval;
+    };
+
+    static const ModelDescription kLargeModel;
+    static const ModelDescription kSmallModel;
+    static const MotionDescription kDenseMotion;
+    static const MotionDescription kLongMotion;
+
+    static void generateModel(
+        nanoem_unicode_string_factory_t *factory, const ModelDescription &desc, nanoem::ByteArray &bytes);
+    static void generateMotion(nanoem_unicode_string_factory_t *factory, const ModelDescription &modelDesc,
+        const MotionDescription &motionDesc, nanoem::ByteArray &bytes);
+    static nanoem::Model *createModel(nanoem::Project *project, const nanoem::ByteArray &bytes);
+    static nanoem::Motion *createModelMotion(
+        nanoem::Project *project, nanoem::Model *model, const nanoem::ByteArray &bytes);
+    static void readFile(const char *filename, nanoem::ByteArray &bytes);
+    static nanoem::String temporaryFilePath(const char *filename);
+
+    /**
+     * Returns the resident memory size of the current process in bytes, or zero if it is not available.
+     *
+     * Catch2 measures only time, so benchmarks report the returned size with WARN to record it in the report.
+     */
+    static nanoem_rsize_t residentMemorySize();
+    static void reportResidentMemorySize(const char *name, nanoem_rsize_t baseSize);
+};
+
+} /* namespace benchmark */
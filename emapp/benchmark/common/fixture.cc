@@ -0,0 +1,393 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/FileUtils.h"
+#include "emapp/Model.h"
+#include "emapp/Motion.h"
+#include "emapp/StringUtils.h"
+#include "emapp/private/CommonInclude.h"
+
+#include "bx/filepath.h"
+#include "glm/gtc/quaternion.hpp"
+
+#if BX_PLATFORM_WINDOWS
+#include <windows.h>
+#include <psapi.h>
+#elif BX_PLATFORM_OSX || BX_PLATFORM_IOS
+#include <mach/mach.h>
+#elif BX_PLATFORM_LINUX
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+using namespace nanoem;
+
+namespace benchmark {
+namespace {
+
+static const nanoem_rsize_t kMaxNumConstraintJoints = 4;
+
+static void
+setBoneName(nanoem_rsize_t index, StringUtils::UnicodeStringScope &scope, nanoem_unicode_string_factory_t *factory)
+{
+    char name[32];
+    StringUtils::format(name, sizeof(name), "bone_%04d", Inline::saturateInt32(index));
+    StringUtils::tryGetString(factory, name, scope);
+}
+
+static Vector3
+boneOrigin(nanoem_rsize_t index, const Fixture::ModelDescription &desc)
+{
+    const nanoem_rsize_t chain = index / desc.m_numBonesPerChain, offset = index % desc.m_numBonesPerChain;
+    const nanoem_f32_t angle = chain * 0.7f;
+    return Vector3(glm::cos(angle) * 4.0f, offset * 1.0f, glm::sin(angle) * 4.0f);
+}
+
+static Fixture::ModelDescription
+createLargeModelDescription()
+{
+    Fixture::ModelDescription desc;
+    desc.m_numBones = 512;
+    desc.m_numBonesPerChain = 16;
+    desc.m_numVertices = 200000;
+    desc.m_numMaterials = 64;
+    desc.m_numRigidBodies = 128;
+    desc.m_numConstraints = 8;
+    return desc;
+}
+
+static Fixture::ModelDescription
+createSmallModelDescription()
+{
+    Fixture::ModelDescription desc;
+    desc.m_numBones = 128;
+    desc.m_numBonesPerChain = 8;
+    desc.m_numVertices = 20000;
+    desc.m_numMaterials = 16;
+    desc.m_numRigidBodies = 32;
+    desc.m_numConstraints = 4;
+    return desc;
+}
+
+static Fixture::MotionDescription
+createDenseMotionDescription()
+{
+    Fixture::MotionDescription desc;
+    desc.m_duration = 3600;
+    desc.m_interval = 2;
+    return desc;
+}
+
+static Fixture::MotionDescription
+createLongMotionDescription()
+{
+    Fixture::MotionDescription desc;
+    desc.m_duration = 10000;
+    desc.m_interval = 20;
+    return desc;
+}
+
+} /* namespace anonymous */
+
+Fixture::ModelDescription::ModelDescription()
+    : m_numBones(0)
+    , m_numBonesPerChain(1)
+    , m_numVertices(0)
+    , m_numMaterials(1)
+    , m_numRigidBodies(0)
+    , m_numConstraints(0)
+{
+}
+
+Fixture::MotionDescription::MotionDescription()
+    : m_duration(0)
+    , m_interval(1)
+{
+}
+
+const Fixture::ModelDescription Fixture::kLargeModel = createLargeModelDescription();
+const Fixture::ModelDescription Fixture::kSmallModel = createSmallModelDescription();
+const Fixture::MotionDescription Fixture::kDenseMotion = createDenseMotionDescription();
+const Fixture::MotionDescription Fixture::kLongMotion = createLongMotionDescription();
+
+void
+Fixture::generateModel(nanoem_unicode_string_factory_t *factory, const ModelDescription &desc, ByteArray &bytes)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_buffer_t *mutableBuffer = nanoemMutableBufferCreate(&status);
+    nanoem_mutable_model_t *mutableModel = nanoemMutableModelCreate(factory, &status);
+    nanoem_model_t *originModel = nanoemMutableModelGetOriginObject(mutableModel);
+    StringUtils::UnicodeStringScope scope(factory);
+    nanoemMutableModelSetCodecType(mutableModel, NANOEM_CODEC_TYPE_UTF16);
+    nanoemMutableModelSetFormatType(mutableModel, NANOEM_MODEL_FORMAT_TYPE_PMX_2_0);
+    if (StringUtils::tryGetString(factory, "benchmark", scope)) {
+        nanoemMutableModelSetName(mutableModel, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+    }
+    tinystl::vector<const nanoem_model_bone_t *, TinySTLAllocator> bones(desc.m_numBones);
+    for (nanoem_rsize_t i = 0; i < desc.m_numBones; i++) {
+        nanoem_mutable_model_bone_t *mutableBone = nanoemMutableModelBoneCreate(originModel, &status);
+        setBoneName(i, scope, factory);
+        nanoemMutableModelBoneSetName(mutableBone, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+        if (i % desc.m_numBonesPerChain != 0) {
+            nanoemMutableModelBoneSetParentBoneObject(mutableBone, bones[i - 1]);
+        }
+        nanoemMutableModelBoneSetOrigin(mutableBone, glm::value_ptr(Vector4(boneOrigin(i, desc), 1)));
+        nanoemMutableModelBoneSetVisible(mutableBone, true);
+        nanoemMutableModelBoneSetMovable(mutableBone, true);
+        nanoemMutableModelBoneSetRotateable(mutableBone, true);
+        nanoemMutableModelBoneSetUserHandleable(mutableBone, true);
+        nanoemMutableModelInsertBoneObject(mutableModel, mutableBone, -1, &status);
+        bones[i] = nanoemMutableModelBoneGetOriginObject(mutableBone);
+        nanoemMutableModelBoneDestroy(mutableBone);
+    }
+    const nanoem_rsize_t numChains = desc.m_numBones / desc.m_numBonesPerChain,
+                         numConstraintJoints = glm::min(desc.m_numBonesPerChain - 1, kMaxNumConstraintJoints),
+                         numConstraints = numConstraintJoints > 0 ? glm::min(desc.m_numConstraints, numChains) : 0;
+    for (nanoem_rsize_t i = 0; i < numConstraints; i++) {
+        /* the tip of the chain reaches for the handle placed off the rest pose so every solve iterates */
+        const nanoem_rsize_t effectorIndex = (i * numChains / numConstraints + 1) * desc.m_numBonesPerChain - 1;
+        nanoem_mutable_model_bone_t *mutableBone = nanoemMutableModelBoneCreate(originModel, &status);
+        char name[32];
+        StringUtils::format(name, sizeof(name), "ik_%04d", Inline::saturateInt32(i));
+        StringUtils::tryGetString(factory, name, scope);
+        nanoemMutableModelBoneSetName(mutableBone, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+        nanoemMutableModelBoneSetOrigin(
+            mutableBone, glm::value_ptr(Vector4(boneOrigin(effectorIndex, desc) + Vector3(1, -2, 1), 1)));
+        nanoemMutableModelBoneSetVisible(mutableBone, true);
+        nanoemMutableModelBoneSetMovable(mutableBone, true);
+        nanoemMutableModelBoneSetRotateable(mutableBone, true);
+        nanoemMutableModelBoneSetUserHandleable(mutableBone, true);
+        nanoemMutableModelInsertBoneObject(mutableModel, mutableBone, -1, &status);
+        nanoem_mutable_model_constraint_t *mutableConstraint =
+            nanoemMutableModelConstraintCreate(originModel, &status);
+        nanoemMutableModelConstraintSetEffectorBoneObject(mutableConstraint, bones[effectorIndex]);
+        nanoemMutableModelConstraintSetTargetBoneObject(
+            mutableConstraint, nanoemMutableModelBoneGetOriginObject(mutableBone));
+        nanoemMutableModelConstraintSetAngleLimit(mutableConstraint, 0.5f);
+        nanoemMutableModelConstraintSetNumIterations(mutableConstraint, 40);
+        for (nanoem_rsize_t j = 1; j <= numConstraintJoints; j++) {
+            nanoem_mutable_model_constraint_joint_t *mutableJoint =
+                nanoemMutableModelConstraintJointCreate(mutableConstraint, &status);
+            nanoemMutableModelConstraintJointSetBoneObject(mutableJoint, bones[effectorIndex - j]);
+            nanoemMutableModelConstraintInsertJointObject(mutableConstraint, mutableJoint, -1, &status);
+            nanoemMutableModelConstraintJointDestroy(mutableJoint);
+        }
+        nanoemMutableModelBoneSetConstraintEnabled(mutableBone, true);
+        nanoemMutableModelBoneSetConstraintObject(mutableBone, mutableConstraint);
+        nanoemMutableModelConstraintDestroy(mutableConstraint);
+        nanoemMutableModelBoneDestroy(mutableBone);
+    }
+    for (nanoem_rsize_t i = 0; i < desc.m_numVertices; i++) {
+        nanoem_mutable_model_vertex_t *mutableVertex = nanoemMutableModelVertexCreate(originModel, &status);
+        const nanoem_rsize_t boneIndex = i % glm::max(desc.m_numBones, nanoem_rsize_t(1));
+        const nanoem_f32_t t = i / nanoem_f32_t(glm::max(desc.m_numVertices, nanoem_rsize_t(1)));
+        const Vector3 origin(boneOrigin(boneIndex, desc) + Vector3(glm::cos(i * 0.1f), t, glm::sin(i * 0.1f)));
+        nanoemMutableModelVertexSetOrigin(mutableVertex, glm::value_ptr(Vector4(origin, 1)));
+        nanoemMutableModelVertexSetNormal(mutableVertex, glm::value_ptr(Vector4(0, 1, 0, 0)));
+        nanoemMutableModelVertexSetTexCoord(mutableVertex, glm::value_ptr(Vector4(t, 1 - t, 0, 0)));
+        if (desc.m_numBones > 1 && (boneIndex + 1) % desc.m_numBonesPerChain != 0) {
+            nanoemMutableModelVertexSetType(mutableVertex, NANOEM_MODEL_VERTEX_TYPE_BDEF2);
+            nanoemMutableModelVertexSetBoneObject(mutableVertex, bones[boneIndex], 0);
+            nanoemMutableModelVertexSetBoneObject(mutableVertex, bones[boneIndex + 1], 1);
+            nanoemMutableModelVertexSetBoneWeight(mutableVertex, 1 - t, 0);
+            nanoemMutableModelVertexSetBoneWeight(mutableVertex, t, 1);
+        }
+        else if (desc.m_numBones > 0) {
+            nanoemMutableModelVertexSetType(mutableVertex, NANOEM_MODEL_VERTEX_TYPE_BDEF1);
+            nanoemMutableModelVertexSetBoneObject(mutableVertex, bones[boneIndex], 0);
+            nanoemMutableModelVertexSetBoneWeight(mutableVertex, 1, 0);
+        }
+        nanoemMutableModelInsertVertexObject(mutableModel, mutableVertex, -1, &status);
+        nanoemMutableModelVertexDestroy(mutableVertex);
+    }
+    const nanoem_rsize_t numTriangles = desc.m_numVertices > 2 ? desc.m_numVertices - 2 : 0,
+                         numMaterials = glm::max(desc.m_numMaterials, nanoem_rsize_t(1));
+    tinystl::vector<nanoem_u32_t, TinySTLAllocator> indices(numTriangles * 3);
+    for (nanoem_rsize_t i = 0; i < numTriangles; i++) {
+        indices[i * 3 + 0] = nanoem_u32_t(i);
+        indices[i * 3 + 1] = nanoem_u32_t(i + 1);
+        indices[i * 3 + 2] = nanoem_u32_t(i + 2);
+    }
+    nanoemMutableModelSetVertexIndices(mutableModel, indices.data(), indices.size(), &status);
+    for (nanoem_rsize_t i = 0; i < numMaterials; i++) {
+        nanoem_mutable_model_material_t *mutableMaterial = nanoemMutableModelMaterialCreate(originModel, &status);
+        const nanoem_rsize_t numMaterialTriangles =
+            numTriangles / numMaterials + (i == numMaterials - 1 ? numTriangles % numMaterials : 0);
+        const nanoem_f32_t hue = i / nanoem_f32_t(numMaterials);
+        nanoemMutableModelMaterialSetDiffuseColor(mutableMaterial, glm::value_ptr(Vector4(hue, 1 - hue, 0.5f, 0)));
+        nanoemMutableModelMaterialSetDiffuseOpacity(mutableMaterial, 1.0f);
+        nanoemMutableModelMaterialSetNumVertexIndices(mutableMaterial, numMaterialTriangles * 3);
+        nanoemMutableModelInsertMaterialObject(mutableModel, mutableMaterial, -1, &status);
+        nanoemMutableModelMaterialDestroy(mutableMaterial);
+    }
+    for (nanoem_rsize_t i = 0, numRigidBodies = glm::min(desc.m_numRigidBodies, desc.m_numBones); i < numRigidBodies;
+         i++) {
+        nanoem_mutable_model_rigid_body_t *mutableRigidBody =
+            nanoemMutableModelRigidBodyCreate(originModel, &status);
+        /* chain roots follow bones and their descendants are driven by simulation */
+        const nanoem_rsize_t boneIndex = i * desc.m_numBones / numRigidBodies;
+        setBoneName(boneIndex, scope, factory);
+        nanoemMutableModelRigidBodySetName(mutableRigidBody, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+        nanoemMutableModelRigidBodySetBoneObject(mutableRigidBody, bones[boneIndex]);
+        nanoemMutableModelRigidBodySetOrigin(
+            mutableRigidBody, glm::value_ptr(Vector4(boneOrigin(boneIndex, desc), 1)));
+        nanoemMutableModelRigidBodySetShapeType(mutableRigidBody, NANOEM_MODEL_RIGID_BODY_SHAPE_TYPE_SPHERE);
+        nanoemMutableModelRigidBodySetShapeSize(mutableRigidBody, glm::value_ptr(Vector4(0.5f, 0.5f, 0.5f, 0)));
+        nanoemMutableModelRigidBodySetMass(mutableRigidBody, 1.0f);
+        nanoemMutableModelRigidBodySetTransformType(mutableRigidBody,
+            boneIndex % desc.m_numBonesPerChain == 0 ? NANOEM_MODEL_RIGID_BODY_TRANSFORM_TYPE_FROM_BONE_TO_SIMULATION
+                                                     : NANOEM_MODEL_RIGID_BODY_TRANSFORM_TYPE_FROM_SIMULATION_TO_BONE);
+        nanoemMutableModelRigidBodySetCollisionGroupId(mutableRigidBody, int(i % 16));
+        nanoemMutableModelRigidBodySetCollisionMask(mutableRigidBody, 0xffff);
+        nanoemMutableModelInsertRigidBodyObject(mutableModel, mutableRigidBody, -1, &status);
+        nanoemMutableModelRigidBodyDestroy(mutableRigidBody);
+    }
+    nanoemMutableModelSaveToBuffer(mutableModel, mutableBuffer, &status);
+    nanoem_buffer_t *buffer = nanoemMutableBufferCreateBufferObject(mutableBuffer, &status);
+    const nanoem_u8_t *dataPtr = nanoemBufferGetDataPtr(buffer);
+    bytes.assign(dataPtr, dataPtr + nanoemBufferGetLength(buffer));
+    nanoemBufferDestroy(buffer);
+    nanoemMutableModelDestroy(mutableModel);
+    nanoemMutableBufferDestroy(mutableBuffer);
+}
+
+void
+Fixture::generateMotion(nanoem_unicode_string_factory_t *factory, const ModelDescription &modelDesc,
+    const MotionDescription &motionDesc, ByteArray &bytes)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_buffer_t *mutableBuffer = nanoemMutableBufferCreate(&status);
+    nanoem_mutable_motion_t *mutableMotion = nanoemMutableMotionCreate(factory, &status);
+    nanoem_motion_t *originMotion = nanoemMutableMotionGetOriginObject(mutableMotion);
+    StringUtils::UnicodeStringScope scope(factory);
+    if (StringUtils::tryGetString(factory, "benchmark", scope)) {
+        nanoemMutableMotionSetTargetModelName(mutableMotion, scope.value(), &status);
+    }
+    const nanoem_frame_index_t interval = glm::max(motionDesc.m_interval, nanoem_frame_index_t(1));
+    for (nanoem_rsize_t i = 0; i < modelDesc.m_numBones; i++) {
+        setBoneName(i, scope, factory);
+        for (nanoem_frame_index_t frameIndex = 0; frameIndex <= motionDesc.m_duration; frameIndex += interval) {
+            nanoem_mutable_motion_bone_keyframe_t *mutableKeyframe =
+                nanoemMutableMotionBoneKeyframeCreate(originMotion, &status);
+            const nanoem_f32_t phase = frameIndex * 0.05f + i * 0.3f;
+            const Quaternion orientation(glm::angleAxis(glm::sin(phase) * 0.5f, glm::normalize(Vector3(1, i % 3, 1))));
+            nanoemMutableMotionBoneKeyframeSetTranslation(
+                mutableKeyframe, glm::value_ptr(Vector4(glm::sin(phase), 0, glm::cos(phase), 0)));
+            nanoemMutableMotionBoneKeyframeSetOrientation(mutableKeyframe, glm::value_ptr(orientation));
+            nanoemMutableMotionAddBoneKeyframe(mutableMotion, mutableKeyframe, scope.value(), frameIndex, &status);
+            nanoemMutableMotionBoneKeyframeDestroy(mutableKeyframe);
+        }
+    }
+    nanoemMutableMotionSortAllKeyframes(mutableMotion);
+    nanoemMutableMotionSaveToBuffer(mutableMotion, mutableBuffer, &status);
+    nanoem_buffer_t *buffer = nanoemMutableBufferCreateBufferObject(mutableBuffer, &status);
+    const nanoem_u8_t *dataPtr = nanoemBufferGetDataPtr(buffer);
+    bytes.assign(dataPtr, dataPtr + nanoemBufferGetLength(buffer));
+    nanoemBufferDestroy(buffer);
+    nanoemMutableMotionDestroy(mutableMotion);
+    nanoemMutableBufferDestroy(mutableBuffer);
+}
+
+Model *
+Fixture::createModel(Project *project, const ByteArray &bytes)
+{
+    Model *model = project->createModel();
+    Error error;
+    if (model->load(bytes, error)) {
+        model->setupAllBindings();
+        model->upload();
+        model->setVisible(true);
+    }
+    else {
+        WARN(error.reasonConstString());
+        project->destroyModel(model);
+        model = nullptr;
+    }
+    return model;
+}
+
+Motion *
+Fixture::createModelMotion(Project *project, Model *model, const ByteArray &bytes)
+{
+    Motion *motion = project->createMotion();
+    Error error;
+    motion->setFormat(NANOEM_MOTION_FORMAT_TYPE_VMD);
+    if (motion->load(bytes, 0, error)) {
+        if (Motion *lastMotion = project->addModelMotion(motion, model)) {
+            project->destroyMotion(lastMotion);
+        }
+    }
+    else {
+        WARN(error.reasonConstString());
+        project->destroyMotion(motion);
+        motion = nullptr;
+    }
+    return motion;
+}
+
+void
+Fixture::readFile(const char *filename, ByteArray &bytes)
+{
+    String path(NANOEM_TEST_FIXTURE_PATH);
+    path.append("/");
+    path.append(filename);
+    FileReaderScope scope(nullptr);
+    Error error;
+    if (scope.open(URI::createFromFilePath(path), error)) {
+        FileUtils::read(scope, bytes, error);
+    }
+}
+
+String
+Fixture::temporaryFilePath(const char *filename)
+{
+    bx::FilePath path(bx::Dir::Temp);
+    path.join(filename);
+    return String(path.getCPtr());
+}
+
+nanoem_rsize_t
+Fixture::residentMemorySize()
+{
+    nanoem_rsize_t size = 0;
+#if BX_PLATFORM_WINDOWS
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        size = counters.WorkingSetSize;
+    }
+#elif BX_PLATFORM_OSX || BX_PLATFORM_IOS
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) ==
+        KERN_SUCCESS) {
+        size = info.resident_size;
+    }
+#elif BX_PLATFORM_LINUX
+    if (FILE *fp = fopen("/proc/self/statm", "r")) {
+        unsigned long numTotalPages, numResidentPages;
+        if (fscanf(fp, "%lu %lu", &numTotalPages, &numResidentPages) == 2) {
+            size = nanoem_rsize_t(numResidentPages) * sysconf(_SC_PAGESIZE);
+        }
+        fclose(fp);
+    }
+#endif
+    return size;
+}
+
+void
+Fixture::reportResidentMemorySize(const char *name, nanoem_rsize_t baseSize)
+{
+    const nanoem_rsize_t size = residentMemorySize();
+    const nanoem_f64_t scale = 1.0 / (1024 * 1024);
+    const nanoem_f64_t delta = size >= baseSize ? (size - baseSize) * scale : -nanoem_f64_t(baseSize - size) * scale;
+    String message;
+    StringUtils::format(message, "%s: resident %.2f MiB (%+.2f MiB)", name, size * scale, delta);
+    WARN(message.c_str());
+}
+
+} /* namespace benchmark */
@@ -0,0 +1,235 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Constants.h"
+#include "emapp/Effect.h"
+#include "emapp/Model.h"
+#include "emapp/Progress.h"
+#include "emapp/StringUtils.h"
+#include "emapp/effect/GlobalUniform.h"
+#include "emapp/effect/Pass.h"
+#include "emapp/effect/Technique.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+typedef tinystl::vector<nanoem_u32_t, TinySTLAllocator> SlotIndexList;
+
+static IPass *
+executeFirstPass(ProjectPtr &o, Model *model, const char *filename, Effect *&effect)
+{
+    Project *project = o->m_project;
+    effect = o->createSourceEffect(model, filename, true);
+    REQUIRE(effect);
+    Progress progress(project, 0);
+    Error error;
+    effect->upload(effect::kAttachmentTypeNone, progress, error);
+    nanoem_rsize_t numMaterials;
+    nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(model->data(), &numMaterials);
+    ITechnique *technique = effect->findTechnique(Effect::kPassTypeObject, materials[0], 0, numMaterials, model);
+    REQUIRE(technique);
+    IPass *pass = technique->execute(model, false);
+    REQUIRE(pass);
+    return pass;
+}
+
+static void
+setAllParameters(Project *project, Model *model, const nanoem_model_material_t *materialPtr, IPass *pass)
+{
+    pass->setGlobalParameters(model, project);
+    pass->setCameraParameters(project->globalCamera(), Constants::kIdentity);
+    pass->setLightParameters(project->globalLight(), false);
+    pass->setAllModelParameters(model, project);
+    pass->setMaterialParameters(materialPtr);
+    pass->setShadowMapParameters(project->shadowCamera(), Constants::kIdentity);
+}
+
+static void
+fillBuffer(nanoem_f32_t seed, effect::GlobalUniform::Buffer &buffer)
+{
+    buffer.m_float4.resize(effect::GlobalUniform::kMaxVertexShaderUniformVectorsFloat);
+    for (nanoem_rsize_t i = 0, numVectors = buffer.m_float4.size(); i < numVectors; i++) {
+        const nanoem_f32_t value = seed + i * 0.25f;
+        buffer.m_float4[i] = Vector4(value, value + 0.5f, value + 1.0f, value + 1.5f);
+    }
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("benchmark_effect_uniform_slots", "[emapp][benchmark][effect]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    Model *model = o->createModel();
+    project->addModel(model);
+    Effect *effect = nullptr;
+    IPass *pass = executeFirstPass(o, model, "effects/parameters/camera/matrix.fx", effect);
+    const effect::Pass *passPtr = static_cast<const effect::Pass *>(pass);
+    nanoem_rsize_t numMaterials;
+    nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(model->data(), &numMaterials);
+    setAllParameters(project, model, materials[0], pass);
+    Effect::PassUniformBufferMap passUniformBuffer;
+    effect->getPassUniformBuffer(passUniformBuffer);
+    const Effect::NamedByteArrayMap &uniformBuffer = passUniformBuffer[passPtr->name()];
+    StringList names;
+    SlotIndexList slotIndices;
+    for (Effect::NamedByteArrayMap::const_iterator it = uniformBuffer.begin(), end = uniformBuffer.end(); it != end;
+         ++it) {
+        names.push_back(it->first);
+        slotIndices.push_back(effect->resolveUniformSlotIndex(it->first));
+    }
+    REQUIRE_FALSE(names.empty());
+    /* each parameter was looked up in four register maps by name before resolving slots of the pass */
+    BENCHMARK("effect::Pass::find*RegisterIndex")
+    {
+        int numFound = 0;
+        for (StringList::const_iterator it = names.begin(), end = names.end(); it != end; ++it) {
+            effect::RegisterIndex index;
+            numFound += passPtr->findVertexPreshaderRegisterIndex(*it, index);
+            numFound += passPtr->findPixelPreshaderRegisterIndex(*it, index);
+            numFound += passPtr->findVertexShaderRegisterIndex(*it, index);
+            numFound += passPtr->findPixelShaderRegisterIndex(*it, index);
+        }
+        return numFound;
+    };
+    BENCHMARK("effect::Pass::findUniformSlot")
+    {
+        int numFound = 0;
+        for (SlotIndexList::const_iterator it = slotIndices.begin(), end = slotIndices.end(); it != end; ++it) {
+            numFound += passPtr->findUniformSlot(*it) != nullptr;
+        }
+        return numFound;
+    };
+    effect::GlobalUniform *uniform = effect->globalUniform();
+    BENCHMARK("IPass::set*Parameters")
+    {
+        uniform->invalidateAll();
+        setAllParameters(project, model, materials[0], pass);
+        return uniform->m_numWrittenBytes;
+    };
+}
+
+TEST_CASE("benchmark_effect_parameter_blocks", "[emapp][benchmark][effect]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    ByteArray bytes;
+    benchmark::Fixture::generateModel(project->unicodeStringFactory(), benchmark::Fixture::kSmallModel, bytes);
+    Model *model = benchmark::Fixture::createModel(project, bytes);
+    REQUIRE(model);
+    project->addModel(model);
+    Effect *effect = nullptr;
+    IPass *pass = executeFirstPass(o, model, "effects/parameters/camera/matrix.fx", effect);
+    effect::GlobalUniform *uniform = effect->globalUniform();
+    nanoem_rsize_t numMaterials;
+    nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(model->data(), &numMaterials);
+    REQUIRE(numMaterials == benchmark::Fixture::kSmallModel.m_numMaterials);
+    /* all blocks are written for every material as they were before retaining them */
+    BENCHMARK("IPass::set*Parameters(all materials, invalidated)")
+    {
+        for (nanoem_rsize_t i = 0; i < numMaterials; i++) {
+            uniform->invalidateAll();
+            setAllParameters(project, model, materials[i], pass);
+        }
+        return uniform->m_numWrittenBytes;
+    };
+    BENCHMARK("IPass::set*Parameters(all materials, retained)")
+    {
+        uniform->endFrame();
+        for (nanoem_rsize_t i = 0; i < numMaterials; i++) {
+            setAllParameters(project, model, materials[i], pass);
+        }
+        return uniform->m_numWrittenBytes;
+    };
+}
+
+TEST_CASE("benchmark_effect_preshader", "[emapp][benchmark][effect]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    Model *model = o->createModel();
+    project->addModel(model);
+    Effect *effect = nullptr;
+    IPass *pass = executeFirstPass(o, model, "effects/preshader.fx", effect);
+    const effect::PreshaderPair &pair = static_cast<const effect::Pass *>(pass)->preshaderPair();
+    CHECK_FALSE(pair.vertex.m_instructions.empty());
+    CHECK_FALSE(pair.pixel.m_instructions.empty());
+    effect::Preshader vertexPreshader(pair.vertex), pixelPreshader(pair.pixel);
+    vertexPreshader.compile();
+    pixelPreshader.compile();
+    effect::GlobalUniform::Buffer vertexInputs[] = { SG_SHADERSTAGE_VS, SG_SHADERSTAGE_VS },
+                                  pixelInputs[] = { SG_SHADERSTAGE_FS, SG_SHADERSTAGE_FS };
+    effect::GlobalUniform::Buffer vertexOutput(SG_SHADERSTAGE_VS), pixelOutput(SG_SHADERSTAGE_FS);
+    for (nanoem_rsize_t i = 0; i < BX_COUNTOF(vertexInputs); i++) {
+        fillBuffer(nanoem_f32_t(i), vertexInputs[i]);
+        fillBuffer(nanoem_f32_t(i), pixelInputs[i]);
+    }
+    fillBuffer(0, vertexOutput);
+    fillBuffer(0, pixelOutput);
+    /* the preshaders were interpreted with the same inputs for every draw before compiling and memoizing them */
+    BENCHMARK("effect::Preshader::interpret")
+    {
+        pair.vertex.interpret(vertexInputs[0], vertexOutput);
+        pair.pixel.interpret(pixelInputs[0], pixelOutput);
+    };
+    BENCHMARK("effect::Preshader::execute(same inputs)")
+    {
+        vertexPreshader.execute(vertexInputs[0], vertexOutput);
+        pixelPreshader.execute(pixelInputs[0], pixelOutput);
+    };
+    BENCHMARK_ADVANCED("effect::Preshader::execute(changed inputs)")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&](int i) {
+            vertexPreshader.execute(vertexInputs[i & 1], vertexOutput);
+            pixelPreshader.execute(pixelInputs[i & 1], pixelOutput);
+        });
+    };
+}
+
+TEST_CASE("benchmark_effect_control_objects", "[emapp][benchmark][effect]")
+{
+    static const int kNumModels = 16;
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    Model *owner = o->createModel();
+    project->addModel(owner);
+    /* CONTROLOBJECT parameters are resolved by filename among all models and the target is added at last */
+    for (int i = 0; i < kNumModels; i++) {
+        Model *model = o->createModel();
+        String path;
+        StringUtils::format(path, "/path/to/model_%02d.pmx", i);
+        model->setFileURI(URI::createFromFilePath(path));
+        project->addModel(model);
+    }
+    Model *target = o->createModel();
+    target->setFileURI(URI::createFromFilePath("/path/to/test.pmx"));
+    project->addModel(target);
+    Effect *effect = nullptr;
+    IPass *pass = executeFirstPass(o, owner, "effects/parameters/controlobjects/model.fx", effect);
+    effect::GlobalUniform *uniform = effect->globalUniform();
+    /* bindings were resolved by filename on every draw before caching them per object binding generation */
+    BENCHMARK("IPass::setAllModelParameters(invalidated)")
+    {
+        project->invalidateAllObjectBindings();
+        uniform->endFrame();
+        pass->setAllModelParameters(owner, project);
+        return uniform->m_numWrittenBytes;
+    };
+    BENCHMARK("IPass::setAllModelParameters(resolved)")
+    {
+        uniform->endFrame();
+        pass->setAllModelParameters(owner, project);
+        return uniform->m_numWrittenBytes;
+    };
+}
@@ -0,0 +1,366 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/BaseAudioPlayer.h"
+#include "emapp/FileUtils.h"
+#include "emapp/ImageLoader.h"
+#include "emapp/internal/FileContentDigestCache.h"
+#include "emapp/internal/LinearPCMStream.h"
+#include "emapp/internal/WaveFormPyramid.h"
+#include "emapp/private/CommonInclude.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+/* 60 seconds and one hour of 16bit stereo 48kHz sawtooth wave */
+static const nanoem_u32_t kSampleRate = 48000, kNumChannels = 2, kNumFrames = kSampleRate * 60,
+                          kNumLongFrames = kSampleRate * 3600;
+
+static void
+generateAllSamples(nanoem_i16_t *samples, nanoem_rsize_t numFrames)
+{
+    for (nanoem_rsize_t i = 0; i < numFrames * kNumChannels; i++) {
+        samples[i] = nanoem_i16_t((i * 97) & 0xffff);
+    }
+}
+
+class StreamingAudioPlayer : public BaseAudioPlayer {
+public:
+    StreamingAudioPlayer()
+        : m_baseResidentMemorySize(0)
+    {
+    }
+    bool
+    initialize(nanoem_frame_index_t /* duration */, nanoem_u32_t /* sampleRate */, Error & /* error */) override
+    {
+        return true;
+    }
+    void
+    expandDuration(nanoem_frame_index_t /* frameIndex */) override
+    {
+    }
+    void
+    destroy() override
+    {
+    }
+    bool
+    loadAllLinearPCMSamples(const nanoem_u8_t *data, size_t size, Error & /* error */) override
+    {
+        assignLinearPCMSamples(data, size);
+        /* both the loaded samples and the samples taken over by the player are alive at this point */
+        if (m_baseResidentMemorySize > 0) {
+            benchmark::Fixture::reportResidentMemorySize(
+                "BaseAudioPlayer::loadAllLinearPCMSamples", m_baseResidentMemorySize);
+        }
+        return true;
+    }
+    void
+    playPart(nanoem_f64_t /* start */, nanoem_f64_t /* length */) override
+    {
+    }
+    void
+    update() override
+    {
+    }
+    void
+    seek(const Rational & /* value */) override
+    {
+    }
+    void
+    internalSetVolumeGain(nanoem_f32_t /* value */, Error & /* error */) override
+    {
+    }
+    void
+    internalTransitStateStarted(Error & /* error */) override
+    {
+    }
+    void
+    internalTransitStatePaused(Error & /* error */) override
+    {
+    }
+    void
+    internalTransitStateResumed(Error & /* error */) override
+    {
+    }
+    void
+    internalTransitStateStopped(Error & /* error */) override
+    {
+    }
+    nanoem_rsize_t m_baseResidentMemorySize;
+};
+
+struct TemporaryFileScope {
+    TemporaryFileScope(const char *filename)
+        : m_fileURI(URI::createFromFilePath(benchmark::Fixture::temporaryFilePath(filename)))
+    {
+    }
+    ~TemporaryFileScope()
+    {
+        FileUtils::deleteFile(m_fileURI);
+    }
+    const URI m_fileURI;
+};
+
+} /* namespace anonymous */
+
+TEST_CASE("benchmark_misc_apng", "[emapp][benchmark][misc]")
+{
+    ByteArray bytes;
+    benchmark::Fixture::readFile("apngs/021.png", bytes);
+    REQUIRE_FALSE(bytes.empty());
+    BENCHMARK("ImageLoader::decodeAPNG")
+    {
+        MemoryReader reader(&bytes);
+        Error error;
+        image::APNG *apng = ImageLoader::decodeAPNG(&reader, error);
+        const bool decoded = apng != nullptr;
+        nanoem_delete(apng);
+        return decoded;
+    };
+    MemoryReader reader(&bytes);
+    Error error;
+    image::APNG *apng = ImageLoader::decodeAPNG(&reader, error);
+    REQUIRE(apng);
+    const nanoem_rsize_t numFrames = apng->numFrames();
+    BENCHMARK_ADVANCED("APNG::compositedFrameImage(sequential)")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&](int i) { return apng->compositedFrameImage(nanoem_rsize_t(i) % numFrames); });
+    };
+    BENCHMARK_ADVANCED("APNG::compositedFrameImage(backward)")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure(
+            [&](int i) { return apng->compositedFrameImage(numFrames - 1 - nanoem_rsize_t(i) % numFrames); });
+    };
+    nanoem_delete(apng);
+}
+
+TEST_CASE("benchmark_misc_apng_composite", "[emapp][benchmark][misc]")
+{
+    ByteArray bytes;
+    benchmark::Fixture::readFile("apngs/021.png", bytes);
+    MemoryReader reader(&bytes);
+    Error error;
+    const nanoem_rsize_t baseSize = benchmark::Fixture::residentMemorySize();
+    image::APNG *apng = ImageLoader::decodeAPNG(&reader, error);
+    REQUIRE(apng);
+    const nanoem_rsize_t numFrames = apng->numFrames();
+    /* frames are decoded by stb_image as they were before inflating them directly */
+    apng->setFrameInflationEnabled(false);
+    BENCHMARK("APNG::composite(stb)")
+    {
+        apng->composite(error);
+        for (nanoem_rsize_t i = 0; i < numFrames; i++) {
+            apng->compositedFrameImage(i);
+        }
+        return apng->numKeyframeCompositions();
+    };
+    apng->setFrameInflationEnabled(true);
+    BENCHMARK("APNG::composite(inflated)")
+    {
+        apng->composite(error);
+        for (nanoem_rsize_t i = 0; i < numFrames; i++) {
+            apng->compositedFrameImage(i);
+        }
+        return apng->numKeyframeCompositions();
+    };
+    benchmark::Fixture::reportResidentMemorySize("APNG::composite", baseSize);
+    CHECK_FALSE(error.hasReason());
+    nanoem_delete(apng);
+}
+
+TEST_CASE("benchmark_misc_apng_blend", "[emapp][benchmark][misc]")
+{
+    /* a frame as large as full HD blended over the composition */
+    static const nanoem_rsize_t kNumPixels = 1920 * 1080;
+    const nanoem_rsize_t baseSize = benchmark::Fixture::residentMemorySize();
+    ByteArray source(kNumPixels * 4), dest(kNumPixels * 4);
+    for (nanoem_rsize_t i = 0, size = source.size(); i < size; i++) {
+        source[i] = nanoem_u8_t((i * 2654435761u) >> 24);
+        dest[i] = nanoem_u8_t(i * 13);
+    }
+    benchmark::Fixture::reportResidentMemorySize("APNG::blendPixelsOver", baseSize);
+    BENCHMARK("APNG::blendPixelsOver(scalar)")
+    {
+        image::APNG::blendPixelsOver(source.data(), dest.data(), kNumPixels, false);
+        return dest[0];
+    };
+    BENCHMARK("APNG::blendPixelsOver(SIMD)")
+    {
+        image::APNG::blendPixelsOver(source.data(), dest.data(), kNumPixels, true);
+        return dest[0];
+    };
+}
+
+TEST_CASE("benchmark_misc_audio", "[emapp][benchmark][misc]")
+{
+    /* one hour of samples is written second by second into the temporary directory not to hold it in memory */
+    const TemporaryFileScope file("nanoem_benchmark_audio.wav");
+    const URI &fileURI = file.m_fileURI;
+    {
+        IAudioPlayer::WAVDescription desc;
+        const nanoem_rsize_t payloadSize = nanoem_rsize_t(kNumLongFrames) * kNumChannels * sizeof(nanoem_i16_t);
+        BaseAudioPlayer::initializeDescription(16, kNumChannels, kSampleRate, payloadSize, desc);
+        const IAudioPlayer::Chunk dataChunk = { nanoem_fourcc('d', 'a', 't', 'a'), nanoem_u32_t(payloadSize) };
+        ByteArray samples(kSampleRate * kNumChannels * sizeof(nanoem_i16_t));
+        generateAllSamples(reinterpret_cast<nanoem_i16_t *>(samples.data()), kSampleRate);
+        FileWriterScope scope;
+        Error error;
+        REQUIRE(scope.open(fileURI, error));
+        FileUtils::writeTyped(scope.writer(), desc, error);
+        FileUtils::writeTyped(scope.writer(), dataChunk, error);
+        for (nanoem_u32_t i = 0; i < kNumLongFrames / kSampleRate; i++) {
+            FileUtils::write(scope.writer(), samples, error);
+        }
+        scope.commit(error);
+        REQUIRE_FALSE(error.hasReason());
+    }
+    BENCHMARK("BaseAudioPlayer::load(ISeekableReader)")
+    {
+        FileReaderScope scope(nullptr);
+        StreamingAudioPlayer player;
+        Error error;
+        return scope.open(fileURI, error) && player.load(scope.reader(), error);
+    };
+    {
+        FileReaderScope scope(nullptr);
+        StreamingAudioPlayer player;
+        Error error;
+        REQUIRE(scope.open(fileURI, error));
+        player.m_baseResidentMemorySize = benchmark::Fixture::residentMemorySize();
+        REQUIRE(player.load(scope.reader(), error));
+        benchmark::Fixture::reportResidentMemorySize(
+            "BaseAudioPlayer::load(ISeekableReader)", player.m_baseResidentMemorySize);
+    }
+    BENCHMARK_ADVANCED("LinearPCMStream::read(random)")(Catch::Benchmark::Chronometer meter)
+    {
+        FileReaderScope scope(nullptr);
+        Error error;
+        REQUIRE(scope.open(fileURI, error));
+        internal::LinearPCMStream stream(scope.reader());
+        REQUIRE(stream.open(error));
+        ByteArray output(1024 * stream.bytesPerFrame());
+        meter.measure([&](int i) {
+            stream.seek((nanoem_u64_t(i) * 2654435761u) % kNumLongFrames);
+            return stream.read(output.data(), 1024, error);
+        });
+    };
+}
+
+namespace {
+
+static void
+benchmarkWaveFormPyramid(nanoem_rsize_t numFrames)
+{
+    /* every column of the timeline as wide as full HD shows the whole audio */
+    static const nanoem_rsize_t kNumColumns = 1920;
+    ByteArray bytes(numFrames * kNumChannels * sizeof(nanoem_i16_t));
+    generateAllSamples(reinterpret_cast<nanoem_i16_t *>(bytes.data()), numFrames);
+    internal::WaveFormPyramid pyramid;
+    BENCHMARK("WaveFormPyramid::update")
+    {
+        pyramid.reset(&bytes, 16, kNumChannels);
+        return pyramid.update(numFrames);
+    };
+    REQUIRE(pyramid.isCompleted());
+    {
+        const nanoem_rsize_t baseSize = benchmark::Fixture::residentMemorySize();
+        internal::WaveFormPyramid newPyramid;
+        newPyramid.reset(&bytes, 16, kNumChannels);
+        newPyramid.update(numFrames);
+        benchmark::Fixture::reportResidentMemorySize("WaveFormPyramid::update", baseSize);
+    }
+    /* scans all samples of each column as the waveform was drawn before summarizing them */
+    BENCHMARK("WaveFormPyramid::Bin::merge(all samples)")
+    {
+        nanoem_f32_t sum = 0;
+        for (nanoem_rsize_t i = 0; i < kNumColumns; i++) {
+            const nanoem_rsize_t beginSample = numFrames * i / kNumColumns * kNumChannels,
+                                 endSample = numFrames * (i + 1) / kNumColumns * kNumChannels;
+            internal::WaveFormPyramid::Bin bin;
+            for (nanoem_rsize_t j = beginSample; j < endSample; j++) {
+                bin.merge(internal::WaveFormPyramid::decodeSample(
+                    &bytes[j * sizeof(nanoem_i16_t)], sizeof(nanoem_i16_t)));
+            }
+            sum += bin.m_max - bin.m_min;
+        }
+        return sum;
+    };
+    BENCHMARK("WaveFormPyramid::query")
+    {
+        nanoem_f32_t sum = 0;
+        for (nanoem_rsize_t i = 0; i < kNumColumns; i++) {
+            const internal::WaveFormPyramid::Bin bin(
+                pyramid.query(numFrames * i / kNumColumns, numFrames * (i + 1) / kNumColumns));
+            sum += bin.m_max - bin.m_min;
+        }
+        return sum;
+    };
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("benchmark_misc_waveform_pyramid", "[emapp][benchmark][misc]")
+{
+    benchmarkWaveFormPyramid(kNumFrames);
+}
+
+TEST_CASE("benchmark_misc_waveform_pyramid_one_hour", "[emapp][benchmark][misc]")
+{
+    /* about 660 MiB of samples, as long as the longest audio the timeline is expected to show */
+    benchmarkWaveFormPyramid(kNumLongFrames);
+}
+
+TEST_CASE("benchmark_misc_file_content_digest", "[emapp][benchmark][misc]")
+{
+    /* stands for a background video referenced by the project */
+    static const nanoem_rsize_t kFileSize = 256 * 1024 * 1024;
+    /* written into the temporary directory and deleted even if any assertion fails */
+    const TemporaryFileScope file("nanoem_benchmark_digest.bin");
+    const URI &fileURI = file.m_fileURI;
+    {
+        ByteArray bytes(kFileSize);
+        for (nanoem_rsize_t i = 0; i < kFileSize; i++) {
+            bytes[i] = nanoem_u8_t((i * 2654435761u) >> 24);
+        }
+        FileWriterScope scope;
+        Error error;
+        REQUIRE(scope.open(fileURI, error));
+        FileUtils::write(scope.writer(), bytes, error);
+        scope.commit(error);
+        REQUIRE_FALSE(error.hasReason());
+    }
+    internal::FileContentDigestCache cache(nullptr);
+    nanoem_u8_t digest[internal::FileContentDigestCache::kDigestSize];
+    BENCHMARK("FileContentDigestCache::digest(uncached)")
+    {
+        Error error;
+        cache.clear();
+        return cache.digest(fileURI, digest, error);
+    };
+    BENCHMARK("FileContentDigestCache::digest(cached)")
+    {
+        Error error;
+        return cache.digest(fileURI, digest, error);
+    };
+    BENCHMARK("FileContentDigestCache::readAllBytes(uncached)")
+    {
+        ByteArray bytes;
+        Error error;
+        cache.clear();
+        return cache.readAllBytes(fileURI, bytes, digest, error);
+    };
+    {
+        const nanoem_rsize_t baseSize = benchmark::Fixture::residentMemorySize();
+        Error error;
+        cache.clear();
+        cache.digest(fileURI, digest, error);
+        benchmark::Fixture::reportResidentMemorySize("FileContentDigestCache::digest(uncached)", baseSize);
+    }
+}
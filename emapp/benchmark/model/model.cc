@@ -0,0 +1,292 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/ICamera.h"
+#include "emapp/Model.h"
+#include "emapp/Motion.h"
+#include "emapp/model/RigidBody.h"
+#include "emapp/model/Vertex.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+typedef tinystl::vector<nanoem_physics_motion_state_t *, TinySTLAllocator> MotionStateList;
+typedef tinystl::vector<Matrix4x4, TinySTLAllocator> Matrix4x4List;
+
+static Model *
+setupModel(Project *project, const benchmark::Fixture::ModelDescription &desc)
+{
+    nanoem_unicode_string_factory_t *factory = project->unicodeStringFactory();
+    ByteArray modelBytes, motionBytes;
+    benchmark::Fixture::generateModel(factory, desc, modelBytes);
+    benchmark::Fixture::generateMotion(factory, desc, benchmark::Fixture::kDenseMotion, motionBytes);
+    Model *model = benchmark::Fixture::createModel(project, modelBytes);
+    REQUIRE(model);
+    project->addModel(model);
+    REQUIRE(benchmark::Fixture::createModelMotion(project, model, motionBytes));
+    project->seek(benchmark::Fixture::kDenseMotion.m_duration / 2, true);
+    return model;
+}
+
+/* projects every vertex as picking did before vertices were indexed by the bounding volume hierarchy */
+static void
+collectAllVerticesInViewportLinear(
+    Model *model, const ICamera *camera, const Vector4SI32 &rect, VertexIndexList &vertexIndices)
+{
+    nanoem_rsize_t numVertices;
+    nanoemModelGetAllVertexObjects(model->data(), &numVertices);
+    vertexIndices.clear();
+    for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+        const Vector2SI32 coord(camera->toDeviceScreenCoordinateInViewport(model->skinnedVertexPosition(i)));
+        if (coord.x >= rect.x && coord.x < rect.x + rect.z && coord.y >= rect.y && coord.y < rect.y + rect.w) {
+            vertexIndices.push_back(nanoem_u32_t(i));
+        }
+    }
+}
+
+static nanoem_f32_t
+sumAllSkinnedVertexPositions(Model *model)
+{
+    nanoem_rsize_t numVertices;
+    nanoemModelGetAllVertexObjects(model->data(), &numVertices);
+    nanoem_f32_t sum = 0;
+    for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+        sum += model->skinnedVertexPosition(i).y;
+    }
+    return sum;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("benchmark_model_load", "[emapp][benchmark][model]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    nanoem_unicode_string_factory_t *factory = project->unicodeStringFactory();
+    ByteArray bytes;
+    benchmark::Fixture::generateModel(factory, benchmark::Fixture::kLargeModel, bytes);
+    REQUIRE_FALSE(bytes.empty());
+    BENCHMARK("nanoemModelLoadFromBuffer")
+    {
+        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+        nanoem_buffer_t *buffer = nanoemBufferCreate(bytes.data(), bytes.size(), &status);
+        nanoem_model_t *model = nanoemModelCreate(factory, &status);
+        const nanoem_bool_t loaded = nanoemModelLoadFromBuffer(model, buffer, &status);
+        nanoemModelDestroy(model);
+        nanoemBufferDestroy(buffer);
+        return loaded;
+    };
+    BENCHMARK("Model::load")
+    {
+        Model *model = project->createModel();
+        Error error;
+        const bool loaded = model->load(bytes, error);
+        project->destroyModel(model);
+        return loaded;
+    };
+    const nanoem_rsize_t baseSize = benchmark::Fixture::residentMemorySize();
+    Model *model = project->createModel();
+    Error error;
+    CHECK(model->load(bytes, error));
+    benchmark::Fixture::reportResidentMemorySize("Model::load", baseSize);
+    project->destroyModel(model);
+}
+
+TEST_CASE("benchmark_model_transform", "[emapp][benchmark][model]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    Model *model = setupModel(project, benchmark::Fixture::kLargeModel);
+    BENCHMARK("Model::performAllBonesTransform")
+    {
+        model->performAllBonesTransform();
+    };
+    BENCHMARK("Model::updateStagingVertexBuffer")
+    {
+        model->markStagingVertexBufferDirty();
+        model->updateStagingVertexBuffer();
+    };
+    BENCHMARK_ADVANCED("Model::synchronizeMotion")(Catch::Benchmark::Chronometer meter)
+    {
+        const nanoem_frame_index_t duration = benchmark::Fixture::kDenseMotion.m_duration;
+        const Motion *motion = project->resolveMotion(model);
+        meter.measure([&](int i) {
+            const nanoem_frame_index_t frameIndex = nanoem_frame_index_t(i) % duration;
+            model->synchronizeMotion(motion, frameIndex, 0, PhysicsEngine::kSimulationTimingBefore);
+        });
+    };
+}
+
+TEST_CASE("benchmark_model_solve_constraints", "[emapp][benchmark][model]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    benchmark::Fixture::ModelDescription desc(benchmark::Fixture::kLargeModel);
+    desc.m_numConstraints = 0;
+    Model *unconstrainedModel = setupModel(project, desc);
+    Model *model = setupModel(project, benchmark::Fixture::kLargeModel);
+    nanoem_rsize_t numBones;
+    nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(model->data(), &numBones);
+    nanoem_rsize_t numBoneConstraints = 0;
+    for (nanoem_rsize_t i = 0; i < numBones; i++) {
+        numBoneConstraints += nanoemModelBoneGetConstraintObject(bones[i]) != nullptr;
+    }
+    REQUIRE(numBoneConstraints == benchmark::Fixture::kLargeModel.m_numConstraints);
+    /* the difference from the unconstrained model is the cost of solving constraints */
+    BENCHMARK("Model::performAllBonesTransform(no constraints)")
+    {
+        unconstrainedModel->performAllBonesTransform();
+    };
+    BENCHMARK("Model::performAllBonesTransform(constraints)")
+    {
+        model->performAllBonesTransform();
+    };
+    /* tracing runs every iteration and records each of them as the solver did before early termination */
+    model->setConstraintIterationTraceEnabled(true);
+    BENCHMARK("Model::performAllBonesTransform(traced constraints)")
+    {
+        model->performAllBonesTransform();
+    };
+    model->setConstraintIterationTraceEnabled(false);
+}
+
+TEST_CASE("benchmark_model_collect_all_objects_in_viewport", "[emapp][benchmark][model]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    benchmark::Fixture::ModelDescription desc(benchmark::Fixture::kLargeModel);
+    desc.m_numVertices = 500000;
+    Model *model = setupModel(project, desc);
+    project->setActiveModel(model);
+    model->performAllBonesTransform();
+    model->updateStagingVertexBuffer();
+    const ICamera *camera = project->activeCamera();
+    const Vector4SI32 rect(camera->toDeviceScreenCoordinateInViewport(model->skinnedVertexPosition(0)) - 32, 64, 64);
+    VertexIndexList indices;
+    model->collectAllVerticesInViewport(rect, indices);
+    REQUIRE_FALSE(indices.empty());
+    BENCHMARK("Model::collectAllVerticesInViewport(linear)")
+    {
+        collectAllVerticesInViewportLinear(model, camera, rect, indices);
+        return indices.size();
+    };
+    BENCHMARK("Model::collectAllVerticesInViewport")
+    {
+        model->collectAllVerticesInViewport(rect, indices);
+        return indices.size();
+    };
+    BENCHMARK("Model::collectAllVerticesInViewport(refit)")
+    {
+        model->markAllSpatialIndicesDirty();
+        model->collectAllVerticesInViewport(rect, indices);
+        return indices.size();
+    };
+    BENCHMARK("Model::collectAllFacesInViewport")
+    {
+        model->collectAllFacesInViewport(rect, indices);
+        return indices.size();
+    };
+    BENCHMARK("Model::collectAllFacesInViewport(refit)")
+    {
+        model->markAllSpatialIndicesDirty();
+        model->collectAllFacesInViewport(rect, indices);
+        return indices.size();
+    };
+}
+
+TEST_CASE("benchmark_model_skinned_vertex_cache", "[emapp][benchmark][model]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    Model *model = setupModel(project, benchmark::Fixture::kLargeModel);
+    model->performAllBonesTransform();
+    nanoem_rsize_t numVertices;
+    nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(model->data(), &numVertices);
+    /* skinned vertices are computed again for the overlays as they were before sharing them */
+    BENCHMARK("Model::VertexUnit::performSkinningByType")
+    {
+        nanoem_f32_t sum = 0;
+        for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+            bx::simd128_t position = bx::simd_zero(), normal = bx::simd_zero();
+            Model::VertexUnit::performSkinningByType(model::Vertex::cast(vertices[i]), &position, &normal);
+            sum += bx::simd_y(position);
+        }
+        return sum;
+    };
+    model->setShowAllVertexPoints(false);
+    BENCHMARK("Model::skinnedVertexPosition(overlays hidden)")
+    {
+        model->markStagingVertexBufferDirty();
+        model->updateStagingVertexBuffer();
+        return sumAllSkinnedVertexPositions(model);
+    };
+    model->setShowAllVertexPoints(true);
+    BENCHMARK("Model::skinnedVertexPosition(overlays shown)")
+    {
+        model->markStagingVertexBufferDirty();
+        model->updateStagingVertexBuffer();
+        return sumAllSkinnedVertexPositions(model);
+    };
+    model->setShowAllVertexPoints(false);
+}
+
+TEST_CASE("benchmark_model_rigid_body_transforms", "[emapp][benchmark][model]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeEnableAnytime);
+    Model *model = setupModel(project, benchmark::Fixture::kLargeModel);
+    PhysicsEngine *engine = project->physicsEngine();
+    nanoem_rsize_t numRigidBodies;
+    nanoem_model_rigid_body_t *const *rigidBodies = nanoemModelGetAllRigidBodyObjects(model->data(), &numRigidBodies);
+    REQUIRE(numRigidBodies > 0);
+    MotionStateList states(numRigidBodies);
+    for (nanoem_rsize_t i = 0; i < numRigidBodies; i++) {
+        const model::RigidBody *rigidBody = model::RigidBody::cast(rigidBodies[i]);
+        states[i] = rigidBody ? engine->motionState(rigidBody->physicsRigidBody()) : nullptr;
+    }
+    Matrix4x4List transforms(numRigidBodies);
+    /* each motion state was transferred by its own call before the bulk entry points */
+    BENCHMARK("PhysicsEngine::getWorldTransform(each)")
+    {
+        for (nanoem_rsize_t i = 0; i < numRigidBodies; i++) {
+            engine->getWorldTransform(states[i], glm::value_ptr(transforms[i]));
+        }
+    };
+    BENCHMARK("PhysicsEngine::getAllWorldTransforms")
+    {
+        engine->getAllWorldTransforms(states.data(), numRigidBodies, glm::value_ptr(transforms[0]));
+    };
+    BENCHMARK("PhysicsEngine::setWorldTransform(each)")
+    {
+        for (nanoem_rsize_t i = 0; i < numRigidBodies; i++) {
+            engine->setWorldTransform(states[i], glm::value_ptr(transforms[i]));
+        }
+    };
+    BENCHMARK("PhysicsEngine::setAllWorldTransforms")
+    {
+        engine->setAllWorldTransforms(states.data(), numRigidBodies, glm::value_ptr(transforms[0]));
+    };
+    BENCHMARK("Model::synchronizeAllRigidBodiesTransformFeedbackToSimulation")
+    {
+        model->synchronizeAllRigidBodiesTransformFeedbackToSimulation();
+    };
+    BENCHMARK("Model::synchronizeAllRigidBodiesTransformFeedbackFromSimulation")
+    {
+        model->synchronizeAllRigidBodiesTransformFeedbackFromSimulation(PhysicsEngine::kRigidBodyFollowBonePerform);
+    };
+    project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeDisable);
+}
@@ -0,0 +1,271 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Motion.h"
+#include "emapp/StringUtils.h"
+#include "emapp/private/CommonInclude.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+typedef tinystl::vector<nanoem_unicode_string_t *, TinySTLAllocator> UnicodeStringList;
+
+static void
+createAllBoneNames(nanoem_unicode_string_factory_t *factory, nanoem_rsize_t numBones, UnicodeStringList &names)
+{
+    names.resize(numBones);
+    for (nanoem_rsize_t i = 0; i < numBones; i++) {
+        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+        char name[32];
+        StringUtils::format(name, sizeof(name), "bone_%04d", Inline::saturateInt32(i));
+        names[i] = nanoemUnicodeStringFactoryCreateString(
+            factory, reinterpret_cast<const nanoem_u8_t *>(name), StringUtils::length(name), &status);
+    }
+}
+
+static void
+destroyAllBoneNames(nanoem_unicode_string_factory_t *factory, UnicodeStringList &names)
+{
+    for (UnicodeStringList::const_iterator it = names.begin(), end = names.end(); it != end; ++it) {
+        nanoemUnicodeStringFactoryDestroyString(factory, *it);
+    }
+    names.clear();
+}
+
+static nanoem_rsize_t
+findAllBoneKeyframes(const nanoem_motion_t *opaque, const benchmark::Fixture::MotionDescription &motionDesc,
+    const UnicodeStringList &names)
+{
+    nanoem_rsize_t numFound = 0;
+    for (nanoem_frame_index_t frameIndex = 0; frameIndex <= motionDesc.m_duration;
+         frameIndex += motionDesc.m_interval) {
+        for (UnicodeStringList::const_iterator it = names.begin(), end = names.end(); it != end; ++it) {
+            numFound += nanoemMotionFindBoneKeyframeObject(opaque, *it, frameIndex) != nullptr;
+        }
+    }
+    return numFound;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("benchmark_motion_load", "[emapp][benchmark][motion]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    nanoem_unicode_string_factory_t *factory = project->unicodeStringFactory();
+    ByteArray bytes;
+    benchmark::Fixture::generateMotion(
+        factory, benchmark::Fixture::kLargeModel, benchmark::Fixture::kDenseMotion, bytes);
+    REQUIRE_FALSE(bytes.empty());
+    BENCHMARK("nanoemMotionLoadFromBuffer")
+    {
+        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+        nanoem_buffer_t *buffer = nanoemBufferCreate(bytes.data(), bytes.size(), &status);
+        nanoem_motion_t *motion = nanoemMotionCreate(factory, &status);
+        const nanoem_bool_t loaded = nanoemMotionLoadFromBuffer(motion, buffer, 0, &status);
+        nanoemMotionDestroy(motion);
+        nanoemBufferDestroy(buffer);
+        return loaded;
+    };
+    BENCHMARK("Motion::load")
+    {
+        Motion *motion = project->createMotion();
+        Error error;
+        motion->setFormat(NANOEM_MOTION_FORMAT_TYPE_VMD);
+        const bool loaded = motion->load(bytes, 0, error);
+        project->destroyMotion(motion);
+        return loaded;
+    };
+    const nanoem_rsize_t baseSize = benchmark::Fixture::residentMemorySize();
+    Motion *motion = project->createMotion();
+    Error error;
+    motion->setFormat(NANOEM_MOTION_FORMAT_TYPE_VMD);
+    CHECK(motion->load(bytes, 0, error));
+    benchmark::Fixture::reportResidentMemorySize("Motion::load", baseSize);
+    project->destroyMotion(motion);
+}
+
+namespace {
+
+static nanoem_frame_index_t
+shiftFrameIndex(void *userData, nanoem_frame_index_t frameIndex)
+{
+    return frameIndex + *static_cast<const nanoem_s32_t *>(userData);
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("benchmark_motion_remap_keyframes", "[emapp][benchmark][motion]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    benchmark::Fixture::ModelDescription modelDesc;
+    modelDesc.m_numBones = 500;
+    ByteArray bytes;
+    benchmark::Fixture::generateMotion(
+        project->unicodeStringFactory(), modelDesc, benchmark::Fixture::kLongMotion, bytes);
+    Motion *motion = project->createMotion();
+    Error error;
+    motion->setFormat(NANOEM_MOTION_FORMAT_TYPE_VMD);
+    REQUIRE(motion->load(bytes, 0, error));
+    const nanoem_frame_index_t duration = benchmark::Fixture::kLongMotion.m_duration;
+    /* each benchmark is a round trip so every run starts from the same keyframe layout */
+    BENCHMARK("Motion::scaleAllBoneKeyframesIn")
+    {
+        motion->scaleAllBoneKeyframesIn(0, duration, 2.0f);
+        motion->scaleAllBoneKeyframesIn(0, duration * 2, 0.5f);
+        return motion->duration();
+    };
+    BENCHMARK("nanoemMutableMotionRemapAllKeyframes")
+    {
+        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+        nanoem_mutable_motion_t *mutableMotion = nanoemMutableMotionCreateAsReference(motion->data(), &status);
+        nanoem_s32_t offset = 1;
+        nanoemMutableMotionRemapAllKeyframes(mutableMotion, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE, 0, duration,
+            shiftFrameIndex, &offset, &status);
+        offset = -1;
+        nanoemMutableMotionRemapAllKeyframes(mutableMotion, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE, 1, duration + 1,
+            shiftFrameIndex, &offset, &status);
+        nanoemMutableMotionDestroy(mutableMotion);
+        return status;
+    };
+    project->destroyMotion(motion);
+}
+
+TEST_CASE("benchmark_motion_find_keyframe_by_name", "[emapp][benchmark][motion]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    nanoem_unicode_string_factory_t *factory = project->unicodeStringFactory();
+    const benchmark::Fixture::ModelDescription &modelDesc = benchmark::Fixture::kLargeModel;
+    const benchmark::Fixture::MotionDescription &motionDesc = benchmark::Fixture::kDenseMotion;
+    ByteArray bytes;
+    benchmark::Fixture::generateMotion(factory, modelDesc, motionDesc, bytes);
+    Motion *motion = project->createMotion();
+    Error error;
+    motion->setFormat(NANOEM_MOTION_FORMAT_TYPE_VMD);
+    REQUIRE(motion->load(bytes, 0, error));
+    /*
+     * names created from the motion's factory are interned and compared by pointer (after). names created from
+     * another factory have equal contents but are distinct instances so every comparison falls back to compare the
+     * contents as all names did before interning (before).
+     */
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_unicode_string_factory_t *otherFactory = nanoemUnicodeStringFactoryCreateEXT(&status);
+    UnicodeStringList internedNames, otherNames;
+    createAllBoneNames(factory, modelDesc.m_numBones, internedNames);
+    createAllBoneNames(otherFactory, modelDesc.m_numBones, otherNames);
+    const nanoem_motion_t *opaque = motion->data();
+    REQUIRE(findAllBoneKeyframes(opaque, motionDesc, internedNames) > 0);
+    REQUIRE(findAllBoneKeyframes(opaque, motionDesc, otherNames) ==
+        findAllBoneKeyframes(opaque, motionDesc, internedNames));
+    BENCHMARK("nanoemMotionFindBoneKeyframeObject (interned names)")
+    {
+        return findAllBoneKeyframes(opaque, motionDesc, internedNames);
+    };
+    BENCHMARK("nanoemMotionFindBoneKeyframeObject (names of another factory)")
+    {
+        return findAllBoneKeyframes(opaque, motionDesc, otherNames);
+    };
+    destroyAllBoneNames(otherFactory, otherNames);
+    destroyAllBoneNames(factory, internedNames);
+    nanoemUnicodeStringFactoryDestroyEXT(otherFactory);
+    project->destroyMotion(motion);
+}
+
+namespace {
+
+static void
+createAllMotions(Project *project, const ByteArray &bytes, int numMotions, Project::MotionList &motions)
+{
+    Error error;
+    for (int i = 0; i < numMotions; i++) {
+        Motion *motion = project->createMotion();
+        motion->setFormat(NANOEM_MOTION_FORMAT_TYPE_VMD);
+        motion->load(bytes, 0, error);
+        motions.push_back(motion);
+    }
+}
+
+static void
+destroyAllMotions(Project *project, Project::MotionList &motions)
+{
+    for (Project::MotionList::const_iterator it = motions.begin(), end = motions.end(); it != end; ++it) {
+        project->destroyMotion(*it);
+    }
+    motions.clear();
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("benchmark_motion_merge_all_keyframes", "[emapp][benchmark][motion]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    benchmark::Fixture::ModelDescription modelDesc;
+    modelDesc.m_numBones = 64;
+    ByteArray bytes;
+    benchmark::Fixture::generateMotion(
+        project->unicodeStringFactory(), modelDesc, benchmark::Fixture::kLongMotion, bytes);
+    Motion *source = project->createMotion();
+    Error error;
+    source->setFormat(NANOEM_MOTION_FORMAT_TYPE_VMD);
+    REQUIRE(source->load(bytes, 0, error));
+    /* shifting by the half of the interval interleaves keyframes of both motions in every track */
+    const nanoem_frame_index_t offset = benchmark::Fixture::kLongMotion.m_interval / 2;
+    Motion *shiftedSource = project->createMotion();
+    shiftedSource->overrideAllKeyframes(source, offset, false);
+    BENCHMARK_ADVANCED("Motion::mergeAllKeyframes")(Catch::Benchmark::Chronometer meter)
+    {
+        Project::MotionList motions;
+        createAllMotions(project, bytes, meter.runs(), motions);
+        meter.measure([&](int i) { motions[i]->mergeAllKeyframes(shiftedSource); });
+        destroyAllMotions(project, motions);
+    };
+    BENCHMARK_ADVANCED("Motion::overrideAllKeyframes")(Catch::Benchmark::Chronometer meter)
+    {
+        Project::MotionList motions;
+        createAllMotions(project, bytes, meter.runs(), motions);
+        meter.measure([&](int i) { motions[i]->overrideAllKeyframes(source, offset, true); });
+        destroyAllMotions(project, motions);
+    };
+    project->destroyMotion(shiftedSource);
+    project->destroyMotion(source);
+}
+
+TEST_CASE("benchmark_motion_create_bone_names", "[emapp][benchmark][motion]")
+{
+    /*
+     * the factory is MBWC on Windows and ICU on the others. names equal to alive ones are shared without decoding
+     * into the heap (after). names not alive yet are allocated and freed as all names were before interning
+     * (before).
+     */
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_unicode_string_factory_t *factory = nanoemUnicodeStringFactoryCreateEXT(&status);
+    const nanoem_rsize_t numBones = benchmark::Fixture::kLargeModel.m_numBones;
+    UnicodeStringList names, internedNames;
+    BENCHMARK("nanoemUnicodeStringFactoryCreateString (not interned)")
+    {
+        createAllBoneNames(factory, numBones, names);
+        destroyAllBoneNames(factory, names);
+    };
+    createAllBoneNames(factory, numBones, internedNames);
+    BENCHMARK("nanoemUnicodeStringFactoryCreateString (interned)")
+    {
+        createAllBoneNames(factory, numBones, names);
+        destroyAllBoneNames(factory, names);
+    };
+    destroyAllBoneNames(factory, internedNames);
+    nanoemUnicodeStringFactoryDestroyEXT(factory);
+}
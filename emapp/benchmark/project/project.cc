@@ -0,0 +1,136 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Accessory.h"
+#include "emapp/IMotionKeyframeSelection.h"
+#include "emapp/Model.h"
+#include "emapp/Motion.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static const nanoem_rsize_t kNumModels = 4;
+
+static void
+setupAllModels(Project *project)
+{
+    nanoem_unicode_string_factory_t *factory = project->unicodeStringFactory();
+    ByteArray modelBytes, motionBytes;
+    benchmark::Fixture::generateModel(factory, benchmark::Fixture::kSmallModel, modelBytes);
+    benchmark::Fixture::generateMotion(
+        factory, benchmark::Fixture::kSmallModel, benchmark::Fixture::kDenseMotion, motionBytes);
+    for (nanoem_rsize_t i = 0; i < kNumModels; i++) {
+        Model *model = benchmark::Fixture::createModel(project, modelBytes);
+        REQUIRE(model);
+        project->addModel(model);
+        REQUIRE(benchmark::Fixture::createModelMotion(project, model, motionBytes));
+    }
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("benchmark_project_seek", "[emapp][benchmark][project]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    setupAllModels(project);
+    const nanoem_frame_index_t duration = benchmark::Fixture::kDenseMotion.m_duration;
+    BENCHMARK_ADVANCED("Project::seek(sequential)")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&](int i) { project->seek(nanoem_frame_index_t(i) % duration, true); });
+    };
+    BENCHMARK_ADVANCED("Project::seek(random)")(Catch::Benchmark::Chronometer meter)
+    {
+        /* Knuth's multiplicative hash keeps the sequence of frame indices same between runs */
+        meter.measure([&](int i) { project->seek((nanoem_frame_index_t(i) * 2654435761u) % duration, true); });
+    };
+}
+
+TEST_CASE("benchmark_project_update", "[emapp][benchmark][project]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    setupAllModels(project);
+    project->seek(benchmark::Fixture::kDenseMotion.m_duration / 2, true);
+    BENCHMARK("Project::update")
+    {
+        project->update();
+    };
+    project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeEnableAnytime);
+    project->resetPhysicsSimulation();
+    BENCHMARK_ADVANCED("Project::seek(physics)")(Catch::Benchmark::Chronometer meter)
+    {
+        const nanoem_frame_index_t duration = benchmark::Fixture::kDenseMotion.m_duration;
+        meter.measure([&](int i) { project->seek(nanoem_frame_index_t(i) % duration, true); });
+    };
+    project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeDisable);
+}
+
+TEST_CASE("benchmark_project_copy_paste_keyframes", "[emapp][benchmark][project]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    nanoem_unicode_string_factory_t *factory = project->unicodeStringFactory();
+    benchmark::Fixture::ModelDescription modelDesc(benchmark::Fixture::kSmallModel);
+    /* 200 bones with 500 keyframes each are 100k keyframes in total */
+    modelDesc.m_numBones = 200;
+    ByteArray modelBytes, motionBytes;
+    benchmark::Fixture::generateModel(factory, modelDesc, modelBytes);
+    benchmark::Fixture::generateMotion(factory, modelDesc, benchmark::Fixture::kLongMotion, motionBytes);
+    Model *model = benchmark::Fixture::createModel(project, modelBytes);
+    REQUIRE(model);
+    project->addModel(model);
+    project->setActiveModel(model);
+    Motion *motion = benchmark::Fixture::createModelMotion(project, model, motionBytes);
+    REQUIRE(motion);
+    motion->selection()->addAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE);
+    Error error;
+    BENCHMARK("Project::copyAllSelectedKeyframes")
+    {
+        project->copyAllSelectedKeyframes(model, error);
+        return project->isMotionClipboardEmpty();
+    };
+    /* pasting at the origin overrides the same keyframes so every run works on the same layout */
+    BENCHMARK("Project::pasteAllSelectedKeyframes")
+    {
+        project->pasteAllSelectedKeyframes(model, 0, error);
+        return motion->duration();
+    };
+    CHECK_FALSE(error.hasReason());
+}
+
+TEST_CASE("benchmark_project_draw_offscreen_render_targets", "[emapp][benchmark][project]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    project->setEffectPluginEnabled(true);
+    setupAllModels(project);
+    /* every owner renders all of the models above with the passive effects assigned by DefaultEffect */
+    for (nanoem_rsize_t i = 0; i < kNumModels; i++) {
+        Accessory *accessory = o->createAccessory("effects/offscreen.x");
+        o->createSourceEffect(accessory, "effects/offscreen.fx");
+        project->addAccessory(accessory);
+    }
+    BENCHMARK("Project::drawAllOffscreenRenderTargets")
+    {
+        project->drawAllOffscreenRenderTargets();
+        project->flushAllCommandBuffers();
+    };
+    BENCHMARK("Project::drawAllOffscreenRenderTargets(invalidated)")
+    {
+        project->invalidateAllOffscreenRenderTargetPlans();
+        project->drawAllOffscreenRenderTargets();
+        project->flushAllCommandBuffers();
+    };
+}
@@ -82,6 +82,7 @@ public:
 
     bool load(const ByteArray &bytes, Error &error) NANOEM_DECL_OVERRIDE;
     bool load(const ByteArray &bytes, const WAVDescription &desc, Error &error) NANOEM_DECL_OVERRIDE;
+    bool load(ISeekableReader *reader, Error &error) NANOEM_DECL_OVERRIDE;
     void play() NANOEM_DECL_OVERRIDE;
     void pause() NANOEM_DECL_OVERRIDE;
     void resume() NANOEM_DECL_OVERRIDE;
@@ -115,10 +116,12 @@ protected:
     virtual void internalTransitStatePaused(Error &error) = 0;
     virtual void internalTransitStateResumed(Error &error) = 0;
     virtual void internalTransitStateStopped(Error &error) = 0;
+    void assignLinearPCMSamples(const nanoem_u8_t *data, nanoem_rsize_t size);
     void reset();
     void setState(State value);
 
     ByteArray m_linearPCMSamples;
+    ByteArray m_streamedLinearPCMSamples;
     URI m_fileURI;
     Vector3 m_volumeGain;
     tinystl::pair<State, State> m_state;
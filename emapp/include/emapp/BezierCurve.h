@@ -10,12 +10,16 @@
 
 #include "emapp/Forward.h"
 
+#include "bx/simd_t.h"
+
 namespace nanoem {
 
 class BezierCurve NANOEM_DECL_SEALED : private NonCopyable {
 public:
     typedef tinystl::unordered_map<nanoem_u64_t, BezierCurve *, TinySTLAllocator> Map;
     typedef tinystl::pair<BezierCurve *, BezierCurve *> Pair;
+    static const Vector2 kP0;
+    static const Vector2 kP1;
 
     BezierCurve(const Vector2U8 &c0, const Vector2U8 &c1, nanoem_frame_index_t interval);
     ~BezierCurve() NANOEM_DECL_NOEXCEPT;
@@ -28,6 +32,8 @@ public:
     Vector2U8 c1() const NANOEM_DECL_NOEXCEPT;
 
     static nanoem_u64_t toHash(const nanoem_u8_t *parameters, nanoem_frame_index_t interval) NANOEM_DECL_NOEXCEPT;
+    static Vector2 interpolate(const Vector2 &c0, const Vector2 &c1, nanoem_f32_t t) NANOEM_DECL_NOEXCEPT;
+    static nanoem_frame_index_t numSamples(nanoem_frame_index_t interval) NANOEM_DECL_NOEXCEPT;
 
 private:
     typedef tinystl::vector<Vector2, nanoem::TinySTLAllocator> PointList;
@@ -42,14 +48,39 @@ private:
         nanoem_u64_t value;
     };
     static void splitBezierCurve(const PointList &points, nanoem_f32_t t, PointList &left, PointList &right);
-    static const Vector2 kP0;
-    static const Vector2 kP1;
     PointList m_parameters;
     Vector2U8 m_c0;
     Vector2U8 m_c1;
     nanoem_frame_index_t m_interval;
 };
 
+/**
+ * Packs up to kMaxNumCurves curves sharing the same interval and evaluates all of them in one pass.
+ *
+ * Samples are stored lane by lane per four curves so the nearest sample search of BezierCurve::value runs on
+ * SIMD registers. Results are same as evaluating each curve with BezierCurve::value.
+ */
+class PackedBezierCurve NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    static const nanoem_rsize_t kMaxNumCurves = 8;
+
+    PackedBezierCurve(const nanoem_u8_t *const *parameters, nanoem_rsize_t numCurves, nanoem_frame_index_t interval);
+    ~PackedBezierCurve() NANOEM_DECL_NOEXCEPT;
+
+    void values(nanoem_f32_t value, nanoem_f32_t *result) const NANOEM_DECL_NOEXCEPT;
+    bool isSame(const nanoem_u8_t *const *parameters, nanoem_frame_index_t interval) const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t numCurves() const NANOEM_DECL_NOEXCEPT;
+
+private:
+    typedef tinystl::vector<bx::simd128_t, TinySTLAllocator> SIMDList;
+    SIMDList m_x;
+    SIMDList m_y;
+    nanoem_u8_t m_parameters[kMaxNumCurves][4];
+    nanoem_frame_index_t m_interval;
+    nanoem_rsize_t m_numCurves;
+    nanoem_rsize_t m_numGroups;
+};
+
 } /* namespace nanoem */
 
 #endif /* NANOEM_EMAPP_BEZIERCURVE_H_ */
@@ -185,8 +185,11 @@ public:
     void updatePassUniformHandles(sg::PassBlock &pb);
     effect::GlobalUniform *globalUniform();
     effect::ViewPassSet viewPassSet() const;
+    nanoem_u32_t resolveUniformSlotIndex(const String &name);
 
     void setGlobalParameters(const IDrawable *drawable, const Project *project, effect::Pass *pass);
+    void writeGlobalParameterBlock(
+        const Project *project, const Vector4 &viewportParameterValue, const effect::Pass *pass);
     void setCameraParameters(const ICamera *camera, const Matrix4x4 &world, const effect::Pass *pass);
     void setLightParameters(const ILight *light, bool adjustment, effect::Pass *pass);
     void setAllAccessoryParameters(const Accessory *accessory, const Project *project, effect::Pass *pass);
@@ -357,6 +360,11 @@ private:
     void setImageUniform(const String &name, const effect::Pass *pass, sg_image handle);
     bool writeUniformBuffer(
         const effect::RegisterIndex &index, const void *ptr, size_t size, effect::GlobalUniform::Buffer &bufferPtr);
+    nanoem_u32_t findUniformSlotIndex(const String &name) const NANOEM_DECL_NOEXCEPT;
+    void addSemanticUniform(effect::UniformSlotIndexMap &uniforms, const String &name);
+    void writeUniformSlot(nanoem_u32_t slotIndex, const effect::Pass *passPtr, const void *ptr, size_t size);
+    void writeUniformSlot(nanoem_u32_t slotIndex, const effect::Pass *passPtr, const Vector4 &value);
+    void writeUniformSlot(nanoem_u32_t slotIndex, const effect::Pass *passPtr, const Matrix4x4 &value);
     void writeUniformBuffer(const String &name, const effect::Pass *passPtr, const void *ptr, size_t size);
     void writeUniformBuffer(const String &name, const effect::Pass *passPtr, bool value);
     void writeUniformBuffer(const String &name, const effect::Pass *passPtr, int value);
@@ -393,6 +401,8 @@ private:
     void destroyAllOffscreenRenderTargetImages(OffscreenRenderTargetImageContainerMap &containers);
     void destroyAllAnimatedImages(AnimatedImageContainerMap &containers);
     void destroyAllStagingBuffers(StagingBufferMap &buffers);
+    tinystl::pair<const Model *, const Accessory *> resolveControlObject(const Model *model, const Accessory *accessory,
+        const Project *project, effect::ControlObjectTarget &target) const;
     tinystl::pair<const Model *, const Accessory *> findOffscreenOwnerObject(
         const IDrawable *ownerDrawable, const Project *project) const NANOEM_DECL_NOEXCEPT;
     void decodeImageData(const ByteArray &bytes, const ImageResourceParameter &parameter, Error &error);
@@ -426,38 +436,37 @@ private:
     effect::ParameterMap m_parameters;
     effect::MatrixUniformMap m_cameraMatrixUniforms;
     effect::MatrixUniformMap m_lightMatrixUniforms;
-    effect::SemanticUniformList m_materialAmbientUniforms;
-    effect::SemanticUniformList m_materialDiffuseUniforms;
-    effect::SemanticUniformList m_materialEmissiveUniforms;
-    effect::SemanticUniformList m_materialSpecularUniforms;
-    effect::SemanticUniformList m_materialSpecularPowerUniforms;
-    effect::SemanticUniformList m_materialToonColorUniforms;
-    effect::SemanticUniformList m_materialEdgeColorUniforms;
-    effect::SemanticUniformList m_materialGroundColorUniforms;
-    effect::SemanticUniformList m_lightAmbientUniforms;
-    effect::SemanticUniformList m_lightDiffuseUniforms;
-    effect::SemanticUniformList m_lightSpecularUniforms;
-    effect::SemanticUniformList m_cameraPositionUniforms;
-    effect::SemanticUniformList m_cameraDirectionUniforms;
-    effect::SemanticUniformList m_lightPositionUniforms;
-    effect::SemanticUniformList m_lightDirectionUniforms;
+    effect::UniformSlotIndexMap m_materialAmbientUniforms;
+    effect::UniformSlotIndexMap m_materialDiffuseUniforms;
+    effect::UniformSlotIndexMap m_materialEmissiveUniforms;
+    effect::UniformSlotIndexMap m_materialSpecularUniforms;
+    effect::UniformSlotIndexMap m_materialSpecularPowerUniforms;
+    effect::UniformSlotIndexMap m_materialToonColorUniforms;
+    effect::UniformSlotIndexMap m_materialEdgeColorUniforms;
+    effect::UniformSlotIndexMap m_materialGroundColorUniforms;
+    effect::UniformSlotIndexMap m_lightAmbientUniforms;
+    effect::UniformSlotIndexMap m_lightDiffuseUniforms;
+    effect::UniformSlotIndexMap m_lightSpecularUniforms;
+    effect::UniformSlotIndexMap m_cameraPositionUniforms;
+    effect::UniformSlotIndexMap m_cameraDirectionUniforms;
+    effect::UniformSlotIndexMap m_lightPositionUniforms;
+    effect::UniformSlotIndexMap m_lightDirectionUniforms;
     effect::SemanticUniformList m_diffuseImageUniforms;
     effect::SemanticUniformList m_sphereImageUniforms;
     effect::SemanticUniformList m_toonImageUniforms;
-    effect::SemanticUniformList m_addingDiffuseImageBlendFactorUniforms;
-    effect::SemanticUniformList m_addingSphereImageBlendFactorUniforms;
-    effect::SemanticUniformList m_multiplyingDiffuseImageBlendFactorUniforms;
-    effect::SemanticUniformList m_multiplyingSphereImageBlendFactorUniforms;
-    effect::SemanticUniformList m_viewportPixelUniforms;
-    effect::SemanticUniformList m_timeUniforms;
-    effect::SemanticUniformList m_systemTimeUniforms;
-    effect::SemanticUniformList m_elapsedTimeUniforms;
-    effect::SemanticUniformList m_elapsedSystemTimeUniforms;
-    effect::SemanticUniformList m_mousePositionUniforms;
-    effect::SemanticUniformList m_leftMouseDownUniforms;
-    effect::SemanticUniformList m_middleMouseDownUniforms;
-    effect::SemanticUniformList m_rightMouseDownUniforms;
-    effect::SemanticUniformList m_controlObjectUniforms;
+    effect::UniformSlotIndexMap m_addingDiffuseImageBlendFactorUniforms;
+    effect::UniformSlotIndexMap m_addingSphereImageBlendFactorUniforms;
+    effect::UniformSlotIndexMap m_multiplyingDiffuseImageBlendFactorUniforms;
+    effect::UniformSlotIndexMap m_multiplyingSphereImageBlendFactorUniforms;
+    effect::UniformSlotIndexMap m_viewportPixelUniforms;
+    effect::UniformSlotIndexMap m_timeUniforms;
+    effect::UniformSlotIndexMap m_systemTimeUniforms;
+    effect::UniformSlotIndexMap m_elapsedTimeUniforms;
+    effect::UniformSlotIndexMap m_elapsedSystemTimeUniforms;
+    effect::UniformSlotIndexMap m_mousePositionUniforms;
+    effect::UniformSlotIndexMap m_leftMouseDownUniforms;
+    effect::UniformSlotIndexMap m_middleMouseDownUniforms;
+    effect::UniformSlotIndexMap m_rightMouseDownUniforms;
     effect::ControlObjectTargetMap m_controlObjectTargets;
     effect::SemanticUniformList m_textureResourceUniforms;
     effect::SemanticImageMap m_resourceImages;
@@ -481,6 +490,8 @@ private:
     effect::TechniqueList m_allTechniques;
     TechniqueListMap m_techniqueByPassTypes;
     PassUniformBufferMap m_passUniformBuffer;
+    effect::UniformSlotIndexMap m_uniformSlotIndices;
+    StringList m_uniformSlotNames;
     StagingBufferMap m_imageStagingBuffers;
     OverridenImageHandleMap m_overridenImageHandles;
     ImageSamplerMap m_imageSamplers;
@@ -13,6 +13,7 @@
 namespace nanoem {
 
 class Error;
+class ISeekableReader;
 class URI;
 
 class IAudioPlayer : private NonCopyable {
@@ -57,6 +58,7 @@ public:
 
     virtual bool load(const ByteArray &bytes, Error &error) = 0;
     virtual bool load(const ByteArray &bytes, const WAVDescription &desc, Error &error) = 0;
+    virtual bool load(ISeekableReader *reader, Error &error) = 0;
     virtual bool loadAllLinearPCMSamples(const nanoem_u8_t *data, size_t size, Error &error) = 0;
     virtual void play() = 0;
     virtual void playPart(nanoem_f64_t start, nanoem_f64_t length) = 0;
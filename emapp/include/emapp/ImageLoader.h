@@ -23,6 +23,14 @@ namespace image {
 
 class APNG {
 public:
+    /**
+     * Blends RGBA pixels of the source over the destination as APNG_BLEND_OP_OVER.
+     *
+     * Four pixels are blended at once with SIMD if enabled, which gives the same result as the scalar path.
+     */
+    static void blendPixelsOver(
+        const nanoem_u8_t *source, nanoem_u8_t *dest, nanoem_rsize_t numPixels, bool enableSIMD) NANOEM_DECL_NOEXCEPT;
+
     APNG();
     ~APNG() NANOEM_DECL_NOEXCEPT;
 
@@ -30,7 +38,17 @@ public:
     void composite(Error &error);
     nanoem_rsize_t findNearestOffset(nanoem_f32_t seconds) const NANOEM_DECL_NOEXCEPT;
 
-    const ByteArray *compositedFrameImage(nanoem_rsize_t offset) const NANOEM_DECL_NOEXCEPT;
+    /**
+     * Returns the composed frame image of the given offset.
+     *
+     * Frames are composed on demand from the current composition or the nearest cached keyframe composition,
+     * so the returned buffer is only valid until the next call.
+     */
+    const ByteArray *compositedFrameImage(nanoem_rsize_t offset);
+    nanoem_rsize_t numFrames() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t numKeyframeCompositions() const NANOEM_DECL_NOEXCEPT;
+    bool isFrameInflationEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setFrameInflationEnabled(bool value);
     nanoem_u32_t width() const NANOEM_DECL_NOEXCEPT;
     nanoem_u32_t height() const NANOEM_DECL_NOEXCEPT;
 
@@ -64,12 +82,20 @@ private:
     };
 #pragma pack(pop)
     struct Frame {
+        Frame()
+            : m_numSequences(0)
+            , m_seconds(0)
+        {
+        }
         FrameControl m_control;
-        ByteArrayList m_sequences;
-        ByteArray m_composition;
+        ByteArray m_data;
+        nanoem_u32_t m_numSequences;
         nanoem_f32_t m_seconds;
     };
     typedef tinystl::vector<Frame *, TinySTLAllocator> FrameSequenceList;
+    typedef tinystl::unordered_map<nanoem_rsize_t, ByteArray, TinySTLAllocator> CompositionMap;
+    static const nanoem_rsize_t kMaxNumKeyframeCompositions;
+    static const nanoem_rsize_t kInvalidOffset;
 
     enum DisposeOp {
         kDisposeOpNone = 0,
@@ -87,10 +113,21 @@ private:
     nanoem_u32_t decodeImageData(ISeekableReader *reader, nanoem_u32_t chunkLength, State &state, Error &error);
     nanoem_u32_t decodeImageEnd(State &state, Error &error);
     nanoem_u32_t decodeImageHeader(ISeekableReader *reader, State &state, Error &error);
+    void composeFrame(const Frame *frame, Error &error);
+    bool decodeFrameImage(const Frame *frame, Error &error);
+    bool inflateFrameImage(const Frame *frame);
+    bool decodeFrameImageWithSTB(const Frame *frame, Error &error);
 
     Header m_header;
     AnimationControl m_control;
     FrameSequenceList m_frames;
+    CompositionMap m_keyframeCompositions;
+    ByteArray m_composition;
+    ByteArray m_frameImage;
+    ByteArray m_inflatedFrameData;
+    nanoem_rsize_t m_compositionOffset;
+    nanoem_rsize_t m_keyframeInterval;
+    bool m_frameInflationEnabled;
 };
 
 class DDS {
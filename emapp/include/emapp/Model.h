@@ -43,6 +43,7 @@ class Project;
 class Vertex;
 
 namespace internal {
+class BoundingVolumeHierarchy;
 class LineDrawer;
 } /* namespace internal */
 
@@ -214,6 +215,11 @@ public:
     bool isStagingVertexBufferDirty() const NANOEM_DECL_NOEXCEPT;
     void markStagingVertexBufferDirty();
     void updateStagingVertexBuffer();
+    void markAllSpatialIndicesDirty();
+    void markVertexOverlayDirty(const nanoem_model_vertex_t *vertexPtr);
+    void collectAllVerticesInViewport(const Vector4SI32 &deviceScaleRect, VertexIndexList &vertexIndices);
+    void collectAllFacesInViewport(const Vector4SI32 &deviceScaleRect, VertexIndexList &faceIndices);
+    const Vector3 &skinnedVertexPosition(nanoem_rsize_t index);
     void resetLanguage();
     void registerUpdateActiveBoneTransformCommand(const Vector3 &translation, const Quaternion &orientation);
     void registerResetBoneSetTransformCommand(
@@ -362,6 +368,8 @@ public:
     void getAllImageViews(ImageViewMap &value) const NANOEM_DECL_OVERRIDE;
     URI resolveImageURI(const String &filename) const;
     BoundingBox boundingBox() const NANOEM_DECL_NOEXCEPT;
+    BoundingBox materialBoundingBox(const nanoem_model_material_t *materialPtr) const NANOEM_DECL_NOEXCEPT;
+    bool isMaterialCullable(const nanoem_model_material_t *materialPtr) const NANOEM_DECL_NOEXCEPT;
     String filename() const;
     const URI *fileURIPtr() const NANOEM_DECL_NOEXCEPT;
     URI fileURI() const NANOEM_DECL_OVERRIDE;
@@ -415,6 +423,8 @@ public:
     void setShowAllVertexWeights(bool value);
     bool isBlendingVertexWeightsEnabled() const NANOEM_DECL_NOEXCEPT;
     void setBlendingVertexWeightsEnabled(bool value);
+    bool isConstraintIterationTraceEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setConstraintIterationTraceEnabled(bool value);
     bool isGroundShadowEnabled() const NANOEM_DECL_NOEXCEPT;
     void setGroundShadowEnabled(bool value);
     bool isShadowMapEnabled() const NANOEM_DECL_NOEXCEPT;
@@ -443,6 +453,30 @@ private:
         ConstraintMap;
     typedef tinystl::unordered_map<nanoem_u32_t, Vector2UI16, TinySTLAllocator> ImageSizeMap;
     typedef tinystl::pair<int, model::Vertex::List> BoneVertexPair;
+    struct SkinnedVertexCache {
+        typedef tinystl::vector<Vector3, TinySTLAllocator> Vector3List;
+        SkinnedVertexCache();
+        ~SkinnedVertexCache() NANOEM_DECL_NOEXCEPT;
+        void resize(nanoem_rsize_t numVertices);
+        void store(
+            nanoem_rsize_t index, const bx::simd128_t &position, const bx::simd128_t &normal) NANOEM_DECL_NOEXCEPT;
+        Vector3List m_positions;
+        Vector3List m_normals;
+        nanoem_u32_t m_generation;
+    };
+    struct RigidBodyTransformCache {
+        typedef tinystl::vector<nanoem_physics_motion_state_t *, TinySTLAllocator> MotionStateList;
+        RigidBodyTransformCache();
+        void fetch(nanoem_model_rigid_body_t *const *rigidBodies, nanoem_rsize_t numRigidBodies,
+            bool includeWorldTransforms);
+        void flush();
+        PhysicsEngine *m_physicsEngine;
+        MotionStateList m_motionStates;
+        MotionStateList m_updatedMotionStates;
+        FloatList m_initialTransforms;
+        FloatList m_worldTransforms;
+        FloatList m_updatedWorldTransforms;
+    };
     struct ParallelSkinningTaskData {
         ParallelSkinningTaskData(Model *model, const IDrawable::DrawType type, nanoem_f32_t edgeSizeFactor);
         ~ParallelSkinningTaskData() NANOEM_DECL_NOEXCEPT;
@@ -450,17 +484,38 @@ private:
         const IDrawable::DrawType m_drawType;
         const nanoem_f32_t m_edgeSizeScaleFactor;
         model::Material::BoneIndexHashMap *m_boneIndices;
+        SkinnedVertexCache *m_skinnedVertexCache;
         nanoem_u8_t *m_output;
         nanoem_model_material_t *const *m_materials;
         nanoem_model_vertex_t *const *m_vertices;
         nanoem_rsize_t m_numVertices;
     };
+    struct DirtyVertexSet {
+        DirtyVertexSet();
+        void resize(nanoem_rsize_t numVertices);
+        void add(nanoem_rsize_t index);
+        void clear();
+        void destroy();
+        VertexIndexList m_indices;
+        ByteArray m_flags;
+        bool m_all;
+    };
     struct DrawArrayBuffer {
+        typedef tinystl::vector<sg_buffer, TinySTLAllocator> BufferList;
         DrawArrayBuffer();
         ~DrawArrayBuffer() NANOEM_DECL_NOEXCEPT;
+        void ensureInitialized(
+            const char *name, const char *kind, nanoem_rsize_t numVertices, nanoem_rsize_t numVertexUnits);
+        void markVertexUnitDirty(nanoem_rsize_t offset) NANOEM_DECL_NOEXCEPT;
+        void update(nanoem_rsize_t numVertexUnits, bool all);
+        void draw(internal::LineDrawer *drawer, nanoem_rsize_t numVertexUnits, sg_primitive_type type);
         void destroy();
         LineVertexList m_vertices;
-        sg_buffer m_buffer;
+        VertexIndexList m_vertexUnitOffsets;
+        BufferList m_buffers;
+        ByteArray m_dirtyChunks;
+        DirtyVertexSet m_dirtyVertices;
+        nanoem_u32_t m_skinnedVertexGeneration;
     };
     struct DrawIndexedBuffer {
         typedef nanoem_u32_t IndexType;
@@ -471,7 +526,7 @@ private:
         void ensureVertexBufferInitialized(const char *name, nanoem_rsize_t numVertices);
         void ensureIndexBufferInitialized(
             const char *name, const nanoem_u32_t *vertexIndices, nanoem_rsize_t numVertexIndices, bool line);
-        void update();
+        void update(bool updateVertices);
         void destroy();
         LineVertexList m_vertices;
         IndexList m_activeIndices;
@@ -479,11 +534,32 @@ private:
         sg_buffer m_indexBuffer;
         sg_buffer m_activeIndexBuffer;
         Vector4 m_color;
+        DirtyVertexSet m_dirtyVertices;
+        const nanoem_model_bone_t *m_activeBonePtr;
+        nanoem_u32_t m_skinnedVertexGeneration;
+        bool m_blendingEnabled;
     };
     struct OffscreenPassiveRenderTargetEffect {
         IEffect *m_passiveEffect;
         bool m_enabled;
     };
+    struct MaterialBound {
+        struct MorphOffset {
+            const nanoem_model_morph_t *m_morph;
+            /* max length of the vertex morph offsets of the material's vertices at weight 1 */
+            nanoem_f32_t m_length;
+        };
+        typedef tinystl::vector<const nanoem_model_bone_t *, TinySTLAllocator> BoneList;
+        typedef tinystl::vector<MorphOffset, TinySTLAllocator> MorphOffsetList;
+        MaterialBound();
+        BoneList m_bones;
+        MorphOffsetList m_morphOffsets;
+        BoundingBox m_boundingBox;
+        /* max distance from a vertex to its bones in the bind pose */
+        nanoem_f32_t m_radius;
+        nanoem_f32_t m_maxEdgeSize;
+        bool m_cullable;
+    };
     typedef tinystl::unordered_map<const par_shapes_mesh_s *, DrawIndexedBuffer, TinySTLAllocator> RigidBodyBuffers;
     typedef tinystl::unordered_map<const par_shapes_mesh_s *, DrawIndexedBuffer, TinySTLAllocator> JointBuffers;
     typedef tinystl::unordered_map<String, OffscreenPassiveRenderTargetEffect, TinySTLAllocator>
@@ -492,9 +568,11 @@ private:
         BoneBoundRigidBodyMap;
     typedef tinystl::unordered_map<const nanoem_model_bone_t *, const nanoem_model_constraint_t *, TinySTLAllocator>
         ResolveConstraintJointParentMap;
+    typedef tinystl::vector<MaterialBound, TinySTLAllocator> MaterialBoundList;
     typedef void (*DispatchParallelTasksIterator)(void *, size_t);
 
     static int compareBoneVertexList(const void *a, const void *b);
+    static int compareIndex(const void *a, const void *b);
     static void handlePerformSkinningVertexTransform(void *opaque, size_t index);
     static void setCommonPipelineDescription(sg_pipeline_desc &desc);
 
@@ -534,6 +612,9 @@ private:
         const String &prefix, const FileEntityMap &allAttachments, Archiver &archiver, Error &error);
     bool getVertexIndexBuffer(const model::Material *material, IPass::Buffer &buffer) const NANOEM_DECL_NOEXCEPT;
     bool getEdgeIndexBuffer(const model::Material *material, IPass::Buffer &buffer) const NANOEM_DECL_NOEXCEPT;
+    void rebuildAllMaterialBounds();
+    void updateAllMaterialBounds();
+    bool cullMaterial(nanoem_rsize_t index, model::Material *material, DrawType type, nanoem_f32_t margin);
     Vector4 connectionBoneColor(
         const nanoem_model_bone_t *bonePtr, const Vector4 &base, bool enableFixedAxis) const NANOEM_DECL_NOEXCEPT;
     Vector4 hoveredBoneColor(const Vector4 &inactive, bool selected) const NANOEM_DECL_NOEXCEPT;
@@ -544,6 +625,12 @@ private:
     void drawAllJointShapes();
     void drawAllRigidBodyShapes();
     void drawAllMaterialOverlays();
+    SkinnedVertexCache *prepareSkinnedVertexCache(nanoem_rsize_t numVertices);
+    const SkinnedVertexCache &skinnedVertexCache();
+    void collectAllBonesInWindow(const Vector2 &deviceScaleCursor, VertexIndexList &boneIndices) const;
+    bool isShowAnyVertexOverlays() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t packAllVertexUnits(
+        nanoem_rsize_t numVertexUnitsPerVertex, DrawArrayBuffer &buffer, bool &updateAll) const;
     void drawAllVertexNormals();
     void drawAllVertexPoints();
     void drawAllVertexFaces();
@@ -561,6 +648,9 @@ private:
     ICamera *m_camera;
     IModelObjectSelection *m_selection;
     internal::LineDrawer *m_drawer;
+    internal::BoundingVolumeHierarchy *m_vertexBoundingVolumes;
+    internal::BoundingVolumeHierarchy *m_faceBoundingVolumes;
+    mutable internal::BoundingVolumeHierarchy *m_boneBoundingVolumes;
     model::ISkinDeformer *m_skinDeformer;
     model::IGizmo *m_gizmo;
     model::IVertexWeightPainter *m_vertexWeightPainter;
@@ -569,6 +659,8 @@ private:
     DrawArrayBuffer m_drawAllVertexPoints;
     DrawIndexedBuffer m_drawAllVertexFaces;
     DrawIndexedBuffer m_drawAllVertexWeights;
+    SkinnedVertexCache m_skinnedVertexCache;
+    RigidBodyTransformCache m_rigidBodyTransformCache;
     RigidBodyBuffers m_drawRigidBody;
     JointBuffers m_drawJoint;
     nanoem_model_t *m_opaque;
@@ -601,6 +693,7 @@ private:
     model::Bone::ListTree m_parentBoneTree;
     model::Bone *m_sharedFallbackBone;
     BoundingBox m_boundingBox;
+    MaterialBoundList m_materialBounds;
     UserData m_userData;
     StringMap m_annotations;
     sg_buffer m_vertexBuffers[2];
@@ -619,6 +712,11 @@ private:
     void *m_dispatchParallelTaskQueue;
     mutable int m_countVertexSkinningNeeded;
     int m_stageVertexBufferIndex;
+    nanoem_u32_t m_skinnedVertexGeneration;
+    nanoem_u32_t m_vertexBoundingVolumesGeneration;
+    nanoem_u32_t m_faceBoundingVolumesGeneration;
+    mutable nanoem_u32_t m_boneBoundingVolumesGeneration;
+    nanoem_u32_t m_boneTransformGeneration;
 };
 
 } /* namespace nanoem */
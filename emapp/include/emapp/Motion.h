@@ -165,6 +165,7 @@ public:
     void writeLoadModelCommandMessage(nanoem_u16_t handle, const URI &fileURI, Error &error);
     void mergeAllKeyframes(const Motion *source);
     void overrideAllKeyframes(const Motion *source, bool reverse);
+    void overrideAllKeyframes(const Motion *source, nanoem_frame_index_t offset, bool reverse);
     void clearAllKeyframes();
     void correctAllSelectedBoneKeyframes(
         const CorrectionVectorFactor &translation, const CorrectionVectorFactor &orientation);
@@ -172,12 +173,10 @@ public:
         const CorrectionScalarFactor &distance);
     void correctAllSelectedMorphKeyframes(const CorrectionScalarFactor &weight);
     void scaleAllAccessoryKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor);
-    void scaleAllBoneKeyframesIn(
-        const Model *model, nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor);
+    void scaleAllBoneKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor);
     void scaleAllLightKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor);
     void scaleAllModelKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor);
-    void scaleAllMorphKeyframesIn(
-        const Model *model, nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor);
+    void scaleAllMorphKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor);
     void scaleAllSelfShadowKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor);
     void selectAllModelObjectKeyframes(const Model *model);
     bool testAllMissingModelObjects(const Model *model, StringSet &bones, StringSet &morphs) const;
@@ -231,12 +230,16 @@ public:
         const nanoem_motion_model_keyframe_t *next, nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT;
     static nanoem_f32_t coefficient(const nanoem_motion_morph_keyframe_t *prev,
         const nanoem_motion_morph_keyframe_t *next, nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT;
-    nanoem_f32_t bezierCurve(const nanoem_motion_bone_keyframe_t *prev, const nanoem_motion_bone_keyframe_t *next,
-        nanoem_motion_bone_keyframe_interpolation_type_t index, nanoem_f32_t value) const;
+    Vector4 bezierCurves(const nanoem_motion_bone_keyframe_t *prev, const nanoem_motion_bone_keyframe_t *next,
+        nanoem_f32_t value) const;
+    void bezierCurves(const nanoem_motion_camera_keyframe_t *prev, const nanoem_motion_camera_keyframe_t *next,
+        nanoem_f32_t value, nanoem_f32_t *values) const;
 
 private:
-    typedef tinystl::unordered_map<const nanoem_motion_bone_keyframe_t *, BezierCurve *, TinySTLAllocator>
-        KeyframeBezierCurveMap;
+    typedef tinystl::unordered_map<const nanoem_motion_bone_keyframe_t *, PackedBezierCurve *, TinySTLAllocator>
+        BoneKeyframePackedBezierCurveMap;
+    typedef tinystl::unordered_map<const nanoem_motion_camera_keyframe_t *, PackedBezierCurve *, TinySTLAllocator>
+        CameraKeyframePackedBezierCurveMap;
     static nanoem_f32_t coefficient(nanoem_frame_index_t prevFrameIndex, nanoem_frame_index_t nextFrameIndex,
         nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT;
     static void copyAccessoryOutsideParent(const nanoem_motion_accessory_keyframe_t *keyframe,
@@ -247,13 +250,17 @@ private:
         const Model *model, nanoem_mutable_motion_t *motion, int offset, nanoem_status_t &status);
     void internalWriteLoadCommandMessage(nanoem_u32_t type, nanoem_u16_t handle, const URI &fileURI, Error &error);
     bool internalSave(nanoem_mutable_motion_t *mutableMotion, IWriter *bytes, Error &error) const;
-    void internalMergeAllKeyframes(const Motion *source, bool _override, bool reverse);
+    void internalMergeAllKeyframes(const Motion *source, nanoem_frame_index_t offset, bool _override, bool reverse);
+    void internalScaleAllKeyframesIn(
+        nanoem_u32_t type, nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor);
+    void destroyAllPackedBezierCurves();
+    void destroyAllStalePackedBezierCurves();
 
     Project *m_project;
     IMotionKeyframeSelection *m_selection;
     nanoem_motion_t *m_opaque;
-    mutable BezierCurve::Map m_bezierCurvesData;
-    mutable KeyframeBezierCurveMap m_keyframeBezierCurves;
+    mutable BoneKeyframePackedBezierCurveMap m_boneKeyframePackedBezierCurves;
+    mutable CameraKeyframePackedBezierCurveMap m_cameraKeyframePackedBezierCurves;
     StringMap m_annotations;
     URI m_fileURI;
     nanoem_motion_format_type_t m_formatType;
@@ -84,13 +84,6 @@ public:
     void setDirty(bool value) NANOEM_DECL_OVERRIDE;
 
 private:
-    nanoem_f32_t bezierCurve(const nanoem_motion_camera_keyframe_t *prev, const nanoem_motion_camera_keyframe_t *next,
-        nanoem_motion_camera_keyframe_interpolation_type_t index, nanoem_f32_t value) const;
-
-    typedef tinystl::unordered_map<const nanoem_motion_camera_keyframe_t *, BezierCurve *, TinySTLAllocator>
-        KeyframeBezierCurveMap;
-    mutable BezierCurve::Map m_bezierCurvesData;
-    mutable KeyframeBezierCurveMap m_keyframeBezierCurves;
     Project *m_project;
     undo_stack_t *m_undoStack;
     StringPair m_outsideParent;
@@ -92,6 +92,12 @@ public:
         const nanoem_physics_motion_state_t *state, nanoem_f32_t *value) const NANOEM_DECL_NOEXCEPT;
     void getWorldTransform(const nanoem_physics_motion_state_t *state, nanoem_f32_t *value) const NANOEM_DECL_NOEXCEPT;
     void setWorldTransform(nanoem_physics_motion_state_t *state, const nanoem_f32_t *value);
+    void getAllInitialTransforms(nanoem_physics_motion_state_t *const *states, nanoem_rsize_t numStates,
+        nanoem_f32_t *values) const NANOEM_DECL_NOEXCEPT;
+    void getAllWorldTransforms(nanoem_physics_motion_state_t *const *states, nanoem_rsize_t numStates,
+        nanoem_f32_t *values) const NANOEM_DECL_NOEXCEPT;
+    void setAllWorldTransforms(
+        nanoem_physics_motion_state_t *const *states, nanoem_rsize_t numStates, const nanoem_f32_t *values);
     void getCenterOfMassOffset(const nanoem_physics_motion_state_t *state, nanoem_f32_t *value) NANOEM_DECL_NOEXCEPT;
     void setCenterOfMassOffset(nanoem_physics_motion_state_t *state, const nanoem_f32_t *value) NANOEM_DECL_NOEXCEPT;
 
@@ -120,6 +126,14 @@ public:
         const nanoem_physics_soft_body_t *body, int offset, nanoem_f32_t *value) const NANOEM_DECL_NOEXCEPT;
     void setSoftBodyVertexPosition(nanoem_physics_soft_body_t *body, int offset, const nanoem_f32_t *value);
     void setSoftBodyVertexNormal(nanoem_physics_soft_body_t *body, int offset, const nanoem_f32_t *value);
+    void getAllSoftBodyVertexPositions(
+        const nanoem_physics_soft_body_t *body, nanoem_f32_t *values) const NANOEM_DECL_NOEXCEPT;
+    void getAllSoftBodyVertexNormals(
+        const nanoem_physics_soft_body_t *body, nanoem_f32_t *values) const NANOEM_DECL_NOEXCEPT;
+    void setAllSoftBodyVertexPositions(
+        nanoem_physics_soft_body_t *body, const int *offsets, nanoem_rsize_t numOffsets, const nanoem_f32_t *values);
+    void setAllSoftBodyVertexNormals(
+        nanoem_physics_soft_body_t *body, const int *offsets, nanoem_rsize_t numOffsets, const nanoem_f32_t *values);
 
     Vector3 direction() const NANOEM_DECL_NOEXCEPT;
     void setDirection(const Vector3 &value);
@@ -0,0 +1,57 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_PROFILER_H_
+#define NANOEM_EMAPP_PROFILER_H_
+
+#include "emapp/Forward.h"
+
+namespace nanoem {
+
+class Error;
+class IWriter;
+class URI;
+
+/**
+ * Records nested CPU scopes into per thread ring buffers and exports them as Chrome trace events.
+ *
+ * Scopes are always compiled in and cost only one flag test while the profiler is disabled. Each thread writes
+ * to its own buffer without locks, so exporting should be done while profiled threads are idle.
+ */
+class Profiler NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    struct Event;
+    struct ThreadBuffer;
+    class Scope NANOEM_DECL_SEALED : private NonCopyable {
+    public:
+        Scope(const char *name) NANOEM_DECL_NOEXCEPT;
+        ~Scope() NANOEM_DECL_NOEXCEPT;
+
+    private:
+        const char *m_name;
+        nanoem_u64_t m_start;
+    };
+
+    static const nanoem_rsize_t kNumRingBufferEvents;
+
+    static bool isEnabled() NANOEM_DECL_NOEXCEPT;
+    static void setEnabled(bool value);
+    static void clear() NANOEM_DECL_NOEXCEPT;
+    static void terminate();
+    static bool exportChromeTrace(IWriter *writer, Error &error);
+    static bool exportChromeTrace(const URI &fileURI, Error &error);
+
+private:
+    static ThreadBuffer *currentThreadBuffer();
+};
+
+} /* namespace nanoem */
+
+/* name must be a string literal since only its pointer is recorded */
+#define EMAPP_PROFILE_SCOPE(name) nanoem::Profiler::Scope BX_CONCATENATE(__emapp_profile_scope_, __LINE__)(name)
+
+#endif /* NANOEM_EMAPP_PROFILER_H_ */
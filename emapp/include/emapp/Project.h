@@ -48,6 +48,7 @@ class IEventPublisher;
 class IFileManager;
 class IImageView;
 class ILight;
+class IPass;
 class IPrimitive2D;
 class ITrack;
 class ImageLoader;
@@ -77,6 +78,9 @@ namespace internal {
 class BlitPass;
 class ClearPass;
 class DebugDrawer;
+class DrawCommandScheduler;
+class FileContentDigestCache;
+class FrustumCuller;
 } /* namespace internal */
 
 class Project NANOEM_DECL_SEALED : private NonCopyable {
@@ -195,6 +199,16 @@ public:
         virtual void addNotFoundFileURI(const URI &fileURI) = 0;
         virtual void addDigestMismatchFileURI(const URI &fileURI) = 0;
     };
+    struct OffscreenRenderTargetPlan {
+        struct Item {
+            IDrawable *m_drawable;
+            IEffect *m_passiveEffect;
+        };
+        typedef tinystl::vector<Item, TinySTLAllocator> ItemList;
+        effect::OffscreenRenderTargetOption m_option;
+        sg_pass m_pass;
+        ItemList m_items;
+    };
 
     typedef tinystl::pair<nanoem_frame_index_t, int> TransformPerformIndex;
     typedef tinystl::unordered_set<nanoem_rsize_t, TinySTLAllocator> ModelMaterialIndexSet;
@@ -209,6 +223,7 @@ public:
     typedef tinystl::unordered_map<String, ByteArray, TinySTLAllocator> IncludeEffectSourceMap;
     typedef tinystl::unordered_map<IDrawable *, Motion *, TinySTLAllocator> MotionHashMap;
     typedef tinystl::unordered_map<nanoem_u32_t, String, TinySTLAllocator> SGHandleStringMap;
+    typedef tinystl::vector<OffscreenRenderTargetPlan, TinySTLAllocator> OffscreenRenderTargetPlanList;
 
     static const char *const kRedoLogFileExtension;
     static const char *const kArchivedNativeFormatFileExtension;
@@ -297,6 +312,8 @@ public:
     Effect *resolveEffect(IDrawable *drawable) NANOEM_DECL_NOEXCEPT;
     const nanoem_model_bone_t *resolveBone(const StringPair &value) const NANOEM_DECL_NOEXCEPT;
     bool containsMotion(const Motion *value) const NANOEM_DECL_NOEXCEPT;
+    nanoem_u32_t objectBindingGeneration() const NANOEM_DECL_NOEXCEPT;
+    void invalidateAllObjectBindings() NANOEM_DECL_NOEXCEPT;
 
     void newModel(Error &error);
     void addModel(Model *model);
@@ -358,17 +375,22 @@ public:
         nanoem_frame_index_t frameIndex, nanoem_f32_t amount, PhysicsEngine::SimulationTimingType timing);
     void setRenderPassName(sg_pass pass, const char *value);
     void setRenderPipelineName(sg_pipeline pipeline, const char *value);
+    void setRenderPipelineSortable(sg_pipeline pipeline, const sg_pipeline_desc &desc, const IPass *pass);
     sg_image sharedFallbackImage() const NANOEM_DECL_NOEXCEPT;
     sg::PassBlock::IDrawQueue *sharedBatchDrawQueue() NANOEM_DECL_NOEXCEPT;
     sg::PassBlock::IDrawQueue *sharedSerialDrawQueue() NANOEM_DECL_NOEXCEPT;
     ImageLoader *sharedImageLoader();
     internal::BlitPass *sharedImageBlitter();
     internal::DebugDrawer *sharedDebugDrawer();
+    const internal::FrustumCuller *frustumCuller() const NANOEM_DECL_NOEXCEPT;
+    internal::FrustumCuller *frustumCuller() NANOEM_DECL_NOEXCEPT;
+    internal::FileContentDigestCache *fileContentDigestCache() NANOEM_DECL_NOEXCEPT;
 
     void drawAllOffscreenRenderTargets();
     void drawShadowMap();
     void drawViewport();
     void flushAllCommandBuffers();
+    const internal::DrawCommandScheduler *drawCommandScheduler() const NANOEM_DECL_NOEXCEPT;
 
     sg_pass beginRenderPass(sg_pass pass);
     void blitRenderPass(sg::PassBlock::IDrawQueue *drawQueue, sg_pass destRenderPass, sg_pass sourceRenderPass);
@@ -402,6 +424,8 @@ public:
     void attachEffectToSelectedDrawable(Effect *effect, Error &error);
     void attachModelMaterialEffect(model::Material *material, Effect *effect);
     void setOffscreenPassiveRenderTargetEffect(const String &name, IDrawable *drawable, Effect *targetEffect);
+    const OffscreenRenderTargetPlanList &resolveOffscreenRenderTargetPlans(Effect *ownerEffect);
+    void invalidateAllOffscreenRenderTargetPlans() NANOEM_DECL_NOEXCEPT;
 
     void setRedoDrawable(nanoem_u32_t key, IDrawable *value);
     Accessory *resolveRedoAccessory(nanoem_u32_t key);
@@ -783,6 +807,11 @@ private:
         bool m_hidden;
         bool m_none;
     };
+    struct BoneClipboardItem {
+        String m_name;
+        Vector3 m_translation;
+        Quaternion m_orientation;
+    };
 
     typedef tinystl::unordered_set<IDrawable *, TinySTLAllocator> DrawableSet;
     typedef tinystl::unordered_map<nanoem_u16_t, Accessory *, TinySTLAllocator> AccessoryHandleMap;
@@ -807,6 +836,9 @@ private:
         SortedOffscreenRenderTargetOptionList;
     typedef tinystl::unordered_map<String, tinystl::pair<Effect *, int>, TinySTLAllocator> EffectReferenceMap;
     typedef tinystl::pair<String, DrawableSet> OffscreenRenderTargetDrawableSet;
+    typedef tinystl::vector<BoneClipboardItem, TinySTLAllocator> BoneClipboardItemList;
+    typedef tinystl::unordered_map<const Effect *, OffscreenRenderTargetPlanList, TinySTLAllocator>
+        OffscreenRenderTargetPlanMap;
 
     static Vector4UI16 internalQueryRectangle(RectangleType type, const Vector4UI16 &viewportRect,
         const Vector2UI16 &offset, nanoem_f32_t deviceScaleRatio) NANOEM_DECL_NOEXCEPT;
@@ -855,7 +887,7 @@ private:
     sg_pass registerRenderPass(const sg_pass_desc &desc, const PixelFormat &format, RenderPassBundle *&descPtrRef);
     void resetOffscreenRenderTarget(const Effect *ownerEffect, const effect::OffscreenRenderTargetOption &option);
     void drawOffscreenRenderTarget(Effect *ownerEffect);
-    void drawObjectToOffscreenRenderTarget(IDrawable *drawable, Effect *ownerEffect, const String &name);
+    void drawObjectToOffscreenRenderTarget(IDrawable *drawable, Effect *ownerEffect, IEffect *passiveEffect);
     void drawAllEffectsDependsOnScriptExternal();
     void getAllOffscreenRenderTargetOptions(const Effect *ownerEffect, effect::OffscreenRenderTargetOptionList &value,
         SortedOffscreenRenderTargetOptionList &sorted) const;
@@ -921,6 +953,8 @@ private:
     internal::BlitPass *m_sharedImageBlitter;
     internal::ClearPass *m_renderPassCleaner;
     internal::DebugDrawer *m_sharedDebugDrawer;
+    internal::FrustumCuller *m_frustumCuller;
+    internal::FileContentDigestCache *m_fileContentDigestCache;
     tinystl::pair<sg_pixel_format, sg_pixel_format> m_viewportPixelFormat;
     model::BindPose m_lastBindPose;
     model::RigidBody::VisualizationClause m_rigidBodyVisualizationClause;
@@ -953,6 +987,7 @@ private:
     Vector4 m_viewportBackgroundColor;
     OffscreenRenderTargetConditionListMap m_allOffscreenRenderTargets;
     OffscreenRenderTargetEffectSetMap m_allOffscreenRenderTargetEffectSets;
+    OffscreenRenderTargetPlanMap m_offscreenRenderTargetPlans;
     sg_image m_fallbackImage;
     bx::HandleAlloc *m_objectHandleAllocator;
     AccessoryHandleMap m_accessoryHandleMap;
@@ -970,8 +1005,8 @@ private:
     nanoem_u32_t m_editingFPS;
     nanoem_motion_bone_keyframe_interpolation_type_t m_boneInterpolationType;
     nanoem_motion_camera_keyframe_interpolation_type_t m_cameraInterpolationType;
-    ByteArray m_modelClipboard;
-    ByteArray m_motionClipboard;
+    BoneClipboardItemList m_modelClipboard;
+    Motion *m_motionClipboard;
     EffectOrderSet m_effectOrderSet;
     EffectReferenceMap m_effectReferences;
     LoadedEffectSet m_loadedEffectSet;
@@ -993,6 +1028,8 @@ private:
     nanoem_u32_t m_cursorModifiers;
     nanoem_u32_t m_actualFPS;
     nanoem_u32_t m_actionSequence;
+    nanoem_u32_t m_objectBindingGeneration;
+    bool m_offscreenRenderTargetPlansDirty;
     bool m_active;
 };
 
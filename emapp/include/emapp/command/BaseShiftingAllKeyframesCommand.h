@@ -46,36 +46,21 @@ private:
     typedef tinystl::vector<nanoem_mutable_motion_self_shadow_keyframe_t *, TinySTLAllocator>
         MutableSelfShadowKeyframeList;
 
-    void shiftAllAccessoryKeyframesBackward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllBoneKeyframesBackward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllCameraKeyframesBackward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllLightKeyframesBackward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllModelKeyframesBackward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllMorphKeyframesBackward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllSelfShadowKeyframesBackward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-
-    void shiftAllAccessoryKeyframesForward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllBoneKeyframesForward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllCameraKeyframesForward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllLightKeyframesForward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllModelKeyframesForward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllMorphKeyframesForward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-    void shiftAllSelfShadowKeyframesForward(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
-
-    void shiftAllAccessoryKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-        const MutableAccessoryKeyframeList &keyframes, int offset, nanoem_status_t *status);
-    void shiftAllBoneKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-        const MutableModelBoneKeyframeList &keyframes, int offset, nanoem_status_t *status);
-    void shiftAllCameraKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-        const MutableCameraKeyframeList &keyframes, int offset, nanoem_status_t *status);
-    void shiftAllLightKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-        const MutableLightKeyframeList &keyframes, int offset, nanoem_status_t *status);
-    void shiftAllModelKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-        const MutableModelKeyframeList &keyframes, int offset, nanoem_status_t *status);
-    void shiftAllMorphKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-        const MutableModelMorphKeyframeList &keyframes, int offset, nanoem_status_t *status);
-    void shiftAllSelfShadowKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-        const MutableSelfShadowKeyframeList &keyframes, int offset, nanoem_status_t *status);
+    void restoreAllAccessoryKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void restoreAllBoneKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void restoreAllCameraKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void restoreAllLightKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void restoreAllModelKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void restoreAllMorphKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void restoreAllSelfShadowKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+
+    void removeAllAccessoryKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void removeAllBoneKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void removeAllCameraKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void removeAllLightKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void removeAllModelKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void removeAllMorphKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
+    void removeAllSelfShadowKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status);
 
     MutableAccessoryKeyframeList m_accessoryKeyframes;
     MutableModelBoneKeyframeList m_boneKeyframes;
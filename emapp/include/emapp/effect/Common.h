@@ -15,7 +15,9 @@
 
 namespace nanoem {
 
+class Accessory;
 class Effect;
+class Model;
 class PixelFormat;
 struct APNGImage;
 
@@ -155,6 +157,20 @@ struct PassRegisterIndexMap {
     RegisterIndexMap m_pixelPreshader;
 };
 typedef tinystl::unordered_map<nanoem_u32_t, nanoem_u32_t, TinySTLAllocator> UniformBufferOffsetMap;
+struct UniformSlot {
+    enum RegisterType {
+        kRegisterTypeFirstEnum,
+        kRegisterTypeVertexPreshader = kRegisterTypeFirstEnum,
+        kRegisterTypePixelPreshader,
+        kRegisterTypeVertexShader,
+        kRegisterTypePixelShader,
+        kRegisterTypeMaxEnum
+    };
+    static const nanoem_u32_t kInvalidIndex;
+    RegisterIndex m_registerIndices[kRegisterTypeMaxEnum];
+};
+typedef tinystl::vector<UniformSlot, TinySTLAllocator> UniformSlotList;
+typedef tinystl::unordered_map<String, nanoem_u32_t, TinySTLAllocator> UniformSlotIndexMap;
 
 struct ScriptIndex {
     static const ScriptIndex kInvalid;
@@ -191,14 +207,50 @@ struct Preshader {
         nanoem_u32_t m_index;
         nanoem_u32_t m_set;
     };
+    enum RegisterFileType {
+        kRegisterFileTypeFirstEnum,
+        kRegisterFileTypeInput = kRegisterFileTypeFirstEnum,
+        kRegisterFileTypeOutput,
+        kRegisterFileTypeLiteral,
+        kRegisterFileTypeTemporary,
+        kRegisterFileTypeNone,
+        kRegisterFileTypeMaxEnum
+    };
+    struct Source {
+        nanoem_u32_t m_fileType;
+        nanoem_u32_t m_offset;
+        nanoem_u32_t m_stride;
+        nanoem_u32_t m_dotOffset;
+        nanoem_u32_t m_dotStride;
+    };
+    /* decoded instruction of which operand types and indices are resolved to register file offsets */
+    struct Operation {
+        nanoem_u32_t m_opcode;
+        nanoem_u32_t m_numElements;
+        Source m_sources[3];
+        nanoem_u32_t m_destinationFileType;
+        nanoem_u32_t m_destinationOffset;
+    };
     Preshader();
     ~Preshader() NANOEM_DECL_NOEXCEPT;
-    void execute(const GlobalUniform::Buffer &inputBuffer, GlobalUniform::Buffer &outputBuffer) const;
+    void compile();
+    void execute(const GlobalUniform::Buffer &inputBuffer, GlobalUniform::Buffer &outputBuffer);
+    void interpret(const GlobalUniform::Buffer &inputBuffer, GlobalUniform::Buffer &outputBuffer) const;
 
     tinystl::vector<Instruction, TinySTLAllocator> m_instructions;
     tinystl::vector<Symbol, TinySTLAllocator> m_symbols;
     tinystl::vector<nanoem_f32_t, TinySTLAllocator> m_literals;
+    tinystl::vector<Operation, TinySTLAllocator> m_operations;
+    tinystl::vector<nanoem_f32_t, TinySTLAllocator> m_temporaryRegisters;
+    tinystl::vector<nanoem_u32_t, TinySTLAllocator> m_inputDependencies;
+    tinystl::vector<nanoem_u32_t, TinySTLAllocator> m_outputDependencies;
+    tinystl::vector<nanoem_u32_t, TinySTLAllocator> m_writtenOutputs;
+    tinystl::vector<nanoem_f32_t, TinySTLAllocator> m_cachedDependencies;
+    tinystl::vector<nanoem_f32_t, TinySTLAllocator> m_cachedOutputs;
     nanoem_u32_t m_numTemporaryRegisters;
+    nanoem_u32_t m_numEvaluations;
+    bool m_compiled;
+    bool m_cached;
 };
 
 struct PreshaderPair {
@@ -263,6 +315,7 @@ struct NonSemanticParameter : AnnotatableParameter {
     NonSemanticParameter(
         const String &name, const GlobalUniform::Vector4List &values, const AnnotationMap &annotations);
     tinystl::vector<Vector4, TinySTLAllocator> m_values;
+    nanoem_u32_t m_uniformSlotIndex;
 };
 
 struct TypedSemanticParameter : AnnotatableParameter {
@@ -337,6 +390,7 @@ struct MatrixUniform {
     const MatrixType m_type;
     const bool m_inversed;
     const bool m_transposed;
+    nanoem_u32_t m_uniformSlotIndex;
 };
 typedef tinystl::unordered_map<String, MatrixUniform, TinySTLAllocator> MatrixUniformMap;
 
@@ -352,12 +406,29 @@ typedef tinystl::vector<ImageSampler, TinySTLAllocator> ImageSamplerList;
 typedef tinystl::vector<tinystl::pair<ScriptCommandType, String>, TinySTLAllocator> ScriptCommandMap;
 
 struct ControlObjectTarget {
+    enum ObjectType {
+        kObjectTypeFirstEnum,
+        kObjectTypeSelf = kObjectTypeFirstEnum,
+        kObjectTypeOffscreenOwner,
+        kObjectTypeFilename,
+        kObjectTypeMaxEnum
+    };
     ControlObjectTarget(const String &name, ParameterType type);
     ~ControlObjectTarget() NANOEM_DECL_NOEXCEPT;
     const String m_name;
     const ParameterType m_type;
+    const ObjectType m_objectType;
     String m_item;
     Vector4 m_value;
+    /* resolved by filename and valid while m_objectGeneration equals to Project::objectBindingGeneration */
+    const Model *m_modelPtr;
+    const Accessory *m_accessoryPtr;
+    nanoem_u32_t m_objectGeneration;
+    /* resolved by m_item of m_itemModelPtr and valid while m_itemGeneration equals to the same as above */
+    const Model *m_itemModelPtr;
+    const nanoem_model_bone_t *m_bonePtr;
+    const nanoem_model_morph_t *m_morphPtr;
+    nanoem_u32_t m_itemGeneration;
 };
 typedef tinystl::unordered_map<String, ControlObjectTarget, TinySTLAllocator> ControlObjectTargetMap;
 
@@ -24,6 +24,16 @@ struct GlobalUniform {
     static const int kMaxPixelShaderUniformVectorsInt = 32;
     static const int kMaxPixelShaderUniformVectorsFloat = 192;
 
+    enum BlockType {
+        kBlockTypeFirstEnum,
+        kBlockTypeGlobal = kBlockTypeFirstEnum,
+        kBlockTypeCamera,
+        kBlockTypeLight,
+        kBlockTypeDrawable,
+        kBlockTypeShadowMap,
+        kBlockTypeMaxEnum
+    };
+
     struct Buffer {
         Buffer(sg_shader_stage stage);
         ~Buffer() NANOEM_DECL_NOEXCEPT;
@@ -36,13 +46,38 @@ struct GlobalUniform {
         Vector4List m_float4;
     };
 
+    struct Block {
+        Block();
+        const void *m_object;
+        Matrix4x4 m_parameter;
+        bool m_retained;
+    };
+
     GlobalUniform();
     ~GlobalUniform() NANOEM_DECL_NOEXCEPT;
 
+    /**
+     * Makes the pass drawing the drawable own both shader buffers.
+     *
+     * Buffers are kept across draws while the owner is the same so frame scoped and drawable scoped
+     * parameter blocks are written only once and only material specific ones are written per material.
+     */
+    void acquire(const void *owner, const void *drawable);
+    /* returns true if the block of the owner is already written with the same object and parameter */
+    bool retain(BlockType type, const void *owner, const void *object, const Matrix4x4 &parameter);
+    void invalidate(BlockType type) NANOEM_DECL_NOEXCEPT;
+    void invalidateAll() NANOEM_DECL_NOEXCEPT;
+    void endFrame() NANOEM_DECL_NOEXCEPT;
+
     Buffer m_vertexShaderBuffer;
     Buffer m_pixelShaderBuffer;
     Buffer m_preshaderVertexShaderBuffer;
     Buffer m_preshaderPixelShaderBuffer;
+    Block m_blocks[kBlockTypeMaxEnum];
+    const void *m_owner;
+    const void *m_drawable;
+    nanoem_u64_t m_numWrittenBytes;
+    nanoem_u64_t m_numLastFrameWrittenBytes;
 };
 
 } /* namespace effect */
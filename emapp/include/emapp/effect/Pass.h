@@ -66,6 +66,7 @@ public:
     nanoem_u8_t pixelShaderImageCount() const NANOEM_DECL_NOEXCEPT;
 
     const PipelineDescriptor &pipelineDescriptor() const NANOEM_DECL_NOEXCEPT;
+    const PreshaderPair &preshaderPair() const NANOEM_DECL_NOEXCEPT;
     void setParentTechnique(Technique *value);
     void setRenderTargetIndexOffset(size_t value);
     void setTechniqueScriptIndex(size_t value);
@@ -75,9 +76,12 @@ public:
     bool findPixelShaderRegisterIndex(const String &name, RegisterIndex &index) const;
     bool findVertexShaderSamplerRegisterIndex(const String &name, SamplerRegisterIndex::List &samplerIndices) const;
     bool findPixelShaderSamplerRegisterIndex(const String &name, SamplerRegisterIndex::List &samplerIndices) const;
+    const UniformSlot *findUniformSlot(nanoem_u32_t index) const NANOEM_DECL_NOEXCEPT;
 
 private:
     typedef tinystl::unordered_map<nanoem_u32_t, sg_pipeline, TinySTLAllocator> PipelineSet;
+    void resolveAllUniformSlots(const RegisterIndexMap &indices, UniformSlot::RegisterType type);
+
     const String m_name;
     const PassRegisterIndexMap m_registerIndices;
     const UniformBufferOffsetMap m_vertexShaderRegisterUniformBufferOffsetMap;
@@ -89,6 +93,7 @@ private:
     Effect *m_effect;
     Technique *m_techniquePtr;
     PipelineSet m_pipelineSet;
+    UniformSlotList m_uniformSlots;
     ScriptCommandMap m_script;
     PreshaderPair m_preshaderPair;
     RenderPassScope m_renderTargetNormalizerScope;
@@ -0,0 +1,66 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_INTERNAL_BOUNDINGVOLUMEHIERARCHY_H_
+#define NANOEM_EMAPP_INTERNAL_BOUNDINGVOLUMEHIERARCHY_H_
+
+#include "emapp/Forward.h"
+
+namespace nanoem {
+namespace internal {
+
+/**
+ * Axis aligned bounding volume hierarchy of points (vertices or faces) to find candidates of picking.
+ *
+ * The tree topology is built once and only node bounds are recomputed by refit when points are moved
+ * so it must be rebuilt when the number of points is changed.
+ */
+class BoundingVolumeHierarchy NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    typedef tinystl::vector<Vector3, TinySTLAllocator> PointList;
+    typedef tinystl::vector<nanoem_u32_t, TinySTLAllocator> IndexList;
+    class ICuller {
+    public:
+        virtual ~ICuller() NANOEM_DECL_NOEXCEPT
+        {
+        }
+        virtual bool intersects(const Vector3 &aabbMin, const Vector3 &aabbMax) const NANOEM_DECL_NOEXCEPT = 0;
+    };
+    static const nanoem_u32_t kMaxLeafPoints = 16;
+
+    BoundingVolumeHierarchy();
+    ~BoundingVolumeHierarchy() NANOEM_DECL_NOEXCEPT;
+
+    void build(const PointList &points);
+    void refit(const PointList &points);
+    void query(const ICuller *culler, IndexList &indices) const;
+    void clear();
+
+    nanoem_rsize_t numPoints() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t numNodes() const NANOEM_DECL_NOEXCEPT;
+
+private:
+    struct Node {
+        Vector3 m_aabbMin;
+        Vector3 m_aabbMax;
+        /* first point offset of a leaf or right child node index of a branch */
+        nanoem_u32_t m_offset;
+        /* zero if the node is a branch and its left child is always next to the node */
+        nanoem_u32_t m_count;
+    };
+    typedef tinystl::vector<Node, TinySTLAllocator> NodeList;
+
+    nanoem_u32_t buildNode(const PointList &points, nanoem_u32_t begin, nanoem_u32_t end);
+
+    NodeList m_nodes;
+    IndexList m_indices;
+};
+
+} /* namespace internal */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_INTERNAL_BOUNDINGVOLUMEHIERARCHY_H_ */
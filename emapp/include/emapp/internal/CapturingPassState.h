@@ -89,6 +89,8 @@ protected:
 
     bool prepareCapturingViewport(Project *project);
     void readPassImage();
+    void readPassImage(nanoem_u8_t *data);
+    void copyFrameImage(const void *source, nanoem_u8_t *dest) const;
     void blitOutputPass();
     void incrementAsyncCount();
     void decrementAsyncCount();
@@ -190,7 +192,7 @@ private:
         nanoem_frame_index_t videoPTS, nanoem_frame_index_t durationFrameIndices, nanoem_f32_t deltaScaleFactor,
         Error &error);
     bool encodeVideoFrame(
-        const ByteArray &frameData, nanoem_frame_index_t audioPTS, nanoem_frame_index_t videoPTS, Error &error);
+        const void *data, nanoem_frame_index_t audioPTS, nanoem_frame_index_t videoPTS, Error &error);
     void seekAndProgress(Project *project, nanoem_frame_index_t frameIndex, nanoem_frame_index_t durationFrameIndices);
     void finishEncoding();
     void stopEncoding(Error &error);
@@ -0,0 +1,131 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_INTERNAL_DRAWCOMMANDSCHEDULER_H_
+#define NANOEM_EMAPP_INTERNAL_DRAWCOMMANDSCHEDULER_H_
+
+#include "emapp/Forward.h"
+
+namespace nanoem {
+namespace internal {
+
+/**
+ * Records draw commands of a render pass, reorders sortable draws by their state and replays them
+ * with skipping state changes that are identical to the previous draw.
+ *
+ * Draws are split into segments and reordering happens only inside a segment. A segment is closed by
+ * callbacks, viewport or scissor rect changes, draws with pipelines that are not marked as sortable
+ * (blending, stencil or no depth write) and draws with pipelines owned by another pass than the previous
+ * draw so effect defined draw orders including multi-pass techniques are always preserved.
+ */
+class DrawCommandScheduler NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    struct Statistics {
+        Statistics() NANOEM_DECL_NOEXCEPT;
+        void reset() NANOEM_DECL_NOEXCEPT;
+        nanoem_u32_t numStateChanges() const NANOEM_DECL_NOEXCEPT;
+        nanoem_u32_t m_numPasses;
+        nanoem_u32_t m_numDraws;
+        nanoem_u32_t m_numSkippedDraws;
+        nanoem_u32_t m_numReorderedDraws;
+        nanoem_u32_t m_numPipelineChanges;
+        nanoem_u32_t m_numBindingChanges;
+        nanoem_u32_t m_numViewportChanges;
+        nanoem_u32_t m_numScissorRectChanges;
+        nanoem_u32_t m_numUniformBlockChanges;
+        nanoem_u32_t m_numSkippedStateChanges;
+    };
+    class IExecutor {
+    public:
+        virtual ~IExecutor() NANOEM_DECL_NOEXCEPT
+        {
+        }
+        virtual bool applyPipeline(sg_pipeline pipeline) = 0;
+        virtual void applyBindings(const sg_bindings &bindings) = 0;
+        virtual void applyViewport(int x, int y, int width, int height) = 0;
+        virtual void applyScissorRect(int x, int y, int width, int height) = 0;
+        virtual void applyUniformBlock(sg_shader_stage stage, const void *data, nanoem_rsize_t size) = 0;
+        virtual void draw(int offset, int count) = 0;
+        virtual void invokeCallback(sg::PassBlock::Callback callback, void *userData) = 0;
+    };
+    typedef bool (*PipelineValidator)(sg_pipeline pipeline);
+
+    static bool isSortable(const sg_pipeline_desc &desc) NANOEM_DECL_NOEXCEPT;
+
+    DrawCommandScheduler();
+    ~DrawCommandScheduler() NANOEM_DECL_NOEXCEPT;
+
+    void begin();
+    void applyPipelineBindings(sg_pipeline pipeline, const sg_bindings &bindings);
+    void applyViewport(int x, int y, int width, int height);
+    void applyScissorRect(int x, int y, int width, int height);
+    void applyUniformBlock(sg_shader_stage stage, const void *data, nanoem_rsize_t size);
+    void draw(int offset, int count);
+    void registerCallback(sg::PassBlock::Callback callback, void *userData);
+    void execute(IExecutor *executor);
+
+    bool isPipelineSortable(sg_pipeline pipeline) const NANOEM_DECL_NOEXCEPT;
+    void setPipelineSortable(sg_pipeline pipeline, const void *pass, bool value);
+    void removeAllInvalidPipelines(PipelineValidator validator);
+    bool isSortEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setSortEnabled(bool value);
+    const Statistics &statistics() const NANOEM_DECL_NOEXCEPT;
+    void resetStatistics() NANOEM_DECL_NOEXCEPT;
+
+private:
+    struct Rect {
+        bool operator!=(const Rect &value) const NANOEM_DECL_NOEXCEPT;
+        int m_x;
+        int m_y;
+        int m_width;
+        int m_height;
+        bool m_enabled;
+    };
+    struct UniformBlock {
+        bool operator!=(const UniformBlock &value) const NANOEM_DECL_NOEXCEPT;
+        const void *m_data;
+        nanoem_rsize_t m_size;
+        nanoem_u32_t m_hash;
+    };
+    struct Unit {
+        static int compare(const void *left, const void *right);
+        sg::PassBlock::Callback m_callback;
+        void *m_userData;
+        sg_pipeline m_pipeline;
+        sg_bindings m_bindings;
+        const void *m_pass;
+        nanoem_u32_t m_bindingsHash;
+        Rect m_viewport;
+        Rect m_scissorRect;
+        UniformBlock m_uniformBlocks[SG_NUM_SHADER_STAGES];
+        nanoem_u32_t m_segment;
+        nanoem_u32_t m_sequence;
+        int m_offset;
+        int m_count;
+        bool m_sortable;
+    };
+    typedef tinystl::vector<Unit, TinySTLAllocator> UnitList;
+    typedef tinystl::unordered_map<nanoem_u32_t, const void *, TinySTLAllocator> PipelinePassMap;
+    typedef tinystl::vector<nanoem_u32_t, TinySTLAllocator> PipelineList;
+
+    void closeSegment() NANOEM_DECL_NOEXCEPT;
+    void sortAllUnits();
+
+    UnitList m_units;
+    PipelinePassMap m_sortablePipelines;
+    Statistics m_statistics;
+    Unit m_pending;
+    nanoem_u32_t m_segment;
+    nanoem_rsize_t m_numPrunablePipelines;
+    bool m_pipelineApplied;
+    bool m_sortEnabled;
+};
+
+} /* namespace internal */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_INTERNAL_DRAWCOMMANDSCHEDULER_H_ */
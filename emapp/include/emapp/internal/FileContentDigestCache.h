@@ -0,0 +1,76 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_INTERNAL_FILECONTENTDIGESTCACHE_H_
+#define NANOEM_EMAPP_INTERNAL_FILECONTENTDIGESTCACHE_H_
+
+#include "emapp/URI.h"
+
+namespace nanoem {
+
+class Error;
+class IReader;
+class ITranslator;
+
+namespace internal {
+
+/**
+ * Keeps SHA-256 digests of files referenced by projects keyed by path, size and modification time.
+ *
+ * A file is hashed again only when its size or timestamp is changed since the last digest. The content read to
+ * test the digest on loading can be retained once and taken by the file loader to avoid reading it twice.
+ */
+class FileContentDigestCache NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    static const nanoem_rsize_t kDigestSize = 32;
+    struct Statistics {
+        Statistics() NANOEM_DECL_NOEXCEPT;
+        void reset() NANOEM_DECL_NOEXCEPT;
+        nanoem_u32_t m_numHits;
+        nanoem_u32_t m_numMisses;
+        nanoem_u64_t m_numHashedBytes;
+    };
+
+    static void calculate(IReader *reader, nanoem_u8_t *value, Error &error);
+    static void calculate(const ByteArray &bytes, nanoem_u8_t *value) NANOEM_DECL_NOEXCEPT;
+
+    FileContentDigestCache(const ITranslator *translator);
+    ~FileContentDigestCache() NANOEM_DECL_NOEXCEPT;
+
+    bool digest(const URI &fileURI, nanoem_u8_t *value, Error &error);
+    bool readAllBytes(const URI &fileURI, ByteArray &bytes, nanoem_u8_t *value, Error &error);
+    void retainContent(const URI &fileURI, ByteArray &bytes);
+    bool takeContent(const URI &fileURI, ByteArray &bytes);
+    void releaseContent() NANOEM_DECL_NOEXCEPT;
+    void remove(const URI &fileURI);
+    void clear() NANOEM_DECL_NOEXCEPT;
+
+    const Statistics &statistics() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t size() const NANOEM_DECL_NOEXCEPT;
+
+private:
+    struct Entry {
+        nanoem_u64_t m_size;
+        nanoem_u64_t m_timestamp;
+        nanoem_u8_t m_digest[kDigestSize];
+    };
+    typedef tinystl::unordered_map<String, Entry, TinySTLAllocator> EntryMap;
+
+    bool find(const String &path, nanoem_u64_t size, nanoem_u64_t timestamp, nanoem_u8_t *value);
+    void insert(const String &path, nanoem_u64_t size, nanoem_u64_t timestamp, const nanoem_u8_t *value);
+
+    const ITranslator *m_translator;
+    EntryMap m_entries;
+    URI m_retainedContentURI;
+    ByteArray m_retainedContent;
+    Statistics m_statistics;
+};
+
+} /* namespace internal */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_INTERNAL_FILECONTENTDIGESTCACHE_H_ */
@@ -0,0 +1,67 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_INTERNAL_FRUSTUMCULLER_H_
+#define NANOEM_EMAPP_INTERNAL_FRUSTUMCULLER_H_
+
+#include "emapp/BoundingBox.h"
+
+namespace nanoem {
+namespace internal {
+
+/**
+ * Tests axis aligned bounds of drawables against view frustums of the active camera and the shadow camera.
+ *
+ * Frustums are set by Project before each kind of pass is drawn. Every test is counted so culled and
+ * submitted draws of the last frame can be inspected without GPU.
+ */
+class FrustumCuller NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    enum FrustumType {
+        kFrustumTypeFirstEnum,
+        kFrustumTypeCamera = kFrustumTypeFirstEnum,
+        kFrustumTypeShadowMap,
+        kFrustumTypeMaxEnum,
+    };
+    struct Statistics {
+        Statistics() NANOEM_DECL_NOEXCEPT;
+        void reset() NANOEM_DECL_NOEXCEPT;
+        nanoem_u32_t m_numSubmittedDraws;
+        nanoem_u32_t m_numCulledDraws;
+    };
+    static const nanoem_rsize_t kNumPlanes = 6;
+
+    static void extractAllPlanes(const Matrix4x4 &viewProjection, Vector4 *planes) NANOEM_DECL_NOEXCEPT;
+    static bool intersects(const Vector4 *planes, const BoundingBox &box) NANOEM_DECL_NOEXCEPT;
+
+    FrustumCuller();
+    ~FrustumCuller() NANOEM_DECL_NOEXCEPT;
+
+    void setViewProjection(FrustumType type, const Matrix4x4 &value);
+    void invalidate(FrustumType type) NANOEM_DECL_NOEXCEPT;
+    bool isVisible(FrustumType type, const BoundingBox &box) const NANOEM_DECL_NOEXCEPT;
+    bool test(FrustumType type, const BoundingBox &box) NANOEM_DECL_NOEXCEPT;
+    void submit() NANOEM_DECL_NOEXCEPT;
+    void endFrame() NANOEM_DECL_NOEXCEPT;
+
+    const Statistics &statistics() const NANOEM_DECL_NOEXCEPT;
+    const Statistics &lastFrameStatistics() const NANOEM_DECL_NOEXCEPT;
+    bool isEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setEnabled(bool value);
+
+private:
+    Vector4 m_planes[kFrustumTypeMaxEnum][kNumPlanes];
+    bool m_valid[kFrustumTypeMaxEnum];
+    Statistics m_statistics;
+    Statistics m_lastFrameStatistics;
+    bool m_enabled;
+};
+
+} /* namespace internal */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_INTERNAL_FRUSTUMCULLER_H_ */
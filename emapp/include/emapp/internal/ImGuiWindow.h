@@ -37,6 +37,7 @@ class DraggingMorphSliderState;
 class ImGuiApplicationMenuBuilder;
 class LightColorVectorValueState;
 class LightDirectionVectorValueState;
+class WaveFormPyramid;
 
 namespace imgui {
 class GizmoController;
@@ -433,6 +434,7 @@ private:
     BoneTranslationValueState *m_boneTranslationValueState;
     BoneOrientationValueState *m_boneOrientationValueState;
     DraggingMorphSliderState *m_draggingMorphSliderState;
+    WaveFormPyramid *m_waveFormPyramid;
     ITrack *m_requestedScrollHereTrack;
     PrimitiveContext m_primitive2D;
     ModalDialogList m_allModalDialogs;
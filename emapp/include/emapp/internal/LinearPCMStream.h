@@ -0,0 +1,67 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_INTERNAL_LINEARPCMSTREAM_H_
+#define NANOEM_EMAPP_INTERNAL_LINEARPCMSTREAM_H_
+
+#include "emapp/IAudioPlayer.h"
+
+namespace nanoem {
+
+class ISeekableReader;
+
+namespace internal {
+
+/**
+ * Reads linear PCM samples of WAV data on demand from a seekable reader.
+ *
+ * Only RIFF chunk headers are read on open and samples are read through a lookahead window,
+ * so neither the whole file nor the whole payload has to be resident.
+ */
+class LinearPCMStream NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    static const nanoem_rsize_t kDefaultNumLookaheadFrames = 4096;
+
+    static nanoem_u64_t toFrameOffset(
+        const IAudioPlayer::Rational &value, nanoem_u32_t sampleRate) NANOEM_DECL_NOEXCEPT;
+
+    LinearPCMStream(ISeekableReader *reader, nanoem_rsize_t numLookaheadFrames = kDefaultNumLookaheadFrames);
+    ~LinearPCMStream() NANOEM_DECL_NOEXCEPT;
+
+    bool open(Error &error);
+    bool seek(nanoem_u64_t frameOffset) NANOEM_DECL_NOEXCEPT;
+    bool seek(const IAudioPlayer::Rational &value) NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t read(nanoem_u8_t *data, nanoem_rsize_t numFrames, Error &error);
+    bool readAll(ByteArray &bytes, Error &error);
+
+    const IAudioPlayer::Format &format() const NANOEM_DECL_NOEXCEPT;
+    IAudioPlayer::Rational durationRational() const NANOEM_DECL_NOEXCEPT;
+    nanoem_u64_t numFrames() const NANOEM_DECL_NOEXCEPT;
+    nanoem_u64_t currentFrame() const NANOEM_DECL_NOEXCEPT;
+    nanoem_u32_t bytesPerFrame() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t numWindowReads() const NANOEM_DECL_NOEXCEPT;
+
+private:
+    bool fill(nanoem_u64_t frameOffset, Error &error);
+    bool readPayload(nanoem_u64_t offset, nanoem_u8_t *data, nanoem_rsize_t size, Error &error);
+
+    ISeekableReader *m_reader;
+    ByteArray m_window;
+    IAudioPlayer::Format m_format;
+    nanoem_u64_t m_payloadOffset;
+    nanoem_u64_t m_numFrames;
+    nanoem_u64_t m_currentFrame;
+    nanoem_u64_t m_windowFrameOffset;
+    nanoem_rsize_t m_numWindowFrames;
+    nanoem_rsize_t m_numLookaheadFrames;
+    nanoem_rsize_t m_numWindowReads;
+};
+
+} /* namespace internal */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_INTERNAL_LINEARPCMSTREAM_H_ */
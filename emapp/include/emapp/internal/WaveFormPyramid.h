@@ -0,0 +1,74 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_INTERNAL_WAVEFORMPYRAMID_H_
+#define NANOEM_EMAPP_INTERNAL_WAVEFORMPYRAMID_H_
+
+#include "emapp/Forward.h"
+
+namespace nanoem {
+namespace internal {
+
+/**
+ * Multi resolution min/max/RMS summary of linear PCM samples to draw waveform of the timeline.
+ *
+ * Level 0 summarizes each kNumBlockFrames frames and each upper level merges two bins of the lower level.
+ * A query merges at most two bins per level and raw samples of both unaligned edges, so its cost doesn't
+ * depend on either the queried range or the audio length.
+ */
+class WaveFormPyramid NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    struct Bin {
+        Bin() NANOEM_DECL_NOEXCEPT;
+        void merge(const Bin &value) NANOEM_DECL_NOEXCEPT;
+        void merge(nanoem_f32_t value) NANOEM_DECL_NOEXCEPT;
+        nanoem_f32_t rms() const NANOEM_DECL_NOEXCEPT;
+        nanoem_f32_t m_min;
+        nanoem_f32_t m_max;
+        nanoem_f32_t m_sumSquares;
+        nanoem_u32_t m_numSamples;
+    };
+    static const nanoem_rsize_t kNumBlockFrames = 32;
+    static const nanoem_rsize_t kMaxLevels = 32;
+
+    static nanoem_f32_t decodeSample(const nanoem_u8_t *ptr, nanoem_rsize_t bytesPerSample) NANOEM_DECL_NOEXCEPT;
+
+    WaveFormPyramid();
+    ~WaveFormPyramid() NANOEM_DECL_NOEXCEPT;
+
+    bool isSameSource(const ByteArray *samples, nanoem_u32_t bitsPerSample, nanoem_u32_t numChannels) const
+        NANOEM_DECL_NOEXCEPT;
+    void reset(const ByteArray *samples, nanoem_u32_t bitsPerSample, nanoem_u32_t numChannels);
+    bool update(nanoem_rsize_t maxFrames);
+    Bin query(nanoem_rsize_t beginFrame, nanoem_rsize_t endFrame) const NANOEM_DECL_NOEXCEPT;
+    void clear();
+
+    nanoem_rsize_t numFrames() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t numBuiltFrames() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t numLevels() const NANOEM_DECL_NOEXCEPT;
+    bool isCompleted() const NANOEM_DECL_NOEXCEPT;
+
+private:
+    typedef tinystl::vector<Bin, TinySTLAllocator> BinList;
+
+    void accumulateFrames(nanoem_rsize_t beginFrame, nanoem_rsize_t endFrame, Bin &bin) const NANOEM_DECL_NOEXCEPT;
+    void appendBlock(const Bin &value);
+
+    const ByteArray *m_samplesPtr;
+    const nanoem_u8_t *m_sourceData;
+    BinList m_levels[kMaxLevels];
+    nanoem_rsize_t m_sourceSize;
+    nanoem_rsize_t m_numFrames;
+    nanoem_rsize_t m_numBuiltFrames;
+    nanoem_u32_t m_bytesPerSample;
+    nanoem_u32_t m_numChannels;
+};
+
+} /* namespace internal */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_INTERNAL_WAVEFORMPYRAMID_H_ */
@@ -54,6 +54,7 @@ public:
         const Vector4 &targetPosition, Joint *result) NANOEM_DECL_NOEXCEPT;
     static bool hasUnitXConstraint(
         const nanoem_model_bone_t *bone, nanoem_unicode_string_factory_t *factory) NANOEM_DECL_NOEXCEPT;
+    static bool isConverged(const Vector3 &effectorPosition, const Vector3 &targetPosition) NANOEM_DECL_NOEXCEPT;
 
     void bind(nanoem_model_constraint_t *constraintPtr);
     void resetLanguage(const nanoem_model_constraint_t *constraintPtr, nanoem_unicode_string_factory_t *factory,
@@ -65,12 +66,15 @@ public:
     const JointIterationResult *effectorIterationResult() const NANOEM_DECL_NOEXCEPT;
     Joint *jointIterationResult(const nanoem_model_constraint_joint_t *joint, nanoem_rsize_t offset);
     Joint *effectorIterationResult(const nanoem_model_constraint_joint_t *joint, nanoem_rsize_t offset);
+    Joint *scratchJoint() NANOEM_DECL_NOEXCEPT;
     String name() const;
     String canonicalName() const;
     const char *nameConstString() const NANOEM_DECL_NOEXCEPT;
     const char *canonicalNameConstString() const NANOEM_DECL_NOEXCEPT;
     bool isEnabled() const NANOEM_DECL_NOEXCEPT;
     void setEnabled(bool value);
+    bool isIterationTraceEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setIterationTraceEnabled(bool value);
 
 private:
     struct PlaceHolder { };
@@ -79,6 +83,7 @@ private:
 
     JointIterationResult m_jointIterationResult;
     JointIterationResult m_effectorIterationResult;
+    Joint m_scratchJoint;
     String m_name;
     String m_canonicalName;
     nanoem_u32_t m_states;
@@ -58,8 +58,10 @@ public:
     void getWorldTransform(
         const nanoem_model_rigid_body_t *rigidBodyPtr, nanoem_f32_t *value) const NANOEM_DECL_NOEXCEPT;
     void synchronizeTransformFeedbackFromSimulation(const nanoem_model_rigid_body_t *rigidBodyPtr,
+        const nanoem_f32_t *initialTransform, const nanoem_f32_t *worldTransform,
         PhysicsEngine::RigidBodyFollowBoneType followType) NANOEM_DECL_NOEXCEPT;
-    void synchronizeTransformFeedbackToSimulation(const nanoem_model_rigid_body_t *body) NANOEM_DECL_NOEXCEPT;
+    bool synchronizeTransformFeedbackToSimulation(const nanoem_model_rigid_body_t *body,
+        const nanoem_f32_t *initialTransform, nanoem_f32_t *worldTransform) NANOEM_DECL_NOEXCEPT;
     void applyAllForces(const nanoem_model_rigid_body_t *rigidBodyPtr) NANOEM_DECL_NOEXCEPT;
     void initializeTransformFeedback(const nanoem_model_rigid_body_t *rigidBodyPtr);
     void resetTransformFeedback(const nanoem_model_rigid_body_t *rigidBodyPtr);
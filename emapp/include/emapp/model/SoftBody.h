@@ -60,6 +60,7 @@ public:
     void setEditingMasked(bool value);
 
 private:
+    typedef tinystl::vector<int, TinySTLAllocator> OffsetList;
     struct PlaceHolder { };
 
     static void destroy(void *opaque, nanoem_model_object_t *object) NANOEM_DECL_NOEXCEPT;
@@ -73,6 +74,9 @@ private:
 
     PhysicsEngine *m_physicsEngine;
     nanoem_physics_soft_body_t *m_physicsSoftBody;
+    OffsetList m_pinnedVertexOffsets;
+    FloatList m_vertexPositions;
+    FloatList m_vertexNormals;
     String m_name;
     String m_canonicalName;
     nanoem_u32_t m_states;
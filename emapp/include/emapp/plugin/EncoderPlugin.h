@@ -40,6 +40,8 @@ public:
         nanoem_frame_index_t currentLocalFrameIndex, const nanoem_u8_t *data, size_t size, Error &error);
     bool encodeVideoFrame(
         nanoem_frame_index_t currentLocalFrameIndex, const nanoem_u8_t *data, size_t size, Error &error);
+    nanoem_u8_t *acquireVideoFrameBuffer(size_t size, Error &error);
+    bool submitVideoFrameBuffer(nanoem_frame_index_t currentLocalFrameIndex, nanoem_u8_t *data, Error &error);
     void interrupt();
     void getAvailableVideoFormatExtensions(StringList &formatExtensionList) const;
     void getUIWindowLayout(ByteArray &bytes, Error &error);
@@ -65,6 +67,10 @@ private:
         nanoem_application_plugin_encoder_t *, nanoem_frame_index_t, const nanoem_u8_t *, nanoem_u32_t, int *);
     typedef void(APIENTRY *PFN_nanoemApplicationPluginEncoderEncodeVideoFrame)(
         nanoem_application_plugin_encoder_t *, nanoem_frame_index_t, const nanoem_u8_t *, nanoem_u32_t, int *);
+    typedef nanoem_u8_t *(APIENTRY *PFN_nanoemApplicationPluginEncoderAcquireVideoFrameBuffer)(
+        nanoem_application_plugin_encoder_t *, nanoem_u32_t, int *);
+    typedef void(APIENTRY *PFN_nanoemApplicationPluginEncoderSubmitVideoFrameBuffer)(
+        nanoem_application_plugin_encoder_t *, nanoem_frame_index_t, nanoem_u8_t *, int *);
     typedef void(APIENTRY *PFN_nanoemApplicationPluginEncoderInterrupt)(nanoem_application_plugin_encoder_t *, int *);
     typedef const char *const *(APIENTRY *PFN_nanoemApplicationPluginEncoderGetAllAvailableVideoFormats)(
         const nanoem_application_plugin_encoder_t *, nanoem_u32_t *);
@@ -93,6 +99,8 @@ private:
     PFN_nanoemApplicationPluginEncoderSetOption _encoderSetOption;
     PFN_nanoemApplicationPluginEncoderEncodeAudioFrame _encoderEncodeAudioFrame;
     PFN_nanoemApplicationPluginEncoderEncodeVideoFrame _encoderEncodeVideoFrame;
+    PFN_nanoemApplicationPluginEncoderAcquireVideoFrameBuffer _encoderAcquireVideoFrameBuffer;
+    PFN_nanoemApplicationPluginEncoderSubmitVideoFrameBuffer _encoderSubmitVideoFrameBuffer;
     PFN_nanoemApplicationPluginEncoderInterrupt _encoderInterrupt;
     PFN_nanoemApplicationPluginEncoderGetAllAvailableVideoFormats _encoderGetAllAvailableVideoFormatExtensions;
     PFN_nanoemApplicationPluginEncoderLoadUIWindowLayout _encoderLoadUIWindowLayout;
@@ -20,7 +20,7 @@
  */
 
 #define NANOEM_APPLICATION_PLUGIN_ENCODER_ABI_VERSION_MAJOR 2
-#define NANOEM_APPLICATION_PLUGIN_ENCODER_ABI_VERSION_MINOR 0
+#define NANOEM_APPLICATION_PLUGIN_ENCODER_ABI_VERSION_MINOR 1
 #define NANOEM_APPLICATION_PLUGIN_ENCODER_ABI_VERSION                                                                  \
     NANOEM_APPLICATION_PLUGIN_MAKE_ABI_VERSION(                                                                        \
         NANOEM_APPLICATION_PLUGIN_ENCODER_ABI_VERSION_MAJOR, NANOEM_APPLICATION_PLUGIN_ENCODER_ABI_VERSION_MINOR)
@@ -128,6 +128,41 @@ NANOEM_DECL_API void APIENTRY nanoemApplicationPluginEncoderEncodeVideoFrame(
     nanoem_application_plugin_encoder_t *encoder, nanoem_frame_index_t currentFrameIndex, const nanoem_u8_t *data,
     nanoem_u32_t size, nanoem_i32_t *status);
 
+/**
+ * \brief Acquire a video frame buffer owned by the encoder
+ *
+ * The host writes video frame data to the returned buffer directly instead of passing its own buffer to
+ * \b nanoemApplicationPluginEncoderEncodeVideoFrame so the encoder doesn't need to copy the frame. The returned buffer
+ * must be passed to \b nanoemApplicationPluginEncoderSubmitVideoFrameBuffer exactly once.
+ *
+ * The host falls back to \b nanoemApplicationPluginEncoderEncodeVideoFrame when the function returns \b NULL without
+ * error.
+ *
+ * \param encoder The opaque encoder plugin object
+ * \param size The size of the video frame data to write in byte unit
+ * \param[out] status \b NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS is set if succeeded, otherwise sets the others
+ * \return The writable buffer at least \b size bytes, or \b NULL if the buffer cannot be provided
+ * \since Encoder Plugin ABI 2.1
+ */
+NANOEM_DECL_API nanoem_u8_t *APIENTRY nanoemApplicationPluginEncoderAcquireVideoFrameBuffer(
+    nanoem_application_plugin_encoder_t *encoder, nanoem_u32_t size, nanoem_i32_t *status);
+
+/**
+ * \brief Submit a video frame buffer acquired by \b nanoemApplicationPluginEncoderAcquireVideoFrameBuffer to encode
+ *
+ * The ownership of \b data is transferred back to the encoder and the host must not access \b data after calling the
+ * function.
+ *
+ * \param encoder The opaque encoder plugin object
+ * \param currentFrameIndex The frame index to encode
+ * \param data The video frame buffer returned by \b nanoemApplicationPluginEncoderAcquireVideoFrameBuffer
+ * \param[out] status \b NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS is set if succeeded, otherwise sets the others
+ * \since Encoder Plugin ABI 2.1
+ */
+NANOEM_DECL_API void APIENTRY nanoemApplicationPluginEncoderSubmitVideoFrameBuffer(
+    nanoem_application_plugin_encoder_t *encoder, nanoem_frame_index_t currentFrameIndex, nanoem_u8_t *data,
+    nanoem_i32_t *status);
+
 /**
  * \brief Interrupt encoding audio/video frame
  *
@@ -6,6 +6,9 @@
 
 #define NOMINMAX
 #include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "emapp/sdk/Decoder.h"
@@ -54,6 +57,9 @@ struct FFmpegEncoder {
     static const char kVideoPixelFormatComponentID[];
     static const int kMinimumSampleRate;
     static const int kMinimumNumChannels;
+    static const int kMaxNumScaleThreads;
+    static const int kScaledVideoFrameAlignment;
+    static const nanoem_u64_t kMaxNumPendingVideoFrames;
 
     FFmpegEncoder()
         : m_formatContext(nullptr)
@@ -63,6 +69,8 @@ struct FFmpegEncoder {
         , m_videoCodecContext(nullptr)
         , m_resampleContext(nullptr)
         , m_scaleContext(nullptr)
+        , m_sourceVideoFrameBufferPool(nullptr)
+        , m_scaledVideoFrameBufferPool(nullptr)
         , m_tempAudioBuffer(nullptr)
         , m_audioCodecID(AV_CODEC_ID_PCM_S16LE)
         , m_videoCodecID(AV_CODEC_ID_RAWVIDEO)
@@ -76,6 +84,9 @@ struct FFmpegEncoder {
         , m_height(0)
         , m_yflip(0)
         , m_nextAudioPTS(0)
+        , m_numSubmittedVideoFrames(0)
+        , m_numEncodedVideoFrames(0)
+        , m_scaleThreadsRunning(false)
     {
         *m_reason = 0;
     }
@@ -147,9 +158,7 @@ struct FFmpegEncoder {
             if ((m_formatContext->oformat->flags & AVFMT_GLOBALHEADER) != 0) {
                 m_videoCodecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
             }
-            const AVPixelFormat sourcePixelFormat = AV_PIX_FMT_RGBA;
-            m_scaleContext = sws_getContext(m_width, m_height, sourcePixelFormat, m_width, m_height,
-                m_videoCodecContext->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr);
+            m_scaleContext = createScaleContext();
         }
         int rc = avcodec_open2(m_videoCodecContext, codec, nullptr);
         if (rc == 0 && m_videoStream) {
@@ -290,31 +299,56 @@ struct FFmpegEncoder {
     encodeVideoFrame(nanoem_frame_index_t currentFrameIndex, const nanoem_u8_t *data, nanoem_u32_t size,
         nanoem_application_plugin_status_t *status)
     {
+        if (!encodeAllScaledVideoFrames(0, status)) {
+            return;
+        }
         const AVCodecParameters *parameters = m_videoStream->codecpar;
         ScopedVideoFrame frame(parameters, currentFrameIndex);
         if (!wrapCall(av_frame_get_buffer(frame, 0), status) || !wrapCall(av_frame_make_writable(frame), status)) {
             return;
         }
-        const nanoem_u8_t *dataPtr[] = { 0, 0, 0, 0 };
-        int lineSizePtr[] = { 0, 0, 0, 0 }, stride = size / m_height;
-        if (m_yflip) {
-            const nanoem_u8_t *ptr = data + stride * (m_height - 1);
-            lineSizePtr[0] = -stride;
-            dataPtr[0] = ptr;
-        }
-        else {
-            lineSizePtr[0] = stride;
-            dataPtr[0] = data;
+        scaleVideoFrame(m_scaleContext, data, size, frame);
+        encodeScaledVideoFrame(frame, status);
+    }
+    nanoem_u8_t *
+    acquireVideoFrameBuffer(nanoem_u32_t size, nanoem_application_plugin_status_t *status)
+    {
+        nanoem_u8_t *data = nullptr;
+        /* returns null without error to fall back to encodeVideoFrame if the size doesn't match */
+        if (m_videoCodecContext && size == m_width * m_height * 4) {
+            if (!m_sourceVideoFrameBufferPool) {
+                startScaleThreads();
+            }
+            if (AVBufferRef *buffer = av_buffer_pool_get(m_sourceVideoFrameBufferPool)) {
+                m_acquiredVideoFrameBuffers.push_back(buffer);
+                data = buffer->data;
+            }
+            else {
+                makeFailureReason(AVERROR(ENOMEM), status);
+            }
         }
-        sws_scale(m_scaleContext, dataPtr, lineSizePtr, 0, m_height, frame.m_opaque->data, frame.m_opaque->linesize);
-        if (wrapCall(avcodec_send_frame(m_videoCodecContext, frame), status)) {
-            AVPacket packet = {};
-            av_init_packet(&packet);
-            if (wrapCall(avcodec_receive_packet(m_videoCodecContext, &packet), status)) {
-                av_packet_rescale_ts(&packet, m_videoCodecContext->time_base, m_videoStream->time_base);
-                packet.stream_index = m_videoStream->index;
-                makeFailureReason(av_interleaved_write_frame(m_formatContext, &packet), status);
+        return data;
+    }
+    void
+    submitVideoFrameBuffer(
+        nanoem_frame_index_t currentFrameIndex, nanoem_u8_t *data, nanoem_application_plugin_status_t *status)
+    {
+        BufferRefList::iterator it = m_acquiredVideoFrameBuffers.begin(), end = m_acquiredVideoFrameBuffers.end();
+        while (it != end && (*it)->data != data) {
+            ++it;
+        }
+        if (it != end) {
+            VideoFrameJob job = { m_numSubmittedVideoFrames++, currentFrameIndex, *it, nullptr };
+            m_acquiredVideoFrameBuffers.erase(it);
+            {
+                std::lock_guard<std::mutex> lock(m_videoFrameMutex);
+                m_pendingVideoFrameJobs.push_back(job);
             }
+            m_pendingVideoFrameCondition.notify_one();
+            encodeAllScaledVideoFrames(kMaxNumPendingVideoFrames, status);
+        }
+        else {
+            makeFailureReason(AVERROR(EINVAL), status);
         }
     }
     int
@@ -325,6 +359,10 @@ struct FFmpegEncoder {
     int
     close(nanoem_application_plugin_status_t *status)
     {
+        if (m_sourceVideoFrameBufferPool) {
+            encodeAllScaledVideoFrames(0, status);
+            stopScaleThreads();
+        }
         if (m_formatContext) {
             makeFailureReason(av_write_trailer(m_formatContext), status);
         }
@@ -491,6 +529,191 @@ struct FFmpegEncoder {
         return makeFailureReason(rc, status) >= 0;
     }
 
+    struct VideoFrameJob {
+        nanoem_u64_t m_sequence;
+        nanoem_frame_index_t m_frameIndex;
+        AVBufferRef *m_source;
+        AVFrame *m_frame;
+    };
+    typedef std::vector<VideoFrameJob> VideoFrameJobList;
+    typedef std::vector<AVBufferRef *> BufferRefList;
+    typedef std::vector<AVFrame *> FrameList;
+    typedef std::vector<std::thread> ThreadList;
+
+    SwsContext *
+    createScaleContext() const
+    {
+        const AVPixelFormat sourcePixelFormat = AV_PIX_FMT_RGBA;
+        return sws_getContext(m_width, m_height, sourcePixelFormat, m_width, m_height, m_videoCodecContext->pix_fmt,
+            SWS_BICUBIC, nullptr, nullptr, nullptr);
+    }
+    void
+    scaleVideoFrame(SwsContext *context, const nanoem_u8_t *data, nanoem_u32_t size, AVFrame *frame) const
+    {
+        const nanoem_u8_t *dataPtr[] = { 0, 0, 0, 0 };
+        int lineSizePtr[] = { 0, 0, 0, 0 }, stride = size / m_height;
+        if (m_yflip) {
+            const nanoem_u8_t *ptr = data + stride * (m_height - 1);
+            lineSizePtr[0] = -stride;
+            dataPtr[0] = ptr;
+        }
+        else {
+            lineSizePtr[0] = stride;
+            dataPtr[0] = data;
+        }
+        sws_scale(context, dataPtr, lineSizePtr, 0, m_height, frame->data, frame->linesize);
+    }
+    bool
+    encodeScaledVideoFrame(AVFrame *frame, nanoem_application_plugin_status_t *status)
+    {
+        bool succeeded = false;
+        if (wrapCall(avcodec_send_frame(m_videoCodecContext, frame), status)) {
+            AVPacket packet = {};
+            av_init_packet(&packet);
+            if (wrapCall(avcodec_receive_packet(m_videoCodecContext, &packet), status)) {
+                av_packet_rescale_ts(&packet, m_videoCodecContext->time_base, m_videoStream->time_base);
+                packet.stream_index = m_videoStream->index;
+                succeeded = wrapCall(av_interleaved_write_frame(m_formatContext, &packet), status);
+            }
+        }
+        return succeeded;
+    }
+    void
+    startScaleThreads()
+    {
+        const AVCodecParameters *parameters = m_videoStream->codecpar;
+        const int numThreads =
+            std::min(std::max(static_cast<int>(std::thread::hardware_concurrency()), 1), kMaxNumScaleThreads);
+        m_sourceVideoFrameBufferPool = av_buffer_pool_init(static_cast<int>(m_width * m_height * 4), nullptr);
+        m_scaledVideoFrameBufferPool = av_buffer_pool_init(
+            av_image_get_buffer_size(static_cast<AVPixelFormat>(parameters->format), parameters->width,
+                parameters->height, kScaledVideoFrameAlignment),
+            nullptr);
+        m_scaleThreadsRunning = true;
+        for (int i = 0; i < numThreads; i++) {
+            m_scaleThreads.push_back(std::thread(&FFmpegEncoder::runScaleThread, this));
+        }
+    }
+    void
+    stopScaleThreads()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_videoFrameMutex);
+            m_scaleThreadsRunning = false;
+        }
+        m_pendingVideoFrameCondition.notify_all();
+        for (ThreadList::iterator it = m_scaleThreads.begin(), end = m_scaleThreads.end(); it != end; ++it) {
+            it->join();
+        }
+        m_scaleThreads.clear();
+        /* scaled frames are left only when encoding them failed */
+        for (VideoFrameJobList::iterator it = m_scaledVideoFrameJobs.begin(), end = m_scaledVideoFrameJobs.end();
+             it != end; ++it) {
+            av_frame_free(&it->m_frame);
+        }
+        m_scaledVideoFrameJobs.clear();
+        for (FrameList::iterator it = m_freeScaledVideoFrames.begin(), end = m_freeScaledVideoFrames.end(); it != end;
+             ++it) {
+            av_frame_free(&*it);
+        }
+        m_freeScaledVideoFrames.clear();
+        for (BufferRefList::iterator it = m_acquiredVideoFrameBuffers.begin(), end = m_acquiredVideoFrameBuffers.end();
+             it != end; ++it) {
+            av_buffer_unref(&*it);
+        }
+        m_acquiredVideoFrameBuffers.clear();
+        /* both pools are freed after all buffers referenced by the codec are returned */
+        av_buffer_pool_uninit(&m_sourceVideoFrameBufferPool);
+        av_buffer_pool_uninit(&m_scaledVideoFrameBufferPool);
+        m_numSubmittedVideoFrames = m_numEncodedVideoFrames = 0;
+    }
+    void
+    runScaleThread()
+    {
+        /* SwsContext cannot be shared between threads */
+        SwsContext *context = createScaleContext();
+        std::unique_lock<std::mutex> lock(m_videoFrameMutex);
+        while (true) {
+            while (m_scaleThreadsRunning && m_pendingVideoFrameJobs.empty()) {
+                m_pendingVideoFrameCondition.wait(lock);
+            }
+            if (m_pendingVideoFrameJobs.empty()) {
+                break;
+            }
+            VideoFrameJob job = m_pendingVideoFrameJobs.front();
+            AVFrame *frame = nullptr;
+            m_pendingVideoFrameJobs.erase(m_pendingVideoFrameJobs.begin());
+            if (!m_freeScaledVideoFrames.empty()) {
+                frame = m_freeScaledVideoFrames.back();
+                m_freeScaledVideoFrames.pop_back();
+            }
+            lock.unlock();
+            job.m_frame = createScaledVideoFrame(context, job, frame);
+            av_buffer_unref(&job.m_source);
+            lock.lock();
+            m_scaledVideoFrameJobs.push_back(job);
+            m_scaledVideoFrameCondition.notify_all();
+        }
+        lock.unlock();
+        sws_freeContext(context);
+    }
+    AVFrame *
+    createScaledVideoFrame(SwsContext *context, const VideoFrameJob &job, AVFrame *frame) const
+    {
+        const AVCodecParameters *parameters = m_videoStream->codecpar;
+        /* frames already encoded are reused and allocated only until the pipeline is filled */
+        if (!frame) {
+            frame = av_frame_alloc();
+        }
+        if (frame && (frame->buf[0] = av_buffer_pool_get(m_scaledVideoFrameBufferPool)) != nullptr) {
+            frame->format = parameters->format;
+            frame->width = parameters->width;
+            frame->height = parameters->height;
+            frame->pts = job.m_frameIndex;
+            av_image_fill_arrays(frame->data, frame->linesize, frame->buf[0]->data,
+                static_cast<AVPixelFormat>(parameters->format), parameters->width, parameters->height,
+                kScaledVideoFrameAlignment);
+            scaleVideoFrame(context, job.m_source->data, job.m_source->size, frame);
+        }
+        else {
+            av_frame_free(&frame);
+        }
+        return frame;
+    }
+    bool
+    encodeAllScaledVideoFrames(nanoem_u64_t numMaxPendingFrames, nanoem_application_plugin_status_t *status)
+    {
+        std::unique_lock<std::mutex> lock(m_videoFrameMutex);
+        bool succeeded = true;
+        /* frames are scaled out of order but must be encoded in the submitted order */
+        while (succeeded && m_numEncodedVideoFrames < m_numSubmittedVideoFrames) {
+            VideoFrameJobList::iterator it = m_scaledVideoFrameJobs.begin(), end = m_scaledVideoFrameJobs.end();
+            while (it != end && it->m_sequence != m_numEncodedVideoFrames) {
+                ++it;
+            }
+            if (it != end) {
+                AVFrame *frame = it->m_frame;
+                m_scaledVideoFrameJobs.erase(it);
+                m_numEncodedVideoFrames++;
+                lock.unlock();
+                succeeded = frame ? encodeScaledVideoFrame(frame, status) : wrapCall(AVERROR(ENOMEM), status);
+                lock.lock();
+                if (frame) {
+                    /* the scaled buffer goes back to the pool when the codec doesn't keep its reference */
+                    av_frame_unref(frame);
+                    m_freeScaledVideoFrames.push_back(frame);
+                }
+            }
+            else if (m_numSubmittedVideoFrames - m_numEncodedVideoFrames > numMaxPendingFrames) {
+                m_scaledVideoFrameCondition.wait(lock);
+            }
+            else {
+                break;
+            }
+        }
+        return succeeded;
+    }
+
     struct ScopedAudioFrame {
         ScopedAudioFrame(const AVCodecParameters *parameters, int numSamplesPerFrame, nanoem_frame_index_t pts)
             : m_opaque(av_frame_alloc())
@@ -547,6 +770,16 @@ struct FFmpegEncoder {
     AVCodecContext *m_videoCodecContext;
     SwrContext *m_resampleContext;
     SwsContext *m_scaleContext;
+    ThreadList m_scaleThreads;
+    std::mutex m_videoFrameMutex;
+    std::condition_variable m_pendingVideoFrameCondition;
+    std::condition_variable m_scaledVideoFrameCondition;
+    VideoFrameJobList m_pendingVideoFrameJobs;
+    VideoFrameJobList m_scaledVideoFrameJobs;
+    FrameList m_freeScaledVideoFrames;
+    BufferRefList m_acquiredVideoFrameBuffers;
+    AVBufferPool *m_sourceVideoFrameBufferPool;
+    AVBufferPool *m_scaledVideoFrameBufferPool;
     nanoem_f32_t *m_tempAudioBuffer;
     AVCodecID m_audioCodecID;
     AVCodecID m_videoCodecID;
@@ -560,12 +793,18 @@ struct FFmpegEncoder {
     nanoem_u32_t m_height;
     nanoem_u32_t m_yflip;
     nanoem_i64_t m_nextAudioPTS;
+    nanoem_u64_t m_numSubmittedVideoFrames;
+    nanoem_u64_t m_numEncodedVideoFrames;
+    bool m_scaleThreadsRunning;
 };
 const char FFmpegEncoder::kAudioCodecComponentID[] = "ffmpeg.audio-codec";
 const char FFmpegEncoder::kVideoCodecComponentID[] = "ffmpeg.video-codec";
 const char FFmpegEncoder::kVideoPixelFormatComponentID[] = "ffmpeg.video-pixel-format";
 const int FFmpegEncoder::kMinimumSampleRate = 44100;
 const int FFmpegEncoder::kMinimumNumChannels = 2;
+const int FFmpegEncoder::kMaxNumScaleThreads = 4;
+const int FFmpegEncoder::kScaledVideoFrameAlignment = 32;
+const nanoem_u64_t FFmpegEncoder::kMaxNumPendingVideoFrames = 8;
 
 struct FFmpegDecoder {
     FFmpegDecoder()
@@ -984,6 +1223,34 @@ nanoemApplicationPluginEncoderEncodeVideoFrame(nanoem_application_plugin_encoder
     }
 }
 
+nanoem_u8_t *APIENTRY
+nanoemApplicationPluginEncoderAcquireVideoFrameBuffer(
+    nanoem_application_plugin_encoder_t *encoder, nanoem_u32_t size, nanoem_i32_t *status)
+{
+    nanoem_application_plugin_status_t *statusPtr = reinterpret_cast<nanoem_application_plugin_status_t *>(status);
+    nanoem_u8_t *data = nullptr;
+    if (nanoem_is_not_null(encoder)) {
+        data = encoder->acquireVideoFrameBuffer(size, statusPtr);
+    }
+    else {
+        nanoem_application_plugin_status_assign_error(statusPtr, NANOEM_APPLICATION_PLUGIN_STATUS_ERROR_NULL_OBJECT);
+    }
+    return data;
+}
+
+void APIENTRY
+nanoemApplicationPluginEncoderSubmitVideoFrameBuffer(nanoem_application_plugin_encoder_t *encoder,
+    nanoem_frame_index_t currentFrameIndex, nanoem_u8_t *data, nanoem_i32_t *status)
+{
+    nanoem_application_plugin_status_t *statusPtr = reinterpret_cast<nanoem_application_plugin_status_t *>(status);
+    if (nanoem_is_not_null(encoder)) {
+        encoder->submitVideoFrameBuffer(currentFrameIndex, data, statusPtr);
+    }
+    else {
+        nanoem_application_plugin_status_assign_error(statusPtr, NANOEM_APPLICATION_PLUGIN_STATUS_ERROR_NULL_OBJECT);
+    }
+}
+
 void APIENTRY
 nanoemApplicationPluginEncoderInterrupt(nanoem_application_plugin_encoder_t *encoder, nanoem_i32_t *status)
 {
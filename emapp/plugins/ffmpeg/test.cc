@@ -0,0 +1,153 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "emapp/sdk/Encoder.h"
+
+namespace {
+
+/* rawvideo muxer is chosen by the extension and writes BGR24 frames as is without any external service */
+static const char kEncodedFilePath[] = "plugin_ffmpeg_test_encoded.rgb";
+static const char kSubmittedFilePath[] = "plugin_ffmpeg_test_submitted.rgb";
+static const nanoem_u32_t kWidth = 320;
+static const nanoem_u32_t kHeight = 180;
+static const nanoem_u32_t kNumFrames = 48;
+static const nanoem_u32_t kFrameSize = kWidth * kHeight * 4;
+
+typedef std::vector<nanoem_u8_t> ByteArray;
+
+static int s_numFailures = 0;
+
+static void
+check(bool condition, const char *message)
+{
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", message);
+        s_numFailures++;
+    }
+}
+
+static void
+fillFrame(nanoem_u32_t frameIndex, nanoem_u8_t *data)
+{
+    for (nanoem_u32_t y = 0; y < kHeight; y++) {
+        for (nanoem_u32_t x = 0; x < kWidth; x++) {
+            nanoem_u8_t *pixel = data + (y * kWidth + x) * 4;
+            pixel[0] = nanoem_u8_t(x + frameIndex * 3);
+            pixel[1] = nanoem_u8_t(y * 2 + frameIndex);
+            pixel[2] = nanoem_u8_t((x ^ y) + frameIndex * 7);
+            pixel[3] = 0xff;
+        }
+    }
+}
+
+static ByteArray
+readAllBytes(const char *filePath)
+{
+    ByteArray bytes;
+    if (FILE *fp = fopen(filePath, "rb")) {
+        fseek(fp, 0, SEEK_END);
+        bytes.resize(ftell(fp));
+        fseek(fp, 0, SEEK_SET);
+        if (!bytes.empty() && fread(bytes.data(), bytes.size(), 1, fp) != 1) {
+            bytes.clear();
+        }
+        fclose(fp);
+    }
+    return bytes;
+}
+
+static nanoem_application_plugin_encoder_t *
+openEncoder(const char *filePath, nanoem_u32_t yflip)
+{
+    const nanoem_u32_t fps = 30, width = kWidth, height = kHeight;
+    nanoem_i32_t status = NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS;
+    nanoem_application_plugin_encoder_t *encoder = nanoemApplicationPluginEncoderCreate();
+    nanoemApplicationPluginEncoderSetOption(
+        encoder, NANOEM_APPLICATION_PLUGIN_ENCODER_OPTION_FPS, &fps, sizeof(fps), &status);
+    nanoemApplicationPluginEncoderSetOption(
+        encoder, NANOEM_APPLICATION_PLUGIN_ENCODER_OPTION_VIDEO_WIDTH, &width, sizeof(width), &status);
+    nanoemApplicationPluginEncoderSetOption(
+        encoder, NANOEM_APPLICATION_PLUGIN_ENCODER_OPTION_VIDEO_HEIGHT, &height, sizeof(height), &status);
+    nanoemApplicationPluginEncoderSetOption(
+        encoder, NANOEM_APPLICATION_PLUGIN_ENCODER_OPTION_VIDEO_YFLIP, &yflip, sizeof(yflip), &status);
+    check(nanoemApplicationPluginEncoderOpen(encoder, filePath, &status) != 0, "open encoder");
+    check(status == NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS, "status of opening encoder");
+    return encoder;
+}
+
+static void
+closeEncoder(nanoem_application_plugin_encoder_t *encoder)
+{
+    nanoem_i32_t status = NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS;
+    nanoemApplicationPluginEncoderClose(encoder, &status);
+    check(status == NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS, "status of closing encoder");
+    nanoemApplicationPluginEncoderDestroy(encoder);
+}
+
+static void
+encodeAllFrames(const char *filePath, nanoem_u32_t yflip)
+{
+    nanoem_application_plugin_encoder_t *encoder = openEncoder(filePath, yflip);
+    ByteArray frame(kFrameSize);
+    for (nanoem_u32_t i = 0; i < kNumFrames; i++) {
+        nanoem_i32_t status = NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS;
+        fillFrame(i, frame.data());
+        nanoemApplicationPluginEncoderEncodeVideoFrame(encoder, i, frame.data(), kFrameSize, &status);
+        check(status == NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS, "status of encoding frame");
+    }
+    closeEncoder(encoder);
+}
+
+static void
+submitAllFrames(const char *filePath, nanoem_u32_t yflip)
+{
+    nanoem_application_plugin_encoder_t *encoder = openEncoder(filePath, yflip);
+    nanoem_i32_t status = NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS;
+    check(nanoemApplicationPluginEncoderAcquireVideoFrameBuffer(encoder, kFrameSize / 2, &status) == nullptr,
+        "acquiring buffer with different size falls back");
+    check(status == NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS, "status of acquiring buffer with different size");
+    nanoem_u8_t unknownBuffer[4];
+    nanoemApplicationPluginEncoderSubmitVideoFrameBuffer(encoder, 0, unknownBuffer, &status);
+    check(status != NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS, "submitting unknown buffer is rejected");
+    for (nanoem_u32_t i = 0; i < kNumFrames; i++) {
+        status = NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS;
+        nanoem_u8_t *data = nanoemApplicationPluginEncoderAcquireVideoFrameBuffer(encoder, kFrameSize, &status);
+        check(data != nullptr, "acquire buffer");
+        if (data) {
+            fillFrame(i, data);
+            nanoemApplicationPluginEncoderSubmitVideoFrameBuffer(encoder, i, data, &status);
+            check(status == NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS, "status of submitting buffer");
+        }
+    }
+    closeEncoder(encoder);
+}
+
+} /* namespace anonymous */
+
+int
+main(int /* argc */, char * /* argv */[])
+{
+    nanoemApplicationPluginEncoderInitialize();
+    for (nanoem_u32_t yflip = 0; yflip < 2; yflip++) {
+        encodeAllFrames(kEncodedFilePath, yflip);
+        submitAllFrames(kSubmittedFilePath, yflip);
+        const ByteArray encoded(readAllBytes(kEncodedFilePath)), submitted(readAllBytes(kSubmittedFilePath));
+        check(encoded.size() == kWidth * kHeight * 3 * kNumFrames, "size of all encoded frames");
+        check(encoded.size() == submitted.size() && memcmp(encoded.data(), submitted.data(), encoded.size()) == 0,
+            "submitted frames are same as encoded frames in order");
+    }
+    nanoemApplicationPluginEncoderTerminate();
+    remove(kEncodedFilePath);
+    remove(kSubmittedFilePath);
+    printf("%s\n", s_numFailures == 0 ? "OK" : "FAILED");
+    return s_numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,92 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "emapp/sdk/Encoder.h"
+
+#include "bx/bx.h"
+#include "bx/timer.h"
+#include "tinystl/allocator.h"
+#include "tinystl/vector.h"
+
+namespace {
+
+static const nanoem_u32_t kDefaultWidth = 640;
+static const nanoem_u32_t kDefaultHeight = 360;
+static const nanoem_u32_t kDefaultNumFrames = 120;
+static const nanoem_u32_t kSquareSize = 64;
+
+static void
+fillFrame(nanoem_u32_t frameIndex, nanoem_u32_t width, nanoem_u32_t height, tinystl::vector<nanoem_u8_t> &pixels)
+{
+    /* static gradient background with a moving square to resemble a typical motion preview */
+    const nanoem_u32_t squareX = (frameIndex * 4) % (width - kSquareSize),
+                       squareY = (height - kSquareSize) / 2 + (frameIndex % 32);
+    for (nanoem_u32_t y = 0; y < height; y++) {
+        for (nanoem_u32_t x = 0; x < width; x++) {
+            nanoem_u8_t *pixel = pixels.data() + (y * width + x) * 4;
+            const bool inside =
+                x >= squareX && x < squareX + kSquareSize && y >= squareY && y < squareY + kSquareSize;
+            pixel[0] = inside ? 0xff : nanoem_u8_t(x * 255 / width);
+            pixel[1] = inside ? 0x40 : nanoem_u8_t(y * 255 / height);
+            pixel[2] = inside ? 0x20 : 0x80;
+            pixel[3] = 0xff;
+        }
+    }
+}
+
+static long
+fileSize(const char *filePath)
+{
+    long size = -1;
+    if (FILE *fp = fopen(filePath, "rb")) {
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        fclose(fp);
+    }
+    return size;
+}
+
+} /* namespace anonymous */
+
+int
+main(int argc, char *argv[])
+{
+    const char *filePath = argc > 1 ? argv[1] : "plugin_gif_benchmark.gif";
+    const nanoem_u32_t numFrames = argc > 2 ? nanoem_u32_t(strtoul(argv[2], nullptr, 10)) : kDefaultNumFrames,
+                       width = kDefaultWidth, height = kDefaultHeight, fps = 30, yflip = 0;
+    const nanoem_u32_t size = width * height * 4;
+    tinystl::vector<tinystl::vector<nanoem_u8_t> > frames(numFrames);
+    for (nanoem_u32_t i = 0; i < numFrames; i++) {
+        frames[i].resize(size);
+        fillFrame(i, width, height, frames[i]);
+    }
+    nanoem_i32_t status = 0;
+    nanoemApplicationPluginEncoderInitialize();
+    nanoem_application_plugin_encoder_t *encoder = nanoemApplicationPluginEncoderCreate();
+    nanoemApplicationPluginEncoderSetOption(
+        encoder, NANOEM_APPLICATION_PLUGIN_ENCODER_OPTION_FPS, &fps, sizeof(fps), &status);
+    nanoemApplicationPluginEncoderSetOption(
+        encoder, NANOEM_APPLICATION_PLUGIN_ENCODER_OPTION_VIDEO_WIDTH, &width, sizeof(width), &status);
+    nanoemApplicationPluginEncoderSetOption(
+        encoder, NANOEM_APPLICATION_PLUGIN_ENCODER_OPTION_VIDEO_HEIGHT, &height, sizeof(height), &status);
+    nanoemApplicationPluginEncoderSetOption(
+        encoder, NANOEM_APPLICATION_PLUGIN_ENCODER_OPTION_VIDEO_YFLIP, &yflip, sizeof(yflip), &status);
+    const int64_t start = bx::getHPCounter();
+    nanoemApplicationPluginEncoderOpen(encoder, filePath, &status);
+    for (nanoem_u32_t i = 0; i < numFrames; i++) {
+        nanoemApplicationPluginEncoderEncodeVideoFrame(encoder, i, frames[i].data(), size, &status);
+    }
+    nanoemApplicationPluginEncoderClose(encoder, &status);
+    const double elapsed = double(bx::getHPCounter() - start) / double(bx::getHPFrequency());
+    nanoemApplicationPluginEncoderDestroy(encoder);
+    nanoemApplicationPluginEncoderTerminate();
+    printf("%u frames (%ux%u) in %.3f seconds: %.2f frames/sec, %ld bytes written to %s\n", numFrames, width,
+        height, elapsed, numFrames / elapsed, fileSize(filePath), filePath);
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -25,74 +25,82 @@ namespace {
 using namespace nanoem::application::plugin;
 
 struct GIFEncoder {
-    typedef tinystl::vector<nanoem_u8_t> Frame;
-    typedef tinystl::vector<Frame> FrameQueue;
+    struct Frame {
+        Frame(nanoem_u32_t sequence, nanoem_u32_t size)
+            : m_sequence(sequence)
+            , m_pixels(size)
+        {
+        }
+        nanoem_u32_t m_sequence;
+        tinystl::vector<nanoem_u8_t> m_pixels;
+    };
+    typedef tinystl::vector<Frame *> FrameQueue;
+    static const nanoem_u32_t kNumWorkerThreads = 4;
+    static const nanoem_u32_t kMaxNumPendingFrames = kNumWorkerThreads * 2;
 
+    static void
+    clearFrameQueue(FrameQueue &queue)
+    {
+        for (FrameQueue::const_iterator it = queue.begin(), end = queue.end(); it != end; ++it) {
+            delete *it;
+        }
+        queue.clear();
+    }
     static nanoem_i32_t
-    threadEntry(bx::Thread * /* thread */, void *userData)
+    workerThreadEntry(bx::Thread * /* thread */, void *userData)
     {
         GIFEncoder *self = static_cast<GIFEncoder *>(userData);
-        nanoem_u32_t height = self->m_height;
-        while (true) {
-            size_t count = 0;
-            FrameQueue &queue = self->m_queue;
+        const nanoem_u32_t numPixels = self->m_width * self->m_height;
+        tinystl::vector<nanoem_u8_t> indexedPixels;
+        Frame *frame;
+        while ((frame = self->popSourceFrame()) != nullptr) {
+            /* every frame is mapped to the shared global palette so frames can be indexed in any order */
+            indexedPixels.resize(numPixels);
+            jo_gif_index(&self->m_gif, frame->m_pixels.data(), self->m_gif.palette, indexedPixels.data());
+            frame->m_pixels.swap(indexedPixels);
             {
-                bx::MutexScope scope(self->m_mutex);
-                BX_UNUSED_1(scope);
-                count = queue.size();
-            }
-            if (count == 0) {
-                self->m_sema.wait();
-            }
-            Frame sourceFrame;
-            {
-                bx::MutexScope scope(self->m_mutex);
-                BX_UNUSED_1(scope);
-                sourceFrame = queue.front();
-                queue.erase(queue.begin(), queue.begin() + 1);
-            }
-            if (sourceFrame.empty()) {
-                bx::MutexScope scope(self->m_mutex);
+                bx::MutexScope scope(self->m_indexedMutex);
                 BX_UNUSED_1(scope);
-                queue.clear();
-                break;
-            }
-            Frame destFrame = sourceFrame;
-            destFrame.resize(sourceFrame.size());
-            const nanoem_u8_t *data = sourceFrame.data();
-            nanoem_u8_t *mutableCopy = destFrame.data();
-            nanoem_u32_t size = sourceFrame.size();
-            const nanoem_u32_t stride = nanoem_u32_t(size / height);
-            if (self->m_yflip) {
-                const nanoem_u8_t *sourcePtr = data + stride * height - stride;
-                for (nanoem_u32_t y = 0; y < height; ++y) {
-                    nanoem_u8_t *destPtr = mutableCopy + y * stride;
-                    memcpy(destPtr, sourcePtr, stride);
-                    sourcePtr -= stride;
-                }
+                self->m_indexedFrames.push_back(frame);
             }
-            else {
-                const nanoem_u8_t *sourcePtr = data;
-                for (nanoem_u32_t y = 0; y < height; ++y) {
-                    nanoem_u8_t *destPtr = mutableCopy + y * stride;
-                    memcpy(destPtr, sourcePtr, stride);
-                    sourcePtr += stride;
-                }
+            self->m_indexedSema.post();
+        }
+        return 0;
+    }
+    static nanoem_i32_t
+    writerThreadEntry(bx::Thread * /* thread */, void *userData)
+    {
+        GIFEncoder *self = static_cast<GIFEncoder *>(userData);
+        tinystl::vector<nanoem_u8_t> previousIndexedPixels;
+        bool running = true;
+        while (running) {
+            self->m_indexedSema.wait();
+            Frame *frame;
+            while ((frame = self->popNextIndexedFrame(running)) != nullptr) {
+                const nanoem_u8_t *previousPixels =
+                    !previousIndexedPixels.empty() ? previousIndexedPixels.data() : nullptr;
+                jo_gif_frame_indexed(&self->m_gif, frame->m_pixels.data(), previousPixels, 0);
+                previousIndexedPixels.swap(frame->m_pixels);
+                delete frame;
+                self->m_slotSema.post();
             }
-            jo_gif_frame(&self->m_gif, mutableCopy, 0, false);
         }
         jo_gif_end(&self->m_gif);
         return 0;
     }
 
     GIFEncoder()
-        : m_fps(0)
+        : m_nextSequence(0)
+        , m_numFrames(0)
+        , m_finished(false)
+        , m_fps(0)
         , m_duration(0)
         , m_width(0)
         , m_height(0)
         , m_format(0)
         , m_yflip(0)
     {
+        m_slotSema.post(kMaxNumPendingFrames);
     }
     ~GIFEncoder()
     {
@@ -102,7 +110,10 @@ struct GIFEncoder {
     open(const char *filePath, nanoem_application_plugin_status_t * /* status */)
     {
         m_gif = jo_gif_start(filePath, nanoem_i16_t(m_width), nanoem_i16_t(m_height), 0, 255);
-        m_thread.init(threadEntry, this);
+        for (nanoem_u32_t i = 0; i < kNumWorkerThreads; i++) {
+            m_workerThreads[i].init(workerThreadEntry, this);
+        }
+        m_writerThread.init(writerThreadEntry, this);
         return 1;
     }
     void
@@ -161,23 +172,43 @@ struct GIFEncoder {
     encodeVideoFrame(nanoem_frame_index_t /* currentFrameIndex */, const nanoem_u8_t *data, nanoem_u32_t size,
         nanoem_application_plugin_status_t * /* status */)
     {
+        /* bounds memory usage when the caller produces frames faster than they are encoded */
+        m_slotSema.wait();
+        Frame *frame = new Frame(m_numFrames++, size);
+        const nanoem_u32_t height = m_height, stride = size / height;
+        nanoem_u8_t *destPtr = frame->m_pixels.data();
+        if (m_yflip) {
+            const nanoem_u8_t *sourcePtr = data + stride * height - stride;
+            for (nanoem_u32_t y = 0; y < height; ++y) {
+                memcpy(destPtr + y * stride, sourcePtr, stride);
+                sourcePtr -= stride;
+            }
+        }
+        else {
+            memcpy(destPtr, data, stride * height);
+        }
+        if (frame->m_sequence == 0) {
+            jo_gif_global_palette(&m_gif, destPtr);
+        }
         {
-            bx::MutexScope scope(m_mutex);
+            bx::MutexScope scope(m_sourceMutex);
             BX_UNUSED_1(scope);
-            m_queue.push_back(Frame(data, data + size));
+            m_sourceFrames.push_back(frame);
         }
-        m_sema.post();
+        m_sourceSema.post();
     }
     int
     interrupt(nanoem_application_plugin_status_t * /* status */)
     {
         {
-            bx::MutexScope scope(m_mutex);
+            bx::MutexScope scope(m_sourceMutex);
             BX_UNUSED_1(scope);
-            m_queue.insert(m_queue.begin(), Frame());
+            /* workers stop before the pending frames and they are discarded at shutdown */
+            for (nanoem_u32_t i = 0; i < kNumWorkerThreads; i++) {
+                m_sourceFrames.insert(m_sourceFrames.begin(), nullptr);
+            }
         }
-        m_sema.post();
-        m_thread.shutdown();
+        shutdown();
         return 1;
     }
     const char *
@@ -194,20 +225,80 @@ struct GIFEncoder {
     close(nanoem_application_plugin_status_t * /* status */)
     {
         {
-            bx::MutexScope scope(m_mutex);
+            bx::MutexScope scope(m_sourceMutex);
             BX_UNUSED_1(scope);
-            m_queue.push_back(Frame());
+            for (nanoem_u32_t i = 0; i < kNumWorkerThreads; i++) {
+                m_sourceFrames.push_back(nullptr);
+            }
         }
-        m_sema.post();
-        m_thread.shutdown();
+        shutdown();
         return 1;
     }
 
+    Frame *
+    popSourceFrame()
+    {
+        m_sourceSema.wait();
+        bx::MutexScope scope(m_sourceMutex);
+        BX_UNUSED_1(scope);
+        Frame *frame = m_sourceFrames.front();
+        m_sourceFrames.erase(m_sourceFrames.begin(), m_sourceFrames.begin() + 1);
+        return frame;
+    }
+    Frame *
+    popNextIndexedFrame(bool &running)
+    {
+        bx::MutexScope scope(m_indexedMutex);
+        BX_UNUSED_1(scope);
+        Frame *frame = nullptr;
+        /* frames are indexed out of order but must be written in order to keep the output deterministic */
+        for (FrameQueue::iterator it = m_indexedFrames.begin(), end = m_indexedFrames.end(); it != end; ++it) {
+            if ((*it)->m_sequence == m_nextSequence) {
+                frame = *it;
+                m_indexedFrames.erase(it, it + 1);
+                m_nextSequence++;
+                break;
+            }
+        }
+        if (!frame && m_finished) {
+            running = false;
+        }
+        return frame;
+    }
+    void
+    shutdown()
+    {
+        for (nanoem_u32_t i = 0; i < kNumWorkerThreads; i++) {
+            m_sourceSema.post();
+        }
+        for (nanoem_u32_t i = 0; i < kNumWorkerThreads; i++) {
+            m_workerThreads[i].shutdown();
+        }
+        {
+            bx::MutexScope scope(m_indexedMutex);
+            BX_UNUSED_1(scope);
+            m_finished = true;
+        }
+        m_indexedSema.post();
+        m_writerThread.shutdown();
+        /* frames are left only when the encoding is interrupted */
+        clearFrameQueue(m_sourceFrames);
+        clearFrameQueue(m_indexedFrames);
+    }
+
     jo_gif_t m_gif;
-    bx::Thread m_thread;
-    bx::Mutex m_mutex;
-    bx::Semaphore m_sema;
-    FrameQueue m_queue;
+    bx::Thread m_workerThreads[kNumWorkerThreads];
+    bx::Thread m_writerThread;
+    bx::Mutex m_sourceMutex;
+    bx::Mutex m_indexedMutex;
+    bx::Semaphore m_sourceSema;
+    bx::Semaphore m_indexedSema;
+    bx::Semaphore m_slotSema;
+    FrameQueue m_sourceFrames;
+    FrameQueue m_indexedFrames;
+    nanoem_u32_t m_nextSequence;
+    nanoem_u32_t m_numFrames;
+    bool m_finished;
     nanoem_u32_t m_fps;
     nanoem_u32_t m_duration;
     nanoem_u32_t m_width;
@@ -43,6 +43,22 @@ extern jo_gif_t jo_gif_start(const char *filename, short width, short height, sh
 // localPalette | true if you want a unique palette generated for this frame (does not effect future frames)
 extern void jo_gif_frame(jo_gif_t *gif, unsigned char *rgba, short delayCsec, bool localPalette);
 
+// gif          | the state (returned from jo_gif_start)
+// rgba         | the pixels to generate the global palette used by all frames from
+extern void jo_gif_global_palette(jo_gif_t *gif, const unsigned char *rgba);
+
+// gif          | the state (returned from jo_gif_start)
+// rgba         | the pixels
+// palette      | the palette to map the pixels with dithering (gif->palette for the global palette)
+// indexedPixels| the output, width * height bytes. can be called from multiple threads at once
+extern void jo_gif_index(const jo_gif_t *gif, const unsigned char *rgba, const unsigned char *palette, unsigned char *indexedPixels);
+
+// gif          | the state (returned from jo_gif_start)
+// indexedPixels| the pixels indexed with the global palette by jo_gif_index
+// prevIndexedPixels | the pixels of the previous frame, only the changed rectangle is written if not NULL
+// delayCsec    | amount of time in between frames (in centiseconds)
+extern void jo_gif_frame_indexed(jo_gif_t *gif, const unsigned char *indexedPixels, const unsigned char *prevIndexedPixels, short delayCsec);
+
 // gif          | the state (returned from jo_gif_start)
 extern void jo_gif_end(jo_gif_t *gif);
 
@@ -59,7 +75,7 @@ extern void jo_gif_end(jo_gif_t *gif);
 #include <math.h>
 
 // Based on NeuQuant algorithm
-static void jo_gif_quantize(unsigned char *rgba, int rgbaSize, int sample, unsigned char *map, int numColors) {
+static void jo_gif_quantize(const unsigned char *rgba, int rgbaSize, int sample, unsigned char *map, int numColors) {
 	// defs for freq and bias
 	const int intbiasshift = 16; /* bias for fractions */
 	const int intbias = (((int) 1) << intbiasshift);
@@ -223,7 +239,7 @@ static void jo_gif_lzw_write(jo_gif_lzw_t *s, int code) {
 	}
 }
 
-static void jo_gif_lzw_encode(unsigned char *in, int len, FILE *fp) {
+static void jo_gif_lzw_encode(const unsigned char *in, int len, FILE *fp) {
 	jo_gif_lzw_t state = {fp, 9};
 	int maxcode = 511;
 
@@ -306,60 +322,53 @@ jo_gif_t jo_gif_start(const char *filename, short width, short height, short rep
 	return gif;
 }
 
-void jo_gif_frame(jo_gif_t *gif, unsigned char * rgba, short delayCsec, bool localPalette) {
-	if(!gif->fp) {
-		return;
-	}
-	short width = gif->width;
-	short height = gif->height;
-	int size = width * height;
-
-	unsigned char localPalTbl[0x300];
-	unsigned char *palette = gif->frame == 0 || !localPalette ? gif->palette : localPalTbl;
-	if(gif->frame == 0 || localPalette) {
-		jo_gif_quantize(rgba, size*4, 1, palette, gif->numColors);		
-	}
+void jo_gif_global_palette(jo_gif_t *gif, const unsigned char *rgba) {
+	jo_gif_quantize(rgba, gif->width * gif->height * 4, 1, gif->palette, gif->numColors);
+}
 
-	unsigned char *indexedPixels = (unsigned char *)malloc(size);
-	{
-		unsigned char *ditheredPixels = (unsigned char*)malloc(size*4);
-		memcpy(ditheredPixels, rgba, size*4);
-		for(int k = 0; k < size*4; k+=4) {
-			int rgb[3] = { ditheredPixels[k+0], ditheredPixels[k+1], ditheredPixels[k+2] };
-			int bestd = 0x7FFFFFFF, best = -1;
-			// TODO: exhaustive search. do something better.
-			for(int i = 0; i < gif->numColors; ++i) {
-				int bb = palette[i*3+0]-rgb[0];
-				int gg = palette[i*3+1]-rgb[1];
-				int rr = palette[i*3+2]-rgb[2];
-				int d = bb*bb + gg*gg + rr*rr;
-				if(d < bestd) {
-					bestd = d;
-					best = i;
-				}
-			}
-			indexedPixels[k/4] = best;
-			int diff[3] = { ditheredPixels[k+0] - palette[indexedPixels[k/4]*3+0], ditheredPixels[k+1] - palette[indexedPixels[k/4]*3+1], ditheredPixels[k+2] - palette[indexedPixels[k/4]*3+2] };
-			// Floyd-Steinberg Error Diffusion
-			// TODO: Use something better -- http://caca.zoy.org/study/part3.html
-			if(k+4 < size*4) { 
-				ditheredPixels[k+4+0] = (unsigned char)jo_gif_clamp(ditheredPixels[k+4+0]+(diff[0]*7/16), 0, 255); 
-				ditheredPixels[k+4+1] = (unsigned char)jo_gif_clamp(ditheredPixels[k+4+1]+(diff[1]*7/16), 0, 255); 
-				ditheredPixels[k+4+2] = (unsigned char)jo_gif_clamp(ditheredPixels[k+4+2]+(diff[2]*7/16), 0, 255); 
+void jo_gif_index(const jo_gif_t *gif, const unsigned char *rgba, const unsigned char *palette, unsigned char *indexedPixels) {
+	short width = gif->width;
+	int size = width * gif->height;
+	unsigned char *ditheredPixels = (unsigned char*)malloc(size*4);
+	memcpy(ditheredPixels, rgba, size*4);
+	for(int k = 0; k < size*4; k+=4) {
+		int rgb[3] = { ditheredPixels[k+0], ditheredPixels[k+1], ditheredPixels[k+2] };
+		int bestd = 0x7FFFFFFF, best = -1;
+		// TODO: exhaustive search. do something better.
+		for(int i = 0; i < gif->numColors; ++i) {
+			int bb = palette[i*3+0]-rgb[0];
+			int gg = palette[i*3+1]-rgb[1];
+			int rr = palette[i*3+2]-rgb[2];
+			int d = bb*bb + gg*gg + rr*rr;
+			if(d < bestd) {
+				bestd = d;
+				best = i;
 			}
-			if(k+width*4+4 < size*4) { 
-				for(int i = 0; i < 3; ++i) {
-					ditheredPixels[k-4+width*4+i] = (unsigned char)jo_gif_clamp(ditheredPixels[k-4+width*4+i]+(diff[i]*3/16), 0, 255); 
-					ditheredPixels[k+width*4+i] = (unsigned char)jo_gif_clamp(ditheredPixels[k+width*4+i]+(diff[i]*5/16), 0, 255); 
-					ditheredPixels[k+width*4+4+i] = (unsigned char)jo_gif_clamp(ditheredPixels[k+width*4+4+i]+(diff[i]*1/16), 0, 255); 
-				}
+		}
+		indexedPixels[k/4] = best;
+		int diff[3] = { ditheredPixels[k+0] - palette[indexedPixels[k/4]*3+0], ditheredPixels[k+1] - palette[indexedPixels[k/4]*3+1], ditheredPixels[k+2] - palette[indexedPixels[k/4]*3+2] };
+		// Floyd-Steinberg Error Diffusion
+		// TODO: Use something better -- http://caca.zoy.org/study/part3.html
+		if(k+4 < size*4) { 
+			ditheredPixels[k+4+0] = (unsigned char)jo_gif_clamp(ditheredPixels[k+4+0]+(diff[0]*7/16), 0, 255); 
+			ditheredPixels[k+4+1] = (unsigned char)jo_gif_clamp(ditheredPixels[k+4+1]+(diff[1]*7/16), 0, 255); 
+			ditheredPixels[k+4+2] = (unsigned char)jo_gif_clamp(ditheredPixels[k+4+2]+(diff[2]*7/16), 0, 255); 
+		}
+		if(k+width*4+4 < size*4) { 
+			for(int i = 0; i < 3; ++i) {
+				ditheredPixels[k-4+width*4+i] = (unsigned char)jo_gif_clamp(ditheredPixels[k-4+width*4+i]+(diff[i]*3/16), 0, 255); 
+				ditheredPixels[k+width*4+i] = (unsigned char)jo_gif_clamp(ditheredPixels[k+width*4+i]+(diff[i]*5/16), 0, 255); 
+				ditheredPixels[k+width*4+4+i] = (unsigned char)jo_gif_clamp(ditheredPixels[k+width*4+4+i]+(diff[i]*1/16), 0, 255); 
 			}
 		}
-		free(ditheredPixels);
 	}
+	free(ditheredPixels);
+}
+
+static void jo_gif_write_image(jo_gif_t *gif, const unsigned char *localPalette, const unsigned char *pixels, short x, short y, short width, short height, short delayCsec, int transparentIndex) {
 	if(gif->frame == 0) {
 		// Global Color Table
-		fwrite(palette, 3*(1<<(gif->palSize+1)), 1, gif->fp);
+		fwrite(gif->palette, 3*(1<<(gif->palSize+1)), 1, gif->fp);
 		if(gif->repeat >= 0) {
 			// Netscape Extension
 			fwrite("\x21\xff\x0bNETSCAPE2.0\x03\x01", 16, 1, gif->fp);
@@ -368,26 +377,102 @@ void jo_gif_frame(jo_gif_t *gif, unsigned char * rgba, short delayCsec, bool loc
 		}
 	}
 	// Graphic Control Extension
-	fwrite("\x21\xf9\x04\x00", 4, 1, gif->fp);
+	fwrite("\x21\xf9\x04", 3, 1, gif->fp);
+	// keeps the previous frame under the transparent pixels (disposal method 1)
+	putc(transparentIndex >= 0 ? 0x05 : 0x00, gif->fp);
 	fwrite(&delayCsec, 2, 1, gif->fp); // delayCsec x 1/100 sec
-	fwrite("\x00\x00", 2, 1, gif->fp); // transparent color index (first byte), currently unused
+	putc(transparentIndex >= 0 ? transparentIndex : 0, gif->fp); // transparent color index
+	putc(0, gif->fp); // block terminator
 	// Image Descriptor
-	fwrite("\x2c\x00\x00\x00\x00", 5, 1, gif->fp); // header, x,y
+	putc(0x2c, gif->fp); // header
+	fwrite(&x, 2, 1, gif->fp);
+	fwrite(&y, 2, 1, gif->fp);
 	fwrite(&width, 2, 1, gif->fp);
 	fwrite(&height, 2, 1, gif->fp);
-	if (gif->frame == 0 || !localPalette) {
+	if (!localPalette) {
 		putc(0, gif->fp);
 	} else {
 		putc(0x80|gif->palSize, gif->fp );
-		fwrite(palette, 3*(1<<(gif->palSize+1)), 1, gif->fp);
+		fwrite(localPalette, 3*(1<<(gif->palSize+1)), 1, gif->fp);
 	}
 	putc(8, gif->fp); // block terminator
-	jo_gif_lzw_encode(indexedPixels, size, gif->fp);
+	jo_gif_lzw_encode(pixels, width * height, gif->fp);
 	putc(0, gif->fp); // block terminator
 	++gif->frame;
+}
+
+void jo_gif_frame(jo_gif_t *gif, unsigned char * rgba, short delayCsec, bool localPalette) {
+	if(!gif->fp) {
+		return;
+	}
+	short width = gif->width;
+	short height = gif->height;
+	int size = width * height;
+
+	unsigned char localPalTbl[0x300];
+	unsigned char *palette = gif->frame == 0 || !localPalette ? gif->palette : localPalTbl;
+	if(gif->frame == 0 || localPalette) {
+		jo_gif_quantize(rgba, size*4, 1, palette, gif->numColors);		
+	}
+
+	unsigned char *indexedPixels = (unsigned char *)malloc(size);
+	jo_gif_index(gif, rgba, palette, indexedPixels);
+	jo_gif_write_image(gif, palette != gif->palette ? palette : NULL, indexedPixels, 0, 0, width, height, delayCsec, -1);
 	free(indexedPixels);
 }
 
+void jo_gif_frame_indexed(jo_gif_t *gif, const unsigned char *indexedPixels, const unsigned char *prevIndexedPixels, short delayCsec) {
+	if(!gif->fp) {
+		return;
+	}
+	int width = gif->width;
+	int height = gif->height;
+	int left = 0, top = 0, right = width, bottom = height;
+	int transparentIndex = -1;
+	if(gif->frame > 0 && prevIndexedPixels) {
+		// Bounding rectangle of the changed pixels
+		left = width, top = height, right = 0, bottom = 0;
+		for(int y = 0; y < height; ++y) {
+			const unsigned char *curr = indexedPixels + y*width, *prev = prevIndexedPixels + y*width;
+			if(memcmp(curr, prev, width) != 0) {
+				int x0 = 0, x1 = width;
+				while(curr[x0] == prev[x0]) ++x0;
+				while(curr[x1-1] == prev[x1-1]) --x1;
+				left = x0 < left ? x0 : left;
+				right = x1 > right ? x1 : right;
+				top = y < top ? y : top;
+				bottom = y + 1;
+			}
+		}
+		if(right <= left) {
+			// same as the previous frame, writes a transparent pixel to keep the delay
+			left = top = 0;
+			right = bottom = 1;
+		}
+		// the first unused entry of the color table is used as transparent color
+		if(gif->numColors < (1<<(gif->palSize+1))) {
+			transparentIndex = gif->numColors;
+		}
+	}
+	int rectWidth = right - left, rectHeight = bottom - top;
+	unsigned char *rectPixels = (unsigned char *)malloc(rectWidth * rectHeight);
+	for(int y = 0; y < rectHeight; ++y) {
+		const unsigned char *curr = indexedPixels + (top+y)*width + left;
+		unsigned char *dest = rectPixels + y*rectWidth;
+		if(transparentIndex >= 0) {
+			// unchanged pixels are transparent to make the LZW runs longer
+			const unsigned char *prev = prevIndexedPixels + (top+y)*width + left;
+			for(int x = 0; x < rectWidth; ++x) {
+				dest[x] = curr[x] == prev[x] ? (unsigned char)transparentIndex : curr[x];
+			}
+		} else {
+			memcpy(dest, curr, rectWidth);
+		}
+	}
+	jo_gif_write_image(gif, NULL, rectPixels, (short)left, (short)top, (short)rectWidth, (short)rectHeight, delayCsec, transparentIndex);
+	free(rectPixels);
+}
+
 void jo_gif_end(jo_gif_t *gif) {
 	if(!gif->fp) {
 		return;
@@ -1,5 +1,5 @@
 
-@
+@
 nanoem.gui.unimplemented$未実装のため現在利用不可
 nanoem.gui.camera	カメラ%
 nanoem.gui.keyframe.copy	コピー'
@@ -988,7 +988,11 @@ $nanoem.project.track.selected-morphs選択モーフ5
 $nanoem.error.motion.not-model.reasonE読み込まれたモーションはモデル用ではありません
 /nanoem.error.motion.not-camera-and-light.reasonQ読み込まれたモーションはカメラ及び照明用ではありません
 *nanoem.error.motion.no-active-model.reasonWモデルモーションを読み込むためのモデルが選択されていません_
-7nanoem.error.motion.no-active-model.recovery-suggestion$モデルを選択してくださいw
+7nanoem.error.motion.no-active-model.recovery-suggestion$モデルを選択してください`
+&nanoem.error.project.copy-bones.reason6コピーするボーンが選択されていませんj
+3nanoem.error.project.copy-bones.recovery-suggestion3コピーするボーンを選択してくださいa
+'nanoem.error.project.paste-bones.reason6コピーしたボーンがモデルにありません}
+4nanoem.error.project.paste-bones.recovery-suggestionEコピーしたボーンを持つモデルを選択してくださいw
 %nanoem.error.project.new-model.reasonN新規モデルを作成するにはプロジェクトの保存が必要です
 &nanoem.error.project.open-model.reasonWモデル編集ダイアログを開くにはプロジェクトの保存が必要です`
  nanoem.project.diagnostics.title<プロジェクトの一部ファイルの読み込み失敗
@@ -1182,7 +1186,7 @@ Ananoem.status.ERROR_DOCUMENT_MODEL_OUTSIDE_PARENT_STATE_NOT_FOUND3モーフの
 ;nanoem.status.ERROR_DOCUMENT_MODEL_OUTSIDE_PARENT_CORRUPTED-モデルの外部親が破損していますl
 2nanoem.status.ERROR_DOCUMENT_SELF_SHADOW_CORRUPTED6セルフシャドウデータが破損しています
 ;nanoem.status.ERROR_DOCUMENT_SELF_SHADOW_KEYFRAME_CORRUPTEDBセルフシャドウのキーフレームが破損しています
-F
+F
 nanoem.gui.unimplemented*Currently Unavailable due to unimplemented
 nanoem.gui.cameraCamera 
 nanoem.gui.keyframe.copyCopy
@@ -2192,7 +2196,11 @@ All Morphs#
 $nanoem.error.motion.not-model.reason,The loading motion is not intended for modelf
 /nanoem.error.motion.not-camera-and-light.reason3The loading motion is not intended for camera/light`
 *nanoem.error.motion.no-active-model.reason2The model is not selected to load the model motionR
-7nanoem.error.motion.no-active-model.recovery-suggestionTry selecting the model]
+7nanoem.error.motion.no-active-model.recovery-suggestionTry selecting the modelG
+&nanoem.error.project.copy-bones.reasonNo bones are selected to copyX
+3nanoem.error.project.copy-bones.recovery-suggestion!Try selecting the bone(s) to copyZ
+'nanoem.error.project.paste-bones.reason/None of the copied bones are found in the modelk
+4nanoem.error.project.paste-bones.recovery-suggestion3Try selecting the model that has the copied bone(s)]
 %nanoem.error.project.new-model.reason4Saving the project is required to create a new modelg
 &nanoem.error.project.open-model.reason=Saving the project is required to open model parameter dialogH
  nanoem.project.diagnostics.title$Loading Project with Partial Failurel
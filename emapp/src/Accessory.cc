@@ -17,6 +17,7 @@
 #include "emapp/ILight.h"
 #include "emapp/ImageLoader.h"
 #include "emapp/ListUtils.h"
+#include "emapp/Profiler.h"
 #include "emapp/Progress.h"
 #include "emapp/Project.h"
 #include "emapp/StringUtils.h"
@@ -610,6 +611,7 @@ Accessory::reset()
 void
 Accessory::draw(DrawType type)
 {
+    EMAPP_PROFILE_SCOPE("Accessory::draw");
     if (isVisible()) {
         switch (type) {
         case IDrawable::kDrawTypeColor:
@@ -675,6 +677,7 @@ Accessory::setOffscreenPassiveRenderTargetEffect(const String &ownerName, IEffec
                     innerEffect->createAllDrawableRenderTargetColorImages(this);
                 }
             }
+            m_project->invalidateAllOffscreenRenderTargetPlans();
         }
     }
 }
@@ -690,6 +693,7 @@ Accessory::removeOffscreenPassiveRenderTargetEffect(const String &ownerName)
             m_offscreenPassiveRenderTargetEffects.find(ownerName);
         if (it != m_offscreenPassiveRenderTargetEffects.end()) {
             m_offscreenPassiveRenderTargetEffects.erase(it);
+            m_project->invalidateAllOffscreenRenderTargetPlans();
         }
     }
 }
@@ -713,6 +717,7 @@ Accessory::setOffscreenPassiveRenderTargetEffectEnabled(const String &ownerName,
             OffscreenPassiveRenderTargetEffect effect = { nullptr, value };
             m_offscreenPassiveRenderTargetEffects.insert(tinystl::make_pair(ownerName, effect));
         }
+        m_project->invalidateAllOffscreenRenderTargetPlans();
     }
 }
 
@@ -849,6 +854,7 @@ Accessory::setFileURI(const URI &value)
 {
     m_fileURI = value;
     m_canonicalName = URI::lastPathComponent(value.absolutePath());
+    m_project->invalidateAllObjectBindings();
 }
 
 const IEffect *
@@ -362,6 +362,7 @@ AccessoryProgramBundle::CommonPass::execute(const IDrawable * /* drawable */, co
         pipeline = sg::make_pipeline(&desc);
         nanoem_assert(sg::query_pipeline_state(pipeline) == SG_RESOURCESTATE_VALID, "pipeline must be valid");
         project->setRenderPipelineName(pipeline, label);
+        project->setRenderPipelineSortable(pipeline, desc, this);
         m_pipelines.insert(tinystl::make_pair(key, pipeline));
     }
     m_bindings.vertex_buffers[0] = buffer.m_vertexBuffer;
@@ -36,6 +36,7 @@
 #include "emapp/ModalDialogFactory.h"
 #include "emapp/Model.h"
 #include "emapp/ModelProgramBundle.h"
+#include "emapp/Profiler.h"
 #include "emapp/Progress.h"
 #include "emapp/Project.h"
 #include "emapp/ResourceBundle.h"
@@ -1654,6 +1655,7 @@ BaseApplicationService::~BaseApplicationService() NANOEM_DECL_NOEXCEPT
     nanoem_delete_safe(m_eventPublisher);
     nanoem_delete_safe(m_stateController);
     nanoem_delete_safe(m_window);
+    Profiler::terminate();
 }
 
 void
@@ -1712,6 +1714,10 @@ BaseApplicationService::createProject(const Vector2UI16 &logicalPixelWindowSize,
     }
     project->setEffectPluginEnabled(preference.isEffectEnabled());
     project->setCompiledEffectCacheEnabled(preference.isEffectCacheEnabled());
+    if (json_object_dotget_string(json_object(m_applicationConfiguration), "project.profiler.path")) {
+        Profiler::clear();
+        Profiler::setEnabled(true);
+    }
     const Vector2UI16 devicePixelWindowSize(Vector2(logicalPixelWindowSize) * project->windowDevicePixelRatio());
     m_window->resizeDevicePixelWindowSize(devicePixelWindowSize);
     if (g_sentryAvailable) {
@@ -1734,6 +1740,14 @@ BaseApplicationService::destroyProject(Project *project)
     if (nanoem_likely(project)) {
         m_window->reset(project);
         project->stop();
+        if (const char *path =
+                json_object_dotget_string(json_object(m_applicationConfiguration), "project.profiler.path")) {
+            Error error;
+            Profiler::setEnabled(false);
+            if (!Profiler::exportChromeTrace(URI::createFromFilePath(path), error)) {
+                EMLOG_WARN("Cannot write CPU profile to {}: {}", path, error.reasonConstString());
+            }
+        }
         if (project->hasTransientPath()) {
             FileUtils::TransientPath path(project->transientPath());
             FileUtils::deleteTransientFile(path);
@@ -5341,6 +5355,7 @@ BaseApplicationService::drawDefaultPass()
         const bool active = project->isActive();
         if (active) {
             OPTICK_FRAME(__PRETTY_FUNCTION__);
+            EMAPP_PROFILE_SCOPE("BaseApplicationService::drawDefaultPass");
             beginDrawContext();
             draw(project);
             sg::commit();
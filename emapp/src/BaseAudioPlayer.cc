@@ -10,12 +10,16 @@
 #include "emapp/FileUtils.h"
 #include "emapp/ListUtils.h"
 #include "emapp/URI.h"
+#include "emapp/internal/LinearPCMStream.h"
 #include "emapp/private/CommonInclude.h"
 
 namespace nanoem {
 
 const size_t BaseAudioPlayer::kRIFFTagSize = 44;
 
+/* 256KiB of 16bit stereo samples per read to feed the player */
+static const nanoem_rsize_t kNumStreamingFrames = 0x10000;
+
 static const nanoem_u8_t *
 findLinearPCMSamplesPayload(
     const nanoem_u8_t *dataPtr, nanoem_rsize_t dataSize, BaseAudioPlayer::Format &format, nanoem_rsize_t &payloadSize)
@@ -163,6 +167,41 @@ BaseAudioPlayer::load(const ByteArray &bytes, const WAVDescription &desc, Error
     return loadAllLinearPCMSamples(bytes.data(), bytes.size(), error);
 }
 
+bool
+BaseAudioPlayer::load(ISeekableReader *reader, Error &error)
+{
+    internal::LinearPCMStream stream(reader, kNumStreamingFrames);
+    bool succeeded = false;
+    if (stream.open(error)) {
+        /*
+         * keep the same contract as load(const ByteArray &): the description has the file size and players
+         * receive the payload followed by WAVHeader sized bytes, which are silence here
+         */
+        const Format &format = stream.format();
+        const nanoem_rsize_t bytesPerFrame = stream.bytesPerFrame(),
+                             payloadSize = static_cast<nanoem_rsize_t>(stream.numFrames() * bytesPerFrame);
+        ByteArray &samples = m_streamedLinearPCMSamples;
+        samples.resize(payloadSize + sizeof(WAVHeader));
+        nanoem_rsize_t offset = 0;
+        while (offset < payloadSize) {
+            const nanoem_rsize_t numReadFrames = stream.read(samples.data() + offset, kNumStreamingFrames, error);
+            if (numReadFrames == 0) {
+                break;
+            }
+            offset += numReadFrames * bytesPerFrame;
+        }
+        if (offset == payloadSize && !error.hasReason()) {
+            initializeDescription(nanoem_u8_t(format.m_bitsPerSample), format.m_numChannels, format.m_sampleRate,
+                reader->size(), m_description);
+            succeeded = loadAllLinearPCMSamples(samples.data(), samples.size(), error);
+        }
+        /* releases either the previous samples swapped by players or the rest of failure */
+        ByteArray released;
+        samples.swap(released);
+    }
+    return succeeded;
+}
+
 void
 BaseAudioPlayer::play()
 {
@@ -325,6 +364,18 @@ BaseAudioPlayer::setVolumeGain(nanoem_f32_t value)
     }
 }
 
+void
+BaseAudioPlayer::assignLinearPCMSamples(const nanoem_u8_t *data, nanoem_rsize_t size)
+{
+    /* samples streamed by load(ISeekableReader *) are taken over without copying after players stopped */
+    if (data == m_streamedLinearPCMSamples.data() && size == m_streamedLinearPCMSamples.size()) {
+        m_linearPCMSamples.swap(m_streamedLinearPCMSamples);
+    }
+    else {
+        m_linearPCMSamples.assign(data, data + size);
+    }
+}
+
 void
 BaseAudioPlayer::reset()
 {
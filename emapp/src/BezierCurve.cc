@@ -18,17 +18,12 @@ BezierCurve::BezierCurve(const Vector2U8 &c0, const Vector2U8 &c1, nanoem_frame_
     , m_c1(c1)
     , m_interval(interval)
 {
-    interval = glm::max(interval, nanoem_frame_index_t(16));
-    m_parameters.resize(interval + 1);
+    const nanoem_frame_index_t numSamples = BezierCurve::numSamples(interval);
+    m_parameters.resize(numSamples);
     const Vector2 c0f(c0), c1f(c1);
-    const nanoem_f32_t intervalFloat = nanoem_f32_t(interval);
-    for (nanoem_frame_index_t i = 0; i <= interval; i++) {
-        const nanoem_f32_t t = i / intervalFloat;
-        const nanoem_f32_t it = 1.0f - t;
-        const Vector2 &v = ((kP0 * glm::pow(it, 3.0f)) + (c0f * t * glm::pow(it, 2.0f) * 3.0f) +
-                               (c1f * it * glm::pow(t, 2.0f) * 3.0f) + (kP1 * glm::pow(t, 3.0f))) /
-            kP1;
-        m_parameters[i] = v;
+    const nanoem_f32_t intervalFloat = nanoem_f32_t(numSamples - 1);
+    for (nanoem_frame_index_t i = 0; i < numSamples; i++) {
+        m_parameters[i] = interpolate(c0f, c1f, i / intervalFloat);
     }
 }
 
@@ -102,6 +97,21 @@ BezierCurve::toHash(const nanoem_u8_t *parameters, nanoem_frame_index_t interval
     return hash.value;
 }
 
+Vector2
+BezierCurve::interpolate(const Vector2 &c0, const Vector2 &c1, nanoem_f32_t t) NANOEM_DECL_NOEXCEPT
+{
+    const nanoem_f32_t it = 1.0f - t;
+    return ((kP0 * glm::pow(it, 3.0f)) + (c0 * t * glm::pow(it, 2.0f) * 3.0f) + (c1 * it * glm::pow(t, 2.0f) * 3.0f) +
+               (kP1 * glm::pow(t, 3.0f))) /
+        kP1;
+}
+
+nanoem_frame_index_t
+BezierCurve::numSamples(nanoem_frame_index_t interval) NANOEM_DECL_NOEXCEPT
+{
+    return glm::max(interval, nanoem_frame_index_t(16)) + 1;
+}
+
 void
 BezierCurve::splitBezierCurve(const PointList &points, nanoem_f32_t t, PointList &left, PointList &right)
 {
@@ -122,4 +132,79 @@ BezierCurve::splitBezierCurve(const PointList &points, nanoem_f32_t t, PointList
     }
 }
 
+PackedBezierCurve::PackedBezierCurve(
+    const nanoem_u8_t *const *parameters, nanoem_rsize_t numCurves, nanoem_frame_index_t interval)
+    : m_interval(interval)
+    , m_numCurves(glm::min(numCurves, nanoem_rsize_t(kMaxNumCurves)))
+    , m_numGroups((m_numCurves + 3) / 4)
+{
+    Inline::clearZeroMemory(m_parameters);
+    for (nanoem_rsize_t i = 0; i < m_numCurves; i++) {
+        memcpy(m_parameters[i], parameters[i], sizeof(m_parameters[i]));
+    }
+    const nanoem_frame_index_t numSamples = BezierCurve::numSamples(interval);
+    const nanoem_f32_t intervalFloat = nanoem_f32_t(numSamples - 1);
+    nanoem_f32_t x[kMaxNumCurves], y[kMaxNumCurves];
+    m_x.resize(numSamples * m_numGroups);
+    m_y.resize(numSamples * m_numGroups);
+    for (nanoem_frame_index_t i = 0; i < numSamples; i++) {
+        const nanoem_f32_t t = i / intervalFloat;
+        for (nanoem_rsize_t j = 0; j < m_numGroups * 4; j++) {
+            /* padding lanes are never read back */
+            const nanoem_u8_t *p = parameters[glm::min(j, m_numCurves - 1)];
+            const Vector2 v(BezierCurve::interpolate(Vector2(p[0], p[1]), Vector2(p[2], p[3]), t));
+            x[j] = v.x;
+            y[j] = v.y;
+        }
+        for (nanoem_rsize_t j = 0; j < m_numGroups; j++) {
+            const nanoem_rsize_t offset = j * 4;
+            m_x[i * m_numGroups + j] = bx::simd_ld(x[offset], x[offset + 1], x[offset + 2], x[offset + 3]);
+            m_y[i * m_numGroups + j] = bx::simd_ld(y[offset], y[offset + 1], y[offset + 2], y[offset + 3]);
+        }
+    }
+}
+
+PackedBezierCurve::~PackedBezierCurve() NANOEM_DECL_NOEXCEPT
+{
+}
+
+void
+PackedBezierCurve::values(nanoem_f32_t value, nanoem_f32_t *result) const NANOEM_DECL_NOEXCEPT
+{
+    const bx::simd128_t v = bx::simd_splat(value);
+    const nanoem_rsize_t numSamples = m_x.size() / glm::max(m_numGroups, nanoem_rsize_t(1));
+    BX_ALIGN_DECL_16(nanoem_f32_t nearest[kMaxNumCurves]);
+    for (nanoem_rsize_t j = 0; j < m_numGroups; j++) {
+        /* same as BezierCurve::value, the first nearest sample wins and P1 is the initial candidate */
+        bx::simd128_t nearestY = bx::simd_splat(BezierCurve::kP1.y),
+                      nearestDistance = bx::simd_abs(bx::simd_sub(bx::simd_splat(BezierCurve::kP1.x), v));
+        for (nanoem_rsize_t i = 0; i < numSamples; i++) {
+            const nanoem_rsize_t offset = i * m_numGroups + j;
+            const bx::simd128_t distance = bx::simd_abs(bx::simd_sub(m_x[offset], v));
+            const bx::simd128_t mask = bx::simd_cmplt(distance, nearestDistance);
+            nearestDistance = bx::simd_selb(mask, distance, nearestDistance);
+            nearestY = bx::simd_selb(mask, m_y[offset], nearestY);
+        }
+        bx::simd_st(nearest + j * 4, nearestY);
+    }
+    memcpy(result, nearest, sizeof(*result) * m_numCurves);
+}
+
+bool
+PackedBezierCurve::isSame(
+    const nanoem_u8_t *const *parameters, nanoem_frame_index_t interval) const NANOEM_DECL_NOEXCEPT
+{
+    bool same = m_interval == interval;
+    for (nanoem_rsize_t i = 0; same && i < m_numCurves; i++) {
+        same = memcmp(m_parameters[i], parameters[i], sizeof(m_parameters[i])) == 0;
+    }
+    return same;
+}
+
+nanoem_rsize_t
+PackedBezierCurve::numCurves() const NANOEM_DECL_NOEXCEPT
+{
+    return m_numCurves;
+}
+
 } /* namespace nanoem */
@@ -641,13 +641,13 @@ CommandRegistrator::registerScaleAllMotionKeyframesInCommand(
         if (Motion *modelMotionPtr = m_project->resolveMotion(model)) {
             modelMotionPtr->save(snapshot, model, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
             if (EnumUtils::isEnabled(flags, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE)) {
-                modelMotionPtr->scaleAllBoneKeyframesIn(model, range.m_from, range.m_to, scaleFactor);
+                modelMotionPtr->scaleAllBoneKeyframesIn(range.m_from, range.m_to, scaleFactor);
             }
             if (EnumUtils::isEnabled(flags, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MODEL)) {
                 modelMotionPtr->scaleAllModelKeyframesIn(range.m_from, range.m_to, scaleFactor);
             }
             if (EnumUtils::isEnabled(flags, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MORPH)) {
-                modelMotionPtr->scaleAllMorphKeyframesIn(model, range.m_from, range.m_to, scaleFactor);
+                modelMotionPtr->scaleAllMorphKeyframesIn(range.m_from, range.m_to, scaleFactor);
             }
             commands.push_back(command::MotionSnapshotCommand::create(modelMotionPtr, model, snapshot, flags));
         }
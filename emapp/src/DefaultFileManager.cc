@@ -25,6 +25,7 @@
 #include "emapp/Progress.h"
 #include "emapp/Project.h"
 #include "emapp/StringUtils.h"
+#include "emapp/internal/FileContentDigestCache.h"
 #include "emapp/internal/ModelEffectSetting.h"
 #include "emapp/plugin/DecoderPlugin.h"
 #include "emapp/plugin/EncoderPlugin.h"
@@ -433,15 +434,11 @@ DefaultFileManager::loadAudioFile(const URI &fileURI, Project *project, Error &e
         if (BaseAudioPlayer::isLoadableExtension(fileURI)) {
             FileReaderScope scope(&m_translator);
             if (scope.open(fileURI, error)) {
-                ByteArray bytes;
-                FileUtils::read(scope, bytes, error);
-                if (!error.hasReason()) {
-                    IAudioPlayer *audio = project->audioPlayer();
-                    if (audio->load(bytes, error)) {
-                        audio->setFileURI(fileURI);
-                        project->setBaseDuration(audio);
-                        succeeded = true;
-                    }
+                IAudioPlayer *audio = project->audioPlayer();
+                if (audio->load(scope.reader(), error)) {
+                    audio->setFileURI(fileURI);
+                    project->setBaseDuration(audio);
+                    succeeded = true;
                 }
             }
         }
@@ -1182,21 +1179,23 @@ DefaultFileManager::internalLoadAccessoryFromFile(
     nanoem_parameter_assert(!fileURI.isEmpty(), "must NOT be empty");
     nanoem_parameter_assert(accessory, "must not be nullptr");
     FileReaderScope scope(&m_translator);
-    bool succeeded = false;
+    ByteArray bytes;
+    /* the content may be already read to test its digest on loading the project */
+    bool succeeded = false, readable = accessory->project()->fileContentDigestCache()->takeContent(fileURI, bytes);
     progress.tryLoadingItem(fileURI);
-    if (scope.open(fileURI, error)) {
-        ByteArray bytes;
+    if (!readable && scope.open(fileURI, error)) {
         FileUtils::read(scope, bytes, error);
-        if (!error.hasReason() && accessory->load(bytes, error)) {
-            accessory->setFileURI(fileURI);
-            accessory->upload();
-            accessory->loadAllImages(progress, error);
-            succeeded = !error.isCancelled();
-            if (succeeded) {
-                accessory->writeLoadCommandMessage(error);
-                EMLOG_INFO("Loaded an accessory: name={} handle={}", accessory->canonicalNameConstString(),
-                    accessory->handle());
-            }
+        readable = true;
+    }
+    if (readable && !error.hasReason() && accessory->load(bytes, error)) {
+        accessory->setFileURI(fileURI);
+        accessory->upload();
+        accessory->loadAllImages(progress, error);
+        succeeded = !error.isCancelled();
+        if (succeeded) {
+            accessory->writeLoadCommandMessage(error);
+            EMLOG_INFO(
+                "Loaded an accessory: name={} handle={}", accessory->canonicalNameConstString(), accessory->handle());
         }
     }
     return succeeded;
@@ -1208,14 +1207,15 @@ DefaultFileManager::internalLoadModelFromFile(const URI &fileURI, Model *model,
     nanoem_parameter_assert(!fileURI.isEmpty(), "must NOT be empty");
     nanoem_parameter_assert(model, "must NOT be nullptr");
     FileReaderScope scope(&m_translator);
-    bool succeeded = false;
-    if (scope.open(fileURI, error)) {
-        ByteArray bytes;
+    ByteArray bytes;
+    bool succeeded = false, readable = model->project()->fileContentDigestCache()->takeContent(fileURI, bytes);
+    if (!readable && scope.open(fileURI, error)) {
         FileUtils::read(scope, bytes, error);
-        if (!error.hasReason() && model->load(bytes, error)) {
-            model->setFileURI(fileURI);
-            succeeded = true;
-        }
+        readable = true;
+    }
+    if (readable && !error.hasReason() && model->load(bytes, error)) {
+        model->setFileURI(fileURI);
+        succeeded = true;
     }
     return succeeded;
 }
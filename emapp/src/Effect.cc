@@ -38,6 +38,7 @@ pfn_D3DCompile g_D3DCompile = nullptr;
 #include "emapp/ModelProgramBundle.h"
 #include "emapp/PixelFormat.h"
 #include "emapp/PluginFactory.h"
+#include "emapp/Profiler.h"
 #include "emapp/Progress.h"
 #include "emapp/Project.h"
 #include "emapp/ShadowCamera.h"
@@ -1393,6 +1394,8 @@ Effect::~Effect() NANOEM_DECL_NOEXCEPT
     m_imageFormats.clear();
     m_fallbackAccessoryProgramBundle = nullptr;
     m_fallbackModelProgramBundle = nullptr;
+    /* retained blocks may be keyed by passes of this effect so they must not be reused */
+    m_globalUniformPtr->invalidateAll();
     m_globalUniformPtr = nullptr;
     m_project = nullptr;
 }
@@ -1977,8 +1980,9 @@ Effect::upload(effect::AttachmentType type, const Archiver *archiver, Progress &
                 else {
                     value.push_back(Constants::kZeroV4);
                 }
-                m_boolParameterUniforms.insert(
-                    tinystl::make_pair(name, NonSemanticParameter(name, value, parameter.m_annotations)));
+                NonSemanticParameter uniform(name, value, parameter.m_annotations);
+                uniform.m_uniformSlotIndex = findUniformSlotIndex(name);
+                m_boolParameterUniforms.insert(tinystl::make_pair(name, uniform));
                 break;
             }
             case kParameterTypeInt: {
@@ -1995,8 +1999,9 @@ Effect::upload(effect::AttachmentType type, const Archiver *archiver, Progress &
                 else {
                     value.push_back(Constants::kZeroV4);
                 }
-                m_intParameterUniforms.insert(
-                    tinystl::make_pair(name, NonSemanticParameter(name, value, parameter.m_annotations)));
+                NonSemanticParameter uniform(name, value, parameter.m_annotations);
+                uniform.m_uniformSlotIndex = findUniformSlotIndex(name);
+                m_intParameterUniforms.insert(tinystl::make_pair(name, uniform));
                 break;
             }
             case kParameterTypeFloat: {
@@ -2013,8 +2018,9 @@ Effect::upload(effect::AttachmentType type, const Archiver *archiver, Progress &
                 else {
                     value.push_back(Constants::kZeroV4);
                 }
-                m_floatParameterUniforms.insert(
-                    tinystl::make_pair(name, NonSemanticParameter(name, value, parameter.m_annotations)));
+                NonSemanticParameter uniform(name, value, parameter.m_annotations);
+                uniform.m_uniformSlotIndex = findUniformSlotIndex(name);
+                m_floatParameterUniforms.insert(tinystl::make_pair(name, uniform));
                 break;
             }
             case kParameterTypeFloat4: {
@@ -2044,8 +2050,9 @@ Effect::upload(effect::AttachmentType type, const Archiver *archiver, Progress &
                     else {
                         value.push_back(Constants::kZeroV4);
                     }
-                    m_vectorParameterUniforms.insert(
-                        tinystl::make_pair(name, NonSemanticParameter(name, value, parameter.m_annotations)));
+                    NonSemanticParameter uniform(name, value, parameter.m_annotations);
+                    uniform.m_uniformSlotIndex = findUniformSlotIndex(name);
+                    m_vectorParameterUniforms.insert(tinystl::make_pair(name, uniform));
                 }
                 break;
             }
@@ -2682,11 +2689,48 @@ Effect::viewPassSet() const
     return m_viewPassSet;
 }
 
+nanoem_u32_t
+Effect::resolveUniformSlotIndex(const String &name)
+{
+    effect::UniformSlotIndexMap::const_iterator it = m_uniformSlotIndices.find(name);
+    nanoem_u32_t index;
+    if (it != m_uniformSlotIndices.end()) {
+        index = it->second;
+    }
+    else {
+        index = Inline::saturateInt32U(m_uniformSlotNames.size());
+        m_uniformSlotIndices.insert(tinystl::make_pair(name, index));
+        m_uniformSlotNames.push_back(name);
+    }
+    return index;
+}
+
 void
 Effect::setGlobalParameters(const IDrawable *drawable, const Project *project, effect::Pass *pass)
 {
+    EMAPP_PROFILE_SCOPE("Effect::setGlobalParameters");
     nanoem_parameter_assert(project, "must not be nullptr");
     nanoem_parameter_assert(pass, "must not be nullptr");
+    const Vector4 viewportParameterValue(project->deviceScaleUniformedViewportImageSize(), 0, 0);
+    const Matrix4x4 blockParameter(viewportParameterValue, Vector4(0), Vector4(0), Vector4(0));
+    m_globalUniformPtr->acquire(pass, drawable);
+    if (!m_globalUniformPtr->retain(GlobalUniform::kBlockTypeGlobal, pass, drawable, blockParameter)) {
+        writeGlobalParameterBlock(project, viewportParameterValue, pass);
+    }
+    const NamedRenderTargetColorImageContainerMap *containers = findNamedRenderTargetColorImageContainerMap(drawable);
+    setFoundImageSamplers(m_textureResourceUniforms, m_resourceImages, pass);
+    setFoundImageSamplers(m_renderTargetColorUniforms, *containers, pass);
+    setFoundImageSamplers(m_offscreenRenderTargetUniforms, m_offscreenRenderTargetImages, pass);
+    setTextureValues(m_resourceImages, pass);
+    setTextureValues(*containers, pass);
+    setTextureValues(m_offscreenRenderTargetImages, pass);
+    m_initializeGlobal = true;
+}
+
+void
+Effect::writeGlobalParameterBlock(
+    const Project *project, const Vector4 &viewportParameterValue, const effect::Pass *pass)
+{
     for (BoolParameterUniformMap::const_iterator it = m_boolParameterUniforms.begin(),
                                                  end = m_boolParameterUniforms.end();
          it != end; ++it) {
@@ -2711,191 +2755,190 @@ Effect::setGlobalParameters(const IDrawable *drawable, const Project *project, e
         writeUniformBuffer(parameter.m_name, pass, parameter);
     }
     if (!m_viewportPixelUniforms.empty()) {
-        const Vector4 viewportParameterValue(project->deviceScaleUniformedViewportImageSize(), 0, 0);
-        for (SemanticUniformList::const_iterator it = m_viewportPixelUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_viewportPixelUniforms.begin(),
                                                  end = m_viewportPixelUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, viewportParameterValue);
+            writeUniformSlot(it->second, pass, viewportParameterValue);
         }
     }
     if (!m_timeUniforms.empty()) {
         const Vector4 time(project->currentLocalFrameIndex() / nanoem_f32_t(project->baseFPS()));
-        for (SemanticUniformList::const_iterator it = m_timeUniforms.begin(), end = m_timeUniforms.end(); it != end;
+        for (UniformSlotIndexMap::const_iterator it = m_timeUniforms.begin(), end = m_timeUniforms.end(); it != end;
              ++it) {
-            writeUniformBuffer(*it, pass, time);
+            writeUniformSlot(it->second, pass, time);
         }
     }
     if (!m_elapsedTimeUniforms.empty()) {
         const Vector4 elapsedTime(project->elapsedLocalFrameIndex() / nanoem_f32_t(project->baseFPS()));
-        for (SemanticUniformList::const_iterator it = m_elapsedTimeUniforms.begin(), end = m_elapsedTimeUniforms.end();
+        for (UniformSlotIndexMap::const_iterator it = m_elapsedTimeUniforms.begin(), end = m_elapsedTimeUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, elapsedTime);
+            writeUniformSlot(it->second, pass, elapsedTime);
         }
     }
     if (!m_systemTimeUniforms.empty()) {
         const Vector4 systemTime(glm::dvec4(project->currentUptimeSeconds()));
-        for (SemanticUniformList::const_iterator it = m_systemTimeUniforms.begin(), end = m_systemTimeUniforms.end();
+        for (UniformSlotIndexMap::const_iterator it = m_systemTimeUniforms.begin(), end = m_systemTimeUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, systemTime);
+            writeUniformSlot(it->second, pass, systemTime);
         }
     }
     if (!m_elapsedSystemTimeUniforms.empty()) {
         const Vector4 elapsedSystemTime(glm::dvec4(project->elapsedUptimeSeconds()));
-        for (SemanticUniformList::const_iterator it = m_elapsedSystemTimeUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_elapsedSystemTimeUniforms.begin(),
                                                  end = m_elapsedSystemTimeUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, elapsedSystemTime);
+            writeUniformSlot(it->second, pass, elapsedSystemTime);
         }
     }
     if (!m_mousePositionUniforms.empty()) {
         const Vector4 mousePosition(project->logicalScaleMovingCursorPosition(), 0.0, 0.0f);
-        for (SemanticUniformList::const_iterator it = m_mousePositionUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_mousePositionUniforms.begin(),
                                                  end = m_mousePositionUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, mousePosition);
+            writeUniformSlot(it->second, pass, mousePosition);
         }
     }
     if (!m_leftMouseDownUniforms.empty()) {
         const Vector4 leftMouseDown(project->logicalScaleLastCursorPosition(Project::kCursorTypeMouseLeft));
-        for (SemanticUniformList::const_iterator it = m_leftMouseDownUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_leftMouseDownUniforms.begin(),
                                                  end = m_leftMouseDownUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, leftMouseDown);
+            writeUniformSlot(it->second, pass, leftMouseDown);
         }
     }
     if (!m_middleMouseDownUniforms.empty()) {
         const Vector4 middleMouseDown(project->logicalScaleLastCursorPosition(Project::kCursorTypeMouseMiddle));
-        for (SemanticUniformList::const_iterator it = m_middleMouseDownUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_middleMouseDownUniforms.begin(),
                                                  end = m_middleMouseDownUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, middleMouseDown);
+            writeUniformSlot(it->second, pass, middleMouseDown);
         }
     }
     if (!m_rightMouseDownUniforms.empty()) {
         const Vector4 rightMouseDown(project->logicalScaleLastCursorPosition(Project::kCursorTypeMouseRight));
-        for (SemanticUniformList::const_iterator it = m_rightMouseDownUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_rightMouseDownUniforms.begin(),
                                                  end = m_rightMouseDownUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, rightMouseDown);
+            writeUniformSlot(it->second, pass, rightMouseDown);
         }
     }
-    const NamedRenderTargetColorImageContainerMap *containers = findNamedRenderTargetColorImageContainerMap(drawable);
-    setFoundImageSamplers(m_textureResourceUniforms, m_resourceImages, pass);
-    setFoundImageSamplers(m_renderTargetColorUniforms, *containers, pass);
-    setFoundImageSamplers(m_offscreenRenderTargetUniforms, m_offscreenRenderTargetImages, pass);
-    setTextureValues(m_resourceImages, pass);
-    setTextureValues(*containers, pass);
-    setTextureValues(m_offscreenRenderTargetImages, pass);
-    m_initializeGlobal = true;
 }
 
 void
 Effect::setCameraParameters(const ICamera *camera, const Matrix4x4 &world, const effect::Pass *pass)
 {
+    EMAPP_PROFILE_SCOPE("Effect::setCameraParameters");
     nanoem_parameter_assert(camera, "must not be nullptr");
     nanoem_parameter_assert(pass, "must not be nullptr");
-    if (!m_cameraDirectionUniforms.empty()) {
-        const Vector4 direction(camera->direction(), 0);
-        for (SemanticUniformList::const_iterator it = m_cameraDirectionUniforms.begin(),
-                                                 end = m_cameraDirectionUniforms.end();
-             it != end; ++it) {
-            writeUniformBuffer(*it, pass, direction);
+    if (!m_globalUniformPtr->retain(GlobalUniform::kBlockTypeCamera, pass, camera, world)) {
+        if (!m_cameraDirectionUniforms.empty()) {
+            const Vector4 direction(camera->direction(), 0);
+            for (UniformSlotIndexMap::const_iterator it = m_cameraDirectionUniforms.begin(),
+                                                     end = m_cameraDirectionUniforms.end();
+                 it != end; ++it) {
+                writeUniformSlot(it->second, pass, direction);
+            }
         }
-    }
-    if (!m_cameraPositionUniforms.empty()) {
-        const Vector4 position(camera->position(), 1);
-        for (SemanticUniformList::const_iterator it = m_cameraPositionUniforms.begin(),
-                                                 end = m_cameraPositionUniforms.end();
-             it != end; ++it) {
-            writeUniformBuffer(*it, pass, position);
+        if (!m_cameraPositionUniforms.empty()) {
+            const Vector4 position(camera->position(), 1);
+            for (UniformSlotIndexMap::const_iterator it = m_cameraPositionUniforms.begin(),
+                                                     end = m_cameraPositionUniforms.end();
+                 it != end; ++it) {
+                writeUniformSlot(it->second, pass, position);
+            }
+            writeUniformBuffer("Place", pass, position);
         }
-        writeUniformBuffer("Place", pass, position);
-    }
-    if (!m_cameraMatrixUniforms.empty()) {
-        Matrix4x4 view, projection, result;
-        camera->getViewTransform(view, projection);
-        for (MatrixUniformMap::const_iterator it = m_cameraMatrixUniforms.begin(), end = m_cameraMatrixUniforms.end();
-             it != end; ++it) {
-            it->second.multiply(world, view, projection, result);
-            writeUniformBuffer(it->first, pass, result);
+        if (!m_cameraMatrixUniforms.empty()) {
+            Matrix4x4 view, projection, result;
+            camera->getViewTransform(view, projection);
+            for (MatrixUniformMap::const_iterator it = m_cameraMatrixUniforms.begin(),
+                                                  end = m_cameraMatrixUniforms.end();
+                 it != end; ++it) {
+                it->second.multiply(world, view, projection, result);
+                writeUniformSlot(it->second.m_uniformSlotIndex, pass, result);
+            }
+            writeUniformBuffer("matWorld", pass, world);
+            writeUniformBuffer("matWorldViewProj", pass, projection * view * world);
         }
-        writeUniformBuffer("matWorld", pass, world);
-        writeUniformBuffer("matWorldViewProj", pass, projection * view * world);
     }
 }
 
 void
 Effect::setLightParameters(const ILight *light, bool adjustment, effect::Pass *pass)
 {
+    EMAPP_PROFILE_SCOPE("Effect::setLightParameters");
     nanoem_parameter_assert(light, "must not be nullptr");
     nanoem_parameter_assert(pass, "must not be nullptr");
-    if (!m_lightDirectionUniforms.empty()) {
-        const Vector4 direction(glm::normalize(light->direction()), 0);
-        for (SemanticUniformList::const_iterator it = m_lightDirectionUniforms.begin(),
-                                                 end = m_lightDirectionUniforms.end();
-             it != end; ++it) {
-            writeUniformBuffer(*it, pass, direction);
-        }
-        writeUniformBuffer("LightDir", pass, direction);
-    }
-    if (!m_lightPositionUniforms.empty()) {
-        const Vector4 position(-light->direction(), 0);
-        for (SemanticUniformList::const_iterator it = m_lightPositionUniforms.begin(),
-                                                 end = m_lightPositionUniforms.end();
-             it != end; ++it) {
-            writeUniformBuffer(*it, pass, position);
-        }
-    }
-    const Vector3 lightColor(light->color());
-    if (adjustment) {
-        if (!m_lightAmbientUniforms.empty()) {
-            const Vector4 ambient(lightColor - Vector3(0.3f), 1);
-            for (SemanticUniformList::const_iterator it = m_lightAmbientUniforms.begin(),
-                                                     end = m_lightAmbientUniforms.end();
+    const Matrix4x4 blockParameter(nanoem_f32_t(adjustment));
+    if (!m_globalUniformPtr->retain(GlobalUniform::kBlockTypeLight, pass, light, blockParameter)) {
+        if (!m_lightDirectionUniforms.empty()) {
+            const Vector4 direction(glm::normalize(light->direction()), 0);
+            for (UniformSlotIndexMap::const_iterator it = m_lightDirectionUniforms.begin(),
+                                                     end = m_lightDirectionUniforms.end();
                  it != end; ++it) {
-                writeUniformBuffer(*it, pass, ambient);
+                writeUniformSlot(it->second, pass, direction);
             }
+            writeUniformBuffer("LightDir", pass, direction);
         }
-        if (!m_lightDiffuseUniforms.empty()) {
-            const Vector4 diffuse(1);
-            for (SemanticUniformList::const_iterator it = m_lightDiffuseUniforms.begin(),
-                                                     end = m_lightDiffuseUniforms.end();
+        if (!m_lightPositionUniforms.empty()) {
+            const Vector4 position(-light->direction(), 0);
+            for (UniformSlotIndexMap::const_iterator it = m_lightPositionUniforms.begin(),
+                                                     end = m_lightPositionUniforms.end();
                  it != end; ++it) {
-                writeUniformBuffer(*it, pass, diffuse);
+                writeUniformSlot(it->second, pass, position);
             }
         }
-        if (!m_lightSpecularUniforms.empty()) {
-            const Vector4 specular(lightColor, 1);
-            for (SemanticUniformList::const_iterator it = m_lightSpecularUniforms.begin(),
-                                                     end = m_lightSpecularUniforms.end();
-                 it != end; ++it) {
-                writeUniformBuffer(*it, pass, specular);
+        const Vector3 lightColor(light->color());
+        if (adjustment) {
+            if (!m_lightAmbientUniforms.empty()) {
+                const Vector4 ambient(lightColor - Vector3(0.3f), 1);
+                for (UniformSlotIndexMap::const_iterator it = m_lightAmbientUniforms.begin(),
+                                                         end = m_lightAmbientUniforms.end();
+                     it != end; ++it) {
+                    writeUniformSlot(it->second, pass, ambient);
+                }
             }
-        }
-    }
-    else {
-        if (!m_lightAmbientUniforms.empty()) {
-            const Vector4 ambient(lightColor, 1);
-            for (SemanticUniformList::const_iterator it = m_lightAmbientUniforms.begin(),
-                                                     end = m_lightAmbientUniforms.end();
-                 it != end; ++it) {
-                writeUniformBuffer(*it, pass, ambient);
+            if (!m_lightDiffuseUniforms.empty()) {
+                const Vector4 diffuse(1);
+                for (UniformSlotIndexMap::const_iterator it = m_lightDiffuseUniforms.begin(),
+                                                         end = m_lightDiffuseUniforms.end();
+                     it != end; ++it) {
+                    writeUniformSlot(it->second, pass, diffuse);
+                }
             }
-        }
-        if (!m_lightDiffuseUniforms.empty()) {
-            const Vector4 diffuse(0);
-            for (SemanticUniformList::const_iterator it = m_lightDiffuseUniforms.begin(),
-                                                     end = m_lightDiffuseUniforms.end();
-                 it != end; ++it) {
-                writeUniformBuffer(*it, pass, diffuse);
+            if (!m_lightSpecularUniforms.empty()) {
+                const Vector4 specular(lightColor, 1);
+                for (UniformSlotIndexMap::const_iterator it = m_lightSpecularUniforms.begin(),
+                                                         end = m_lightSpecularUniforms.end();
+                     it != end; ++it) {
+                    writeUniformSlot(it->second, pass, specular);
+                }
             }
         }
-        if (!m_lightSpecularUniforms.empty()) {
-            const Vector4 specular(lightColor, 1);
-            for (SemanticUniformList::const_iterator it = m_lightSpecularUniforms.begin(),
-                                                     end = m_lightSpecularUniforms.end();
-                 it != end; ++it) {
-                writeUniformBuffer(*it, pass, specular);
+        else {
+            if (!m_lightAmbientUniforms.empty()) {
+                const Vector4 ambient(lightColor, 1);
+                for (UniformSlotIndexMap::const_iterator it = m_lightAmbientUniforms.begin(),
+                                                         end = m_lightAmbientUniforms.end();
+                     it != end; ++it) {
+                    writeUniformSlot(it->second, pass, ambient);
+                }
+            }
+            if (!m_lightDiffuseUniforms.empty()) {
+                const Vector4 diffuse(0);
+                for (UniformSlotIndexMap::const_iterator it = m_lightDiffuseUniforms.begin(),
+                                                         end = m_lightDiffuseUniforms.end();
+                     it != end; ++it) {
+                    writeUniformSlot(it->second, pass, diffuse);
+                }
+            }
+            if (!m_lightSpecularUniforms.empty()) {
+                const Vector4 specular(lightColor, 1);
+                for (UniformSlotIndexMap::const_iterator it = m_lightSpecularUniforms.begin(),
+                                                         end = m_lightSpecularUniforms.end();
+                     it != end; ++it) {
+                    writeUniformSlot(it->second, pass, specular);
+                }
             }
         }
     }
@@ -2904,48 +2947,34 @@ Effect::setLightParameters(const ILight *light, bool adjustment, effect::Pass *p
 void
 Effect::setAllAccessoryParameters(const Accessory *accessory, const Project *project, effect::Pass *pass)
 {
+    EMAPP_PROFILE_SCOPE("Effect::setAllAccessoryParameters");
     nanoem_parameter_assert(accessory, "must not be nullptr");
     nanoem_parameter_assert(pass, "must not be nullptr");
-    for (SemanticUniformList::const_iterator it = m_controlObjectUniforms.begin(), end = m_controlObjectUniforms.end();
-         it != end; ++it) {
-        const String &parameterName = *it;
-        ControlObjectTargetMap::iterator it2 = m_controlObjectTargets.find(*it);
-        if (it2 != m_controlObjectTargets.end()) {
-            ControlObjectTarget &target = it2->second;
-            const String &targetName = target.m_name;
-            const Accessory *foundAccessory = nullptr;
-            const Model *foundModel = nullptr;
-            if (StringUtils::equals(targetName.c_str(), "(self)")) {
-                foundAccessory = accessory;
-            }
-            else if (StringUtils::equals(targetName.c_str(), "(OffscreenOwner)")) {
-                const tinystl::pair<const Model *, const Accessory *> &pair =
-                    findOffscreenOwnerObject(accessory, project);
-                foundModel = pair.first;
-                foundAccessory = pair.second;
-            }
-            else {
-                foundAccessory = project->findAccessoryByFilename(targetName);
-                foundModel = project->findModelByFilename(targetName);
-            }
-            if (foundAccessory) {
-                setAccessoryParameter(parameterName, foundAccessory, target, pass);
+    if (!m_globalUniformPtr->retain(GlobalUniform::kBlockTypeDrawable, pass, accessory, Constants::kIdentity)) {
+        for (ControlObjectTargetMap::iterator it = m_controlObjectTargets.begin(), end = m_controlObjectTargets.end();
+             it != end; ++it) {
+            const String &parameterName = it->first;
+            ControlObjectTarget &target = it->second;
+            const tinystl::pair<const Model *, const Accessory *> found =
+                resolveControlObject(nullptr, accessory, project, target);
+            if (found.second) {
+                setAccessoryParameter(parameterName, found.second, target, pass);
             }
-            else if (foundModel) {
-                setModelParameter(parameterName, foundModel, target, pass);
+            else if (found.first) {
+                setModelParameter(parameterName, found.first, target, pass);
             }
             else {
                 setDefaultControlParameterValues(parameterName, target, pass);
             }
         }
+        nanodxm_rsize_t numVertices, numMaterials;
+        nanodxmDocumentGetVertices(accessory->data(), &numVertices);
+        writeUniformBuffer("VertexCount", pass, nanoem_f32_t(numVertices));
+        nanodxmDocumentGetMaterials(accessory->data(), &numMaterials);
+        writeUniformBuffer("SubsetCount", pass, nanoem_f32_t(numMaterials));
+        writeUniformBuffer("transp", pass, accessory->isTranslucent());
+        writeUniformBuffer("opadd", pass, accessory->isAddBlendEnabled());
     }
-    nanodxm_rsize_t numVertices, numMaterials;
-    nanodxmDocumentGetVertices(accessory->data(), &numVertices);
-    writeUniformBuffer("VertexCount", pass, nanoem_f32_t(numVertices));
-    nanodxmDocumentGetMaterials(accessory->data(), &numMaterials);
-    writeUniformBuffer("SubsetCount", pass, nanoem_f32_t(numMaterials));
-    writeUniformBuffer("transp", pass, accessory->isTranslucent());
-    writeUniformBuffer("opadd", pass, accessory->isAddBlendEnabled());
 }
 
 void
@@ -3038,47 +3067,34 @@ Effect::setAccessoryParameter(
 void
 Effect::setAllModelParameters(const Model *model, const Project *project, Pass *pass)
 {
+    EMAPP_PROFILE_SCOPE("Effect::setAllModelParameters");
     nanoem_parameter_assert(model, "must not be nullptr");
     nanoem_parameter_assert(pass, "must not be nullptr");
-    for (SemanticUniformList::const_iterator it = m_controlObjectUniforms.begin(), end = m_controlObjectUniforms.end();
-         it != end; ++it) {
-        const String &parameterName = *it;
-        ControlObjectTargetMap::iterator it2 = m_controlObjectTargets.find(*it);
-        if (it2 != m_controlObjectTargets.end()) {
-            ControlObjectTarget &target = it2->second;
-            const String &targetName = target.m_name;
-            const Model *foundModel = nullptr;
-            const Accessory *foundAccessory = nullptr;
-            if (StringUtils::equals(targetName.c_str(), "(self)")) {
-                foundModel = model;
-            }
-            else if (StringUtils::equals(targetName.c_str(), "(OffscreenOwner)")) {
-                const tinystl::pair<const Model *, const Accessory *> &pair = findOffscreenOwnerObject(model, project);
-                foundModel = pair.first;
-                foundAccessory = pair.second;
-            }
-            else {
-                foundModel = project->findModelByFilename(targetName);
-                foundAccessory = project->findAccessoryByFilename(targetName);
-            }
-            if (foundModel) {
-                setModelParameter(parameterName, foundModel, target, pass);
+    if (!m_globalUniformPtr->retain(GlobalUniform::kBlockTypeDrawable, pass, model, Constants::kIdentity)) {
+        for (ControlObjectTargetMap::iterator it = m_controlObjectTargets.begin(), end = m_controlObjectTargets.end();
+             it != end; ++it) {
+            const String &parameterName = it->first;
+            ControlObjectTarget &target = it->second;
+            const tinystl::pair<const Model *, const Accessory *> found =
+                resolveControlObject(model, nullptr, project, target);
+            if (found.first) {
+                setModelParameter(parameterName, found.first, target, pass);
             }
-            else if (foundAccessory) {
-                setAccessoryParameter(parameterName, foundAccessory, target, pass);
+            else if (found.second) {
+                setAccessoryParameter(parameterName, found.second, target, pass);
             }
             else {
                 setDefaultControlParameterValues(parameterName, target, pass);
             }
         }
+        nanoem_rsize_t numVertices, numMaterials;
+        nanoemModelGetAllVertexObjects(model->data(), &numVertices);
+        writeUniformBuffer("VertexCount", pass, nanoem_f32_t(numVertices));
+        nanoemModelGetAllMaterialObjects(model->data(), &numMaterials);
+        writeUniformBuffer("SubsetCount", pass, nanoem_f32_t(numMaterials));
+        writeUniformBuffer("transp", pass, model->isTranslucent());
+        writeUniformBuffer("opadd", pass, model->isAddBlendEnabled());
     }
-    nanoem_rsize_t numVertices, numMaterials;
-    nanoemModelGetAllVertexObjects(model->data(), &numVertices);
-    writeUniformBuffer("VertexCount", pass, nanoem_f32_t(numVertices));
-    nanoemModelGetAllMaterialObjects(model->data(), &numMaterials);
-    writeUniformBuffer("SubsetCount", pass, nanoem_f32_t(numMaterials));
-    writeUniformBuffer("transp", pass, model->isTranslucent());
-    writeUniformBuffer("opadd", pass, model->isAddBlendEnabled());
 }
 
 void
@@ -3088,7 +3104,14 @@ Effect::setModelParameter(const String &name, const Model *model, ControlObjectT
     nanoem_parameter_assert(model, "must not be nullptr");
     const String &item = target.m_item;
     if (!item.empty()) {
-        if (const model::Bone *bone = model::Bone::cast(model->findBone(item))) {
+        const nanoem_u32_t generation = model->project()->objectBindingGeneration();
+        if (target.m_itemModelPtr != model || target.m_itemGeneration != generation) {
+            target.m_bonePtr = model->findBone(item);
+            target.m_morphPtr = model->findMorph(item);
+            target.m_itemModelPtr = model;
+            target.m_itemGeneration = generation;
+        }
+        if (const model::Bone *bone = model::Bone::cast(target.m_bonePtr)) {
             ParameterType type = target.m_type;
             if (type == kParameterTypeFloat4) {
                 const Vector4 position(bone->worldTransformOrigin(), 1);
@@ -3100,7 +3123,7 @@ Effect::setModelParameter(const String &name, const Model *model, ControlObjectT
                 target.m_value = Vector4(bone->worldTransformOrigin(), 1);
             }
         }
-        else if (const model::Morph *morph = model::Morph::cast(model->findMorph(item))) {
+        else if (const model::Morph *morph = model::Morph::cast(target.m_morphPtr)) {
             if (target.m_type == kParameterTypeFloat) {
                 const Vector4 weight(morph->weight());
                 writeUniformBuffer(name, pass, morph->weight());
@@ -3147,6 +3170,7 @@ Effect::setModelParameter(const String &name, const Model *model, ControlObjectT
 void
 Effect::setMaterialParameters(const Accessory *accessory, const nanodxm_material_t *materialPtr, Pass *pass)
 {
+    EMAPP_PROFILE_SCOPE("Effect::setMaterialParameters(Accessory)");
     nanoem_parameter_assert(accessory, "must not be nullptr");
     nanoem_parameter_assert(materialPtr, "must not be nullptr");
     nanoem_parameter_assert(pass, "must not be nullptr");
@@ -3158,79 +3182,79 @@ Effect::setMaterialParameters(const Accessory *accessory, const nanodxm_material
         specularPower(nanodxmMaterialGetShininess(materialPtr));
     if (!m_materialAmbientUniforms.empty()) {
         const Vector4 ambient(df.r, df.g, df.b, 1.0f);
-        for (SemanticUniformList::const_iterator it = m_materialAmbientUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialAmbientUniforms.begin(),
                                                  end = m_materialAmbientUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, ambient);
+            writeUniformSlot(it->second, pass, ambient);
         }
     }
     if (!m_materialDiffuseUniforms.empty()) {
-        for (SemanticUniformList::const_iterator it = m_materialDiffuseUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialDiffuseUniforms.begin(),
                                                  end = m_materialDiffuseUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, diffuse);
+            writeUniformSlot(it->second, pass, diffuse);
         }
     }
     if (!m_materialEmissiveUniforms.empty()) {
         const Vector4 emissive(em.r, em.g, em.b, 1.0f);
-        for (SemanticUniformList::const_iterator it = m_materialEmissiveUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialEmissiveUniforms.begin(),
                                                  end = m_materialEmissiveUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, emissive);
+            writeUniformSlot(it->second, pass, emissive);
         }
     }
     if (!m_materialSpecularPowerUniforms.empty()) {
-        for (SemanticUniformList::const_iterator it = m_materialSpecularPowerUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialSpecularPowerUniforms.begin(),
                                                  end = m_materialSpecularPowerUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, specularPower);
+            writeUniformSlot(it->second, pass, specularPower);
         }
     }
     if (!m_materialSpecularUniforms.empty()) {
-        for (SemanticUniformList::const_iterator it = m_materialSpecularUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialSpecularUniforms.begin(),
                                                  end = m_materialSpecularUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, specular);
+            writeUniformSlot(it->second, pass, specular);
         }
     }
     if (!m_addingDiffuseImageBlendFactorUniforms.empty()) {
         const Vector4 addingDiffuseTextureBlendFactor(0);
-        for (SemanticUniformList::const_iterator it = m_addingDiffuseImageBlendFactorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_addingDiffuseImageBlendFactorUniforms.begin(),
                                                  end = m_addingDiffuseImageBlendFactorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, addingDiffuseTextureBlendFactor);
+            writeUniformSlot(it->second, pass, addingDiffuseTextureBlendFactor);
         }
     }
     if (!m_addingSphereImageBlendFactorUniforms.empty()) {
         const Vector4 addingSphereTextureBlendFactor(0);
-        for (SemanticUniformList::const_iterator it = m_addingSphereImageBlendFactorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_addingSphereImageBlendFactorUniforms.begin(),
                                                  end = m_addingSphereImageBlendFactorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, addingSphereTextureBlendFactor);
+            writeUniformSlot(it->second, pass, addingSphereTextureBlendFactor);
         }
     }
     if (!m_multiplyingDiffuseImageBlendFactorUniforms.empty()) {
         const Vector4 multiplyingDiffuseTextureBlendFactor(1);
-        for (SemanticUniformList::const_iterator it = m_multiplyingDiffuseImageBlendFactorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_multiplyingDiffuseImageBlendFactorUniforms.begin(),
                                                  end = m_multiplyingDiffuseImageBlendFactorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, multiplyingDiffuseTextureBlendFactor);
+            writeUniformSlot(it->second, pass, multiplyingDiffuseTextureBlendFactor);
         }
     }
     if (!m_multiplyingSphereImageBlendFactorUniforms.empty()) {
         const Vector4 multiplyingSphereTextureBlendFactor(1);
-        for (SemanticUniformList::const_iterator it = m_multiplyingSphereImageBlendFactorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_multiplyingSphereImageBlendFactorUniforms.begin(),
                                                  end = m_multiplyingSphereImageBlendFactorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, multiplyingSphereTextureBlendFactor);
+            writeUniformSlot(it->second, pass, multiplyingSphereTextureBlendFactor);
         }
     }
     if (!m_materialToonColorUniforms.empty()) {
         const Vector4 toonColor(1);
-        for (SemanticUniformList::const_iterator it = m_materialToonColorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialToonColorUniforms.begin(),
                                                  end = m_materialToonColorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, toonColor);
+            writeUniformSlot(it->second, pass, toonColor);
         }
     }
     if (const Accessory::Material *material = accessory->findMaterial(materialPtr)) {
@@ -3273,95 +3297,96 @@ Effect::setMaterialParameters(const Accessory *accessory, const nanodxm_material
 void
 Effect::setMaterialParameters(const nanoem_model_material_t *materialPtr, const String &target, Pass *pass)
 {
+    EMAPP_PROFILE_SCOPE("Effect::setMaterialParameters(Model)");
     nanoem_parameter_assert(materialPtr, "must not be nullptr");
     nanoem_parameter_assert(pass, "must not be nullptr");
     const model::Material *material = model::Material::cast(materialPtr);
     const model::Material::Color &baseColor = material->base();
     if (!m_materialAmbientUniforms.empty()) {
         const Vector4 ambient(baseColor.m_diffuse, 1);
-        for (SemanticUniformList::const_iterator it = m_materialAmbientUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialAmbientUniforms.begin(),
                                                  end = m_materialAmbientUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, ambient);
+            writeUniformSlot(it->second, pass, ambient);
         }
     }
     if (!m_materialDiffuseUniforms.empty()) {
         const Vector4 diffuse(baseColor.m_diffuse, baseColor.m_diffuseOpacity);
-        for (SemanticUniformList::const_iterator it = m_materialDiffuseUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialDiffuseUniforms.begin(),
                                                  end = m_materialDiffuseUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, diffuse);
+            writeUniformSlot(it->second, pass, diffuse);
         }
     }
     if (!m_materialEmissiveUniforms.empty()) {
         const Vector4 emissive(baseColor.m_ambient, 1);
-        for (SemanticUniformList::const_iterator it = m_materialEmissiveUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialEmissiveUniforms.begin(),
                                                  end = m_materialEmissiveUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, emissive);
+            writeUniformSlot(it->second, pass, emissive);
         }
     }
     if (!m_materialSpecularPowerUniforms.empty()) {
         const Vector4 specularPower(
             glm::abs(baseColor.m_specularPower) < Constants::kEpsilon ? 1.0f : baseColor.m_specularPower);
-        for (SemanticUniformList::const_iterator it = m_materialSpecularPowerUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialSpecularPowerUniforms.begin(),
                                                  end = m_materialSpecularPowerUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, specularPower);
+            writeUniformSlot(it->second, pass, specularPower);
         }
     }
     if (!m_materialSpecularUniforms.empty()) {
         const Vector4 specular(baseColor.m_specular, 1);
-        for (SemanticUniformList::const_iterator it = m_materialSpecularUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialSpecularUniforms.begin(),
                                                  end = m_materialSpecularUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, specular);
+            writeUniformSlot(it->second, pass, specular);
         }
     }
     const model::Material::Color &addColor = material->add();
     if (!m_addingDiffuseImageBlendFactorUniforms.empty()) {
         const Vector4 addingDiffuseTextureBlendFactor(addColor.m_diffuseTextureBlendFactor);
-        for (SemanticUniformList::const_iterator it = m_addingDiffuseImageBlendFactorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_addingDiffuseImageBlendFactorUniforms.begin(),
                                                  end = m_addingDiffuseImageBlendFactorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, addingDiffuseTextureBlendFactor);
+            writeUniformSlot(it->second, pass, addingDiffuseTextureBlendFactor);
         }
         writeUniformBuffer("TexCAdd", pass, addingDiffuseTextureBlendFactor);
     }
     if (!m_addingSphereImageBlendFactorUniforms.empty()) {
         const Vector4 addingSphereTextureBlendFactor(addColor.m_sphereTextureBlendFactor);
-        for (SemanticUniformList::const_iterator it = m_addingSphereImageBlendFactorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_addingSphereImageBlendFactorUniforms.begin(),
                                                  end = m_addingSphereImageBlendFactorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, addingSphereTextureBlendFactor);
+            writeUniformSlot(it->second, pass, addingSphereTextureBlendFactor);
         }
         writeUniformBuffer("SphCAdd", pass, addingSphereTextureBlendFactor);
     }
     const model::Material::Color &mulColor = material->mul();
     if (!m_multiplyingDiffuseImageBlendFactorUniforms.empty()) {
         const Vector4 multiplyingDiffuseTextureBlendFactor(mulColor.m_diffuseTextureBlendFactor);
-        for (SemanticUniformList::const_iterator it = m_multiplyingDiffuseImageBlendFactorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_multiplyingDiffuseImageBlendFactorUniforms.begin(),
                                                  end = m_multiplyingDiffuseImageBlendFactorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, multiplyingDiffuseTextureBlendFactor);
+            writeUniformSlot(it->second, pass, multiplyingDiffuseTextureBlendFactor);
         }
         writeUniformBuffer("TexCMul", pass, multiplyingDiffuseTextureBlendFactor);
     }
     if (!m_multiplyingSphereImageBlendFactorUniforms.empty()) {
         const Vector4 multiplyingSphereTextureBlendFactor(mulColor.m_sphereTextureBlendFactor);
-        for (SemanticUniformList::const_iterator it = m_multiplyingSphereImageBlendFactorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_multiplyingSphereImageBlendFactorUniforms.begin(),
                                                  end = m_multiplyingSphereImageBlendFactorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, multiplyingSphereTextureBlendFactor);
+            writeUniformSlot(it->second, pass, multiplyingSphereTextureBlendFactor);
         }
         writeUniformBuffer("SphCMul", pass, multiplyingSphereTextureBlendFactor);
     }
     if (!m_materialToonColorUniforms.empty()) {
         const Vector4 toonColor(material->toonColor());
-        for (SemanticUniformList::const_iterator it = m_materialToonColorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialToonColorUniforms.begin(),
                                                  end = m_materialToonColorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, toonColor);
+            writeUniformSlot(it->second, pass, toonColor);
         }
     }
     if (const IImageView *diffuseImage = material->diffuseImage()) {
@@ -3412,6 +3437,7 @@ Effect::setMaterialParameters(const nanoem_model_material_t *materialPtr, const
 void
 Effect::setEdgeParameters(const nanoem_model_material_t *materialPtr, nanoem_f32_t edgeSize, Pass *pass)
 {
+    EMAPP_PROFILE_SCOPE("Effect::setEdgeParameters");
     nanoem_parameter_assert(materialPtr, "must not be nullptr");
     nanoem_parameter_assert(pass, "must not be nullptr");
     BX_UNUSED_1(edgeSize);
@@ -3419,10 +3445,10 @@ Effect::setEdgeParameters(const nanoem_model_material_t *materialPtr, nanoem_f32
         const model::Material *material = model::Material::cast(materialPtr);
         const model::Material::Edge &edge = material->edge();
         const Vector4 color(edge.m_color, edge.m_opacity);
-        for (SemanticUniformList::const_iterator it = m_materialEdgeColorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialEdgeColorUniforms.begin(),
                                                  end = m_materialEdgeColorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, color);
+            writeUniformSlot(it->second, pass, color);
         }
     }
 }
@@ -3430,9 +3456,12 @@ Effect::setEdgeParameters(const nanoem_model_material_t *materialPtr, nanoem_f32
 void
 Effect::setShadowParameters(const ILight *light, const ICamera *camera, const Matrix4x4 &world, Pass *pass)
 {
+    EMAPP_PROFILE_SCOPE("Effect::setShadowParameters");
     nanoem_parameter_assert(light, "must not be nullptr");
     nanoem_parameter_assert(pass, "must not be nullptr");
     if (!m_cameraMatrixUniforms.empty()) {
+        /* camera matrices are overwritten with the shadow ones so the retained camera block is no longer valid */
+        m_globalUniformPtr->invalidate(GlobalUniform::kBlockTypeCamera);
         Matrix4x4 shadow, view, projection, result;
         light->getShadowTransform(shadow);
         camera->getViewTransform(view, projection);
@@ -3440,17 +3469,17 @@ Effect::setShadowParameters(const ILight *light, const ICamera *camera, const Ma
         for (MatrixUniformMap::const_iterator it = m_cameraMatrixUniforms.begin(), end = m_cameraMatrixUniforms.end();
              it != end; ++it) {
             it->second.multiply(shadow, view, projection, result);
-            writeUniformBuffer(it->first, pass, result);
+            writeUniformSlot(it->second.m_uniformSlotIndex, pass, result);
         }
         writeUniformBuffer("matWorld", pass, shadow);
         writeUniformBuffer("matWorldViewProj", pass, projection * view * world);
     }
     if (!m_materialGroundColorUniforms.empty()) {
         const Vector4 color(light->groundShadowColor(), 1.0f + light->isTranslucentGroundShadowEnabled() * -0.5f);
-        for (SemanticUniformList::const_iterator it = m_materialGroundColorUniforms.begin(),
+        for (UniformSlotIndexMap::const_iterator it = m_materialGroundColorUniforms.begin(),
                                                  end = m_materialGroundColorUniforms.end();
              it != end; ++it) {
-            writeUniformBuffer(*it, pass, color);
+            writeUniformSlot(it->second, pass, color);
         }
     }
 }
@@ -3458,15 +3487,17 @@ Effect::setShadowParameters(const ILight *light, const ICamera *camera, const Ma
 void
 Effect::setShadowMapParameters(const ShadowCamera *shadowCamera, const Matrix4x4 &world, Pass *pass)
 {
+    EMAPP_PROFILE_SCOPE("Effect::setShadowMapParameters");
     nanoem_parameter_assert(shadowCamera, "must NOT be nullptr");
     nanoem_parameter_assert(pass, "must not be nullptr");
-    if (!m_lightMatrixUniforms.empty()) {
+    if (!m_lightMatrixUniforms.empty() &&
+        !m_globalUniformPtr->retain(GlobalUniform::kBlockTypeShadowMap, pass, shadowCamera, world)) {
         Matrix4x4 view, projection, result;
         shadowCamera->getViewProjection(view, projection);
         for (MatrixUniformMap::const_iterator it = m_lightMatrixUniforms.begin(), end = m_lightMatrixUniforms.end();
              it != end; ++it) {
             it->second.multiply(world, view, projection, result);
-            writeUniformBuffer(it->first, pass, result);
+            writeUniformSlot(it->second.m_uniformSlotIndex, pass, result);
         }
     }
     if (shadowCamera->isEnabled()) {
@@ -3649,10 +3680,10 @@ Effect::handleDiffuseSemantic(Effect *self, const TypedSemanticParameter &parame
             const String &name = parameter.m_name;
             const String &value = it->second.m_string;
             if (StringUtils::equals(value.c_str(), kObjectGeometryValueLiteral)) {
-                self->m_materialDiffuseUniforms.insert(name);
+                self->addSemanticUniform(self->m_materialDiffuseUniforms, name);
             }
             else if (StringUtils::equals(value.c_str(), kObjectLightValueLiteral)) {
-                self->m_lightDiffuseUniforms.insert(name);
+                self->addSemanticUniform(self->m_lightDiffuseUniforms, name);
             }
             else {
                 self->addInvalidParameterValueError(value, parameter);
@@ -3677,10 +3708,10 @@ Effect::handleAmbientSemantic(Effect *self, const TypedSemanticParameter &parame
             const String &name = parameter.m_name;
             const String &value = it->second.m_string;
             if (StringUtils::equals(value.c_str(), kObjectGeometryValueLiteral)) {
-                self->m_materialAmbientUniforms.insert(name);
+                self->addSemanticUniform(self->m_materialAmbientUniforms, name);
             }
             else if (StringUtils::equals(value.c_str(), kObjectLightValueLiteral)) {
-                self->m_lightAmbientUniforms.insert(name);
+                self->addSemanticUniform(self->m_lightAmbientUniforms, name);
             }
             else {
                 self->addInvalidParameterValueError(value, parameter);
@@ -3705,7 +3736,7 @@ Effect::handleEmissiveSemantic(Effect *self, const TypedSemanticParameter &param
             const String &value = it->second.m_string;
             if (StringUtils::equals(value.c_str(), kObjectGeometryValueLiteral)) {
                 const String &name = parameter.m_name;
-                self->m_materialEmissiveUniforms.insert(name);
+                self->addSemanticUniform(self->m_materialEmissiveUniforms, name);
             }
             else {
                 self->addInvalidParameterValueError(value, parameter);
@@ -3730,10 +3761,10 @@ Effect::handleSpecularSemantic(Effect *self, const TypedSemanticParameter &param
             const String &name = parameter.m_name;
             const String &value = it->second.m_string;
             if (StringUtils::equals(value.c_str(), kObjectGeometryValueLiteral)) {
-                self->m_materialSpecularUniforms.insert(name);
+                self->addSemanticUniform(self->m_materialSpecularUniforms, name);
             }
             else if (StringUtils::equals(value.c_str(), kObjectLightValueLiteral)) {
-                self->m_lightSpecularUniforms.insert(name);
+                self->addSemanticUniform(self->m_lightSpecularUniforms, name);
             }
             else {
                 self->addInvalidParameterValueError(value, parameter);
@@ -3758,14 +3789,14 @@ Effect::handleSpecularPowerSemantic(Effect *self, const TypedSemanticParameter &
         if (it != annotations.end()) {
             const String &value = it->second.m_string;
             if (StringUtils::equals(value.c_str(), kObjectGeometryValueLiteral)) {
-                self->m_materialSpecularPowerUniforms.insert(name);
+                self->addSemanticUniform(self->m_materialSpecularPowerUniforms, name);
             }
             else {
                 self->addInvalidParameterValueError(value, parameter);
             }
         }
         else {
-            self->m_materialSpecularPowerUniforms.insert(name);
+            self->addSemanticUniform(self->m_materialSpecularPowerUniforms, name);
         }
     }
     else {
@@ -3783,14 +3814,14 @@ Effect::handleToonColorSemantic(Effect *self, const TypedSemanticParameter &para
         if (it != annotations.end()) {
             const String &value = it->second.m_string;
             if (StringUtils::equals(value.c_str(), kObjectGeometryValueLiteral)) {
-                self->m_materialToonColorUniforms.insert(name);
+                self->addSemanticUniform(self->m_materialToonColorUniforms, name);
             }
             else {
                 self->addInvalidParameterValueError(value, parameter);
             }
         }
         else {
-            self->m_materialToonColorUniforms.insert(name);
+            self->addSemanticUniform(self->m_materialToonColorUniforms, name);
         }
     }
     else {
@@ -3808,14 +3839,14 @@ Effect::handleEdgeColorSemantic(Effect *self, const TypedSemanticParameter &para
         if (it != annotations.end()) {
             const String &value = it->second.m_string;
             if (StringUtils::equals(value.c_str(), kObjectGeometryValueLiteral)) {
-                self->m_materialEdgeColorUniforms.insert(name);
+                self->addSemanticUniform(self->m_materialEdgeColorUniforms, name);
             }
             else {
                 self->addInvalidParameterValueError(value, parameter);
             }
         }
         else {
-            self->m_materialEdgeColorUniforms.insert(name);
+            self->addSemanticUniform(self->m_materialEdgeColorUniforms, name);
         }
     }
     else {
@@ -3828,7 +3859,7 @@ Effect::handleGroundShadowColorSemantic(
     Effect *self, const TypedSemanticParameter &parameter, Progress & /* progress */)
 {
     if (parameter.m_type == kParameterTypeFloat4) {
-        self->m_materialGroundColorUniforms.insert(parameter.m_name);
+        self->addSemanticUniform(self->m_materialGroundColorUniforms, parameter.m_name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat4, parameter);
@@ -3845,10 +3876,10 @@ Effect::handlePositionSemantic(Effect *self, const TypedSemanticParameter &param
             const String &name = parameter.m_name;
             const String &value = it->second.m_string;
             if (StringUtils::equals(value.c_str(), kObjectLightValueLiteral)) {
-                self->m_lightPositionUniforms.insert(name);
+                self->addSemanticUniform(self->m_lightPositionUniforms, name);
             }
             else if (StringUtils::equals(value.c_str(), kObjectCameraValueLiteral)) {
-                self->m_cameraPositionUniforms.insert(name);
+                self->addSemanticUniform(self->m_cameraPositionUniforms, name);
             }
             else {
                 self->addInvalidParameterValueError(value, parameter);
@@ -3873,10 +3904,10 @@ Effect::handleDirectionSemantic(Effect *self, const TypedSemanticParameter &para
             const String &name = parameter.m_name;
             const String &value = it->second.m_string;
             if (StringUtils::equals(value.c_str(), kObjectLightValueLiteral)) {
-                self->m_lightDirectionUniforms.insert(name);
+                self->addSemanticUniform(self->m_lightDirectionUniforms, name);
             }
             else if (StringUtils::equals(value.c_str(), kObjectCameraValueLiteral)) {
-                self->m_cameraDirectionUniforms.insert(name);
+                self->addSemanticUniform(self->m_cameraDirectionUniforms, name);
             }
             else {
                 self->addInvalidParameterValueError(value, parameter);
@@ -3933,7 +3964,7 @@ void
 Effect::handleAddingTextureSemantic(Effect *self, const TypedSemanticParameter &parameter, Progress & /* progress */)
 {
     if (parameter.m_type == kParameterTypeFloat4) {
-        self->m_addingDiffuseImageBlendFactorUniforms.insert(parameter.m_name);
+        self->addSemanticUniform(self->m_addingDiffuseImageBlendFactorUniforms, parameter.m_name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat4, parameter);
@@ -3945,7 +3976,7 @@ Effect::handleMultiplyingTextureSemantic(
     Effect *self, const TypedSemanticParameter &parameter, Progress & /* progress */)
 {
     if (parameter.m_type == kParameterTypeFloat4) {
-        self->m_multiplyingDiffuseImageBlendFactorUniforms.insert(parameter.m_name);
+        self->addSemanticUniform(self->m_multiplyingDiffuseImageBlendFactorUniforms, parameter.m_name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat4, parameter);
@@ -3957,7 +3988,7 @@ Effect::handleAddingSphereTextureSemantic(
     Effect *self, const TypedSemanticParameter &parameter, Progress & /* progress */)
 {
     if (parameter.m_type == kParameterTypeFloat4) {
-        self->m_addingSphereImageBlendFactorUniforms.insert(parameter.m_name);
+        self->addSemanticUniform(self->m_addingSphereImageBlendFactorUniforms, parameter.m_name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat4, parameter);
@@ -3969,7 +4000,7 @@ Effect::handleMultiplyingSphereTextureSemantic(
     Effect *self, const TypedSemanticParameter &parameter, Progress & /* progress */)
 {
     if (parameter.m_type == kParameterTypeFloat4) {
-        self->m_multiplyingSphereImageBlendFactorUniforms.insert(parameter.m_name);
+        self->addSemanticUniform(self->m_multiplyingSphereImageBlendFactorUniforms, parameter.m_name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat4, parameter);
@@ -3981,7 +4012,7 @@ Effect::handleViewportPixelSizeSemantic(
     Effect *self, const TypedSemanticParameter &parameter, Progress & /* progress */)
 {
     if (parameter.m_type == kParameterTypeFloat4) {
-        self->m_viewportPixelUniforms.insert(parameter.m_name);
+        self->addSemanticUniform(self->m_viewportPixelUniforms, parameter.m_name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat4, parameter);
@@ -3997,11 +4028,11 @@ Effect::handleTimeSemantic(Effect *self, const TypedSemanticParameter &parameter
         const String &name = parameter.m_name;
         if (it != annotations.end()) {
             if (it->second.m_bool) {
-                self->m_timeUniforms.insert(name);
+                self->addSemanticUniform(self->m_timeUniforms, name);
                 return;
             }
         }
-        self->m_systemTimeUniforms.insert(name);
+        self->addSemanticUniform(self->m_systemTimeUniforms, name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat, parameter);
@@ -4017,11 +4048,11 @@ Effect::handleElapsedTimeSemantic(Effect *self, const TypedSemanticParameter &pa
         const String &name = parameter.m_name;
         if (it != annotations.end()) {
             if (it->second.m_bool) {
-                self->m_elapsedTimeUniforms.insert(name);
+                self->addSemanticUniform(self->m_elapsedTimeUniforms, name);
                 return;
             }
         }
-        self->m_elapsedSystemTimeUniforms.insert(name);
+        self->addSemanticUniform(self->m_elapsedSystemTimeUniforms, name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat, parameter);
@@ -4032,7 +4063,7 @@ void
 Effect::handleMousePositionSemantic(Effect *self, const TypedSemanticParameter &parameter, Progress & /* progress */)
 {
     if (parameter.m_type == kParameterTypeFloat4) {
-        self->m_mousePositionUniforms.insert(parameter.m_name);
+        self->addSemanticUniform(self->m_mousePositionUniforms, parameter.m_name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat4, parameter);
@@ -4043,7 +4074,7 @@ void
 Effect::handleLeftMouseDownSemantic(Effect *self, const TypedSemanticParameter &parameter, Progress & /* progress */)
 {
     if (parameter.m_type == kParameterTypeFloat4) {
-        self->m_leftMouseDownUniforms.insert(parameter.m_name);
+        self->addSemanticUniform(self->m_leftMouseDownUniforms, parameter.m_name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat4, parameter);
@@ -4054,7 +4085,7 @@ void
 Effect::handleMiddleMouseDownSemantic(Effect *self, const TypedSemanticParameter &parameter, Progress & /* progress */)
 {
     if (parameter.m_type == kParameterTypeFloat4) {
-        self->m_middleMouseDownUniforms.insert(parameter.m_name);
+        self->addSemanticUniform(self->m_middleMouseDownUniforms, parameter.m_name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat4, parameter);
@@ -4065,7 +4096,7 @@ void
 Effect::handleRightMouseDownSemantic(Effect *self, const TypedSemanticParameter &parameter, Progress & /* progress */)
 {
     if (parameter.m_type == kParameterTypeFloat4) {
-        self->m_rightMouseDownUniforms.insert(parameter.m_name);
+        self->addSemanticUniform(self->m_rightMouseDownUniforms, parameter.m_name);
     }
     else {
         self->addInvalidParameterTypeError(kParameterTypeFloat4, parameter);
@@ -4085,7 +4116,6 @@ Effect::handleControlObjectSemantic(Effect *self, const TypedSemanticParameter &
         }
         const String &parameterName = parameter.m_name;
         self->m_controlObjectTargets.insert(tinystl::make_pair(parameterName, target));
-        self->m_controlObjectUniforms.insert(parameterName);
     }
     else {
         self->addMissingParameterKeyError(kNameKeyLiteral, parameter);
@@ -4845,44 +4875,74 @@ Effect::writeUniformBuffer(
     return result;
 }
 
+nanoem_u32_t
+Effect::findUniformSlotIndex(const String &name) const NANOEM_DECL_NOEXCEPT
+{
+    effect::UniformSlotIndexMap::const_iterator it = m_uniformSlotIndices.find(name);
+    return it != m_uniformSlotIndices.end() ? it->second : UniformSlot::kInvalidIndex;
+}
+
 void
-Effect::writeUniformBuffer(const String &name, const effect::Pass *passPtr, const void *ptr, size_t size)
+Effect::addSemanticUniform(effect::UniformSlotIndexMap &uniforms, const String &name)
+{
+    /* semantic parameters are handled after all passes are created so the slot is already known here */
+    uniforms.insert(tinystl::make_pair(name, findUniformSlotIndex(name)));
+}
+
+void
+Effect::writeUniformSlot(nanoem_u32_t slotIndex, const effect::Pass *passPtr, const void *ptr, size_t size)
 {
     nanoem_parameter_assert(passPtr, "must not be nullptr");
     nanoem_parameter_assert(ptr, "must not be nullptr");
-    RegisterIndex registerIndex;
-    bool written = false;
-    if (passPtr->findVertexPreshaderRegisterIndex(name, registerIndex)) {
-        written = writeUniformBuffer(registerIndex, ptr, size, m_globalUniformPtr->m_preshaderVertexShaderBuffer);
-        if (!written) {
-            m_logger->log("Parameter \"%s\" in \"Effects/%s/%s/%s\" cannot be written due to size buffer flow\n",
-                name.c_str(), nameConstString(), passPtr->technique()->nameConstString(), passPtr->nameConstString());
-        }
-    }
-    if (passPtr->findPixelPreshaderRegisterIndex(name, registerIndex)) {
-        written = writeUniformBuffer(registerIndex, ptr, size, m_globalUniformPtr->m_preshaderPixelShaderBuffer);
-        if (!written) {
-            m_logger->log("Parameter \"%s\" in \"Effects/%s/%s/%s\" cannot be written due to size buffer flow\n",
-                name.c_str(), nameConstString(), passPtr->technique()->nameConstString(), passPtr->nameConstString());
-        }
-    }
-    if (passPtr->findVertexShaderRegisterIndex(name, registerIndex)) {
-        written = writeUniformBuffer(registerIndex, ptr, size, m_globalUniformPtr->m_vertexShaderBuffer);
-        if (!written) {
-            m_logger->log("Parameter \"%s\" in \"Effects/%s/%s/%s\" cannot be written due to size buffer flow\n",
-                name.c_str(), nameConstString(), passPtr->technique()->nameConstString(), passPtr->nameConstString());
+    if (const UniformSlot *slot = passPtr->findUniformSlot(slotIndex)) {
+        GlobalUniform::Buffer *const buffers[] = {
+            &m_globalUniformPtr->m_preshaderVertexShaderBuffer,
+            &m_globalUniformPtr->m_preshaderPixelShaderBuffer,
+            &m_globalUniformPtr->m_vertexShaderBuffer,
+            &m_globalUniformPtr->m_pixelShaderBuffer,
+        };
+        bool written = false;
+        for (int i = UniformSlot::kRegisterTypeFirstEnum; i < UniformSlot::kRegisterTypeMaxEnum; i++) {
+            const RegisterIndex &registerIndex = slot->m_registerIndices[i];
+            if (registerIndex.m_type != nanoem_u32_t(-1)) {
+                written = writeUniformBuffer(registerIndex, ptr, size, *buffers[i]);
+                if (written) {
+                    m_globalUniformPtr->m_numWrittenBytes += size;
+                }
+                else {
+                    m_logger->log(
+                        "Parameter \"%s\" in \"Effects/%s/%s/%s\" cannot be written due to size buffer flow\n",
+                        m_uniformSlotNames[slotIndex].c_str(), nameConstString(),
+                        passPtr->technique()->nameConstString(), passPtr->nameConstString());
+                }
+            }
         }
-    }
-    if (passPtr->findPixelShaderRegisterIndex(name, registerIndex)) {
-        written = writeUniformBuffer(registerIndex, ptr, size, m_globalUniformPtr->m_pixelShaderBuffer);
-        if (!written) {
-            m_logger->log("Parameter \"%s\" in \"Effects/%s/%s/%s\" cannot be written due to size buffer flow\n",
-                name.c_str(), nameConstString(), passPtr->technique()->nameConstString(), passPtr->nameConstString());
+        if (m_enablePassUniformBufferInspection && written) {
+            const nanoem_u8_t *bytes = reinterpret_cast<const nanoem_u8_t *>(ptr);
+            m_passUniformBuffer[passPtr->name()][m_uniformSlotNames[slotIndex]].assign(bytes, bytes + size);
         }
     }
-    if (m_enablePassUniformBufferInspection && written) {
-        const nanoem_u8_t *bytes = reinterpret_cast<const nanoem_u8_t *>(ptr);
-        m_passUniformBuffer[passPtr->name()][name].assign(bytes, bytes + size);
+}
+
+void
+Effect::writeUniformSlot(nanoem_u32_t slotIndex, const effect::Pass *passPtr, const Vector4 &value)
+{
+    writeUniformSlot(slotIndex, passPtr, glm::value_ptr(value), sizeof(value));
+}
+
+void
+Effect::writeUniformSlot(nanoem_u32_t slotIndex, const effect::Pass *passPtr, const Matrix4x4 &value)
+{
+    writeUniformSlot(slotIndex, passPtr, glm::value_ptr(value), sizeof(value));
+}
+
+void
+Effect::writeUniformBuffer(const String &name, const effect::Pass *passPtr, const void *ptr, size_t size)
+{
+    /* only fixed names (e.g. "matWorld" or "EgColor") come here and take one slot lookup per write */
+    const nanoem_u32_t slotIndex = findUniformSlotIndex(name);
+    if (slotIndex != UniformSlot::kInvalidIndex) {
+        writeUniformSlot(slotIndex, passPtr, ptr, size);
     }
 }
 
@@ -4925,7 +4985,13 @@ Effect::writeUniformBuffer(const String &name, const effect::Pass *passPtr, cons
 void
 Effect::writeUniformBuffer(const String &name, const effect::Pass *passPtr, const effect::NonSemanticParameter &value)
 {
-    writeUniformBuffer(name, passPtr, value.m_values.data(), value.m_values.size() * sizeof(value.m_values[0]));
+    const size_t size = value.m_values.size() * sizeof(value.m_values[0]);
+    if (value.m_uniformSlotIndex != UniformSlot::kInvalidIndex) {
+        writeUniformSlot(value.m_uniformSlotIndex, passPtr, value.m_values.data(), size);
+    }
+    else {
+        writeUniformBuffer(name, passPtr, value.m_values.data(), size);
+    }
 }
 
 void
@@ -5223,6 +5289,7 @@ Effect::setTextureValues(const OffscreenRenderTargetImageContainerMap &container
 void
 Effect::updatePassImageHandles(effect::Pass *pass, sg_bindings &bindings)
 {
+    EMAPP_PROFILE_SCOPE("Effect::updatePassImageHandles");
     nanoem_parameter_assert(pass, "must not be nullptr");
     sg_image *pixelShaderImages = bindings.fs_images, *vertexShaderImages = bindings.vs_images,
              fallbackImage = m_project->sharedFallbackImage();
@@ -5257,12 +5324,12 @@ Effect::updatePassImageHandles(effect::Pass *pass, sg_bindings &bindings)
 void
 Effect::updatePassUniformHandles(sg::PassBlock &pb)
 {
+    EMAPP_PROFILE_SCOPE("Effect::updatePassUniformHandles");
     GlobalUniform::Buffer &pbuffer = m_globalUniformPtr->m_pixelShaderBuffer;
     GlobalUniform::Buffer &vbuffer = m_globalUniformPtr->m_vertexShaderBuffer;
+    /* buffers are cleared when another pass or drawable acquires them instead of every draw */
     pbuffer.apply(pb);
     vbuffer.apply(pb);
-    vbuffer.reset();
-    pbuffer.reset();
 }
 
 void
@@ -5277,12 +5344,14 @@ Effect::handleMatrixSemantics(
         AnnotationMap::const_iterator it = parameter.m_annotations.findAnnotation(kObjectKeyLiteral);
         if (it == parameter.m_annotations.end() ||
             StringUtils::equals(it->second.m_string.c_str(), kObjectCameraValueLiteral)) {
-            m_cameraMatrixUniforms.insert(
-                tinystl::make_pair(name, MatrixUniform(name, matrixType, inversed, transposed)));
+            MatrixUniform uniform(name, matrixType, inversed, transposed);
+            uniform.m_uniformSlotIndex = findUniformSlotIndex(name);
+            m_cameraMatrixUniforms.insert(tinystl::make_pair(name, uniform));
         }
         else if (StringUtils::equals(it->second.m_string.c_str(), kObjectLightValueLiteral)) {
-            m_lightMatrixUniforms.insert(
-                tinystl::make_pair(name, MatrixUniform(name, matrixType, inversed, transposed)));
+            MatrixUniform uniform(name, matrixType, inversed, transposed);
+            uniform.m_uniformSlotIndex = findUniformSlotIndex(name);
+            m_lightMatrixUniforms.insert(tinystl::make_pair(name, uniform));
         }
     }
     else {
@@ -5521,6 +5590,39 @@ Effect::overridePipelineDescription(sg_pipeline_desc &pd, ScriptClassType classT
         pd.depth.pixel_format, pd.sample_count, pd.color_count);
 }
 
+tinystl::pair<const Model *, const Accessory *>
+Effect::resolveControlObject(
+    const Model *model, const Accessory *accessory, const Project *project, ControlObjectTarget &target) const
+{
+    tinystl::pair<const Model *, const Accessory *> pair(nullptr, nullptr);
+    switch (target.m_objectType) {
+    case ControlObjectTarget::kObjectTypeSelf: {
+        pair.first = model;
+        pair.second = accessory;
+        break;
+    }
+    case ControlObjectTarget::kObjectTypeOffscreenOwner: {
+        pair = findOffscreenOwnerObject(model ? static_cast<const IDrawable *>(model) : accessory, project);
+        break;
+    }
+    case ControlObjectTarget::kObjectTypeFilename: {
+        /* resolve by filename only when drawables are added, removed or renamed */
+        const nanoem_u32_t generation = project->objectBindingGeneration();
+        if (target.m_objectGeneration != generation) {
+            target.m_modelPtr = project->findModelByFilename(target.m_name);
+            target.m_accessoryPtr = project->findAccessoryByFilename(target.m_name);
+            target.m_objectGeneration = generation;
+        }
+        pair.first = target.m_modelPtr;
+        pair.second = target.m_accessoryPtr;
+        break;
+    }
+    default:
+        break;
+    }
+    return pair;
+}
+
 tinystl::pair<const Model *, const Accessory *>
 Effect::findOffscreenOwnerObject(const IDrawable *ownerDrawable, const Project *project) const NANOEM_DECL_NOEXCEPT
 {
@@ -791,20 +791,29 @@ FileUtils::timestamp(const char *filePath) NANOEM_DECL_NOEXCEPT
 #if BX_PLATFORM_WINDOWS
     MutableWideString newPath;
     StringUtils::getWideCharString(filePath, newPath);
-    FILETIME time;
-    GetFileTime(newPath.data(), nullptr, nullptr, &time);
-    ULARGE_INTEGER ul;
-    ul.HighPart = time.dwHighDateTime;
-    ul.LowPart = time.dwLowDateTime;
-    value = ul.QuadPart;
+    HANDLE handle = CreateFileW(newPath.data(), FILE_READ_ATTRIBUTES,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS,
+        nullptr);
+    if (handle != INVALID_HANDLE_VALUE) {
+        FILETIME time;
+        if (GetFileTime(handle, nullptr, nullptr, &time)) {
+            ULARGE_INTEGER ul;
+            ul.HighPart = time.dwHighDateTime;
+            ul.LowPart = time.dwLowDateTime;
+            value = ul.QuadPart;
+        }
+        CloseHandle(handle);
+    }
 #elif BX_PLATFORM_OSX || BX_PLATFORM_IOS
     struct stat st;
-    ::stat(filePath, &st);
-    value = static_cast<nanoem_u64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+    if (::stat(filePath, &st) == 0) {
+        value = static_cast<nanoem_u64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+    }
 #elif BX_PLATFORM_LINUX
     struct stat st;
-    ::stat(filePath, &st);
-    value = st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    if (::stat(filePath, &st) == 0) {
+        value = static_cast<nanoem_u64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    }
 #endif
     return value;
 }
@@ -16,6 +16,7 @@
 #include "emapp/private/CommonInclude.h"
 
 #include "bx/endian.h"
+#include "bx/simd_t.h"
 
 /* for sscanf */
 #include <stdio.h>
@@ -56,6 +57,8 @@ static const nanoem_u32_t kPNGChunkTypeImageEnd = nanoem_fourcc('I', 'E', 'N', '
 static const nanoem_u32_t kPNGChunkTypeAnimationControl = nanoem_fourcc('a', 'c', 'T', 'L');
 static const nanoem_u32_t kPNGChunkTypeFrameControl = nanoem_fourcc('f', 'c', 'T', 'L');
 static const nanoem_u32_t kPNGChunkTypeFrameData = nanoem_fourcc('f', 'd', 'A', 'T');
+static const nanoem_u8_t kPNGColorTypeTruecolor = 2;
+static const nanoem_u8_t kPNGColorTypeTruecolorAlpha = 6;
 
 static const nanoem_u32_t kDDSImageSizeHardLimit = 16384;
 static const nanoem_u32_t kDDSImageDepthHardLimit = 2048;
@@ -157,8 +160,130 @@ enum D3D11_RESOURCE_MISC_FLAG {
     D3D11_RESOURCE_MISC_TEXTURECUBE = 0x4L,
 };
 
+static inline nanoem_u8_t
+paethPredictor(int a, int b, int c) NANOEM_DECL_NOEXCEPT
+{
+    const int p = a + b - c, pa = glm::abs(p - a), pb = glm::abs(p - b), pc = glm::abs(p - c);
+    return nanoem_u8_t((pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c));
+}
+
+static bool
+unfilterScanlines(nanoem_u8_t *data, nanoem_rsize_t stride, nanoem_u32_t height, nanoem_u32_t bpp) NANOEM_DECL_NOEXCEPT
+{
+    const nanoem_u8_t *previousLine = nullptr;
+    bool valid = true;
+    for (nanoem_u32_t y = 0; valid && y < height; y++) {
+        const nanoem_u8_t filterType = *data++;
+        nanoem_u8_t *line = data;
+        switch (filterType) {
+        case 0: {
+            break;
+        }
+        case 1: {
+            for (nanoem_rsize_t x = bpp; x < stride; x++) {
+                line[x] = nanoem_u8_t(line[x] + line[x - bpp]);
+            }
+            break;
+        }
+        case 2: {
+            for (nanoem_rsize_t x = 0; previousLine && x < stride; x++) {
+                line[x] = nanoem_u8_t(line[x] + previousLine[x]);
+            }
+            break;
+        }
+        case 3: {
+            for (nanoem_rsize_t x = 0; x < stride; x++) {
+                const int left = x >= bpp ? line[x - bpp] : 0, up = previousLine ? previousLine[x] : 0;
+                line[x] = nanoem_u8_t(line[x] + ((left + up) >> 1));
+            }
+            break;
+        }
+        case 4: {
+            for (nanoem_rsize_t x = 0; x < stride; x++) {
+                const int left = x >= bpp ? line[x - bpp] : 0, up = previousLine ? previousLine[x] : 0,
+                          upperLeft = previousLine && x >= bpp ? previousLine[x - bpp] : 0;
+                line[x] = nanoem_u8_t(line[x] + paethPredictor(left, up, upperLeft));
+            }
+            break;
+        }
+        default:
+            valid = false;
+            break;
+        }
+        previousLine = line;
+        data += stride;
+    }
+    return valid;
+}
+
+static inline void
+blendPixelOver(const nanoem_u8_t *source, nanoem_u8_t *dest) NANOEM_DECL_NOEXCEPT
+{
+    const nanoem_u8_t alpha = source[3];
+    const nanoem_f32_t factor = alpha / 255.0f;
+    for (int i = 0; i < 3; i++) {
+        const nanoem_u8_t foreground = factor * source[i], background = (1.0f - factor) * dest[i];
+        dest[i] = foreground + background;
+    }
+    if (dest[3] == 0) {
+        dest[3] = alpha;
+    }
+}
+
+struct BlendFactorTable {
+    BlendFactorTable() NANOEM_DECL_NOEXCEPT
+    {
+        for (nanoem_rsize_t i = 0; i < BX_COUNTOF(m_values); i++) {
+            m_values[i] = i / 255.0f;
+        }
+    }
+    nanoem_f32_t m_values[256];
+};
+static const BlendFactorTable kBlendFactorTable;
+
+static inline bx::simd128_t
+multiplyPixelChannel(bx::simd128_t pixels, int shift, bx::simd128_t factor) NANOEM_DECL_NOEXCEPT
+{
+    const bx::simd128_t channel = bx::simd_itof(bx::simd_and(bx::simd_srl(pixels, shift), bx::simd_isplat(0xff)));
+    return bx::simd_ftoi(bx::simd_floor(bx::simd_mul(factor, channel)));
+}
+
+static inline void
+blendFourPixelsOver(const nanoem_u8_t *source, nanoem_u8_t *dest) NANOEM_DECL_NOEXCEPT
+{
+    /*
+     * each lane holds one little endian RGBA pixel. factors are looked up from the table divided with scalar as
+     * NEON divides with the reciprocal estimate, and products are truncated with floor as ftoi rounds on SSE,
+     * so results are the same as blendPixelOver bit for bit
+     */
+    BX_ALIGN_DECL_16(nanoem_u32_t) pixels[4];
+    BX_ALIGN_DECL_16(nanoem_f32_t) factors[4];
+    for (int i = 0; i < 4; i++) {
+        factors[i] = kBlendFactorTable.m_values[source[i * 4 + 3]];
+    }
+    memcpy(pixels, source, sizeof(pixels));
+    const bx::simd128_t foreground = bx::simd_ld(pixels);
+    memcpy(pixels, dest, sizeof(pixels));
+    const bx::simd128_t background = bx::simd_ld(pixels), alphaMask = bx::simd_isplat(0xff000000),
+                        factor = bx::simd_ld(factors), inverse = bx::simd_sub(bx::simd_splat(1.0f), factor),
+                        backgroundAlpha = bx::simd_and(background, alphaMask);
+    bx::simd128_t result = bx::simd_selb(bx::simd_icmpeq(backgroundAlpha, bx::simd_zero()),
+        bx::simd_and(foreground, alphaMask), backgroundAlpha);
+    for (int i = 0; i < 3; i++) {
+        const int shift = i * 8;
+        const bx::simd128_t value = bx::simd_iadd(
+            multiplyPixelChannel(foreground, shift, factor), multiplyPixelChannel(background, shift, inverse));
+        result = bx::simd_or(result, bx::simd_sll(bx::simd_and(value, bx::simd_isplat(0xff)), shift));
+    }
+    bx::simd_st(pixels, result);
+    memcpy(dest, pixels, sizeof(pixels));
+}
+
 } /* namespace anonymous */
 
+const nanoem_rsize_t image::APNG::kMaxNumKeyframeCompositions = 8;
+const nanoem_rsize_t image::APNG::kInvalidOffset = ~nanoem_rsize_t(0);
+
 struct image::APNG::State {
     ByteArray m_dataChunk;
     CRC m_crc;
@@ -178,6 +303,9 @@ struct image::APNG::State {
 };
 
 image::APNG::APNG()
+    : m_compositionOffset(kInvalidOffset)
+    , m_keyframeInterval(1)
+    , m_frameInflationEnabled(true)
 {
     Inline::clearZeroMemory(m_header);
     Inline::clearZeroMemory(m_control);
@@ -287,96 +415,15 @@ image::APNG::decode(ISeekableReader *reader, Error &error)
 void
 image::APNG::composite(Error &error)
 {
-    CRC crc;
-    ByteArray compositionImageData, buffer;
-    MemoryWriter writer(&buffer);
-    const nanoem_u32_t width = m_header.m_width, height = m_header.m_height;
-    compositionImageData.resize(nanoem_rsize_t(4) * width * height);
-    for (APNG::FrameSequenceList::const_iterator it = m_frames.begin(), end = m_frames.end(); it != end; ++it) {
-        APNG::Frame *frame = *it;
-        const APNG::FrameControl &frameControl = frame->m_control;
-        switch (frameControl.m_disposeOp) {
-        case APNG::kDisposeOpPrevious: {
-            if (it > m_frames.begin()) {
-                const APNG::Frame *previousFrame = *(it - 1);
-                compositionImageData = previousFrame->m_composition;
-            }
-            break;
-        }
-        case APNG::kDisposeOpBackground: {
-            memset(compositionImageData.data(), 0, compositionImageData.size());
-            break;
-        }
-        case APNG::kDisposeOpNone:
-        default:
-            break;
-        }
-        for (ByteArrayList::const_iterator it2 = frame->m_sequences.begin(), end2 = frame->m_sequences.end();
-             it2 != end2; ++it2) {
-            const ByteArray &bytes = *it2;
-            APNG::Header header(m_header);
-            header.m_width = bx::toBigEndian(frameControl.m_width);
-            header.m_height = bx::toBigEndian(frameControl.m_height);
-            writer.clear();
-            FileUtils::writeTyped(&writer, kPNGSignature, error);
-            FileUtils::writeTyped(&writer, bx::toBigEndian(Inline::saturateInt32U(sizeof(header))), error);
-            FileUtils::writeTyped(&writer, kPNGChunkTypeImageHeader, error);
-            FileUtils::writeTyped(&writer, header, error);
-            FileUtils::writeTyped(&writer, crc.checksumTyped(kPNGChunkTypeImageHeader, header), error);
-            FileUtils::writeTyped(&writer, bx::toBigEndian(Inline::saturateInt32U(bytes.size())), error);
-            FileUtils::writeTyped(&writer, kPNGChunkTypeImageData, error);
-            FileUtils::write(&writer, bytes, error);
-            FileUtils::writeTyped(&writer, crc.checksum(kPNGChunkTypeImageData, bytes.data(), bytes.size()), error);
-            FileUtils::writeTyped(&writer, 0, error);
-            FileUtils::writeTyped(&writer, kPNGChunkTypeImageEnd, error);
-            FileUtils::writeTyped(&writer, crc.checksum(kPNGChunkTypeImageEnd, nullptr, 0), error);
-            Error err;
-            sg_image_desc desc;
-            nanoem_u8_t *decodedImageDataPtr = nullptr;
-            Inline::clearZeroMemory(desc);
-            if (ImageLoader::decodeImageWithSTB(buffer.data(), buffer.size(), "", desc, &decodedImageDataPtr, err)) {
-                desc.mag_filter = desc.min_filter = SG_FILTER_LINEAR;
-                if (frameControl.m_blendOp == APNG::kBlendOpSource) {
-                    const nanoem_u32_t *imageDataPtr = reinterpret_cast<const nanoem_u32_t *>(decodedImageDataPtr);
-                    nanoem_u32_t *compositionImageDataPtr =
-                                     reinterpret_cast<nanoem_u32_t *>(compositionImageData.data()),
-                                 xoffset = frameControl.m_xoffset, yoffset = frameControl.m_yoffset;
-                    for (nanoem_u32_t y = 0, h = frameControl.m_height; y < h; y++) {
-                        for (nanoem_u32_t x = 0, w = frameControl.m_width; x < w; x++) {
-                            const nanoem_rsize_t srcOffset = y * frameControl.m_width + x,
-                                                 dstOffset = ((y + yoffset) * width) + (x + xoffset);
-                            compositionImageDataPtr[dstOffset] = imageDataPtr[srcOffset];
-                        }
-                    }
-                }
-                else if (frameControl.m_blendOp == APNG::kBlendOpOver) {
-                    const nanoem_u32_t xoffset = frameControl.m_xoffset, yoffset = frameControl.m_yoffset;
-                    const nanoem_u8_t *imageDataPtr = static_cast<const nanoem_u8_t *>(decodedImageDataPtr);
-                    nanoem_u8_t *compositionImageDataPtr = compositionImageData.data();
-                    // nanoem_u32_t i0, i1;
-                    for (nanoem_u32_t y = 0, h = frameControl.m_height; y < h; y++) {
-                        for (nanoem_u32_t x = 0, w = frameControl.m_width; x < w; x++) {
-                            const nanoem_rsize_t srcOffset = (y * frameControl.m_width + x) * 4,
-                                                 dstOffset = (((y + yoffset) * width) + (x + xoffset)) * 4;
-                            const nanoem_u8_t a = imageDataPtr[srcOffset + 3];
-                            float alpha = a / 255.0f;
-                            for (int i = 0; i < 3; i++) {
-                                const nanoem_u8_t fg = alpha * imageDataPtr[srcOffset + i];
-                                const nanoem_u8_t bg = (1.0f - alpha) * compositionImageDataPtr[dstOffset + i];
-                                compositionImageDataPtr[dstOffset + i] = fg + bg;
-                            }
-                            if (compositionImageDataPtr[dstOffset + 3] == 0) {
-                                compositionImageDataPtr[dstOffset + 3] = a;
-                            }
-                            // i0 = Inline::saturateInt32U(srcOffset);
-                            // i1 = Inline::saturateInt32U(dstOffset);
-                        }
-                    }
-                }
-                ImageLoader::releaseDecodedImageWithSTB(&decodedImageDataPtr);
-            }
-        }
-        frame->m_composition = compositionImageData;
+    const nanoem_rsize_t numFrames = m_frames.size();
+    /* keep only a bounded number of composed frames as seek points instead of every frame */
+    m_keyframeInterval = glm::max((numFrames + kMaxNumKeyframeCompositions - 1) / kMaxNumKeyframeCompositions,
+        nanoem_rsize_t(1));
+    m_keyframeCompositions.clear();
+    m_composition.clear();
+    m_compositionOffset = kInvalidOffset;
+    if (numFrames > 0 && !error.hasReason()) {
+        compositedFrameImage(0);
     }
 }
 
@@ -384,30 +431,111 @@ nanoem_rsize_t
 image::APNG::findNearestOffset(nanoem_f32_t seconds) const NANOEM_DECL_NOEXCEPT
 {
     nanoem_rsize_t offset = 0;
-    if (!m_frames.empty()) {
-        const nanoem_f32_t duration = m_frames.back()->m_seconds, value = fmod(seconds, duration);
-        for (nanoem_rsize_t i = 0, numFrames = m_frames.size() - 1; i < numFrames; i++) {
-            const nanoem_f32_t v0 = m_frames[i]->m_seconds;
-            const nanoem_f32_t v1 = m_frames[i + 1]->m_seconds;
-            if (v0 < value && v1 > value) {
-                offset = i;
-                break;
+    if (m_frames.size() > 1) {
+        const nanoem_f32_t duration = m_frames.back()->m_seconds;
+        if (duration > 0) {
+            const nanoem_f32_t value = fmod(seconds, duration);
+            /* find the last frame starting at or before the value by binary search */
+            nanoem_rsize_t low = 0, high = m_frames.size() - 1;
+            while (low < high) {
+                const nanoem_rsize_t middle = low + (high - low) / 2;
+                if (m_frames[middle]->m_seconds <= value) {
+                    low = middle + 1;
+                }
+                else {
+                    high = middle;
+                }
             }
+            offset = low > 0 ? low - 1 : 0;
         }
     }
     return offset;
 }
 
 const ByteArray *
-image::APNG::compositedFrameImage(nanoem_rsize_t offset) const NANOEM_DECL_NOEXCEPT
+image::APNG::compositedFrameImage(nanoem_rsize_t offset)
 {
     const ByteArray *composition = nullptr;
     if (offset < m_frames.size()) {
-        composition = &m_frames[offset]->m_composition;
+        if (offset != m_compositionOffset) {
+            nanoem_rsize_t start = 0;
+            if (m_compositionOffset != kInvalidOffset && m_compositionOffset < offset) {
+                start = m_compositionOffset + 1;
+            }
+            /* resume from the nearest keyframe composition if it is closer than the current one */
+            for (nanoem_rsize_t i = (offset / m_keyframeInterval) * m_keyframeInterval;; i -= m_keyframeInterval) {
+                if (i < start) {
+                    break;
+                }
+                CompositionMap::const_iterator it = m_keyframeCompositions.find(i);
+                if (it != m_keyframeCompositions.end()) {
+                    m_composition = it->second;
+                    start = i + 1;
+                    break;
+                }
+                else if (i == 0) {
+                    break;
+                }
+            }
+            if (start == 0) {
+                m_composition.resize(nanoem_rsize_t(4) * m_header.m_width * m_header.m_height);
+                memset(m_composition.data(), 0, m_composition.size());
+            }
+            Error error;
+            for (nanoem_rsize_t i = start; i <= offset; i++) {
+                composeFrame(m_frames[i], error);
+                if (i % m_keyframeInterval == 0 &&
+                    m_keyframeCompositions.find(i) == m_keyframeCompositions.end()) {
+                    m_keyframeCompositions.insert(tinystl::make_pair(i, m_composition));
+                }
+            }
+            m_compositionOffset = offset;
+        }
+        composition = &m_composition;
     }
     return composition;
 }
 
+nanoem_rsize_t
+image::APNG::numFrames() const NANOEM_DECL_NOEXCEPT
+{
+    return m_frames.size();
+}
+
+nanoem_rsize_t
+image::APNG::numKeyframeCompositions() const NANOEM_DECL_NOEXCEPT
+{
+    return m_keyframeCompositions.size();
+}
+
+void
+image::APNG::blendPixelsOver(
+    const nanoem_u8_t *source, nanoem_u8_t *dest, nanoem_rsize_t numPixels, bool enableSIMD) NANOEM_DECL_NOEXCEPT
+{
+    nanoem_rsize_t offset = 0;
+    if (enableSIMD) {
+        for (const nanoem_rsize_t numAlignedPixels = numPixels & ~nanoem_rsize_t(3); offset < numAlignedPixels;
+             offset += 4) {
+            blendFourPixelsOver(source + offset * 4, dest + offset * 4);
+        }
+    }
+    for (; offset < numPixels; offset++) {
+        blendPixelOver(source + offset * 4, dest + offset * 4);
+    }
+}
+
+bool
+image::APNG::isFrameInflationEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return m_frameInflationEnabled;
+}
+
+void
+image::APNG::setFrameInflationEnabled(bool value)
+{
+    m_frameInflationEnabled = value;
+}
+
 nanoem_u32_t
 image::APNG::width() const NANOEM_DECL_NOEXCEPT
 {
@@ -440,7 +568,7 @@ image::APNG::decodeFrameControl(ISeekableReader *reader, State &state, Error &er
 {
     char message[Error::kMaxReasonLength];
     if (state.m_frame) {
-        if (state.m_frame->m_sequences.empty()) {
+        if (state.m_frame->m_numSequences == 0) {
             error = Error("APNG: Empty image sequence", 0, Error::kDomainTypeApplication);
             return 0;
         }
@@ -508,8 +636,10 @@ image::APNG::decodeFrameData(ISeekableReader *reader, nanoem_u32_t chunkLength,
             error = Error(message, 0, Error::kDomainTypeApplication);
         }
         else if (state.m_frame) {
-            state.m_dataChunk.erase(state.m_dataChunk.begin(), state.m_dataChunk.begin() + sizeof(sequenceNumber));
-            state.m_frame->m_sequences.push_back(state.m_dataChunk);
+            /* all fdAT chunks of the frame form a single zlib stream */
+            ByteArray &data = state.m_frame->m_data;
+            data.insert(data.end(), state.m_dataChunk.begin() + sizeof(sequenceNumber), state.m_dataChunk.end());
+            state.m_frame->m_numSequences++;
         }
     }
     state.m_expectedSequenceNumber++;
@@ -526,7 +656,9 @@ image::APNG::decodeImageData(ISeekableReader *reader, nanoem_u32_t chunkLength,
     }
     nanoem_u32_t checksum = state.m_crc.checksum(kPNGChunkTypeImageData, state.m_dataChunk.data(), chunkLength);
     if (state.m_frame) {
-        state.m_frame->m_sequences.push_back(state.m_dataChunk);
+        ByteArray &data = state.m_frame->m_data;
+        data.insert(data.end(), state.m_dataChunk.begin(), state.m_dataChunk.end());
+        state.m_frame->m_numSequences++;
     }
     return checksum;
 }
@@ -535,7 +667,7 @@ nanoem_u32_t
 image::APNG::decodeImageEnd(State &state, Error &error)
 {
     if (state.m_frame) {
-        if (state.m_frame->m_sequences.empty()) {
+        if (state.m_frame->m_numSequences == 0) {
             error = Error("APNG: Empty image sequence", 0, Error::kDomainTypeApplication);
             return 0;
         }
@@ -568,6 +700,116 @@ image::APNG::decodeImageHeader(ISeekableReader *reader, State &state, Error &err
     return checksum;
 }
 
+void
+image::APNG::composeFrame(const Frame *frame, Error &error)
+{
+    const APNG::FrameControl &frameControl = frame->m_control;
+    if (frameControl.m_disposeOp == APNG::kDisposeOpBackground) {
+        memset(m_composition.data(), 0, m_composition.size());
+    }
+    /* kDisposeOpPrevious keeps the composition of the previous frame as is */
+    if (decodeFrameImage(frame, error)) {
+        const nanoem_u32_t width = m_header.m_width, xoffset = frameControl.m_xoffset,
+                           yoffset = frameControl.m_yoffset, frameWidth = frameControl.m_width;
+        const nanoem_rsize_t frameStride = nanoem_rsize_t(4) * frameWidth;
+        const nanoem_u8_t *imageDataPtr = m_frameImage.data();
+        for (nanoem_u32_t y = 0, h = frameControl.m_height; y < h; y++) {
+            const nanoem_u8_t *sourceLine = imageDataPtr + y * frameStride;
+            nanoem_u8_t *destLine = m_composition.data() + ((nanoem_rsize_t(y) + yoffset) * width + xoffset) * 4;
+            if (frameControl.m_blendOp == APNG::kBlendOpOver) {
+                blendPixelsOver(sourceLine, destLine, frameWidth, true);
+            }
+            else {
+                memcpy(destLine, sourceLine, frameStride);
+            }
+        }
+    }
+}
+
+bool
+image::APNG::decodeFrameImage(const Frame *frame, Error &error)
+{
+    const bool inflatable = m_frameInflationEnabled && m_header.m_depth == 8 && m_header.m_interlaceType == 0 &&
+        (m_header.m_colorType == kPNGColorTypeTruecolor || m_header.m_colorType == kPNGColorTypeTruecolorAlpha);
+    return inflatable ? inflateFrameImage(frame) : decodeFrameImageWithSTB(frame, error);
+}
+
+bool
+image::APNG::inflateFrameImage(const Frame *frame)
+{
+    const FrameControl &frameControl = frame->m_control;
+    const nanoem_u32_t bpp = m_header.m_colorType == kPNGColorTypeTruecolorAlpha ? 4 : 3,
+                       width = frameControl.m_width, height = frameControl.m_height;
+    const nanoem_rsize_t stride = nanoem_rsize_t(bpp) * width, inflatedSize = (stride + 1) * height;
+    m_inflatedFrameData.resize(inflatedSize);
+    /* inflate the concatenated frame data directly instead of wrapping it into another PNG */
+    const int actualSize = stbi_zlib_decode_buffer(reinterpret_cast<char *>(m_inflatedFrameData.data()),
+        Inline::saturateInt32(inflatedSize), reinterpret_cast<const char *>(frame->m_data.data()),
+        Inline::saturateInt32(frame->m_data.size()));
+    bool succeeded = false;
+    if (actualSize >= 0 && nanoem_rsize_t(actualSize) == inflatedSize &&
+        unfilterScanlines(m_inflatedFrameData.data(), stride, height, bpp)) {
+        m_frameImage.resize(nanoem_rsize_t(4) * width * height);
+        nanoem_u8_t *dest = m_frameImage.data();
+        for (nanoem_u32_t y = 0; y < height; y++) {
+            const nanoem_u8_t *line = m_inflatedFrameData.data() + y * (stride + 1) + 1;
+            if (bpp == 4) {
+                memcpy(dest, line, stride);
+                dest += stride;
+            }
+            else {
+                for (nanoem_u32_t x = 0; x < width; x++) {
+                    dest[0] = line[0];
+                    dest[1] = line[1];
+                    dest[2] = line[2];
+                    dest[3] = 0xff;
+                    line += 3;
+                    dest += 4;
+                }
+            }
+        }
+        succeeded = true;
+    }
+    return succeeded;
+}
+
+bool
+image::APNG::decodeFrameImageWithSTB(const Frame *frame, Error &error)
+{
+    CRC crc;
+    ByteArray buffer;
+    MemoryWriter writer(&buffer);
+    const FrameControl &frameControl = frame->m_control;
+    const ByteArray &bytes = frame->m_data;
+    APNG::Header header(m_header);
+    header.m_width = bx::toBigEndian(frameControl.m_width);
+    header.m_height = bx::toBigEndian(frameControl.m_height);
+    FileUtils::writeTyped(&writer, kPNGSignature, error);
+    FileUtils::writeTyped(&writer, bx::toBigEndian(Inline::saturateInt32U(sizeof(header))), error);
+    FileUtils::writeTyped(&writer, kPNGChunkTypeImageHeader, error);
+    FileUtils::writeTyped(&writer, header, error);
+    FileUtils::writeTyped(&writer, crc.checksumTyped(kPNGChunkTypeImageHeader, header), error);
+    FileUtils::writeTyped(&writer, bx::toBigEndian(Inline::saturateInt32U(bytes.size())), error);
+    FileUtils::writeTyped(&writer, kPNGChunkTypeImageData, error);
+    FileUtils::write(&writer, bytes, error);
+    FileUtils::writeTyped(&writer, crc.checksum(kPNGChunkTypeImageData, bytes.data(), bytes.size()), error);
+    FileUtils::writeTyped(&writer, 0, error);
+    FileUtils::writeTyped(&writer, kPNGChunkTypeImageEnd, error);
+    FileUtils::writeTyped(&writer, crc.checksum(kPNGChunkTypeImageEnd, nullptr, 0), error);
+    Error err;
+    sg_image_desc desc;
+    nanoem_u8_t *decodedImageDataPtr = nullptr;
+    Inline::clearZeroMemory(desc);
+    bool succeeded = false;
+    if (ImageLoader::decodeImageWithSTB(buffer.data(), buffer.size(), "", desc, &decodedImageDataPtr, err)) {
+        const nanoem_rsize_t size = nanoem_rsize_t(4) * frameControl.m_width * frameControl.m_height;
+        m_frameImage.assign(decodedImageDataPtr, decodedImageDataPtr + size);
+        ImageLoader::releaseDecodedImageWithSTB(&decodedImageDataPtr);
+        succeeded = true;
+    }
+    return succeeded;
+}
+
 const nanoem_u32_t image::DDS::kSignature = nanoem_fourcc('D', 'D', 'S', ' ');
 
 image::DDS::DDS()
@@ -23,11 +23,14 @@
 #include "emapp/Motion.h"
 #include "emapp/PerspectiveCamera.h"
 #include "emapp/PhysicsEngine.h"
+#include "emapp/Profiler.h"
 #include "emapp/Progress.h"
 #include "emapp/Project.h"
 #include "emapp/StringUtils.h"
 #include "emapp/command/TransformBoneCommand.h"
 #include "emapp/command/TransformMorphCommand.h"
+#include "emapp/internal/BoundingVolumeHierarchy.h"
+#include "emapp/internal/FrustumCuller.h"
 #include "emapp/internal/LineDrawer.h"
 #include "emapp/internal/ModelObjectSelection.h"
 #include "emapp/model/BindPose.h"
@@ -66,6 +69,9 @@ namespace {
 
 static const nanoem_f32_t kDrawBoneConnectionThickness = 1.0f;
 static const nanoem_f32_t kDrawVertexNormalScaleFactor = 0.1f;
+/* update_buffer rewrites whole buffer so overlays are split into chunks to upload only dirty ones */
+static const nanoem_rsize_t kDrawArrayBufferChunkSize = 8192;
+static const nanoem_u32_t kInvalidVertexUnitOffset = ~nanoem_u32_t(0);
 static const int kMaxBoneUniforms = 55;
 
 enum PrivateStateFlags {
@@ -92,6 +98,10 @@ enum PrivateStateFlags {
     kPrivateStateShowAllVertexWeights = 1 << 21,
     kPrivateStateBlendingVertexWeightsEnabled = 1 << 22,
     kPrivateStateShowAllVertexNormals = 1 << 23,
+    kPrivateStateTraceConstraintIterations = 1 << 24,
+    kPrivateStateDirtyVertexSpatialIndex = 1 << 25,
+    kPrivateStateDirtyFaceSpatialIndex = 1 << 26,
+    kPrivateStateDirtyMaterialBounds = 1 << 27,
     kPrivateStateReserved = 1 << 31,
 };
 static const nanoem_u32_t kPrivateStateInitialValue = kPrivateStatePhysicsSimulation | kPrivateStateEnableGroundShadow;
@@ -204,6 +214,80 @@ struct DummyLight : ILight {
     Project *m_project;
 };
 
+class ViewportRectCuller : public internal::BoundingVolumeHierarchy::ICuller {
+public:
+    ViewportRectCuller(const ICamera *camera, const Vector4SI32 &deviceScaleRect)
+        : m_camera(camera)
+        , m_rect(deviceScaleRect)
+    {
+        Matrix4x4 view, projection;
+        camera->getViewTransform(view, projection);
+        m_viewProjection = projection * view;
+    }
+    bool
+    intersects(const Vector3 &aabbMin, const Vector3 &aabbMax) const NANOEM_DECL_NOEXCEPT_OVERRIDE
+    {
+        Vector2SI32 coordMin(INT32_MAX), coordMax(INT32_MIN);
+        for (int i = 0; i < 8; i++) {
+            const Vector3 corner(
+                i & 1 ? aabbMax.x : aabbMin.x, i & 2 ? aabbMax.y : aabbMin.y, i & 4 ? aabbMax.z : aabbMin.z);
+            if ((m_viewProjection * Vector4(corner, 1)).w <= 0) {
+                /* projected box is not bounded by its corners when it crosses the camera plane */
+                return true;
+            }
+            const Vector2SI32 coord(m_camera->toDeviceScreenCoordinateInViewport(corner));
+            coordMin = glm::min(coordMin, coord);
+            coordMax = glm::max(coordMax, coord);
+        }
+        /* one pixel margin absorbs rounding of projected coordinates */
+        return coordMax.x + 1 >= m_rect.x && coordMin.x - 1 <= m_rect.x + m_rect.z && coordMax.y + 1 >= m_rect.y &&
+            coordMin.y - 1 <= m_rect.y + m_rect.w;
+    }
+
+private:
+    const ICamera *m_camera;
+    const Vector4SI32 m_rect;
+    Matrix4x4 m_viewProjection;
+};
+
+static Vector4U8
+vertexWeightColor(
+    const model::Vertex *vertex, const model::Bone *activeBoneObject, bool enableBlending) NANOEM_DECL_NOEXCEPT
+{
+    Vector3 color(0.25f);
+    nanoem_f32_t opacity = vertex->isEditingMasked() || enableBlending ? 0.0f : 1.0f;
+    for (nanoem_rsize_t j = 0; j < 4; j++) {
+        const model::Bone *bone = vertex->bone(j);
+        if (bone && bone == activeBoneObject) {
+            nanoem_f32_t component = 0;
+            switch (j) {
+            case 0: {
+                component = bx::simd_x(vertex->m_simd.m_weights);
+                break;
+            }
+            case 1: {
+                component = bx::simd_y(vertex->m_simd.m_weights);
+                break;
+            }
+            case 2: {
+                component = bx::simd_z(vertex->m_simd.m_weights);
+                break;
+            }
+            case 3: {
+                component = bx::simd_w(vertex->m_simd.m_weights);
+                break;
+            }
+            default:
+                break;
+            }
+            color = Color::jet(component);
+            opacity = 1.0f;
+            break;
+        }
+    }
+    return Vector4U8(Vector4(color, opacity) * 255.0f);
+}
+
 } /* namespace anonymous */
 
 const Matrix4x4 Model::kInitialWorldMatrix = Constants::kIdentity;
@@ -529,6 +613,7 @@ Model::ParallelSkinningTaskData::ParallelSkinningTaskData(
     , m_drawType(type)
     , m_edgeSizeScaleFactor(edgeSizeFactor)
     , m_boneIndices(0)
+    , m_skinnedVertexCache(nullptr)
     , m_output(0)
     , m_materials(nullptr)
     , m_vertices(nullptr)
@@ -544,28 +629,209 @@ Model::ParallelSkinningTaskData::~ParallelSkinningTaskData() NANOEM_DECL_NOEXCEP
 {
 }
 
+Model::SkinnedVertexCache::SkinnedVertexCache()
+    : m_generation(0)
+{
+}
+
+Model::SkinnedVertexCache::~SkinnedVertexCache() NANOEM_DECL_NOEXCEPT
+{
+}
+
+void
+Model::SkinnedVertexCache::resize(nanoem_rsize_t numVertices)
+{
+    m_positions.resize(numVertices);
+    m_normals.resize(numVertices);
+}
+
+void
+Model::SkinnedVertexCache::store(
+    nanoem_rsize_t index, const bx::simd128_t &position, const bx::simd128_t &normal) NANOEM_DECL_NOEXCEPT
+{
+    m_positions[index] = Vector3(bx::simd_x(position), bx::simd_y(position), bx::simd_z(position));
+    m_normals[index] = Vector3(bx::simd_x(normal), bx::simd_y(normal), bx::simd_z(normal));
+}
+
+Model::RigidBodyTransformCache::RigidBodyTransformCache()
+    : m_physicsEngine(nullptr)
+{
+}
+
+void
+Model::RigidBodyTransformCache::fetch(
+    nanoem_model_rigid_body_t *const *rigidBodies, nanoem_rsize_t numRigidBodies, bool includeWorldTransforms)
+{
+    m_motionStates.resize(numRigidBodies);
+    m_initialTransforms.resize(numRigidBodies * 16);
+    m_updatedMotionStates.clear();
+    m_updatedWorldTransforms.clear();
+    for (nanoem_rsize_t i = 0; i < numRigidBodies; i++) {
+        const model::RigidBody *rigidBody = model::RigidBody::cast(rigidBodies[i]);
+        m_motionStates[i] = rigidBody ? m_physicsEngine->motionState(rigidBody->physicsRigidBody()) : nullptr;
+    }
+    m_physicsEngine->getAllInitialTransforms(m_motionStates.data(), numRigidBodies, m_initialTransforms.data());
+    if (includeWorldTransforms) {
+        m_worldTransforms.resize(numRigidBodies * 16);
+        m_physicsEngine->getAllWorldTransforms(m_motionStates.data(), numRigidBodies, m_worldTransforms.data());
+    }
+}
+
+void
+Model::RigidBodyTransformCache::flush()
+{
+    if (!m_updatedMotionStates.empty()) {
+        m_physicsEngine->setAllWorldTransforms(
+            m_updatedMotionStates.data(), m_updatedMotionStates.size(), m_updatedWorldTransforms.data());
+        m_updatedMotionStates.clear();
+        m_updatedWorldTransforms.clear();
+    }
+}
+
+Model::MaterialBound::MaterialBound()
+    : m_radius(0)
+    , m_maxEdgeSize(0)
+    , m_cullable(false)
+{
+}
+
+Model::DirtyVertexSet::DirtyVertexSet()
+    : m_all(true)
+{
+}
+
+void
+Model::DirtyVertexSet::resize(nanoem_rsize_t numVertices)
+{
+    m_indices.clear();
+    m_flags.clear();
+    m_flags.resize(numVertices);
+    m_all = true;
+}
+
+void
+Model::DirtyVertexSet::add(nanoem_rsize_t index)
+{
+    /* nothing is collected until the overlay is allocated as all vertices are written at first */
+    if (!m_all && index < m_flags.size() && m_flags[index] == 0) {
+        m_flags[index] = 1;
+        m_indices.push_back(Inline::saturateInt32U(index));
+    }
+}
+
+void
+Model::DirtyVertexSet::clear()
+{
+    for (VertexIndexList::const_iterator it = m_indices.begin(), end = m_indices.end(); it != end; ++it) {
+        m_flags[*it] = 0;
+    }
+    m_indices.clear();
+    m_all = false;
+}
+
+void
+Model::DirtyVertexSet::destroy()
+{
+    m_indices.clear();
+    m_flags.clear();
+    m_all = true;
+}
+
 Model::DrawArrayBuffer::DrawArrayBuffer()
+    : m_skinnedVertexGeneration(0)
 {
-    m_buffer = { SG_INVALID_ID };
 }
 
 Model::DrawArrayBuffer::~DrawArrayBuffer() NANOEM_DECL_NOEXCEPT
 {
 }
 
+void
+Model::DrawArrayBuffer::ensureInitialized(
+    const char *name, const char *kind, nanoem_rsize_t numVertices, nanoem_rsize_t numVertexUnits)
+{
+    if (m_buffers.empty()) {
+        const nanoem_rsize_t numChunks =
+            glm::max((numVertexUnits + kDrawArrayBufferChunkSize - 1) / kDrawArrayBufferChunkSize, size_t(1));
+        m_vertices.resize(glm::max(numVertexUnits, size_t(1)));
+        m_vertexUnitOffsets.resize(numVertices);
+        m_buffers.resize(numChunks);
+        m_dirtyChunks.resize(numChunks);
+        m_dirtyVertices.resize(numVertices);
+        for (nanoem_rsize_t i = 0; i < numChunks; i++) {
+            const nanoem_rsize_t offset = i * kDrawArrayBufferChunkSize;
+            sg_buffer_desc bd;
+            Inline::clearZeroMemory(bd);
+            bd.size = sizeof(m_vertices[0]) * glm::min(m_vertices.size() - offset, kDrawArrayBufferChunkSize);
+            bd.usage = SG_USAGE_DYNAMIC;
+            char label[Inline::kMarkerStringLength];
+            if (Inline::isDebugLabelEnabled()) {
+                StringUtils::format(
+                    label, sizeof(label), "Models/%s/%s/VertexBuffer/%d", name, kind, Inline::saturateInt32(i));
+                bd.label = label;
+            }
+            sg_buffer &buffer = m_buffers[i];
+            buffer = sg::make_buffer(&bd);
+            nanoem_assert(sg::query_buffer_state(buffer) == SG_RESOURCESTATE_VALID, "vertex buffer must be valid");
+            SG_LABEL_BUFFER(buffer, bd.label);
+        }
+    }
+}
+
+void
+Model::DrawArrayBuffer::markVertexUnitDirty(nanoem_rsize_t offset) NANOEM_DECL_NOEXCEPT
+{
+    m_dirtyChunks[offset / kDrawArrayBufferChunkSize] = 1;
+}
+
+void
+Model::DrawArrayBuffer::update(nanoem_rsize_t numVertexUnits, bool all)
+{
+    const nanoem_rsize_t numChunks = (numVertexUnits + kDrawArrayBufferChunkSize - 1) / kDrawArrayBufferChunkSize;
+    for (nanoem_rsize_t i = 0; i < numChunks; i++) {
+        if (all || m_dirtyChunks[i]) {
+            const nanoem_rsize_t offset = i * kDrawArrayBufferChunkSize,
+                                 size = glm::min(numVertexUnits - offset, kDrawArrayBufferChunkSize);
+            sg::update_buffer(
+                m_buffers[i], &m_vertices[offset], Inline::saturateInt32(sizeof(m_vertices[0]) * size));
+        }
+    }
+    memset(m_dirtyChunks.data(), 0, m_dirtyChunks.size());
+}
+
+void
+Model::DrawArrayBuffer::draw(internal::LineDrawer *drawer, nanoem_rsize_t numVertexUnits, sg_primitive_type type)
+{
+    const nanoem_rsize_t numChunks = (numVertexUnits + kDrawArrayBufferChunkSize - 1) / kDrawArrayBufferChunkSize;
+    for (nanoem_rsize_t i = 0; i < numChunks; i++) {
+        const nanoem_rsize_t offset = i * kDrawArrayBufferChunkSize;
+        internal::LineDrawer::Option option(
+            m_buffers[i], glm::min(numVertexUnits - offset, kDrawArrayBufferChunkSize));
+        option.m_primitiveType = type;
+        drawer->drawPass(option);
+    }
+}
+
 void
 Model::DrawArrayBuffer::destroy()
 {
-    SG_INSERT_MARKERF("Model::DrawArrayBuffer::destroy(vertex=%d", m_buffer.id);
-    if (sg::is_valid(m_buffer)) {
-        sg::destroy_buffer(m_buffer);
-        m_buffer = { SG_INVALID_ID };
+    for (BufferList::const_iterator it = m_buffers.begin(), end = m_buffers.end(); it != end; ++it) {
+        SG_INSERT_MARKERF("Model::DrawArrayBuffer::destroy(vertex=%d)", it->id);
+        sg::destroy_buffer(*it);
     }
+    m_buffers.clear();
     m_vertices.clear();
+    m_vertexUnitOffsets.clear();
+    m_dirtyChunks.clear();
+    m_dirtyVertices.destroy();
+    m_skinnedVertexGeneration = 0;
 }
 
 Model::DrawIndexedBuffer::DrawIndexedBuffer()
     : m_color(0xff)
+    , m_activeBonePtr(nullptr)
+    , m_skinnedVertexGeneration(0)
+    , m_blendingEnabled(false)
 {
     m_vertexBuffer = m_indexBuffer = m_activeIndexBuffer = { SG_INVALID_ID };
 }
@@ -625,6 +891,7 @@ Model::DrawIndexedBuffer::ensureVertexBufferInitialized(const char *name, nanoem
 {
     if (!sg::is_valid(m_vertexBuffer)) {
         m_vertices.resize(glm::max(numVertices, size_t(1)));
+        m_dirtyVertices.resize(numVertices);
         sg_buffer_desc desc;
         Inline::clearZeroMemory(desc);
         desc.size = sizeof(m_vertices[0]) * m_vertices.size();
@@ -700,10 +967,12 @@ Model::DrawIndexedBuffer::ensureIndexBufferInitialized(
 }
 
 void
-Model::DrawIndexedBuffer::update()
+Model::DrawIndexedBuffer::update(bool updateVertices)
 {
-    const int vertexBufferSize = Inline::saturateInt32(m_vertices.size() * sizeof(m_vertices[0]));
-    sg::update_buffer(m_vertexBuffer, m_vertices.data(), vertexBufferSize);
+    if (updateVertices) {
+        const int vertexBufferSize = Inline::saturateInt32(m_vertices.size() * sizeof(m_vertices[0]));
+        sg::update_buffer(m_vertexBuffer, m_vertices.data(), vertexBufferSize);
+    }
     if (sg::is_valid(m_activeIndexBuffer)) {
         const int activeIndexBufferSize = Inline::saturateInt32(m_activeIndices.size() * sizeof(m_activeIndices[0]));
         sg::update_buffer(m_activeIndexBuffer, m_activeIndices.data(), activeIndexBufferSize);
@@ -728,6 +997,10 @@ Model::DrawIndexedBuffer::destroy()
     }
     m_vertices.clear();
     m_activeIndices.clear();
+    m_dirtyVertices.destroy();
+    m_activeBonePtr = nullptr;
+    m_skinnedVertexGeneration = 0;
+    m_blendingEnabled = false;
 }
 
 StringList
@@ -856,6 +1129,9 @@ Model::Model(Project *project, nanoem_u16_t handle)
     , m_camera(nullptr)
     , m_selection(nullptr)
     , m_drawer(nullptr)
+    , m_vertexBoundingVolumes(nullptr)
+    , m_faceBoundingVolumes(nullptr)
+    , m_boneBoundingVolumes(nullptr)
     , m_skinDeformer(nullptr)
     , m_gizmo(nullptr)
     , m_vertexWeightPainter(nullptr)
@@ -879,6 +1155,11 @@ Model::Model(Project *project, nanoem_u16_t handle)
     , m_dispatchParallelTaskQueue(nullptr)
     , m_countVertexSkinningNeeded(0)
     , m_stageVertexBufferIndex(0)
+    , m_skinnedVertexGeneration(1)
+    , m_vertexBoundingVolumesGeneration(0)
+    , m_faceBoundingVolumesGeneration(0)
+    , m_boneBoundingVolumesGeneration(0)
+    , m_boneTransformGeneration(1)
 {
     nanoem_assert(m_project, "must not be nullptr");
     Inline::clearZeroMemory(m_activeMorphPtr);
@@ -904,6 +1185,9 @@ Model::~Model() NANOEM_DECL_NOEXCEPT
 {
     nanoem_delete_safe(m_camera);
     nanoem_delete_safe(m_drawer);
+    nanoem_delete_safe(m_vertexBoundingVolumes);
+    nanoem_delete_safe(m_faceBoundingVolumes);
+    nanoem_delete_safe(m_boneBoundingVolumes);
     nanoem_delete_safe(m_skinDeformer);
     nanoem_delete_safe(m_gizmo);
     nanoem_delete_safe(m_vertexWeightPainter);
@@ -1361,6 +1645,7 @@ Model::setupAllBindings()
         vertex->setupBoneBinding(vertexPtr, this);
     }
     splitBonesPerMaterial(m_boneIndexHashes);
+    m_project->invalidateAllObjectBindings();
 }
 
 void
@@ -1620,6 +1905,7 @@ Model::clear()
     nanoemModelDestroy(m_opaque);
     nanoem_status_t status = NANOEM_STATUS_SUCCESS;
     m_opaque = nanoemModelCreate(m_project->unicodeStringFactory(), &status);
+    m_project->invalidateAllObjectBindings();
 }
 
 void
@@ -1647,6 +1933,7 @@ void
 Model::synchronizeMotion(const Motion *motion, nanoem_frame_index_t frameIndex, nanoem_f32_t amount,
     PhysicsEngine::SimulationTimingType timing)
 {
+    EMAPP_PROFILE_SCOPE("Model::synchronizeMotion");
     const nanoem_motion_model_keyframe_t *keyframe = nullptr;
     bool visible = true;
     if (motion && timing == PhysicsEngine::kSimulationTimingBefore) {
@@ -1715,10 +2002,14 @@ Model::synchronizeAllRigidBodiesTransformFeedbackFromSimulation(PhysicsEngine::R
 {
     nanoem_rsize_t numRigidBodies;
     nanoem_model_rigid_body_t *const *rigidBodies = nanoemModelGetAllRigidBodyObjects(m_opaque, &numRigidBodies);
+    RigidBodyTransformCache &cache = m_rigidBodyTransformCache;
+    cache.m_physicsEngine = m_project->physicsEngine();
+    cache.fetch(rigidBodies, numRigidBodies, true);
     for (nanoem_rsize_t i = 0; i < numRigidBodies; i++) {
         const nanoem_model_rigid_body_t *rigidBodyPtr = rigidBodies[i];
         if (model::RigidBody *rigidBody = model::RigidBody::cast(rigidBodyPtr)) {
-            rigidBody->synchronizeTransformFeedbackFromSimulation(rigidBodyPtr, followType);
+            rigidBody->synchronizeTransformFeedbackFromSimulation(
+                rigidBodyPtr, &cache.m_initialTransforms[i * 16], &cache.m_worldTransforms[i * 16], followType);
         }
     }
 }
@@ -1728,13 +2019,23 @@ Model::synchronizeAllRigidBodiesTransformFeedbackToSimulation()
 {
     nanoem_rsize_t numRigidBodies;
     nanoem_model_rigid_body_t *const *rigidBodies = nanoemModelGetAllRigidBodyObjects(m_opaque, &numRigidBodies);
+    RigidBodyTransformCache &cache = m_rigidBodyTransformCache;
+    cache.m_physicsEngine = m_project->physicsEngine();
+    cache.fetch(rigidBodies, numRigidBodies, false);
     for (nanoem_rsize_t i = 0; i < numRigidBodies; i++) {
         const nanoem_model_rigid_body_t *rigidBodyPtr = rigidBodies[i];
         if (model::RigidBody *rigidBody = model::RigidBody::cast(rigidBodyPtr)) {
+            nanoem_f32_t worldTransform[16];
             rigidBody->applyAllForces(rigidBodyPtr);
-            rigidBody->synchronizeTransformFeedbackToSimulation(rigidBodyPtr);
+            if (rigidBody->synchronizeTransformFeedbackToSimulation(
+                    rigidBodyPtr, &cache.m_initialTransforms[i * 16], worldTransform)) {
+                cache.m_updatedMotionStates.push_back(cache.m_motionStates[i]);
+                cache.m_updatedWorldTransforms.insert(
+                    cache.m_updatedWorldTransforms.end(), worldTransform, worldTransform + 16);
+            }
         }
     }
+    cache.flush();
 }
 
 void
@@ -1777,6 +2078,7 @@ Model::rebuildIndexBuffer()
     sg::destroy_buffer(m_indexBuffer);
     m_indexBuffer = { SG_INVALID_ID };
     initializeStagingIndexBuffer();
+    markAllSpatialIndicesDirty();
 }
 
 void
@@ -1786,11 +2088,13 @@ Model::clearAllDrawVertexBuffers()
     m_drawAllVertexNormals.destroy();
     m_drawAllVertexPoints.destroy();
     m_drawAllVertexWeights.destroy();
+    markAllSpatialIndicesDirty();
 }
 
 void
 Model::performAllBonesTransform()
 {
+    EMAPP_PROFILE_SCOPE("Model::performAllBonesTransform");
     applyAllBonesTransform(PhysicsEngine::kSimulationTimingBefore);
     solveAllConstraints();
     PhysicsEngine *engine = m_project->physicsEngine();
@@ -1891,6 +2195,7 @@ Model::resetAllMorphDeformStates()
 void
 Model::deformAllMorphs(bool checkDirty)
 {
+    EMAPP_PROFILE_SCOPE("Model::deformAllMorphs");
     nanoem_rsize_t numObjects;
     nanoem_model_morph_t *const *morphs = nanoemModelGetAllMorphObjects(data(), &numObjects);
     for (nanoem_rsize_t i = 0; i < numObjects; i++) {
@@ -1913,15 +2218,20 @@ void
 Model::markStagingVertexBufferDirty()
 {
     EnumUtils::setEnabled(kPrivateStateDirtyStagingBuffer, m_states, true);
+    /* staging buffer is marked dirty whenever bones are transformed */
+    m_boneTransformGeneration++;
 }
 
 void
 Model::updateStagingVertexBuffer()
 {
+    EMAPP_PROFILE_SCOPE("Model::updateStagingVertexBuffer");
     if (EnumUtils::isEnabled(kPrivateStateDirtyStagingBuffer, m_states)) {
+        updateAllMaterialBounds();
         sg_buffer stagingVertexBuffer = m_vertexBuffers[m_stageVertexBufferIndex];
         if (sg::is_valid(stagingVertexBuffer)) {
             SG_PUSH_GROUPF("Model::updateStagingVertexBuffer(name=%s)", canonicalNameConstString());
+            m_skinnedVertexGeneration++;
             if (m_skinDeformer) {
                 m_skinDeformer->execute(m_stageVertexBufferIndex);
             }
@@ -1941,6 +2251,88 @@ Model::updateStagingVertexBuffer()
     }
 }
 
+void
+Model::markAllSpatialIndicesDirty()
+{
+    EnumUtils::setEnabled(kPrivateStateDirtyVertexSpatialIndex | kPrivateStateDirtyFaceSpatialIndex |
+            kPrivateStateDirtyMaterialBounds,
+        m_states, true);
+    m_boneTransformGeneration++;
+}
+
+void
+Model::markVertexOverlayDirty(const nanoem_model_vertex_t *vertexPtr)
+{
+    const int index = model::Vertex::index(vertexPtr);
+    if (index >= 0) {
+        m_drawAllVertexNormals.m_dirtyVertices.add(index);
+        m_drawAllVertexPoints.m_dirtyVertices.add(index);
+        m_drawAllVertexWeights.m_dirtyVertices.add(index);
+    }
+}
+
+void
+Model::collectAllVerticesInViewport(const Vector4SI32 &deviceScaleRect, VertexIndexList &vertexIndices)
+{
+    if (!m_vertexBoundingVolumes) {
+        m_vertexBoundingVolumes = nanoem_new(internal::BoundingVolumeHierarchy);
+        EnumUtils::setEnabled(kPrivateStateDirtyVertexSpatialIndex, m_states, true);
+    }
+    /* the tree is built from skinned vertices and refitted after they are deformed */
+    const SkinnedVertexCache &cache = skinnedVertexCache();
+    if (EnumUtils::isEnabled(kPrivateStateDirtyVertexSpatialIndex, m_states) ||
+        m_vertexBoundingVolumesGeneration != cache.m_generation) {
+        m_vertexBoundingVolumes->refit(cache.m_positions);
+        m_vertexBoundingVolumesGeneration = cache.m_generation;
+        EnumUtils::setEnabled(kPrivateStateDirtyVertexSpatialIndex, m_states, false);
+    }
+    const ViewportRectCuller culler(m_project->activeCamera(), deviceScaleRect);
+    vertexIndices.clear();
+    m_vertexBoundingVolumes->query(&culler, vertexIndices);
+    if (!vertexIndices.empty()) {
+        qsort(vertexIndices.data(), vertexIndices.size(), sizeof(vertexIndices[0]), compareIndex);
+    }
+}
+
+void
+Model::collectAllFacesInViewport(const Vector4SI32 &deviceScaleRect, VertexIndexList &faceIndices)
+{
+    nanoem_rsize_t numVertexIndices;
+    const nanoem_u32_t *vertexIndices = nanoemModelGetAllVertexIndices(m_opaque, &numVertexIndices);
+    if (!m_faceBoundingVolumes) {
+        m_faceBoundingVolumes = nanoem_new(internal::BoundingVolumeHierarchy);
+        EnumUtils::setEnabled(kPrivateStateDirtyFaceSpatialIndex, m_states, true);
+    }
+    const SkinnedVertexCache &cache = skinnedVertexCache();
+    if (EnumUtils::isEnabled(kPrivateStateDirtyFaceSpatialIndex, m_states) ||
+        m_faceBoundingVolumesGeneration != cache.m_generation) {
+        const nanoem_rsize_t numFaces = numVertexIndices / 3;
+        internal::BoundingVolumeHierarchy::PointList points;
+        points.resize(numFaces);
+        for (nanoem_rsize_t i = 0; i < numFaces; i++) {
+            const nanoem_u32_t *face = &vertexIndices[i * 3];
+            const Vector3 &o0 = cache.m_positions[face[0]], &o1 = cache.m_positions[face[1]],
+                          &o2 = cache.m_positions[face[2]];
+            points[i] = o0 + (o1 - o0) * 0.5f + (o2 - o0) * 0.5f;
+        }
+        m_faceBoundingVolumes->refit(points);
+        m_faceBoundingVolumesGeneration = cache.m_generation;
+        EnumUtils::setEnabled(kPrivateStateDirtyFaceSpatialIndex, m_states, false);
+    }
+    const ViewportRectCuller culler(m_project->activeCamera(), deviceScaleRect);
+    faceIndices.clear();
+    m_faceBoundingVolumes->query(&culler, faceIndices);
+    if (!faceIndices.empty()) {
+        qsort(faceIndices.data(), faceIndices.size(), sizeof(faceIndices[0]), compareIndex);
+    }
+}
+
+const Vector3 &
+Model::skinnedVertexPosition(nanoem_rsize_t index)
+{
+    return skinnedVertexCache().m_positions[index];
+}
+
 void
 Model::registerUpdateActiveBoneTransformCommand(const Vector3 &translation, const Quaternion &orientation)
 {
@@ -2128,6 +2520,7 @@ Model::addBoneReference(nanoem_model_bone_t *value)
         if (m_skinDeformer) {
             m_skinDeformer->rebuildAllBones();
         }
+        m_project->invalidateAllObjectBindings();
         m_project->rebuildAllTracks();
     }
 }
@@ -2145,6 +2538,7 @@ Model::addMorphReference(const nanoem_model_morph_t *value)
                 m_morphs.insert(tinystl::make_pair(objectName, value));
             }
         }
+        m_project->invalidateAllObjectBindings();
         m_project->rebuildAllTracks();
     }
 }
@@ -2190,6 +2584,7 @@ Model::removeBoneReference(const String &value)
         if (m_skinDeformer) {
             m_skinDeformer->rebuildAllBones();
         }
+        m_project->invalidateAllObjectBindings();
         m_project->rebuildAllTracks();
     }
 }
@@ -2209,6 +2604,7 @@ Model::removeMorphReference(const String &value)
     MorphHashMap::const_iterator it = m_morphs.find(value);
     if (it != m_morphs.end()) {
         m_morphs.erase(it);
+        m_project->invalidateAllObjectBindings();
         m_project->rebuildAllTracks();
     }
 }
@@ -2255,6 +2651,7 @@ Model::pushUndo(undo_command_t *command)
 void
 Model::solveAllConstraints()
 {
+    EMAPP_PROFILE_SCOPE("Model::solveAllConstraints");
     nanoem_rsize_t numConstraints;
     nanoem_unicode_string_factory_t *factory = m_project->unicodeStringFactory();
     nanoem_model_constraint_t *const *constraints = nanoemModelGetAllConstraintObjects(m_opaque, &numConstraints);
@@ -2295,6 +2692,7 @@ Model::reset()
 void
 Model::draw(DrawType type)
 {
+    EMAPP_PROFILE_SCOPE("Model::draw");
     if (isVisible()) {
         switch (type) {
         case IDrawable::kDrawTypeColor:
@@ -2394,6 +2792,7 @@ Model::setOffscreenPassiveRenderTargetEffect(const String &ownerName, IEffect *v
                     innerEffect->createAllDrawableRenderTargetColorImages(this);
                 }
             }
+            m_project->invalidateAllOffscreenRenderTargetPlans();
         }
     }
 }
@@ -2409,6 +2808,7 @@ Model::removeOffscreenPassiveRenderTargetEffect(const String &ownerName)
             m_offscreenPassiveRenderTargetEffects.find(ownerName);
         if (it != m_offscreenPassiveRenderTargetEffects.end()) {
             m_offscreenPassiveRenderTargetEffects.erase(it);
+            m_project->invalidateAllOffscreenRenderTargetPlans();
         }
     }
 }
@@ -2432,6 +2832,7 @@ Model::setOffscreenPassiveRenderTargetEffectEnabled(const String &ownerName, boo
             OffscreenPassiveRenderTargetEffect effect = { nullptr, value };
             m_offscreenPassiveRenderTargetEffects.insert(tinystl::make_pair(ownerName, effect));
         }
+        m_project->invalidateAllOffscreenRenderTargetPlans();
     }
 }
 
@@ -2851,6 +3252,13 @@ Model::compareBoneVertexList(const void *a, const void *b)
     return Inline::saturateInt32(right->second.size()) - Inline::saturateInt32(left->second.size());
 }
 
+int
+Model::compareIndex(const void *a, const void *b)
+{
+    const nanoem_u32_t left = *static_cast<const nanoem_u32_t *>(a), right = *static_cast<const nanoem_u32_t *>(b);
+    return left < right ? -1 : left > right ? 1 : 0;
+}
+
 void
 Model::handlePerformSkinningVertexTransform(void *opaque, size_t index)
 {
@@ -2864,6 +3272,9 @@ Model::handlePerformSkinningVertexTransform(void *opaque, size_t index)
     case IDrawable::kDrawTypeShadowMap:
     case IDrawable::kDrawTypeScriptExternalColor:
         p.performSkinning(s->m_edgeSizeScaleFactor, vertex);
+        if (s->m_skinnedVertexCache) {
+            s->m_skinnedVertexCache->store(index, p.m_position, p.m_normal);
+        }
         vertex->reset();
         break;
     default:
@@ -3157,6 +3568,7 @@ Model::bindConstraint(nanoem_model_constraint_t *constraintPtr)
     constriant->bind(constraintPtr);
     constriant->resetLanguage(constraintPtr, m_project->unicodeStringFactory(), m_project->castLanguage());
     constriant->initialize(constraintPtr);
+    constriant->setIterationTraceEnabled(isConstraintIterationTraceEnabled());
     nanoem_rsize_t numJoints;
     nanoem_model_constraint_joint_t *const *joints = nanoemModelConstraintGetAllJointObjects(constraintPtr, &numJoints);
     const nanoem_model_constraint_t *constraintConstPtr = constraintPtr;
@@ -3236,6 +3648,9 @@ Model::internalClear()
     m_drawAllVertexWeights.destroy();
     m_drawAllVertexNormals.destroy();
     m_drawAllVertexPoints.destroy();
+    nanoem_delete_safe(m_vertexBoundingVolumes);
+    nanoem_delete_safe(m_faceBoundingVolumes);
+    nanoem_delete_safe(m_boneBoundingVolumes);
     for (RigidBodyBuffers::iterator it = m_drawRigidBody.begin(), end = m_drawRigidBody.end(); it != end; ++it) {
         it->second.destroy();
     }
@@ -3406,6 +3821,7 @@ Model::internalUpdateStagingVertexBuffer(nanoem_u8_t *ptr, nanoem_rsize_t numVer
         ParallelSkinningTaskData s(this, m_project->drawType(), edgeSize());
         if (nanoem_likely(s.m_numVertices > 0)) {
             s.m_output = ptr;
+            s.m_skinnedVertexCache = prepareSkinnedVertexCache(numVertices);
             dispatchParallelTasks(&Model::handlePerformSkinningVertexTransform, &s, numVertices);
         }
         for (nanoem_rsize_t i = 0; i < numSoftBodies; i++) {
@@ -3419,6 +3835,7 @@ Model::internalUpdateStagingVertexBuffer(nanoem_u8_t *ptr, nanoem_rsize_t numVer
         ParallelSkinningTaskData s(this, m_project->drawType(), edgeSize());
         if (nanoem_likely(s.m_numVertices > 0)) {
             s.m_output = ptr;
+            s.m_skinnedVertexCache = prepareSkinnedVertexCache(numVertices);
             dispatchParallelTasks(&Model::handlePerformSkinningVertexTransform, &s, numVertices);
         }
     }
@@ -3697,13 +4114,16 @@ Model::solveConstraint(
     model::Constraint *constraint = model::Constraint::cast(constraintPtr);
     const Vector4 effectorBonePosition(effectorBone->worldTransformOrigin(), 1),
         targetBonePosition(targetBone->worldTransformOrigin(), 1);
+    const bool traceEnabled = constraint->isIterationTraceEnabled();
     for (int i = 0; i < numIterations; i++) {
         const bool firstIteration = i == 0;
+        bool rotated = false;
         for (nanoem_rsize_t j = 0; j < numJoints; j++) {
             const nanoem_model_constraint_joint_t *joint = joints[j];
             const nanoem_model_bone_t *jointBonePtr = nanoemModelConstraintJointGetBoneObject(joint);
             model::Bone *jointBone = model::Bone::cast(jointBonePtr);
-            model::Constraint::Joint *jointResult = constraint->jointIterationResult(joint, i);
+            model::Constraint::Joint *jointResult =
+                traceEnabled ? constraint->jointIterationResult(joint, i) : constraint->scratchJoint();
             if (!model::Constraint::solveAxisAngle(
                     jointBone->worldTransform(), effectorBonePosition, targetBonePosition, jointResult)) {
                 nanoem_f32_t newAngleLimit = angleLimit * (j + 1);
@@ -3733,12 +4153,19 @@ Model::solveConstraint(
                     upperJointBone->updateLocalTransform(upperJointBonePtr, upperJointBone->localTranslation(),
                         upperJointBone->constraintJointOrientation());
                 }
-                jointResult->setTransform(jointBone->worldTransform());
                 effectorBone->updateLocalTransform(effectorBonePtr);
-                model::Constraint::Joint *effectorResult = constraint->effectorIterationResult(joint, i);
-                effectorResult->setTransform(effectorBone->worldTransform());
+                if (traceEnabled) {
+                    jointResult->setTransform(jointBone->worldTransform());
+                    model::Constraint::Joint *effectorResult = constraint->effectorIterationResult(joint, i);
+                    effectorResult->setTransform(effectorBone->worldTransform());
+                }
+                rotated = true;
             }
         }
+        /* effector position is fixed at the beginning so only stop when no joint was rotated */
+        if (!rotated && !traceEnabled) {
+            break;
+        }
     }
 }
 
@@ -3998,6 +4425,162 @@ Model::getEdgeIndexBuffer(const model::Material *material, IPass::Buffer &buffer
     return renderable;
 }
 
+void
+Model::rebuildAllMaterialBounds()
+{
+    static const nanoem_u32_t kUnusedVertex = ~nanoem_u32_t(0), kSharedVertex = kUnusedVertex - 1;
+    nanoem_rsize_t numMaterials, numVertices, numVertexIndices, numMorphs, numSoftBodies, indexOffset = 0;
+    nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(m_opaque, &numMaterials);
+    nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(m_opaque, &numVertices);
+    const nanoem_u32_t *indices = nanoemModelGetAllVertexIndices(m_opaque, &numVertexIndices);
+    tinystl::unordered_set<const nanoem_model_bone_t *, TinySTLAllocator> boneSet;
+    tinystl::vector<nanoem_u32_t, TinySTLAllocator> vertexMaterials(numVertices, kUnusedVertex);
+    m_materialBounds.clear();
+    m_materialBounds.resize(numMaterials);
+    for (nanoem_rsize_t i = 0; i < numMaterials; i++) {
+        const nanoem_rsize_t numIndices = nanoemModelMaterialGetNumVertexIndices(materials[i]),
+                             offsetTo = glm::min(indexOffset + numIndices, numVertexIndices);
+        MaterialBound &bound = m_materialBounds[i];
+        bound.m_cullable = numIndices > 0;
+        boneSet.clear();
+        for (nanoem_rsize_t j = indexOffset; bound.m_cullable && j < offsetTo; j++) {
+            const nanoem_u32_t vertexIndex = indices[j];
+            if (vertexIndex < numVertices) {
+                const nanoem_model_vertex_t *vertexPtr = vertices[vertexIndex];
+                const Vector3 origin(glm::make_vec3(nanoemModelVertexGetOrigin(vertexPtr)));
+                nanoem_f32_t radius = -1;
+                /* zero weighted bones are also included so it doesn't depend on how weights are normalized */
+                for (nanoem_rsize_t k = 0; k < 4; k++) {
+                    if (const nanoem_model_bone_t *bonePtr = nanoemModelVertexGetBoneObject(vertexPtr, k)) {
+                        const Vector3 boneOrigin(glm::make_vec3(nanoemModelBoneGetOrigin(bonePtr)));
+                        radius = glm::max(radius, glm::distance(origin, boneOrigin));
+                        boneSet.insert(bonePtr);
+                    }
+                }
+                nanoem_u32_t &materialIndex = vertexMaterials[vertexIndex];
+                materialIndex = materialIndex == kUnusedVertex || materialIndex == nanoem_u32_t(i)
+                    ? nanoem_u32_t(i)
+                    : kSharedVertex;
+                bound.m_cullable = radius >= 0;
+                bound.m_radius = glm::max(bound.m_radius, radius);
+                bound.m_maxEdgeSize = glm::max(bound.m_maxEdgeSize, nanoemModelVertexGetEdgeSize(vertexPtr));
+            }
+            else {
+                bound.m_cullable = false;
+            }
+        }
+        if (bound.m_cullable) {
+            bound.m_bones.reserve(boneSet.size());
+            for (tinystl::unordered_set<const nanoem_model_bone_t *, TinySTLAllocator>::const_iterator
+                     it = boneSet.begin(),
+                     end = boneSet.end();
+                 it != end; ++it) {
+                bound.m_bones.push_back(*it);
+            }
+        }
+        indexOffset += numIndices;
+    }
+    /* offsets are kept per morph and scaled by its current weight since weights are not clamped */
+    tinystl::vector<nanoem_f32_t, TinySTLAllocator> morphOffsetLengths(numMaterials);
+    nanoem_model_morph_t *const *morphs = nanoemModelGetAllMorphObjects(m_opaque, &numMorphs);
+    for (nanoem_rsize_t i = 0; i < numMorphs; i++) {
+        const nanoem_model_morph_t *morphPtr = morphs[i];
+        if (nanoemModelMorphGetType(morphPtr) == NANOEM_MODEL_MORPH_TYPE_VERTEX) {
+            nanoem_rsize_t numItems;
+            nanoem_model_morph_vertex_t *const *items = nanoemModelMorphGetAllVertexMorphObjects(morphPtr, &numItems);
+            nanoem_f32_t sharedOffsetLength = 0;
+            morphOffsetLengths.assign(numMaterials, 0.0f);
+            for (nanoem_rsize_t j = 0; j < numItems; j++) {
+                const nanoem_model_morph_vertex_t *item = items[j];
+                const int vertexIndex = model::Vertex::index(nanoemModelMorphVertexGetVertexObject(item));
+                if (vertexIndex >= 0 && nanoem_rsize_t(vertexIndex) < numVertices) {
+                    const nanoem_u32_t materialIndex = vertexMaterials[vertexIndex];
+                    const nanoem_f32_t length = glm::length(glm::make_vec3(nanoemModelMorphVertexGetPosition(item)));
+                    if (materialIndex < numMaterials) {
+                        morphOffsetLengths[materialIndex] = glm::max(morphOffsetLengths[materialIndex], length);
+                    }
+                    else if (materialIndex == kSharedVertex) {
+                        /* a vertex shared by materials is rare so it is applied to all materials conservatively */
+                        sharedOffsetLength = glm::max(sharedOffsetLength, length);
+                    }
+                }
+            }
+            for (nanoem_rsize_t j = 0; j < numMaterials; j++) {
+                const nanoem_f32_t length = glm::max(morphOffsetLengths[j], sharedOffsetLength);
+                if (length > 0) {
+                    const MaterialBound::MorphOffset offset = { morphPtr, length };
+                    m_materialBounds[j].m_morphOffsets.push_back(offset);
+                }
+            }
+        }
+    }
+    /* soft bodies move vertices regardless of bones */
+    nanoem_model_soft_body_t *const *softBodies = nanoemModelGetAllSoftBodyObjects(m_opaque, &numSoftBodies);
+    for (nanoem_rsize_t i = 0; i < numSoftBodies; i++) {
+        const int materialIndex = model::Material::index(nanoemModelSoftBodyGetMaterialObject(softBodies[i]));
+        if (materialIndex >= 0 && nanoem_rsize_t(materialIndex) < numMaterials) {
+            m_materialBounds[materialIndex].m_cullable = false;
+        }
+    }
+}
+
+void
+Model::updateAllMaterialBounds()
+{
+    nanoem_rsize_t numMaterials;
+    nanoemModelGetAllMaterialObjects(m_opaque, &numMaterials);
+    if (EnumUtils::isEnabled(kPrivateStateDirtyMaterialBounds, m_states) || m_materialBounds.size() != numMaterials) {
+        rebuildAllMaterialBounds();
+        EnumUtils::setEnabled(kPrivateStateDirtyMaterialBounds, m_states, false);
+    }
+    for (MaterialBoundList::iterator it = m_materialBounds.begin(), end = m_materialBounds.end(); it != end; ++it) {
+        MaterialBound &bound = *it;
+        if (bound.m_cullable) {
+            BoundingBox &box = bound.m_boundingBox;
+            box.reset();
+            for (MaterialBound::BoneList::const_iterator it2 = bound.m_bones.begin(), end2 = bound.m_bones.end();
+                 it2 != end2; ++it2) {
+                if (const model::Bone *bone = model::Bone::cast(*it2)) {
+                    box.set(bone->worldTransformOrigin());
+                }
+            }
+            nanoem_f32_t radius = bound.m_radius;
+            for (MaterialBound::MorphOffsetList::const_iterator it2 = bound.m_morphOffsets.begin(),
+                                                                end2 = bound.m_morphOffsets.end();
+                 it2 != end2; ++it2) {
+                if (const model::Morph *morph = model::Morph::cast(it2->m_morph)) {
+                    radius += glm::abs(morph->weight()) * it2->m_length;
+                }
+            }
+            /* bones are rigidly transformed so each vertex stays within the radius of its bones */
+            box.m_min -= Vector3(radius);
+            box.m_max += Vector3(radius);
+        }
+    }
+}
+
+bool
+Model::cullMaterial(nanoem_rsize_t index, model::Material *material, DrawType type, nanoem_f32_t margin)
+{
+    internal::FrustumCuller *culler = m_project->frustumCuller();
+    const IEffect *bundle = m_project->sharedResourceRepository()->modelProgramBundle();
+    bool culled = false;
+    /* effects other than the built-in one may transform vertices arbitrarily */
+    if (internalEffect(material) == bundle && index < m_materialBounds.size() && m_materialBounds[index].m_cullable &&
+        (type == kDrawTypeColor || type == kDrawTypeEdge || type == kDrawTypeShadowMap)) {
+        BoundingBox box(m_materialBounds[index].m_boundingBox);
+        box.m_min -= Vector3(margin);
+        box.m_max += Vector3(margin);
+        culled = !culler->test(type == kDrawTypeShadowMap ? internal::FrustumCuller::kFrustumTypeShadowMap
+                                                          : internal::FrustumCuller::kFrustumTypeCamera,
+            box);
+    }
+    else {
+        culler->submit();
+    }
+    return culled;
+}
+
 Vector4
 Model::connectionBoneColor(
     const nanoem_model_bone_t *bonePtr, const Vector4 &base, bool enableFixedAxis) const NANOEM_DECL_NOEXCEPT
@@ -4056,7 +4639,8 @@ Model::drawColor(bool scriptExternalColor)
         numIndices = nanoemModelMaterialGetNumVertexIndices(materialPtr);
         model::Material *material = model::Material::cast(materialPtr);
         IPass::Buffer buffer(numIndices, indexOffset, true);
-        if (getVertexIndexBuffer(material, buffer)) {
+        if (getVertexIndexBuffer(material, buffer) &&
+            !cullMaterial(i, material, scriptExternalColor ? kDrawTypeScriptExternalColor : kDrawTypeColor, 0)) {
             IEffect *effect = internalEffect(material);
             if (ITechnique *technique = effect->findTechnique(passType, materialPtr, i, numMaterials, this)) {
                 SG_PUSH_GROUPF("Model::drawColor(offset=%d, name=%s)", i, material->canonicalNameConstString());
@@ -4096,7 +4680,11 @@ Model::drawEdge(nanoem_f32_t edgeSizeScaleFactor)
             !nanoemModelMaterialIsPointDrawEnabled(materialPtr)) {
             model::Material *material = model::Material::cast(materialPtr);
             IPass::Buffer buffer(numIndices, indexOffset, true);
-            if (getEdgeIndexBuffer(material, buffer)) {
+            /* edges are extruded along normals by the scaled edge size of both the material and the vertex */
+            const nanoem_f32_t margin = i < m_materialBounds.size()
+                ? edgeSizeScaleFactor * nanoemModelMaterialGetEdgeSize(materialPtr) * m_materialBounds[i].m_maxEdgeSize
+                : 0;
+            if (getEdgeIndexBuffer(material, buffer) && !cullMaterial(i, material, kDrawTypeEdge, glm::abs(margin))) {
                 IEffect *effect = internalEffect(material);
                 if (ITechnique *technique =
                         effect->findTechnique(Effect::kPassTypeEdge, materialPtr, i, numMaterials, this)) {
@@ -4182,7 +4770,7 @@ Model::drawShadowMap()
             !nanoemModelMaterialIsPointDrawEnabled(materialPtr)) {
             model::Material *material = model::Material::cast(materialPtr);
             IPass::Buffer buffer(numIndices, indexOffset, true);
-            if (getVertexIndexBuffer(material, buffer)) {
+            if (getVertexIndexBuffer(material, buffer) && !cullMaterial(i, material, kDrawTypeShadowMap, 0)) {
                 IEffect *effect = internalEffect(material);
                 if (ITechnique *technique =
                         effect->findTechnique(Effect::kPassTypeZplot, materialPtr, i, numMaterials, this)) {
@@ -4249,79 +4837,149 @@ Model::drawAllMaterialOverlays()
     SG_POP_GROUP();
 }
 
+Model::SkinnedVertexCache *
+Model::prepareSkinnedVertexCache(nanoem_rsize_t numVertices)
+{
+    SkinnedVertexCache *cache = nullptr;
+    /* skinned vertices are captured only while overlays read them to keep playback free from extra writes */
+    if (isShowAnyVertexOverlays()) {
+        m_skinnedVertexCache.resize(numVertices);
+        m_skinnedVertexCache.m_generation = m_skinnedVertexGeneration;
+        cache = &m_skinnedVertexCache;
+    }
+    return cache;
+}
+
+const Model::SkinnedVertexCache &
+Model::skinnedVertexCache()
+{
+    if (m_skinnedVertexCache.m_generation != m_skinnedVertexGeneration) {
+        /* staging buffer is not skinned on CPU (e.g. skin deformer) or overlays have been just enabled */
+        nanoem_rsize_t numVertices;
+        nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(m_opaque, &numVertices);
+        bx::simd128_t position = bx::simd_zero(), normal = bx::simd_zero();
+        m_skinnedVertexCache.resize(numVertices);
+        for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+            const nanoem_model_vertex_t *vertexPtr = vertices[i];
+            if (const model::Vertex *vertex = model::Vertex::cast(vertexPtr)) {
+                if (const model::SoftBody *softBody = model::SoftBody::cast(vertex->softBody())) {
+                    softBody->getVertexPosition(vertexPtr, &position);
+                    normal = vertex->m_simd.m_normal;
+                }
+                else {
+                    Model::VertexUnit::performSkinningByType(vertex, &position, &normal);
+                }
+                m_skinnedVertexCache.store(i, position, normal);
+            }
+        }
+        m_skinnedVertexCache.m_generation = m_skinnedVertexGeneration;
+    }
+    return m_skinnedVertexCache;
+}
+
 void
-Model::drawAllVertexNormals()
+Model::collectAllBonesInWindow(const Vector2 &deviceScaleCursor, VertexIndexList &boneIndices) const
+{
+    nanoem_rsize_t numBones;
+    nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(m_opaque, &numBones);
+    if (!m_boneBoundingVolumes) {
+        m_boneBoundingVolumes = nanoem_new(internal::BoundingVolumeHierarchy);
+        m_boneBoundingVolumesGeneration = m_boneTransformGeneration - 1;
+    }
+    if (m_boneBoundingVolumesGeneration != m_boneTransformGeneration) {
+        internal::BoundingVolumeHierarchy::PointList points;
+        points.resize(numBones);
+        for (nanoem_rsize_t i = 0; i < numBones; i++) {
+            const model::Bone *bone = model::Bone::cast(bones[i]);
+            points[i] = bone ? Vector3(worldTransform(bone->worldTransform())[3]) : Constants::kZeroV3;
+        }
+        m_boneBoundingVolumes->refit(points);
+        m_boneBoundingVolumesGeneration = m_boneTransformGeneration;
+    }
+    /* bone points are tested in the window so the cursor is moved to the viewport space to query */
+    const Vector2SI32 layoutRect(m_project->deviceScaleUniformedViewportLayoutRect());
+    const int radius = int(glm::ceil(m_project->deviceScaleCircleRadius()));
+    const Vector2SI32 cursor(Vector2SI32(deviceScaleCursor) - layoutRect);
+    const ViewportRectCuller culler(m_project->activeCamera(), Vector4SI32(cursor - radius, radius * 2, radius * 2));
+    boneIndices.clear();
+    m_boneBoundingVolumes->query(&culler, boneIndices);
+    if (!boneIndices.empty()) {
+        /* keeps the order of candidates same as the bone objects to cycle them */
+        qsort(boneIndices.data(), boneIndices.size(), sizeof(boneIndices[0]), compareIndex);
+    }
+}
+
+bool
+Model::isShowAnyVertexOverlays() const NANOEM_DECL_NOEXCEPT
+{
+    return EnumUtils::isEnabled(kPrivateStateShowAllVertexNormals | kPrivateStateShowAllVertexPoints |
+            kPrivateStateShowAllVertexFaces | kPrivateStateShowAllVertexWeights,
+        m_states);
+}
+
+nanoem_rsize_t
+Model::packAllVertexUnits(nanoem_rsize_t numVertexUnitsPerVertex, DrawArrayBuffer &buffer, bool &updateAll) const
 {
     nanoem_rsize_t numVertices;
     nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(m_opaque, &numVertices);
-    model::Vertex::List newVertices;
-    numVertices *= 2;
-    if (!m_activeMaterialPtr) {
-        newVertices.resize(numVertices);
-        for (nanoem_rsize_t i = 0; i < numVertices; i++) {
-            newVertices[i] = vertices[i / 2];
+    nanoem_u32_t *offsets = buffer.m_vertexUnitOffsets.data();
+    nanoem_rsize_t numVertexUnits = 0;
+    for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+        const model::Vertex *vertex = model::Vertex::cast(vertices[i]);
+        nanoem_u32_t offset = kInvalidVertexUnitOffset;
+        if (vertex && (!m_activeMaterialPtr || isMaterialSelected(vertex->material()))) {
+            offset = Inline::saturateInt32U(numVertexUnits);
+            numVertexUnits += numVertexUnitsPerVertex;
+        }
+        /* vertices after the changed one are shifted so all of them must be rewritten */
+        if (offsets[i] != offset) {
+            offsets[i] = offset;
+            updateAll = true;
         }
     }
-    else {
-        newVertices.reserve(numVertices);
+    return numVertexUnits;
+}
+
+void
+Model::drawAllVertexNormals()
+{
+    nanoem_rsize_t numVertices;
+    nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(m_opaque, &numVertices);
+    DrawArrayBuffer &buffer = m_drawAllVertexNormals;
+    buffer.ensureInitialized(canonicalNameConstString(), "Normals", numVertices, numVertices * 2);
+    const SkinnedVertexCache &cache = skinnedVertexCache();
+    bool updateAll = buffer.m_dirtyVertices.m_all || buffer.m_skinnedVertexGeneration != cache.m_generation;
+    const nanoem_rsize_t numVertexUnits = packAllVertexUnits(2, buffer, updateAll);
+    const nanoem_u32_t *offsets = buffer.m_vertexUnitOffsets.data();
+    sg::LineVertexUnit *vertexUnits = buffer.m_vertices.data();
+    if (updateAll) {
         for (nanoem_rsize_t i = 0; i < numVertices; i++) {
-            const nanoem_model_vertex_t *vertexPtr = vertices[i];
-            const model::Vertex *vertex = model::Vertex::cast(vertexPtr);
-            if (vertex && isMaterialSelected(vertex->material())) {
-                newVertices.push_back(vertexPtr);
+            const nanoem_u32_t offset = offsets[i];
+            if (offset != kInvalidVertexUnitOffset) {
+                const Vector3 &position = cache.m_positions[i];
+                vertexUnits[offset].m_position = position;
+                vertexUnits[offset + 1].m_position = position + cache.m_normals[i] * kDrawVertexNormalScaleFactor;
             }
         }
     }
-    const size_t numNewVertices = newVertices.size();
-    if (!sg::is_valid(m_drawAllVertexNormals.m_buffer)) {
-        sg_buffer_desc bd;
-        Inline::clearZeroMemory(bd);
-        bd.size = sizeof(m_drawAllVertexNormals.m_vertices[0]) * glm::max(numNewVertices, size_t(1));
-        bd.usage = SG_USAGE_DYNAMIC;
-        char label[Inline::kMarkerStringLength];
-        if (Inline::isDebugLabelEnabled()) {
-            StringUtils::format(label, sizeof(label), "Models/%s/Normals/VertexBuffer", canonicalNameConstString());
-            bd.label = label;
-        }
-        m_drawAllVertexNormals.m_buffer = sg::make_buffer(&bd);
-        m_drawAllVertexNormals.m_vertices.resize(numNewVertices);
-        nanoem_assert(sg::query_buffer_state(m_drawAllVertexNormals.m_buffer) == SG_RESOURCESTATE_VALID,
-            "vertex buffer must be valid");
-        SG_LABEL_BUFFER(m_drawAllVertexNormals.m_buffer, bd.label);
-    }
-    bx::simd128_t normal = bx::simd_zero();
-    sg::LineVertexUnit *vertexUnits = m_drawAllVertexNormals.m_vertices.data();
-    for (size_t i = 0; i < numNewVertices; i += 2) {
-        const nanoem_model_vertex_t *vertexPtr = newVertices[i];
-        const int index = model::Vertex::index(vertexPtr) * 2;
-        if (const model::Vertex *vertex = model::Vertex::cast(vertexPtr)) {
-            sg::LineVertexUnit &vertexUnit = vertexUnits[index];
-            bx::simd128_t *ptr = reinterpret_cast<bx::simd128_t *>(glm::value_ptr(vertexUnit.m_position));
-            if (const model::SoftBody *softBody = model::SoftBody::cast(vertex->softBody())) {
-                bx::simd128_t position;
-                softBody->getVertexPosition(vertexPtr, &position);
-                vertexUnit.m_position = glm::make_vec3(reinterpret_cast<const nanoem_f32_t *>(&position));
-            }
-            else {
-                Model::VertexUnit::performSkinningByType(vertex, ptr, &normal);
-            }
-            const nanoem_u8_t opacity = vertex->isEditingMasked() ? 1 : 0xff;
-            vertexUnit.m_color = m_selection->containsVertex(vertexPtr) ? Vector4U8(0xff, 0, 0, opacity)
-                                                                        : Vector4U8(0x7f, 0x7f, 0x7f, opacity);
-            sg::LineVertexUnit &vertexUnit2 = vertexUnits[index + 1];
-            vertexUnit2 = vertexUnit;
-            vertexUnit2.m_position +=
-                glm::make_vec3(reinterpret_cast<const nanoem_f32_t *>(&normal)) * kDrawVertexNormalScaleFactor;
+    const VertexIndexList &dirtyVertexIndices = buffer.m_dirtyVertices.m_indices;
+    const nanoem_rsize_t numDirtyVertices = updateAll ? numVertices : dirtyVertexIndices.size();
+    for (nanoem_rsize_t i = 0; i < numDirtyVertices; i++) {
+        const nanoem_rsize_t index = updateAll ? i : dirtyVertexIndices[i];
+        const nanoem_u32_t offset = offsets[index];
+        if (offset != kInvalidVertexUnitOffset) {
+            const nanoem_model_vertex_t *vertexPtr = vertices[index];
+            const nanoem_u8_t opacity = model::Vertex::cast(vertexPtr)->isEditingMasked() ? 1 : 0xff;
+            const Vector4U8 color(m_selection->containsVertex(vertexPtr) ? Vector4U8(0xff, 0, 0, opacity)
+                                                                         : Vector4U8(0x7f, 0x7f, 0x7f, opacity));
+            vertexUnits[offset].m_color = vertexUnits[offset + 1].m_color = color;
+            buffer.markVertexUnitDirty(offset);
         }
     }
-    const int size = Inline::saturateInt32(sizeof(*vertexUnits) * numNewVertices);
-    if (size > 0) {
-        sg::update_buffer(m_drawAllVertexNormals.m_buffer, vertexUnits, size);
-    }
-    internal::LineDrawer *drawer = lineDrawer();
-    internal::LineDrawer::Option option(m_drawAllVertexNormals.m_buffer, numNewVertices);
-    option.m_primitiveType = SG_PRIMITIVETYPE_LINES;
-    drawer->drawPass(option);
+    buffer.update(numVertexUnits, updateAll);
+    buffer.m_dirtyVertices.clear();
+    buffer.m_skinnedVertexGeneration = cache.m_generation;
+    buffer.draw(lineDrawer(), numVertexUnits, SG_PRIMITIVETYPE_LINES);
 }
 
 void
@@ -4329,67 +4987,38 @@ Model::drawAllVertexPoints()
 {
     nanoem_rsize_t numVertices;
     nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(m_opaque, &numVertices);
-    model::Vertex::List newVertices;
-    if (!m_activeMaterialPtr) {
-        newVertices.resize(numVertices);
-        memcpy(newVertices.data(), vertices, sizeof(newVertices[0]) * numVertices);
-    }
-    else {
-        newVertices.reserve(numVertices);
+    DrawArrayBuffer &buffer = m_drawAllVertexPoints;
+    buffer.ensureInitialized(canonicalNameConstString(), "Points", numVertices, numVertices);
+    const SkinnedVertexCache &cache = skinnedVertexCache();
+    bool updateAll = buffer.m_dirtyVertices.m_all || buffer.m_skinnedVertexGeneration != cache.m_generation;
+    const nanoem_rsize_t numVertexUnits = packAllVertexUnits(1, buffer, updateAll);
+    const nanoem_u32_t *offsets = buffer.m_vertexUnitOffsets.data();
+    sg::LineVertexUnit *vertexUnits = buffer.m_vertices.data();
+    if (updateAll) {
         for (nanoem_rsize_t i = 0; i < numVertices; i++) {
-            const nanoem_model_vertex_t *vertexPtr = vertices[i];
-            const model::Vertex *vertex = model::Vertex::cast(vertexPtr);
-            if (vertex && isMaterialSelected(vertex->material())) {
-                newVertices.push_back(vertexPtr);
+            const nanoem_u32_t offset = offsets[i];
+            if (offset != kInvalidVertexUnitOffset) {
+                vertexUnits[offset].m_position = cache.m_positions[i];
             }
         }
     }
-    const size_t numNewVertices = newVertices.size();
-    if (!sg::is_valid(m_drawAllVertexPoints.m_buffer)) {
-        sg_buffer_desc bd;
-        Inline::clearZeroMemory(bd);
-        bd.size = sizeof(m_drawAllVertexPoints.m_vertices[0]) * glm::max(numNewVertices, size_t(1));
-        bd.usage = SG_USAGE_DYNAMIC;
-        char label[Inline::kMarkerStringLength];
-        if (Inline::isDebugLabelEnabled()) {
-            StringUtils::format(label, sizeof(label), "Models/%s/Points/VertexBuffer", canonicalNameConstString());
-            bd.label = label;
-        }
-        m_drawAllVertexPoints.m_buffer = sg::make_buffer(&bd);
-        m_drawAllVertexPoints.m_vertices.resize(numNewVertices);
-        nanoem_assert(sg::query_buffer_state(m_drawAllVertexPoints.m_buffer) == SG_RESOURCESTATE_VALID,
-            "vertex buffer must be valid");
-        SG_LABEL_BUFFER(m_drawAllVertexPoints.m_buffer, bd.label);
-    }
-    bx::simd128_t normal;
-    sg::LineVertexUnit *vertexUnits = m_drawAllVertexPoints.m_vertices.data();
-    for (size_t i = 0; i < numNewVertices; i++) {
-        const nanoem_model_vertex_t *vertexPtr = newVertices[i];
-        const int index = model::Vertex::index(vertexPtr);
-        if (const model::Vertex *vertex = model::Vertex::cast(vertexPtr)) {
-            sg::LineVertexUnit &vertexUnit = vertexUnits[index];
-            bx::simd128_t *ptr = reinterpret_cast<bx::simd128_t *>(glm::value_ptr(vertexUnit.m_position));
-            if (const model::SoftBody *softBody = model::SoftBody::cast(vertex->softBody())) {
-                bx::simd128_t position;
-                softBody->getVertexPosition(vertexPtr, &position);
-                vertexUnit.m_position = glm::make_vec3(reinterpret_cast<const nanoem_f32_t *>(&position));
-            }
-            else {
-                Model::VertexUnit::performSkinningByType(vertex, ptr, &normal);
-            }
-            const nanoem_u8_t opacity = vertex->isEditingMasked() ? 1 : 0xff;
-            vertexUnit.m_color = m_selection->containsVertex(vertexPtr) ? Vector4U8(0xff, 0, 0, opacity)
-                                                                        : Vector4U8(0, 0, 0xff, opacity);
+    const VertexIndexList &dirtyVertexIndices = buffer.m_dirtyVertices.m_indices;
+    const nanoem_rsize_t numDirtyVertices = updateAll ? numVertices : dirtyVertexIndices.size();
+    for (nanoem_rsize_t i = 0; i < numDirtyVertices; i++) {
+        const nanoem_rsize_t index = updateAll ? i : dirtyVertexIndices[i];
+        const nanoem_u32_t offset = offsets[index];
+        if (offset != kInvalidVertexUnitOffset) {
+            const nanoem_model_vertex_t *vertexPtr = vertices[index];
+            const nanoem_u8_t opacity = model::Vertex::cast(vertexPtr)->isEditingMasked() ? 1 : 0xff;
+            vertexUnits[offset].m_color = m_selection->containsVertex(vertexPtr) ? Vector4U8(0xff, 0, 0, opacity)
+                                                                                : Vector4U8(0, 0, 0xff, opacity);
+            buffer.markVertexUnitDirty(offset);
         }
     }
-    const int size = Inline::saturateInt32(sizeof(*vertexUnits) * numNewVertices);
-    if (size > 0) {
-        sg::update_buffer(m_drawAllVertexPoints.m_buffer, vertexUnits, size);
-    }
-    internal::LineDrawer *drawer = lineDrawer();
-    internal::LineDrawer::Option option(m_drawAllVertexPoints.m_buffer, numNewVertices);
-    option.m_primitiveType = SG_PRIMITIVETYPE_POINTS;
-    drawer->drawPass(option);
+    buffer.update(numVertexUnits, updateAll);
+    buffer.m_dirtyVertices.clear();
+    buffer.m_skinnedVertexGeneration = cache.m_generation;
+    buffer.draw(lineDrawer(), numVertexUnits, SG_PRIMITIVETYPE_POINTS);
 }
 
 void
@@ -4402,24 +5031,21 @@ Model::drawAllVertexFaces()
     m_drawAllVertexFaces.ensureVertexBufferInitialized(canonicalNameConstString(), numVertices);
     m_drawAllVertexFaces.ensureIndexBufferInitialized(
         canonicalNameConstString(), vertexIndices, numVertexIndices, true);
-    sg::LineVertexUnit *vertexUnits = m_drawAllVertexFaces.m_vertices.data();
-    bx::simd128_t normal;
-    for (nanoem_rsize_t i = 0; i < numVertices; i++) {
-        const nanoem_model_vertex_t *vertexPtr = vertices[i];
-        if (const model::Vertex *vertex = model::Vertex::cast(vertexPtr)) {
-            sg::LineVertexUnit &vertexUnit = vertexUnits[i];
-            bx::simd128_t *ptr = reinterpret_cast<bx::simd128_t *>(glm::value_ptr(vertexUnit.m_position));
-            if (const model::SoftBody *softBody = model::SoftBody::cast(vertex->softBody())) {
-                bx::simd128_t position;
-                softBody->getVertexPosition(vertexPtr, &position);
-                vertexUnit.m_position = glm::make_vec3(reinterpret_cast<const nanoem_f32_t *>(&position));
-            }
-            else {
-                Model::VertexUnit::performSkinningByType(vertex, ptr, &normal);
+    const SkinnedVertexCache &cache = skinnedVertexCache();
+    /* face color is given by the option so vertices are rewritten only after skinning changed */
+    const bool updatePosition = m_drawAllVertexFaces.m_dirtyVertices.m_all ||
+        m_drawAllVertexFaces.m_skinnedVertexGeneration != cache.m_generation;
+    if (updatePosition) {
+        sg::LineVertexUnit *vertexUnits = m_drawAllVertexFaces.m_vertices.data();
+        for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+            if (model::Vertex::cast(vertices[i])) {
+                vertexUnits[i].m_position = cache.m_positions[i];
+                vertexUnits[i].m_color = Vector4U8(0xff);
             }
-            vertexUnit.m_color = Vector4U8(0xff);
         }
     }
+    m_drawAllVertexFaces.m_dirtyVertices.clear();
+    m_drawAllVertexFaces.m_skinnedVertexGeneration = cache.m_generation;
     const IModelObjectSelection::FaceList faces(m_selection->allFaces());
     if (!faces.empty() && !sg::is_valid(m_drawAllVertexFaces.m_activeIndexBuffer)) {
         sg_buffer_desc desc;
@@ -4444,7 +5070,7 @@ Model::drawAllVertexFaces()
         activeIndices[offset + 4] = vertexIndex2;
         activeIndices[offset + 5] = vertexIndex0;
     }
-    m_drawAllVertexFaces.update();
+    m_drawAllVertexFaces.update(updatePosition);
     internal::LineDrawer::Option option(m_drawAllVertexFaces.m_vertexBuffer, 0);
     option.m_indexBuffer = m_drawAllVertexFaces.m_indexBuffer;
     option.m_indexType = SG_INDEXTYPE_UINT32;
@@ -4484,56 +5110,34 @@ Model::drawAllVertexWeights()
     m_drawAllVertexWeights.ensureVertexBufferInitialized(canonicalNameConstString(), numVertices);
     m_drawAllVertexWeights.ensureIndexBufferInitialized(
         canonicalNameConstString(), vertexIndices, numVertexIndices, false);
-    sg::LineVertexUnit *vertexUnits = m_drawAllVertexWeights.m_vertices.data();
-    bx::simd128_t normal;
-    for (nanoem_rsize_t i = 0; i < numVertices; i++) {
-        const nanoem_model_vertex_t *vertexPtr = vertices[i];
-        if (const model::Vertex *vertex = model::Vertex::cast(vertexPtr)) {
-            sg::LineVertexUnit &vertexUnit = vertexUnits[i];
-            bx::simd128_t *ptr = reinterpret_cast<bx::simd128_t *>(glm::value_ptr(vertexUnit.m_position));
-            if (const model::SoftBody *softBody = model::SoftBody::cast(vertex->softBody())) {
-                bx::simd128_t position;
-                softBody->getVertexPosition(vertexPtr, &position);
-                vertexUnit.m_position = glm::make_vec3(reinterpret_cast<const nanoem_f32_t *>(&position));
-            }
-            else {
-                Model::VertexUnit::performSkinningByType(vertex, ptr, &normal);
-            }
-            Vector3 color(0.25f);
-            nanoem_f32_t opacity = vertex->isEditingMasked() || enableBlending ? 0.0f : 1.0f;
-            for (nanoem_rsize_t j = 0; j < 4; j++) {
-                const model::Bone *bone = vertex->bone(j);
-                if (bone && bone == activeBoneObject) {
-                    nanoem_f32_t component = 0;
-                    switch (j) {
-                    case 0: {
-                        component = bx::simd_x(vertex->m_simd.m_weights);
-                        break;
-                    }
-                    case 1: {
-                        component = bx::simd_y(vertex->m_simd.m_weights);
-                        break;
-                    }
-                    case 2: {
-                        component = bx::simd_z(vertex->m_simd.m_weights);
-                        break;
-                    }
-                    case 3: {
-                        component = bx::simd_w(vertex->m_simd.m_weights);
-                        break;
-                    }
-                    default:
-                        break;
-                    }
-                    color = Color::jet(component);
-                    opacity = 1.0f;
-                    break;
-                }
+    const SkinnedVertexCache &cache = skinnedVertexCache();
+    DrawIndexedBuffer &buffer = m_drawAllVertexWeights;
+    const bool updatePosition = buffer.m_dirtyVertices.m_all || buffer.m_skinnedVertexGeneration != cache.m_generation;
+    /* painting rewrites weights of the vertices under the brush so all of them are recolored while painting */
+    const bool updateAll = updatePosition || m_vertexWeightPainter || buffer.m_activeBonePtr != activeBonePtr ||
+        buffer.m_blendingEnabled != enableBlending;
+    sg::LineVertexUnit *vertexUnits = buffer.m_vertices.data();
+    if (updatePosition) {
+        for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+            if (model::Vertex::cast(vertices[i])) {
+                vertexUnits[i].m_position = cache.m_positions[i];
             }
-            vertexUnit.m_color = Vector4(color, opacity) * 255.0f;
         }
     }
-    m_drawAllVertexWeights.update();
+    const VertexIndexList &dirtyVertexIndices = buffer.m_dirtyVertices.m_indices;
+    const nanoem_rsize_t numDirtyVertices = updateAll ? numVertices : dirtyVertexIndices.size();
+    for (nanoem_rsize_t i = 0; i < numDirtyVertices; i++) {
+        const nanoem_rsize_t index = updateAll ? i : dirtyVertexIndices[i];
+        if (const model::Vertex *vertex = model::Vertex::cast(vertices[index])) {
+            vertexUnits[index].m_color = vertexWeightColor(vertex, activeBoneObject, enableBlending);
+        }
+    }
+    /* indexed triangles refer to any vertex so the buffer is uploaded as a whole only when anything was recolored */
+    buffer.update(numDirtyVertices > 0);
+    buffer.m_dirtyVertices.clear();
+    buffer.m_skinnedVertexGeneration = cache.m_generation;
+    buffer.m_activeBonePtr = activeBonePtr;
+    buffer.m_blendingEnabled = enableBlending;
     internal::LineDrawer::Option option(m_drawAllVertexWeights.m_vertexBuffer, 0);
     option.m_indexBuffer = m_drawAllVertexWeights.m_indexBuffer;
     option.m_primitiveType = SG_PRIMITIVETYPE_TRIANGLES;
@@ -5223,8 +5827,10 @@ Model::intersectsBone(
     nanoem_rsize_t numBones;
     nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(m_opaque, &numBones);
     model::Bone::List candidateBones;
-    for (nanoem_rsize_t i = 0; i < numBones; i++) {
-        const nanoem_model_bone_t *bonePtr = bones[i];
+    VertexIndexList boneIndices;
+    collectAllBonesInWindow(deviceScaleCursorPosition, boneIndices);
+    for (VertexIndexList::const_iterator it = boneIndices.begin(), end = boneIndices.end(); it != end; ++it) {
+        const nanoem_model_bone_t *bonePtr = bones[*it];
         if (isBoneSelectable(bonePtr) && !isRigidBodyBound(bonePtr)) {
             const model::Bone *bone = model::Bone::cast(bonePtr);
             if (intersectsBoneInWindow(deviceScaleCursorPosition, bone, coord)) {
@@ -5253,8 +5859,10 @@ Model::intersectsBone(const Vector2 &deviceScaleCursorPosition, nanoem_rsize_t &
     nanoem_rsize_t numBones;
     nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(m_opaque, &numBones);
     tinystl::vector<nanoem_model_bone_t *, TinySTLAllocator> candidateBones;
-    for (nanoem_rsize_t i = 0; i < numBones; i++) {
-        nanoem_model_bone_t *bonePtr = bones[i];
+    VertexIndexList boneIndices;
+    collectAllBonesInWindow(deviceScaleCursorPosition, boneIndices);
+    for (VertexIndexList::const_iterator it = boneIndices.begin(), end = boneIndices.end(); it != end; ++it) {
+        nanoem_model_bone_t *bonePtr = bones[*it];
         if (isBoneSelectable(bonePtr) && !isRigidBodyBound(bonePtr)) {
             const model::Bone *bone = model::Bone::cast(bonePtr);
             if (intersectsBoneInWindow(deviceScaleCursorPosition, bone, coord)) {
@@ -5427,6 +6035,21 @@ Model::boundingBox() const NANOEM_DECL_NOEXCEPT
     return m_boundingBox;
 }
 
+BoundingBox
+Model::materialBoundingBox(const nanoem_model_material_t *materialPtr) const NANOEM_DECL_NOEXCEPT
+{
+    const int index = model::Material::index(materialPtr);
+    return index >= 0 && nanoem_rsize_t(index) < m_materialBounds.size() ? m_materialBounds[index].m_boundingBox
+                                                                         : BoundingBox();
+}
+
+bool
+Model::isMaterialCullable(const nanoem_model_material_t *materialPtr) const NANOEM_DECL_NOEXCEPT
+{
+    const int index = model::Material::index(materialPtr);
+    return index >= 0 && nanoem_rsize_t(index) < m_materialBounds.size() && m_materialBounds[index].m_cullable;
+}
+
 String
 Model::filename() const
 {
@@ -5456,6 +6079,7 @@ void
 Model::setFileURI(const URI &value)
 {
     m_fileURI = value;
+    m_project->invalidateAllObjectBindings();
 }
 
 const IEffect *
@@ -5832,6 +6456,34 @@ Model::setBlendingVertexWeightsEnabled(bool value)
     }
 }
 
+bool
+Model::isConstraintIterationTraceEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return EnumUtils::isEnabled(kPrivateStateTraceConstraintIterations, m_states);
+}
+
+void
+Model::setConstraintIterationTraceEnabled(bool value)
+{
+    if (isConstraintIterationTraceEnabled() != value) {
+        nanoem_rsize_t numBones, numConstraints;
+        nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(m_opaque, &numBones);
+        nanoem_model_constraint_t *const *constraints = nanoemModelGetAllConstraintObjects(m_opaque, &numConstraints);
+        for (nanoem_rsize_t i = 0; i < numBones; i++) {
+            const nanoem_model_constraint_t *constraintPtr = nanoemModelBoneGetConstraintObject(bones[i]);
+            if (model::Constraint *constraint = model::Constraint::cast(constraintPtr)) {
+                constraint->setIterationTraceEnabled(value);
+            }
+        }
+        for (nanoem_rsize_t i = 0; i < numConstraints; i++) {
+            if (model::Constraint *constraint = model::Constraint::cast(constraints[i])) {
+                constraint->setIterationTraceEnabled(value);
+            }
+        }
+        EnumUtils::setEnabled(kPrivateStateTraceConstraintIterations, m_states, value);
+    }
+}
+
 bool
 Model::isGroundShadowEnabled() const NANOEM_DECL_NOEXCEPT
 {
@@ -5926,6 +6578,9 @@ void
 Model::setDirty(bool value)
 {
     EnumUtils::setEnabled(kPrivateStateDirty, m_states, value);
+    if (value) {
+        markAllSpatialIndicesDirty();
+    }
 }
 
 bool
@@ -38,20 +38,311 @@
 namespace nanoem {
 namespace {
 
+static inline const nanoem_motion_keyframe_object_t *
+keyframeObjectOf(const nanoem_motion_accessory_keyframe_t *keyframe) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionAccessoryKeyframeGetKeyframeObject(keyframe);
+}
+
+static inline const nanoem_motion_keyframe_object_t *
+keyframeObjectOf(const nanoem_motion_bone_keyframe_t *keyframe) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionBoneKeyframeGetKeyframeObject(keyframe);
+}
+
+static inline const nanoem_motion_keyframe_object_t *
+keyframeObjectOf(const nanoem_motion_camera_keyframe_t *keyframe) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionCameraKeyframeGetKeyframeObject(keyframe);
+}
+
+static inline const nanoem_motion_keyframe_object_t *
+keyframeObjectOf(const nanoem_motion_light_keyframe_t *keyframe) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionLightKeyframeGetKeyframeObject(keyframe);
+}
+
+static inline const nanoem_motion_keyframe_object_t *
+keyframeObjectOf(const nanoem_motion_model_keyframe_t *keyframe) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionModelKeyframeGetKeyframeObject(keyframe);
+}
+
+static inline const nanoem_motion_keyframe_object_t *
+keyframeObjectOf(const nanoem_motion_morph_keyframe_t *keyframe) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionMorphKeyframeGetKeyframeObject(keyframe);
+}
+
+static inline const nanoem_motion_keyframe_object_t *
+keyframeObjectOf(const nanoem_motion_self_shadow_keyframe_t *keyframe) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionSelfShadowKeyframeGetKeyframeObject(keyframe);
+}
+
+template <typename TKeyframe>
+static inline int
+trackIdOf(const TKeyframe * /* keyframe */) NANOEM_DECL_NOEXCEPT
+{
+    return 0;
+}
+
+static inline int
+trackIdOf(const nanoem_motion_bone_keyframe_t *keyframe) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionBoneKeyframeGetId(keyframe);
+}
+
+static inline int
+trackIdOf(const nanoem_motion_morph_keyframe_t *keyframe) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionMorphKeyframeGetId(keyframe);
+}
+
+static inline const nanoem_unicode_string_t *
+trackNameOf(const nanoem_motion_bone_keyframe_t *keyframe) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionBoneKeyframeGetName(keyframe);
+}
+
+static inline const nanoem_unicode_string_t *
+trackNameOf(const nanoem_motion_morph_keyframe_t *keyframe) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionMorphKeyframeGetName(keyframe);
+}
+
+static inline const nanoem_motion_accessory_keyframe_t *
+findKeyframeOf(const nanoem_motion_t *motion, const nanoem_motion_accessory_keyframe_t * /* keyframe */,
+    nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionFindAccessoryKeyframeObject(motion, frameIndex);
+}
+
+static inline const nanoem_motion_bone_keyframe_t *
+findKeyframeOf(const nanoem_motion_t *motion, const nanoem_motion_bone_keyframe_t *keyframe,
+    nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionFindBoneKeyframeObject(motion, trackNameOf(keyframe), frameIndex);
+}
+
+static inline const nanoem_motion_camera_keyframe_t *
+findKeyframeOf(const nanoem_motion_t *motion, const nanoem_motion_camera_keyframe_t * /* keyframe */,
+    nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionFindCameraKeyframeObject(motion, frameIndex);
+}
+
+static inline const nanoem_motion_light_keyframe_t *
+findKeyframeOf(const nanoem_motion_t *motion, const nanoem_motion_light_keyframe_t * /* keyframe */,
+    nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionFindLightKeyframeObject(motion, frameIndex);
+}
+
+static inline const nanoem_motion_model_keyframe_t *
+findKeyframeOf(const nanoem_motion_t *motion, const nanoem_motion_model_keyframe_t * /* keyframe */,
+    nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionFindModelKeyframeObject(motion, frameIndex);
+}
+
+static inline const nanoem_motion_morph_keyframe_t *
+findKeyframeOf(const nanoem_motion_t *motion, const nanoem_motion_morph_keyframe_t *keyframe,
+    nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionFindMorphKeyframeObject(motion, trackNameOf(keyframe), frameIndex);
+}
+
+static inline const nanoem_motion_self_shadow_keyframe_t *
+findKeyframeOf(const nanoem_motion_t *motion, const nanoem_motion_self_shadow_keyframe_t * /* keyframe */,
+    nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionFindSelfShadowKeyframeObject(motion, frameIndex);
+}
+
+struct MergingTrack {
+    typedef tinystl::vector<MergingTrack, TinySTLAllocator> List;
+    typedef tinystl::unordered_map<String, nanoem_rsize_t, TinySTLAllocator> IndexMap;
+    const nanoem_unicode_string_t *m_name;
+    String m_utf8Name;
+    nanoem_rsize_t m_begin;
+    nanoem_rsize_t m_end;
+};
+
+/* keyframe of the motion to merge that is ordered by the track and the frame index to walk both of the source and
+ * the destination keyframes of the same track at once instead of looking up the destination per keyframe */
+template <typename TKeyframe> struct MergingKeyframe {
+    typedef tinystl::vector<MergingKeyframe, TinySTLAllocator> List;
+
+    static int compare(const void *left, const void *right) NANOEM_DECL_NOEXCEPT;
+    static void sortAll(
+        TKeyframe *const *keyframes, nanoem_rsize_t numKeyframes, nanoem_frame_index_t offset, List &sorted);
+    static void splitAllTracks(
+        const List &keyframes, nanoem_unicode_string_factory_t *factory, MergingTrack::List &tracks);
+    static void zip(const nanoem_motion_t *motion, MergingKeyframe *source, const MergingKeyframe *sourceEnd,
+        const MergingKeyframe *dest, const MergingKeyframe *destEnd) NANOEM_DECL_NOEXCEPT;
+    static void zipAll(const nanoem_motion_t *motion, const List &dests, List &sources) NANOEM_DECL_NOEXCEPT;
+    static void zipAllTracks(const nanoem_motion_t *motion, const MergingTrack::List &sourceTracks,
+        const MergingTrack::List &destTracks, const List &dests, List &sources);
+    static bool isDuplicated(const List &keyframes, nanoem_rsize_t begin, nanoem_rsize_t end, nanoem_rsize_t index,
+        bool _override) NANOEM_DECL_NOEXCEPT;
+
+    TKeyframe *m_keyframe;
+    TKeyframe *m_found;
+    nanoem_frame_index_t m_frameIndex;
+    nanoem_rsize_t m_order;
+    int m_trackId;
+};
+
+template <typename TKeyframe>
+int
+MergingKeyframe<TKeyframe>::compare(const void *left, const void *right) NANOEM_DECL_NOEXCEPT
+{
+    const MergingKeyframe *lvalue = static_cast<const MergingKeyframe *>(left);
+    const MergingKeyframe *rvalue = static_cast<const MergingKeyframe *>(right);
+    if (lvalue->m_trackId != rvalue->m_trackId) {
+        return lvalue->m_trackId < rvalue->m_trackId ? -1 : 1;
+    }
+    else if (lvalue->m_frameIndex != rvalue->m_frameIndex) {
+        return lvalue->m_frameIndex < rvalue->m_frameIndex ? -1 : 1;
+    }
+    /* qsort is not stable so the source order decides keyframes at the same frame */
+    else if (lvalue->m_order != rvalue->m_order) {
+        return lvalue->m_order < rvalue->m_order ? -1 : 1;
+    }
+    return 0;
+}
+
+template <typename TKeyframe>
+void
+MergingKeyframe<TKeyframe>::sortAll(
+    TKeyframe *const *keyframes, nanoem_rsize_t numKeyframes, nanoem_frame_index_t offset, List &sorted)
+{
+    sorted.resize(numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+        TKeyframe *keyframe = keyframes[i];
+        MergingKeyframe &item = sorted[i];
+        item.m_keyframe = keyframe;
+        item.m_found = nullptr;
+        item.m_frameIndex = nanoemMotionKeyframeObjectGetFrameIndex(keyframeObjectOf(keyframe)) + offset;
+        item.m_order = i;
+        item.m_trackId = trackIdOf(keyframe);
+    }
+    if (numKeyframes > 0) {
+        qsort(sorted.data(), numKeyframes, sizeof(sorted[0]), compare);
+    }
+}
+
+template <typename TKeyframe>
+void
+MergingKeyframe<TKeyframe>::splitAllTracks(
+    const List &keyframes, nanoem_unicode_string_factory_t *factory, MergingTrack::List &tracks)
+{
+    const nanoem_rsize_t numKeyframes = keyframes.size();
+    nanoem_rsize_t begin = 0;
+    while (begin < numKeyframes) {
+        const int trackId = keyframes[begin].m_trackId;
+        nanoem_rsize_t end = begin + 1;
+        while (end < numKeyframes && keyframes[end].m_trackId == trackId) {
+            end++;
+        }
+        MergingTrack track;
+        track.m_name = trackNameOf(keyframes[begin].m_keyframe);
+        StringUtils::getUtf8String(track.m_name, factory, track.m_utf8Name);
+        track.m_begin = begin;
+        track.m_end = end;
+        tracks.push_back(track);
+        begin = end;
+    }
+}
+
+template <typename TKeyframe>
+void
+MergingKeyframe<TKeyframe>::zip(const nanoem_motion_t *motion, MergingKeyframe *source,
+    const MergingKeyframe *sourceEnd, const MergingKeyframe *dest, const MergingKeyframe *destEnd) NANOEM_DECL_NOEXCEPT
+{
+    for (; source != sourceEnd; source++) {
+        while (dest != destEnd && dest->m_frameIndex < source->m_frameIndex) {
+            dest++;
+        }
+        if (dest != destEnd && dest->m_frameIndex == source->m_frameIndex) {
+            const MergingKeyframe *next = dest + 1;
+            /* the track holds only one of the duplicated keyframes loaded at the same frame */
+            source->m_found = next != destEnd && next->m_frameIndex == dest->m_frameIndex
+                ? const_cast<TKeyframe *>(findKeyframeOf(motion, dest->m_keyframe, dest->m_frameIndex))
+                : dest->m_keyframe;
+        }
+        else {
+            source->m_found = nullptr;
+        }
+    }
+}
+
+template <typename TKeyframe>
+void
+MergingKeyframe<TKeyframe>::zipAll(const nanoem_motion_t *motion, const List &dests, List &sources) NANOEM_DECL_NOEXCEPT
+{
+    zip(motion, sources.data(), sources.data() + sources.size(), dests.data(), dests.data() + dests.size());
+}
+
+template <typename TKeyframe>
+void
+MergingKeyframe<TKeyframe>::zipAllTracks(const nanoem_motion_t *motion, const MergingTrack::List &sourceTracks,
+    const MergingTrack::List &destTracks, const List &dests, List &sources)
+{
+    MergingTrack::IndexMap destTrackIndices;
+    for (nanoem_rsize_t i = 0, numTracks = destTracks.size(); i < numTracks; i++) {
+        destTrackIndices.insert(tinystl::make_pair(destTracks[i].m_utf8Name, i));
+    }
+    for (MergingTrack::List::const_iterator it = sourceTracks.begin(), end = sourceTracks.end(); it != end; ++it) {
+        MergingTrack::IndexMap::const_iterator it2 = destTrackIndices.find(it->m_utf8Name);
+        if (it2 != destTrackIndices.end()) {
+            const MergingTrack &destTrack = destTracks[it2->second];
+            zip(motion, sources.data() + it->m_begin, sources.data() + it->m_end, dests.data() + destTrack.m_begin,
+                dests.data() + destTrack.m_end);
+        }
+    }
+}
+
+template <typename TKeyframe>
+bool
+MergingKeyframe<TKeyframe>::isDuplicated(const List &keyframes, nanoem_rsize_t begin, nanoem_rsize_t end,
+    nanoem_rsize_t index, bool _override) NANOEM_DECL_NOEXCEPT
+{
+    /* adding keyframes at the same frame in order keeps the first one and overriding them keeps the last one */
+    const nanoem_frame_index_t frameIndex = keyframes[index].m_frameIndex;
+    return _override ? index + 1 < end && keyframes[index + 1].m_frameIndex == frameIndex
+                     : index > begin && keyframes[index - 1].m_frameIndex == frameIndex;
+}
+
+typedef MergingKeyframe<nanoem_motion_accessory_keyframe_t> MergingAccessoryKeyframe;
+typedef MergingKeyframe<nanoem_motion_bone_keyframe_t> MergingBoneKeyframe;
+typedef MergingKeyframe<nanoem_motion_camera_keyframe_t> MergingCameraKeyframe;
+typedef MergingKeyframe<nanoem_motion_light_keyframe_t> MergingLightKeyframe;
+typedef MergingKeyframe<nanoem_motion_model_keyframe_t> MergingModelKeyframe;
+typedef MergingKeyframe<nanoem_motion_morph_keyframe_t> MergingMorphKeyframe;
+typedef MergingKeyframe<nanoem_motion_self_shadow_keyframe_t> MergingSelfShadowKeyframe;
+
 struct Merger {
     static void transformBoneKeyframeReversed(nanoem_mutable_motion_bone_keyframe_t *keyframe);
+    static const MergingBoneKeyframe *findFirstReversingBoneKeyframe(
+        const MergingBoneKeyframe::List &keyframes, const MergingTrack &track) NANOEM_DECL_NOEXCEPT;
+    static const MergingBoneKeyframe *findBoneKeyframe(const MergingBoneKeyframe::List &keyframes,
+        const MergingTrack &track, nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT;
 
     Merger(const nanoem_motion_t *source, nanoem_unicode_string_factory_t *factory, nanoem_motion_t *opaque,
-        bool _override);
+        nanoem_frame_index_t offset, bool _override);
     ~Merger() NANOEM_DECL_NOEXCEPT;
 
     void addAccessoryKeyframe(const nanoem_motion_accessory_keyframe_t *keyframe, nanoem_frame_index_t frameIndex);
     void mergeAllAccessoryKeyframes();
-    void reverseBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, const String &newName);
-    void reverseBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, StringSet &reversedBoneNameSet);
-    void addBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, bool reverse, StringSet &reversedBoneNameSet);
+    void reverseBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, nanoem_frame_index_t frameIndex,
+        const String &newName);
+    void reverseAllBoneKeyframes(const MergingBoneKeyframe::List &keyframes, const MergingTrack::List &tracks);
+    void addBoneKeyframe(const nanoem_motion_bone_keyframe_t *keyframe, const nanoem_unicode_string_t *name,
+        nanoem_frame_index_t frameIndex);
     void mergeAllBoneKeyframes(bool reverse);
-    void addCameraKeyframe(nanoem_motion_camera_keyframe_t *keyframe, nanoem_frame_index_t frameIndex);
+    void addCameraKeyframe(const nanoem_motion_camera_keyframe_t *keyframe, nanoem_frame_index_t frameIndex);
     void mergeAllCameraKeyframes();
     void addLightKeyframe(const nanoem_motion_light_keyframe_t *keyframe, nanoem_frame_index_t frameIndex);
     void mergeAllLightKeyframes();
@@ -62,8 +353,10 @@ struct Merger {
     void mergeAllMorphKeyframes();
     void addSelfShadowKeyframe(const nanoem_motion_self_shadow_keyframe_t *keyframe, nanoem_frame_index_t frameIndex);
     void mergeAllSelfShadowKeyframes();
+    void sortAllKeyframes();
 
     const nanoem_motion_t *m_source;
+    const nanoem_frame_index_t m_offset;
     const bool m_override;
     nanoem_unicode_string_factory_t *m_factory;
     nanoem_mutable_motion_t *m_dest;
@@ -82,9 +375,10 @@ Merger::transformBoneKeyframeReversed(nanoem_mutable_motion_bone_keyframe_t *key
         keyframe, glm::value_ptr(Quaternion(orientation[3], orientation[0], -orientation[1], -orientation[2])));
 }
 
-Merger::Merger(
-    const nanoem_motion_t *source, nanoem_unicode_string_factory_t *factory, nanoem_motion_t *opaque, bool _override)
+Merger::Merger(const nanoem_motion_t *source, nanoem_unicode_string_factory_t *factory, nanoem_motion_t *opaque,
+    nanoem_frame_index_t offset, bool _override)
     : m_source(source)
+    , m_offset(offset)
     , m_override(_override)
     , m_factory(factory)
     , m_dest(nullptr)
@@ -114,39 +408,45 @@ Merger::addAccessoryKeyframe(const nanoem_motion_accessory_keyframe_t *keyframe,
 void
 Merger::mergeAllAccessoryKeyframes()
 {
-    nanoem_rsize_t numKeyframes;
+    nanoem_rsize_t numSourceKeyframes, numDestKeyframes;
     nanoem_motion_t *destOrigin = nanoemMutableMotionGetOriginObject(m_dest);
-    nanoem_motion_accessory_keyframe_t *const *keyframes =
-        nanoemMotionGetAllAccessoryKeyframeObjects(m_source, &numKeyframes);
-    for (nanoem_frame_index_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_accessory_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionAccessoryKeyframeGetKeyframeObject(keyframe));
-        if (!m_override && !nanoemMotionFindAccessoryKeyframeObject(destOrigin, frameIndex)) {
-            addAccessoryKeyframe(keyframe, frameIndex);
-        }
-        else if (m_override) {
+    nanoem_motion_accessory_keyframe_t *const *sourceKeyframes =
+        nanoemMotionGetAllAccessoryKeyframeObjects(m_source, &numSourceKeyframes);
+    nanoem_motion_accessory_keyframe_t *const *destKeyframes =
+        nanoemMotionGetAllAccessoryKeyframeObjects(destOrigin, &numDestKeyframes);
+    MergingAccessoryKeyframe::List sources, dests;
+    MergingAccessoryKeyframe::sortAll(sourceKeyframes, numSourceKeyframes, m_offset, sources);
+    MergingAccessoryKeyframe::sortAll(destKeyframes, numDestKeyframes, 0, dests);
+    MergingAccessoryKeyframe::zipAll(destOrigin, dests, sources);
+    /* all existing keyframes are overridden before adding any keyframes to keep the destination sorted */
+    const nanoem_rsize_t numSources = sources.size();
+    for (nanoem_rsize_t i = 0; i < numSources; i++) {
+        const MergingAccessoryKeyframe &keyframe = sources[i];
+        if (m_override && keyframe.m_found &&
+            !MergingAccessoryKeyframe::isDuplicated(sources, 0, numSources, i, true)) {
             nanoem_mutable_motion_accessory_keyframe_t *newKeyframe =
-                nanoemMutableMotionAccessoryKeyframeCreateByFound(destOrigin, frameIndex, &m_status);
+                nanoemMutableMotionAccessoryKeyframeCreateAsReference(keyframe.m_found, &m_status);
             if (newKeyframe) {
-                nanoemMutableMotionAccessoryKeyframeCopy(newKeyframe, keyframe, &m_status);
+                nanoemMutableMotionAccessoryKeyframeCopy(newKeyframe, keyframe.m_keyframe, &m_status);
                 nanoemMutableMotionAccessoryKeyframeDestroy(newKeyframe);
             }
-            else {
-                addAccessoryKeyframe(keyframe, frameIndex);
-            }
+        }
+    }
+    for (nanoem_rsize_t i = 0; i < numSources; i++) {
+        const MergingAccessoryKeyframe &keyframe = sources[i];
+        if (!keyframe.m_found && !MergingAccessoryKeyframe::isDuplicated(sources, 0, numSources, i, m_override)) {
+            addAccessoryKeyframe(keyframe.m_keyframe, keyframe.m_frameIndex);
         }
     }
 }
 
 void
-Merger::reverseBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, const String &newName)
+Merger::reverseBoneKeyframe(
+    const nanoem_motion_bone_keyframe_t *origin, nanoem_frame_index_t frameIndex, const String &newName)
 {
     nanoem_motion_t *destOrigin = nanoemMutableMotionGetOriginObject(m_dest);
     StringUtils::UnicodeStringScope scope(m_factory);
     if (StringUtils::tryGetString(m_factory, newName, scope)) {
-        const nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(origin));
         nanoem_mutable_motion_bone_keyframe_t *keyframe =
             nanoemMutableMotionBoneKeyframeCreateByFound(destOrigin, scope.value(), frameIndex, &m_status);
         if (keyframe) {
@@ -163,43 +463,82 @@ Merger::reverseBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, const S
     }
 }
 
+const MergingBoneKeyframe *
+Merger::findFirstReversingBoneKeyframe(
+    const MergingBoneKeyframe::List &keyframes, const MergingTrack &track) NANOEM_DECL_NOEXCEPT
+{
+    const MergingBoneKeyframe *first = nullptr;
+    for (nanoem_rsize_t i = track.m_begin; i < track.m_end; i++) {
+        const MergingBoneKeyframe &keyframe = keyframes[i];
+        if (!first || keyframe.m_order < first->m_order) {
+            first = &keyframe;
+        }
+    }
+    return first;
+}
+
+const MergingBoneKeyframe *
+Merger::findBoneKeyframe(const MergingBoneKeyframe::List &keyframes, const MergingTrack &track,
+    nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT
+{
+    /* the last keyframe at the same frame is the one applied after all of them */
+    nanoem_rsize_t low = track.m_begin, high = track.m_end;
+    while (low < high) {
+        const nanoem_rsize_t mid = low + (high - low) / 2;
+        if (keyframes[mid].m_frameIndex <= frameIndex) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low > track.m_begin && keyframes[low - 1].m_frameIndex == frameIndex ? &keyframes[low - 1] : nullptr;
+}
+
 void
-Merger::reverseBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, StringSet &reversedBoneNameSet)
+Merger::reverseAllBoneKeyframes(const MergingBoneKeyframe::List &keyframes, const MergingTrack::List &tracks)
 {
     static const nanoem_u8_t kLeftInJapanese[] = { 0xe5, 0xb7, 0xa6, 0x0 },
                              kRightInJapanese[] = { 0xe5, 0x8f, 0xb3, 0x0 };
-    String utf8Name;
-    StringUtils::getUtf8String(nanoemMotionBoneKeyframeGetName(origin), m_factory, utf8Name);
-    if (StringUtils::hasPrefix(utf8Name.c_str(), reinterpret_cast<const char *>(kLeftInJapanese))) {
-        const String &newName =
-            StringUtils::substitutedPrefixString(reinterpret_cast<const char *>(kRightInJapanese), utf8Name.c_str());
-        if (reversedBoneNameSet.find(newName) == reversedBoneNameSet.end()) {
-            reverseBoneKeyframe(origin, newName);
-            reversedBoneNameSet.insert(newName);
-        }
+    const char *left = reinterpret_cast<const char *>(kLeftInJapanese),
+               *right = reinterpret_cast<const char *>(kRightInJapanese);
+    MergingTrack::IndexMap trackIndices;
+    for (nanoem_rsize_t i = 0, numTracks = tracks.size(); i < numTracks; i++) {
+        trackIndices.insert(tinystl::make_pair(tracks[i].m_utf8Name, i));
     }
-    if (StringUtils::hasPrefix(utf8Name.c_str(), reinterpret_cast<const char *>(kRightInJapanese))) {
-        const String &newName =
-            StringUtils::substitutedPrefixString(reinterpret_cast<const char *>(kLeftInJapanese), utf8Name.c_str());
-        if (reversedBoneNameSet.find(newName) == reversedBoneNameSet.end()) {
-            reverseBoneKeyframe(origin, newName);
-            reversedBoneNameSet.insert(newName);
+    for (MergingTrack::List::const_iterator it = tracks.begin(), end = tracks.end(); it != end; ++it) {
+        const char *name = it->m_utf8Name.c_str();
+        String newName;
+        if (StringUtils::hasPrefix(name, left)) {
+            newName = StringUtils::substitutedPrefixString(right, name);
+        }
+        else if (StringUtils::hasPrefix(name, right)) {
+            newName = StringUtils::substitutedPrefixString(left, name);
+        }
+        else {
+            continue;
+        }
+        /* only the first keyframe of the track in the source order is mirrored to the opposite track */
+        MergingTrack::IndexMap::const_iterator it2 = trackIndices.find(newName);
+        const MergingTrack *opposite = it2 != trackIndices.end() ? &tracks[it2->second] : nullptr;
+        if (const MergingBoneKeyframe *first = findFirstReversingBoneKeyframe(keyframes, *it)) {
+            /* the opposite keyframe at the same frame wins only if it follows the first one in the source order */
+            const MergingBoneKeyframe *keyframe =
+                opposite ? findBoneKeyframe(keyframes, *opposite, first->m_frameIndex) : nullptr;
+            if (!keyframe || keyframe->m_order < first->m_order) {
+                reverseBoneKeyframe(first->m_keyframe, first->m_frameIndex, newName);
+            }
         }
     }
 }
 
 void
-Merger::addBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, bool reverse, StringSet &reversedBoneNameSet)
+Merger::addBoneKeyframe(
+    const nanoem_motion_bone_keyframe_t *keyframe, const nanoem_unicode_string_t *name, nanoem_frame_index_t frameIndex)
 {
     nanoem_motion_t *destOrigin = nanoemMutableMotionGetOriginObject(m_dest);
     nanoem_mutable_motion_bone_keyframe_t *newKeyframe = nanoemMutableMotionBoneKeyframeCreate(destOrigin, &m_status);
-    nanoemMutableMotionBoneKeyframeCopy(newKeyframe, origin);
-    if (reverse) {
-        reverseBoneKeyframe(origin, reversedBoneNameSet);
-    }
-    const nanoem_unicode_string_t *name = nanoemMotionBoneKeyframeGetName(origin);
-    const nanoem_frame_index_t frameIndex =
-        nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(origin));
+    nanoemMutableMotionBoneKeyframeCopy(newKeyframe, keyframe);
     nanoemMutableMotionAddBoneKeyframe(m_dest, newKeyframe, name, frameIndex, &m_status);
     nanoemMutableMotionBoneKeyframeDestroy(newKeyframe);
 }
@@ -207,37 +546,47 @@ Merger::addBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, bool revers
 void
 Merger::mergeAllBoneKeyframes(bool reverse)
 {
-    nanoem_rsize_t numKeyframes;
+    nanoem_rsize_t numSourceKeyframes, numDestKeyframes;
     nanoem_motion_t *destOrigin = nanoemMutableMotionGetOriginObject(m_dest);
-    nanoem_motion_bone_keyframe_t *const *keyframes = nanoemMotionGetAllBoneKeyframeObjects(m_source, &numKeyframes);
-    StringSet reversedBoneNameSet;
-    for (nanoem_frame_index_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_bone_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(keyframe));
-        const nanoem_unicode_string_t *name = nanoemMotionBoneKeyframeGetName(keyframe);
-        if (!m_override && !nanoemMotionFindBoneKeyframeObject(destOrigin, name, frameIndex)) {
-            addBoneKeyframe(keyframe, reverse, reversedBoneNameSet);
-        }
-        else if (m_override) {
-            nanoem_mutable_motion_bone_keyframe_t *newKeyframe =
-                nanoemMutableMotionBoneKeyframeCreateByFound(destOrigin, name, frameIndex, &m_status);
-            if (newKeyframe) {
-                nanoemMutableMotionBoneKeyframeCopy(newKeyframe, keyframe);
-                if (reverse) {
-                    reverseBoneKeyframe(keyframe, reversedBoneNameSet);
-                }
-                nanoemMutableMotionBoneKeyframeDestroy(newKeyframe);
+    nanoem_motion_bone_keyframe_t *const *sourceKeyframes =
+        nanoemMotionGetAllBoneKeyframeObjects(m_source, &numSourceKeyframes);
+    nanoem_motion_bone_keyframe_t *const *destKeyframes =
+        nanoemMotionGetAllBoneKeyframeObjects(destOrigin, &numDestKeyframes);
+    MergingBoneKeyframe::List sources, dests;
+    MergingTrack::List sourceTracks, destTracks;
+    MergingBoneKeyframe::sortAll(sourceKeyframes, numSourceKeyframes, m_offset, sources);
+    MergingBoneKeyframe::sortAll(destKeyframes, numDestKeyframes, 0, dests);
+    MergingBoneKeyframe::splitAllTracks(sources, m_factory, sourceTracks);
+    MergingBoneKeyframe::splitAllTracks(dests, m_factory, destTracks);
+    MergingBoneKeyframe::zipAllTracks(destOrigin, sourceTracks, destTracks, dests, sources);
+    for (MergingTrack::List::const_iterator it = sourceTracks.begin(), end = sourceTracks.end(); it != end; ++it) {
+        const nanoem_unicode_string_t *name = it->m_name;
+        for (nanoem_rsize_t i = it->m_begin; i < it->m_end; i++) {
+            const MergingBoneKeyframe &keyframe = sources[i];
+            if (MergingBoneKeyframe::isDuplicated(sources, it->m_begin, it->m_end, i, m_override)) {
+                continue;
             }
-            else {
-                addBoneKeyframe(keyframe, reverse, reversedBoneNameSet);
+            else if (!keyframe.m_found) {
+                addBoneKeyframe(keyframe.m_keyframe, name, keyframe.m_frameIndex);
+            }
+            else if (m_override) {
+                nanoem_mutable_motion_bone_keyframe_t *newKeyframe =
+                    nanoemMutableMotionBoneKeyframeCreateAsReference(keyframe.m_found, &m_status);
+                if (newKeyframe) {
+                    nanoemMutableMotionBoneKeyframeCopy(newKeyframe, keyframe.m_keyframe);
+                    nanoemMutableMotionBoneKeyframeDestroy(newKeyframe);
+                }
             }
         }
     }
+    /* keyframes are mirrored only while overriding as pasting is the only operation to merge them reversed */
+    if (reverse && m_override) {
+        reverseAllBoneKeyframes(sources, sourceTracks);
+    }
 }
 
 void
-Merger::addCameraKeyframe(nanoem_motion_camera_keyframe_t *keyframe, nanoem_frame_index_t frameIndex)
+Merger::addCameraKeyframe(const nanoem_motion_camera_keyframe_t *keyframe, nanoem_frame_index_t frameIndex)
 {
     nanoem_motion_t *destOrigin = nanoemMutableMotionGetOriginObject(m_dest);
     nanoem_mutable_motion_camera_keyframe_t *newKeyframe =
@@ -250,27 +599,33 @@ Merger::addCameraKeyframe(nanoem_motion_camera_keyframe_t *keyframe, nanoem_fram
 void
 Merger::mergeAllCameraKeyframes()
 {
-    nanoem_rsize_t numKeyframes;
+    nanoem_rsize_t numSourceKeyframes, numDestKeyframes;
     nanoem_motion_t *destOrigin = nanoemMutableMotionGetOriginObject(m_dest);
-    nanoem_motion_camera_keyframe_t *const *keyframes =
-        nanoemMotionGetAllCameraKeyframeObjects(m_source, &numKeyframes);
-    for (nanoem_frame_index_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_camera_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(keyframe));
-        if (!m_override && !nanoemMotionFindCameraKeyframeObject(destOrigin, frameIndex)) {
-            addCameraKeyframe(keyframe, frameIndex);
-        }
-        else if (m_override) {
+    nanoem_motion_camera_keyframe_t *const *sourceKeyframes =
+        nanoemMotionGetAllCameraKeyframeObjects(m_source, &numSourceKeyframes);
+    nanoem_motion_camera_keyframe_t *const *destKeyframes =
+        nanoemMotionGetAllCameraKeyframeObjects(destOrigin, &numDestKeyframes);
+    MergingCameraKeyframe::List sources, dests;
+    MergingCameraKeyframe::sortAll(sourceKeyframes, numSourceKeyframes, m_offset, sources);
+    MergingCameraKeyframe::sortAll(destKeyframes, numDestKeyframes, 0, dests);
+    MergingCameraKeyframe::zipAll(destOrigin, dests, sources);
+    /* all existing keyframes are overridden before adding any keyframes to keep the destination sorted */
+    const nanoem_rsize_t numSources = sources.size();
+    for (nanoem_rsize_t i = 0; i < numSources; i++) {
+        const MergingCameraKeyframe &keyframe = sources[i];
+        if (m_override && keyframe.m_found && !MergingCameraKeyframe::isDuplicated(sources, 0, numSources, i, true)) {
             nanoem_mutable_motion_camera_keyframe_t *newKeyframe =
-                nanoemMutableMotionCameraKeyframeCreateByFound(destOrigin, frameIndex, &m_status);
+                nanoemMutableMotionCameraKeyframeCreateAsReference(keyframe.m_found, &m_status);
             if (newKeyframe) {
-                nanoemMutableMotionCameraKeyframeCopy(newKeyframe, keyframe);
+                nanoemMutableMotionCameraKeyframeCopy(newKeyframe, keyframe.m_keyframe);
                 nanoemMutableMotionCameraKeyframeDestroy(newKeyframe);
             }
-            else {
-                addCameraKeyframe(keyframe, frameIndex);
-            }
+        }
+    }
+    for (nanoem_rsize_t i = 0; i < numSources; i++) {
+        const MergingCameraKeyframe &keyframe = sources[i];
+        if (!keyframe.m_found && !MergingCameraKeyframe::isDuplicated(sources, 0, numSources, i, m_override)) {
+            addCameraKeyframe(keyframe.m_keyframe, keyframe.m_frameIndex);
         }
     }
 }
@@ -288,26 +643,33 @@ Merger::addLightKeyframe(const nanoem_motion_light_keyframe_t *keyframe, nanoem_
 void
 Merger::mergeAllLightKeyframes()
 {
-    nanoem_rsize_t numKeyframes;
+    nanoem_rsize_t numSourceKeyframes, numDestKeyframes;
     nanoem_motion_t *destOrigin = nanoemMutableMotionGetOriginObject(m_dest);
-    nanoem_motion_light_keyframe_t *const *keyframes = nanoemMotionGetAllLightKeyframeObjects(m_source, &numKeyframes);
-    for (nanoem_frame_index_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_light_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionLightKeyframeGetKeyframeObject(keyframe));
-        if (!m_override && !nanoemMotionFindLightKeyframeObject(destOrigin, frameIndex)) {
-            addLightKeyframe(keyframe, frameIndex);
-        }
-        else if (m_override) {
+    nanoem_motion_light_keyframe_t *const *sourceKeyframes =
+        nanoemMotionGetAllLightKeyframeObjects(m_source, &numSourceKeyframes);
+    nanoem_motion_light_keyframe_t *const *destKeyframes =
+        nanoemMotionGetAllLightKeyframeObjects(destOrigin, &numDestKeyframes);
+    MergingLightKeyframe::List sources, dests;
+    MergingLightKeyframe::sortAll(sourceKeyframes, numSourceKeyframes, m_offset, sources);
+    MergingLightKeyframe::sortAll(destKeyframes, numDestKeyframes, 0, dests);
+    MergingLightKeyframe::zipAll(destOrigin, dests, sources);
+    /* all existing keyframes are overridden before adding any keyframes to keep the destination sorted */
+    const nanoem_rsize_t numSources = sources.size();
+    for (nanoem_rsize_t i = 0; i < numSources; i++) {
+        const MergingLightKeyframe &keyframe = sources[i];
+        if (m_override && keyframe.m_found && !MergingLightKeyframe::isDuplicated(sources, 0, numSources, i, true)) {
             nanoem_mutable_motion_light_keyframe_t *newKeyframe =
-                nanoemMutableMotionLightKeyframeCreateByFound(destOrigin, frameIndex, &m_status);
+                nanoemMutableMotionLightKeyframeCreateAsReference(keyframe.m_found, &m_status);
             if (newKeyframe) {
-                nanoemMutableMotionLightKeyframeCopy(newKeyframe, keyframe);
+                nanoemMutableMotionLightKeyframeCopy(newKeyframe, keyframe.m_keyframe);
                 nanoemMutableMotionLightKeyframeDestroy(newKeyframe);
             }
-            else {
-                addLightKeyframe(keyframe, frameIndex);
-            }
+        }
+    }
+    for (nanoem_rsize_t i = 0; i < numSources; i++) {
+        const MergingLightKeyframe &keyframe = sources[i];
+        if (!keyframe.m_found && !MergingLightKeyframe::isDuplicated(sources, 0, numSources, i, m_override)) {
+            addLightKeyframe(keyframe.m_keyframe, keyframe.m_frameIndex);
         }
     }
 }
@@ -325,26 +687,33 @@ Merger::addModelKeyframe(const nanoem_motion_model_keyframe_t *keyframe, nanoem_
 void
 Merger::mergeAllModelKeyframes()
 {
-    nanoem_rsize_t numKeyframes;
+    nanoem_rsize_t numSourceKeyframes, numDestKeyframes;
     nanoem_motion_t *destOrigin = nanoemMutableMotionGetOriginObject(m_dest);
-    nanoem_motion_model_keyframe_t *const *keyframes = nanoemMotionGetAllModelKeyframeObjects(m_source, &numKeyframes);
-    for (nanoem_frame_index_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_model_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionModelKeyframeGetKeyframeObject(keyframe));
-        if (!m_override && !nanoemMotionFindModelKeyframeObject(destOrigin, frameIndex)) {
-            addModelKeyframe(keyframe, frameIndex);
-        }
-        else if (m_override) {
+    nanoem_motion_model_keyframe_t *const *sourceKeyframes =
+        nanoemMotionGetAllModelKeyframeObjects(m_source, &numSourceKeyframes);
+    nanoem_motion_model_keyframe_t *const *destKeyframes =
+        nanoemMotionGetAllModelKeyframeObjects(destOrigin, &numDestKeyframes);
+    MergingModelKeyframe::List sources, dests;
+    MergingModelKeyframe::sortAll(sourceKeyframes, numSourceKeyframes, m_offset, sources);
+    MergingModelKeyframe::sortAll(destKeyframes, numDestKeyframes, 0, dests);
+    MergingModelKeyframe::zipAll(destOrigin, dests, sources);
+    /* all existing keyframes are overridden before adding any keyframes to keep the destination sorted */
+    const nanoem_rsize_t numSources = sources.size();
+    for (nanoem_rsize_t i = 0; i < numSources; i++) {
+        const MergingModelKeyframe &keyframe = sources[i];
+        if (m_override && keyframe.m_found && !MergingModelKeyframe::isDuplicated(sources, 0, numSources, i, true)) {
             nanoem_mutable_motion_model_keyframe_t *newKeyframe =
-                nanoemMutableMotionModelKeyframeCreateByFound(destOrigin, frameIndex, &m_status);
+                nanoemMutableMotionModelKeyframeCreateAsReference(keyframe.m_found, &m_status);
             if (newKeyframe) {
-                nanoemMutableMotionModelKeyframeCopy(newKeyframe, keyframe, &m_status);
+                nanoemMutableMotionModelKeyframeCopy(newKeyframe, keyframe.m_keyframe, &m_status);
                 nanoemMutableMotionModelKeyframeDestroy(newKeyframe);
             }
-            else {
-                addModelKeyframe(keyframe, frameIndex);
-            }
+        }
+    }
+    for (nanoem_rsize_t i = 0; i < numSources; i++) {
+        const MergingModelKeyframe &keyframe = sources[i];
+        if (!keyframe.m_found && !MergingModelKeyframe::isDuplicated(sources, 0, numSources, i, m_override)) {
+            addModelKeyframe(keyframe.m_keyframe, keyframe.m_frameIndex);
         }
     }
 }
@@ -363,26 +732,36 @@ Merger::addMorphKeyframe(const nanoem_motion_morph_keyframe_t *keyframe, const n
 void
 Merger::mergeAllMorphKeyframes()
 {
-    nanoem_rsize_t numKeyframes;
+    nanoem_rsize_t numSourceKeyframes, numDestKeyframes;
     nanoem_motion_t *destOrigin = nanoemMutableMotionGetOriginObject(m_dest);
-    nanoem_motion_morph_keyframe_t *const *keyframes = nanoemMotionGetAllMorphKeyframeObjects(m_source, &numKeyframes);
-    for (nanoem_frame_index_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_morph_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionMorphKeyframeGetKeyframeObject(keyframe));
-        const nanoem_unicode_string_t *name = nanoemMotionMorphKeyframeGetName(keyframe);
-        if (!m_override && !nanoemMotionFindMorphKeyframeObject(destOrigin, name, frameIndex)) {
-            addMorphKeyframe(keyframe, name, frameIndex);
-        }
-        else if (m_override) {
-            nanoem_mutable_motion_morph_keyframe_t *newKeyframe =
-                nanoemMutableMotionMorphKeyframeCreateByFound(destOrigin, name, frameIndex, &m_status);
-            if (newKeyframe) {
-                nanoemMutableMotionMorphKeyframeCopy(newKeyframe, keyframe);
-                nanoemMutableMotionMorphKeyframeDestroy(newKeyframe);
+    nanoem_motion_morph_keyframe_t *const *sourceKeyframes =
+        nanoemMotionGetAllMorphKeyframeObjects(m_source, &numSourceKeyframes);
+    nanoem_motion_morph_keyframe_t *const *destKeyframes =
+        nanoemMotionGetAllMorphKeyframeObjects(destOrigin, &numDestKeyframes);
+    MergingMorphKeyframe::List sources, dests;
+    MergingTrack::List sourceTracks, destTracks;
+    MergingMorphKeyframe::sortAll(sourceKeyframes, numSourceKeyframes, m_offset, sources);
+    MergingMorphKeyframe::sortAll(destKeyframes, numDestKeyframes, 0, dests);
+    MergingMorphKeyframe::splitAllTracks(sources, m_factory, sourceTracks);
+    MergingMorphKeyframe::splitAllTracks(dests, m_factory, destTracks);
+    MergingMorphKeyframe::zipAllTracks(destOrigin, sourceTracks, destTracks, dests, sources);
+    for (MergingTrack::List::const_iterator it = sourceTracks.begin(), end = sourceTracks.end(); it != end; ++it) {
+        const nanoem_unicode_string_t *name = it->m_name;
+        for (nanoem_rsize_t i = it->m_begin; i < it->m_end; i++) {
+            const MergingMorphKeyframe &keyframe = sources[i];
+            if (MergingMorphKeyframe::isDuplicated(sources, it->m_begin, it->m_end, i, m_override)) {
+                continue;
             }
-            else {
-                addMorphKeyframe(keyframe, name, frameIndex);
+            else if (!keyframe.m_found) {
+                addMorphKeyframe(keyframe.m_keyframe, name, keyframe.m_frameIndex);
+            }
+            else if (m_override) {
+                nanoem_mutable_motion_morph_keyframe_t *newKeyframe =
+                    nanoemMutableMotionMorphKeyframeCreateAsReference(keyframe.m_found, &m_status);
+                if (newKeyframe) {
+                    nanoemMutableMotionMorphKeyframeCopy(newKeyframe, keyframe.m_keyframe);
+                    nanoemMutableMotionMorphKeyframeDestroy(newKeyframe);
+                }
             }
         }
     }
@@ -402,29 +781,42 @@ Merger::addSelfShadowKeyframe(const nanoem_motion_self_shadow_keyframe_t *keyfra
 void
 Merger::mergeAllSelfShadowKeyframes()
 {
-    nanoem_rsize_t numKeyframes;
+    nanoem_rsize_t numSourceKeyframes, numDestKeyframes;
     nanoem_motion_t *destOrigin = nanoemMutableMotionGetOriginObject(m_dest);
-    nanoem_motion_self_shadow_keyframe_t *const *keyframes =
-        nanoemMotionGetAllSelfShadowKeyframeObjects(m_source, &numKeyframes);
-    for (nanoem_frame_index_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_self_shadow_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionSelfShadowKeyframeGetKeyframeObject(keyframe));
-        if (!m_override && !nanoemMotionFindSelfShadowKeyframeObject(destOrigin, frameIndex)) {
-            addSelfShadowKeyframe(keyframe, frameIndex);
-        }
-        else if (m_override) {
+    nanoem_motion_self_shadow_keyframe_t *const *sourceKeyframes =
+        nanoemMotionGetAllSelfShadowKeyframeObjects(m_source, &numSourceKeyframes);
+    nanoem_motion_self_shadow_keyframe_t *const *destKeyframes =
+        nanoemMotionGetAllSelfShadowKeyframeObjects(destOrigin, &numDestKeyframes);
+    MergingSelfShadowKeyframe::List sources, dests;
+    MergingSelfShadowKeyframe::sortAll(sourceKeyframes, numSourceKeyframes, m_offset, sources);
+    MergingSelfShadowKeyframe::sortAll(destKeyframes, numDestKeyframes, 0, dests);
+    MergingSelfShadowKeyframe::zipAll(destOrigin, dests, sources);
+    /* all existing keyframes are overridden before adding any keyframes to keep the destination sorted */
+    const nanoem_rsize_t numSources = sources.size();
+    for (nanoem_rsize_t i = 0; i < numSources; i++) {
+        const MergingSelfShadowKeyframe &keyframe = sources[i];
+        if (m_override && keyframe.m_found &&
+            !MergingSelfShadowKeyframe::isDuplicated(sources, 0, numSources, i, true)) {
             nanoem_mutable_motion_self_shadow_keyframe_t *newKeyframe =
-                nanoemMutableMotionSelfShadowKeyframeCreateByFound(destOrigin, frameIndex, &m_status);
+                nanoemMutableMotionSelfShadowKeyframeCreateAsReference(keyframe.m_found, &m_status);
             if (newKeyframe) {
-                nanoemMutableMotionSelfShadowKeyframeCopy(newKeyframe, keyframe);
+                nanoemMutableMotionSelfShadowKeyframeCopy(newKeyframe, keyframe.m_keyframe);
                 nanoemMutableMotionSelfShadowKeyframeDestroy(newKeyframe);
             }
-            else {
-                addSelfShadowKeyframe(keyframe, frameIndex);
-            }
         }
     }
+    for (nanoem_rsize_t i = 0; i < numSources; i++) {
+        const MergingSelfShadowKeyframe &keyframe = sources[i];
+        if (!keyframe.m_found && !MergingSelfShadowKeyframe::isDuplicated(sources, 0, numSources, i, m_override)) {
+            addSelfShadowKeyframe(keyframe.m_keyframe, keyframe.m_frameIndex);
+        }
+    }
+}
+
+void
+Merger::sortAllKeyframes()
+{
+    nanoemMutableMotionSortAllKeyframes(m_dest);
 }
 
 static int
@@ -461,6 +853,78 @@ compareKeyframeDescend(
     }
 }
 
+struct ScaleFrameIndexContext {
+    nanoem_frame_index_t m_from;
+    nanoem_f32_t m_scaleFactor;
+};
+
+static nanoem_frame_index_t
+scaleFrameIndex(void *userData, nanoem_frame_index_t frameIndex)
+{
+    const ScaleFrameIndexContext *context = static_cast<const ScaleFrameIndexContext *>(userData);
+    const nanoem_frame_index_t dest =
+        static_cast<nanoem_frame_index_t>((frameIndex - context->m_from) * context->m_scaleFactor) + context->m_from;
+    /* shrinking leaves a keyframe whose destination is the first frame of the range as is */
+    return context->m_scaleFactor < 1 && dest == context->m_from + 1 ? frameIndex : dest;
+}
+
+template <typename TKeyframe, typename TMap>
+static PackedBezierCurve *
+findKeyframePackedBezierCurve(const TKeyframe *keyframe, const nanoem_u8_t *const *parameters,
+    nanoem_rsize_t numCurves, nanoem_frame_index_t interval, TMap &curves)
+{
+    PackedBezierCurve *curve = nullptr;
+    typename TMap::iterator it = curves.find(keyframe);
+    if (it != curves.end()) {
+        curve = it->second;
+        /* interpolation parameters or the previous keyframe may be changed after the curve is packed */
+        if (!curve->isSame(parameters, interval)) {
+            nanoem_delete(curve);
+            curve = it->second = nanoem_new(PackedBezierCurve(parameters, numCurves, interval));
+        }
+    }
+    else {
+        curve = nanoem_new(PackedBezierCurve(parameters, numCurves, interval));
+        curves.insert(tinystl::make_pair(keyframe, curve));
+    }
+    return curve;
+}
+
+template <typename TMap>
+static void
+destroyAllKeyframePackedBezierCurves(TMap &curves)
+{
+    for (typename TMap::const_iterator it = curves.begin(), end = curves.end(); it != end; ++it) {
+        nanoem_delete(it->second);
+    }
+    curves.clear();
+}
+
+template <typename TKeyframe, typename TMap>
+static void
+destroyAllStaleKeyframePackedBezierCurves(TKeyframe *const *keyframes, nanoem_rsize_t numKeyframes, TMap &curves)
+{
+    if (!curves.empty()) {
+        typedef tinystl::unordered_set<const TKeyframe *, TinySTLAllocator> KeyframeSet;
+        typedef tinystl::vector<const TKeyframe *, TinySTLAllocator> KeyframeList;
+        KeyframeSet aliveKeyframes;
+        KeyframeList staleKeyframes;
+        for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+            aliveKeyframes.insert(keyframes[i]);
+        }
+        for (typename TMap::const_iterator it = curves.begin(), end = curves.end(); it != end; ++it) {
+            if (aliveKeyframes.find(it->first) == aliveKeyframes.end()) {
+                nanoem_delete(it->second);
+                staleKeyframes.push_back(it->first);
+            }
+        }
+        for (typename KeyframeList::const_iterator it = staleKeyframes.begin(), end = staleKeyframes.end(); it != end;
+             ++it) {
+            curves.erase(*it);
+        }
+    }
+}
+
 } /* namespace anonymous */
 
 const String Motion::kNMDFormatExtension = String("nmd");
@@ -1122,12 +1586,8 @@ Motion::Motion(Project *project, nanoem_u16_t handle)
 
 Motion::~Motion() NANOEM_DECL_NOEXCEPT
 {
-    for (BezierCurve::Map::const_iterator it = m_bezierCurvesData.begin(), end = m_bezierCurvesData.end(); it != end;
-         ++it) {
-        nanoem_delete(it->second);
-    }
+    destroyAllPackedBezierCurves();
     nanoem_delete_safe(m_selection);
-    m_bezierCurvesData.clear();
     nanoemMotionDestroy(m_opaque);
     m_opaque = nullptr;
 }
@@ -1415,24 +1875,25 @@ Motion::writeLoadModelCommandMessage(nanoem_u16_t handle, const URI &fileURI, Er
 void
 Motion::mergeAllKeyframes(const Motion *source)
 {
-    internalMergeAllKeyframes(source, false, false);
+    internalMergeAllKeyframes(source, 0, false, false);
 }
 
 void
 Motion::overrideAllKeyframes(const Motion *source, bool reverse)
 {
-    internalMergeAllKeyframes(source, true, reverse);
+    internalMergeAllKeyframes(source, 0, true, reverse);
+}
+
+void
+Motion::overrideAllKeyframes(const Motion *source, nanoem_frame_index_t offset, bool reverse)
+{
+    internalMergeAllKeyframes(source, offset, true, reverse);
 }
 
 void
 Motion::clearAllKeyframes()
 {
-    for (BezierCurve::Map::const_iterator it = m_bezierCurvesData.begin(), end = m_bezierCurvesData.end(); it != end;
-         ++it) {
-        nanoem_delete(it->second);
-    }
-    m_bezierCurvesData.clear();
-    m_keyframeBezierCurves.clear();
+    destroyAllPackedBezierCurves();
     m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL);
     nanoemMotionDestroy(m_opaque);
     nanoem_status_t status = NANOEM_STATUS_SUCCESS;
@@ -1518,277 +1979,37 @@ Motion::correctAllSelectedMorphKeyframes(const CorrectionScalarFactor &weight)
 void
 Motion::scaleAllAccessoryKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor)
 {
-    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
-    if (scaleFactor > 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ACCESSORY);
-        for (nanoem_frame_index_t i = to; i > from; i--) {
-            if (nanoem_mutable_motion_accessory_keyframe_t *k =
-                    nanoemMutableMotionAccessoryKeyframeCreateByFound(m_opaque, i, &status)) {
-                const nanoem_frame_index_t dest = static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-                nanoemMutableMotionRemoveAccessoryKeyframe(m, k, &status);
-                nanoemMutableMotionAddAccessoryKeyframe(m, k, dest, &status);
-                nanoemMutableMotionAccessoryKeyframeDestroy(k);
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
-    else if (scaleFactor < 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ACCESSORY);
-        for (nanoem_frame_index_t startFrom = from + 1, i = startFrom; i <= to; i++) {
-            const nanoem_frame_index_t dest = static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-            if (dest == startFrom) {
-                continue;
-            }
-            else if (nanoem_mutable_motion_accessory_keyframe_t *k =
-                         nanoemMutableMotionAccessoryKeyframeCreateByFound(m_opaque, i, &status)) {
-                nanoemMutableMotionRemoveAccessoryKeyframe(m, k, &status);
-                nanoemMutableMotionAddAccessoryKeyframe(m, k, dest, &status);
-                nanoem_frame_index_t increment = 0;
-                do {
-                    nanoemMutableMotionAddAccessoryKeyframe(m, k, dest + increment, &status);
-                    increment++;
-                } while (status == NANOEM_STATUS_ERROR_MOTION_ACCESSORY_KEYFRAME_ALREADY_EXISTS);
-                nanoemMutableMotionAccessoryKeyframeDestroy(k);
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
+    internalScaleAllKeyframesIn(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ACCESSORY, from, to, scaleFactor);
 }
 
 void
-Motion::scaleAllBoneKeyframesIn(
-    const Model *model, nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor)
+Motion::scaleAllBoneKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor)
 {
-    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
-    nanoem_rsize_t numBones;
-    if (scaleFactor > 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(model->data(), &numBones);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE);
-        for (nanoem_frame_index_t i = to; i > from; i--) {
-            for (nanoem_rsize_t j = 0; j < numBones; j++) {
-                const nanoem_unicode_string_t *name = nanoemModelBoneGetName(bones[j], NANOEM_LANGUAGE_TYPE_FIRST_ENUM);
-                if (nanoem_mutable_motion_bone_keyframe_t *k =
-                        nanoemMutableMotionBoneKeyframeCreateByFound(m_opaque, name, i, &status)) {
-                    const nanoem_frame_index_t dest =
-                        static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-                    nanoemMutableMotionRemoveBoneKeyframe(m, k, &status);
-                    nanoemMutableMotionAddBoneKeyframe(m, k, name, dest, &status);
-                    nanoemMutableMotionBoneKeyframeDestroy(k);
-                }
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
-    else if (scaleFactor < 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(model->data(), &numBones);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE);
-        for (nanoem_frame_index_t startFrom = from + 1, i = startFrom; i <= to; i++) {
-            for (nanoem_rsize_t j = 0; j < numBones; j++) {
-                const nanoem_unicode_string_t *name = nanoemModelBoneGetName(bones[j], NANOEM_LANGUAGE_TYPE_FIRST_ENUM);
-                const nanoem_frame_index_t dest = static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-                if (dest == startFrom) {
-                    continue;
-                }
-                else if (nanoem_mutable_motion_bone_keyframe_t *k =
-                             nanoemMutableMotionBoneKeyframeCreateByFound(m_opaque, name, i, &status)) {
-                    nanoemMutableMotionRemoveBoneKeyframe(m, k, &status);
-                    nanoemMutableMotionAddBoneKeyframe(m, k, name, dest, &status);
-                    nanoem_frame_index_t increment = 0;
-                    do {
-                        nanoemMutableMotionAddBoneKeyframe(m, k, name, dest + increment, &status);
-                        increment++;
-                    } while (status == NANOEM_STATUS_ERROR_MOTION_BONE_KEYFRAME_ALREADY_EXISTS);
-                    nanoemMutableMotionBoneKeyframeDestroy(k);
-                }
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
+    internalScaleAllKeyframesIn(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE, from, to, scaleFactor);
 }
 
 void
 Motion::scaleAllLightKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor)
 {
-    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
-    if (scaleFactor > 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_LIGHT);
-        for (nanoem_frame_index_t i = to; i > from; i--) {
-            if (nanoem_mutable_motion_light_keyframe_t *k =
-                    nanoemMutableMotionLightKeyframeCreateByFound(m_opaque, i, &status)) {
-                const nanoem_frame_index_t dest = static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-                nanoemMutableMotionRemoveLightKeyframe(m, k, &status);
-                nanoemMutableMotionAddLightKeyframe(m, k, dest, &status);
-                nanoemMutableMotionLightKeyframeDestroy(k);
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
-    else if (scaleFactor < 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_LIGHT);
-        for (nanoem_frame_index_t startFrom = from + 1, i = startFrom; i <= to; i++) {
-            const nanoem_frame_index_t dest = static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-            if (dest == startFrom) {
-                continue;
-            }
-            else if (nanoem_mutable_motion_light_keyframe_t *k =
-                         nanoemMutableMotionLightKeyframeCreateByFound(m_opaque, i, &status)) {
-                nanoemMutableMotionRemoveLightKeyframe(m, k, &status);
-                nanoemMutableMotionAddLightKeyframe(m, k, dest, &status);
-                nanoem_frame_index_t increment = 0;
-                do {
-                    nanoemMutableMotionAddLightKeyframe(m, k, dest + increment, &status);
-                    increment++;
-                } while (status == NANOEM_STATUS_ERROR_MOTION_LIGHT_KEYFRAME_ALREADY_EXISTS);
-                nanoemMutableMotionLightKeyframeDestroy(k);
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
+    internalScaleAllKeyframesIn(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_LIGHT, from, to, scaleFactor);
 }
 
 void
 Motion::scaleAllModelKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor)
 {
-    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
-    if (scaleFactor > 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MODEL);
-        for (nanoem_frame_index_t i = to; i > from; i--) {
-            if (nanoem_mutable_motion_model_keyframe_t *k =
-                    nanoemMutableMotionModelKeyframeCreateByFound(m_opaque, i, &status)) {
-                const nanoem_frame_index_t dest = static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-                nanoemMutableMotionRemoveModelKeyframe(m, k, &status);
-                nanoemMutableMotionAddModelKeyframe(m, k, dest, &status);
-                nanoemMutableMotionModelKeyframeDestroy(k);
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
-    else if (scaleFactor < 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MODEL);
-        for (nanoem_frame_index_t startFrom = from + 1, i = startFrom; i <= to; i++) {
-            const nanoem_frame_index_t dest = static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-            if (dest == startFrom) {
-                continue;
-            }
-            else if (nanoem_mutable_motion_model_keyframe_t *k =
-                         nanoemMutableMotionModelKeyframeCreateByFound(m_opaque, i, &status)) {
-                nanoemMutableMotionRemoveModelKeyframe(m, k, &status);
-                nanoemMutableMotionAddModelKeyframe(m, k, dest, &status);
-                nanoem_frame_index_t increment = 0;
-                do {
-                    nanoemMutableMotionAddModelKeyframe(m, k, dest + increment, &status);
-                    increment++;
-                } while (status == NANOEM_STATUS_ERROR_MOTION_MODEL_KEYFRAME_ALREADY_EXISTS);
-                nanoemMutableMotionModelKeyframeDestroy(k);
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
+    internalScaleAllKeyframesIn(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MODEL, from, to, scaleFactor);
 }
 
 void
-Motion::scaleAllMorphKeyframesIn(
-    const Model *model, nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor)
+Motion::scaleAllMorphKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor)
 {
-    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
-    nanoem_rsize_t numMorphs;
-    if (scaleFactor > 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        nanoem_model_morph_t *const *morphs = nanoemModelGetAllMorphObjects(model->data(), &numMorphs);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MORPH);
-        for (nanoem_frame_index_t i = to; i > from; i--) {
-            for (nanoem_rsize_t j = 0; j < numMorphs; j++) {
-                const nanoem_unicode_string_t *name =
-                    nanoemModelMorphGetName(morphs[j], NANOEM_LANGUAGE_TYPE_FIRST_ENUM);
-                if (nanoem_mutable_motion_morph_keyframe_t *k =
-                        nanoemMutableMotionMorphKeyframeCreateByFound(m_opaque, name, i, &status)) {
-                    const nanoem_frame_index_t dest =
-                        static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-                    nanoemMutableMotionRemoveMorphKeyframe(m, k, &status);
-                    nanoemMutableMotionAddMorphKeyframe(m, k, name, dest, &status);
-                    nanoemMutableMotionMorphKeyframeDestroy(k);
-                }
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
-    else if (scaleFactor < 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        nanoem_model_morph_t *const *morphs = nanoemModelGetAllMorphObjects(model->data(), &numMorphs);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MORPH);
-        for (nanoem_frame_index_t startFrom = from + 1, i = startFrom; i <= to; i++) {
-            for (nanoem_rsize_t j = 0; j < numMorphs; j++) {
-                const nanoem_unicode_string_t *name =
-                    nanoemModelMorphGetName(morphs[j], NANOEM_LANGUAGE_TYPE_FIRST_ENUM);
-                const nanoem_frame_index_t dest = static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-                if (dest == startFrom) {
-                    continue;
-                }
-                else if (nanoem_mutable_motion_morph_keyframe_t *k =
-                             nanoemMutableMotionMorphKeyframeCreateByFound(m_opaque, name, i, &status)) {
-                    nanoemMutableMotionRemoveMorphKeyframe(m, k, &status);
-                    nanoemMutableMotionAddMorphKeyframe(m, k, name, dest, &status);
-                    nanoem_frame_index_t increment = 0;
-                    do {
-                        nanoemMutableMotionAddMorphKeyframe(m, k, name, dest + increment, &status);
-                        increment++;
-                    } while (status == NANOEM_STATUS_ERROR_MOTION_MORPH_KEYFRAME_ALREADY_EXISTS);
-                    nanoemMutableMotionMorphKeyframeDestroy(k);
-                }
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
+    internalScaleAllKeyframesIn(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MORPH, from, to, scaleFactor);
 }
 
 void
 Motion::scaleAllSelfShadowKeyframesIn(nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor)
 {
-    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
-    if (scaleFactor > 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_SELFSHADOW);
-        for (nanoem_frame_index_t i = to; i > from; i--) {
-            if (nanoem_mutable_motion_self_shadow_keyframe_t *k =
-                    nanoemMutableMotionSelfShadowKeyframeCreateByFound(m_opaque, i, &status)) {
-                const nanoem_frame_index_t dest = static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-                nanoemMutableMotionRemoveSelfShadowKeyframe(m, k, &status);
-                nanoemMutableMotionAddSelfShadowKeyframe(m, k, dest, &status);
-                nanoemMutableMotionSelfShadowKeyframeDestroy(k);
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
-    else if (scaleFactor < 1) {
-        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
-        m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_SELFSHADOW);
-        for (nanoem_frame_index_t startFrom = from + 1, i = startFrom; i <= to; i++) {
-            const nanoem_frame_index_t dest = static_cast<nanoem_frame_index_t>((i - from) * scaleFactor) + from;
-            if (dest == startFrom) {
-                continue;
-            }
-            else if (nanoem_mutable_motion_self_shadow_keyframe_t *k =
-                         nanoemMutableMotionSelfShadowKeyframeCreateByFound(m_opaque, i, &status)) {
-                nanoemMutableMotionRemoveSelfShadowKeyframe(m, k, &status);
-                nanoemMutableMotionAddSelfShadowKeyframe(m, k, dest, &status);
-                nanoem_frame_index_t increment = 0;
-                do {
-                    nanoemMutableMotionAddSelfShadowKeyframe(m, k, dest + increment, &status);
-                    increment++;
-                } while (status == NANOEM_STATUS_ERROR_MOTION_SELF_SHADOW_KEYFRAME_ALREADY_EXISTS);
-                nanoemMutableMotionSelfShadowKeyframeDestroy(k);
-            }
-        }
-        nanoemMutableMotionDestroy(m);
-    }
+    internalScaleAllKeyframesIn(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_SELFSHADOW, from, to, scaleFactor);
 }
 
 void
@@ -2059,6 +2280,10 @@ Motion::isDirty() const NANOEM_DECL_NOEXCEPT
 void
 Motion::setDirty(bool value)
 {
+    if (value) {
+        /* keyframes may be removed by the change so curves cached for them are released */
+        destroyAllStalePackedBezierCurves();
+    }
     m_dirty = value;
 }
 
@@ -2128,34 +2353,62 @@ Motion::coefficient(const nanoem_motion_morph_keyframe_t *prev, const nanoem_mot
     return coefficient(prevFrameIndex, nextFrameIndex, frameIndex);
 }
 
-nanoem_f32_t
-Motion::bezierCurve(const nanoem_motion_bone_keyframe_t *prev, const nanoem_motion_bone_keyframe_t *next,
-    nanoem_motion_bone_keyframe_interpolation_type_t index, nanoem_f32_t value) const
+Vector4
+Motion::bezierCurves(const nanoem_motion_bone_keyframe_t *prev, const nanoem_motion_bone_keyframe_t *next,
+    nanoem_f32_t value) const
 {
-    const nanoem_u8_t *parameters = nanoemMotionBoneKeyframeGetInterpolation(next, index);
-    BezierCurve *curve;
-    KeyframeBezierCurveMap::const_iterator it = m_keyframeBezierCurves.find(next);
-    if (it != m_keyframeBezierCurves.end()) {
-        curve = it->second;
+    const nanoem_u8_t *parameters[NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM];
+    for (int i = NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM;
+         i < NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM; i++) {
+        parameters[i] =
+            nanoemMotionBoneKeyframeGetInterpolation(next, nanoem_motion_bone_keyframe_interpolation_type_t(i));
     }
-    else {
-        const nanoem_frame_index_t interval =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next)) -
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(prev));
-        const nanoem_u64_t hash = BezierCurve::toHash(parameters, interval);
-        BezierCurve::Map::const_iterator it2 = m_bezierCurvesData.find(hash);
-        if (it2 != m_bezierCurvesData.end()) {
-            curve = it2->second;
-            m_keyframeBezierCurves.insert(tinystl::make_pair(next, curve));
-        }
-        else {
-            const Vector2 c0(parameters[0], parameters[1]), c1(parameters[2], parameters[3]);
-            curve = nanoem_new(BezierCurve(c0, c1, interval));
-            m_bezierCurvesData.insert(tinystl::make_pair(hash, curve));
-            m_keyframeBezierCurves.insert(tinystl::make_pair(next, curve));
-        }
+    const nanoem_frame_index_t interval =
+        nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next)) -
+        nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(prev));
+    PackedBezierCurve *curve = findKeyframePackedBezierCurve(
+        next, parameters, BX_COUNTOF(parameters), interval, m_boneKeyframePackedBezierCurves);
+    Vector4 result;
+    curve->values(value, glm::value_ptr(result));
+    return result;
+}
+
+void
+Motion::bezierCurves(const nanoem_motion_camera_keyframe_t *prev, const nanoem_motion_camera_keyframe_t *next,
+    nanoem_f32_t value, nanoem_f32_t *values) const
+{
+    const nanoem_u8_t *parameters[NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM];
+    for (int i = NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM;
+         i < NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM; i++) {
+        parameters[i] =
+            nanoemMotionCameraKeyframeGetInterpolation(next, nanoem_motion_camera_keyframe_interpolation_type_t(i));
     }
-    return curve->value(value);
+    const nanoem_frame_index_t interval =
+        nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(next)) -
+        nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(prev));
+    PackedBezierCurve *curve = findKeyframePackedBezierCurve(
+        next, parameters, BX_COUNTOF(parameters), interval, m_cameraKeyframePackedBezierCurves);
+    curve->values(value, values);
+}
+
+void
+Motion::destroyAllPackedBezierCurves()
+{
+    destroyAllKeyframePackedBezierCurves(m_boneKeyframePackedBezierCurves);
+    destroyAllKeyframePackedBezierCurves(m_cameraKeyframePackedBezierCurves);
+}
+
+void
+Motion::destroyAllStalePackedBezierCurves()
+{
+    nanoem_rsize_t numBoneKeyframes, numCameraKeyframes;
+    nanoem_motion_bone_keyframe_t *const *boneKeyframes =
+        nanoemMotionGetAllBoneKeyframeObjects(m_opaque, &numBoneKeyframes);
+    destroyAllStaleKeyframePackedBezierCurves(boneKeyframes, numBoneKeyframes, m_boneKeyframePackedBezierCurves);
+    nanoem_motion_camera_keyframe_t *const *cameraKeyframes =
+        nanoemMotionGetAllCameraKeyframeObjects(m_opaque, &numCameraKeyframes);
+    destroyAllStaleKeyframePackedBezierCurves(
+        cameraKeyframes, numCameraKeyframes, m_cameraKeyframePackedBezierCurves);
 }
 
 nanoem_f32_t
@@ -2302,9 +2555,11 @@ Motion::internalSave(nanoem_mutable_motion_t *mutableMotion, IWriter *writer, Er
 }
 
 void
-Motion::internalMergeAllKeyframes(const Motion *source, bool _override, bool reverse)
+Motion::internalMergeAllKeyframes(const Motion *source, nanoem_frame_index_t offset, bool _override, bool reverse)
 {
-    Merger merger(source->data(), m_project->unicodeStringFactory(), m_opaque, _override);
+    Merger merger(source->data(), m_project->unicodeStringFactory(), m_opaque, offset, _override);
+    /* existing keyframes are referenced while overriding and it looks them up with binary search */
+    merger.sortAllKeyframes();
     merger.mergeAllAccessoryKeyframes();
     merger.mergeAllBoneKeyframes(reverse);
     merger.mergeAllCameraKeyframes();
@@ -2312,7 +2567,23 @@ Motion::internalMergeAllKeyframes(const Motion *source, bool _override, bool rev
     merger.mergeAllModelKeyframes();
     merger.mergeAllMorphKeyframes();
     merger.mergeAllSelfShadowKeyframes();
+    merger.sortAllKeyframes();
     setDirty(true);
 }
 
+void
+Motion::internalScaleAllKeyframesIn(
+    nanoem_u32_t type, nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_f32_t scaleFactor)
+{
+    if (scaleFactor > 1 || scaleFactor < 1) {
+        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+        nanoem_mutable_motion_t *m = nanoemMutableMotionCreateAsReference(m_opaque, &status);
+        ScaleFrameIndexContext context = { from, scaleFactor };
+        m_selection->clearAllKeyframes(type);
+        /* all keyframes in the range are moved at once and collided ones are shifted to the next free frame */
+        nanoemMutableMotionRemapAllKeyframes(m, type, from + 1, to, scaleFrameIndex, &context, &status);
+        nanoemMutableMotionDestroy(m);
+    }
+}
+
 } /* namespace nanoem */
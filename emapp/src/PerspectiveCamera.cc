@@ -68,11 +68,6 @@ PerspectiveCamera::PerspectiveCamera(Project *project)
 
 PerspectiveCamera::~PerspectiveCamera() NANOEM_DECL_NOEXCEPT
 {
-    for (BezierCurve::Map::const_iterator it = m_bezierCurvesData.begin(), end = m_bezierCurvesData.end(); it != end;
-         ++it) {
-        nanoem_delete(it->second);
-    }
-    m_bezierCurvesData.clear();
     undoStackDestroy(m_undoStack);
     m_undoStack = nullptr;
 }
@@ -164,6 +159,20 @@ PerspectiveCamera::synchronizeParameters(const Motion *motion, const nanoem_fram
         if (prevKeyframe && nextKeyframe) {
             const nanoem_motion_camera_keyframe_t *interpolateKeyframe = nextKeyframe;
             const nanoem_f32_t coef = Motion::coefficient(prevKeyframe, nextKeyframe, frameIndex);
+            nanoem_f32_t t2s[NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM];
+            for (int i = NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM;
+                 i < NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM; i++) {
+                t2s[i] = coef;
+            }
+            for (int i = NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM;
+                 i < NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM; i++) {
+                /* all six curves are evaluated at once if any of them is not linear */
+                if (!nanoemMotionCameraKeyframeIsLinearInterpolation(
+                        interpolateKeyframe, nanoem_motion_camera_keyframe_interpolation_type_t(i))) {
+                    motion->bezierCurves(prevKeyframe, nextKeyframe, coef, t2s);
+                    break;
+                }
+            }
             const Vector3 prevLookAt = glm::make_vec3(nanoemMotionCameraKeyframeGetLookAt(prevKeyframe));
             const Vector3 nextLookAt = glm::make_vec3(nanoemMotionCameraKeyframeGetLookAt(nextKeyframe));
             if (nanoemMotionCameraKeyframeIsLinearInterpolation(
@@ -192,8 +201,7 @@ PerspectiveCamera::synchronizeParameters(const Motion *motion, const nanoem_fram
                         m_isLinearInterpolation[i] = true;
                     }
                     else {
-                        const nanoem_f32_t t2 = bezierCurve(prevKeyframe, nextKeyframe, type, coef);
-                        lookAt[i] = glm::mix(v0, v1, t2);
+                        lookAt[i] = glm::mix(v0, v1, t2s[i]);
                         m_bezierControlPoints[i] =
                             glm::make_vec4(nanoemMotionCameraKeyframeGetInterpolation(interpolateKeyframe, type));
                         m_isLinearInterpolation[i] = false;
@@ -211,9 +219,7 @@ PerspectiveCamera::synchronizeParameters(const Motion *motion, const nanoem_fram
                 m_isLinearInterpolation[NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_ANGLE] = true;
             }
             else {
-                const nanoem_f32_t &t2 = bezierCurve(
-                    prevKeyframe, nextKeyframe, NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_ANGLE, coef);
-                setAngle(glm::mix(angle0, angle1, t2));
+                setAngle(glm::mix(angle0, angle1, t2s[NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_ANGLE]));
                 m_bezierControlPoints[NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_ANGLE] =
                     glm::make_vec4(nanoemMotionCameraKeyframeGetInterpolation(
                         interpolateKeyframe, NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_ANGLE));
@@ -229,8 +235,7 @@ PerspectiveCamera::synchronizeParameters(const Motion *motion, const nanoem_fram
                 m_isLinearInterpolation[NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_FOV] = true;
             }
             else {
-                const nanoem_f32_t &t2 =
-                    bezierCurve(prevKeyframe, nextKeyframe, NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_FOV, coef);
+                const nanoem_f32_t t2 = t2s[NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_FOV];
                 setFovRadians(glm::radians(glm::mix(fov0, fov1, t2)));
                 m_bezierControlPoints[NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_FOV] =
                     glm::make_vec4(nanoemMotionCameraKeyframeGetInterpolation(
@@ -247,8 +252,7 @@ PerspectiveCamera::synchronizeParameters(const Motion *motion, const nanoem_fram
                 m_isLinearInterpolation[NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_DISTANCE] = true;
             }
             else {
-                const nanoem_f32_t &t2 = bezierCurve(
-                    prevKeyframe, nextKeyframe, NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_DISTANCE, coef);
+                const nanoem_f32_t t2 = t2s[NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_DISTANCE];
                 setDistance(glm::mix(distance0, distance1, t2));
                 m_bezierControlPoints[NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_DISTANCE] =
                     glm::make_vec4(nanoemMotionCameraKeyframeGetInterpolation(
@@ -597,34 +601,4 @@ PerspectiveCamera::setDirty(bool value)
     m_dirty = value;
 }
 
-nanoem_f32_t
-PerspectiveCamera::bezierCurve(const nanoem_motion_camera_keyframe_t *prev, const nanoem_motion_camera_keyframe_t *next,
-    nanoem_motion_camera_keyframe_interpolation_type_t index, nanoem_f32_t value) const
-{
-    const nanoem_u8_t *parameters = nanoemMotionCameraKeyframeGetInterpolation(next, index);
-    BezierCurve *curve;
-    KeyframeBezierCurveMap::const_iterator it = m_keyframeBezierCurves.find(next);
-    if (it != m_keyframeBezierCurves.end()) {
-        curve = it->second;
-    }
-    else {
-        const nanoem_frame_index_t interval =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(next)) -
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(prev));
-        const nanoem_u64_t hash = BezierCurve::toHash(parameters, interval);
-        BezierCurve::Map::const_iterator it2 = m_bezierCurvesData.find(hash);
-        if (it2 != m_bezierCurvesData.end()) {
-            curve = it2->second;
-            m_keyframeBezierCurves.insert(tinystl::make_pair(next, curve));
-        }
-        else {
-            const Vector2 c0(parameters[0], parameters[1]), c1(parameters[2], parameters[3]);
-            curve = nanoem_new(BezierCurve(c0, c1, interval));
-            m_bezierCurvesData.insert(tinystl::make_pair(hash, curve));
-            m_keyframeBezierCurves.insert(tinystl::make_pair(next, curve));
-        }
-    }
-    return curve->value(value);
-}
-
 } /* namespace nanoem */
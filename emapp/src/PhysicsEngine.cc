@@ -7,6 +7,7 @@
 #include "emapp/PhysicsEngine.h"
 
 #include "emapp/Constants.h"
+#include "emapp/Profiler.h"
 #include "emapp/private/CommonInclude.h"
 
 #ifndef DLL
@@ -113,6 +114,20 @@ struct PhysicsEngine::PrivateContext {
         nanoem_physics_soft_body_t *soft_body, int offset, const nanoem_f32_t *value);
     typedef void(APIENTRY *PFN_nanoemPhysicsSoftBodySetVertexNormal)(
         nanoem_physics_soft_body_t *soft_body, int offset, const nanoem_f32_t *value);
+    typedef void(APIENTRY *PFN_nanoemPhysicsMotionStateGetAllInitialWorldTransforms)(
+        nanoem_physics_motion_state_t *const *motion_states, nanoem_rsize_t num_objects, nanoem_f32_t *values);
+    typedef void(APIENTRY *PFN_nanoemPhysicsMotionStateGetAllCurrentWorldTransforms)(
+        nanoem_physics_motion_state_t *const *motion_states, nanoem_rsize_t num_objects, nanoem_f32_t *values);
+    typedef void(APIENTRY *PFN_nanoemPhysicsMotionStateSetAllCurrentWorldTransforms)(
+        nanoem_physics_motion_state_t *const *motion_states, nanoem_rsize_t num_objects, const nanoem_f32_t *values);
+    typedef void(APIENTRY *PFN_nanoemPhysicsSoftBodyGetAllVertexPositions)(
+        const nanoem_physics_soft_body_t *soft_body, nanoem_f32_t *values);
+    typedef void(APIENTRY *PFN_nanoemPhysicsSoftBodyGetAllVertexNormals)(
+        const nanoem_physics_soft_body_t *soft_body, nanoem_f32_t *values);
+    typedef void(APIENTRY *PFN_nanoemPhysicsSoftBodySetAllVertexPositions)(nanoem_physics_soft_body_t *soft_body,
+        const int *offsets, nanoem_rsize_t num_offsets, const nanoem_f32_t *values);
+    typedef void(APIENTRY *PFN_nanoemPhysicsSoftBodySetAllVertexNormals)(nanoem_physics_soft_body_t *soft_body,
+        const int *offsets, nanoem_rsize_t num_offsets, const nanoem_f32_t *values);
     typedef nanoem_bool_t(APIENTRY *PFN_nanoemPhysicsSoftBodyIsVisualizeEnabled)(
         const nanoem_physics_soft_body_t *soft_body);
     typedef void(APIENTRY *PFN_nanoemPhysicsSoftBodySetVisualizeEnabled)(
@@ -162,6 +177,9 @@ struct PhysicsEngine::PrivateContext {
         , motionStateSetCurrentWorldTransform(nullptr)
         , motionStateGetCenterOfMassOffset(nullptr)
         , motionStateSetCenterOfMassOffset(nullptr)
+        , motionStateGetAllInitialWorldTransforms(nullptr)
+        , motionStateGetAllCurrentWorldTransforms(nullptr)
+        , motionStateSetAllCurrentWorldTransforms(nullptr)
         , jointCreate(nullptr)
         , jointGetCalculatedTransformA(nullptr)
         , jointGetCalculatedTransformB(nullptr)
@@ -184,6 +202,10 @@ struct PhysicsEngine::PrivateContext {
         , softBodyGetVertexNormal(nullptr)
         , softBodySetVertexPosition(nullptr)
         , softBodySetVertexNormal(nullptr)
+        , softBodyGetAllVertexPositions(nullptr)
+        , softBodyGetAllVertexNormals(nullptr)
+        , softBodySetAllVertexPositions(nullptr)
+        , softBodySetAllVertexNormals(nullptr)
         , softBodyIsVisualizeEnabled(nullptr)
         , softBodySetVisualizeEnabled(nullptr)
     {
@@ -257,6 +279,21 @@ struct PhysicsEngine::PrivateContext {
             resolveSymbol(opaque, "nanoemPhysicsSoftBodyDestroy", softBodyDestroy, valid);
             resolveSymbol(opaque, "nanoemPhysicsWorldAddSoftBody", worldAddSoftBody, valid);
             resolveSymbol(opaque, "nanoemPhysicsWorldRemoveSoftBody", worldRemoveSoftBody, valid);
+            /* bulk entry points are optional and fall back to per object ones when the plugin lacks them */
+            bool bulkValid = true;
+            resolveSymbol(opaque, "nanoemPhysicsMotionStateGetAllInitialWorldTransforms",
+                motionStateGetAllInitialWorldTransforms, bulkValid);
+            resolveSymbol(opaque, "nanoemPhysicsMotionStateGetAllCurrentWorldTransforms",
+                motionStateGetAllCurrentWorldTransforms, bulkValid);
+            resolveSymbol(opaque, "nanoemPhysicsMotionStateSetAllCurrentWorldTransforms",
+                motionStateSetAllCurrentWorldTransforms, bulkValid);
+            resolveSymbol(
+                opaque, "nanoemPhysicsSoftBodyGetAllVertexPositions", softBodyGetAllVertexPositions, bulkValid);
+            resolveSymbol(opaque, "nanoemPhysicsSoftBodyGetAllVertexNormals", softBodyGetAllVertexNormals, bulkValid);
+            resolveSymbol(
+                opaque, "nanoemPhysicsSoftBodySetAllVertexPositions", softBodySetAllVertexPositions, bulkValid);
+            resolveSymbol(
+                opaque, "nanoemPhysicsSoftBodySetAllVertexNormals", softBodySetAllVertexNormals, bulkValid);
             bx::dlclose(opaque);
         }
         return valid;
@@ -286,6 +323,9 @@ struct PhysicsEngine::PrivateContext {
         motionStateSetCurrentWorldTransform = nanoemPhysicsMotionStateSetCurrentWorldTransform;
         motionStateGetCenterOfMassOffset = nanoemPhysicsMotionStateGetCenterOfMassOffset;
         motionStateSetCenterOfMassOffset = nanoemPhysicsMotionStateSetCenterOfMassOffset;
+        motionStateGetAllInitialWorldTransforms = nanoemPhysicsMotionStateGetAllInitialWorldTransforms;
+        motionStateGetAllCurrentWorldTransforms = nanoemPhysicsMotionStateGetAllCurrentWorldTransforms;
+        motionStateSetAllCurrentWorldTransforms = nanoemPhysicsMotionStateSetAllCurrentWorldTransforms;
         rigidBodyCreate = nanoemPhysicsRigidBodyCreate;
         rigidBodyGetMotionState = nanoemPhysicsRigidBodyGetMotionState;
         rigidBodyGetWorldTransform = nanoemPhysicsRigidBodyGetWorldTransform;
@@ -323,6 +363,10 @@ struct PhysicsEngine::PrivateContext {
         softBodyGetVertexNormal = nanoemPhysicsSoftBodyGetVertexNormal;
         softBodySetVertexPosition = nanoemPhysicsSoftBodySetVertexPosition;
         softBodySetVertexNormal = nanoemPhysicsSoftBodySetVertexNormal;
+        softBodyGetAllVertexPositions = nanoemPhysicsSoftBodyGetAllVertexPositions;
+        softBodyGetAllVertexNormals = nanoemPhysicsSoftBodyGetAllVertexNormals;
+        softBodySetAllVertexPositions = nanoemPhysicsSoftBodySetAllVertexPositions;
+        softBodySetAllVertexNormals = nanoemPhysicsSoftBodySetAllVertexNormals;
         softBodyIsVisualizeEnabled = nanoemPhysicsSoftBodyIsVisualizeEnabled;
         softBodySetVisualizeEnabled = nanoemPhysicsSoftBodySetVisualizeEnabled;
         return true;
@@ -375,6 +419,9 @@ struct PhysicsEngine::PrivateContext {
     PFN_nanoemPhysicsMotionStateSetCurrentWorldTransform motionStateSetCurrentWorldTransform;
     PFN_nanoemPhysicsMotionStateGetCenterOfMassOffset motionStateGetCenterOfMassOffset;
     PFN_nanoemPhysicsMotionStateSetCenterOfMassOffset motionStateSetCenterOfMassOffset;
+    PFN_nanoemPhysicsMotionStateGetAllInitialWorldTransforms motionStateGetAllInitialWorldTransforms;
+    PFN_nanoemPhysicsMotionStateGetAllCurrentWorldTransforms motionStateGetAllCurrentWorldTransforms;
+    PFN_nanoemPhysicsMotionStateSetAllCurrentWorldTransforms motionStateSetAllCurrentWorldTransforms;
     PFN_nanoemPhysicsJointCreate jointCreate;
     PFN_nanoemPhysicsJointGetCalculatedTransformA jointGetCalculatedTransformA;
     PFN_nanoemPhysicsJointGetCalculatedTransformB jointGetCalculatedTransformB;
@@ -397,6 +444,10 @@ struct PhysicsEngine::PrivateContext {
     PFN_nanoemPhysicsSoftBodyGetVertexNormal softBodyGetVertexNormal;
     PFN_nanoemPhysicsSoftBodySetVertexPosition softBodySetVertexPosition;
     PFN_nanoemPhysicsSoftBodySetVertexNormal softBodySetVertexNormal;
+    PFN_nanoemPhysicsSoftBodyGetAllVertexPositions softBodyGetAllVertexPositions;
+    PFN_nanoemPhysicsSoftBodyGetAllVertexNormals softBodyGetAllVertexNormals;
+    PFN_nanoemPhysicsSoftBodySetAllVertexPositions softBodySetAllVertexPositions;
+    PFN_nanoemPhysicsSoftBodySetAllVertexNormals softBodySetAllVertexNormals;
     PFN_nanoemPhysicsSoftBodyIsVisualizeEnabled softBodyIsVisualizeEnabled;
     PFN_nanoemPhysicsSoftBodySetVisualizeEnabled softBodySetVisualizeEnabled;
 };
@@ -446,6 +497,7 @@ PhysicsEngine::reset() NANOEM_DECL_NOEXCEPT
 void
 PhysicsEngine::stepSimulation(nanoem_f32_t delta)
 {
+    EMAPP_PROFILE_SCOPE("PhysicsEngine::stepSimulation");
     m_context->worldStepSimulation(m_context->m_opaque, delta);
 }
 
@@ -664,6 +716,62 @@ PhysicsEngine::setSoftBodyVertexNormal(nanoem_physics_soft_body_t *body, int off
     m_context->softBodySetVertexNormal(body, offset, value);
 }
 
+void
+PhysicsEngine::getAllSoftBodyVertexPositions(
+    const nanoem_physics_soft_body_t *body, nanoem_f32_t *values) const NANOEM_DECL_NOEXCEPT
+{
+    if (m_context->softBodyGetAllVertexPositions) {
+        m_context->softBodyGetAllVertexPositions(body, values);
+    }
+    else {
+        for (int i = 0, numVertices = m_context->softBodyGetNumVertexObjects(body); i < numVertices; i++) {
+            m_context->softBodyGetVertexPosition(body, i, values + i * 4);
+        }
+    }
+}
+
+void
+PhysicsEngine::getAllSoftBodyVertexNormals(
+    const nanoem_physics_soft_body_t *body, nanoem_f32_t *values) const NANOEM_DECL_NOEXCEPT
+{
+    if (m_context->softBodyGetAllVertexNormals) {
+        m_context->softBodyGetAllVertexNormals(body, values);
+    }
+    else {
+        for (int i = 0, numVertices = m_context->softBodyGetNumVertexObjects(body); i < numVertices; i++) {
+            m_context->softBodyGetVertexNormal(body, i, values + i * 4);
+        }
+    }
+}
+
+void
+PhysicsEngine::setAllSoftBodyVertexPositions(
+    nanoem_physics_soft_body_t *body, const int *offsets, nanoem_rsize_t numOffsets, const nanoem_f32_t *values)
+{
+    if (m_context->softBodySetAllVertexPositions) {
+        m_context->softBodySetAllVertexPositions(body, offsets, numOffsets, values);
+    }
+    else {
+        for (nanoem_rsize_t i = 0; i < numOffsets; i++) {
+            m_context->softBodySetVertexPosition(body, offsets ? offsets[i] : int(i), values + i * 4);
+        }
+    }
+}
+
+void
+PhysicsEngine::setAllSoftBodyVertexNormals(
+    nanoem_physics_soft_body_t *body, const int *offsets, nanoem_rsize_t numOffsets, const nanoem_f32_t *values)
+{
+    if (m_context->softBodySetAllVertexNormals) {
+        m_context->softBodySetAllVertexNormals(body, offsets, numOffsets, values);
+    }
+    else {
+        for (nanoem_rsize_t i = 0; i < numOffsets; i++) {
+            m_context->softBodySetVertexNormal(body, offsets ? offsets[i] : int(i), values + i * 4);
+        }
+    }
+}
+
 Vector3
 PhysicsEngine::direction() const NANOEM_DECL_NOEXCEPT
 {
@@ -816,6 +924,48 @@ PhysicsEngine::setWorldTransform(nanoem_physics_motion_state_t *state, const nan
     m_context->motionStateSetCurrentWorldTransform(state, value);
 }
 
+void
+PhysicsEngine::getAllInitialTransforms(nanoem_physics_motion_state_t *const *states, nanoem_rsize_t numStates,
+    nanoem_f32_t *values) const NANOEM_DECL_NOEXCEPT
+{
+    if (m_context->motionStateGetAllInitialWorldTransforms) {
+        m_context->motionStateGetAllInitialWorldTransforms(states, numStates, values);
+    }
+    else {
+        for (nanoem_rsize_t i = 0; i < numStates; i++) {
+            m_context->motionStateGetInitialWorldTransform(states[i], values + i * 16);
+        }
+    }
+}
+
+void
+PhysicsEngine::getAllWorldTransforms(nanoem_physics_motion_state_t *const *states, nanoem_rsize_t numStates,
+    nanoem_f32_t *values) const NANOEM_DECL_NOEXCEPT
+{
+    if (m_context->motionStateGetAllCurrentWorldTransforms) {
+        m_context->motionStateGetAllCurrentWorldTransforms(states, numStates, values);
+    }
+    else {
+        for (nanoem_rsize_t i = 0; i < numStates; i++) {
+            m_context->motionStateGetCurrentWorldTransform(states[i], values + i * 16);
+        }
+    }
+}
+
+void
+PhysicsEngine::setAllWorldTransforms(
+    nanoem_physics_motion_state_t *const *states, nanoem_rsize_t numStates, const nanoem_f32_t *values)
+{
+    if (m_context->motionStateSetAllCurrentWorldTransforms) {
+        m_context->motionStateSetAllCurrentWorldTransforms(states, numStates, values);
+    }
+    else {
+        for (nanoem_rsize_t i = 0; i < numStates; i++) {
+            m_context->motionStateSetCurrentWorldTransform(states[i], values + i * 16);
+        }
+    }
+}
+
 void
 PhysicsEngine::getCenterOfMassOffset(
     const nanoem_physics_motion_state_t *state, nanoem_f32_t *value) NANOEM_DECL_NOEXCEPT
@@ -0,0 +1,207 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/Profiler.h"
+
+#include "emapp/Error.h"
+#include "emapp/FileUtils.h"
+#include "emapp/StringUtils.h"
+#include "emapp/URI.h"
+#include "emapp/private/CommonInclude.h"
+
+#include "bx/mutex.h"
+#include "sokol/sokol_time.h"
+
+#include <atomic>
+
+namespace nanoem {
+
+struct Profiler::Event {
+    const char *m_name;
+    nanoem_u64_t m_start;
+    nanoem_u64_t m_duration;
+};
+
+struct Profiler::ThreadBuffer {
+    ThreadBuffer(nanoem_u32_t threadID)
+        : m_events(kNumRingBufferEvents)
+        , m_numEvents(0)
+        , m_threadID(threadID)
+    {
+    }
+    tinystl::vector<Event, TinySTLAllocator> m_events;
+    nanoem_u64_t m_numEvents;
+    nanoem_u32_t m_threadID;
+};
+
+namespace {
+
+typedef tinystl::vector<Profiler::ThreadBuffer *, TinySTLAllocator> ThreadBufferList;
+
+static const nanoem_rsize_t kMaxChunkSize = 0x10000;
+
+static bx::Mutex s_mutex;
+static ThreadBufferList s_threadBuffers;
+/*
+ * a scope closing while terminate runs may still write to the buffer it already fetched, so buffers are retired on
+ * terminate and destroyed on the next one instead of being destroyed immediately
+ */
+static ThreadBufferList s_retiredThreadBuffers;
+/* bumped on terminate so each thread drops its pointer to the retired buffer */
+static std::atomic<nanoem_u32_t> s_generation(1);
+/* toggled from the UI thread while the other threads open and close scopes */
+static std::atomic<bool> s_enabled(false);
+static BX_THREAD_LOCAL void *t_threadBuffer = nullptr;
+static BX_THREAD_LOCAL nanoem_u32_t t_generation = 0;
+
+static void
+appendEscapedString(const char *value, String &output)
+{
+    for (const char *ptr = value; *ptr; ptr++) {
+        const char c = *ptr;
+        if (c == '"' || c == '\\') {
+            output.append("\\");
+            output.append(ptr, ptr + 1);
+        }
+        else if (static_cast<nanoem_u8_t>(c) >= 0x20) {
+            output.append(ptr, ptr + 1);
+        }
+    }
+}
+
+static bool
+flushChunk(IWriter *writer, String &chunk, bool force, Error &error)
+{
+    if (force || chunk.size() >= kMaxChunkSize) {
+        FileUtils::write(writer, chunk, error);
+        chunk.clear();
+    }
+    return !error.hasReason();
+}
+
+} /* namespace anonymous */
+
+const nanoem_rsize_t Profiler::kNumRingBufferEvents = 0x10000;
+
+Profiler::Scope::Scope(const char *name) NANOEM_DECL_NOEXCEPT : m_name(name), m_start(0)
+{
+    if (nanoem_unlikely(s_enabled.load(std::memory_order_relaxed))) {
+        m_start = stm_now();
+    }
+}
+
+Profiler::Scope::~Scope() NANOEM_DECL_NOEXCEPT
+{
+    if (nanoem_unlikely(s_enabled.load(std::memory_order_relaxed) && m_start != 0)) {
+        if (ThreadBuffer *buffer = currentThreadBuffer()) {
+            Event &event = buffer->m_events[buffer->m_numEvents % kNumRingBufferEvents];
+            event.m_name = m_name;
+            event.m_start = m_start;
+            event.m_duration = stm_since(m_start);
+            buffer->m_numEvents++;
+        }
+    }
+}
+
+bool
+Profiler::isEnabled() NANOEM_DECL_NOEXCEPT
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+void
+Profiler::setEnabled(bool value)
+{
+    s_enabled.store(value, std::memory_order_relaxed);
+}
+
+void
+Profiler::clear() NANOEM_DECL_NOEXCEPT
+{
+    bx::MutexScope locker(s_mutex);
+    for (ThreadBufferList::const_iterator it = s_threadBuffers.begin(), end = s_threadBuffers.end(); it != end;
+         ++it) {
+        (*it)->m_numEvents = 0;
+    }
+}
+
+void
+Profiler::terminate()
+{
+    bx::MutexScope locker(s_mutex);
+    s_enabled = false;
+    for (ThreadBufferList::const_iterator it = s_retiredThreadBuffers.begin(), end = s_retiredThreadBuffers.end();
+         it != end; ++it) {
+        nanoem_delete(*it);
+    }
+    s_retiredThreadBuffers = s_threadBuffers;
+    s_threadBuffers.clear();
+    s_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+bool
+Profiler::exportChromeTrace(IWriter *writer, Error &error)
+{
+    bx::MutexScope locker(s_mutex);
+    String chunk;
+    char buffer[128];
+    bool first = true;
+    chunk.append("{\"traceEvents\":[");
+    for (ThreadBufferList::const_iterator it = s_threadBuffers.begin(), end = s_threadBuffers.end();
+         it != end && !error.hasReason(); ++it) {
+        const ThreadBuffer *threadBuffer = *it;
+        const nanoem_u64_t numEvents = threadBuffer->m_numEvents,
+                           offset = numEvents > kNumRingBufferEvents ? numEvents - kNumRingBufferEvents : 0;
+        /* events are recorded on scope exit so the oldest ones in the ring are emitted first */
+        for (nanoem_u64_t i = offset; i < numEvents && flushChunk(writer, chunk, false, error); i++) {
+            const Event &event = threadBuffer->m_events[i % kNumRingBufferEvents];
+            chunk.append(first ? "\n" : ",\n");
+            chunk.append("{\"name\":\"");
+            appendEscapedString(event.m_name, chunk);
+            StringUtils::format(buffer, sizeof(buffer),
+                "\",\"cat\":\"emapp\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                stm_us(event.m_start), stm_us(event.m_duration), threadBuffer->m_threadID);
+            chunk.append(buffer);
+            first = false;
+        }
+    }
+    chunk.append("\n],\"displayTimeUnit\":\"ms\"}\n");
+    return flushChunk(writer, chunk, true, error);
+}
+
+bool
+Profiler::exportChromeTrace(const URI &fileURI, Error &error)
+{
+    FileWriterScope scope;
+    bool succeeded = false;
+    if (scope.open(fileURI, error)) {
+        if (exportChromeTrace(scope.writer(), error)) {
+            scope.commit(error);
+            succeeded = !error.hasReason();
+        }
+        else {
+            scope.rollback(error);
+        }
+    }
+    return succeeded;
+}
+
+Profiler::ThreadBuffer *
+Profiler::currentThreadBuffer()
+{
+    ThreadBuffer *buffer = static_cast<ThreadBuffer *>(t_threadBuffer);
+    if (nanoem_unlikely(!buffer || t_generation != s_generation.load(std::memory_order_acquire))) {
+        bx::MutexScope locker(s_mutex);
+        buffer = nanoem_new(ThreadBuffer(Inline::saturateInt32U(s_threadBuffers.size() + 1)));
+        s_threadBuffers.push_back(buffer);
+        t_threadBuffer = buffer;
+        /* read under the lock so the new buffer is never tagged with a generation already retired */
+        t_generation = s_generation.load(std::memory_order_relaxed);
+    }
+    return buffer;
+}
+
+} /* namespace nanoem */
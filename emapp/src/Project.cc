@@ -34,6 +34,7 @@
 #include "emapp/PhysicsEngine.h"
 #include "emapp/PixelFormat.h"
 #include "emapp/PluginFactory.h"
+#include "emapp/Profiler.h"
 #include "emapp/Progress.h"
 #include "emapp/ShadowCamera.h"
 #include "emapp/StringUtils.h"
@@ -41,9 +42,13 @@
 #include "emapp/command/BatchUndoCommandListCommand.h"
 #include "emapp/command/MotionSnapshotCommand.h"
 #include "emapp/command/TransformBoneCommand.h"
+#include "emapp/effect/GlobalUniform.h"
 #include "emapp/internal/BlitPass.h"
 #include "emapp/internal/ClearPass.h"
 #include "emapp/internal/DebugDrawer.h"
+#include "emapp/internal/DrawCommandScheduler.h"
+#include "emapp/internal/FileContentDigestCache.h"
+#include "emapp/internal/FrustumCuller.h"
 #include "emapp/internal/project/Archive.h"
 #include "emapp/internal/project/JSON.h"
 #include "emapp/internal/project/Native.h"
@@ -281,6 +286,12 @@ compareOffscreenRenderTargetOption(const void *left, const void *right)
     return result;
 }
 
+static bool
+isRenderPipelineValid(sg_pipeline pipeline)
+{
+    return sg::query_pipeline_state(pipeline) == SG_RESOURCESTATE_VALID;
+}
+
 static const Vector2UI16 kDefaultViewportImageSize = Vector2UI16(640, 360);
 static const nanoem_u32_t kTimeBasedAudioSourceDefaultSampleRate = 1440;
 
@@ -350,6 +361,18 @@ struct Project::DrawQueue {
         }
     };
     typedef tinystl::vector<PassCommandBuffer, TinySTLAllocator> PassCommandBufferList;
+    struct Executor : internal::DrawCommandScheduler::IExecutor {
+        Executor(const PassCommandBuffer *pass, Project *project);
+        bool applyPipeline(sg_pipeline pipeline) NANOEM_DECL_OVERRIDE;
+        void applyBindings(const sg_bindings &bindings) NANOEM_DECL_OVERRIDE;
+        void applyViewport(int x, int y, int width, int height) NANOEM_DECL_OVERRIDE;
+        void applyScissorRect(int x, int y, int width, int height) NANOEM_DECL_OVERRIDE;
+        void applyUniformBlock(sg_shader_stage stage, const void *data, nanoem_rsize_t size) NANOEM_DECL_OVERRIDE;
+        void draw(int offset, int count) NANOEM_DECL_OVERRIDE;
+        void invokeCallback(sg::PassBlock::Callback callback, void *userData) NANOEM_DECL_OVERRIDE;
+        const PassCommandBuffer *m_pass;
+        Project *m_project;
+    };
 
     static void applyPipelineBindings(CommandBuffer &buffer, sg_pipeline pipeline, const sg_bindings &bindings);
     static void applyViewport(CommandBuffer &buffer, int x, int y, int width, int height);
@@ -358,19 +381,86 @@ struct Project::DrawQueue {
     static void applyUniformBlock(CommandBuffer &buffer, sg_shader_stage stage, const void *data, nanoem_rsize_t size);
     static void draw(CommandBuffer &buffer, int offset, int count);
     static void registerCallback(CommandBuffer &buffer, sg::PassBlock::Callback callback, void *userData);
-    static void drawPass(const PassCommandBuffer *pass, Project *project, bx::HashMurmur2A &hasher);
 
     DrawQueue();
     ~DrawQueue() NANOEM_DECL_NOEXCEPT;
 
     size_t size() const NANOEM_DECL_NOEXCEPT;
+    void drawPass(const PassCommandBuffer *pass, Project *project);
     void flush(Project *project);
 
     Project *m_project;
     PassCommandBufferList m_commandBuffers;
+    internal::DrawCommandScheduler m_scheduler;
     int m_counts;
 };
 
+Project::DrawQueue::Executor::Executor(const PassCommandBuffer *pass, Project *project)
+    : m_pass(pass)
+    , m_project(project)
+{
+}
+
+bool
+Project::DrawQueue::Executor::applyPipeline(sg_pipeline pipeline)
+{
+    SG_INSERT_MARKERF("Project::DrawQueue::Executor::applyPipeline(pipeline=%d, name=%s)", pipeline.id,
+        m_project->findRenderPipelineName(pipeline));
+#if defined(NANOEM_ENABLE_DEBUG_LABEL)
+    char buffer[Inline::kMarkerStringLength];
+    StringUtils::format(buffer, sizeof(buffer), "Project::DrawQueue::Executor::applyPipeline(pass=%s, name=%s)",
+        m_project->findRenderPassName(m_pass->m_handle), m_project->findRenderPipelineName(pipeline));
+#endif /* NANOEM_ENABLE_DEBUG_LABEL */
+    const bool valid = sg::query_pipeline_state(pipeline) == SG_RESOURCESTATE_VALID;
+    if (valid) {
+        sg::apply_pipeline(pipeline);
+    }
+    return valid;
+}
+
+void
+Project::DrawQueue::Executor::applyBindings(const sg_bindings &bindings)
+{
+    sg::apply_bindings(&bindings);
+}
+
+void
+Project::DrawQueue::Executor::applyViewport(int x, int y, int width, int height)
+{
+    SG_INSERT_MARKERF(
+        "Project::DrawQueue::Executor::applyViewport(x=%d, y=%d, width=%d, height=%d)", x, y, width, height);
+    sg::apply_viewport(x, y, width, height, true);
+}
+
+void
+Project::DrawQueue::Executor::applyScissorRect(int x, int y, int width, int height)
+{
+    SG_INSERT_MARKERF(
+        "Project::DrawQueue::Executor::applyScissorRect(x=%d, y=%d, width=%d, height=%d)", x, y, width, height);
+    sg::apply_scissor_rect(x, y, width, height, true);
+}
+
+void
+Project::DrawQueue::Executor::applyUniformBlock(sg_shader_stage stage, const void *data, nanoem_rsize_t size)
+{
+    SG_INSERT_MARKERF("Project::DrawQueue::Executor::applyUniformBlock(stage=%d, size=%d)", stage, size);
+    sg::apply_uniforms(stage, 0, data, Inline::saturateInt32(size));
+}
+
+void
+Project::DrawQueue::Executor::draw(int offset, int count)
+{
+    SG_INSERT_MARKERF("Project::DrawQueue::Executor::draw(offset=%d, count=%d)", offset, count);
+    sg::draw(offset, count, 1);
+}
+
+void
+Project::DrawQueue::Executor::invokeCallback(sg::PassBlock::Callback callback, void *userData)
+{
+    SG_INSERT_MARKER("Project::DrawQueue::Executor::invokeCallback()");
+    callback(m_pass->m_handle, userData);
+}
+
 void
 Project::DrawQueue::applyPipelineBindings(
     DrawQueue::CommandBuffer &buffer, sg_pipeline pipeline, const sg_bindings &bindings)
@@ -459,7 +549,7 @@ Project::DrawQueue::registerCallback(CommandBuffer &buffer, sg::PassBlock::Callb
 }
 
 void
-Project::DrawQueue::drawPass(const DrawQueue::PassCommandBuffer *pass, Project *project, bx::HashMurmur2A &hasher)
+Project::DrawQueue::drawPass(const DrawQueue::PassCommandBuffer *pass, Project *project)
 {
     BX_UNUSED_1(project);
     SG_PUSH_GROUPF(
@@ -481,99 +571,54 @@ Project::DrawQueue::drawPass(const DrawQueue::PassCommandBuffer *pass, Project *
     SG_INSERT_MARKERF("Project::DrawQueue::beginPass(color=%s, depth=%s, stencil=%s, batch=%s)",
         EnumStringifyUtils::toString(pa.colors[0].action), EnumStringifyUtils::toString(pa.depth.action),
         EnumStringifyUtils::toString(pa.stencil.action), pass->m_batch ? "true" : "false");
-    nanoem_u32_t lastDrawPassHash = 0;
-    bool pipelineApplied = false;
-    hasher.begin();
+    m_scheduler.begin();
     for (CommandBuffer::const_iterator it2 = pass->m_items->begin() + 1, end2 = pass->m_items->end(); it2 != end2;
          ++it2) {
         const Command &item = *it2;
         switch (item.m_type) {
         case kCommandTypeApplyPipelineBinding: {
-            SG_INSERT_MARKERF("Project::DrawQueue::drawPass(index=%d, type=kCommandTypeApplyPipelineBinding, "
-                              "pipeline=%d, name=%s)",
-                it2 - pass->m_items->begin(), item.u.m_pb.m_pipeline.id,
-                project->findRenderPipelineName(item.u.m_pb.m_pipeline));
-#if defined(NANOEM_ENABLE_DEBUG_LABEL)
-            char buffer[Inline::kMarkerStringLength];
-            StringUtils::format(buffer, sizeof(buffer),
-                "Project::DrawQueue::drawPass(pass=%s, index=%lu, type=kCommandTypeApplyPipelineBinding, name=%s)",
-                project->findRenderPassName(pass->m_handle), it2 - pass->m_items->begin(),
-                project->findRenderPipelineName(item.u.m_pb.m_pipeline));
-#endif /* NANOEM_ENABLE_DEBUG_LABEL */
-            const sg_pipeline pipeline = item.u.m_pb.m_pipeline;
-            if (sg::query_pipeline_state(pipeline) == SG_RESOURCESTATE_VALID) {
-                sg::apply_pipeline(pipeline);
-                sg::apply_bindings(&item.u.m_pb.m_bindings);
-                hasher.add(item.u.m_pb);
-                pipelineApplied = true;
-            }
+            m_scheduler.applyPipelineBindings(item.u.m_pb.m_pipeline, item.u.m_pb.m_bindings);
             break;
         }
         case kCommandTypeApplyViewport: {
-            SG_INSERT_MARKERF("Project::DrawQueue::drawPass(index=%d, type=kCommandTypeApplyViewport, x=%d, y=%d, "
-                              "width=%d, height=%d)",
-                it2 - pass->m_items->begin(), item.u.m_rect.m_x, item.u.m_rect.m_y, item.u.m_rect.m_width,
-                item.u.m_rect.m_height);
-            sg::apply_viewport(
-                item.u.m_rect.m_x, item.u.m_rect.m_y, item.u.m_rect.m_width, item.u.m_rect.m_height, true);
-            hasher.add(item.u.m_rect);
+            m_scheduler.applyViewport(
+                item.u.m_rect.m_x, item.u.m_rect.m_y, item.u.m_rect.m_width, item.u.m_rect.m_height);
             break;
         }
         case kCommandTypeApplyScissorRect: {
-            SG_INSERT_MARKERF("Project::DrawQueue::drawPass(index=%d, type=kCommandTypeApplyScissorRect, x=%d, y=%d, "
-                              "width=%d, height=%d)",
-                it2 - pass->m_items->begin(), item.u.m_rect.m_x, item.u.m_rect.m_y, item.u.m_rect.m_width,
-                item.u.m_rect.m_height);
-            sg::apply_scissor_rect(
-                item.u.m_rect.m_x, item.u.m_rect.m_y, item.u.m_rect.m_width, item.u.m_rect.m_height, true);
-            hasher.add(item.u.m_rect);
+            m_scheduler.applyScissorRect(
+                item.u.m_rect.m_x, item.u.m_rect.m_y, item.u.m_rect.m_width, item.u.m_rect.m_height);
             break;
         }
         case kCommandTypeApplyUniformBlockVertex: {
-            SG_INSERT_MARKERF(
-                "Project::DrawQueue::drawPass(index=%d, type=kCommandTypeApplyUniformBlockVertex, size=%d)",
-                it2 - pass->m_items->begin(), item.u.m_ub.m_size);
-            nanoem_u8_t *data = item.u.m_ub.m_data;
-            int size = Inline::saturateInt32(item.u.m_ub.m_size);
-            sg::apply_uniforms(SG_SHADERSTAGE_VS, 0, data, size);
-            hasher.add(data, size);
-            delete[] data;
+            m_scheduler.applyUniformBlock(SG_SHADERSTAGE_VS, item.u.m_ub.m_data, item.u.m_ub.m_size);
             break;
         }
         case kCommandTypeApplyUniformBlockFragment: {
-            SG_INSERT_MARKERF(
-                "Project::DrawQueue::drawPass(index=%d, type=kCommandTypeApplyUniformBlockFragment, size=%d)",
-                it2 - pass->m_items->begin(), item.u.m_ub.m_size);
-            nanoem_u8_t *data = item.u.m_ub.m_data;
-            int size = Inline::saturateInt32(item.u.m_ub.m_size);
-            sg::apply_uniforms(SG_SHADERSTAGE_FS, 0, data, size);
-            hasher.add(data, size);
-            delete[] data;
+            m_scheduler.applyUniformBlock(SG_SHADERSTAGE_FS, item.u.m_ub.m_data, item.u.m_ub.m_size);
             break;
         }
         case kCommandTypeDraw: {
-            SG_INSERT_MARKERF("Project::DrawQueue::drawPass(index=%d, type=kCommandTypeDraw, offset=%d, count=%d)",
-                it2 - pass->m_items->begin(), item.u.m_draw.m_offset, item.u.m_draw.m_count);
-            hasher.add(item.u.m_draw);
-            nanoem_u32_t drawPassHash = hasher.end();
-            hasher.begin();
-            if (pipelineApplied && lastDrawPassHash != drawPassHash) {
-                sg::draw(item.u.m_draw.m_offset, item.u.m_draw.m_count, 1);
-                lastDrawPassHash = drawPassHash;
-                pipelineApplied = false;
-            }
+            m_scheduler.draw(item.u.m_draw.m_offset, item.u.m_draw.m_count);
             break;
         }
         case kCommandTypeCallback: {
-            SG_INSERT_MARKERF(
-                "Project::DrawQueue::drawPass(index=%d, type=kCommandTypeCallback)", it2 - pass->m_items->begin());
-            item.u.m_callback.m_func(pass->m_handle, item.u.m_callback.m_opaque);
+            m_scheduler.registerCallback(item.u.m_callback.m_func, item.u.m_callback.m_opaque);
             break;
         }
         default:
             break;
         }
     }
+    Executor executor(pass, project);
+    m_scheduler.execute(&executor);
+    for (CommandBuffer::const_iterator it2 = pass->m_items->begin() + 1, end2 = pass->m_items->end(); it2 != end2;
+         ++it2) {
+        const CommandType type = it2->m_type;
+        if (type == kCommandTypeApplyUniformBlockVertex || type == kCommandTypeApplyUniformBlockFragment) {
+            delete[] it2->u.m_ub.m_data;
+        }
+    }
     sg::end_pass();
     SG_INSERT_MARKER("Project::DrawQueue::endPass()");
     SG_POP_GROUP();
@@ -602,12 +647,14 @@ Project::DrawQueue::size() const NANOEM_DECL_NOEXCEPT
 void
 Project::DrawQueue::flush(Project *project)
 {
-    bx::HashMurmur2A hasher;
+    m_scheduler.resetStatistics();
+    /* pipelines are destroyed without notifying the project when effects or program bundles are released */
+    m_scheduler.removeAllInvalidPipelines(isRenderPipelineValid);
     for (PassCommandBufferList::const_iterator it = m_commandBuffers.begin(), end = m_commandBuffers.end(); it != end;
          ++it) {
         const sg_pass pass = it->m_handle;
         if (sg::query_pass_state(pass) == SG_RESOURCESTATE_VALID) {
-            drawPass(it, project, hasher);
+            drawPass(it, project);
         }
         else {
             SG_INSERT_MARKERF("[WARN] The pass \"%s\" (%d) was skipped", project->findRenderPassName(pass), pass.id);
@@ -1229,6 +1276,8 @@ Project::Project(const Injector &injector)
     , m_sharedImageBlitter(nullptr)
     , m_renderPassCleaner(nullptr)
     , m_sharedDebugDrawer(nullptr)
+    , m_frustumCuller(nullptr)
+    , m_fileContentDigestCache(nullptr)
     , m_viewportPixelFormat(injector.m_pixelFormat, injector.m_pixelFormat)
     , m_drawType(IDrawable::kDrawTypeColor)
     , m_editingMode(kEditingModeNone)
@@ -1252,6 +1301,7 @@ Project::Project(const Injector &injector)
     , m_editingFPS(0)
     , m_boneInterpolationType(NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM)
     , m_cameraInterpolationType(NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM)
+    , m_motionClipboard(nullptr)
     , m_transformPerformedAt(Motion::kMaxFrameIndex, 0)
     , m_indicesOfMaterialToAttachEffect(bx::kInvalidHandle, ModelMaterialIndexSet())
     , m_windowDevicePixelRatio(injector.m_windowDevicePixelRatio, injector.m_windowDevicePixelRatio)
@@ -1268,6 +1318,8 @@ Project::Project(const Injector &injector)
     , m_coordinationSystem(GLM_LEFT_HANDED)
     , m_actualFPS(0)
     , m_actionSequence(0)
+    , m_objectBindingGeneration(1)
+    , m_offscreenRenderTargetPlansDirty(true)
     , m_active(false)
 {
     const bool topLeft = sg::query_features().origin_top_left;
@@ -1283,6 +1335,8 @@ Project::Project(const Injector &injector)
     m_renderPassBlitter = nanoem_new(internal::BlitPass(this, !topLeft));
     m_viewportPassBlitter = nanoem_new(internal::BlitPass(this, false));
     m_renderPassCleaner = nanoem_new(internal::ClearPass(this));
+    m_frustumCuller = nanoem_new(internal::FrustumCuller);
+    m_fileContentDigestCache = nanoem_new(internal::FileContentDigestCache(m_translator));
     m_drawQueue = nanoem_new(DrawQueue);
     m_drawQueue->m_project = this;
     m_batchDrawQueue = nanoem_new(BatchDrawQueue(m_drawQueue));
@@ -1336,6 +1390,8 @@ Project::~Project() NANOEM_DECL_NOEXCEPT
     nanoem_delete_safe(m_light);
     nanoem_delete_safe(m_physicsEngine);
     nanoem_delete_safe(m_sharedDebugDrawer);
+    nanoem_delete_safe(m_frustumCuller);
+    nanoem_delete_safe(m_fileContentDigestCache);
     nanoem_delete_safe(m_sharedImageLoader);
     nanoem_delete_safe(m_renderPassBlitter);
     nanoem_delete_safe(m_sharedImageBlitter);
@@ -1420,6 +1476,8 @@ Project::destroy() NANOEM_DECL_NOEXCEPT
     for (MotionList::const_iterator it = deletingMotions.begin(), end = deletingMotions.end(); it != end; ++it) {
         destroyMotion(*it);
     }
+    clearMotionClipboard();
+    m_modelClipboard.clear();
     EffectList deletingEffects;
     for (LoadedEffectSet::const_iterator it = m_loadedEffectSet.begin(), end = m_loadedEffectSet.end(); it != end;
          ++it) {
@@ -1809,6 +1867,21 @@ Project::containsMotion(const Motion *value) const NANOEM_DECL_NOEXCEPT
     return ListUtils::contains(const_cast<Motion *>(value), m_allMotions);
 }
 
+nanoem_u32_t
+Project::objectBindingGeneration() const NANOEM_DECL_NOEXCEPT
+{
+    return m_objectBindingGeneration;
+}
+
+void
+Project::invalidateAllObjectBindings() NANOEM_DECL_NOEXCEPT
+{
+    /* zero is reserved for bindings never resolved */
+    if (++m_objectBindingGeneration == 0) {
+        m_objectBindingGeneration = 1;
+    }
+}
+
 void
 Project::newModel(Error &error)
 {
@@ -1878,8 +1951,10 @@ Project::addModel(Model *model)
     }
     m_drawableOrderList.push_back(model);
     m_transformModelOrderList.push_back(model);
+    invalidateAllOffscreenRenderTargetPlans();
     m_allModelPtrs.push_back(model);
     addEffectOrderSet(model);
+    invalidateAllObjectBindings();
     eventPublisher()->publishAddModelEvent(model);
     Motion *motion = createMotion();
     undoStackClear(model->undoStack());
@@ -1893,7 +1968,9 @@ Project::addAccessory(Accessory *accessory)
     nanoem_parameter_assert(accessory, "must not be nullptr");
     m_drawableOrderList.push_back(accessory);
     m_allAccessoryPtrs.push_back(accessory);
+    invalidateAllOffscreenRenderTargetPlans();
     addEffectOrderSet(accessory);
+    invalidateAllObjectBindings();
     rebuildAllTracks();
     eventPublisher()->publishAddAccessoryEvent(accessory);
     Motion *motion = createMotion();
@@ -2132,6 +2209,7 @@ Project::removeModel(Model *model)
     }
     removeDrawable(model);
     ListUtils::removeItem(model, m_transformModelOrderList);
+    invalidateAllObjectBindings();
     IEventPublisher *publisher = eventPublisher();
     if (ListUtils::removeItem(model, m_allModelPtrs)) {
         MotionHashMap::iterator it2 = m_drawable2MotionPtrs.find(model);
@@ -2155,6 +2233,7 @@ Project::removeAccessory(Accessory *accessory)
         setActiveAccessory(nullptr);
     }
     removeDrawable(accessory);
+    invalidateAllObjectBindings();
     IEventPublisher *publisher = eventPublisher();
     if (ListUtils::removeItem(accessory, m_allAccessoryPtrs)) {
         MotionHashMap::iterator it2 = m_drawable2MotionPtrs.find(accessory);
@@ -2621,6 +2700,7 @@ Project::seek(nanoem_frame_index_t frameIndex, bool forceSeek)
 void
 Project::seek(nanoem_frame_index_t frameIndex, nanoem_f32_t amount, bool forceSeek)
 {
+    EMAPP_PROFILE_SCOPE("Project::seek");
     if (canSeek()) {
         if (forceSeek) {
             const nanoem_frame_index_t lastDuration = duration(), seekFrom = currentLocalFrameIndex();
@@ -2645,6 +2725,7 @@ Project::seek(nanoem_frame_index_t frameIndex, nanoem_f32_t amount, bool forceSe
 void
 Project::update()
 {
+    EMAPP_PROFILE_SCOPE("Project::update");
     SG_PUSH_GROUP("Project::update");
     if (isPlaying() && continuesPlaying()) {
         m_audioPlayer->update();
@@ -2845,6 +2926,12 @@ Project::setRenderPipelineName(sg_pipeline pipeline, const char *value)
     }
 }
 
+void
+Project::setRenderPipelineSortable(sg_pipeline pipeline, const sg_pipeline_desc &desc, const IPass *pass)
+{
+    m_drawQueue->m_scheduler.setPipelineSortable(pipeline, pass, internal::DrawCommandScheduler::isSortable(desc));
+}
+
 sg_image
 Project::sharedFallbackImage() const NANOEM_DECL_NOEXCEPT
 {
@@ -2891,11 +2978,33 @@ Project::sharedDebugDrawer()
     return m_sharedDebugDrawer;
 }
 
+const internal::FrustumCuller *
+Project::frustumCuller() const NANOEM_DECL_NOEXCEPT
+{
+    return m_frustumCuller;
+}
+
+internal::FrustumCuller *
+Project::frustumCuller() NANOEM_DECL_NOEXCEPT
+{
+    return m_frustumCuller;
+}
+
+internal::FileContentDigestCache *
+Project::fileContentDigestCache() NANOEM_DECL_NOEXCEPT
+{
+    return m_fileContentDigestCache;
+}
+
 void
 Project::drawAllOffscreenRenderTargets()
 {
+    EMAPP_PROFILE_SCOPE("Project::drawAllOffscreenRenderTargets");
     if (m_drawType == IDrawable::kDrawTypeColor && !m_allOffscreenRenderTargets.empty()) {
         SG_PUSH_GROUPF("Project::drawAllOffscreenRenderTargets(size=%d)", m_allOffscreenRenderTargets.size());
+        Matrix4x4 viewMatrix, projectionMatrix;
+        activeCamera()->getViewTransform(viewMatrix, projectionMatrix);
+        m_frustumCuller->setViewProjection(internal::FrustumCuller::kFrustumTypeCamera, projectionMatrix * viewMatrix);
         for (OffscreenRenderTargetConditionListMap::const_iterator it = m_allOffscreenRenderTargets.begin(),
                                                                    end = m_allOffscreenRenderTargets.end();
              it != end; ++it) {
@@ -2911,11 +3020,14 @@ Project::drawAllOffscreenRenderTargets()
 void
 Project::drawShadowMap()
 {
+    EMAPP_PROFILE_SCOPE("Project::drawShadowMap");
     if (isShadowMapEnabled()) {
         SG_PUSH_GROUP("Project::drawShadowMap");
         Matrix4x4 lightView, lightProjection;
         m_shadowCamera->getViewProjection(lightView, lightProjection);
         m_shadowCamera->clear();
+        /* zplot pass rasterizes with the light view projection without the crop matrix */
+        m_frustumCuller->setViewProjection(internal::FrustumCuller::kFrustumTypeShadowMap, lightProjection * lightView);
         if (m_editingMode != Project::kEditingModeSelect) {
             const nanoem_rsize_t numDrawables = m_drawableOrderList.size();
             const sg_pass pass = m_shadowCamera->pass();
@@ -2940,11 +3052,13 @@ Project::drawShadowMap()
 void
 Project::drawViewport()
 {
+    EMAPP_PROFILE_SCOPE("Project::drawViewport");
     if (nanoem_likely(sg::is_valid(m_viewportPrimaryPass.m_handle))) {
         SG_PUSH_GROUP("Project::drawViewport");
         const bool isDrawingColorType = m_drawType == IDrawable::kDrawTypeColor;
         Matrix4x4 viewMatrix, projectionMatrix;
         activeCamera()->getViewTransform(viewMatrix, projectionMatrix);
+        m_frustumCuller->setViewProjection(internal::FrustumCuller::kFrustumTypeCamera, projectionMatrix * viewMatrix);
         drawAllEffectsDependsOnScriptExternal();
         clearViewportPrimaryPass();
         if (isDrawingColorType) {
@@ -2987,9 +3101,18 @@ Project::flushAllCommandBuffers()
     SG_PUSH_GROUPF("Project::flushAllCommandBuffers(size=%d)", m_drawQueue->size());
     m_drawQueue->flush(this);
     m_batchDrawQueue->clear();
+    /* parameter blocks retained in this frame depend on time and cursor so they must be written again */
+    m_sharedResourceRepository->effectGlobalUniform()->endFrame();
+    m_frustumCuller->endFrame();
     SG_POP_GROUP();
 }
 
+const internal::DrawCommandScheduler *
+Project::drawCommandScheduler() const NANOEM_DECL_NOEXCEPT
+{
+    return &m_drawQueue->m_scheduler;
+}
+
 sg_pass
 Project::beginRenderPass(sg_pass pass)
 {
@@ -3466,9 +3589,9 @@ Project::copyAllSelectedKeyframes(Model *model, Error &error)
         }
     }
     nanoemMutableMotionDestroy(motion);
+    BX_UNUSED_1(error);
     clearMotionClipboard();
-    dest->save(m_motionClipboard, model, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
-    destroyMotion(dest);
+    m_motionClipboard = dest;
 }
 
 void
@@ -3631,7 +3754,8 @@ Project::selectAllMotionKeyframesIn(const TimelineSegment &range, Model *model)
 void
 Project::clearMotionClipboard()
 {
-    m_motionClipboard.clear();
+    destroyMotion(m_motionClipboard);
+    m_motionClipboard = nullptr;
 }
 
 void
@@ -3718,43 +3842,24 @@ void
 Project::copyAllSelectedBones(Model *model, Error &error)
 {
     if (model) {
-        Model *dest = createModel();
-        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
-        nanoem_unicode_string_factory_t *factory = unicodeStringFactory();
-        nanoem_mutable_model_t *mutableModel = nanoemMutableModelCreateAsReference(dest->data(), &status);
-        nanoem_model_t *originModel = nanoemMutableModelGetOriginObject(mutableModel);
-        nanoemMutableModelSetFormatType(mutableModel, NANOEM_MODEL_FORMAT_TYPE_PMX_2_1);
-        StringUtils::UnicodeStringScope scope(factory);
-        if (StringUtils::tryGetString(factory, model->name(), scope)) {
-            nanoem_status_t status = NANOEM_STATUS_SUCCESS;
-            nanoemMutableModelSetName(mutableModel, scope.value(), NANOEM_LANGUAGE_TYPE_FIRST_ENUM, &status);
-        }
-        nanoem_mutable_model_morph_t *morph = nanoemMutableModelMorphCreate(originModel, &status);
-        nanoemMutableModelMorphSetCategory(morph, NANOEM_MODEL_MORPH_CATEGORY_OTHER);
-        nanoemMutableModelMorphSetType(morph, NANOEM_MODEL_MORPH_TYPE_BONE);
         const model::Bone::Set *boneSet = model->selection()->allBoneSet();
+        if (boneSet->empty()) {
+            error = Error(m_translator->translate("nanoem.error.project.copy-bones.reason"),
+                m_translator->translate("nanoem.error.project.copy-bones.recovery-suggestion"),
+                Error::kDomainTypeApplication);
+            return;
+        }
+        m_modelClipboard.clear();
+        m_modelClipboard.reserve(boneSet->size());
         for (model::Bone::Set::const_iterator it = boneSet->begin(), end = boneSet->end(); it != end; ++it) {
-            const model::Bone *bone = model::Bone::cast(*it);
-            if (bone && StringUtils::tryGetString(factory, bone->name(), scope)) {
-                nanoem_status_t status = NANOEM_STATUS_SUCCESS;
-                nanoem_mutable_model_bone_t *mutableBone = nanoemMutableModelBoneCreate(originModel, &status);
-                nanoemMutableModelBoneSetName(mutableBone, scope.value(), NANOEM_LANGUAGE_TYPE_FIRST_ENUM, &status);
-                nanoemMutableModelInsertBoneObject(mutableModel, mutableBone, -1, &status);
-                nanoem_mutable_model_morph_bone_t *child = nanoemMutableModelMorphBoneCreate(morph, &status);
-                nanoemMutableModelMorphBoneSetBoneObject(child, nanoemMutableModelBoneGetOriginObject(mutableBone));
-                nanoemMutableModelMorphBoneSetTranslation(
-                    child, glm::value_ptr(Vector4(bone->localUserTranslation(), 1)));
-                nanoemMutableModelMorphBoneSetOrientation(child, glm::value_ptr(bone->localUserOrientation()));
-                nanoemMutableModelMorphInsertBoneMorphObject(morph, child, -1, &status);
-                nanoemMutableModelBoneDestroy(mutableBone);
-                nanoemMutableModelMorphBoneDestroy(child);
+            if (const model::Bone *bone = model::Bone::cast(*it)) {
+                BoneClipboardItem item;
+                item.m_name = bone->name();
+                item.m_translation = bone->localUserTranslation();
+                item.m_orientation = bone->localUserOrientation();
+                m_modelClipboard.push_back(item);
             }
         }
-        nanoemMutableModelInsertMorphObject(mutableModel, morph, -1, &status);
-        nanoemMutableModelDestroy(mutableModel);
-        nanoemMutableModelMorphDestroy(morph);
-        dest->save(m_modelClipboard, error);
-        destroyModel(dest);
     }
 }
 
@@ -3812,7 +3917,7 @@ Project::isModelClipboardEmpty() const NANOEM_DECL_NOEXCEPT
 bool
 Project::isMotionClipboardEmpty() const NANOEM_DECL_NOEXCEPT
 {
-    return m_motionClipboard.empty();
+    return m_motionClipboard == nullptr;
 }
 
 bool
@@ -4073,6 +4178,7 @@ Project::setDrawableOrderList(const DrawableList &value)
         v.push_back(*it);
     }
     m_drawableOrderList = v;
+    invalidateAllOffscreenRenderTargetPlans();
 }
 
 const Project::ModelList *
@@ -5189,6 +5295,7 @@ Project::createAllOffscreenRenderTargets(Effect *ownerEffect, const Archiver *ar
     if (!sorted.empty()) {
         setCurrentRenderPass(lastViewIndex);
     }
+    invalidateAllOffscreenRenderTargetPlans();
     SG_POP_GROUP();
 }
 
@@ -5226,6 +5333,7 @@ Project::releaseAllOffscreenRenderTarget(Effect *ownerEffect)
     if (it2 != m_allOffscreenRenderTargetEffectSets.end()) {
         m_allOffscreenRenderTargetEffectSets.erase(it2);
     }
+    invalidateAllOffscreenRenderTargetPlans();
     SG_POP_GROUP();
 }
 
@@ -6585,48 +6693,44 @@ Project::internalPasteAllSelectedKeyframes(Model *model, nanoem_frame_index_t fr
 {
     nanoem_assert(!isPlaying(), "must not be called while playing");
     if (!isMotionClipboardEmpty()) {
-        Motion *source = createMotion();
-        if (source->load(m_motionClipboard, frameIndex, error)) {
-            ByteArray snapshot;
-            if (Motion *modelMotionPtr = resolveMotion(model)) {
-                modelMotionPtr->save(snapshot, model, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
-                modelMotionPtr->overrideAllKeyframes(source, symmetric);
-                model->pushUndo(command::MotionSnapshotCommand::create(modelMotionPtr, model, snapshot,
-                    NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE | NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MODEL |
-                        NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MORPH));
-            }
-            else {
-                command::BatchUndoCommandListCommand::UndoCommandList commands;
-                Motion *cameraMotionPtr = cameraMotion();
-                cameraMotionPtr->save(snapshot, nullptr, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
-                cameraMotionPtr->overrideAllKeyframes(source, false);
-                commands.push_back(command::MotionSnapshotCommand::create(
-                    cameraMotionPtr, nullptr, snapshot, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_CAMERA));
-                Motion *lightMotionPtr = lightMotion();
-                lightMotionPtr->save(snapshot, nullptr, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
-                lightMotionPtr->overrideAllKeyframes(source, false);
-                commands.push_back(command::MotionSnapshotCommand::create(
-                    lightMotionPtr, nullptr, snapshot, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_LIGHT));
-                Motion *selfShadowMotionPtr = selfShadowMotion();
-                selfShadowMotionPtr->save(snapshot, nullptr, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
-                selfShadowMotionPtr->overrideAllKeyframes(source, false);
-                commands.push_back(command::MotionSnapshotCommand::create(
-                    selfShadowMotionPtr, nullptr, snapshot, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_SELFSHADOW));
-                for (Project::AccessoryList::const_iterator it = m_allAccessoryPtrs.begin(),
-                                                            end = m_allAccessoryPtrs.end();
-                     it != end; ++it) {
-                    Accessory *accessory = *it;
-                    if (Motion *accessoryMotionPtr = resolveMotion(accessory)) {
-                        accessoryMotionPtr->save(snapshot, nullptr, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
-                        accessoryMotionPtr->overrideAllKeyframes(source, false);
-                        commands.push_back(command::MotionSnapshotCommand::create(
-                            accessoryMotionPtr, nullptr, snapshot, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ACCESSORY));
-                    }
+        const Motion *source = m_motionClipboard;
+        ByteArray snapshot;
+        if (Motion *modelMotionPtr = resolveMotion(model)) {
+            modelMotionPtr->save(snapshot, model, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
+            modelMotionPtr->overrideAllKeyframes(source, frameIndex, symmetric);
+            model->pushUndo(command::MotionSnapshotCommand::create(modelMotionPtr, model, snapshot,
+                NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE | NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MODEL |
+                    NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MORPH));
+        }
+        else {
+            command::BatchUndoCommandListCommand::UndoCommandList commands;
+            Motion *cameraMotionPtr = cameraMotion();
+            cameraMotionPtr->save(snapshot, nullptr, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
+            cameraMotionPtr->overrideAllKeyframes(source, frameIndex, false);
+            commands.push_back(command::MotionSnapshotCommand::create(
+                cameraMotionPtr, nullptr, snapshot, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_CAMERA));
+            Motion *lightMotionPtr = lightMotion();
+            lightMotionPtr->save(snapshot, nullptr, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
+            lightMotionPtr->overrideAllKeyframes(source, frameIndex, false);
+            commands.push_back(command::MotionSnapshotCommand::create(
+                lightMotionPtr, nullptr, snapshot, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_LIGHT));
+            Motion *selfShadowMotionPtr = selfShadowMotion();
+            selfShadowMotionPtr->save(snapshot, nullptr, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
+            selfShadowMotionPtr->overrideAllKeyframes(source, frameIndex, false);
+            commands.push_back(command::MotionSnapshotCommand::create(
+                selfShadowMotionPtr, nullptr, snapshot, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_SELFSHADOW));
+            for (Project::AccessoryList::const_iterator it = m_allAccessoryPtrs.begin(), end = m_allAccessoryPtrs.end();
+                 it != end; ++it) {
+                Accessory *accessory = *it;
+                if (Motion *accessoryMotionPtr = resolveMotion(accessory)) {
+                    accessoryMotionPtr->save(snapshot, nullptr, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
+                    accessoryMotionPtr->overrideAllKeyframes(source, frameIndex, false);
+                    commands.push_back(command::MotionSnapshotCommand::create(
+                        accessoryMotionPtr, nullptr, snapshot, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ACCESSORY));
                 }
-                pushUndo(command::BatchUndoCommandListCommand::create(commands, nullptr, this));
             }
+            pushUndo(command::BatchUndoCommandListCommand::create(commands, nullptr, this));
         }
-        destroyMotion(source);
     }
 }
 
@@ -6635,65 +6739,55 @@ Project::internalPasteAllSelectedBones(Model *model, bool symmetric, Error &erro
 {
     nanoem_assert(!isPlaying(), "must not be called while playing");
     if (model && !isModelClipboardEmpty()) {
-        Model *source = createModel();
-        if (source->load(m_modelClipboard, error)) {
-            nanoem_rsize_t numMorphs;
-            nanoem_model_morph_t *const *morphs = nanoemModelGetAllMorphObjects(source->data(), &numMorphs);
-            if (numMorphs > 0) {
-                model::BindPose lastBindPose, currentBindPose;
-                model->saveBindPose(lastBindPose);
-                nanoem_rsize_t numBoneMorphs;
-                const nanoem_model_morph_t *rootMorph = morphs[0];
-                nanoem_unicode_string_factory_t *factory = unicodeStringFactory();
-                nanoem_model_morph_bone_t *const *boneMorphs =
-                    nanoemModelMorphGetAllBoneMorphObjects(rootMorph, &numBoneMorphs);
-                model::Bone::Set originBones;
-                StringSet symmetricBoneNameSet;
-                for (nanoem_rsize_t i = 0; i < numBoneMorphs; i++) {
-                    const nanoem_model_morph_bone_t *boneMorph = boneMorphs[i];
-                    const nanoem_model_bone_t *sourceBone = nanoemModelMorphBoneGetBoneObject(boneMorph);
-                    String name;
-                    StringUtils::getUtf8String(
-                        nanoemModelBoneGetName(sourceBone, NANOEM_LANGUAGE_TYPE_FIRST_ENUM), factory, name);
-                    const nanoem_model_bone_t *originBone = model->findBone(name);
-                    if (model::Bone *bone = model::Bone::cast(originBone)) {
-                        const Vector3 translation(glm::make_vec3(nanoemModelMorphBoneGetTranslation(boneMorph)));
-                        const Quaternion orientation(glm::make_quat(nanoemModelMorphBoneGetOrientation(boneMorph)));
-                        const char *namePtr = bone->canonicalNameConstString();
-                        if (symmetric) {
-                            if (StringUtils::hasPrefix(
-                                    namePtr, reinterpret_cast<const char *>(model::Bone::kNameLeftInJapanese))) {
-                                const String newName(StringUtils::substitutedPrefixString(
-                                    reinterpret_cast<const char *>(model::Bone::kNameRightInJapanese), namePtr));
-                                if (symmetricBoneNameSet.find(newName) == symmetricBoneNameSet.end()) {
-                                    symmetricLocalTransformBone(newName, translation, orientation, model);
-                                    symmetricBoneNameSet.insert(newName);
-                                }
-                            }
-                            if (StringUtils::hasPrefix(
-                                    namePtr, reinterpret_cast<const char *>(model::Bone::kNameRightInJapanese))) {
-                                const String newName(StringUtils::substitutedPrefixString(
-                                    reinterpret_cast<const char *>(model::Bone::kNameLeftInJapanese), namePtr));
-                                if (symmetricBoneNameSet.find(newName) == symmetricBoneNameSet.end()) {
-                                    symmetricLocalTransformBone(newName, translation, orientation, model);
-                                    symmetricBoneNameSet.insert(newName);
-                                }
-                            }
+        model::BindPose lastBindPose, currentBindPose;
+        model->saveBindPose(lastBindPose);
+        model::Bone::Set originBones;
+        StringSet symmetricBoneNameSet;
+        for (BoneClipboardItemList::const_iterator it = m_modelClipboard.begin(), end = m_modelClipboard.end();
+             it != end; ++it) {
+            const nanoem_model_bone_t *originBone = model->findBone(it->m_name);
+            if (model::Bone *bone = model::Bone::cast(originBone)) {
+                const Vector3 &translation = it->m_translation;
+                const Quaternion &orientation = it->m_orientation;
+                const char *namePtr = bone->canonicalNameConstString();
+                if (symmetric) {
+                    if (StringUtils::hasPrefix(
+                            namePtr, reinterpret_cast<const char *>(model::Bone::kNameLeftInJapanese))) {
+                        const String newName(StringUtils::substitutedPrefixString(
+                            reinterpret_cast<const char *>(model::Bone::kNameRightInJapanese), namePtr));
+                        if (symmetricBoneNameSet.find(newName) == symmetricBoneNameSet.end()) {
+                            symmetricLocalTransformBone(newName, translation, orientation, model);
+                            symmetricBoneNameSet.insert(newName);
                         }
-                        else {
-                            bone->setLocalUserTranslation(translation);
-                            bone->setLocalUserOrientation(orientation);
+                    }
+                    if (StringUtils::hasPrefix(
+                            namePtr, reinterpret_cast<const char *>(model::Bone::kNameRightInJapanese))) {
+                        const String newName(StringUtils::substitutedPrefixString(
+                            reinterpret_cast<const char *>(model::Bone::kNameLeftInJapanese), namePtr));
+                        if (symmetricBoneNameSet.find(newName) == symmetricBoneNameSet.end()) {
+                            symmetricLocalTransformBone(newName, translation, orientation, model);
+                            symmetricBoneNameSet.insert(newName);
                         }
-                        bone->setDirty(true);
-                        originBones.insert(originBone);
                     }
                 }
-                model->saveBindPose(currentBindPose);
-                model->pushUndo(command::TransformBoneCommand::create(
-                    lastBindPose, currentBindPose, ListUtils::toListFromSet(originBones), model, this));
+                else {
+                    bone->setLocalUserTranslation(translation);
+                    bone->setLocalUserOrientation(orientation);
+                }
+                bone->setDirty(true);
+                originBones.insert(originBone);
             }
         }
-        destroyModel(source);
+        if (originBones.empty()) {
+            error = Error(m_translator->translate("nanoem.error.project.paste-bones.reason"),
+                m_translator->translate("nanoem.error.project.paste-bones.recovery-suggestion"),
+                Error::kDomainTypeApplication);
+        }
+        else {
+            model->saveBindPose(currentBindPose);
+            model->pushUndo(command::TransformBoneCommand::create(
+                lastBindPose, currentBindPose, ListUtils::toListFromSet(originBones), model, this));
+        }
     }
 }
 
@@ -6830,6 +6924,7 @@ Project::removeDrawable(IDrawable *drawable)
     removeEffectOrderSet(drawable);
     if (ListUtils::removeItem(drawable, m_drawableOrderList)) {
         drawable->setActiveEffect(nullptr);
+        invalidateAllOffscreenRenderTargetPlans();
         RedoObjectHandleMap::const_iterator it = m_redoObjectHandles.find(drawable->handle());
         if (it != m_redoObjectHandles.end()) {
             m_redoObjectHandles.erase(it);
@@ -6855,6 +6950,7 @@ Project::internalResetAllRenderTargets(const Vector2UI16 &size)
     m_renderPassBundleMap.clear();
     m_renderPassStringMap.clear();
     m_hashedRenderPassBundleMap.clear();
+    invalidateAllOffscreenRenderTargetPlans();
     StringSet sharedRenderColorImageNames, sharedOffscreenImageNames;
     for (LoadedEffectSet::const_iterator it = m_loadedEffectSet.begin(), end = m_loadedEffectSet.end(); it != end;
          ++it) {
@@ -6959,29 +7055,26 @@ void
 Project::drawOffscreenRenderTarget(Effect *ownerEffect)
 {
     sg_pass_action pa;
-    effect::OffscreenRenderTargetOptionList options;
-    SortedOffscreenRenderTargetOptionList sorted;
-    getAllOffscreenRenderTargetOptions(ownerEffect, options, sorted);
-    for (SortedOffscreenRenderTargetOptionList::const_iterator it = sorted.begin(), end = sorted.end(); it != end;
-         ++it) {
-        const effect::OffscreenRenderTargetOption *option = *it;
-        const String &name = option->m_name;
-        const sg_pass pass = registerOffscreenRenderPass(ownerEffect, *option);
+    const OffscreenRenderTargetPlanList &plans = resolveOffscreenRenderTargetPlans(ownerEffect);
+    for (OffscreenRenderTargetPlanList::const_iterator it = plans.begin(), end = plans.end(); it != end; ++it) {
+        const OffscreenRenderTargetPlan &plan = *it;
+        const effect::OffscreenRenderTargetOption &option = plan.m_option;
+        const sg_pass pass = plan.m_pass;
         effect::RenderPassScope renderPassScope;
         PassScope scope(m_currentOffscreenRenderPass, pass), scope2(m_originOffscreenRenderPass, pass);
         BX_UNUSED_2(scope, scope2);
-        SG_PUSH_GROUPF("Project::drawOffscreenRenderTarget(name=%s, pass=%s, owner=%s)", name.c_str(),
+        SG_PUSH_GROUPF("Project::drawOffscreenRenderTarget(name=%s, pass=%s, owner=%s)", option.m_name.c_str(),
             findRenderPassName(pass), ownerEffect->nameConstString());
-        option->getPassAction(pa);
+        option.getPassAction(pa);
         setOffscreenRenderPassScope(&renderPassScope);
-        const int numSamples = option->m_colorImageDescription.sample_count;
+        const int numSamples = option.m_colorImageDescription.sample_count;
         const PixelFormat format(findRenderPassPixelFormat(pass, numSamples));
         clearRenderPass(sharedBatchDrawQueue(), pass, pa, format);
-        for (DrawableList::const_iterator it2 = m_drawableOrderList.begin(), end2 = m_drawableOrderList.end();
+        for (OffscreenRenderTargetPlan::ItemList::const_iterator it2 = plan.m_items.begin(), end2 = plan.m_items.end();
              it2 != end2; ++it2) {
-            drawObjectToOffscreenRenderTarget(*it2, ownerEffect, name);
+            drawObjectToOffscreenRenderTarget(it2->m_drawable, ownerEffect, it2->m_passiveEffect);
         }
-        ownerEffect->generateOffscreenMipmapImagesChain(*option);
+        ownerEffect->generateOffscreenMipmapImagesChain(option);
         setOffscreenRenderPassScope(nullptr);
         renderPassScope.reset(nullptr);
         SG_POP_GROUP();
@@ -6989,27 +7082,69 @@ Project::drawOffscreenRenderTarget(Effect *ownerEffect)
 }
 
 void
-Project::drawObjectToOffscreenRenderTarget(IDrawable *drawable, Effect *ownerEffect, const String &name)
+Project::drawObjectToOffscreenRenderTarget(IDrawable *drawable, Effect *ownerEffect, IEffect *passiveEffect)
 {
-    if (drawable->isOffscreenPassiveRenderTargetEffectEnabled(name)) {
-        if (IEffect *passiveEffect = drawable->findOffscreenPassiveRenderTargetEffect(name)) {
-            IEffect *lastActiveEffect = drawable->activeEffect();
-            if (lastActiveEffect && lastActiveEffect->scriptClass() != IEffect::kScriptClassTypeScene &&
-                lastActiveEffect->scriptOrder() == IEffect::kScriptOrderTypeStandard) {
-                drawable->setActiveEffect(ownerEffect);
-                drawable->setPassiveEffect(passiveEffect);
-                if (isGroundShadowEnabled()) {
-                    drawable->draw(IDrawable::kDrawTypeGroundShadow);
-                }
-                if (m_editingMode != kEditingModeSelect) {
-                    drawable->draw(IDrawable::kDrawTypeEdge);
+    IEffect *lastActiveEffect = drawable->activeEffect();
+    if (lastActiveEffect && lastActiveEffect->scriptClass() != IEffect::kScriptClassTypeScene &&
+        lastActiveEffect->scriptOrder() == IEffect::kScriptOrderTypeStandard) {
+        drawable->setActiveEffect(ownerEffect);
+        drawable->setPassiveEffect(passiveEffect);
+        if (isGroundShadowEnabled()) {
+            drawable->draw(IDrawable::kDrawTypeGroundShadow);
+        }
+        if (m_editingMode != kEditingModeSelect) {
+            drawable->draw(IDrawable::kDrawTypeEdge);
+        }
+        drawable->draw(IDrawable::kDrawTypeColor);
+        drawable->setActiveEffect(lastActiveEffect);
+        drawable->setPassiveEffect(nullptr);
+    }
+}
+
+const Project::OffscreenRenderTargetPlanList &
+Project::resolveOffscreenRenderTargetPlans(Effect *ownerEffect)
+{
+    /* kept apart from the state flags since restoreState overwrites them */
+    if (m_offscreenRenderTargetPlansDirty) {
+        m_offscreenRenderTargetPlans.clear();
+        m_offscreenRenderTargetPlansDirty = false;
+    }
+    OffscreenRenderTargetPlanMap::iterator it = m_offscreenRenderTargetPlans.find(ownerEffect);
+    if (it == m_offscreenRenderTargetPlans.end()) {
+        /* passive effects of drawables are resolved by name only once until any of them is changed */
+        OffscreenRenderTargetPlanList plans;
+        effect::OffscreenRenderTargetOptionList options;
+        SortedOffscreenRenderTargetOptionList sorted;
+        getAllOffscreenRenderTargetOptions(ownerEffect, options, sorted);
+        plans.reserve(sorted.size());
+        for (SortedOffscreenRenderTargetOptionList::const_iterator it2 = sorted.begin(), end2 = sorted.end();
+             it2 != end2; ++it2) {
+            const effect::OffscreenRenderTargetOption *option = *it2;
+            const String &name = option->m_name;
+            const OffscreenRenderTargetPlan plan = { *option, registerOffscreenRenderPass(ownerEffect, *option),
+                OffscreenRenderTargetPlan::ItemList() };
+            plans.push_back(plan);
+            OffscreenRenderTargetPlan::ItemList &items = plans.back().m_items;
+            for (DrawableList::const_iterator it3 = m_drawableOrderList.begin(), end3 = m_drawableOrderList.end();
+                 it3 != end3; ++it3) {
+                IDrawable *drawable = *it3;
+                if (drawable->isOffscreenPassiveRenderTargetEffectEnabled(name)) {
+                    if (IEffect *passiveEffect = drawable->findOffscreenPassiveRenderTargetEffect(name)) {
+                        const OffscreenRenderTargetPlan::Item item = { drawable, passiveEffect };
+                        items.push_back(item);
+                    }
                 }
-                drawable->draw(IDrawable::kDrawTypeColor);
-                drawable->setActiveEffect(lastActiveEffect);
-                drawable->setPassiveEffect(nullptr);
             }
         }
+        it = m_offscreenRenderTargetPlans.insert(tinystl::make_pair(ownerEffect, plans)).first;
     }
+    return it->second;
+}
+
+void
+Project::invalidateAllOffscreenRenderTargetPlans() NANOEM_DECL_NOEXCEPT
+{
+    m_offscreenRenderTargetPlansDirty = true;
 }
 
 void
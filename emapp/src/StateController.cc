@@ -584,6 +584,7 @@ struct ISelector {
     virtual void end(const Vector4SI32 &value, const Project *project) = 0;
     virtual void draw(IPrimitive2D *primitive, nanoem_f32_t devicePixelRatio) = 0;
     virtual bool contains(const Vector2SI32 &coord) const NANOEM_DECL_NOEXCEPT = 0;
+    virtual Vector4SI32 boundingRect() const NANOEM_DECL_NOEXCEPT = 0;
 };
 
 class RectangleSelector NANOEM_DECL_SEALED : public ISelector, private NonCopyable {
@@ -599,6 +600,7 @@ public:
     void end(const Vector4SI32 &logicalScaleRect, const Project *project) NANOEM_DECL_NOEXCEPT_OVERRIDE;
     void draw(IPrimitive2D *primitive, nanoem_f32_t devicePixelRatio) NANOEM_DECL_NOEXCEPT_OVERRIDE;
     bool contains(const Vector2SI32 &deviceScaleCursorPosition) const NANOEM_DECL_NOEXCEPT_OVERRIDE;
+    Vector4SI32 boundingRect() const NANOEM_DECL_NOEXCEPT_OVERRIDE;
     void updateRectangle(const Vector4SI32 &logicalScaleRect, const Project *project) NANOEM_DECL_NOEXCEPT;
 
 private:
@@ -669,6 +671,12 @@ RectangleSelector::contains(const Vector2SI32 &deviceScaleCursorPosition) const
     return Inline::intersectsRectPoint(m_deviceScaleRect, deviceScaleCursorPosition);
 }
 
+Vector4SI32
+RectangleSelector::boundingRect() const NANOEM_DECL_NOEXCEPT
+{
+    return m_deviceScaleRect;
+}
+
 void
 RectangleSelector::updateRectangle(const Vector4SI32 &logicalScaleRect, const Project *project) NANOEM_DECL_NOEXCEPT
 {
@@ -686,6 +694,7 @@ public:
     void end(const Vector4SI32 &logicalScaleRect, const Project *project) NANOEM_DECL_NOEXCEPT_OVERRIDE;
     void draw(IPrimitive2D *primitive, nanoem_f32_t devicePixelRatio) NANOEM_DECL_NOEXCEPT_OVERRIDE;
     bool contains(const Vector2SI32 &deviceScaleCursorPosition) const NANOEM_DECL_NOEXCEPT_OVERRIDE;
+    Vector4SI32 boundingRect() const NANOEM_DECL_NOEXCEPT_OVERRIDE;
     void updateRectangle(const Vector4SI32 &logicalScaleRect, const Project *project) NANOEM_DECL_NOEXCEPT;
 
 private:
@@ -755,6 +764,17 @@ CircleSelector::contains(const Vector2SI32 &deviceScaleCursorPosition) const NAN
     return glm::distance(center, Vector2(deviceScaleCursorPosition)) < radius;
 }
 
+Vector4SI32
+CircleSelector::boundingRect() const NANOEM_DECL_NOEXCEPT
+{
+    const Vector4 rect(m_deviceScaleRect);
+    const int radius = int(glm::ceil(glm::sqrt(rect.z * rect.z + rect.w * rect.w)));
+    Vector2SI32 center;
+    center.x = m_direction.x < 0 ? m_deviceScaleRect.z + m_deviceScaleRect.x : m_deviceScaleRect.x;
+    center.y = m_direction.y < 0 ? m_deviceScaleRect.w + m_deviceScaleRect.y : m_deviceScaleRect.y;
+    return Vector4SI32(center - radius, radius * 2, radius * 2);
+}
+
 void
 CircleSelector::updateRectangle(const Vector4SI32 &logicalScaleRect, const Project *project) NANOEM_DECL_NOEXCEPT
 {
@@ -1052,12 +1072,13 @@ DraggingVertexSelectionState::commitSelection(Model *model, const Project *proje
         selection->removeAllVertices();
     }
     const ISelector *selector = currentSelector(model);
-    for (nanoem_rsize_t i = 0; i < numVertices; i++) {
-        const nanoem_model_vertex_t *vertexPtr = vertices[i];
+    VertexIndexList candidates;
+    model->collectAllVerticesInViewport(selector->boundingRect(), candidates);
+    for (VertexIndexList::const_iterator it = candidates.begin(), end = candidates.end(); it != end; ++it) {
+        const nanoem_model_vertex_t *vertexPtr = vertices[*it];
         const model::Vertex *vertex = model::Vertex::cast(vertexPtr);
         if (!vertex->isEditingMasked()) {
-            const bx::simd128_t v = vertex->m_simd.m_origin;
-            const Vector3 position(bx::simd_x(v), bx::simd_y(v), bx::simd_z(v));
+            const Vector3 &position = model->skinnedVertexPosition(*it);
             const Vector2SI32 coord(camera->toDeviceScreenCoordinateInViewport(position));
             if (selector->contains(coord)) {
                 selection->addVertex(vertexPtr);
@@ -1101,8 +1122,7 @@ DraggingFaceSelectionState::name() const NANOEM_DECL_NOEXCEPT
 void
 DraggingFaceSelectionState::commitSelection(Model *model, const Project *project, bool removeAll)
 {
-    nanoem_rsize_t numVertices, numMaterials, numVertexIndices;
-    nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(model->data(), &numVertices);
+    nanoem_rsize_t numMaterials, numVertexIndices;
     nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(model->data(), &numMaterials);
     const nanoem_u32_t *vertexIndices = nanoemModelGetAllVertexIndices(model->data(), &numVertexIndices);
     const ICamera *camera = project->activeCamera();
@@ -1111,29 +1131,30 @@ DraggingFaceSelectionState::commitSelection(Model *model, const Project *project
         selection->removeAllFaces();
     }
     const ISelector *selector = currentSelector(model);
-    for (nanoem_rsize_t i = 0, offset = 0; i < numMaterials; i++) {
-        const nanoem_model_material_t *materialPtr = materials[i];
-        const nanoem_rsize_t numVertexIndices = nanoemModelMaterialGetNumVertexIndices(materialPtr);
-        const model::Material *material = model::Material::cast(materialPtr);
-        if (material && material->isVisible()) {
-            for (nanoem_rsize_t j = 0; j < numVertexIndices; j += 3) {
-                const nanoem_rsize_t o = offset + j, faceIndex = o / 3;
-                if (!model->isFaceEditingMasked(faceIndex)) {
-                    const nanoem_u32_t i0 = vertexIndices[o], i1 = vertexIndices[o + 1], i2 = vertexIndices[o + 2];
-                    const nanoem_model_vertex_t *v0 = vertices[i0], *v1 = vertices[i1], *v2 = vertices[i2];
-                    const Vector3 o0(glm::make_vec3(nanoemModelVertexGetOrigin(v0))),
-                        o1(glm::make_vec3(nanoemModelVertexGetOrigin(v1))),
-                        o2(glm::make_vec3(nanoemModelVertexGetOrigin(v2))),
-                        baryCenter(o0 + (o1 - o0) * 0.5f + (o2 - o0) * 0.5f);
-                    const Vector2SI32 coord(camera->toDeviceScreenCoordinateInViewport(baryCenter));
-                    if (selector->contains(coord)) {
-                        const Vector4UI32 face(o / 3, i0, i1, i2);
-                        selection->addFace(face);
-                    }
-                }
+    VertexIndexList candidates;
+    model->collectAllFacesInViewport(selector->boundingRect(), candidates);
+    nanoem_rsize_t materialIndex = 0, offset = 0;
+    for (VertexIndexList::const_iterator it = candidates.begin(), end = candidates.end(); it != end; ++it) {
+        /* candidates are sorted so the material owning the face is found by walking forward */
+        const nanoem_rsize_t faceIndex = *it, o = faceIndex * 3;
+        while (materialIndex < numMaterials &&
+            o >= offset + nanoemModelMaterialGetNumVertexIndices(materials[materialIndex])) {
+            offset += nanoemModelMaterialGetNumVertexIndices(materials[materialIndex++]);
+        }
+        if (materialIndex >= numMaterials) {
+            break;
+        }
+        const model::Material *material = model::Material::cast(materials[materialIndex]);
+        if (material && material->isVisible() && !model->isFaceEditingMasked(faceIndex)) {
+            const nanoem_u32_t i0 = vertexIndices[o], i1 = vertexIndices[o + 1], i2 = vertexIndices[o + 2];
+            const Vector3 &o0 = model->skinnedVertexPosition(i0), &o1 = model->skinnedVertexPosition(i1),
+                          &o2 = model->skinnedVertexPosition(i2), baryCenter(o0 + (o1 - o0) * 0.5f + (o2 - o0) * 0.5f);
+            const Vector2SI32 coord(camera->toDeviceScreenCoordinateInViewport(baryCenter));
+            if (selector->contains(coord)) {
+                const Vector4UI32 face(faceIndex, i0, i1, i2);
+                selection->addFace(face);
             }
         }
-        offset += numVertexIndices;
     }
 }
 
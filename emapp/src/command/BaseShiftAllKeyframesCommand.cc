@@ -14,6 +14,15 @@
 
 namespace nanoem {
 namespace command {
+namespace {
+
+static nanoem_frame_index_t
+shiftFrameIndex(void *userData, nanoem_frame_index_t frameIndex)
+{
+    return frameIndex + *static_cast<const nanoem_s32_t *>(userData);
+}
+
+} /* namespace anonymous */
 
 BaseShiftingAllKeyframesCommand::~BaseShiftingAllKeyframesCommand() NANOEM_DECL_NOEXCEPT
 {
@@ -90,27 +99,31 @@ BaseShiftingAllKeyframesCommand::shiftAllKeyframesBackward(Error &error)
     if (m_localFrameIndex > 0 && currentProject()->containsMotion(m_motion)) {
         nanoem_status_t status = NANOEM_STATUS_SUCCESS;
         nanoem_mutable_motion_t *mutableMotion = nanoemMutableMotionCreateAsReference(m_motion->data(), &status);
+        nanoem_s32_t offset = 1;
+        nanoemMutableMotionRemapAllKeyframes(mutableMotion, m_types, m_localFrameIndex, Motion::kMaxFrameIndex - 1,
+            shiftFrameIndex, &offset, &status);
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ACCESSORY, m_types)) {
-            shiftAllAccessoryKeyframesBackward(mutableMotion, &status);
+            restoreAllAccessoryKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE, m_types)) {
-            shiftAllBoneKeyframesBackward(mutableMotion, &status);
+            restoreAllBoneKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_CAMERA, m_types)) {
-            shiftAllCameraKeyframesBackward(mutableMotion, &status);
+            restoreAllCameraKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_LIGHT, m_types)) {
-            shiftAllLightKeyframesBackward(mutableMotion, &status);
+            restoreAllLightKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MODEL, m_types)) {
-            shiftAllModelKeyframesBackward(mutableMotion, &status);
+            restoreAllModelKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MORPH, m_types)) {
-            shiftAllMorphKeyframesBackward(mutableMotion, &status);
+            restoreAllMorphKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_SELFSHADOW, m_types)) {
-            shiftAllSelfShadowKeyframesBackward(mutableMotion, &status);
+            restoreAllSelfShadowKeyframes(mutableMotion, &status);
         }
+        /* keyframes restored after the remap are appended so they must be sorted again */
         nanoemMutableMotionSortAllKeyframes(mutableMotion);
         nanoemMutableMotionDestroy(mutableMotion);
         m_motion->setDirty(true);
@@ -125,27 +138,29 @@ BaseShiftingAllKeyframesCommand::shiftAllKeyframesForward(Error &error)
         nanoem_status_t status = NANOEM_STATUS_SUCCESS;
         nanoem_mutable_motion_t *mutableMotion = nanoemMutableMotionCreateAsReference(m_motion->data(), &status);
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ACCESSORY, m_types)) {
-            shiftAllAccessoryKeyframesForward(mutableMotion, &status);
+            removeAllAccessoryKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE, m_types)) {
-            shiftAllBoneKeyframesForward(mutableMotion, &status);
+            removeAllBoneKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_CAMERA, m_types)) {
-            shiftAllCameraKeyframesForward(mutableMotion, &status);
+            removeAllCameraKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_LIGHT, m_types)) {
-            shiftAllLightKeyframesForward(mutableMotion, &status);
+            removeAllLightKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MODEL, m_types)) {
-            shiftAllModelKeyframesForward(mutableMotion, &status);
+            removeAllModelKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MORPH, m_types)) {
-            shiftAllMorphKeyframesForward(mutableMotion, &status);
+            removeAllMorphKeyframes(mutableMotion, &status);
         }
         if (EnumUtils::isEnabled(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_SELFSHADOW, m_types)) {
-            shiftAllSelfShadowKeyframesForward(mutableMotion, &status);
+            removeAllSelfShadowKeyframes(mutableMotion, &status);
         }
-        nanoemMutableMotionSortAllKeyframes(mutableMotion);
+        nanoem_s32_t offset = -1;
+        nanoemMutableMotionRemapAllKeyframes(mutableMotion, m_types, m_localFrameIndex + 1, Motion::kMaxFrameIndex,
+            shiftFrameIndex, &offset, &status);
         nanoemMutableMotionDestroy(mutableMotion);
         m_motion->setDirty(true);
         assignError(status, error);
@@ -185,22 +200,9 @@ BaseShiftingAllKeyframesCommand::BaseShiftingAllKeyframesCommand(
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllAccessoryKeyframesBackward(
+BaseShiftingAllKeyframesCommand::restoreAllAccessoryKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
-    nanoem_rsize_t numKeyframes;
-    nanoem_motion_accessory_keyframe_t *const *keyframes =
-        nanoemMotionGetAllAccessoryKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableAccessoryKeyframeList targets;
-    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_accessory_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionAccessoryKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex >= m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionAccessoryKeyframeCreateAsReference(keyframe, status));
-        }
-    }
-    shiftAllAccessoryKeyframesWithOffset(mutableMotion, targets, 1, status);
     for (MutableAccessoryKeyframeList::const_iterator it = m_accessoryKeyframes.begin(),
                                                       end = m_accessoryKeyframes.end();
          it != end; ++it) {
@@ -211,22 +213,9 @@ BaseShiftingAllKeyframesCommand::shiftAllAccessoryKeyframesBackward(
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllBoneKeyframesBackward(
+BaseShiftingAllKeyframesCommand::restoreAllBoneKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
-    nanoem_rsize_t numKeyframes;
-    nanoem_motion_bone_keyframe_t *const *keyframes =
-        nanoemMotionGetAllBoneKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableModelBoneKeyframeList targets;
-    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_bone_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex >= m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionBoneKeyframeCreateAsReference(keyframe, status));
-        }
-    }
-    shiftAllBoneKeyframesWithOffset(mutableMotion, targets, 1, status);
     for (MutableModelBoneKeyframeList::const_iterator it = m_boneKeyframes.begin(), end = m_boneKeyframes.end();
          it != end; ++it) {
         nanoem_mutable_motion_bone_keyframe_t *keyframe = *it;
@@ -239,22 +228,9 @@ BaseShiftingAllKeyframesCommand::shiftAllBoneKeyframesBackward(
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllCameraKeyframesBackward(
+BaseShiftingAllKeyframesCommand::restoreAllCameraKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
-    nanoem_rsize_t numKeyframes;
-    nanoem_motion_camera_keyframe_t *const *keyframes =
-        nanoemMotionGetAllCameraKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableCameraKeyframeList targets;
-    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_camera_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex >= m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionCameraKeyframeCreateAsReference(keyframe, status));
-        }
-    }
-    shiftAllCameraKeyframesWithOffset(mutableMotion, targets, 1, status);
     for (MutableCameraKeyframeList::const_iterator it = m_cameraKeyframes.begin(), end = m_cameraKeyframes.end();
          it != end; ++it) {
         nanoemMutableMotionAddCameraKeyframe(mutableMotion, *it, m_localFrameIndex, status);
@@ -264,22 +240,9 @@ BaseShiftingAllKeyframesCommand::shiftAllCameraKeyframesBackward(
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllLightKeyframesBackward(
+BaseShiftingAllKeyframesCommand::restoreAllLightKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
-    nanoem_rsize_t numKeyframes;
-    nanoem_motion_light_keyframe_t *const *keyframes =
-        nanoemMotionGetAllLightKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableLightKeyframeList targets;
-    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_light_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionLightKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex >= m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionLightKeyframeCreateAsReference(keyframe, status));
-        }
-    }
-    shiftAllLightKeyframesWithOffset(mutableMotion, targets, 1, status);
     for (MutableLightKeyframeList::const_iterator it = m_lightKeyframes.begin(), end = m_lightKeyframes.end();
          it != end; ++it) {
         nanoemMutableMotionAddLightKeyframe(mutableMotion, *it, m_localFrameIndex, status);
@@ -289,22 +252,9 @@ BaseShiftingAllKeyframesCommand::shiftAllLightKeyframesBackward(
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllModelKeyframesBackward(
+BaseShiftingAllKeyframesCommand::restoreAllModelKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
-    nanoem_rsize_t numKeyframes;
-    nanoem_motion_model_keyframe_t *const *keyframes =
-        nanoemMotionGetAllModelKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableModelKeyframeList targets;
-    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_model_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionModelKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex >= m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionModelKeyframeCreateAsReference(keyframe, status));
-        }
-    }
-    shiftAllModelKeyframesWithOffset(mutableMotion, targets, 1, status);
     for (MutableModelKeyframeList::const_iterator it = m_modelKeyframes.begin(), end = m_modelKeyframes.end();
          it != end; ++it) {
         nanoemMutableMotionAddModelKeyframe(mutableMotion, *it, m_localFrameIndex, status);
@@ -314,22 +264,9 @@ BaseShiftingAllKeyframesCommand::shiftAllModelKeyframesBackward(
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllMorphKeyframesBackward(
+BaseShiftingAllKeyframesCommand::restoreAllMorphKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
-    nanoem_rsize_t numKeyframes;
-    nanoem_motion_morph_keyframe_t *const *keyframes =
-        nanoemMotionGetAllMorphKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableModelMorphKeyframeList targets;
-    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_morph_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionMorphKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex >= m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionMorphKeyframeCreateAsReference(keyframe, status));
-        }
-    }
-    shiftAllMorphKeyframesWithOffset(mutableMotion, targets, 1, status);
     for (MutableModelMorphKeyframeList::const_iterator it = m_morphKeyframes.begin(), end = m_morphKeyframes.end();
          it != end; ++it) {
         nanoem_mutable_motion_morph_keyframe_t *keyframe = *it;
@@ -342,22 +279,9 @@ BaseShiftingAllKeyframesCommand::shiftAllMorphKeyframesBackward(
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllSelfShadowKeyframesBackward(
+BaseShiftingAllKeyframesCommand::restoreAllSelfShadowKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
-    nanoem_rsize_t numKeyframes;
-    nanoem_motion_self_shadow_keyframe_t *const *keyframes =
-        nanoemMotionGetAllSelfShadowKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableSelfShadowKeyframeList targets;
-    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
-        nanoem_motion_self_shadow_keyframe_t *keyframe = keyframes[i];
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionSelfShadowKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex >= m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionSelfShadowKeyframeCreateAsReference(keyframe, status));
-        }
-    }
-    shiftAllSelfShadowKeyframesWithOffset(mutableMotion, targets, 1, status);
     for (MutableSelfShadowKeyframeList::const_iterator it = m_selfShadowKeyframes.begin(),
                                                        end = m_selfShadowKeyframes.end();
          it != end; ++it) {
@@ -368,21 +292,17 @@ BaseShiftingAllKeyframesCommand::shiftAllSelfShadowKeyframesBackward(
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllAccessoryKeyframesForward(
+BaseShiftingAllKeyframesCommand::removeAllAccessoryKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
     nanoem_rsize_t numKeyframes;
     nanoem_motion_accessory_keyframe_t *const *keyframes =
         nanoemMotionGetAllAccessoryKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableAccessoryKeyframeList targets;
     for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
         nanoem_motion_accessory_keyframe_t *keyframe = keyframes[i];
         nanoem_frame_index_t frameIndex =
             nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionAccessoryKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex > m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionAccessoryKeyframeCreateAsReference(keyframe, status));
-        }
-        else if (frameIndex == m_localFrameIndex) {
+        if (frameIndex == m_localFrameIndex) {
             m_accessoryKeyframes.push_back(nanoemMutableMotionAccessoryKeyframeCreateAsReference(keyframe, status));
         }
     }
@@ -391,25 +311,19 @@ BaseShiftingAllKeyframesCommand::shiftAllAccessoryKeyframesForward(
          it != end; ++it) {
         nanoemMutableMotionRemoveAccessoryKeyframe(mutableMotion, *it, status);
     }
-    shiftAllAccessoryKeyframesWithOffset(mutableMotion, targets, -1, status);
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllBoneKeyframesForward(
-    nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
+BaseShiftingAllKeyframesCommand::removeAllBoneKeyframes(nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
     nanoem_rsize_t numKeyframes;
     nanoem_motion_bone_keyframe_t *const *keyframes =
         nanoemMotionGetAllBoneKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableModelBoneKeyframeList targets;
     for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
         nanoem_motion_bone_keyframe_t *keyframe = keyframes[i];
         nanoem_frame_index_t frameIndex =
             nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex > m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionBoneKeyframeCreateAsReference(keyframe, status));
-        }
-        else if (frameIndex == m_localFrameIndex) {
+        if (frameIndex == m_localFrameIndex) {
             m_boneKeyframes.push_back(nanoemMutableMotionBoneKeyframeCreateAsReference(keyframe, status));
         }
     }
@@ -417,25 +331,20 @@ BaseShiftingAllKeyframesCommand::shiftAllBoneKeyframesForward(
          it != end; ++it) {
         nanoemMutableMotionRemoveBoneKeyframe(mutableMotion, *it, status);
     }
-    shiftAllBoneKeyframesWithOffset(mutableMotion, targets, -1, status);
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllCameraKeyframesForward(
+BaseShiftingAllKeyframesCommand::removeAllCameraKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
     nanoem_rsize_t numKeyframes;
     nanoem_motion_camera_keyframe_t *const *keyframes =
         nanoemMotionGetAllCameraKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableCameraKeyframeList targets;
     for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
         nanoem_motion_camera_keyframe_t *keyframe = keyframes[i];
         nanoem_frame_index_t frameIndex =
             nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex > m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionCameraKeyframeCreateAsReference(keyframe, status));
-        }
-        else if (frameIndex == m_localFrameIndex) {
+        if (frameIndex == m_localFrameIndex) {
             m_cameraKeyframes.push_back(nanoemMutableMotionCameraKeyframeCreateAsReference(keyframe, status));
         }
     }
@@ -443,25 +352,20 @@ BaseShiftingAllKeyframesCommand::shiftAllCameraKeyframesForward(
          it != end; ++it) {
         nanoemMutableMotionRemoveCameraKeyframe(mutableMotion, *it, status);
     }
-    shiftAllCameraKeyframesWithOffset(mutableMotion, targets, -1, status);
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllLightKeyframesForward(
+BaseShiftingAllKeyframesCommand::removeAllLightKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
     nanoem_rsize_t numKeyframes;
     nanoem_motion_light_keyframe_t *const *keyframes =
         nanoemMotionGetAllLightKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableLightKeyframeList targets;
     for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
         nanoem_motion_light_keyframe_t *keyframe = keyframes[i];
         nanoem_frame_index_t frameIndex =
             nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionLightKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex > m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionLightKeyframeCreateAsReference(keyframe, status));
-        }
-        else if (frameIndex == m_localFrameIndex) {
+        if (frameIndex == m_localFrameIndex) {
             m_lightKeyframes.push_back(nanoemMutableMotionLightKeyframeCreateAsReference(keyframe, status));
         }
     }
@@ -469,25 +373,20 @@ BaseShiftingAllKeyframesCommand::shiftAllLightKeyframesForward(
          it != end; ++it) {
         nanoemMutableMotionRemoveLightKeyframe(mutableMotion, *it, status);
     }
-    shiftAllLightKeyframesWithOffset(mutableMotion, targets, -1, status);
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllModelKeyframesForward(
+BaseShiftingAllKeyframesCommand::removeAllModelKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
     nanoem_rsize_t numKeyframes;
     nanoem_motion_model_keyframe_t *const *keyframes =
         nanoemMotionGetAllModelKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableModelKeyframeList targets;
     for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
         nanoem_motion_model_keyframe_t *keyframe = keyframes[i];
         nanoem_frame_index_t frameIndex =
             nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionModelKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex > m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionModelKeyframeCreateAsReference(keyframe, status));
-        }
-        else if (frameIndex == m_localFrameIndex) {
+        if (frameIndex == m_localFrameIndex) {
             m_modelKeyframes.push_back(nanoemMutableMotionModelKeyframeCreateAsReference(keyframe, status));
         }
     }
@@ -495,26 +394,21 @@ BaseShiftingAllKeyframesCommand::shiftAllModelKeyframesForward(
          it != end; ++it) {
         nanoemMutableMotionRemoveModelKeyframe(mutableMotion, *it, status);
     }
-    shiftAllModelKeyframesWithOffset(mutableMotion, targets, -1, status);
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllMorphKeyframesForward(
+BaseShiftingAllKeyframesCommand::removeAllMorphKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
     nanoem_rsize_t numKeyframes;
     nanoem_motion_morph_keyframe_t *const *keyframes =
         nanoemMotionGetAllMorphKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableModelMorphKeyframeList targets;
     const bool isEmpty = m_morphKeyframes.empty();
     for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
         nanoem_motion_morph_keyframe_t *keyframe = keyframes[i];
         nanoem_frame_index_t frameIndex =
             nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionMorphKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex > m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionMorphKeyframeCreateAsReference(keyframe, status));
-        }
-        else if (frameIndex == m_localFrameIndex && isEmpty) {
+        if (frameIndex == m_localFrameIndex && isEmpty) {
             m_morphKeyframes.push_back(nanoemMutableMotionMorphKeyframeCreateAsReference(keyframe, status));
         }
     }
@@ -522,25 +416,20 @@ BaseShiftingAllKeyframesCommand::shiftAllMorphKeyframesForward(
          it != end; ++it) {
         nanoemMutableMotionRemoveMorphKeyframe(mutableMotion, *it, status);
     }
-    shiftAllMorphKeyframesWithOffset(mutableMotion, targets, -1, status);
 }
 
 void
-BaseShiftingAllKeyframesCommand::shiftAllSelfShadowKeyframesForward(
+BaseShiftingAllKeyframesCommand::removeAllSelfShadowKeyframes(
     nanoem_mutable_motion_t *mutableMotion, nanoem_status_t *status)
 {
     nanoem_rsize_t numKeyframes;
     nanoem_motion_self_shadow_keyframe_t *const *keyframes =
         nanoemMotionGetAllSelfShadowKeyframeObjects(m_motion->data(), &numKeyframes);
-    MutableSelfShadowKeyframeList targets;
     for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
         nanoem_motion_self_shadow_keyframe_t *keyframe = keyframes[i];
         nanoem_frame_index_t frameIndex =
             nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionSelfShadowKeyframeGetKeyframeObject(keyframe));
-        if (frameIndex > m_localFrameIndex) {
-            targets.push_back(nanoemMutableMotionSelfShadowKeyframeCreateAsReference(keyframe, status));
-        }
-        else if (frameIndex == m_localFrameIndex) {
+        if (frameIndex == m_localFrameIndex) {
             m_selfShadowKeyframes.push_back(nanoemMutableMotionSelfShadowKeyframeCreateAsReference(keyframe, status));
         }
     }
@@ -549,128 +438,6 @@ BaseShiftingAllKeyframesCommand::shiftAllSelfShadowKeyframesForward(
          it != end; ++it) {
         nanoemMutableMotionRemoveSelfShadowKeyframe(mutableMotion, *it, status);
     }
-    shiftAllSelfShadowKeyframesWithOffset(mutableMotion, targets, -1, status);
-}
-
-void
-BaseShiftingAllKeyframesCommand::shiftAllAccessoryKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-    const MutableAccessoryKeyframeList &keyframes, int offset, nanoem_status_t *status)
-{
-    for (MutableAccessoryKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoemMutableMotionRemoveAccessoryKeyframe(mutableMotion, *it, status);
-    }
-    for (MutableAccessoryKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoem_mutable_motion_accessory_keyframe_t *mutableKeyframe = *it;
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionAccessoryKeyframeGetKeyframeObject(
-                nanoemMutableMotionAccessoryKeyframeGetOriginObject(mutableKeyframe)));
-        nanoemMutableMotionAddAccessoryKeyframe(mutableMotion, mutableKeyframe, frameIndex + offset, status);
-        nanoemMutableMotionAccessoryKeyframeDestroy(mutableKeyframe);
-    }
-}
-
-void
-BaseShiftingAllKeyframesCommand::shiftAllBoneKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-    const MutableModelBoneKeyframeList &keyframes, int offset, nanoem_status_t *status)
-{
-    for (MutableModelBoneKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoemMutableMotionRemoveBoneKeyframe(mutableMotion, *it, status);
-    }
-    for (MutableModelBoneKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoem_mutable_motion_bone_keyframe_t *mutableKeyframe = *it;
-        nanoem_motion_bone_keyframe_t *origin = nanoemMutableMotionBoneKeyframeGetOriginObject(mutableKeyframe);
-        const nanoem_unicode_string_t *name = nanoemMotionBoneKeyframeGetName(origin);
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(origin));
-        nanoemMutableMotionAddBoneKeyframe(mutableMotion, mutableKeyframe, name, frameIndex + offset, status);
-        nanoemMutableMotionBoneKeyframeDestroy(mutableKeyframe);
-    }
-}
-
-void
-BaseShiftingAllKeyframesCommand::shiftAllCameraKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-    const MutableCameraKeyframeList &keyframes, int offset, nanoem_status_t *status)
-{
-    for (MutableCameraKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoemMutableMotionRemoveCameraKeyframe(mutableMotion, *it, status);
-    }
-    for (MutableCameraKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoem_mutable_motion_camera_keyframe_t *mutableKeyframe = *it;
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(
-                nanoemMutableMotionCameraKeyframeGetOriginObject(mutableKeyframe)));
-        nanoemMutableMotionAddCameraKeyframe(mutableMotion, mutableKeyframe, frameIndex + offset, status);
-        nanoemMutableMotionCameraKeyframeDestroy(mutableKeyframe);
-    }
-}
-
-void
-BaseShiftingAllKeyframesCommand::shiftAllLightKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-    const MutableLightKeyframeList &keyframes, int offset, nanoem_status_t *status)
-{
-    for (MutableLightKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoemMutableMotionRemoveLightKeyframe(mutableMotion, *it, status);
-    }
-    for (MutableLightKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoem_mutable_motion_light_keyframe_t *mutableKeyframe = *it;
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionLightKeyframeGetKeyframeObject(
-                nanoemMutableMotionLightKeyframeGetOriginObject(mutableKeyframe)));
-        nanoemMutableMotionAddLightKeyframe(mutableMotion, mutableKeyframe, frameIndex + offset, status);
-        nanoemMutableMotionLightKeyframeDestroy(mutableKeyframe);
-    }
-}
-
-void
-BaseShiftingAllKeyframesCommand::shiftAllModelKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-    const MutableModelKeyframeList &keyframes, int offset, nanoem_status_t *status)
-{
-    for (MutableModelKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoemMutableMotionRemoveModelKeyframe(mutableMotion, *it, status);
-    }
-    for (MutableModelKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoem_mutable_motion_model_keyframe_t *mutableKeyframe = *it;
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionModelKeyframeGetKeyframeObject(
-                nanoemMutableMotionModelKeyframeGetOriginObject(mutableKeyframe)));
-        nanoemMutableMotionAddModelKeyframe(mutableMotion, mutableKeyframe, frameIndex + offset, status);
-        nanoemMutableMotionModelKeyframeDestroy(mutableKeyframe);
-    }
-}
-
-void
-BaseShiftingAllKeyframesCommand::shiftAllMorphKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-    const MutableModelMorphKeyframeList &keyframes, int offset, nanoem_status_t *status)
-{
-    for (MutableModelMorphKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoemMutableMotionRemoveMorphKeyframe(mutableMotion, *it, status);
-    }
-    for (MutableModelMorphKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoem_mutable_motion_morph_keyframe_t *mutableKeyframe = *it;
-        nanoem_motion_morph_keyframe_t *origin = nanoemMutableMotionMorphKeyframeGetOriginObject(mutableKeyframe);
-        const nanoem_unicode_string_t *name = nanoemMotionMorphKeyframeGetName(origin);
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionMorphKeyframeGetKeyframeObject(origin));
-        nanoemMutableMotionAddMorphKeyframe(mutableMotion, mutableKeyframe, name, frameIndex + offset, status);
-        nanoemMutableMotionMorphKeyframeDestroy(mutableKeyframe);
-    }
-}
-
-void
-BaseShiftingAllKeyframesCommand::shiftAllSelfShadowKeyframesWithOffset(nanoem_mutable_motion_t *mutableMotion,
-    const MutableSelfShadowKeyframeList &keyframes, int offset, nanoem_status_t *status)
-{
-    for (MutableSelfShadowKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoemMutableMotionRemoveSelfShadowKeyframe(mutableMotion, *it, status);
-    }
-    for (MutableSelfShadowKeyframeList::const_iterator it = keyframes.begin(), end = keyframes.end(); it != end; ++it) {
-        nanoem_mutable_motion_self_shadow_keyframe_t *mutableKeyframe = *it;
-        nanoem_frame_index_t frameIndex =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionSelfShadowKeyframeGetKeyframeObject(
-                nanoemMutableMotionSelfShadowKeyframeGetOriginObject(mutableKeyframe)));
-        nanoemMutableMotionAddSelfShadowKeyframe(mutableMotion, mutableKeyframe, frameIndex + offset, status);
-        nanoemMutableMotionSelfShadowKeyframeDestroy(mutableKeyframe);
-    }
 }
 
 } /* namespace command */
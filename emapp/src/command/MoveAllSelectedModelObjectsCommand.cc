@@ -257,6 +257,7 @@ MoveAllSelectedModelObjectsCommand::State::transform(const Matrix4x4 &delta)
             vertex->m_simd.m_origin = bx::simd_ld(glm::value_ptr(newOrigin));
         }
         m_activeModel->markStagingVertexBufferDirty();
+        m_activeModel->markAllSpatialIndicesDirty();
         m_activeModel->updateStagingVertexBuffer();
         break;
     }
@@ -306,6 +307,7 @@ MoveAllSelectedModelObjectsCommand::State::commit(const Matrix4x4 &delta)
             vertex->m_simd.m_origin = bx::simd_ld(glm::value_ptr(newOrigin));
         }
         m_activeModel->markStagingVertexBufferDirty();
+        m_activeModel->markAllSpatialIndicesDirty();
         m_activeModel->updateStagingVertexBuffer();
         break;
     }
@@ -351,6 +353,7 @@ MoveAllSelectedModelObjectsCommand::State::reset()
             vertex->m_simd.m_origin = bx::simd_ld(glm::value_ptr(it->m_origin));
         }
         m_activeModel->markStagingVertexBufferDirty();
+        m_activeModel->markAllSpatialIndicesDirty();
         m_activeModel->updateStagingVertexBuffer();
         break;
     }
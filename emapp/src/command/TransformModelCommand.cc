@@ -157,6 +157,7 @@ TransformModelCommand::undo(Error &error)
         nanoemMutableModelJointSetOrigin(it->m_opaque, glm::value_ptr(origin));
     }
     m_activeModel->markStagingVertexBufferDirty();
+    m_activeModel->markAllSpatialIndicesDirty();
     m_activeModel->updateStagingVertexBuffer();
     assignError(status, error);
 }
@@ -200,6 +201,7 @@ TransformModelCommand::redo(Error &error)
         nanoemMutableModelJointSetOrigin(it->m_opaque, glm::value_ptr(newOrigin));
     }
     m_activeModel->markStagingVertexBufferDirty();
+    m_activeModel->markAllSpatialIndicesDirty();
     m_activeModel->updateStagingVertexBuffer();
     assignError(status, error);
 }
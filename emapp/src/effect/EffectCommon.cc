@@ -80,6 +80,194 @@ setMipFilter(nanoem_u32_t value, sg_filter &filter) NANOEM_DECL_NOEXCEPT
     }
 }
 
+static nanoem_u32_t
+normalizePreshaderOpcode(nanoem_u32_t opcode) NANOEM_DECL_NOEXCEPT
+{
+    return opcode >= FX9__EFFECT__DX9MS__OPCODE__PSO_SCALAR_OPS
+        ? opcode + (FX9__EFFECT__DX9MS__OPCODE__PSO_MIN_SCALAR - FX9__EFFECT__DX9MS__OPCODE__PSO_SCALAR_OPS)
+        : opcode;
+}
+
+static nanoem_f32_t
+dotPreshaderVector(const Vector4 &src0, const Vector4 &src1, nanoem_u32_t numElements) NANOEM_DECL_NOEXCEPT
+{
+    nanoem_f32_t value = 0;
+    switch (numElements) {
+    case 4:
+        value = glm::dot(src0, src1);
+        break;
+    case 3:
+        value = glm::dot(Vector3(src0), Vector3(src1));
+        break;
+    case 2:
+        value = glm::dot(Vector2(src0), Vector2(src1));
+        break;
+    case 1:
+        value = glm::dot(src0.x, src1.x);
+        break;
+    default:
+        break;
+    }
+    return value;
+}
+
+static nanoem_f32_t
+evaluatePreshaderScalar(nanoem_u32_t opcode, nanoem_f32_t src0, nanoem_f32_t src1, nanoem_f32_t src2,
+    nanoem_f32_t dst0) NANOEM_DECL_NOEXCEPT
+{
+    switch (static_cast<Fx9__Effect__Dx9ms__Opcode>(opcode)) {
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_ACOS: {
+        dst0 = glm::acos(src0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_ADD:
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_ADD_SCALAR: {
+        dst0 = src0 + src1;
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_ASIN: {
+        dst0 = glm::asin(src0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_ATAN: {
+        dst0 = glm::atan(src0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_ATAN2:
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_ATAN2_SCALAR: {
+        dst0 = glm::atan(src0, src1);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_CMP: {
+        dst0 = glm::mix(src2, src1, src0 >= 0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_COS: {
+        dst0 = glm::cos(src0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_DIV:
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_DIV_SCALAR: {
+        dst0 = src1 != 0.0f ? src0 / src1 : 0.0f;
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_EXP: {
+        dst0 = glm::exp(src0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_FRC: {
+        dst0 = glm::fract(src0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_GE:
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_GE_SCALAR: {
+        dst0 = src0 >= src1;
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_SIN: {
+        dst0 = glm::sin(src0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_LT:
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_LT_SCALAR: {
+        dst0 = src0 < src1;
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_LOG: {
+        dst0 = glm::log(src0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_NOISE_SCALAR: {
+        // dst0 = glm::perlin(src0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_MOV: {
+        dst0 = src0;
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_NOISE: {
+        // dst0 = glm::perlin(src0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_MAX:
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_MAX_SCALAR: {
+        dst0 = glm::max(src0, src1);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_MIN:
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_MIN_SCALAR: {
+        dst0 = glm::min(src0, src1);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_MOVC:
+        break;
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_MUL:
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_MUL_SCALAR: {
+        dst0 = src0 * src1;
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_NEG: {
+        dst0 = -src0;
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_NOP:
+        break;
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_RCP: {
+        nanoem_f32_t f = src0;
+        dst0 = (f == 0.0f ? 0.0f : (f != 1.0f ? 1.0f / f : f));
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_RSQ: {
+        dst0 = glm::inversesqrt(src0);
+        break;
+    }
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_DOT:
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_DOT_SCALAR:
+    case FX9__EFFECT__DX9MS__OPCODE__PSO_SCALAR_OPS:
+    default:
+        nanoem_assert(false, "must NOT reach here");
+        break;
+    }
+    return dst0;
+}
+
+static bool
+containsIndex(nanoem_u32_t value, const tinystl::vector<nanoem_u32_t, TinySTLAllocator> &indices) NANOEM_DECL_NOEXCEPT
+{
+    for (tinystl::vector<nanoem_u32_t, TinySTLAllocator>::const_iterator it = indices.begin(), end = indices.end();
+         it != end; ++it) {
+        if (*it == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void
+appendUniqueIndex(nanoem_u32_t value, tinystl::vector<nanoem_u32_t, TinySTLAllocator> &indices)
+{
+    if (!containsIndex(value, indices)) {
+        indices.push_back(value);
+    }
+}
+
+static void
+snapshotPreshaderDependencies(const tinystl::vector<nanoem_u32_t, TinySTLAllocator> &indices,
+    const GlobalUniform::Buffer &buffer, nanoem_f32_t *cachedPtr, bool &changed) NANOEM_DECL_NOEXCEPT
+{
+    const nanoem_rsize_t numScalars = buffer.m_float4.size() * 4;
+    const nanoem_f32_t *valuesPtr = numScalars > 0 ? glm::value_ptr(buffer.m_float4[0]) : nullptr;
+    for (tinystl::vector<nanoem_u32_t, TinySTLAllocator>::const_iterator it = indices.begin(), end = indices.end();
+         it != end; ++it, ++cachedPtr) {
+        const nanoem_u32_t index = *it;
+        const nanoem_f32_t value = index < numScalars ? valuesPtr[index] : 0.0f;
+        if (memcmp(&value, cachedPtr, sizeof(value)) != 0) {
+            *cachedPtr = value;
+            changed = true;
+        }
+    }
+}
+
 } /* namespace anonymous */
 
 PipelineDescriptor::Stencil::Stencil()
@@ -266,6 +454,8 @@ RegisterIndex::~RegisterIndex() NANOEM_DECL_NOEXCEPT
 {
 }
 
+const nanoem_u32_t UniformSlot::kInvalidIndex = nanoem_u32_t(-1);
+
 SamplerRegisterIndex::SamplerRegisterIndex()
     : m_type(0)
     , m_flags(0)
@@ -622,6 +812,9 @@ Preshader::Symbol::~Symbol() NANOEM_DECL_NOEXCEPT
 
 Preshader::Preshader()
     : m_numTemporaryRegisters(0)
+    , m_numEvaluations(0)
+    , m_compiled(false)
+    , m_cached(false)
 {
 }
 
@@ -708,7 +901,193 @@ UIWidgetParameter::~UIWidgetParameter() NANOEM_DECL_NOEXCEPT
 }
 
 void
-Preshader::execute(const GlobalUniform::Buffer &inputBuffer, GlobalUniform::Buffer &outputBuffer) const
+Preshader::compile()
+{
+    /* padding for vector reads of the last temporary register */
+    static const nanoem_u32_t kNumTemporaryRegisterPaddings = 8;
+    const size_t numInstructions = m_instructions.size();
+    m_operations.resize(numInstructions);
+    m_temporaryRegisters.resize(m_numTemporaryRegisters + kNumTemporaryRegisterPaddings);
+    m_inputDependencies.clear();
+    m_outputDependencies.clear();
+    m_writtenOutputs.clear();
+    for (size_t i = 0; i < numInstructions; i++) {
+        const Instruction &instruction = m_instructions[i];
+        const size_t numOperands = glm::min(instruction.m_operands.size(), size_t(4));
+        const bool isScalarOp = instruction.m_opcode >= FX9__EFFECT__DX9MS__OPCODE__PSO_SCALAR_OPS;
+        Operation &operation = m_operations[i];
+        operation.m_opcode = normalizePreshaderOpcode(instruction.m_opcode);
+        operation.m_numElements = glm::min(instruction.m_numElements, 4u);
+        operation.m_destinationFileType = kRegisterFileTypeNone;
+        operation.m_destinationOffset = 0;
+        for (size_t j = 0; j < BX_COUNTOF(operation.m_sources); j++) {
+            Source &source = operation.m_sources[j];
+            source.m_fileType = kRegisterFileTypeNone;
+            source.m_offset = source.m_stride = source.m_dotOffset = source.m_dotStride = 0;
+        }
+        for (size_t j = 0; j < numOperands; j++) {
+            const Preshader::Operand &operand = instruction.m_operands[j];
+            const nanoem_u32_t scalarIndex = operand.m_index;
+            const bool isDestination = j == numOperands - 1;
+            Source source;
+            source.m_fileType = kRegisterFileTypeNone;
+            source.m_offset = source.m_dotOffset = scalarIndex;
+            source.m_stride = source.m_dotStride = 1;
+            switch (static_cast<Fx9__Effect__Dx9ms__OperandType>(operand.m_type)) {
+            case FX9__EFFECT__DX9MS__OPERAND_TYPE__PSOT_INPUT: {
+                source.m_fileType = kRegisterFileTypeInput;
+                source.m_dotOffset = scalarIndex & ~3u;
+                break;
+            }
+            case FX9__EFFECT__DX9MS__OPERAND_TYPE__PSOT_LITERAL: {
+                source.m_fileType = kRegisterFileTypeLiteral;
+                source.m_stride = source.m_dotStride = 0;
+                break;
+            }
+            case FX9__EFFECT__DX9MS__OPERAND_TYPE__PSOT_OUTPUT: {
+                source.m_fileType = kRegisterFileTypeOutput;
+                source.m_dotOffset = scalarIndex & ~3u;
+                if (isDestination) {
+                    operation.m_destinationFileType = kRegisterFileTypeOutput;
+                    operation.m_destinationOffset = scalarIndex;
+                    for (nanoem_u32_t k = 0; k < operation.m_numElements; k++) {
+                        appendUniqueIndex(scalarIndex + k, m_writtenOutputs);
+                    }
+                }
+                break;
+            }
+            case FX9__EFFECT__DX9MS__OPERAND_TYPE__PSOT_TEMP: {
+                if (scalarIndex < m_numTemporaryRegisters) {
+                    source.m_fileType = kRegisterFileTypeTemporary;
+                    if (isScalarOp) {
+                        source.m_stride = source.m_dotStride = 0;
+                    }
+                    else {
+                        /* same as the interpreter that applies the component offset to the loaded vector */
+                        source.m_offset = scalarIndex + scalarIndex % 4;
+                    }
+                    if (isDestination) {
+                        operation.m_destinationFileType = kRegisterFileTypeTemporary;
+                        operation.m_destinationOffset = scalarIndex;
+                    }
+                }
+                break;
+            }
+            default:
+                nanoem_assert(false, "must NOT reach here");
+                break;
+            }
+            if (j < BX_COUNTOF(operation.m_sources)) {
+                const bool isDot = operation.m_opcode == FX9__EFFECT__DX9MS__OPCODE__PSO_DOT;
+                const nanoem_u32_t offset = isDot ? source.m_dotOffset : source.m_offset;
+                operation.m_sources[j] = source;
+                for (nanoem_u32_t k = 0; k < operation.m_numElements; k++) {
+                    const nanoem_u32_t index = offset + k;
+                    if (source.m_fileType == kRegisterFileTypeInput) {
+                        appendUniqueIndex(index, m_inputDependencies);
+                    }
+                    /* outputs written by the preceding instructions are not the external dependencies */
+                    else if (source.m_fileType == kRegisterFileTypeOutput && !containsIndex(index, m_writtenOutputs)) {
+                        appendUniqueIndex(index, m_outputDependencies);
+                    }
+                }
+            }
+        }
+    }
+    m_cachedDependencies.resize(m_inputDependencies.size() + m_outputDependencies.size());
+    m_cachedOutputs.resize(m_writtenOutputs.size());
+    m_compiled = true;
+    m_cached = false;
+}
+
+void
+Preshader::execute(const GlobalUniform::Buffer &inputBuffer, GlobalUniform::Buffer &outputBuffer)
+{
+    if (!m_compiled) {
+        compile();
+    }
+    if (m_operations.empty()) {
+        return;
+    }
+    const nanoem_rsize_t numOutputs = outputBuffer.m_float4.size() * 4;
+    nanoem_f32_t *outputPtr = numOutputs > 0 ? glm::value_ptr(outputBuffer.m_float4[0]) : nullptr;
+    bool changed = !m_cached;
+    snapshotPreshaderDependencies(m_inputDependencies, inputBuffer, m_cachedDependencies.data(), changed);
+    snapshotPreshaderDependencies(
+        m_outputDependencies, outputBuffer, m_cachedDependencies.data() + m_inputDependencies.size(), changed);
+    if (changed) {
+        const nanoem_f32_t *registerFiles[kRegisterFileTypeMaxEnum] = {
+            inputBuffer.m_float4.empty() ? nullptr : glm::value_ptr(inputBuffer.m_float4[0]),
+            outputPtr,
+            m_literals.data(),
+            m_temporaryRegisters.data(),
+            nullptr,
+        };
+        const nanoem_rsize_t registerFileSizes[kRegisterFileTypeMaxEnum] = {
+            inputBuffer.m_float4.size() * 4,
+            numOutputs,
+            m_literals.size(),
+            m_temporaryRegisters.size(),
+            0,
+        };
+        nanoem_f32_t *destinationFiles[kRegisterFileTypeMaxEnum] = {
+            nullptr,
+            outputPtr,
+            nullptr,
+            m_temporaryRegisters.data(),
+            nullptr,
+        };
+        memset(m_temporaryRegisters.data(), 0, m_temporaryRegisters.size() * sizeof(m_temporaryRegisters[0]));
+        for (tinystl::vector<Operation, TinySTLAllocator>::const_iterator it = m_operations.begin(),
+                                                                          end = m_operations.end();
+             it != end; ++it) {
+            const Operation &operation = *it;
+            const nanoem_u32_t numElements = operation.m_numElements;
+            Vector4 dst(Constants::kZeroV4);
+            if (operation.m_opcode == FX9__EFFECT__DX9MS__OPCODE__PSO_DOT) {
+                Vector4 src[2];
+                for (nanoem_u32_t j = 0; j < 2; j++) {
+                    const Source &source = operation.m_sources[j];
+                    const nanoem_f32_t *filePtr = registerFiles[source.m_fileType];
+                    const nanoem_rsize_t fileSize = registerFileSizes[source.m_fileType];
+                    for (nanoem_u32_t k = 0; k < 4; k++) {
+                        const nanoem_rsize_t index = source.m_dotOffset + k * source.m_dotStride;
+                        src[j][k] = index < fileSize ? filePtr[index] : 0.0f;
+                    }
+                }
+                dst = Vector4(dotPreshaderVector(src[0], src[1], numElements));
+            }
+            /* elementwise results are written as zeros same as the interpreter */
+            if (nanoem_f32_t *destinationPtr = destinationFiles[operation.m_destinationFileType]) {
+                const nanoem_rsize_t fileSize = registerFileSizes[operation.m_destinationFileType];
+                for (nanoem_u32_t j = 0; j < numElements; j++) {
+                    const nanoem_rsize_t index = operation.m_destinationOffset + j;
+                    if (index < fileSize) {
+                        destinationPtr[index] = dst[j];
+                    }
+                }
+            }
+        }
+        for (size_t i = 0, numWrittenOutputs = m_writtenOutputs.size(); i < numWrittenOutputs; i++) {
+            const nanoem_u32_t index = m_writtenOutputs[i];
+            m_cachedOutputs[i] = index < numOutputs ? outputPtr[index] : 0.0f;
+        }
+        m_cached = true;
+        m_numEvaluations++;
+    }
+    else {
+        /* output registers are shared with the other passes so the cached results must be written again */
+        for (size_t i = 0, numWrittenOutputs = m_writtenOutputs.size(); i < numWrittenOutputs; i++) {
+            const nanoem_u32_t index = m_writtenOutputs[i];
+            if (index < numOutputs) {
+                outputPtr[index] = m_cachedOutputs[i];
+            }
+        }
+    }
+}
+
+void
+Preshader::interpret(const GlobalUniform::Buffer &inputBuffer, GlobalUniform::Buffer &outputBuffer) const
 {
     const size_t numInstructions = m_instructions.size();
     tinystl::vector<nanoem_f32_t, TinySTLAllocator> temp(m_numTemporaryRegisters);
@@ -773,152 +1152,17 @@ Preshader::execute(const GlobalUniform::Buffer &inputBuffer, GlobalUniform::Buff
                 break;
             }
         }
-        const nanoem_u32_t opcode = isScalarOp ? instruction.m_opcode +
-                (FX9__EFFECT__DX9MS__OPCODE__PSO_MIN_SCALAR - FX9__EFFECT__DX9MS__OPCODE__PSO_SCALAR_OPS)
-                                               : instruction.m_opcode;
+        const nanoem_u32_t opcode = normalizePreshaderOpcode(instruction.m_opcode);
         const nanoem_u32_t numElements = instruction.m_numElements;
         nanoem_assert(numElements <= 4, "must NOT be greater than 4");
-        // fprintf(stderr, "INS[%d]: %s\n", i, instruction.toString(this).c_str());
         if (opcode == FX9__EFFECT__DX9MS__OPCODE__PSO_DOT) {
-            switch (numElements) {
-            case 4:
-                dst = Vector4(glm::dot(src[0], src[1]));
-                break;
-            case 3:
-                dst = Vector4(glm::dot(Vector3(src[0]), Vector3(src[1])));
-                break;
-            case 2:
-                dst = Vector4(glm::dot(Vector2(src[0]), Vector2(src[1])));
-                break;
-            case 1:
-                dst = Vector4(glm::dot(src[0].x, src[1].x));
-                break;
-            default:
-                break;
-            }
+            dst = Vector4(dotPreshaderVector(src[0], src[1], numElements));
         }
         else {
             for (nanoem_u32_t j = 0; j < numElements; j++) {
-                nanoem_f32_t src0 = src[0][j + soffset[0]];
-                nanoem_f32_t src1 = src[1][j + soffset[1]];
-                nanoem_f32_t src2 = src[2][j + soffset[2]];
-                nanoem_f32_t dst0 = dst[j];
-                switch (static_cast<Fx9__Effect__Dx9ms__Opcode>(opcode)) {
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_ACOS: {
-                    dst0 = glm::acos(src0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_ADD:
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_ADD_SCALAR: {
-                    dst0 = src0 + src1;
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_ASIN: {
-                    dst0 = glm::asin(src0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_ATAN: {
-                    dst0 = glm::atan(src0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_ATAN2:
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_ATAN2_SCALAR: {
-                    dst0 = glm::atan(src0, src1);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_CMP: {
-                    dst0 = glm::mix(src2, src1, src0 >= 0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_COS: {
-                    dst0 = glm::cos(src0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_DIV:
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_DIV_SCALAR: {
-                    dst0 = src1 != 0.0f ? src0 / src1 : 0.0f;
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_EXP: {
-                    dst0 = glm::exp(src0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_FRC: {
-                    dst0 = glm::fract(src0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_GE:
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_GE_SCALAR: {
-                    dst0 = src0 >= src1;
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_SIN: {
-                    dst0 = glm::sin(src0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_LT:
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_LT_SCALAR: {
-                    dst0 = src0 < src1;
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_LOG: {
-                    dst0 = glm::log(src0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_NOISE_SCALAR: {
-                    // dst0 = glm::perlin(src0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_MOV: {
-                    dst0 = src0;
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_NOISE: {
-                    // dst0 = glm::perlin(src0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_MAX:
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_MAX_SCALAR: {
-                    dst0 = glm::max(src0, src1);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_MIN:
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_MIN_SCALAR: {
-                    dst0 = glm::min(src0, src1);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_MOVC:
-                    break;
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_MUL:
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_MUL_SCALAR: {
-                    dst0 = src0 * src1;
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_NEG: {
-                    dst0 = -src0;
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_NOP:
-                    break;
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_RCP: {
-                    nanoem_f32_t f = src0;
-                    dst0 = (f == 0.0f ? 0.0f : (f != 1.0f ? 1.0f / f : f));
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_RSQ: {
-                    dst0 = glm::inversesqrt(src0);
-                    break;
-                }
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_DOT:
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_DOT_SCALAR:
-                case FX9__EFFECT__DX9MS__OPCODE__PSO_SCALAR_OPS:
-                default:
-                    nanoem_assert(false, "must NOT reach here");
-                    break;
-                }
+                const nanoem_f32_t dst0 = evaluatePreshaderScalar(
+                    opcode, src[0][j + soffset[0]], src[1][j + soffset[1]], src[2][j + soffset[2]], dst[j]);
                 BX_UNUSED_1(dst0);
-                // fprintf(stderr, "  dst[%d] = %3f src0 = %3f src1 = %3f src2 = %3f\n",
-                // j, dst0, src0, src1, src2);
             }
         }
         if (outputPtr) {
@@ -943,6 +1187,7 @@ NonSemanticParameter::NonSemanticParameter(
     const String &name, const GlobalUniform::Vector4List &values, const AnnotationMap &annotations)
     : AnnotatableParameter(name, annotations)
     , m_values(values)
+    , m_uniformSlotIndex(UniformSlot::kInvalidIndex)
 {
 }
 
@@ -963,6 +1208,7 @@ MatrixUniform::MatrixUniform(const String &name, MatrixType type, bool inversed,
     , m_type(type)
     , m_inversed(inversed)
     , m_transposed(transposed)
+    , m_uniformSlotIndex(UniformSlot::kInvalidIndex)
 {
 }
 
@@ -1032,7 +1278,17 @@ ImageSampler::~ImageSampler() NANOEM_DECL_NOEXCEPT
 ControlObjectTarget::ControlObjectTarget(const String &name, ParameterType type)
     : m_name(name)
     , m_type(type)
+    , m_objectType(StringUtils::equals(name.c_str(), "(self)")
+              ? kObjectTypeSelf
+              : StringUtils::equals(name.c_str(), "(OffscreenOwner)") ? kObjectTypeOffscreenOwner : kObjectTypeFilename)
     , m_value(0)
+    , m_modelPtr(nullptr)
+    , m_accessoryPtr(nullptr)
+    , m_objectGeneration(0)
+    , m_itemModelPtr(nullptr)
+    , m_bonePtr(nullptr)
+    , m_morphPtr(nullptr)
+    , m_itemGeneration(0)
 {
 }
 
@@ -437,6 +437,7 @@ parsePreshader(const Fx9__Effect__Dx9ms__Shader *shaderPtr, Preshader &preshader
             nanoem_f64_t literal = preshaderPtr->literals[i];
             preshader.m_literals[i] = nanoem_f32_t(literal);
         }
+        preshader.compile();
     }
 }
 
@@ -51,11 +51,22 @@ GlobalUniform::Buffer::elementCount() const NANOEM_DECL_NOEXCEPT
     return m_float4.size();
 }
 
+GlobalUniform::Block::Block()
+    : m_object(nullptr)
+    , m_parameter(0)
+    , m_retained(false)
+{
+}
+
 GlobalUniform::GlobalUniform()
     : m_vertexShaderBuffer(SG_SHADERSTAGE_VS)
     , m_pixelShaderBuffer(SG_SHADERSTAGE_FS)
     , m_preshaderVertexShaderBuffer(SG_SHADERSTAGE_VS)
     , m_preshaderPixelShaderBuffer(SG_SHADERSTAGE_FS)
+    , m_owner(nullptr)
+    , m_drawable(nullptr)
+    , m_numWrittenBytes(0)
+    , m_numLastFrameWrittenBytes(0)
 {
 }
 
@@ -63,5 +74,60 @@ GlobalUniform::~GlobalUniform() NANOEM_DECL_NOEXCEPT
 {
 }
 
+void
+GlobalUniform::acquire(const void *owner, const void *drawable)
+{
+    if (owner != m_owner || drawable != m_drawable) {
+        /* values written by another pass or for another drawable must not leak into this draw */
+        m_vertexShaderBuffer.reset();
+        m_pixelShaderBuffer.reset();
+        for (int i = kBlockTypeFirstEnum; i < kBlockTypeMaxEnum; i++) {
+            m_blocks[i].m_retained = false;
+        }
+        m_owner = owner;
+        m_drawable = drawable;
+    }
+}
+
+bool
+GlobalUniform::retain(BlockType type, const void *owner, const void *object, const Matrix4x4 &parameter)
+{
+    bool retained = false;
+    if (owner == m_owner) {
+        Block &block = m_blocks[type];
+        retained = block.m_retained && block.m_object == object && block.m_parameter == parameter;
+        if (!retained) {
+            block.m_object = object;
+            block.m_parameter = parameter;
+            block.m_retained = true;
+        }
+    }
+    return retained;
+}
+
+void
+GlobalUniform::invalidate(BlockType type) NANOEM_DECL_NOEXCEPT
+{
+    m_blocks[type].m_retained = false;
+}
+
+void
+GlobalUniform::invalidateAll() NANOEM_DECL_NOEXCEPT
+{
+    for (int i = kBlockTypeFirstEnum; i < kBlockTypeMaxEnum; i++) {
+        m_blocks[i].m_retained = false;
+    }
+    /* forces the next owner to clear buffers */
+    m_owner = m_drawable = nullptr;
+}
+
+void
+GlobalUniform::endFrame() NANOEM_DECL_NOEXCEPT
+{
+    invalidateAll();
+    m_numLastFrameWrittenBytes = m_numWrittenBytes;
+    m_numWrittenBytes = 0;
+}
+
 } /* namespace effect */
 } /* namespace nanoem */
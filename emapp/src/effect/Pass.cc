@@ -53,6 +53,10 @@ Pass::Pass(Effect *effect, const String &name, const PipelineDescriptor &pd,
     m_vertexBuffer = { SG_INVALID_ID };
     const String s(annotations.stringAnnotation(kScriptKeyLiteral, String("Draw=Geometry;")));
     Effect::parseScript(s, m_script);
+    resolveAllUniformSlots(m_registerIndices.m_vertexPreshader, UniformSlot::kRegisterTypeVertexPreshader);
+    resolveAllUniformSlots(m_registerIndices.m_pixelPreshader, UniformSlot::kRegisterTypePixelPreshader);
+    resolveAllUniformSlots(m_registerIndices.m_vertexShader, UniformSlot::kRegisterTypeVertexShader);
+    resolveAllUniformSlots(m_registerIndices.m_pixelShader, UniformSlot::kRegisterTypePixelShader);
 }
 
 Pass::~Pass() NANOEM_DECL_NOEXCEPT
@@ -97,7 +101,9 @@ Pass::registerPipelineSet(const sg_pipeline_desc &desc)
         }
         pipeline = sg::make_pipeline(&newDesc);
         if (sg::query_pipeline_state(pipeline) == SG_RESOURCESTATE_VALID) {
-            m_techniquePtr->effect()->project()->setRenderPipelineName(pipeline, label);
+            Project *project = m_techniquePtr->effect()->project();
+            project->setRenderPipelineName(pipeline, label);
+            project->setRenderPipelineSortable(pipeline, newDesc, this);
             m_pipelineSet.insert(tinystl::make_pair(key, pipeline));
         }
         else {
@@ -400,6 +406,12 @@ Pass::pipelineDescriptor() const NANOEM_DECL_NOEXCEPT
     return m_pipelineDescriptor;
 }
 
+const PreshaderPair &
+Pass::preshaderPair() const NANOEM_DECL_NOEXCEPT
+{
+    return m_preshaderPair;
+}
+
 void
 Pass::setParentTechnique(Technique *value)
 {
@@ -490,5 +502,23 @@ Pass::findPixelShaderSamplerRegisterIndex(const String &name, SamplerRegisterInd
     return found;
 }
 
+const UniformSlot *
+Pass::findUniformSlot(nanoem_u32_t index) const NANOEM_DECL_NOEXCEPT
+{
+    return index < m_uniformSlots.size() ? &m_uniformSlots[index] : nullptr;
+}
+
+void
+Pass::resolveAllUniformSlots(const RegisterIndexMap &indices, UniformSlot::RegisterType type)
+{
+    for (RegisterIndexMap::const_iterator it = indices.begin(), end = indices.end(); it != end; ++it) {
+        const nanoem_u32_t index = m_effect->resolveUniformSlotIndex(it->first);
+        if (index >= m_uniformSlots.size()) {
+            m_uniformSlots.resize(index + 1);
+        }
+        m_uniformSlots[index].m_registerIndices[type] = it->second;
+    }
+}
+
 } /* namespace effect */
 } /* namespace nanoem */
@@ -0,0 +1,156 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/internal/BoundingVolumeHierarchy.h"
+
+#include "emapp/private/CommonInclude.h"
+
+namespace nanoem {
+namespace internal {
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+{
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy() NANOEM_DECL_NOEXCEPT
+{
+}
+
+void
+BoundingVolumeHierarchy::build(const PointList &points)
+{
+    clear();
+    const nanoem_u32_t numPoints = Inline::saturateInt32U(points.size());
+    if (numPoints > 0) {
+        m_indices.resize(numPoints);
+        for (nanoem_u32_t i = 0; i < numPoints; i++) {
+            m_indices[i] = i;
+        }
+        m_nodes.reserve((numPoints / kMaxLeafPoints + 1) * 2);
+        buildNode(points, 0, numPoints);
+    }
+}
+
+void
+BoundingVolumeHierarchy::refit(const PointList &points)
+{
+    if (points.size() != m_indices.size()) {
+        build(points);
+    }
+    else {
+        /* children are always placed after their parent so reverse order visits them first */
+        for (nanoem_rsize_t i = m_nodes.size(); i > 0; i--) {
+            Node &node = m_nodes[i - 1];
+            if (node.m_count > 0) {
+                Vector3 aabbMin(FLT_MAX), aabbMax(-FLT_MAX);
+                for (nanoem_u32_t j = node.m_offset, end = node.m_offset + node.m_count; j < end; j++) {
+                    const Vector3 &point = points[m_indices[j]];
+                    aabbMin = glm::min(aabbMin, point);
+                    aabbMax = glm::max(aabbMax, point);
+                }
+                node.m_aabbMin = aabbMin;
+                node.m_aabbMax = aabbMax;
+            }
+            else {
+                const Node &left = m_nodes[i], &right = m_nodes[node.m_offset];
+                node.m_aabbMin = glm::min(left.m_aabbMin, right.m_aabbMin);
+                node.m_aabbMax = glm::max(left.m_aabbMax, right.m_aabbMax);
+            }
+        }
+    }
+}
+
+void
+BoundingVolumeHierarchy::query(const ICuller *culler, IndexList &indices) const
+{
+    if (!m_nodes.empty()) {
+        IndexList stack;
+        stack.push_back(0);
+        while (!stack.empty()) {
+            const nanoem_u32_t nodeIndex = stack.back();
+            const Node &node = m_nodes[nodeIndex];
+            stack.pop_back();
+            if (culler->intersects(node.m_aabbMin, node.m_aabbMax)) {
+                if (node.m_count > 0) {
+                    for (nanoem_u32_t i = node.m_offset, end = node.m_offset + node.m_count; i < end; i++) {
+                        indices.push_back(m_indices[i]);
+                    }
+                }
+                else {
+                    stack.push_back(node.m_offset);
+                    stack.push_back(nodeIndex + 1);
+                }
+            }
+        }
+    }
+}
+
+void
+BoundingVolumeHierarchy::clear()
+{
+    m_nodes.clear();
+    m_indices.clear();
+}
+
+nanoem_rsize_t
+BoundingVolumeHierarchy::numPoints() const NANOEM_DECL_NOEXCEPT
+{
+    return m_indices.size();
+}
+
+nanoem_rsize_t
+BoundingVolumeHierarchy::numNodes() const NANOEM_DECL_NOEXCEPT
+{
+    return m_nodes.size();
+}
+
+nanoem_u32_t
+BoundingVolumeHierarchy::buildNode(const PointList &points, nanoem_u32_t begin, nanoem_u32_t end)
+{
+    const nanoem_u32_t nodeIndex = Inline::saturateInt32U(m_nodes.size()), count = end - begin;
+    Vector3 aabbMin(FLT_MAX), aabbMax(-FLT_MAX);
+    for (nanoem_u32_t i = begin; i < end; i++) {
+        const Vector3 &point = points[m_indices[i]];
+        aabbMin = glm::min(aabbMin, point);
+        aabbMax = glm::max(aabbMax, point);
+    }
+    m_nodes.push_back(Node());
+    if (count <= kMaxLeafPoints) {
+        Node &node = m_nodes[nodeIndex];
+        node.m_aabbMin = aabbMin;
+        node.m_aabbMax = aabbMax;
+        node.m_offset = begin;
+        node.m_count = count;
+    }
+    else {
+        /* split at the center of the longest axis and fall back to halve when all points are on one side */
+        const Vector3 extent(aabbMax - aabbMin);
+        const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        const nanoem_f32_t pivot = (aabbMin[axis] + aabbMax[axis]) * 0.5f;
+        nanoem_u32_t middle = begin;
+        for (nanoem_u32_t i = begin; i < end; i++) {
+            if (points[m_indices[i]][axis] < pivot) {
+                const nanoem_u32_t index = m_indices[i];
+                m_indices[i] = m_indices[middle];
+                m_indices[middle++] = index;
+            }
+        }
+        if (middle == begin || middle == end) {
+            middle = begin + count / 2;
+        }
+        buildNode(points, begin, middle);
+        const nanoem_u32_t right = buildNode(points, middle, end);
+        Node &node = m_nodes[nodeIndex];
+        node.m_aabbMin = aabbMin;
+        node.m_aabbMax = aabbMax;
+        node.m_offset = right;
+        node.m_count = 0;
+    }
+    return nodeIndex;
+}
+
+} /* namespace internal */
+} /* namespace nanoem */
@@ -1094,14 +1094,32 @@ CapturingPassState::prepareCapturingViewport(Project *project)
 void
 CapturingPassState::readPassImage()
 {
-    sg::read_pass(m_outputPass, m_frameStagingBuffer, m_frameImageData.data(), m_frameImageData.size());
+    readPassImage(m_frameImageData.data());
+}
+
+void
+CapturingPassState::readPassImage(nanoem_u8_t *data)
+{
+    sg::read_pass(m_outputPass, m_frameStagingBuffer, data, m_frameImageData.size());
+    copyFrameImage(data, data);
+}
+
+void
+CapturingPassState::copyFrameImage(const void *source, nanoem_u8_t *dest) const
+{
+    const size_t size = m_frameImageData.size();
     if (m_outputImageDescription.pixel_format == SG_PIXELFORMAT_RGBA8) {
-        nanoem_u32_t *dataPtr = reinterpret_cast<nanoem_u32_t *>(m_frameImageData.data());
-        for (size_t i = 0, size = m_frameImageData.size() / sizeof(*dataPtr); i < size; i++) {
-            nanoem_u32_t *ptr = dataPtr + i, v = *ptr;
-            *ptr = 0 | ((v & 0x000000ff) << 16) | (v & 0x0000ff00) | ((v & 0x00ff0000) >> 16) | (v & 0xff000000);
+        /* swizzles while copying to avoid touching the destination twice */
+        const nanoem_u32_t *sourcePtr = static_cast<const nanoem_u32_t *>(source);
+        nanoem_u32_t *destPtr = reinterpret_cast<nanoem_u32_t *>(dest);
+        for (size_t i = 0, numPixels = size / sizeof(*destPtr); i < numPixels; i++) {
+            const nanoem_u32_t v = sourcePtr[i];
+            destPtr[i] = 0 | ((v & 0x000000ff) << 16) | (v & 0x0000ff00) | ((v & 0x00ff0000) >> 16) | (v & 0xff000000);
         }
     }
+    else if (source != dest) {
+        memcpy(dest, source, size);
+    }
 }
 
 StateController *
@@ -1526,16 +1544,7 @@ CapturingPassAsVideoState::handleCaptureViaEncoderPlugin(Project *project, nanoe
             bx::MutexScope scope(m_state->mutex());
             Error error;
             if (m_state->frameImageData().size() == size) {
-                memcpy(m_state->mutableFrameImageDataPtr(), data, size);
-                if (m_state->outputImageDescription().pixel_format == SG_PIXELFORMAT_RGBA8) {
-                    nanoem_u32_t *dataPtr = reinterpret_cast<nanoem_u32_t *>(m_state->mutableFrameImageDataPtr());
-                    for (size_t i = 0, numPixels = size / sizeof(*dataPtr); i < numPixels; i++) {
-                        nanoem_u32_t *ptr = dataPtr + i, v = *ptr;
-                        *ptr = 0 | ((v & 0x000000ff) << 16) | (v & 0x0000ff00) | ((v & 0x00ff0000) >> 16) |
-                            (v & 0xff000000);
-                    }
-                }
-                if (!m_state->encodeVideoFrame(m_state->frameImageData(), m_audioPTS, m_videoPTS, error)) {
+                if (!m_state->encodeVideoFrame(data, m_audioPTS, m_videoPTS, error)) {
                     m_state->stopEncoding(error);
                     m_state->setStateTransition(kCancelled);
                 }
@@ -1565,8 +1574,7 @@ CapturingPassAsVideoState::handleCaptureViaEncoderPlugin(Project *project, nanoe
             sg::read_pass_async(outputPass(), frameStagingBuffer(), &AsyncReadHandler::handleReadPassAsync, handler);
         }
         else {
-            readPassImage();
-            if (!encodeVideoFrame(frameImageData(), audioPTS, videoPTS, error)) {
+            if (!encodeVideoFrame(nullptr, audioPTS, videoPTS, error)) {
                 setStateTransition(kCancelled);
             }
         }
@@ -1577,7 +1585,7 @@ CapturingPassAsVideoState::handleCaptureViaEncoderPlugin(Project *project, nanoe
 
 bool
 CapturingPassAsVideoState::encodeVideoFrame(
-    const ByteArray &frameData, nanoem_frame_index_t audioPTS, nanoem_frame_index_t videoPTS, Error &error)
+    const void *data, nanoem_frame_index_t audioPTS, nanoem_frame_index_t videoPTS, Error &error)
 {
     bool continuable = true;
     if (m_encoderPluginPtr && (lastVideoPTS() == Motion::kMaxFrameIndex || videoPTS > lastVideoPTS())) {
@@ -1594,7 +1602,29 @@ CapturingPassAsVideoState::encodeVideoFrame(
             continuable &=
                 m_encoderPluginPtr->encodeAudioFrame(nanoem_frame_index_t(videoPTS), slice.data(), slice.size(), error);
         }
-        continuable &= m_encoderPluginPtr->encodeVideoFrame(videoPTS, frameData.data(), frameData.size(), error);
+        /* writes the frame into the buffer owned by the encoder if possible, and null data reads the pass directly */
+        const size_t size = frameImageData().size();
+        if (nanoem_u8_t *buffer = m_encoderPluginPtr->acquireVideoFrameBuffer(size, error)) {
+            if (data) {
+                copyFrameImage(data, buffer);
+            }
+            else {
+                readPassImage(buffer);
+            }
+            continuable &= m_encoderPluginPtr->submitVideoFrameBuffer(videoPTS, buffer, error);
+        }
+        else if (!error.hasReason()) {
+            if (data) {
+                copyFrameImage(data, mutableFrameImageDataPtr());
+            }
+            else {
+                readPassImage();
+            }
+            continuable &= m_encoderPluginPtr->encodeVideoFrame(videoPTS, frameImageData().data(), size, error);
+        }
+        else {
+            continuable = false;
+        }
         setLastVideoPTS(videoPTS);
     }
     return continuable;
@@ -0,0 +1,413 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/internal/DrawCommandScheduler.h"
+
+#include "emapp/private/CommonInclude.h"
+
+#include "bx/hash.h"
+
+namespace nanoem {
+namespace internal {
+namespace {
+
+static const nanoem_rsize_t kMinPrunablePipelines = 64;
+
+} /* namespace anonymous */
+
+DrawCommandScheduler::Statistics::Statistics() NANOEM_DECL_NOEXCEPT
+{
+    reset();
+}
+
+void
+DrawCommandScheduler::Statistics::reset() NANOEM_DECL_NOEXCEPT
+{
+    m_numPasses = 0;
+    m_numDraws = 0;
+    m_numSkippedDraws = 0;
+    m_numReorderedDraws = 0;
+    m_numPipelineChanges = 0;
+    m_numBindingChanges = 0;
+    m_numViewportChanges = 0;
+    m_numScissorRectChanges = 0;
+    m_numUniformBlockChanges = 0;
+    m_numSkippedStateChanges = 0;
+}
+
+nanoem_u32_t
+DrawCommandScheduler::Statistics::numStateChanges() const NANOEM_DECL_NOEXCEPT
+{
+    return m_numPipelineChanges + m_numBindingChanges + m_numViewportChanges + m_numScissorRectChanges +
+        m_numUniformBlockChanges;
+}
+
+bool
+DrawCommandScheduler::Rect::operator!=(const Rect &value) const NANOEM_DECL_NOEXCEPT
+{
+    return m_enabled != value.m_enabled || m_x != value.m_x || m_y != value.m_y || m_width != value.m_width ||
+        m_height != value.m_height;
+}
+
+bool
+DrawCommandScheduler::UniformBlock::operator!=(const UniformBlock &value) const NANOEM_DECL_NOEXCEPT
+{
+    bool result = true;
+    if (m_size == value.m_size && m_hash == value.m_hash) {
+        result = m_data != value.m_data && (!m_data || !value.m_data || memcmp(m_data, value.m_data, m_size) != 0);
+    }
+    return result;
+}
+
+int
+DrawCommandScheduler::Unit::compare(const void *left, const void *right)
+{
+    const Unit *lvalue = static_cast<const Unit *>(left), *rvalue = static_cast<const Unit *>(right);
+    int result = 0;
+    if (lvalue->m_segment != rvalue->m_segment) {
+        result = lvalue->m_segment < rvalue->m_segment ? -1 : 1;
+    }
+    else if (lvalue->m_sortable && rvalue->m_sortable) {
+        if (lvalue->m_pipeline.id != rvalue->m_pipeline.id) {
+            result = lvalue->m_pipeline.id < rvalue->m_pipeline.id ? -1 : 1;
+        }
+        else if (lvalue->m_bindingsHash != rvalue->m_bindingsHash) {
+            result = lvalue->m_bindingsHash < rvalue->m_bindingsHash ? -1 : 1;
+        }
+        else {
+            for (int i = 0; i < SG_NUM_SHADER_STAGES && result == 0; i++) {
+                const nanoem_u32_t lhash = lvalue->m_uniformBlocks[i].m_hash, rhash = rvalue->m_uniformBlocks[i].m_hash;
+                if (lhash != rhash) {
+                    result = lhash < rhash ? -1 : 1;
+                }
+            }
+        }
+    }
+    if (result == 0) {
+        result = lvalue->m_sequence < rvalue->m_sequence ? -1 : (lvalue->m_sequence > rvalue->m_sequence ? 1 : 0);
+    }
+    return result;
+}
+
+bool
+DrawCommandScheduler::isSortable(const sg_pipeline_desc &desc) NANOEM_DECL_NOEXCEPT
+{
+    const sg_depth_state &ds = desc.depth;
+    bool sortable = !desc.stencil.enabled && !desc.alpha_to_coverage_enabled && ds.write_enabled &&
+        (ds.compare == SG_COMPAREFUNC_LESS || ds.compare == SG_COMPAREFUNC_LESS_EQUAL);
+    for (int i = 0, numColors = glm::max(desc.color_count, 1); sortable && i < numColors; i++) {
+        sortable &= !desc.colors[i].blend.enabled;
+    }
+    return sortable;
+}
+
+DrawCommandScheduler::DrawCommandScheduler()
+    : m_segment(0)
+    , m_numPrunablePipelines(kMinPrunablePipelines)
+    , m_pipelineApplied(false)
+    , m_sortEnabled(true)
+{
+    Inline::clearZeroMemory(m_pending);
+}
+
+DrawCommandScheduler::~DrawCommandScheduler() NANOEM_DECL_NOEXCEPT
+{
+}
+
+void
+DrawCommandScheduler::begin()
+{
+    m_units.clear();
+    Inline::clearZeroMemory(m_pending);
+    m_segment = 0;
+    m_pipelineApplied = false;
+}
+
+void
+DrawCommandScheduler::applyPipelineBindings(sg_pipeline pipeline, const sg_bindings &bindings)
+{
+    m_pending.m_pipeline = pipeline;
+    m_pending.m_bindings = bindings;
+    m_pending.m_bindingsHash = bx::hash<bx::HashMurmur2A>(bindings);
+    for (int i = 0; i < SG_NUM_SHADER_STAGES; i++) {
+        Inline::clearZeroMemory(m_pending.m_uniformBlocks[i]);
+    }
+    m_pipelineApplied = true;
+}
+
+void
+DrawCommandScheduler::applyViewport(int x, int y, int width, int height)
+{
+    const Rect rect = { x, y, width, height, true };
+    if (rect != m_pending.m_viewport) {
+        m_pending.m_viewport = rect;
+        closeSegment();
+    }
+}
+
+void
+DrawCommandScheduler::applyScissorRect(int x, int y, int width, int height)
+{
+    const Rect rect = { x, y, width, height, true };
+    if (rect != m_pending.m_scissorRect) {
+        m_pending.m_scissorRect = rect;
+        closeSegment();
+    }
+}
+
+void
+DrawCommandScheduler::applyUniformBlock(sg_shader_stage stage, const void *data, nanoem_rsize_t size)
+{
+    if (stage == SG_SHADERSTAGE_VS || stage == SG_SHADERSTAGE_FS) {
+        UniformBlock &block = m_pending.m_uniformBlocks[stage];
+        block.m_data = data;
+        block.m_size = size;
+        block.m_hash = bx::hash<bx::HashMurmur2A>(data, Inline::saturateInt32U(size));
+    }
+}
+
+void
+DrawCommandScheduler::draw(int offset, int count)
+{
+    /* a draw command without preceding pipeline is skipped as same as the previous draw queue did */
+    if (m_pipelineApplied) {
+        Unit unit(m_pending);
+        unit.m_callback = nullptr;
+        unit.m_userData = nullptr;
+        unit.m_offset = offset;
+        unit.m_count = count;
+        PipelinePassMap::const_iterator it = m_sortablePipelines.find(unit.m_pipeline.id);
+        unit.m_sortable = m_sortEnabled && it != m_sortablePipelines.end();
+        unit.m_pass = unit.m_sortable ? it->second : nullptr;
+        /* draws of different passes must not be mixed as the latter pass may depend on results of the former */
+        if (!unit.m_sortable || (!m_units.empty() && m_units.back().m_pass != unit.m_pass)) {
+            closeSegment();
+        }
+        unit.m_segment = m_segment;
+        unit.m_sequence = Inline::saturateInt32U(m_units.size());
+        m_units.push_back(unit);
+        if (!unit.m_sortable) {
+            closeSegment();
+        }
+        m_pipelineApplied = false;
+    }
+    else {
+        m_statistics.m_numSkippedDraws++;
+    }
+}
+
+void
+DrawCommandScheduler::registerCallback(sg::PassBlock::Callback callback, void *userData)
+{
+    if (callback) {
+        Unit unit;
+        Inline::clearZeroMemory(unit);
+        unit.m_callback = callback;
+        unit.m_userData = userData;
+        closeSegment();
+        unit.m_segment = m_segment;
+        unit.m_sequence = Inline::saturateInt32U(m_units.size());
+        m_units.push_back(unit);
+        closeSegment();
+    }
+}
+
+void
+DrawCommandScheduler::execute(IExecutor *executor)
+{
+    sortAllUnits();
+    Rect currentViewport, currentScissorRect;
+    UniformBlock currentUniformBlocks[SG_NUM_SHADER_STAGES];
+    sg_pipeline currentPipeline = { SG_INVALID_ID };
+    const Unit *lastDrawnUnit = nullptr;
+    bool pipelineValid = false, bindingsApplied = false;
+    Inline::clearZeroMemory(currentViewport);
+    Inline::clearZeroMemory(currentScissorRect);
+    Inline::clearZeroMemory(currentUniformBlocks);
+    for (UnitList::const_iterator it = m_units.begin(), end = m_units.end(); it != end; ++it) {
+        const Unit &unit = *it;
+        if (unit.m_callback) {
+            executor->invokeCallback(unit.m_callback, unit.m_userData);
+            /* the callback may change any state so all cached states must be invalidated */
+            currentPipeline = { SG_INVALID_ID };
+            Inline::clearZeroMemory(currentViewport);
+            Inline::clearZeroMemory(currentScissorRect);
+            pipelineValid = bindingsApplied = false;
+            lastDrawnUnit = nullptr;
+            continue;
+        }
+        if (lastDrawnUnit && lastDrawnUnit->m_pipeline.id == unit.m_pipeline.id &&
+            lastDrawnUnit->m_offset == unit.m_offset && lastDrawnUnit->m_count == unit.m_count &&
+            !(lastDrawnUnit->m_viewport != unit.m_viewport) && !(lastDrawnUnit->m_scissorRect != unit.m_scissorRect) &&
+            lastDrawnUnit->m_bindingsHash == unit.m_bindingsHash &&
+            memcmp(&lastDrawnUnit->m_bindings, &unit.m_bindings, sizeof(unit.m_bindings)) == 0 &&
+            !(lastDrawnUnit->m_uniformBlocks[SG_SHADERSTAGE_VS] != unit.m_uniformBlocks[SG_SHADERSTAGE_VS]) &&
+            !(lastDrawnUnit->m_uniformBlocks[SG_SHADERSTAGE_FS] != unit.m_uniformBlocks[SG_SHADERSTAGE_FS])) {
+            /* exactly same draw call as the previous one */
+            m_statistics.m_numSkippedDraws++;
+            continue;
+        }
+        if (unit.m_viewport.m_enabled) {
+            if (unit.m_viewport != currentViewport) {
+                const Rect &rect = unit.m_viewport;
+                executor->applyViewport(rect.m_x, rect.m_y, rect.m_width, rect.m_height);
+                currentViewport = rect;
+                m_statistics.m_numViewportChanges++;
+            }
+            else {
+                m_statistics.m_numSkippedStateChanges++;
+            }
+        }
+        if (unit.m_scissorRect.m_enabled) {
+            if (unit.m_scissorRect != currentScissorRect) {
+                const Rect &rect = unit.m_scissorRect;
+                executor->applyScissorRect(rect.m_x, rect.m_y, rect.m_width, rect.m_height);
+                currentScissorRect = rect;
+                m_statistics.m_numScissorRectChanges++;
+            }
+            else {
+                m_statistics.m_numSkippedStateChanges++;
+            }
+        }
+        if (unit.m_pipeline.id != currentPipeline.id) {
+            pipelineValid = executor->applyPipeline(unit.m_pipeline);
+            currentPipeline = unit.m_pipeline;
+            bindingsApplied = false;
+            /* uniform blocks must be applied again after changing pipeline */
+            Inline::clearZeroMemory(currentUniformBlocks);
+            if (pipelineValid) {
+                m_statistics.m_numPipelineChanges++;
+            }
+        }
+        else {
+            m_statistics.m_numSkippedStateChanges++;
+        }
+        if (!pipelineValid) {
+            m_statistics.m_numSkippedDraws++;
+            continue;
+        }
+        if (!bindingsApplied || lastDrawnUnit == nullptr || lastDrawnUnit->m_bindingsHash != unit.m_bindingsHash ||
+            memcmp(&lastDrawnUnit->m_bindings, &unit.m_bindings, sizeof(unit.m_bindings)) != 0) {
+            executor->applyBindings(unit.m_bindings);
+            bindingsApplied = true;
+            m_statistics.m_numBindingChanges++;
+        }
+        else {
+            m_statistics.m_numSkippedStateChanges++;
+        }
+        for (int i = 0; i < SG_NUM_SHADER_STAGES; i++) {
+            const UniformBlock &block = unit.m_uniformBlocks[i];
+            if (block.m_data) {
+                if (block != currentUniformBlocks[i]) {
+                    executor->applyUniformBlock(static_cast<sg_shader_stage>(i), block.m_data, block.m_size);
+                    currentUniformBlocks[i] = block;
+                    m_statistics.m_numUniformBlockChanges++;
+                }
+                else {
+                    m_statistics.m_numSkippedStateChanges++;
+                }
+            }
+        }
+        executor->draw(unit.m_offset, unit.m_count);
+        m_statistics.m_numDraws++;
+        lastDrawnUnit = &unit;
+    }
+    m_statistics.m_numPasses++;
+    begin();
+}
+
+bool
+DrawCommandScheduler::isPipelineSortable(sg_pipeline pipeline) const NANOEM_DECL_NOEXCEPT
+{
+    return m_sortablePipelines.find(pipeline.id) != m_sortablePipelines.end();
+}
+
+void
+DrawCommandScheduler::setPipelineSortable(sg_pipeline pipeline, const void *pass, bool value)
+{
+    PipelinePassMap::iterator it = m_sortablePipelines.find(pipeline.id);
+    if (value) {
+        if (it != m_sortablePipelines.end()) {
+            it->second = pass;
+        }
+        else {
+            m_sortablePipelines.insert(tinystl::make_pair(pipeline.id, pass));
+        }
+    }
+    else if (it != m_sortablePipelines.end()) {
+        m_sortablePipelines.erase(it);
+    }
+}
+
+void
+DrawCommandScheduler::removeAllInvalidPipelines(PipelineValidator validator)
+{
+    /* pipelines are validated only when the map is grown twice since the last pruning to amortize the cost */
+    if (m_sortablePipelines.size() >= m_numPrunablePipelines) {
+        PipelineList invalidPipelines;
+        for (PipelinePassMap::const_iterator it = m_sortablePipelines.begin(), end = m_sortablePipelines.end();
+             it != end; ++it) {
+            const sg_pipeline pipeline = { it->first };
+            if (!validator(pipeline)) {
+                invalidPipelines.push_back(it->first);
+            }
+        }
+        for (PipelineList::const_iterator it = invalidPipelines.begin(), end = invalidPipelines.end(); it != end;
+             ++it) {
+            m_sortablePipelines.erase(m_sortablePipelines.find(*it));
+        }
+        m_numPrunablePipelines = glm::max(m_sortablePipelines.size() * 2, kMinPrunablePipelines);
+    }
+}
+
+bool
+DrawCommandScheduler::isSortEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return m_sortEnabled;
+}
+
+void
+DrawCommandScheduler::setSortEnabled(bool value)
+{
+    m_sortEnabled = value;
+}
+
+const DrawCommandScheduler::Statistics &
+DrawCommandScheduler::statistics() const NANOEM_DECL_NOEXCEPT
+{
+    return m_statistics;
+}
+
+void
+DrawCommandScheduler::resetStatistics() NANOEM_DECL_NOEXCEPT
+{
+    m_statistics.reset();
+}
+
+void
+DrawCommandScheduler::closeSegment() NANOEM_DECL_NOEXCEPT
+{
+    if (!m_units.empty() && m_units.back().m_segment == m_segment) {
+        m_segment++;
+    }
+}
+
+void
+DrawCommandScheduler::sortAllUnits()
+{
+    if (m_sortEnabled && m_units.size() > 1) {
+        qsort(m_units.data(), m_units.size(), sizeof(m_units[0]), Unit::compare);
+        nanoem_u32_t index = 0;
+        for (UnitList::const_iterator it = m_units.begin(), end = m_units.end(); it != end; ++it, ++index) {
+            if (it->m_sequence != index) {
+                m_statistics.m_numReorderedDraws++;
+            }
+        }
+    }
+}
+
+} /* namespace internal */
+} /* namespace nanoem */
@@ -0,0 +1,182 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/internal/FileContentDigestCache.h"
+
+#include "emapp/Error.h"
+#include "emapp/FileUtils.h"
+#include "emapp/private/CommonInclude.h"
+
+namespace nanoem {
+namespace internal {
+
+FileContentDigestCache::Statistics::Statistics() NANOEM_DECL_NOEXCEPT
+{
+    reset();
+}
+
+void
+FileContentDigestCache::Statistics::reset() NANOEM_DECL_NOEXCEPT
+{
+    m_numHits = 0;
+    m_numMisses = 0;
+    m_numHashedBytes = 0;
+}
+
+void
+FileContentDigestCache::calculate(IReader *reader, nanoem_u8_t *value, Error &error)
+{
+    SHA256_CTX ctx;
+    nanoem_u8_t buffer[Inline::kReadingFileContentsBufferSize];
+    nanoem_i32_t actualReadSize;
+    sha256_init(&ctx);
+    while ((actualReadSize = FileUtils::read(reader, buffer, sizeof(buffer), error)) > 0) {
+        sha256_update(&ctx, buffer, actualReadSize);
+    }
+    sha256_final(&ctx, value);
+}
+
+void
+FileContentDigestCache::calculate(const ByteArray &bytes, nanoem_u8_t *value) NANOEM_DECL_NOEXCEPT
+{
+    SHA256_CTX ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, bytes.data(), bytes.size());
+    sha256_final(&ctx, value);
+}
+
+FileContentDigestCache::FileContentDigestCache(const ITranslator *translator)
+    : m_translator(translator)
+{
+}
+
+FileContentDigestCache::~FileContentDigestCache() NANOEM_DECL_NOEXCEPT
+{
+}
+
+bool
+FileContentDigestCache::digest(const URI &fileURI, nanoem_u8_t *value, Error &error)
+{
+    FileReaderScope scope(m_translator);
+    bool succeeded = false;
+    if (scope.open(fileURI, error)) {
+        const String &path = fileURI.absolutePath();
+        const nanoem_u64_t size = scope.reader()->size(), timestamp = FileUtils::timestamp(fileURI);
+        if (!find(path, size, timestamp, value)) {
+            calculate(scope.reader(), value, error);
+            if (!error.hasReason()) {
+                insert(path, size, timestamp, value);
+                m_statistics.m_numHashedBytes += size;
+            }
+        }
+        succeeded = !error.hasReason();
+    }
+    return succeeded;
+}
+
+bool
+FileContentDigestCache::readAllBytes(const URI &fileURI, ByteArray &bytes, nanoem_u8_t *value, Error &error)
+{
+    FileReaderScope scope(m_translator);
+    bool succeeded = false;
+    if (scope.open(fileURI, error)) {
+        const String &path = fileURI.absolutePath();
+        const nanoem_u64_t size = scope.reader()->size(), timestamp = FileUtils::timestamp(fileURI);
+        FileUtils::read(scope, bytes, error);
+        if (!error.hasReason() && !find(path, size, timestamp, value)) {
+            calculate(bytes, value);
+            insert(path, size, timestamp, value);
+            m_statistics.m_numHashedBytes += bytes.size();
+        }
+        succeeded = !error.hasReason();
+    }
+    return succeeded;
+}
+
+void
+FileContentDigestCache::retainContent(const URI &fileURI, ByteArray &bytes)
+{
+    m_retainedContentURI = fileURI;
+    m_retainedContent.swap(bytes);
+}
+
+bool
+FileContentDigestCache::takeContent(const URI &fileURI, ByteArray &bytes)
+{
+    bool taken = false;
+    if (!m_retainedContentURI.isEmpty() && m_retainedContentURI == fileURI) {
+        bytes.swap(m_retainedContent);
+        releaseContent();
+        taken = true;
+    }
+    return taken;
+}
+
+void
+FileContentDigestCache::releaseContent() NANOEM_DECL_NOEXCEPT
+{
+    m_retainedContentURI = URI();
+    m_retainedContent.clear();
+}
+
+void
+FileContentDigestCache::remove(const URI &fileURI)
+{
+    EntryMap::const_iterator it = m_entries.find(fileURI.absolutePath());
+    if (it != m_entries.end()) {
+        m_entries.erase(it);
+    }
+}
+
+void
+FileContentDigestCache::clear() NANOEM_DECL_NOEXCEPT
+{
+    m_entries.clear();
+    releaseContent();
+    m_statistics.reset();
+}
+
+const FileContentDigestCache::Statistics &
+FileContentDigestCache::statistics() const NANOEM_DECL_NOEXCEPT
+{
+    return m_statistics;
+}
+
+nanoem_rsize_t
+FileContentDigestCache::size() const NANOEM_DECL_NOEXCEPT
+{
+    return m_entries.size();
+}
+
+bool
+FileContentDigestCache::find(const String &path, nanoem_u64_t size, nanoem_u64_t timestamp, nanoem_u8_t *value)
+{
+    EntryMap::const_iterator it = m_entries.find(path);
+    const bool found = it != m_entries.end() && it->second.m_size == size && it->second.m_timestamp == timestamp;
+    if (found) {
+        memcpy(value, it->second.m_digest, sizeof(it->second.m_digest));
+        m_statistics.m_numHits++;
+    }
+    else {
+        m_statistics.m_numMisses++;
+    }
+    return found;
+}
+
+void
+FileContentDigestCache::insert(const String &path, nanoem_u64_t size, nanoem_u64_t timestamp, const nanoem_u8_t *value)
+{
+    /* the timestamp cannot be retrieved on some platforms so the content may be changed without resizing */
+    if (timestamp != 0) {
+        Entry &entry = m_entries[path];
+        entry.m_size = size;
+        entry.m_timestamp = timestamp;
+        memcpy(entry.m_digest, value, sizeof(entry.m_digest));
+    }
+}
+
+} /* namespace internal */
+} /* namespace nanoem */
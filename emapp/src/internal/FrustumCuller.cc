@@ -0,0 +1,135 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/internal/FrustumCuller.h"
+
+#include "emapp/private/CommonInclude.h"
+
+namespace nanoem {
+namespace internal {
+
+FrustumCuller::Statistics::Statistics() NANOEM_DECL_NOEXCEPT
+{
+    reset();
+}
+
+void
+FrustumCuller::Statistics::reset() NANOEM_DECL_NOEXCEPT
+{
+    m_numSubmittedDraws = 0;
+    m_numCulledDraws = 0;
+}
+
+void
+FrustumCuller::extractAllPlanes(const Matrix4x4 &viewProjection, Vector4 *planes) NANOEM_DECL_NOEXCEPT
+{
+    const Matrix4x4 m(glm::transpose(viewProjection));
+    planes[0] = m[3] + m[0];
+    planes[1] = m[3] - m[0];
+    planes[2] = m[3] + m[1];
+    planes[3] = m[3] - m[1];
+    /* assumes [-1, 1] depth range that is also conservative for [0, 1] */
+    planes[4] = m[3] + m[2];
+    planes[5] = m[3] - m[2];
+}
+
+bool
+FrustumCuller::intersects(const Vector4 *planes, const BoundingBox &box) NANOEM_DECL_NOEXCEPT
+{
+    bool intersected = box.m_min.x <= box.m_max.x;
+    for (nanoem_rsize_t i = 0; intersected && i < kNumPlanes; i++) {
+        const Vector4 &plane = planes[i];
+        /* tests the corner of the box farthest along the plane normal */
+        const Vector3 corner(plane.x >= 0 ? box.m_max.x : box.m_min.x, plane.y >= 0 ? box.m_max.y : box.m_min.y,
+            plane.z >= 0 ? box.m_max.z : box.m_min.z);
+        intersected = glm::dot(Vector3(plane), corner) + plane.w >= 0;
+    }
+    return intersected;
+}
+
+FrustumCuller::FrustumCuller()
+    : m_enabled(true)
+{
+    for (nanoem_rsize_t i = kFrustumTypeFirstEnum; i < kFrustumTypeMaxEnum; i++) {
+        m_valid[i] = false;
+    }
+}
+
+FrustumCuller::~FrustumCuller() NANOEM_DECL_NOEXCEPT
+{
+}
+
+void
+FrustumCuller::setViewProjection(FrustumType type, const Matrix4x4 &value)
+{
+    extractAllPlanes(value, m_planes[type]);
+    m_valid[type] = true;
+}
+
+void
+FrustumCuller::invalidate(FrustumType type) NANOEM_DECL_NOEXCEPT
+{
+    m_valid[type] = false;
+}
+
+bool
+FrustumCuller::isVisible(FrustumType type, const BoundingBox &box) const NANOEM_DECL_NOEXCEPT
+{
+    return !m_enabled || !m_valid[type] || intersects(m_planes[type], box);
+}
+
+bool
+FrustumCuller::test(FrustumType type, const BoundingBox &box) NANOEM_DECL_NOEXCEPT
+{
+    const bool visible = isVisible(type, box);
+    if (visible) {
+        m_statistics.m_numSubmittedDraws++;
+    }
+    else {
+        m_statistics.m_numCulledDraws++;
+    }
+    return visible;
+}
+
+void
+FrustumCuller::submit() NANOEM_DECL_NOEXCEPT
+{
+    m_statistics.m_numSubmittedDraws++;
+}
+
+void
+FrustumCuller::endFrame() NANOEM_DECL_NOEXCEPT
+{
+    m_lastFrameStatistics = m_statistics;
+    m_statistics.reset();
+}
+
+const FrustumCuller::Statistics &
+FrustumCuller::statistics() const NANOEM_DECL_NOEXCEPT
+{
+    return m_statistics;
+}
+
+const FrustumCuller::Statistics &
+FrustumCuller::lastFrameStatistics() const NANOEM_DECL_NOEXCEPT
+{
+    return m_lastFrameStatistics;
+}
+
+bool
+FrustumCuller::isEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return m_enabled;
+}
+
+void
+FrustumCuller::setEnabled(bool value)
+{
+    m_enabled = value;
+}
+
+} /* namespace internal */
+} /* namespace nanoem */
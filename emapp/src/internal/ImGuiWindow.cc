@@ -35,6 +35,7 @@
 #include "emapp/internal/DraggingMorphState.h"
 #include "emapp/internal/ImGuiApplicationMenuBuilder.h"
 #include "emapp/internal/LightValueState.h"
+#include "emapp/internal/WaveFormPyramid.h"
 #include "emapp/internal/imgui/AccessoryOutsideParentDialog.h"
 #include "emapp/internal/imgui/ActiveAccessorySelector.h"
 #include "emapp/internal/imgui/ActiveModelSelector.h"
@@ -122,6 +123,7 @@ static const Vector4 kColorTranslucentRed(1, 0, 0, 0.5f);
 static const Vector4 kColorTranslucentGreen(0, 1, 0, 0.5f);
 static const Vector4 kColorTranslucentBlue(0, 0, 1, 0.5f);
 static const Vector4 kColorGray(0.5f, 0.5f, 0.5f, 1);
+static const nanoem_rsize_t kWaveFormPyramidUpdateFrames = 1 << 18;
 
 static bool
 isSelectingBoneHandle(const IModelObjectSelection *selection, Project::RectangleType type) NANOEM_DECL_NOEXCEPT
@@ -220,124 +222,6 @@ VertexWeightPainterUtils::layoutSelectBoneComboBox(
     }
 }
 
-struct WaveFormPanelDrawer {
-    typedef nanoem_f32_t (*CallbackHandler)(void *data, int idx);
-
-    static nanoem_f32_t callback(void *userData, int offset) NANOEM_DECL_NOEXCEPT;
-    WaveFormPanelDrawer(const Project *project, nanoem_u32_t numVisibleMarkers);
-
-    nanoem_f32_t plotSample32(nanoem_rsize_t offset) const NANOEM_DECL_NOEXCEPT;
-    nanoem_f32_t plotSample24(nanoem_rsize_t offset) const NANOEM_DECL_NOEXCEPT;
-    nanoem_f32_t plotSample16(nanoem_rsize_t offset) const NANOEM_DECL_NOEXCEPT;
-    nanoem_f32_t plotSample8(nanoem_rsize_t offset) const NANOEM_DECL_NOEXCEPT;
-    nanoem_rsize_t sampleBytesOffset(nanoem_rsize_t offset) const NANOEM_DECL_NOEXCEPT;
-
-    const ByteArray *m_linearPCMSamplesPtr;
-    nanoem_rsize_t m_base;
-    nanoem_rsize_t m_length;
-    nanoem_rsize_t m_bytesPerSample;
-};
-
-nanoem_f32_t
-WaveFormPanelDrawer::callback(void *userData, int offset) NANOEM_DECL_NOEXCEPT
-{
-    const WaveFormPanelDrawer *drawer = static_cast<const WaveFormPanelDrawer *>(userData);
-    nanoem_f32_t value = 0.0f;
-    switch (drawer->m_bytesPerSample) {
-    case 4: {
-        value = drawer->plotSample32(offset);
-        break;
-    }
-    case 3: {
-        value = drawer->plotSample24(offset);
-        break;
-    }
-    case 2: {
-        value = drawer->plotSample16(offset);
-        break;
-    }
-    case 1: {
-        value = drawer->plotSample8(offset);
-        break;
-    }
-    default:
-        break;
-    }
-    return glm::clamp(value, -1.0f, 1.0f);
-}
-
-WaveFormPanelDrawer::WaveFormPanelDrawer(const Project *project, nanoem_u32_t numVisibleMarkers)
-    : m_linearPCMSamplesPtr(nullptr)
-    , m_base(0)
-    , m_length(0)
-    , m_bytesPerSample(0)
-{
-    const IAudioPlayer *player = project->audioPlayer();
-    if (player->isLoaded()) {
-        const nanoem_f64_t denominator(project->baseFPS());
-        const nanoem_frame_index_t frameIndex = project->currentLocalFrameIndex();
-        const nanoem_u32_t bytesPerSample = player->bitsPerSample() / 8,
-                           bytesPerSecond = player->sampleRate() * player->numChannels() * bytesPerSample,
-                           length = static_cast<nanoem_u32_t>((numVisibleMarkers / denominator) * bytesPerSecond),
-                           base = static_cast<nanoem_u32_t>((frameIndex / denominator) * bytesPerSecond);
-        m_linearPCMSamplesPtr = player->linearPCMSamples();
-        m_length = length - length % bytesPerSample;
-        m_base = base - base % bytesPerSample;
-        m_bytesPerSample = bytesPerSample;
-    }
-}
-
-nanoem_f32_t
-WaveFormPanelDrawer::plotSample32(nanoem_rsize_t index) const NANOEM_DECL_NOEXCEPT
-{
-    nanoem_f32_t value = 0;
-    const nanoem_rsize_t offset = sampleBytesOffset(index);
-    if (m_linearPCMSamplesPtr && offset < m_linearPCMSamplesPtr->size() - m_bytesPerSample) {
-        value = *reinterpret_cast<const nanoem_i32_t *>(m_linearPCMSamplesPtr->data() + offset) / 2147483647.0f;
-    }
-    return value;
-}
-
-nanoem_f32_t
-WaveFormPanelDrawer::plotSample24(nanoem_rsize_t index) const NANOEM_DECL_NOEXCEPT
-{
-    nanoem_f32_t value = 0;
-    const nanoem_rsize_t offset = sampleBytesOffset(index);
-    if (m_linearPCMSamplesPtr && offset < m_linearPCMSamplesPtr->size() - m_bytesPerSample) {
-        const nanoem_u8_t *ptr = m_linearPCMSamplesPtr->data() + offset;
-        value = Inline::readI24(ptr) / 8388607.0f;
-    }
-    return value;
-}
-
-nanoem_f32_t
-WaveFormPanelDrawer::plotSample16(nanoem_rsize_t index) const NANOEM_DECL_NOEXCEPT
-{
-    nanoem_f32_t value = 0;
-    const nanoem_rsize_t offset = sampleBytesOffset(index);
-    if (m_linearPCMSamplesPtr && offset < m_linearPCMSamplesPtr->size() - m_bytesPerSample) {
-        value = *reinterpret_cast<const nanoem_i16_t *>(m_linearPCMSamplesPtr->data() + offset) / 32767.0f;
-    }
-    return value;
-}
-
-nanoem_f32_t
-WaveFormPanelDrawer::plotSample8(nanoem_rsize_t index) const NANOEM_DECL_NOEXCEPT
-{
-    nanoem_f32_t value = 0;
-    const nanoem_rsize_t offset = sampleBytesOffset(index);
-    if (m_linearPCMSamplesPtr && offset < m_linearPCMSamplesPtr->size() - m_bytesPerSample) {
-        value = *reinterpret_cast<const char *>(m_linearPCMSamplesPtr->data() + offset) / 127.0f;
-    }
-    return value;
-}
-
-nanoem_rsize_t
-WaveFormPanelDrawer::sampleBytesOffset(nanoem_rsize_t sample) const NANOEM_DECL_NOEXCEPT
-{
-    return m_base + sample * m_bytesPerSample;
-}
-
 class BasePrimitiveDialog : public imgui::BaseNonModalDialogWindow {
 protected:
     BasePrimitiveDialog(BaseApplicationService *applicationPtr, const Vector3 &t, const Vector3 &r, const Vector3 &s);
@@ -1134,6 +1018,7 @@ ImGuiWindow::ImGuiWindow(BaseApplicationService *application)
     , m_boneTranslationValueState(nullptr)
     , m_boneOrientationValueState(nullptr)
     , m_draggingMorphSliderState(nullptr)
+    , m_waveFormPyramid(nullptr)
     , m_requestedScrollHereTrack(nullptr)
     , m_context(nullptr)
     , m_debugger(nullptr)
@@ -1188,6 +1073,7 @@ ImGuiWindow::~ImGuiWindow()
     m_allModalDialogs.clear();
     nanoem_delete_safe(m_menu);
     nanoem_delete_safe(m_gizmoController);
+    nanoem_delete_safe(m_waveFormPyramid);
 }
 
 bool
@@ -2952,10 +2838,45 @@ ImGuiWindow::drawWavePanel(nanoem_f32_t tracksWidth, Project *project, nanoem_u3
         (ImGui::GetContentRegionAvail().x - tracksWidth - ImGui::GetStyle().ScrollbarSize) /
         (ImGui::GetTextLineHeight());
     numVisibleMarkers = nanoem_u32_t(numVisibleMarkersWidth) - 1;
-    WaveFormPanelDrawer drawer(project, numVisibleMarkers);
-    ImGui::PlotHistogram("##timeline.wave", WaveFormPanelDrawer::callback, &drawer,
-        Inline::saturateInt32(drawer.m_length), 0, nullptr, -1, 1,
-        ImVec2(ImGui::GetContentRegionAvail().x, histogramHeight));
+    const ImVec2 size(ImGui::GetContentRegionAvail().x, histogramHeight), offset(ImGui::GetCursorScreenPos()),
+        rectMax(offset.x + size.x, offset.y + size.y);
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    ImGui::Dummy(size);
+    drawList->AddRectFilled(offset, rectMax, ImGui::GetColorU32(ImGuiCol_FrameBg), ImGui::GetStyle().FrameRounding);
+    const IAudioPlayer *player = project->audioPlayer();
+    if (player->isLoaded()) {
+        const ByteArray *samples = player->linearPCMSamples();
+        if (!m_waveFormPyramid) {
+            m_waveFormPyramid = nanoem_new(WaveFormPyramid);
+        }
+        if (!m_waveFormPyramid->isSameSource(samples, player->bitsPerSample(), player->numChannels())) {
+            m_waveFormPyramid->reset(samples, player->bitsPerSample(), player->numChannels());
+        }
+        /* the pyramid is built incrementally to keep loading a long audio from stalling the frame */
+        m_waveFormPyramid->update(kWaveFormPyramidUpdateFrames);
+        const nanoem_f64_t framesPerMarker = player->sampleRate() / nanoem_f64_t(project->baseFPS());
+        const nanoem_f64_t beginFrame = project->currentLocalFrameIndex() * framesPerMarker,
+                           numFrames = numVisibleMarkers * framesPerMarker;
+        const int numColumns = static_cast<int>(size.x);
+        const nanoem_f32_t centerY = offset.y + size.y * 0.5f, halfHeight = size.y * 0.5f;
+        const ImU32 peakColor = ImGui::GetColorU32(ImGuiCol_PlotHistogram),
+                    rmsColor = ImGui::GetColorU32(ImGuiCol_PlotHistogramHovered);
+        drawList->PushClipRect(offset, rectMax, true);
+        for (int i = 0; i < numColumns; i++) {
+            const nanoem_rsize_t first = static_cast<nanoem_rsize_t>(beginFrame + numFrames * i / numColumns),
+                                 last = static_cast<nanoem_rsize_t>(beginFrame + numFrames * (i + 1) / numColumns);
+            const WaveFormPyramid::Bin bin(m_waveFormPyramid->query(first, glm::max(last, first + 1)));
+            if (bin.m_numSamples > 0) {
+                const nanoem_f32_t x = offset.x + i + 0.5f, maxValue = glm::clamp(bin.m_max, -1.0f, 1.0f),
+                                   minValue = glm::clamp(bin.m_min, -1.0f, 1.0f), rms = glm::min(bin.rms(), 1.0f);
+                drawList->AddLine(ImVec2(x, centerY - maxValue * halfHeight),
+                    ImVec2(x, centerY - minValue * halfHeight + 1.0f), peakColor);
+                drawList->AddLine(
+                    ImVec2(x, centerY - rms * halfHeight), ImVec2(x, centerY + rms * halfHeight + 1.0f), rmsColor);
+            }
+        }
+        drawList->PopClipRect();
+    }
 }
 
 void
@@ -5100,6 +5021,14 @@ ImGuiWindow::drawPrimitive2D(Project *project, IState *state, nanoem_u32_t flags
         state->onDrawPrimitive2D(&m_primitive2D);
     }
     Model *activeModel = project->activeModel();
+    /* only the active model draws heatmaps so the others must not keep tracing after the active model is changed */
+    const Project::ModelList *models = project->allModels();
+    for (Project::ModelList::const_iterator it = models->begin(), end = models->end(); it != end; ++it) {
+        Model *model = *it;
+        if (model != activeModel || !model->isVisible()) {
+            model->setConstraintIterationTraceEnabled(false);
+        }
+    }
     if (activeModel && activeModel->isVisible()) {
         const Vector2SI32 deviceScaleCursor(project->deviceScaleMovingCursorPosition());
         Vector4 activeBoneColor(DrawUtils::kColorRed, 1);
@@ -5115,7 +5044,9 @@ ImGuiWindow::drawPrimitive2D(Project *project, IState *state, nanoem_u32_t flags
         if (EnumUtils::isEnabled(IState::kDrawTypeConstraintConnections, flags)) {
             activeModel->drawConstraintConnections(&m_primitive2D, deviceScaleCursor);
         }
-        if (EnumUtils::isEnabled(IState::kDrawTypeConstraintHeatmaps, flags)) {
+        const bool drawConstraintHeatmaps = EnumUtils::isEnabled(IState::kDrawTypeConstraintHeatmaps, flags);
+        activeModel->setConstraintIterationTraceEnabled(drawConstraintHeatmaps);
+        if (drawConstraintHeatmaps) {
             activeModel->drawConstraintsHeatMap(&m_primitive2D);
         }
         if (EnumUtils::isEnabled(IState::kDrawTypeBoneMoveHandle, flags)) {
@@ -0,0 +1,218 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/internal/LinearPCMStream.h"
+
+#include "emapp/Error.h"
+#include "emapp/FileUtils.h"
+#include "emapp/private/CommonInclude.h"
+
+namespace nanoem {
+namespace internal {
+namespace {
+
+static const nanoem_rsize_t kMaxReadChunkSize = 0x1000000;
+
+} /* namespace anonymous */
+
+nanoem_u64_t
+LinearPCMStream::toFrameOffset(const IAudioPlayer::Rational &value, nanoem_u32_t sampleRate) NANOEM_DECL_NOEXCEPT
+{
+    /* integer arithmetic to avoid drifting a frame by rounding error of floating point */
+    const nanoem_u64_t denominator = glm::max(value.m_denominator, 1u);
+    return (value.m_numerator / denominator) * sampleRate +
+        ((value.m_numerator % denominator) * sampleRate) / denominator;
+}
+
+LinearPCMStream::LinearPCMStream(ISeekableReader *reader, nanoem_rsize_t numLookaheadFrames)
+    : m_reader(reader)
+    , m_payloadOffset(0)
+    , m_numFrames(0)
+    , m_currentFrame(0)
+    , m_windowFrameOffset(0)
+    , m_numWindowFrames(0)
+    , m_numLookaheadFrames(glm::max(numLookaheadFrames, nanoem_rsize_t(1)))
+    , m_numWindowReads(0)
+{
+    Inline::clearZeroMemory(m_format);
+}
+
+LinearPCMStream::~LinearPCMStream() NANOEM_DECL_NOEXCEPT
+{
+    m_reader = nullptr;
+}
+
+bool
+LinearPCMStream::open(Error &error)
+{
+    IAudioPlayer::WAVHeader header;
+    bool formatFound = false, succeeded = false;
+    m_reader->seek(0, ISeekable::kSeekTypeBegin, error);
+    if (FileUtils::read(m_reader, &header, sizeof(header), error) == sizeof(header) &&
+        header.m_riffChunk.m_id == nanoem_fourcc('R', 'I', 'F', 'F') &&
+        header.m_wave == nanoem_fourcc('W', 'A', 'V', 'E')) {
+        const nanoem_u64_t size = m_reader->size();
+        nanoem_u64_t offset = sizeof(header);
+        IAudioPlayer::Chunk chunk;
+        while (!error.hasReason() && offset + sizeof(chunk) <= size) {
+            m_reader->seek(offset, ISeekable::kSeekTypeBegin, error);
+            if (FileUtils::read(m_reader, &chunk, sizeof(chunk), error) != sizeof(chunk)) {
+                break;
+            }
+            offset += sizeof(chunk);
+            if (chunk.m_id == nanoem_fourcc('f', 'm', 't', ' ') && chunk.m_size >= sizeof(m_format)) {
+                formatFound = FileUtils::read(m_reader, &m_format, sizeof(m_format), error) == sizeof(m_format);
+            }
+            else if (chunk.m_id == nanoem_fourcc('d', 'a', 't', 'a')) {
+                const nanoem_u32_t bits = m_format.m_bitsPerSample;
+                if (!formatFound) {
+                    break;
+                }
+                else if (m_format.m_numChannels > 0 && bits >= 8 && bits <= 32 && bits % 8 == 0) {
+                    /* data of archived wav older than 24.1 may be truncated so limit to the actual size */
+                    const nanoem_u64_t payloadSize = glm::min(static_cast<nanoem_u64_t>(chunk.m_size), size - offset);
+                    m_payloadOffset = offset;
+                    m_numFrames = payloadSize / bytesPerFrame();
+                    m_currentFrame = m_windowFrameOffset = 0;
+                    m_numWindowFrames = 0;
+                    succeeded = true;
+                }
+                else {
+                    error = Error("Unsupported PCM audio format", 0, Error::kDomainTypeApplication);
+                }
+                break;
+            }
+            /* RIFF chunks are word aligned */
+            offset += chunk.m_size + (chunk.m_size & 1);
+        }
+        if (!succeeded && !error.hasReason()) {
+            error = Error("Cannot find PCM audio buffer", 0, Error::kDomainTypeApplication);
+        }
+    }
+    else if (!error.hasReason()) {
+        error = Error("Invalid RIFF header", 0, Error::kDomainTypeApplication);
+    }
+    return succeeded;
+}
+
+bool
+LinearPCMStream::seek(nanoem_u64_t frameOffset) NANOEM_DECL_NOEXCEPT
+{
+    m_currentFrame = glm::min(frameOffset, m_numFrames);
+    return frameOffset <= m_numFrames;
+}
+
+bool
+LinearPCMStream::seek(const IAudioPlayer::Rational &value) NANOEM_DECL_NOEXCEPT
+{
+    return seek(toFrameOffset(value, m_format.m_sampleRate));
+}
+
+nanoem_rsize_t
+LinearPCMStream::read(nanoem_u8_t *data, nanoem_rsize_t numFrames, Error &error)
+{
+    const nanoem_rsize_t bytesPerFrame = this->bytesPerFrame();
+    nanoem_rsize_t numReadFrames = 0;
+    while (numReadFrames < numFrames && m_currentFrame < m_numFrames) {
+        if (m_currentFrame < m_windowFrameOffset || m_currentFrame >= m_windowFrameOffset + m_numWindowFrames) {
+            if (!fill(m_currentFrame, error)) {
+                break;
+            }
+        }
+        const nanoem_rsize_t offset = static_cast<nanoem_rsize_t>(m_currentFrame - m_windowFrameOffset),
+                             numCopyFrames = glm::min(numFrames - numReadFrames, m_numWindowFrames - offset);
+        memcpy(data + numReadFrames * bytesPerFrame, m_window.data() + offset * bytesPerFrame,
+            numCopyFrames * bytesPerFrame);
+        numReadFrames += numCopyFrames;
+        m_currentFrame += numCopyFrames;
+    }
+    return numReadFrames;
+}
+
+bool
+LinearPCMStream::readAll(ByteArray &bytes, Error &error)
+{
+    bytes.resize(static_cast<nanoem_rsize_t>(m_numFrames * bytesPerFrame()));
+    return readPayload(0, bytes.data(), bytes.size(), error);
+}
+
+const IAudioPlayer::Format &
+LinearPCMStream::format() const NANOEM_DECL_NOEXCEPT
+{
+    return m_format;
+}
+
+IAudioPlayer::Rational
+LinearPCMStream::durationRational() const NANOEM_DECL_NOEXCEPT
+{
+    IAudioPlayer::Rational value;
+    value.m_numerator = m_numFrames;
+    value.m_denominator = m_format.m_sampleRate;
+    return value;
+}
+
+nanoem_u64_t
+LinearPCMStream::numFrames() const NANOEM_DECL_NOEXCEPT
+{
+    return m_numFrames;
+}
+
+nanoem_u64_t
+LinearPCMStream::currentFrame() const NANOEM_DECL_NOEXCEPT
+{
+    return m_currentFrame;
+}
+
+nanoem_u32_t
+LinearPCMStream::bytesPerFrame() const NANOEM_DECL_NOEXCEPT
+{
+    return (m_format.m_bitsPerSample / 8) * m_format.m_numChannels;
+}
+
+nanoem_rsize_t
+LinearPCMStream::numWindowReads() const NANOEM_DECL_NOEXCEPT
+{
+    return m_numWindowReads;
+}
+
+bool
+LinearPCMStream::fill(nanoem_u64_t frameOffset, Error &error)
+{
+    const nanoem_rsize_t bytesPerFrame = this->bytesPerFrame(),
+                         numFrames = static_cast<nanoem_rsize_t>(
+                             glm::min(static_cast<nanoem_u64_t>(m_numLookaheadFrames), m_numFrames - frameOffset));
+    m_window.resize(numFrames * bytesPerFrame);
+    m_numWindowFrames = 0;
+    bool succeeded = readPayload(frameOffset * bytesPerFrame, m_window.data(), m_window.size(), error);
+    if (succeeded) {
+        m_windowFrameOffset = frameOffset;
+        m_numWindowFrames = numFrames;
+        m_numWindowReads++;
+    }
+    return succeeded;
+}
+
+bool
+LinearPCMStream::readPayload(nanoem_u64_t offset, nanoem_u8_t *data, nanoem_rsize_t size, Error &error)
+{
+    m_reader->seek(static_cast<nanoem_i64_t>(m_payloadOffset + offset), ISeekable::kSeekTypeBegin, error);
+    nanoem_rsize_t rest = size;
+    while (rest > 0 && !error.hasReason()) {
+        const nanoem_rsize_t chunkSize = glm::min(rest, kMaxReadChunkSize);
+        if (FileUtils::read(m_reader, data, chunkSize, error) != static_cast<nanoem_i32_t>(chunkSize)) {
+            if (!error.hasReason()) {
+                error = Error("Insufficient PCM audio buffer", 0, Error::kDomainTypeApplication);
+            }
+            break;
+        }
+        data += chunkSize;
+        rest -= chunkSize;
+    }
+    return rest == 0 && !error.hasReason();
+}
+
+} /* namespace internal */
+} /* namespace nanoem */
@@ -159,8 +159,9 @@ ModelObjectSelection::~ModelObjectSelection() NANOEM_DECL_NOEXCEPT
 void
 ModelObjectSelection::addVertex(const nanoem_model_vertex_t *value)
 {
-    if (value) {
+    if (value && m_selectedVertexSet.find(value) == m_selectedVertexSet.end()) {
         m_selectedVertexSet.insert(value);
+        m_parent->markVertexOverlayDirty(value);
     }
 }
 
@@ -298,7 +299,11 @@ ModelObjectSelection::addAllMaterials()
 void
 ModelObjectSelection::removeVertex(const nanoem_model_vertex_t *value)
 {
-    m_selectedVertexSet.erase(value);
+    model::Vertex::Set::const_iterator it = m_selectedVertexSet.find(value);
+    if (it != m_selectedVertexSet.end()) {
+        m_selectedVertexSet.erase(it);
+        m_parent->markVertexOverlayDirty(value);
+    }
 }
 
 void
@@ -358,6 +363,10 @@ ModelObjectSelection::removeFace(const Vector4UI32 &value)
 void
 ModelObjectSelection::removeAllVertices()
 {
+    for (model::Vertex::Set::const_iterator it = m_selectedVertexSet.begin(), end = m_selectedVertexSet.end();
+         it != end; ++it) {
+        m_parent->markVertexOverlayDirty(*it);
+    }
     m_selectedVertexSet.clear();
 }
 
@@ -0,0 +1,226 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/internal/WaveFormPyramid.h"
+
+#include "emapp/private/CommonInclude.h"
+
+namespace nanoem {
+namespace internal {
+
+WaveFormPyramid::Bin::Bin() NANOEM_DECL_NOEXCEPT : m_min(FLT_MAX), m_max(-FLT_MAX), m_sumSquares(0), m_numSamples(0)
+{
+}
+
+void
+WaveFormPyramid::Bin::merge(const Bin &value) NANOEM_DECL_NOEXCEPT
+{
+    m_min = glm::min(m_min, value.m_min);
+    m_max = glm::max(m_max, value.m_max);
+    m_sumSquares += value.m_sumSquares;
+    m_numSamples += value.m_numSamples;
+}
+
+void
+WaveFormPyramid::Bin::merge(nanoem_f32_t value) NANOEM_DECL_NOEXCEPT
+{
+    m_min = glm::min(m_min, value);
+    m_max = glm::max(m_max, value);
+    m_sumSquares += value * value;
+    m_numSamples++;
+}
+
+nanoem_f32_t
+WaveFormPyramid::Bin::rms() const NANOEM_DECL_NOEXCEPT
+{
+    return m_numSamples > 0 ? glm::sqrt(m_sumSquares / m_numSamples) : 0.0f;
+}
+
+nanoem_f32_t
+WaveFormPyramid::decodeSample(const nanoem_u8_t *ptr, nanoem_rsize_t bytesPerSample) NANOEM_DECL_NOEXCEPT
+{
+    nanoem_f32_t value = 0;
+    switch (bytesPerSample) {
+    case 4: {
+        value = *reinterpret_cast<const nanoem_i32_t *>(ptr) / 2147483647.0f;
+        break;
+    }
+    case 3: {
+        value = Inline::readI24(ptr) / 8388607.0f;
+        break;
+    }
+    case 2: {
+        value = *reinterpret_cast<const nanoem_i16_t *>(ptr) / 32767.0f;
+        break;
+    }
+    case 1: {
+        value = *reinterpret_cast<const char *>(ptr) / 127.0f;
+        break;
+    }
+    default:
+        break;
+    }
+    return value;
+}
+
+WaveFormPyramid::WaveFormPyramid()
+    : m_samplesPtr(nullptr)
+    , m_sourceData(nullptr)
+    , m_sourceSize(0)
+    , m_numFrames(0)
+    , m_numBuiltFrames(0)
+    , m_bytesPerSample(0)
+    , m_numChannels(0)
+{
+}
+
+WaveFormPyramid::~WaveFormPyramid() NANOEM_DECL_NOEXCEPT
+{
+}
+
+bool
+WaveFormPyramid::isSameSource(
+    const ByteArray *samples, nanoem_u32_t bitsPerSample, nanoem_u32_t numChannels) const NANOEM_DECL_NOEXCEPT
+{
+    return m_samplesPtr == samples && samples && m_sourceData == samples->data() &&
+        m_sourceSize == samples->size() && m_bytesPerSample == bitsPerSample / 8 && m_numChannels == numChannels;
+}
+
+void
+WaveFormPyramid::reset(const ByteArray *samples, nanoem_u32_t bitsPerSample, nanoem_u32_t numChannels)
+{
+    clear();
+    const nanoem_u32_t bytesPerSample = bitsPerSample / 8;
+    if (samples && bytesPerSample > 0 && bytesPerSample <= 4 && numChannels > 0) {
+        m_samplesPtr = samples;
+        m_sourceData = samples->data();
+        m_sourceSize = samples->size();
+        m_bytesPerSample = bytesPerSample;
+        m_numChannels = numChannels;
+        m_numFrames = m_sourceSize / (bytesPerSample * numChannels);
+    }
+}
+
+bool
+WaveFormPyramid::update(nanoem_rsize_t maxFrames)
+{
+    const nanoem_rsize_t numBlocks = m_numFrames / kNumBlockFrames;
+    nanoem_rsize_t numProcessedFrames = 0;
+    while (m_levels[0].size() < numBlocks && numProcessedFrames < maxFrames) {
+        const nanoem_rsize_t beginFrame = m_levels[0].size() * kNumBlockFrames;
+        Bin bin;
+        accumulateFrames(beginFrame, beginFrame + kNumBlockFrames, bin);
+        appendBlock(bin);
+        numProcessedFrames += kNumBlockFrames;
+    }
+    /* frames of the last partial block are always read from the samples directly */
+    m_numBuiltFrames = m_levels[0].size() < numBlocks ? m_levels[0].size() * kNumBlockFrames : m_numFrames;
+    return isCompleted();
+}
+
+WaveFormPyramid::Bin
+WaveFormPyramid::query(nanoem_rsize_t beginFrame, nanoem_rsize_t endFrame) const NANOEM_DECL_NOEXCEPT
+{
+    Bin result;
+    endFrame = glm::min(endFrame, m_numBuiltFrames);
+    if (beginFrame < endFrame) {
+        nanoem_rsize_t blockBegin = (beginFrame + kNumBlockFrames - 1) / kNumBlockFrames,
+                       blockEnd = endFrame / kNumBlockFrames;
+        if (blockBegin >= blockEnd) {
+            accumulateFrames(beginFrame, endFrame, result);
+        }
+        else {
+            accumulateFrames(beginFrame, blockBegin * kNumBlockFrames, result);
+            accumulateFrames(blockEnd * kNumBlockFrames, endFrame, result);
+            /* bottom-up segment tree traversal and every parent of the range has both children */
+            for (nanoem_rsize_t level = 0; blockBegin < blockEnd && level < kMaxLevels; level++) {
+                const BinList &bins = m_levels[level];
+                if (blockBegin & 1) {
+                    result.merge(bins[blockBegin++]);
+                }
+                if (blockEnd & 1) {
+                    result.merge(bins[--blockEnd]);
+                }
+                blockBegin >>= 1;
+                blockEnd >>= 1;
+            }
+        }
+    }
+    return result;
+}
+
+void
+WaveFormPyramid::clear()
+{
+    for (nanoem_rsize_t i = 0; i < kMaxLevels; i++) {
+        m_levels[i].clear();
+    }
+    m_samplesPtr = nullptr;
+    m_sourceData = nullptr;
+    m_sourceSize = m_numFrames = m_numBuiltFrames = 0;
+    m_bytesPerSample = m_numChannels = 0;
+}
+
+nanoem_rsize_t
+WaveFormPyramid::numFrames() const NANOEM_DECL_NOEXCEPT
+{
+    return m_numFrames;
+}
+
+nanoem_rsize_t
+WaveFormPyramid::numBuiltFrames() const NANOEM_DECL_NOEXCEPT
+{
+    return m_numBuiltFrames;
+}
+
+nanoem_rsize_t
+WaveFormPyramid::numLevels() const NANOEM_DECL_NOEXCEPT
+{
+    nanoem_rsize_t numLevels = 0;
+    while (numLevels < kMaxLevels && !m_levels[numLevels].empty()) {
+        numLevels++;
+    }
+    return numLevels;
+}
+
+bool
+WaveFormPyramid::isCompleted() const NANOEM_DECL_NOEXCEPT
+{
+    return m_numBuiltFrames == m_numFrames;
+}
+
+void
+WaveFormPyramid::accumulateFrames(
+    nanoem_rsize_t beginFrame, nanoem_rsize_t endFrame, Bin &bin) const NANOEM_DECL_NOEXCEPT
+{
+    const nanoem_rsize_t stride = m_bytesPerSample * m_numChannels;
+    const nanoem_u8_t *ptr = m_sourceData + beginFrame * stride;
+    for (nanoem_rsize_t i = beginFrame; i < endFrame; i++) {
+        for (nanoem_u32_t j = 0; j < m_numChannels; j++) {
+            bin.merge(decodeSample(ptr + j * m_bytesPerSample, m_bytesPerSample));
+        }
+        ptr += stride;
+    }
+}
+
+void
+WaveFormPyramid::appendBlock(const Bin &value)
+{
+    Bin bin(value);
+    for (nanoem_rsize_t level = 0; level < kMaxLevels; level++) {
+        BinList &bins = m_levels[level];
+        bins.push_back(bin);
+        const nanoem_rsize_t numBins = bins.size();
+        if (numBins % 2 != 0) {
+            break;
+        }
+        bin = bins[numBins - 2];
+        bin.merge(bins[numBins - 1]);
+    }
+}
+
+} /* namespace internal */
+} /* namespace nanoem */
@@ -1537,6 +1537,7 @@ ModelParameterDialog::layoutAllVertices(Project *project)
             StringUtils::format(buffer, sizeof(buffer), "##vertex[%d].visible", i);
             if (ImGui::Checkbox(buffer, &visible)) {
                 vertex->setEditingMasked(visible ? false : true);
+                m_activeModel->markVertexOverlayDirty(vertexPtr);
             }
             ImGui::SameLine();
             formatVertexText(buffer, sizeof(buffer), vertexPtr);
@@ -1925,6 +1926,7 @@ ModelParameterDialog::layoutAllFaces(Project *project)
                         const nanoem_model_vertex_t *vertexPtr = vertices[facesPtr[j]];
                         if (model::Vertex *vertex = model::Vertex::cast(vertexPtr)) {
                             vertex->setEditingMasked(!vertex->isEditingMasked());
+                            m_activeModel->markVertexOverlayDirty(vertexPtr);
                         }
                     }
                 }
@@ -6135,6 +6137,7 @@ ModelParameterDialog::layoutManipulateVertexMenu(Project *project)
                 const nanoem_model_vertex_t *vertexPtr = *it;
                 if (model::Vertex *vertex = model::Vertex::cast(vertexPtr)) {
                     vertex->setEditingMasked(true);
+                    m_activeModel->markVertexOverlayDirty(vertexPtr);
                 }
             }
         }
@@ -6144,6 +6147,7 @@ ModelParameterDialog::layoutManipulateVertexMenu(Project *project)
                 const nanoem_model_vertex_t *vertexPtr = *it;
                 if (model::Vertex *vertex = model::Vertex::cast(vertexPtr)) {
                     vertex->setEditingMasked(false);
+                    m_activeModel->markVertexOverlayDirty(vertexPtr);
                 }
             }
         }
@@ -6153,6 +6157,7 @@ ModelParameterDialog::layoutManipulateVertexMenu(Project *project)
                 const nanoem_model_vertex_t *vertexPtr = vertices[i];
                 if (model::Vertex *vertex = model::Vertex::cast(vertexPtr)) {
                     vertex->setEditingMasked(!vertex->isEditingMasked());
+                    m_activeModel->markVertexOverlayDirty(vertexPtr);
                 }
             }
         }
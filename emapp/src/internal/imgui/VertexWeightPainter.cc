@@ -53,13 +53,18 @@ VertexWeightPainter::paint(const Vector2SI32 &logicalScaleCursorPosition)
     Model *activeModel = project->activeModel();
     nanoem_rsize_t numVertices;
     nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(activeModel->data(), &numVertices);
+    const Vector2SI32 layoutRect(project->deviceScaleUniformedViewportLayoutRect());
+    const int extent = int(glm::ceil(radius()));
+    const Vector2SI32 deviceScaleViewportCursorPosition(Vector2SI32(deviceScaleCursorPosition) - layoutRect);
+    VertexIndexList candidates;
+    activeModel->collectAllVerticesInViewport(
+        Vector4SI32(deviceScaleViewportCursorPosition - extent, extent * 2, extent * 2), candidates);
     nanoem_status_t status = NANOEM_STATUS_SUCCESS;
-    for (nanoem_rsize_t i = 0; i < numVertices; i++) {
-        nanoem_model_vertex_t *vertexPtr = vertices[i];
+    for (VertexIndexList::const_iterator it = candidates.begin(), end = candidates.end(); it != end; ++it) {
+        nanoem_model_vertex_t *vertexPtr = vertices[*it];
         const model::Vertex *vertex = model::Vertex::cast(vertexPtr);
         if (vertex && !vertex->isEditingMasked()) {
-            const Vector3 origin(glm::make_vec3(nanoemModelVertexGetOrigin(vertexPtr)));
-            const Vector2 cursor(camera->toDeviceScreenCoordinateInWindow(origin));
+            const Vector2 cursor(camera->toDeviceScreenCoordinateInWindow(activeModel->skinnedVertexPosition(*it)));
             if (glm::distance(deviceScaleCursorPosition, cursor) < radius()) {
                 paintVertex(vertexPtr, &status);
             }
@@ -23,6 +23,7 @@
 #include "emapp/ShadowCamera.h"
 #include "emapp/StringUtils.h"
 #include "emapp/UUID.h"
+#include "emapp/internal/FileContentDigestCache.h"
 #include "emapp/internal/project/Archive.h"
 #include "emapp/private/CommonInclude.h"
 
@@ -235,8 +236,9 @@ struct Native::Context {
     void load(const Nanoem__Project__Project *p, FileType fileType, Error &error, Project::IDiagnostics *diagnostics);
 
     String canonicalizeFilePath(const URI &fileURI);
-    static void calculateFileContentDigest(IReader *reader, ProtobufCBinaryData &checksum);
-    bool testFileContentDigest(const URI &fileURI, const ProtobufCBinaryData &checksum, Error &error) const;
+    bool calculateFileContentDigest(const URI &fileURI, ProtobufCBinaryData &checksum, Error &error);
+    bool testFileContentDigest(
+        const URI &fileURI, const ProtobufCBinaryData &checksum, bool retainContent, Error &error);
     Nanoem__Project__Audio *saveAudio(FileType fileType, Error &error);
     Nanoem__Project__Camera *saveCamera();
     Nanoem__Project__Confirmation *saveConfirmation();
@@ -864,12 +866,13 @@ Native::Context::loadAccessoryFromFile(const Nanoem__Project__Accessory *a, nano
     const URI fileURI(toURI(a->file_uri, m_project->fileURI(), isAbsolutePath));
     if (FileUtils::exists(fileURI)) {
         IFileManager *manager = m_project->fileManager();
-        if (testFileContentDigest(fileURI, a->file_checksum, error)) {
+        if (testFileContentDigest(fileURI, a->file_checksum, true, error)) {
             if (manager->loadFromFile(fileURI, IFileManager::kDialogTypeLoadModelFile, m_project, error)) {
                 Accessory *accessory = m_project->allAccessories()->back();
                 loadAccessory(a, accessory, Inline::saturateInt32(numDrawables), drawableOrderList, activeAccessoryPtr);
                 handles.insert(tinystl::make_pair(static_cast<nanoem_u16_t>(a->accessory_handle), accessory->handle()));
             }
+            m_project->fileContentDigestCache()->releaseContent();
         }
         else if (diagnostics) {
             diagnostics->addDigestMismatchFileURI(fileURI);
@@ -953,7 +956,7 @@ Native::Context::loadAllModelMaterialEffects(
          i < numMaterialEffectAttachments; i++) {
         const Nanoem__Project__MaterialEffectAttachment *attachment = m->material_effect_attachments[i];
         const URI fileURI(toURI(attachment->file_uri, m_project->fileURI(), isAbsolutePath));
-        if (testFileContentDigest(fileURI, attachment->file_checksum, error)) {
+        if (testFileContentDigest(fileURI, attachment->file_checksum, false, error)) {
             Effect *effect = m_project->findEffect(fileURI);
             if (effect) {
                 attachModelMaterialEffect(model, effect, attachment->offset);
@@ -1019,7 +1022,7 @@ Native::Context::loadModelFromFile(const Nanoem__Project__Model *m, nanoem_rsize
     const URI fileURI(toURI(m->file_uri, m_project->fileURI(), isAbsolutePath));
     if (FileUtils::exists(fileURI)) {
         IFileManager *manager = m_project->fileManager();
-        if (testFileContentDigest(fileURI, m->file_checksum, error) &&
+        if (testFileContentDigest(fileURI, m->file_checksum, true, error) &&
             manager->loadFromFile(fileURI, IFileManager::kDialogTypeLoadModelFile, m_project, error)) {
             Model *model = m_project->allModels()->back();
             loadModel(m, model, Inline::saturateInt32(numDrawables), drawableOrderList, transformOrderList,
@@ -1027,6 +1030,7 @@ Native::Context::loadModelFromFile(const Nanoem__Project__Model *m, nanoem_rsize
             handles.insert(tinystl::make_pair(static_cast<nanoem_u16_t>(m->model_handle), model->handle()));
             model->setDirty(false);
         }
+        m_project->fileContentDigestCache()->releaseContent();
         if (isAbsolutePath) {
             m_project->setFilePathMode(Project::kFilePathModeAbsolute);
         }
@@ -1390,39 +1394,40 @@ Native::Context::canonicalizeFilePath(const URI &fileURI)
     return path;
 }
 
-void
-Native::Context::calculateFileContentDigest(IReader *reader, ProtobufCBinaryData &checksum)
+bool
+Native::Context::calculateFileContentDigest(const URI &fileURI, ProtobufCBinaryData &checksum, Error &error)
 {
-    SHA256_CTX ctx;
-    Error error;
-    nanoem_u8_t buffer[Inline::kReadingFileContentsBufferSize];
-    nanoem_i32_t actualReadSize;
-    sha256_init(&ctx);
-    while ((actualReadSize = FileUtils::read(reader, buffer, sizeof(buffer), error)) > 0) {
-        sha256_update(&ctx, buffer, actualReadSize);
+    nanoem_u8_t digest[internal::FileContentDigestCache::kDigestSize];
+    bool succeeded = m_project->fileContentDigestCache()->digest(fileURI, digest, error);
+    if (succeeded) {
+        checksum.len = sizeof(digest);
+        checksum.data = new nanoem_u8_t[checksum.len];
+        memcpy(checksum.data, digest, checksum.len);
     }
-    checksum.len = SHA256_BLOCK_SIZE;
-    checksum.data = new nanoem_u8_t[checksum.len];
-    sha256_final(&ctx, checksum.data);
+    return succeeded;
 }
 
 bool
-Native::Context::testFileContentDigest(const URI &fileURI, const ProtobufCBinaryData &checksum, Error &error) const
+Native::Context::testFileContentDigest(
+    const URI &fileURI, const ProtobufCBinaryData &checksum, bool retainContent, Error &error)
 {
-    FileReaderScope scope(nullptr);
+    internal::FileContentDigestCache *cache = m_project->fileContentDigestCache();
+    nanoem_u8_t digest[internal::FileContentDigestCache::kDigestSize];
+    ByteArray bytes;
     bool fileChecksumPassed = false;
-    if (scope.open(fileURI, error)) {
-        ProtobufCBinaryData binary;
-        calculateFileContentDigest(scope.reader(), binary);
-        fileChecksumPassed = checksum.len == binary.len && memcmp(checksum.data, binary.data, binary.len) == 0;
-        if (!fileChecksumPassed) {
+    /* reads the content once and hands it to the loader instead of reading it again after the test */
+    if (retainContent ? cache->readAllBytes(fileURI, bytes, digest, error) : cache->digest(fileURI, digest, error)) {
+        fileChecksumPassed = checksum.len == sizeof(digest) && memcmp(checksum.data, digest, sizeof(digest)) == 0;
+        if (fileChecksumPassed && retainContent) {
+            cache->retainContent(fileURI, bytes);
+        }
+        else if (!fileChecksumPassed) {
             char reason[Error::kMaxRecoverySuggestionLength];
             StringUtils::format(reason, sizeof(reason),
                 m_project->translator()->translate("nanoem.window.dialog.error.file-content-digest.reason"),
                 fileURI.absolutePathConstString());
             error = Error(reason, "", Error::kDomainTypeApplication);
         }
-        delete[] binary.data;
     }
     return fileChecksumPassed;
 }
@@ -1436,11 +1441,9 @@ Native::Context::saveAudio(FileType fileType, Error &error)
     const URI fileURI(audioPtr->fileURI());
     audio->file_uri = newURI(m_project, fileURI, Archive::kBGMEntryPath, fileType);
     audio->volume = audioPtr->volumeGain();
-    FileReaderScope scope(m_project->translator());
     if (fileType == kFileTypeData && m_includeAudioVideoFileContentDigest && !fileURI.isEmpty() &&
-        scope.open(fileURI, error)) {
+        calculateFileContentDigest(fileURI, audio->file_checksum, error)) {
         audio->has_file_checksum = 1;
-        calculateFileContentDigest(scope.reader(), audio->file_checksum);
     }
     return audio;
 }
@@ -1612,11 +1615,9 @@ Native::Context::saveVideo(FileType fileType, Error &error)
         video->file_uri = nanoem_new(Nanoem__Project__URI);
         nanoem__project__uri__init(video->file_uri);
     }
-    FileReaderScope scope(m_project->translator());
     if (fileType == kFileTypeData && m_includeAudioVideoFileContentDigest && !fileURI.isEmpty() &&
-        scope.open(fileURI, error)) {
+        calculateFileContentDigest(fileURI, video->file_checksum, error)) {
         video->has_file_checksum = 1;
-        calculateFileContentDigest(scope.reader(), video->file_checksum);
     }
     video->scale_factor = m_project->backgroundVideoScaleFactor();
     return video;
@@ -1649,10 +1650,9 @@ Native::Context::saveAccessory(Accessory *accessory, FileType fileType, Error &e
     ao->accessory_handle = accessory->handle();
     const URI fileURI(accessory->fileURI());
     ao->file_uri = newURI(m_project, fileURI, ao->path_for_legacy_compatibility, fileType);
-    FileReaderScope scope(m_project->translator());
-    if (fileType == kFileTypeData && !fileURI.isEmpty() && scope.open(fileURI, error)) {
+    if (fileType == kFileTypeData && !fileURI.isEmpty() &&
+        calculateFileContentDigest(fileURI, ao->file_checksum, error)) {
         ao->has_file_checksum = 1;
-        calculateFileContentDigest(scope.reader(), ao->file_checksum);
     }
     if (const Effect *effect = m_project->resolveEffect(accessory)) {
         const StringList includePaths(effect->allIncludePaths());
@@ -1702,7 +1702,6 @@ void
 Native::Context::saveAllModelMaterialAttachments(
     Nanoem__Project__Model *mo, Model *model, FileType fileType, Error &error)
 {
-    FileReaderScope scope(m_project->translator());
     nanoem_rsize_t numMaterials;
     nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(model->data(), &numMaterials);
     if (numMaterials > 0) {
@@ -1722,9 +1721,9 @@ Native::Context::saveAllModelMaterialAttachments(
                     copyString(attachment->path_for_legacy_compatibility, "");
                     attachment->file_uri =
                         newURI(m_project, fileURI, attachment->path_for_legacy_compatibility, fileType);
-                    if (fileType == kFileTypeData && !fileURI.isEmpty() && scope.open(fileURI, error)) {
+                    if (fileType == kFileTypeData && !fileURI.isEmpty() &&
+                        calculateFileContentDigest(fileURI, attachment->file_checksum, error)) {
                         attachment->has_file_checksum = 1;
-                        calculateFileContentDigest(scope.reader(), attachment->file_checksum);
                     }
                 }
             }
@@ -1769,10 +1768,9 @@ Native::Context::saveModel(Model *model, FileType fileType, Error &error)
     mo->model_handle = model->handle();
     const URI fileURI(model->fileURI());
     mo->file_uri = newURI(m_project, fileURI, mo->path_for_legacy_compatibility, fileType);
-    FileReaderScope scope(m_project->translator());
-    if (fileType == kFileTypeData && !fileURI.isEmpty() && scope.open(fileURI, error)) {
+    if (fileType == kFileTypeData && !fileURI.isEmpty() &&
+        calculateFileContentDigest(fileURI, mo->file_checksum, error)) {
         mo->has_file_checksum = 1;
-        calculateFileContentDigest(scope.reader(), mo->file_checksum);
     }
     saveAllModelMaterialAttachments(mo, model, fileType, error);
     saveAllIncludeEffectSources(mo, model);
@@ -1947,10 +1945,9 @@ Native::Context::saveOffscreenRenderTargetEffect(
                 copyString(attachment->path, filename);
                 const URI fileURI(effect->fileURI());
                 attachment->file_uri = newURI(m_project, fileURI, filename, fileType);
-                FileReaderScope scope(m_project->translator());
-                if (fileType == kFileTypeData && !fileURI.isEmpty() && scope.open(fileURI, error)) {
+                if (fileType == kFileTypeData && !fileURI.isEmpty() &&
+                    calculateFileContentDigest(fileURI, attachment->file_checksum, error)) {
                     attachment->has_file_checksum = 1;
-                    calculateFileContentDigest(scope.reader(), attachment->file_checksum);
                 }
                 const StringList includePaths(effect->allIncludePaths());
                 if (!includePaths.empty()) {
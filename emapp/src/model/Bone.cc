@@ -807,6 +807,16 @@ Bone::synchronizeTransform(const Motion *motion, const nanoem_model_bone_t *bone
             const nanoem_motion_bone_keyframe_t *interpolateKeyframe = nextKeyframe;
             const Vector3 translation0(toVector3(prevKeyframe)), translation1(toVector3(nextKeyframe));
             const nanoem_f32_t coef = Motion::coefficient(prevKeyframe, nextKeyframe, frameIndex);
+            Vector4 bezierCoefficients(coef);
+            for (int i = NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM;
+                 motion && i < NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM; i++) {
+                /* all four curves are evaluated at once if any of them is not linear */
+                if (!nanoemMotionBoneKeyframeIsLinearInterpolation(
+                        interpolateKeyframe, nanoem_motion_bone_keyframe_interpolation_type_t(i))) {
+                    bezierCoefficients = motion->bezierCurves(prevKeyframe, nextKeyframe, coef);
+                    break;
+                }
+            }
             const bool prevEnabled = nanoemMotionBoneKeyframeIsPhysicsSimulationEnabled(prevKeyframe),
                        nextEnabled = nanoemMotionBoneKeyframeIsPhysicsSimulationEnabled(nextKeyframe);
             if (prevEnabled && !nextEnabled && rigidBodyPtr) {
@@ -830,8 +840,7 @@ Bone::synchronizeTransform(const Motion *motion, const nanoem_model_bone_t *bone
                         transform.m_translation[i] = glm::mix(v0, v1, coef);
                     }
                     else if (motion) {
-                        nanoem_f32_t t2 = motion->bezierCurve(prevKeyframe, nextKeyframe, type, coef);
-                        transform.m_translation[i] = glm::mix(v0, v1, t2);
+                        transform.m_translation[i] = glm::mix(v0, v1, bezierCoefficients[i]);
                         transform.m_bezierControlPoints[i] =
                             glm::make_vec4(nanoemMotionBoneKeyframeGetInterpolation(interpolateKeyframe, type));
                         transform.m_enableLinearInterpolation[i] = false;
@@ -847,8 +856,7 @@ Bone::synchronizeTransform(const Motion *motion, const nanoem_model_bone_t *bone
                 transform.m_orientation = glm::slerp(orientation0, orientation1, coef);
             }
             else if (motion) {
-                nanoem_f32_t t2 = motion->bezierCurve(
-                    prevKeyframe, nextKeyframe, NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_ORIENTATION, coef);
+                const nanoem_f32_t t2 = bezierCoefficients[NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_ORIENTATION];
                 transform.m_orientation = glm::slerp(orientation0, orientation1, t2);
                 transform.m_bezierControlPoints[NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_ORIENTATION] =
                     glm::make_vec4(nanoemMotionBoneKeyframeGetInterpolation(
@@ -913,12 +921,20 @@ Bone::solveConstraint(const nanoem_model_constraint_t *constraintPtr, int numIte
         return;
     }
     const Vector4 targetBonePosition(targetBone->worldTransformOrigin(), 1);
+    /* iteration results are only kept for the heatmap and all iterations must be run to fill them */
+    const bool traceEnabled = constraintUserData->isIterationTraceEnabled();
     for (int i = 0; i < numIterations; i++) {
         const bool firstIteration = i == 0;
+        if (!traceEnabled && !firstIteration &&
+            Constraint::isConverged(effectorBone->worldTransformOrigin(), Vector3(targetBonePosition))) {
+            break;
+        }
+        bool rotated = false;
         for (nanoem_rsize_t j = 0; j < numJoints; j++) {
             const nanoem_model_constraint_joint_t *joint = joints[j];
             Bone *jointBone = Bone::cast(nanoemModelConstraintJointGetBoneObject(joint));
-            Constraint::Joint *jointResult = constraintUserData->jointIterationResult(joint, i);
+            Constraint::Joint *jointResult =
+                traceEnabled ? constraintUserData->jointIterationResult(joint, i) : constraintUserData->scratchJoint();
             const Vector4 effectorBonePosition(effectorBone->worldTransformOrigin(), 1);
             if (jointBone &&
                 !Constraint::solveAxisAngle(
@@ -965,12 +981,19 @@ Bone::solveConstraint(const nanoem_model_constraint_t *constraintPtr, int numIte
                     upperJointBone->updateLocalTransform(upperJointBonePtr, upperJointBone->localTranslation(),
                         upperJointBone->constraintJointOrientation());
                 }
-                jointResult->setTransform(jointBone->worldTransform());
                 effectorBone->updateLocalTransform(effectorBonePtr);
-                Constraint::Joint *effectorResult = constraintUserData->effectorIterationResult(joint, i);
-                effectorResult->setTransform(effectorBone->worldTransform());
+                if (traceEnabled) {
+                    jointResult->setTransform(jointBone->worldTransform());
+                    Constraint::Joint *effectorResult = constraintUserData->effectorIterationResult(joint, i);
+                    effectorResult->setTransform(effectorBone->worldTransform());
+                }
+                rotated = true;
             }
         }
+        /* next iterations see exactly the same transforms and never rotate any joint */
+        if (!rotated && !traceEnabled) {
+            break;
+        }
     }
 }
 
@@ -13,6 +13,7 @@
 #include "emapp/private/CommonInclude.h"
 
 #include "glm/gtc/matrix_inverse.hpp"
+#include "glm/gtx/norm.hpp"
 #include "glm/gtx/vector_query.hpp"
 
 namespace nanoem {
@@ -21,9 +22,12 @@ namespace {
 
 enum PrivateStateFlags {
     kPrivateStateEnabled = 1 << 1,
+    kPrivateStateIterationTraceEnabled = 1 << 2,
     kPrivateStateReserved = 1 << 31,
 };
 static const nanoem_u32_t kPrivateStateInitialValue = kPrivateStateEnabled;
+/* squared distance between effector and target treated as reached (0.0001 in model space) */
+static const nanoem_f32_t kConvergenceThreshold = 1.0e-8f;
 
 } /* namespade anonymous */
 
@@ -131,6 +135,12 @@ Constraint::hasUnitXConstraint(
             reinterpret_cast<const char *>(buffer), reinterpret_cast<const char *>(model::Bone::kRightKneeInJapanese));
 }
 
+bool
+Constraint::isConverged(const Vector3 &effectorPosition, const Vector3 &targetPosition) NANOEM_DECL_NOEXCEPT
+{
+    return glm::distance2(effectorPosition, targetPosition) <= kConvergenceThreshold;
+}
+
 void
 Constraint::bind(nanoem_model_constraint_t *constraintPtr)
 {
@@ -204,6 +214,13 @@ Constraint::effectorIterationResult(const nanoem_model_constraint_joint_t *joint
     return &m_effectorIterationResult[joint][offset];
 }
 
+Constraint::Joint *
+Constraint::scratchJoint() NANOEM_DECL_NOEXCEPT
+{
+    /* reused by every untraced solve instead of the per-joint iteration results */
+    return &m_scratchJoint;
+}
+
 String
 Constraint::name() const
 {
@@ -240,6 +257,18 @@ Constraint::setEnabled(bool value)
     EnumUtils::setEnabled(kPrivateStateEnabled, m_states, value);
 }
 
+bool
+Constraint::isIterationTraceEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return EnumUtils::isEnabled(kPrivateStateIterationTraceEnabled, m_states);
+}
+
+void
+Constraint::setIterationTraceEnabled(bool value)
+{
+    EnumUtils::setEnabled(kPrivateStateIterationTraceEnabled, m_states, value);
+}
+
 void
 Constraint::destroy(void *opaque, nanoem_model_object_t * /* constraintPtr */) NANOEM_DECL_NOEXCEPT
 {
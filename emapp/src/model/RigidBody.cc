@@ -98,6 +98,7 @@ RigidBody::getWorldTransform(
 
 void
 RigidBody::synchronizeTransformFeedbackFromSimulation(const nanoem_model_rigid_body_t *rigidBodyPtr,
+    const nanoem_f32_t *initialTransformPtr, const nanoem_f32_t *worldTransformPtr,
     PhysicsEngine::RigidBodyFollowBoneType followType) NANOEM_DECL_NOEXCEPT
 {
     nanoem_parameter_assert(rigidBodyPtr, "must not be nullptr");
@@ -109,14 +110,13 @@ RigidBody::synchronizeTransformFeedbackFromSimulation(const nanoem_model_rigid_b
         if (Bone *bone = Bone::cast(bonePtr)) {
             const nanoem_model_rigid_body_transform_type_t type = nanoemModelRigidBodyGetTransformType(rigidBodyPtr);
 #if 1
-            Matrix4x4 worldTransform, initialTransform;
-            nanoem_physics_motion_state_t *state = m_physicsEngine->motionState(m_physicsRigidBody);
-            m_physicsEngine->getInitialTransform(state, glm::value_ptr(initialTransform));
-            m_physicsEngine->getWorldTransform(state, glm::value_ptr(worldTransform));
+            const Matrix4x4 initialTransform(glm::make_mat4(initialTransformPtr));
+            Matrix4x4 worldTransform(glm::make_mat4(worldTransformPtr));
             if (followType == PhysicsEngine::kRigidBodyFollowBonePerform &&
                 type == NANOEM_MODEL_RIGID_BODY_TRANSFORM_TYPE_FROM_BONE_ORIENTATION_AND_SIMULATION_TO_BONE) {
                 const Matrix4x4 localTransform(bone->localTransform());
                 worldTransform = glm::translate(Constants::kIdentity, -Vector3(localTransform[3])) * worldTransform;
+                nanoem_physics_motion_state_t *state = m_physicsEngine->motionState(m_physicsRigidBody);
                 m_physicsEngine->setWorldTransform(state, glm::value_ptr(worldTransform));
             }
             const Matrix4x4 skinningTransform(worldTransform * glm::affineInverse(initialTransform));
@@ -162,22 +162,26 @@ RigidBody::synchronizeTransformFeedbackFromSimulation(const nanoem_model_rigid_b
     }
 }
 
-void
-RigidBody::synchronizeTransformFeedbackToSimulation(const nanoem_model_rigid_body_t *rigidBodyPtr) NANOEM_DECL_NOEXCEPT
+bool
+RigidBody::synchronizeTransformFeedbackToSimulation(const nanoem_model_rigid_body_t *rigidBodyPtr,
+    const nanoem_f32_t *initialTransformPtr, nanoem_f32_t *worldTransformPtr) NANOEM_DECL_NOEXCEPT
 {
     nanoem_parameter_assert(rigidBodyPtr, "must not be nullptr");
     const nanoem_model_rigid_body_transform_type_t transformType = nanoemModelRigidBodyGetTransformType(rigidBodyPtr);
+    bool updated = false;
     if (transformType == NANOEM_MODEL_RIGID_BODY_TRANSFORM_TYPE_FROM_BONE_TO_SIMULATION || isKinematic()) {
         if (const Bone *bone = Bone::cast(nanoemModelRigidBodyGetBoneObject(rigidBodyPtr))) {
-            nanoem_physics_motion_state_t *state = m_physicsEngine->motionState(m_physicsRigidBody);
+            /* the caller writes world transform to the motion state so resetting states comes first */
             bx::float4x4_t initialTransform, worldTransform;
-            m_physicsEngine->getInitialTransform(state, reinterpret_cast<nanoem_f32_t *>(&initialTransform));
+            memcpy(&initialTransform, initialTransformPtr, sizeof(initialTransform));
             const bx::float4x4_t skinningTransformMatrix = bone->skinningTransformMatrix();
             bx::float4x4_mul(&worldTransform, &initialTransform, &skinningTransformMatrix);
-            m_physicsEngine->setWorldTransform(state, reinterpret_cast<const nanoem_f32_t *>(&worldTransform));
+            memcpy(worldTransformPtr, &worldTransform, sizeof(worldTransform));
             m_physicsEngine->resetStates(m_physicsRigidBody);
+            updated = true;
         }
     }
+    return updated;
 }
 
 void
@@ -139,14 +139,22 @@ void
 SoftBody::synchronizeTransformFeedbackFromSimulation(
     Model::VertexUnit *vertexUnits, nanoem_rsize_t numVertices) NANOEM_DECL_NOEXCEPT
 {
-    int numSoftBodyVertices = m_physicsEngine->numSoftBodyVertices(m_physicsSoftBody);
-    for (int i = 0; i < numSoftBodyVertices; i++) {
-        const nanoem_model_vertex_t *vertexPtr = m_physicsEngine->resolveSoftBodyVertexObject(m_physicsSoftBody, i);
-        nanoem_rsize_t vertexIndex = static_cast<nanoem_rsize_t>(model::Vertex::index(vertexPtr));
-        if (nanoem_likely(vertexIndex < numVertices)) {
-            Model::VertexUnit &vertexUnit = vertexUnits[vertexIndex];
-            getVertexPosition(i, &vertexUnit.m_position);
-            getVertexNormal(i, &vertexUnit.m_normal);
+    const int numSoftBodyVertices = m_physicsEngine->numSoftBodyVertices(m_physicsSoftBody);
+    if (numSoftBodyVertices > 0) {
+        /* fetch all vertices at once to avoid crossing the physics bridge per vertex */
+        const nanoem_rsize_t numComponents = nanoem_rsize_t(numSoftBodyVertices) * 4;
+        m_vertexPositions.resize(numComponents);
+        m_vertexNormals.resize(numComponents);
+        m_physicsEngine->getAllSoftBodyVertexPositions(m_physicsSoftBody, m_vertexPositions.data());
+        m_physicsEngine->getAllSoftBodyVertexNormals(m_physicsSoftBody, m_vertexNormals.data());
+        for (int i = 0; i < numSoftBodyVertices; i++) {
+            const nanoem_model_vertex_t *vertexPtr = m_physicsEngine->resolveSoftBodyVertexObject(m_physicsSoftBody, i);
+            nanoem_rsize_t vertexIndex = static_cast<nanoem_rsize_t>(model::Vertex::index(vertexPtr));
+            if (nanoem_likely(vertexIndex < numVertices)) {
+                Model::VertexUnit &vertexUnit = vertexUnits[vertexIndex];
+                memcpy(&vertexUnit.m_position, &m_vertexPositions[i * 4], sizeof(vertexUnit.m_position));
+                memcpy(&vertexUnit.m_normal, &m_vertexNormals[i * 4], sizeof(vertexUnit.m_normal));
+            }
         }
     }
 }
@@ -157,16 +165,29 @@ SoftBody::synchronizeTransformFeedbackToSimulation(
 {
     nanoem_rsize_t numIndices;
     const nanoem_u32_t *indices = nanoemModelSoftBodyGetAllPinnedVertexIndices(softBodyPtr, &numIndices);
+    m_pinnedVertexOffsets.clear();
+    m_vertexPositions.clear();
+    m_vertexNormals.clear();
     for (nanoem_rsize_t i = 0; i < numIndices; i++) {
         const nanoem_u32_t index = indices[i];
         const nanoem_model_vertex_t *vertexPtr = m_physicsEngine->resolveSoftBodyVertexObject(m_physicsSoftBody, index);
         nanoem_rsize_t vertexIndex = static_cast<nanoem_rsize_t>(model::Vertex::index(vertexPtr));
         if (nanoem_likely(vertexIndex < numVertices)) {
             const Model::VertexUnit &vertexUnit = vertexUnits[vertexIndex];
-            setVertexPosition(index, &vertexUnit.m_position);
-            setVertexNormal(index, &vertexUnit.m_normal);
+            const nanoem_f32_t *position = reinterpret_cast<const nanoem_f32_t *>(&vertexUnit.m_position),
+                               *normal = reinterpret_cast<const nanoem_f32_t *>(&vertexUnit.m_normal);
+            m_pinnedVertexOffsets.push_back(int(index));
+            m_vertexPositions.insert(m_vertexPositions.end(), position, position + 4);
+            m_vertexNormals.insert(m_vertexNormals.end(), normal, normal + 4);
         }
     }
+    if (!m_pinnedVertexOffsets.empty()) {
+        const nanoem_rsize_t numOffsets = m_pinnedVertexOffsets.size();
+        m_physicsEngine->setAllSoftBodyVertexPositions(
+            m_physicsSoftBody, m_pinnedVertexOffsets.data(), numOffsets, m_vertexPositions.data());
+        m_physicsEngine->setAllSoftBodyVertexNormals(
+            m_physicsSoftBody, m_pinnedVertexOffsets.data(), numOffsets, m_vertexNormals.data());
+    }
 }
 
 void
@@ -27,6 +27,8 @@ EncoderPlugin::EncoderPlugin(IEventPublisher *publisher)
     , _encoderSetOption(nullptr)
     , _encoderEncodeAudioFrame(nullptr)
     , _encoderEncodeVideoFrame(nullptr)
+    , _encoderAcquireVideoFrameBuffer(nullptr)
+    , _encoderSubmitVideoFrameBuffer(nullptr)
     , _encoderInterrupt(nullptr)
     , _encoderGetAllAvailableVideoFormatExtensions(nullptr)
     , _encoderLoadUIWindowLayout(nullptr)
@@ -101,6 +103,11 @@ EncoderPlugin::load(const URI &fileURI)
                     _encoderGetUIWindowLayoutData, valid);
                 Inline::resolveSymbol(handle, "nanoemApplicationPluginEncoderSetUIComponentLayoutData",
                     _encoderSetUIComponentLayoutData, valid);
+                // ABI version 2.1
+                Inline::resolveSymbol(handle, "nanoemApplicationPluginEncoderAcquireVideoFrameBuffer",
+                    _encoderAcquireVideoFrameBuffer);
+                Inline::resolveSymbol(handle, "nanoemApplicationPluginEncoderSubmitVideoFrameBuffer",
+                    _encoderSubmitVideoFrameBuffer);
                 m_handle = handle;
                 m_name = fileURI.lastPathComponent();
                 _encoderInitialize();
@@ -214,6 +221,27 @@ EncoderPlugin::encodeVideoFrame(
     return succeeded;
 }
 
+nanoem_u8_t *
+EncoderPlugin::acquireVideoFrameBuffer(size_t size, Error &error)
+{
+    nanoem_u8_t *data = nullptr;
+    if (!m_interrupted && _encoderAcquireVideoFrameBuffer && _encoderSubmitVideoFrameBuffer) {
+        int status = NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS;
+        data = _encoderAcquireVideoFrameBuffer(m_encoder, Inline::saturateInt32U(size), &status);
+        handlePluginStatus(status, error);
+    }
+    return data;
+}
+
+bool
+EncoderPlugin::submitVideoFrameBuffer(nanoem_frame_index_t currentLocalFrameIndex, nanoem_u8_t *data, Error &error)
+{
+    int status = NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS;
+    _encoderSubmitVideoFrameBuffer(m_encoder, currentLocalFrameIndex, data, &status);
+    handlePluginStatus(status, error);
+    return status == NANOEM_APPLICATION_PLUGIN_STATUS_SUCCESS;
+}
+
 void
 EncoderPlugin::interrupt()
 {
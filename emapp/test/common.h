@@ -183,6 +183,7 @@ public:
 
         nanoem::Accessory *createAccessory(const char *filename = "test.x");
         nanoem::Model *createModel(const char *filename = "test.pmx");
+        nanoem::Model *createSkinnedModel();
         nanoem::Effect *createBinaryEffect(nanoem::IDrawable *drawable, const char *filename = "test.fxn");
         nanoem::Effect *createSourceEffect(nanoem::IDrawable *drawable, const char *filename, bool inspection = false);
         nanoem::Project::AccessoryList allAccessories();
@@ -227,6 +228,7 @@ public:
     static const nanoem_model_morph_t *findRandomMorph(const nanoem::Model *model);
     static nanoem::Accessory *createAccessory(nanoem::Project *project, const char *filename);
     static nanoem::Model *createModel(nanoem::Project *project, const char *filename);
+    static nanoem::Model *createSkinnedModel(nanoem::Project *project);
     static nanoem::Effect *createBinaryEffect(
         nanoem::Project *project, nanoem::IDrawable *drawable, const char *filename);
     static nanoem::Effect *createSourceEffect(
@@ -123,6 +123,12 @@ TestScope::Object::createModel(const char *filename)
     return TestScope::createModel(m_project, filename);
 }
 
+Model *
+TestScope::Object::createSkinnedModel()
+{
+    return TestScope::createSkinnedModel(m_project);
+}
+
 Effect *
 TestScope::Object::createBinaryEffect(IDrawable *drawable, const char *filename)
 {
@@ -388,6 +394,109 @@ TestScope::createModel(Project *project, const char *filename)
     return model;
 }
 
+Model *
+TestScope::createSkinnedModel(Project *project)
+{
+    /* test.pmx has no vertices so skinning and picking are tested with this generated model */
+    static const char *const kBoneNames[] = { "root", "child" };
+    static const Vector3 kBoneOrigins[] = { Vector3(0, 0, 0), Vector3(0, 5, 0) };
+    static const Vector3 kVertexOrigins[] = { Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(0, 5, 0), Vector3(1, 5, 0) };
+    static const nanoem_u32_t kVertexIndices[] = { 0, 1, 2, 1, 3, 2 };
+    nanoem_unicode_string_factory_t *factory = project->unicodeStringFactory();
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_buffer_t *mutableBuffer = nanoemMutableBufferCreate(&status);
+    nanoem_mutable_model_t *mutableModel = nanoemMutableModelCreate(factory, &status);
+    nanoem_model_t *originModel = nanoemMutableModelGetOriginObject(mutableModel);
+    StringUtils::UnicodeStringScope scope(factory);
+    nanoemMutableModelSetCodecType(mutableModel, NANOEM_CODEC_TYPE_UTF16);
+    nanoemMutableModelSetFormatType(mutableModel, NANOEM_MODEL_FORMAT_TYPE_PMX_2_0);
+    if (StringUtils::tryGetString(factory, "skinned", scope)) {
+        nanoemMutableModelSetName(mutableModel, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+    }
+    const nanoem_model_bone_t *bones[BX_COUNTOF(kBoneNames)];
+    for (nanoem_rsize_t i = 0; i < BX_COUNTOF(kBoneNames); i++) {
+        nanoem_mutable_model_bone_t *mutableBone = nanoemMutableModelBoneCreate(originModel, &status);
+        StringUtils::tryGetString(factory, kBoneNames[i], scope);
+        nanoemMutableModelBoneSetName(mutableBone, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+        if (i > 0) {
+            nanoemMutableModelBoneSetParentBoneObject(mutableBone, bones[i - 1]);
+        }
+        nanoemMutableModelBoneSetOrigin(mutableBone, glm::value_ptr(Vector4(kBoneOrigins[i], 1)));
+        nanoemMutableModelBoneSetVisible(mutableBone, true);
+        nanoemMutableModelBoneSetMovable(mutableBone, true);
+        nanoemMutableModelBoneSetRotateable(mutableBone, true);
+        nanoemMutableModelBoneSetUserHandleable(mutableBone, true);
+        nanoemMutableModelInsertBoneObject(mutableModel, mutableBone, -1, &status);
+        bones[i] = nanoemMutableModelBoneGetOriginObject(mutableBone);
+        nanoemMutableModelBoneDestroy(mutableBone);
+    }
+    const nanoem_model_vertex_t *vertices[BX_COUNTOF(kVertexOrigins)];
+    for (nanoem_rsize_t i = 0; i < BX_COUNTOF(kVertexOrigins); i++) {
+        nanoem_mutable_model_vertex_t *mutableVertex = nanoemMutableModelVertexCreate(originModel, &status);
+        nanoemMutableModelVertexSetOrigin(mutableVertex, glm::value_ptr(Vector4(kVertexOrigins[i], 1)));
+        nanoemMutableModelVertexSetNormal(mutableVertex, glm::value_ptr(Vector4(0, 0, -1, 0)));
+        if (i == 3) {
+            /* the last vertex is shared by both bones */
+            nanoemMutableModelVertexSetType(mutableVertex, NANOEM_MODEL_VERTEX_TYPE_BDEF2);
+            nanoemMutableModelVertexSetBoneObject(mutableVertex, bones[0], 0);
+            nanoemMutableModelVertexSetBoneObject(mutableVertex, bones[1], 1);
+            nanoemMutableModelVertexSetBoneWeight(mutableVertex, 0.5f, 0);
+            nanoemMutableModelVertexSetBoneWeight(mutableVertex, 0.5f, 1);
+        }
+        else {
+            nanoemMutableModelVertexSetType(mutableVertex, NANOEM_MODEL_VERTEX_TYPE_BDEF1);
+            nanoemMutableModelVertexSetBoneObject(mutableVertex, bones[i / 2], 0);
+            nanoemMutableModelVertexSetBoneWeight(mutableVertex, 1, 0);
+        }
+        nanoemMutableModelInsertVertexObject(mutableModel, mutableVertex, -1, &status);
+        vertices[i] = nanoemMutableModelVertexGetOriginObject(mutableVertex);
+        nanoemMutableModelVertexDestroy(mutableVertex);
+    }
+    nanoemMutableModelSetVertexIndices(mutableModel, kVertexIndices, BX_COUNTOF(kVertexIndices), &status);
+    nanoem_mutable_model_material_t *mutableMaterial = nanoemMutableModelMaterialCreate(originModel, &status);
+    nanoemMutableModelMaterialSetDiffuseColor(mutableMaterial, glm::value_ptr(Vector4(1, 1, 1, 0)));
+    nanoemMutableModelMaterialSetDiffuseOpacity(mutableMaterial, 1.0f);
+    nanoemMutableModelMaterialSetNumVertexIndices(mutableMaterial, BX_COUNTOF(kVertexIndices));
+    nanoemMutableModelInsertMaterialObject(mutableModel, mutableMaterial, -1, &status);
+    nanoemMutableModelMaterialDestroy(mutableMaterial);
+    /* moves the first vertex by one unit along Y axis */
+    nanoem_mutable_model_morph_t *mutableMorph = nanoemMutableModelMorphCreate(originModel, &status);
+    StringUtils::tryGetString(factory, "vertex", scope);
+    nanoemMutableModelMorphSetName(mutableMorph, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+    nanoemMutableModelMorphSetCategory(mutableMorph, NANOEM_MODEL_MORPH_CATEGORY_OTHER);
+    nanoemMutableModelMorphSetType(mutableMorph, NANOEM_MODEL_MORPH_TYPE_VERTEX);
+    nanoem_mutable_model_morph_vertex_t *mutableVertexMorph =
+        nanoemMutableModelMorphVertexCreate(mutableMorph, &status);
+    nanoemMutableModelMorphVertexSetVertexObject(mutableVertexMorph, vertices[0]);
+    nanoemMutableModelMorphVertexSetPosition(mutableVertexMorph, glm::value_ptr(Vector4(0, 1, 0, 0)));
+    nanoemMutableModelMorphInsertVertexMorphObject(mutableMorph, mutableVertexMorph, -1, &status);
+    nanoemMutableModelMorphVertexDestroy(mutableVertexMorph);
+    nanoemMutableModelInsertMorphObject(mutableModel, mutableMorph, -1, &status);
+    nanoemMutableModelMorphDestroy(mutableMorph);
+    nanoemMutableModelSaveToBuffer(mutableModel, mutableBuffer, &status);
+    nanoem_buffer_t *buffer = nanoemMutableBufferCreateBufferObject(mutableBuffer, &status);
+    const nanoem_u8_t *dataPtr = nanoemBufferGetDataPtr(buffer);
+    ByteArray bytes;
+    bytes.assign(dataPtr, dataPtr + nanoemBufferGetLength(buffer));
+    nanoemBufferDestroy(buffer);
+    nanoemMutableModelDestroy(mutableModel);
+    nanoemMutableBufferDestroy(mutableBuffer);
+    Model *model = project->createModel();
+    Error error;
+    model->setFileURI(URI::createFromFilePath("skinned.pmx"));
+    if (model->load(bytes, error)) {
+        model->setupAllBindings();
+        model->upload();
+        model->setVisible(true);
+    }
+    else {
+        WARN(error.reasonConstString());
+        project->destroyModel(model);
+        model = nullptr;
+    }
+    return model;
+}
+
 Effect *
 TestScope::createBinaryEffect(Project *project, IDrawable *drawable, const char *filename)
 {
@@ -0,0 +1,126 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Constants.h"
+#include "emapp/Effect.h"
+#include "emapp/Model.h"
+#include "emapp/Progress.h"
+#include "emapp/effect/GlobalUniform.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static void
+setAllParameters(Project *project, Model *model, const nanoem_model_material_t *materialPtr, IPass *pass)
+{
+    pass->setGlobalParameters(model, project);
+    pass->setCameraParameters(project->globalCamera(), Constants::kIdentity);
+    pass->setLightParameters(project->globalLight(), false);
+    pass->setAllModelParameters(model, project);
+    pass->setMaterialParameters(materialPtr);
+    pass->setShadowMapParameters(project->shadowCamera(), Constants::kIdentity);
+}
+
+static void
+setBlockParameters(effect::GlobalUniform::BlockType type, Project *project, Model *model, IPass *pass)
+{
+    switch (type) {
+    case effect::GlobalUniform::kBlockTypeGlobal:
+        pass->setGlobalParameters(model, project);
+        break;
+    case effect::GlobalUniform::kBlockTypeCamera:
+        pass->setCameraParameters(project->globalCamera(), Constants::kIdentity);
+        break;
+    case effect::GlobalUniform::kBlockTypeLight:
+        pass->setLightParameters(project->globalLight(), false);
+        break;
+    case effect::GlobalUniform::kBlockTypeDrawable:
+        pass->setAllModelParameters(model, project);
+        break;
+    case effect::GlobalUniform::kBlockTypeShadowMap:
+        pass->setShadowMapParameters(project->shadowCamera(), Constants::kIdentity);
+        break;
+    default:
+        break;
+    }
+}
+
+static nanoem_u64_t
+countBlockWrittenBytes(effect::GlobalUniform::BlockType type, Project *project, Model *model, IPass *pass,
+    effect::GlobalUniform *uniform)
+{
+    const nanoem_u64_t numWrittenBytes = uniform->m_numWrittenBytes;
+    uniform->invalidate(type);
+    setBlockParameters(type, project, model, pass);
+    return uniform->m_numWrittenBytes - numWrittenBytes;
+}
+
+static nanoem_u64_t
+countAllRetainedBlockWrittenBytes(Project *project, Model *model, IPass *pass, effect::GlobalUniform *uniform)
+{
+    nanoem_u64_t numWrittenBytes = 0;
+    for (int i = effect::GlobalUniform::kBlockTypeFirstEnum; i < effect::GlobalUniform::kBlockTypeMaxEnum; i++) {
+        numWrittenBytes +=
+            countBlockWrittenBytes(static_cast<effect::GlobalUniform::BlockType>(i), project, model, pass, uniform);
+    }
+    return numWrittenBytes;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("effect_parameter_block_written_once_per_drawable", "[emapp][effect]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    Model *model = o->createModel();
+    project->addModel(model);
+    Effect *effect = o->createSourceEffect(model, "effects/parameters/camera/matrix.fx", true);
+    Progress progress(project, 0);
+    Error error;
+    effect->upload(effect::kAttachmentTypeNone, progress, error);
+    nanoem_rsize_t numMaterials;
+    nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(model->data(), &numMaterials);
+    ITechnique *technique = effect->findTechnique(Effect::kPassTypeObject, materials[0], 0, numMaterials, model);
+    REQUIRE(technique);
+    IPass *pass = technique->execute(model, false);
+    REQUIRE(pass);
+    effect::GlobalUniform *uniform = effect->globalUniform();
+    uniform->endFrame();
+    setAllParameters(project, model, materials[0], pass);
+    const nanoem_u64_t numFirstWrittenBytes = uniform->m_numWrittenBytes;
+    CHECK(numFirstWrittenBytes > 0);
+    const effect::GlobalUniform::Vector4List vertexBuffer(uniform->m_vertexShaderBuffer.m_float4);
+    /* sizes of the retained blocks are measured by writing each block again after releasing only that block */
+    const nanoem_u64_t numCameraBlockBytes =
+        countBlockWrittenBytes(effect::GlobalUniform::kBlockTypeCamera, project, model, pass, uniform);
+    const nanoem_u64_t numRetainedBlockBytes = countAllRetainedBlockWrittenBytes(project, model, pass, uniform);
+    CHECK(numCameraBlockBytes > 0);
+    CHECK(numRetainedBlockBytes >= numCameraBlockBytes);
+    CHECK(numRetainedBlockBytes <= numFirstWrittenBytes);
+    /* all blocks are retained and only material parameters are written for the next material */
+    const nanoem_u64_t numBaseWrittenBytes = uniform->m_numWrittenBytes;
+    setAllParameters(project, model, materials[0], pass);
+    const nanoem_u64_t numSecondWrittenBytes = uniform->m_numWrittenBytes - numBaseWrittenBytes;
+    CHECK(numSecondWrittenBytes + numRetainedBlockBytes <= numFirstWrittenBytes);
+    CHECK(memcmp(vertexBuffer.data(), uniform->m_vertexShaderBuffer.m_float4.data(),
+              vertexBuffer.size() * sizeof(vertexBuffer[0])) == 0);
+    /* changing world matrix must write the whole camera block again */
+    pass->setCameraParameters(project->globalCamera(), Matrix4x4(2));
+    CHECK(uniform->m_numWrittenBytes - numBaseWrittenBytes - numSecondWrittenBytes == numCameraBlockBytes);
+    pass->setCameraParameters(project->globalCamera(), Constants::kIdentity);
+    const nanoem_u64_t numFrameWrittenBytes = uniform->m_numWrittenBytes;
+    uniform->endFrame();
+    CHECK(uniform->m_numLastFrameWrittenBytes == numFrameWrittenBytes);
+    CHECK(uniform->m_numWrittenBytes == 0);
+    /* all blocks are written again in the next frame */
+    setAllParameters(project, model, materials[0], pass);
+    CHECK(uniform->m_numWrittenBytes == numFirstWrittenBytes);
+}
@@ -0,0 +1,301 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Effect.h"
+#include "emapp/Model.h"
+#include "emapp/Progress.h"
+#include "emapp/effect/GlobalUniform.h"
+#include "emapp/effect/Pass.h"
+#include "emapp/effect/Technique.h"
+
+#include <random>
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+/* same as Fx9__Effect__Dx9ms__Opcode and Fx9__Effect__Dx9ms__OperandType */
+enum {
+    kOpcodeMov = 1,
+    kOpcodeRcp = 3,
+    kOpcodeFrc = 4,
+    kOpcodeSin = 8,
+    kOpcodeLt = 15,
+    kOpcodeAdd = 17,
+    kOpcodeMul = 18,
+    kOpcodeDiv = 20,
+    kOpcodeCmp = 21,
+    kOpcodeDot = 23,
+    kOpcodeMinScalar = 25,
+};
+enum {
+    kOperandTypeInput,
+    kOperandTypeOutput,
+    kOperandTypeLiteral,
+    kOperandTypeTemp,
+};
+
+static void
+addInstruction(nanoem_u32_t opcode, nanoem_u32_t numElements, const nanoem_u32_t (*operands)[2],
+    nanoem_u32_t numOperands, effect::Preshader &preshader)
+{
+    effect::Preshader::Instruction instruction;
+    instruction.m_opcode = opcode;
+    instruction.m_numElements = numElements;
+    for (nanoem_u32_t i = 0; i < numOperands; i++) {
+        effect::Preshader::Operand operand;
+        operand.m_type = operands[i][0];
+        operand.m_index = operands[i][1];
+        instruction.m_operands.push_back(operand);
+    }
+    preshader.m_instructions.push_back(instruction);
+}
+
+static void
+fillBuffer(std::mt19937 &engine, effect::GlobalUniform::Buffer &buffer)
+{
+    std::uniform_real_distribution<nanoem_f32_t> distribution(-4.0f, 4.0f);
+    for (size_t i = 0, numVectors = buffer.m_float4.size(); i < numVectors; i++) {
+        buffer.m_float4[i] = Vector4(
+            distribution(engine), distribution(engine), distribution(engine), distribution(engine));
+    }
+}
+
+/* same as Preshader::execute at the baseline, which is what the compiled preshaders must reproduce */
+static void
+executeBaselinePreshader(const effect::Preshader &preshader, const effect::GlobalUniform::Buffer &inputBuffer,
+    effect::GlobalUniform::Buffer &outputBuffer)
+{
+    /* padded as the baseline reads the last temporary registers as a vector */
+    tinystl::vector<nanoem_f32_t, TinySTLAllocator> temp(preshader.m_numTemporaryRegisters + 4);
+    for (size_t i = 0, numInstructions = preshader.m_instructions.size(); i < numInstructions; i++) {
+        const effect::Preshader::Instruction &instruction = preshader.m_instructions[i];
+        const size_t numOperands = glm::min(instruction.m_operands.size(), size_t(4));
+        const bool isScalarOp = instruction.m_opcode >= kOpcodeMinScalar;
+        Vector4 src[] = { Vector4(0), Vector4(0), Vector4(0), Vector4(0) }, dst(0);
+        nanoem_f32_t *outputPtr = nullptr;
+        for (size_t j = 0; j < numOperands; j++) {
+            const effect::Preshader::Operand &operand = instruction.m_operands[j];
+            const nanoem_u32_t scalarIndex = operand.m_index, vec4Index = scalarIndex / 4;
+            const bool isDestination = j == numOperands - 1;
+            switch (operand.m_type) {
+            case kOperandTypeInput: {
+                if (vec4Index < inputBuffer.m_float4.size()) {
+                    src[j] = inputBuffer.m_float4[vec4Index];
+                }
+                break;
+            }
+            case kOperandTypeLiteral: {
+                if (scalarIndex < preshader.m_literals.size()) {
+                    src[j] = Vector4(preshader.m_literals[scalarIndex]);
+                }
+                break;
+            }
+            case kOperandTypeOutput: {
+                if (vec4Index < outputBuffer.m_float4.size()) {
+                    src[j] = outputBuffer.m_float4[vec4Index];
+                    if (isDestination) {
+                        outputPtr = &outputBuffer.m_float4[vec4Index][scalarIndex % 4];
+                    }
+                }
+                break;
+            }
+            case kOperandTypeTemp: {
+                if (scalarIndex < preshader.m_numTemporaryRegisters) {
+                    src[j] = isScalarOp ? Vector4(temp[scalarIndex]) : glm::make_vec4(&temp[scalarIndex]);
+                    if (isDestination) {
+                        outputPtr = &temp[scalarIndex];
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        /* the baseline computes elementwise results but discards them, so only DOT writes values except zero */
+        if (!isScalarOp && instruction.m_opcode == kOpcodeDot) {
+            switch (instruction.m_numElements) {
+            case 4:
+                dst = Vector4(glm::dot(src[0], src[1]));
+                break;
+            case 3:
+                dst = Vector4(glm::dot(Vector3(src[0]), Vector3(src[1])));
+                break;
+            case 2:
+                dst = Vector4(glm::dot(Vector2(src[0]), Vector2(src[1])));
+                break;
+            case 1:
+                dst = Vector4(glm::dot(src[0].x, src[1].x));
+                break;
+            default:
+                break;
+            }
+        }
+        if (outputPtr) {
+            memcpy(outputPtr, glm::value_ptr(dst), instruction.m_numElements * sizeof(*outputPtr));
+        }
+    }
+}
+
+static bool
+equalsBuffer(const effect::GlobalUniform::Buffer &left, const effect::GlobalUniform::Buffer &right)
+{
+    return left.m_float4.size() == right.m_float4.size() &&
+        memcmp(left.m_float4.data(), right.m_float4.data(), left.m_float4.size() * sizeof(left.m_float4[0])) == 0;
+}
+
+static void
+compareWithBaseline(const effect::Preshader &source, effect::GlobalUniform::Buffer &input, std::mt19937 &engine)
+{
+    effect::Preshader compiled(source);
+    effect::GlobalUniform::Buffer expected(SG_SHADERSTAGE_VS), interpreted(SG_SHADERSTAGE_VS),
+        executed(SG_SHADERSTAGE_VS);
+    expected.m_float4.resize(32);
+    fillBuffer(engine, expected);
+    interpreted.m_float4 = executed.m_float4 = expected.m_float4;
+    compiled.compile();
+    executeBaselinePreshader(source, input, expected);
+    source.interpret(input, interpreted);
+    compiled.execute(input, executed);
+    CHECK(equalsBuffer(expected, interpreted));
+    CHECK(equalsBuffer(expected, executed));
+}
+
+static void
+createPreshader(effect::Preshader &preshader)
+{
+    const nanoem_u32_t mov[][2] = { { kOperandTypeInput, 4 }, { kOperandTypeTemp, 0 } },
+                       add[][2] = { { kOperandTypeTemp, 0 }, { kOperandTypeLiteral, 1 }, { kOperandTypeTemp, 4 } },
+                       mul[][2] = { { kOperandTypeTemp, 4 }, { kOperandTypeInput, 8 }, { kOperandTypeOutput, 0 } },
+                       dot[][2] = { { kOperandTypeInput, 0 }, { kOperandTypeOutput, 0 }, { kOperandTypeOutput, 4 } },
+                       rcp[][2] = { { kOperandTypeInput, 2 }, { kOperandTypeOutput, 9 } },
+                       cmp[][2] = { { kOperandTypeInput, 0 }, { kOperandTypeLiteral, 0 }, { kOperandTypeTemp, 4 },
+                           { kOperandTypeOutput, 12 } },
+                       minScalar[][2] = { { kOperandTypeTemp, 4 }, { kOperandTypeInput, 12 }, { kOperandTypeTemp, 8 } },
+                       sin[][2] = { { kOperandTypeTemp, 8 }, { kOperandTypeOutput, 16 } },
+                       frc[][2] = { { kOperandTypeInput, 13 }, { kOperandTypeOutput, 21 } },
+                       lt[][2] = { { kOperandTypeInput, 4 }, { kOperandTypeInput, 8 }, { kOperandTypeOutput, 24 } },
+                       div[][2] = { { kOperandTypeOutput, 24 }, { kOperandTypeLiteral, 2 },
+                           { kOperandTypeOutput, 28 } },
+                       dotInputs[][2] = { { kOperandTypeInput, 5 }, { kOperandTypeInput, 9 },
+                           { kOperandTypeOutput, 36 } },
+                       dotTemp[][2] = { { kOperandTypeInput, 0 }, { kOperandTypeInput, 12 }, { kOperandTypeTemp, 8 } },
+                       dotFromTemp[][2] = { { kOperandTypeTemp, 8 }, { kOperandTypeInput, 4 },
+                           { kOperandTypeOutput, 41 } },
+                       dotLiteral[][2] = { { kOperandTypeLiteral, 1 }, { kOperandTypeInput, 14 },
+                           { kOperandTypeOutput, 44 } },
+                       dotOutput[][2] = { { kOperandTypeOutput, 36 }, { kOperandTypeInput, 1 },
+                           { kOperandTypeOutput, 47 } };
+    preshader.m_numTemporaryRegisters = 12;
+    preshader.m_literals.push_back(0.5f);
+    preshader.m_literals.push_back(-1.5f);
+    preshader.m_literals.push_back(0.0f);
+    addInstruction(kOpcodeMov, 4, mov, BX_COUNTOF(mov), preshader);
+    addInstruction(kOpcodeAdd, 4, add, BX_COUNTOF(add), preshader);
+    addInstruction(kOpcodeMul, 4, mul, BX_COUNTOF(mul), preshader);
+    addInstruction(kOpcodeDot, 3, dot, BX_COUNTOF(dot), preshader);
+    addInstruction(kOpcodeRcp, 1, rcp, BX_COUNTOF(rcp), preshader);
+    addInstruction(kOpcodeCmp, 4, cmp, BX_COUNTOF(cmp), preshader);
+    addInstruction(kOpcodeMinScalar, 4, minScalar, BX_COUNTOF(minScalar), preshader);
+    addInstruction(kOpcodeSin, 4, sin, BX_COUNTOF(sin), preshader);
+    addInstruction(kOpcodeFrc, 2, frc, BX_COUNTOF(frc), preshader);
+    addInstruction(kOpcodeLt, 4, lt, BX_COUNTOF(lt), preshader);
+    addInstruction(kOpcodeDiv, 4, div, BX_COUNTOF(div), preshader);
+    /* only DOT produces values except zero at the baseline */
+    addInstruction(kOpcodeDot, 4, dotInputs, BX_COUNTOF(dotInputs), preshader);
+    addInstruction(kOpcodeDot, 3, dotTemp, BX_COUNTOF(dotTemp), preshader);
+    addInstruction(kOpcodeDot, 2, dotFromTemp, BX_COUNTOF(dotFromTemp), preshader);
+    addInstruction(kOpcodeDot, 4, dotLiteral, BX_COUNTOF(dotLiteral), preshader);
+    addInstruction(kOpcodeDot, 1, dotOutput, BX_COUNTOF(dotOutput), preshader);
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("effect_preshader_compiled_matches_baseline", "[emapp][effect]")
+{
+    std::mt19937 engine(42);
+    effect::Preshader preshader;
+    createPreshader(preshader);
+    effect::GlobalUniform::Buffer input(SG_SHADERSTAGE_VS);
+    input.m_float4.resize(4);
+    for (int i = 0; i < 16; i++) {
+        fillBuffer(engine, input);
+        compareWithBaseline(preshader, input, engine);
+    }
+}
+
+TEST_CASE("effect_preshader_memoize_results", "[emapp][effect]")
+{
+    std::mt19937 engine(7);
+    effect::Preshader preshader;
+    createPreshader(preshader);
+    preshader.compile();
+    effect::GlobalUniform::Buffer input(SG_SHADERSTAGE_VS), output(SG_SHADERSTAGE_VS);
+    input.m_float4.resize(8);
+    output.m_float4.resize(32);
+    fillBuffer(engine, input);
+    preshader.execute(input, output);
+    CHECK(preshader.m_numEvaluations == 1);
+    const effect::GlobalUniform::Vector4List expected(output.m_float4);
+    preshader.execute(input, output);
+    CHECK(preshader.m_numEvaluations == 1);
+    CHECK(memcmp(expected.data(), output.m_float4.data(), expected.size() * sizeof(expected[0])) == 0);
+    /* registers not read by the preshader */
+    input.m_float4[7] = Vector4(42);
+    preshader.execute(input, output);
+    CHECK(preshader.m_numEvaluations == 1);
+    /* outputs overwritten by the other pass must be restored without evaluation */
+    output.m_float4[0] = output.m_float4[4] = Vector4(0);
+    preshader.execute(input, output);
+    CHECK(preshader.m_numEvaluations == 1);
+    CHECK(memcmp(expected.data(), output.m_float4.data(), expected.size() * sizeof(expected[0])) == 0);
+    input.m_float4[2].x += 1.0f;
+    preshader.execute(input, output);
+    CHECK(preshader.m_numEvaluations == 2);
+    CHECK(memcmp(expected.data(), output.m_float4.data(), expected.size() * sizeof(expected[0])) != 0);
+}
+
+TEST_CASE("effect_preshader_fixtures", "[emapp][effect]")
+{
+    static const char *const kFixtures[] = {
+        "effects/preshader.fx",
+        "effects/parameters/application.fx",
+        "effects/parameters/builtin_variables.fx",
+    };
+    TestScope scope;
+    std::mt19937 engine(1);
+    for (size_t i = 0; i < BX_COUNTOF(kFixtures); i++) {
+        ProjectPtr o = scope.createProject();
+        Project *project = o.get()->m_project;
+        Model *model = o->createModel();
+        project->addModel(model);
+        Effect *effect = o->createSourceEffect(model, kFixtures[i], true);
+        Progress progress(project, 0);
+        Error error;
+        effect->upload(effect::kAttachmentTypeNone, progress, error);
+        nanoem_rsize_t numMaterials;
+        nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(model->data(), &numMaterials);
+        effect::Technique *technique = static_cast<effect::Technique *>(
+            effect->findTechnique(Effect::kPassTypeObject, materials[0], 0, numMaterials, model));
+        REQUIRE(technique);
+        effect::PassList passes;
+        technique->getAllPasses(passes);
+        effect::GlobalUniform *uniform = effect->globalUniform();
+        for (effect::PassList::const_iterator it = passes.begin(), end = passes.end(); it != end; ++it) {
+            const effect::PreshaderPair &pair = (*it)->preshaderPair();
+            for (int j = 0; j < 4; j++) {
+                fillBuffer(engine, uniform->m_preshaderVertexShaderBuffer);
+                fillBuffer(engine, uniform->m_preshaderPixelShaderBuffer);
+                compareWithBaseline(pair.vertex, uniform->m_preshaderVertexShaderBuffer, engine);
+                compareWithBaseline(pair.pixel, uniform->m_preshaderPixelShaderBuffer, engine);
+            }
+        }
+    }
+}
@@ -374,3 +374,18 @@ TEST_CASE("effect_parameters_builtin_variables", "[emapp][effect]")
         CHECK(extractFloat(uniformBuffer, "SubsetCount") == 1.0f);
     }
 }
+
+TEST_CASE("effect_parameters_non_semantic_variables", "[emapp][effect]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        Effect::NamedByteArrayMap uniformBuffer;
+        effectModelEffectPass("effects/parameters/non_semantic.fx", o, uniformBuffer);
+        CHECK(uniformBuffer.size() == 4);
+        CHECK(extractFloat(uniformBuffer, "enable_flag") == 1.0f);
+        CHECK(extractFloat(uniformBuffer, "iteration_count") == 3.0f);
+        CHECK(extractFloat(uniformBuffer, "strength") == 0.25f);
+        CHECK_THAT(extractVector4(uniformBuffer, "tint"), Equals(Vector4(0.1f, 0.2f, 0.3f, 0.4f)));
+    }
+}
@@ -0,0 +1,5 @@
+/* resolved only while the target drawables exist under these filenames */
+bool target_model_visible : CONTROLOBJECT < string name = "target.pmx"; >;
+bool target_accessory_visible : CONTROLOBJECT < string name = "target.x"; >;
+
+#include "../shaders.fx"
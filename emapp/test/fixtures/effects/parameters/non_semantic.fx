@@ -0,0 +1,7 @@
+/* non semantic */
+bool enable_flag = true;
+int iteration_count = 3;
+float strength = 0.25;
+float4 tint = float4(0.1, 0.2, 0.3, 0.4);
+
+#include "shaders.fx"
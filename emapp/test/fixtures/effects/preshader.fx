@@ -0,0 +1,26 @@
+/* expressions of uniforms only are lowered to preshaders */
+float4x4 world_view_projection : WORLDVIEWPROJECTION;
+float time : TIME;
+float scale = 2.0;
+float4 tint = float4(0.5, 0.25, 1.0, 1.0);
+
+float4
+MainVS(float4 position : POSITION) : POSITION
+{
+    float factor = sin(time * 3.0) * scale + 1.0 / scale;
+    return mul(position, world_view_projection) * factor;
+}
+
+float4
+MainPS() : COLOR
+{
+    float4 color = tint * max(scale, cos(time)) + frac(time * 0.5);
+    return color * rsqrt(dot(tint.xyz, tint.xyz) + 1.0);
+}
+
+technique T {
+    pass P {
+        VertexShader = compile vs_3_0 MainVS();
+        PixelShader  = compile ps_3_0 MainPS();
+    }
+}
@@ -0,0 +1,52 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/BezierCurve.h"
+
+using namespace nanoem;
+
+TEST_CASE("packed_bezier_curve_values", "[emapp][misc]")
+{
+    static const nanoem_u8_t kParameters[][4] = {
+        { 20, 20, 107, 107 },
+        { 0, 127, 127, 0 },
+        { 64, 0, 64, 127 },
+        { 127, 0, 0, 127 },
+        { 10, 90, 30, 100 },
+        { 100, 5, 120, 60 },
+    };
+    const nanoem_u8_t *parameters[BX_COUNTOF(kParameters)];
+    for (nanoem_rsize_t i = 0; i < BX_COUNTOF(kParameters); i++) {
+        parameters[i] = kParameters[i];
+    }
+    static const nanoem_frame_index_t kIntervals[] = { 1, 15, 16, 30, 120 };
+    for (nanoem_rsize_t i = 0; i < BX_COUNTOF(kIntervals); i++) {
+        const nanoem_frame_index_t interval = kIntervals[i];
+        /* bone keyframes have four curves and camera keyframes have six curves */
+        const PackedBezierCurve bone(parameters, 4, interval), camera(parameters, BX_COUNTOF(parameters), interval);
+        CHECK(bone.numCurves() == 4);
+        CHECK(camera.numCurves() == BX_COUNTOF(parameters));
+        CHECK(bone.isSame(parameters, interval));
+        CHECK_FALSE(bone.isSame(parameters, interval + 1));
+        for (int j = 0; j <= 100; j++) {
+            const nanoem_f32_t value = j / 100.0f;
+            nanoem_f32_t boneValues[4], cameraValues[BX_COUNTOF(parameters)];
+            bone.values(value, boneValues);
+            camera.values(value, cameraValues);
+            for (nanoem_rsize_t k = 0; k < BX_COUNTOF(parameters); k++) {
+                const nanoem_u8_t *p = parameters[k];
+                const BezierCurve curve(Vector2U8(p[0], p[1]), Vector2U8(p[2], p[3]), interval);
+                const nanoem_f32_t expected = curve.value(value);
+                CHECK(cameraValues[k] == Approx(expected));
+                if (k < 4) {
+                    CHECK(boneValues[k] == Approx(expected));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/internal/BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+struct BoxCuller : internal::BoundingVolumeHierarchy::ICuller {
+    BoxCuller(const Vector3 &boxMin, const Vector3 &boxMax)
+        : m_boxMin(boxMin)
+        , m_boxMax(boxMax)
+    {
+    }
+    bool
+    intersects(const Vector3 &aabbMin, const Vector3 &aabbMax) const noexcept override
+    {
+        return glm::all(glm::lessThanEqual(aabbMin, m_boxMax)) && glm::all(glm::lessThanEqual(m_boxMin, aabbMax));
+    }
+    bool
+    contains(const Vector3 &point) const noexcept
+    {
+        return intersects(point, point);
+    }
+    Vector3 m_boxMin;
+    Vector3 m_boxMax;
+};
+
+static void
+generateAllPoints(nanoem_rsize_t numPoints, std::mt19937 &engine, internal::BoundingVolumeHierarchy::PointList &points)
+{
+    std::uniform_real_distribution<nanoem_f32_t> distribution(-10.0f, 10.0f);
+    points.resize(numPoints);
+    for (nanoem_rsize_t i = 0; i < numPoints; i++) {
+        points[i] = Vector3(distribution(engine), distribution(engine), distribution(engine));
+    }
+}
+
+static std::vector<nanoem_u32_t>
+queryAllIndices(const internal::BoundingVolumeHierarchy &hierarchy, const BoxCuller &culler,
+    const internal::BoundingVolumeHierarchy::PointList &points)
+{
+    internal::BoundingVolumeHierarchy::IndexList indices;
+    hierarchy.query(&culler, indices);
+    std::vector<nanoem_u32_t> result;
+    for (auto index : indices) {
+        /* query returns candidates of intersected leaves so exact test is required */
+        if (culler.contains(points[index])) {
+            result.push_back(index);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+static std::vector<nanoem_u32_t>
+bruteForceAllIndices(const BoxCuller &culler, const internal::BoundingVolumeHierarchy::PointList &points)
+{
+    std::vector<nanoem_u32_t> result;
+    for (nanoem_u32_t i = 0, numPoints = nanoem_u32_t(points.size()); i < numPoints; i++) {
+        if (culler.contains(points[i])) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("boundingvolumehierarchy_empty", "[emapp][misc]")
+{
+    internal::BoundingVolumeHierarchy hierarchy;
+    internal::BoundingVolumeHierarchy::PointList points;
+    internal::BoundingVolumeHierarchy::IndexList indices;
+    const BoxCuller culler(Vector3(-1), Vector3(1));
+    hierarchy.build(points);
+    hierarchy.query(&culler, indices);
+    CHECK(hierarchy.numPoints() == 0);
+    CHECK(hierarchy.numNodes() == 0);
+    CHECK(indices.empty());
+}
+
+TEST_CASE("boundingvolumehierarchy_query_matches_brute_force", "[emapp][misc]")
+{
+    std::mt19937 engine(42);
+    internal::BoundingVolumeHierarchy hierarchy;
+    internal::BoundingVolumeHierarchy::PointList points;
+    generateAllPoints(5000, engine, points);
+    hierarchy.build(points);
+    CHECK(hierarchy.numPoints() == 5000);
+    CHECK(hierarchy.numNodes() > 1);
+    std::uniform_real_distribution<nanoem_f32_t> distribution(-12.0f, 12.0f);
+    for (int i = 0; i < 32; i++) {
+        const Vector3 a(distribution(engine), distribution(engine), distribution(engine)),
+            b(distribution(engine), distribution(engine), distribution(engine));
+        const BoxCuller culler(glm::min(a, b), glm::max(a, b));
+        CHECK(queryAllIndices(hierarchy, culler, points) == bruteForceAllIndices(culler, points));
+    }
+}
+
+TEST_CASE("boundingvolumehierarchy_refit_moved_points", "[emapp][misc]")
+{
+    std::mt19937 engine(7);
+    internal::BoundingVolumeHierarchy hierarchy;
+    internal::BoundingVolumeHierarchy::PointList points;
+    generateAllPoints(1000, engine, points);
+    hierarchy.build(points);
+    const nanoem_rsize_t numNodes = hierarchy.numNodes();
+    for (nanoem_rsize_t i = 0; i < points.size(); i += 3) {
+        points[i] += Vector3(25, 0, -25);
+    }
+    hierarchy.refit(points);
+    CHECK(hierarchy.numNodes() == numNodes);
+    const BoxCuller movedCuller(Vector3(15, -10, -35), Vector3(35, 10, -15));
+    CHECK(queryAllIndices(hierarchy, movedCuller, points) == bruteForceAllIndices(movedCuller, points));
+    CHECK(bruteForceAllIndices(movedCuller, points).size() == 334);
+    const BoxCuller originCuller(Vector3(-5), Vector3(5));
+    CHECK(queryAllIndices(hierarchy, originCuller, points) == bruteForceAllIndices(originCuller, points));
+}
+
+TEST_CASE("boundingvolumehierarchy_refit_rebuilds_when_number_of_points_changed", "[emapp][misc]")
+{
+    std::mt19937 engine(1);
+    internal::BoundingVolumeHierarchy hierarchy;
+    internal::BoundingVolumeHierarchy::PointList points;
+    generateAllPoints(100, engine, points);
+    hierarchy.build(points);
+    generateAllPoints(300, engine, points);
+    hierarchy.refit(points);
+    CHECK(hierarchy.numPoints() == 300);
+    const BoxCuller culler(Vector3(-10), Vector3(10));
+    CHECK(queryAllIndices(hierarchy, culler, points).size() == 300);
+}
+
+TEST_CASE("boundingvolumehierarchy_coincident_points", "[emapp][misc]")
+{
+    internal::BoundingVolumeHierarchy hierarchy;
+    internal::BoundingVolumeHierarchy::PointList points;
+    points.resize(100);
+    for (nanoem_rsize_t i = 0; i < points.size(); i++) {
+        points[i] = Vector3(1, 2, 3);
+    }
+    hierarchy.build(points);
+    CHECK(hierarchy.numPoints() == 100);
+    const BoxCuller hitCuller(Vector3(0), Vector3(5)), missCuller(Vector3(-5), Vector3(0));
+    CHECK(queryAllIndices(hierarchy, hitCuller, points).size() == 100);
+    CHECK(queryAllIndices(hierarchy, missCuller, points).empty());
+}
@@ -0,0 +1,252 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/internal/DrawCommandScheduler.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+struct RecordingExecutor : internal::DrawCommandScheduler::IExecutor {
+    bool
+    applyPipeline(sg_pipeline pipeline) override
+    {
+        m_pipelines.push_back(pipeline.id);
+        return pipeline.id != kInvalidPipelineID;
+    }
+    void
+    applyBindings(const sg_bindings & /* bindings */) override
+    {
+        m_numBindings++;
+    }
+    void
+    applyViewport(int /* x */, int /* y */, int /* width */, int /* height */) override
+    {
+        m_numViewports++;
+    }
+    void
+    applyScissorRect(int /* x */, int /* y */, int /* width */, int /* height */) override
+    {
+        m_numScissorRects++;
+    }
+    void
+    applyUniformBlock(sg_shader_stage /* stage */, const void * /* data */, nanoem_rsize_t /* size */) override
+    {
+        m_numUniformBlocks++;
+    }
+    void
+    draw(int offset, int /* count */) override
+    {
+        m_draws.push_back(offset);
+    }
+    void
+    invokeCallback(sg::PassBlock::Callback /* callback */, void * /* userData */) override
+    {
+        m_draws.push_back(-1);
+    }
+    static const nanoem_u32_t kInvalidPipelineID = 0xdeadbeef;
+    std::vector<nanoem_u32_t> m_pipelines;
+    std::vector<int> m_draws;
+    int m_numBindings = 0;
+    int m_numViewports = 0;
+    int m_numScissorRects = 0;
+    int m_numUniformBlocks = 0;
+};
+
+static const int kFirstPass = 1, kSecondPass = 2;
+
+static bool
+isPipelineValid(sg_pipeline pipeline)
+{
+    return pipeline.id % 2 == 0;
+}
+
+static void
+emptyCallback(sg_pass /* pass */, void * /* userData */)
+{
+}
+
+static void
+submitDraw(internal::DrawCommandScheduler &scheduler, nanoem_u32_t pipelineID, const nanoem_f32_t &uniform, int offset)
+{
+    sg_pipeline pipeline = { pipelineID };
+    sg_bindings bindings = {};
+    bindings.vertex_buffers[0].id = pipelineID;
+    scheduler.applyPipelineBindings(pipeline, bindings);
+    scheduler.applyUniformBlock(SG_SHADERSTAGE_VS, &uniform, sizeof(uniform));
+    scheduler.draw(offset, 3);
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("drawcommandscheduler_is_sortable", "[emapp][misc]")
+{
+    sg_pipeline_desc desc = {};
+    CHECK_FALSE(internal::DrawCommandScheduler::isSortable(desc));
+    desc.depth.write_enabled = true;
+    desc.depth.compare = SG_COMPAREFUNC_LESS_EQUAL;
+    CHECK(internal::DrawCommandScheduler::isSortable(desc));
+    desc.colors[0].blend.enabled = true;
+    CHECK_FALSE(internal::DrawCommandScheduler::isSortable(desc));
+    desc.colors[0].blend.enabled = false;
+    desc.stencil.enabled = true;
+    CHECK_FALSE(internal::DrawCommandScheduler::isSortable(desc));
+}
+
+TEST_CASE("drawcommandscheduler_skip_redundant_state_changes", "[emapp][misc]")
+{
+    internal::DrawCommandScheduler scheduler;
+    RecordingExecutor executor;
+    const nanoem_f32_t uniform = 1.0f;
+    scheduler.begin();
+    scheduler.applyViewport(0, 0, 640, 360);
+    submitDraw(scheduler, 1, uniform, 0);
+    submitDraw(scheduler, 1, uniform, 3);
+    submitDraw(scheduler, 1, uniform, 6);
+    scheduler.execute(&executor);
+    const internal::DrawCommandScheduler::Statistics &statistics = scheduler.statistics();
+    CHECK(executor.m_draws == std::vector<int>({ 0, 3, 6 }));
+    CHECK(executor.m_pipelines.size() == 1);
+    CHECK(executor.m_numBindings == 1);
+    CHECK(executor.m_numUniformBlocks == 1);
+    CHECK(executor.m_numViewports == 1);
+    CHECK(statistics.m_numDraws == 3);
+    CHECK(statistics.m_numPipelineChanges == 1);
+    CHECK(statistics.m_numBindingChanges == 1);
+    CHECK(statistics.m_numUniformBlockChanges == 1);
+    CHECK(statistics.m_numViewportChanges == 1);
+    CHECK(statistics.m_numSkippedStateChanges == 8);
+    CHECK(statistics.numStateChanges() == 4);
+}
+
+TEST_CASE("drawcommandscheduler_sort_sortable_draws", "[emapp][misc]")
+{
+    internal::DrawCommandScheduler scheduler;
+    RecordingExecutor executor;
+    const nanoem_f32_t uniform = 1.0f;
+    scheduler.setPipelineSortable(sg_pipeline { 1 }, &kFirstPass, true);
+    scheduler.setPipelineSortable(sg_pipeline { 2 }, &kFirstPass, true);
+    scheduler.begin();
+    submitDraw(scheduler, 2, uniform, 0);
+    submitDraw(scheduler, 1, uniform, 3);
+    submitDraw(scheduler, 2, uniform, 6);
+    submitDraw(scheduler, 1, uniform, 9);
+    scheduler.execute(&executor);
+    CHECK(executor.m_pipelines == std::vector<nanoem_u32_t>({ 1, 2 }));
+    CHECK(executor.m_draws == std::vector<int>({ 3, 9, 0, 6 }));
+    CHECK(scheduler.statistics().m_numPipelineChanges == 2);
+    CHECK(scheduler.statistics().m_numReorderedDraws == 4);
+}
+
+TEST_CASE("drawcommandscheduler_preserve_order_of_unsortable_draws", "[emapp][misc]")
+{
+    internal::DrawCommandScheduler scheduler;
+    RecordingExecutor executor;
+    const nanoem_f32_t uniform = 1.0f;
+    scheduler.setPipelineSortable(sg_pipeline { 1 }, &kFirstPass, true);
+    scheduler.begin();
+    submitDraw(scheduler, 2, uniform, 0);
+    submitDraw(scheduler, 1, uniform, 3);
+    submitDraw(scheduler, 2, uniform, 6);
+    submitDraw(scheduler, 1, uniform, 9);
+    scheduler.execute(&executor);
+    CHECK(executor.m_pipelines == std::vector<nanoem_u32_t>({ 2, 1, 2, 1 }));
+    CHECK(executor.m_draws == std::vector<int>({ 0, 3, 6, 9 }));
+    CHECK(scheduler.statistics().m_numReorderedDraws == 0);
+}
+
+TEST_CASE("drawcommandscheduler_never_sort_across_callback_and_viewport", "[emapp][misc]")
+{
+    internal::DrawCommandScheduler scheduler;
+    RecordingExecutor executor;
+    const nanoem_f32_t uniform = 1.0f;
+    scheduler.setPipelineSortable(sg_pipeline { 1 }, &kFirstPass, true);
+    scheduler.setPipelineSortable(sg_pipeline { 2 }, &kFirstPass, true);
+    scheduler.begin();
+    submitDraw(scheduler, 2, uniform, 0);
+    scheduler.registerCallback(emptyCallback, nullptr);
+    submitDraw(scheduler, 1, uniform, 3);
+    scheduler.applyViewport(0, 0, 320, 180);
+    submitDraw(scheduler, 2, uniform, 6);
+    submitDraw(scheduler, 1, uniform, 9);
+    scheduler.execute(&executor);
+    CHECK(executor.m_draws == std::vector<int>({ 0, -1, 3, 9, 6 }));
+    CHECK(executor.m_pipelines == std::vector<nanoem_u32_t>({ 2, 1, 2 }));
+}
+
+TEST_CASE("drawcommandscheduler_apply_changed_uniform_block", "[emapp][misc]")
+{
+    internal::DrawCommandScheduler scheduler;
+    RecordingExecutor executor;
+    const nanoem_f32_t uniforms[] = { 1.0f, 2.0f, 1.0f };
+    scheduler.begin();
+    submitDraw(scheduler, 1, uniforms[0], 0);
+    submitDraw(scheduler, 1, uniforms[1], 3);
+    submitDraw(scheduler, 1, uniforms[2], 6);
+    scheduler.execute(&executor);
+    CHECK(executor.m_numUniformBlocks == 3);
+    CHECK(executor.m_numBindings == 1);
+}
+
+TEST_CASE("drawcommandscheduler_skip_draw_without_pipeline", "[emapp][misc]")
+{
+    internal::DrawCommandScheduler scheduler;
+    RecordingExecutor executor;
+    const nanoem_f32_t uniform = 1.0f;
+    scheduler.begin();
+    scheduler.draw(0, 3);
+    submitDraw(scheduler, RecordingExecutor::kInvalidPipelineID, uniform, 3);
+    submitDraw(scheduler, 1, uniform, 6);
+    submitDraw(scheduler, 1, uniform, 6);
+    scheduler.execute(&executor);
+    CHECK(executor.m_draws == std::vector<int>({ 6 }));
+    CHECK(scheduler.statistics().m_numDraws == 1);
+    CHECK(scheduler.statistics().m_numSkippedDraws == 3);
+}
+
+TEST_CASE("drawcommandscheduler_never_sort_across_passes", "[emapp][misc]")
+{
+    internal::DrawCommandScheduler scheduler;
+    RecordingExecutor executor;
+    const nanoem_f32_t uniform = 1.0f;
+    /* both passes of a multi-pass technique draw the same material with LESS_EQUAL in turn */
+    scheduler.setPipelineSortable(sg_pipeline { 1 }, &kSecondPass, true);
+    scheduler.setPipelineSortable(sg_pipeline { 2 }, &kFirstPass, true);
+    scheduler.setPipelineSortable(sg_pipeline { 3 }, &kFirstPass, true);
+    scheduler.begin();
+    submitDraw(scheduler, 3, uniform, 0);
+    submitDraw(scheduler, 2, uniform, 3);
+    submitDraw(scheduler, 1, uniform, 0);
+    submitDraw(scheduler, 3, uniform, 6);
+    submitDraw(scheduler, 2, uniform, 9);
+    submitDraw(scheduler, 1, uniform, 6);
+    scheduler.execute(&executor);
+    CHECK(executor.m_draws == std::vector<int>({ 3, 0, 0, 9, 6, 6 }));
+    CHECK(executor.m_pipelines == std::vector<nanoem_u32_t>({ 2, 3, 1, 2, 3, 1 }));
+    CHECK(scheduler.statistics().m_numReorderedDraws == 4);
+}
+
+TEST_CASE("drawcommandscheduler_remove_all_invalid_pipelines", "[emapp][misc]")
+{
+    internal::DrawCommandScheduler scheduler;
+    for (nanoem_u32_t i = 1; i < 64; i++) {
+        scheduler.setPipelineSortable(sg_pipeline { i }, &kFirstPass, true);
+    }
+    /* pruning is deferred until enough pipelines are registered */
+    scheduler.removeAllInvalidPipelines(isPipelineValid);
+    CHECK(scheduler.isPipelineSortable(sg_pipeline { 1 }));
+    scheduler.setPipelineSortable(sg_pipeline { 64 }, &kFirstPass, true);
+    scheduler.removeAllInvalidPipelines(isPipelineValid);
+    CHECK_FALSE(scheduler.isPipelineSortable(sg_pipeline { 1 }));
+    CHECK_FALSE(scheduler.isPipelineSortable(sg_pipeline { 63 }));
+    CHECK(scheduler.isPipelineSortable(sg_pipeline { 2 }));
+    CHECK(scheduler.isPipelineSortable(sg_pipeline { 64 }));
+    scheduler.setPipelineSortable(sg_pipeline { 2 }, &kFirstPass, false);
+    CHECK_FALSE(scheduler.isPipelineSortable(sg_pipeline { 2 }));
+}
@@ -0,0 +1,85 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/FileUtils.h"
+#include "emapp/internal/FileContentDigestCache.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static const char kDigestTestPath[] = "test_digest.bin";
+
+static void
+writeFile(const URI &fileURI, nanoem_rsize_t size)
+{
+    ByteArray bytes(size);
+    for (nanoem_rsize_t i = 0; i < size; i++) {
+        bytes[i] = nanoem_u8_t(i * 31);
+    }
+    FileWriterScope scope;
+    Error error;
+    REQUIRE(scope.open(fileURI, error));
+    FileUtils::write(scope.writer(), bytes, error);
+    scope.commit(error);
+    REQUIRE_FALSE(error.hasReason());
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("filecontentdigestcache_hashes_only_changed_files", "[emapp][misc]")
+{
+    const URI fileURI(URI::createFromFilePath(kDigestTestPath));
+    internal::FileContentDigestCache cache(nullptr);
+    nanoem_u8_t first[internal::FileContentDigestCache::kDigestSize],
+        second[internal::FileContentDigestCache::kDigestSize];
+    Error error;
+    writeFile(fileURI, 100000);
+    CHECK(cache.digest(fileURI, first, error));
+    CHECK(cache.digest(fileURI, second, error));
+    CHECK(memcmp(first, second, sizeof(first)) == 0);
+    CHECK(cache.statistics().m_numHits == 1);
+    CHECK(cache.statistics().m_numMisses == 1);
+    CHECK(cache.statistics().m_numHashedBytes == 100000);
+    SECTION("resized file is hashed again")
+    {
+        writeFile(fileURI, 50000);
+        CHECK(cache.digest(fileURI, second, error));
+        CHECK(memcmp(first, second, sizeof(first)) != 0);
+        CHECK(cache.statistics().m_numMisses == 2);
+        CHECK(cache.statistics().m_numHashedBytes == 150000);
+    }
+    SECTION("digest of read content is same as streamed one")
+    {
+        ByteArray bytes;
+        cache.clear();
+        CHECK(cache.readAllBytes(fileURI, bytes, second, error));
+        CHECK(bytes.size() == 100000);
+        CHECK(memcmp(first, second, sizeof(first)) == 0);
+        CHECK(cache.digest(fileURI, second, error));
+        CHECK(cache.statistics().m_numHits == 1);
+    }
+    CHECK_FALSE(error.hasReason());
+    FileUtils::deleteFile(kDigestTestPath);
+}
+
+TEST_CASE("filecontentdigestcache_retained_content", "[emapp][misc]")
+{
+    const URI fileURI(URI::createFromFilePath(kDigestTestPath)),
+        otherFileURI(URI::createFromFilePath("test_digest_other.bin"));
+    internal::FileContentDigestCache cache(nullptr);
+    ByteArray bytes(16), taken;
+    cache.retainContent(fileURI, bytes);
+    CHECK(bytes.empty());
+    CHECK_FALSE(cache.takeContent(otherFileURI, taken));
+    CHECK(cache.takeContent(fileURI, taken));
+    CHECK(taken.size() == 16);
+    /* retained content can be taken only once */
+    CHECK_FALSE(cache.takeContent(fileURI, taken));
+}
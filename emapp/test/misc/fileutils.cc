@@ -58,3 +58,10 @@ TEST_CASE("fileutils_relative_path", "[emapp][misc]")
     CHECK(FileUtils::relativePath("D:/path/to/relative", "D:/base") == String("../path/to/relative"));
     CHECK(FileUtils::relativePath("D:/path/to/relative", "C:/base") == String());
 }
+
+TEST_CASE("fileutils_timestamp", "[emapp][misc]")
+{
+    /* the digest cache treats zero as unknown so the missing file must not leak an uninitialized value */
+    CHECK(FileUtils::timestamp("/path/to/nonexistent/file") == 0);
+    CHECK(FileUtils::timestamp(".") != 0);
+}
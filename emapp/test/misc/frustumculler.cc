@@ -0,0 +1,85 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/internal/FrustumCuller.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static BoundingBox
+makeBox(const Vector3 &center, nanoem_f32_t radius)
+{
+    BoundingBox box;
+    box.set(center - Vector3(radius), center + Vector3(radius));
+    return box;
+}
+
+static Matrix4x4
+makeViewProjection()
+{
+    const Matrix4x4 view(glm::lookAt(Vector3(0, 0, 10), Vector3(0), Vector3(0, 1, 0)));
+    const Matrix4x4 projection(glm::perspective(glm::radians(60.0f), 1.0f, 1.0f, 100.0f));
+    return projection * view;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("frustumculler_intersects", "[emapp][misc]")
+{
+    Vector4 planes[internal::FrustumCuller::kNumPlanes];
+    internal::FrustumCuller::extractAllPlanes(makeViewProjection(), planes);
+    CHECK(internal::FrustumCuller::intersects(planes, makeBox(Vector3(0), 1)));
+    /* behind the camera */
+    CHECK_FALSE(internal::FrustumCuller::intersects(planes, makeBox(Vector3(0, 0, 20), 1)));
+    /* beyond the far plane */
+    CHECK_FALSE(internal::FrustumCuller::intersects(planes, makeBox(Vector3(0, 0, -200), 1)));
+    /* outside of the left and the top planes */
+    CHECK_FALSE(internal::FrustumCuller::intersects(planes, makeBox(Vector3(-50, 0, 0), 1)));
+    CHECK_FALSE(internal::FrustumCuller::intersects(planes, makeBox(Vector3(0, 50, 0), 1)));
+    /* partially overlapped with the right plane */
+    CHECK(internal::FrustumCuller::intersects(planes, makeBox(Vector3(8, 0, 0), 3)));
+    /* empty box is never visible */
+    CHECK_FALSE(internal::FrustumCuller::intersects(planes, BoundingBox()));
+}
+
+TEST_CASE("frustumculler_counts_all_draws", "[emapp][misc]")
+{
+    internal::FrustumCuller culler;
+    const BoundingBox visible(makeBox(Vector3(0), 1)), invisible(makeBox(Vector3(0, 0, 20), 1));
+    /* nothing is culled until the frustum is set */
+    CHECK(culler.test(internal::FrustumCuller::kFrustumTypeCamera, invisible));
+    culler.setViewProjection(internal::FrustumCuller::kFrustumTypeCamera, makeViewProjection());
+    CHECK(culler.test(internal::FrustumCuller::kFrustumTypeCamera, visible));
+    CHECK_FALSE(culler.test(internal::FrustumCuller::kFrustumTypeCamera, invisible));
+    CHECK(culler.test(internal::FrustumCuller::kFrustumTypeShadowMap, invisible));
+    culler.submit();
+    CHECK(culler.statistics().m_numSubmittedDraws == 4);
+    CHECK(culler.statistics().m_numCulledDraws == 1);
+    culler.endFrame();
+    CHECK(culler.statistics().m_numSubmittedDraws == 0);
+    CHECK(culler.statistics().m_numCulledDraws == 0);
+    CHECK(culler.lastFrameStatistics().m_numSubmittedDraws == 4);
+    CHECK(culler.lastFrameStatistics().m_numCulledDraws == 1);
+}
+
+TEST_CASE("frustumculler_disabled_or_invalidated", "[emapp][misc]")
+{
+    internal::FrustumCuller culler;
+    const BoundingBox invisible(makeBox(Vector3(0, 0, 20), 1));
+    culler.setViewProjection(internal::FrustumCuller::kFrustumTypeCamera, makeViewProjection());
+    CHECK_FALSE(culler.isVisible(internal::FrustumCuller::kFrustumTypeCamera, invisible));
+    culler.setEnabled(false);
+    CHECK(culler.isVisible(internal::FrustumCuller::kFrustumTypeCamera, invisible));
+    culler.setEnabled(true);
+    culler.invalidate(internal::FrustumCuller::kFrustumTypeCamera);
+    CHECK(culler.isVisible(internal::FrustumCuller::kFrustumTypeCamera, invisible));
+}
@@ -31,6 +31,22 @@ loadAPNG(const char *filename, Error &error)
     return loaded && !error.hasReason();
 }
 
+/* the over blend of composing APNG frames before blending them with SIMD */
+static void
+blendPixelOverBaseline(const nanoem_u8_t *source, nanoem_u8_t *dest)
+{
+    const nanoem_u8_t a = source[3];
+    float alpha = a / 255.0f;
+    for (int i = 0; i < 3; i++) {
+        const nanoem_u8_t fg = alpha * source[i];
+        const nanoem_u8_t bg = (1.0f - alpha) * dest[i];
+        dest[i] = fg + bg;
+    }
+    if (dest[3] == 0) {
+        dest[3] = a;
+    }
+}
+
 } /* namespace anonymous */
 
 // based on https://philip.html5.org/tests/apng/tests.html
@@ -115,6 +131,102 @@ TEST_CASE("imageloader_apng", "[emapp][misc]")
     CHECK(loadAPNG(NANOEM_TEST_FIXTURE_PATH "/apngs/060.png", error));
 }
 
+TEST_CASE("imageloader_apng_composition_on_demand", "[emapp][misc]")
+{
+    Error error;
+    FileReaderScope scope(nullptr);
+    REQUIRE(scope.open(URI::createFromFilePath(NANOEM_TEST_FIXTURE_PATH "/apngs/021.png"), error));
+    image::APNG *apng = ImageLoader::decodeAPNG(scope.reader(), error);
+    REQUIRE(apng);
+    const nanoem_rsize_t numFrames = apng->numFrames();
+    REQUIRE(numFrames > 8);
+    ByteArrayList compositions;
+    for (nanoem_rsize_t i = 0; i < numFrames; i++) {
+        const ByteArray *composition = apng->compositedFrameImage(i);
+        REQUIRE(composition);
+        CHECK(composition->size() == nanoem_rsize_t(4) * apng->width() * apng->height());
+        compositions.push_back(*composition);
+    }
+    /* only a bounded number of compositions are retained as seek points */
+    CHECK(apng->numKeyframeCompositions() <= 9);
+    CHECK_FALSE(apng->compositedFrameImage(numFrames));
+    /* seeking backward must compose the same image as sequential playback */
+    for (nanoem_rsize_t i = 0; i < numFrames; i += 3) {
+        const nanoem_rsize_t offset = numFrames - i - 1;
+        const ByteArray *composition = apng->compositedFrameImage(offset);
+        CHECK(memcmp(composition->data(), compositions[offset].data(), composition->size()) == 0);
+    }
+    CHECK(apng->findNearestOffset(0) == 0);
+    nanoem_rsize_t lastOffset = 0;
+    for (int i = 0; i < 100; i++) {
+        const nanoem_rsize_t offset = apng->findNearestOffset(i * 0.01f);
+        CHECK(offset >= lastOffset);
+        CHECK(offset < numFrames);
+        lastOffset = offset;
+    }
+    nanoem_delete(apng);
+}
+
+TEST_CASE("imageloader_apng_inflated_frames_match_stb", "[emapp][misc]")
+{
+    for (int i = 0; i <= 60; i++) {
+        String filename;
+        StringUtils::format(filename, NANOEM_TEST_FIXTURE_PATH "/apngs/%03d.png", i);
+        Error error;
+        FileReaderScope scope(nullptr), scope2(nullptr);
+        REQUIRE(scope.open(URI::createFromFilePath(filename), error));
+        REQUIRE(scope2.open(URI::createFromFilePath(filename), error));
+        image::APNG *inflated = ImageLoader::decodeAPNG(scope.reader(), error);
+        image::APNG *decoded = ImageLoader::decodeAPNG(scope2.reader(), error);
+        if (inflated && decoded) {
+            INFO(filename.c_str());
+            CHECK(inflated->isFrameInflationEnabled());
+            decoded->setFrameInflationEnabled(false);
+            decoded->composite(error);
+            REQUIRE(inflated->numFrames() == decoded->numFrames());
+            for (nanoem_rsize_t j = 0, numFrames = inflated->numFrames(); j < numFrames; j++) {
+                const ByteArray *expected = decoded->compositedFrameImage(j),
+                                *actual = inflated->compositedFrameImage(j);
+                REQUIRE(expected);
+                REQUIRE(actual);
+                REQUIRE(actual->size() == expected->size());
+                CHECK(memcmp(actual->data(), expected->data(), actual->size()) == 0);
+            }
+        }
+        nanoem_delete_safe(inflated);
+        nanoem_delete_safe(decoded);
+    }
+}
+
+TEST_CASE("imageloader_apng_blend_pixels_over_simd_match_scalar", "[emapp][misc]")
+{
+    /* every alpha meets every foreground and background, and the odd count leaves pixels to the scalar path */
+    static const nanoem_rsize_t kNumPixels = 256 * 256 + 3;
+    ByteArray source(kNumPixels * 4), expected(kNumPixels * 4);
+    for (nanoem_rsize_t i = 0; i < kNumPixels; i++) {
+        nanoem_u8_t *sourcePixel = &source[i * 4], *destPixel = &expected[i * 4];
+        sourcePixel[0] = nanoem_u8_t(i);
+        sourcePixel[1] = nanoem_u8_t(i * 7);
+        sourcePixel[2] = nanoem_u8_t(0xff - i);
+        sourcePixel[3] = nanoem_u8_t(i >> 8);
+        destPixel[0] = nanoem_u8_t(i >> 8);
+        destPixel[1] = nanoem_u8_t(i * 13);
+        destPixel[2] = nanoem_u8_t(i);
+        destPixel[3] = i % 3 ? 0 : nanoem_u8_t(i);
+    }
+    ByteArray scalar(expected), simd(expected), unaligned(kNumPixels * 4 + 1);
+    memcpy(unaligned.data() + 1, expected.data(), expected.size());
+    for (nanoem_rsize_t i = 0; i < kNumPixels; i++) {
+        blendPixelOverBaseline(&source[i * 4], &expected[i * 4]);
+    }
+    image::APNG::blendPixelsOver(source.data(), scalar.data(), kNumPixels, false);
+    image::APNG::blendPixelsOver(source.data(), simd.data(), kNumPixels, true);
+    image::APNG::blendPixelsOver(source.data(), unaligned.data() + 1, kNumPixels, true);
+    CHECK(memcmp(scalar.data(), expected.data(), expected.size()) == 0);
+    CHECK(memcmp(simd.data(), expected.data(), expected.size()) == 0);
+    CHECK(memcmp(unaligned.data() + 1, expected.data(), expected.size()) == 0);
+}
+
 #if defined(NANOEM_TEST_DXTEXMEDIA_PATH)
 
 namespace {
@@ -0,0 +1,301 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/BaseAudioPlayer.h"
+#include "emapp/FileUtils.h"
+#include "emapp/internal/LinearPCMStream.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static void
+appendChunk(nanoem_u32_t id, const void *data, nanoem_u32_t size, nanoem_u32_t declaredSize, ByteArray &bytes)
+{
+    const IAudioPlayer::Chunk chunk = { id, declaredSize };
+    const nanoem_u8_t *chunkPtr = reinterpret_cast<const nanoem_u8_t *>(&chunk),
+                      *dataPtr = static_cast<const nanoem_u8_t *>(data);
+    bytes.insert(bytes.end(), chunkPtr, chunkPtr + sizeof(chunk));
+    bytes.insert(bytes.end(), dataPtr, dataPtr + size);
+    if (size & 1) {
+        bytes.push_back(0);
+    }
+}
+
+static void
+createWAV(const ByteArray &samples, nanoem_u32_t declaredSize, nanoem_u16_t channels, nanoem_u32_t sampleRate,
+    ByteArray &bytes)
+{
+    IAudioPlayer::WAVDescription desc;
+    BaseAudioPlayer::initializeDescription(16, channels, sampleRate, samples.size(), desc);
+    const char kInfo[] = "odd";
+    bytes.clear();
+    bytes.insert(bytes.end(), reinterpret_cast<const nanoem_u8_t *>(&desc.m_header),
+        reinterpret_cast<const nanoem_u8_t *>(&desc.m_header) + sizeof(desc.m_header));
+    /* odd sized chunk before the format chunk to test padding */
+    appendChunk(nanoem_fourcc('L', 'I', 'S', 'T'), kInfo, sizeof(kInfo), sizeof(kInfo), bytes);
+    appendChunk(desc.m_formatChunk.m_id, &desc.m_formatData, sizeof(desc.m_formatData), sizeof(desc.m_formatData),
+        bytes);
+    appendChunk(nanoem_fourcc('d', 'a', 't', 'a'), samples.data(), static_cast<nanoem_u32_t>(samples.size()),
+        declaredSize, bytes);
+}
+
+static void
+generateSamples(nanoem_rsize_t numFrames, nanoem_u16_t channels, ByteArray &samples)
+{
+    samples.resize(numFrames * channels * sizeof(nanoem_u16_t));
+    nanoem_u16_t *ptr = reinterpret_cast<nanoem_u16_t *>(samples.data());
+    for (nanoem_rsize_t i = 0, numSamples = numFrames * channels; i < numSamples; i++) {
+        ptr[i] = nanoem_u16_t(i * 7919);
+    }
+}
+
+static bool
+readFrames(internal::LinearPCMStream &stream, nanoem_u64_t frameOffset, nanoem_rsize_t numFrames,
+    const ByteArray &samples)
+{
+    Error error;
+    ByteArray actual;
+    actual.resize(numFrames * stream.bytesPerFrame());
+    stream.seek(frameOffset);
+    const nanoem_rsize_t numReadFrames = stream.read(actual.data(), numFrames, error);
+    return !error.hasReason() && numReadFrames == numFrames &&
+        memcmp(actual.data(), samples.data() + frameOffset * stream.bytesPerFrame(), actual.size()) == 0;
+}
+
+class RecordingAudioPlayer : public BaseAudioPlayer {
+public:
+    RecordingAudioPlayer()
+        : m_loadedData(nullptr)
+    {
+    }
+    bool
+    initialize(nanoem_frame_index_t /* duration */, nanoem_u32_t /* sampleRate */, Error & /* error */) override
+    {
+        return true;
+    }
+    void
+    expandDuration(nanoem_frame_index_t /* frameIndex */) override
+    {
+    }
+    void
+    destroy() override
+    {
+    }
+    bool
+    loadAllLinearPCMSamples(const nanoem_u8_t *data, size_t size, Error & /* error */) override
+    {
+        m_loadedData = data;
+        assignLinearPCMSamples(data, size);
+        m_loadedDescription = m_description;
+        return true;
+    }
+    void
+    playPart(nanoem_f64_t /* start */, nanoem_f64_t /* length */) override
+    {
+    }
+    void
+    update() override
+    {
+    }
+    void
+    seek(const Rational & /* value */) override
+    {
+    }
+    void
+    internalSetVolumeGain(nanoem_f32_t /* value */, Error & /* error */) override
+    {
+    }
+    void
+    internalTransitStateStarted(Error & /* error */) override
+    {
+    }
+    void
+    internalTransitStatePaused(Error & /* error */) override
+    {
+    }
+    void
+    internalTransitStateResumed(Error & /* error */) override
+    {
+    }
+    void
+    internalTransitStateStopped(Error & /* error */) override
+    {
+    }
+    WAVDescription m_loadedDescription;
+    const nanoem_u8_t *m_loadedData;
+};
+
+} /* namespace anonymous */
+
+TEST_CASE("linearpcmstream_open_and_read", "[emapp][misc]")
+{
+    ByteArray samples, bytes;
+    generateSamples(1000, 2, samples);
+    createWAV(samples, static_cast<nanoem_u32_t>(samples.size()), 2, 48000, bytes);
+    MemoryReader reader(&bytes);
+    internal::LinearPCMStream stream(&reader, 7);
+    Error error;
+    CHECK(stream.open(error));
+    CHECK_FALSE(error.hasReason());
+    CHECK(stream.format().m_numChannels == 2);
+    CHECK(stream.format().m_sampleRate == 48000);
+    CHECK(stream.format().m_bitsPerSample == 16);
+    CHECK(stream.bytesPerFrame() == 4);
+    CHECK(stream.numFrames() == 1000);
+    CHECK(stream.durationRational().m_numerator == 1000);
+    CHECK(stream.durationRational().m_denominator == 48000);
+    CHECK(readFrames(stream, 0, 3, samples));
+    CHECK(readFrames(stream, 5, 20, samples));
+    CHECK(readFrames(stream, 990, 10, samples));
+    CHECK(readFrames(stream, 123, 1, samples));
+    CHECK(stream.currentFrame() == 124);
+    ByteArray all;
+    CHECK(stream.readAll(all, error));
+    CHECK(all.size() == samples.size());
+    CHECK(memcmp(all.data(), samples.data(), samples.size()) == 0);
+}
+
+TEST_CASE("linearpcmstream_lookahead_window", "[emapp][misc]")
+{
+    ByteArray samples, bytes;
+    generateSamples(100, 1, samples);
+    createWAV(samples, static_cast<nanoem_u32_t>(samples.size()), 1, 44100, bytes);
+    MemoryReader reader(&bytes);
+    internal::LinearPCMStream stream(&reader, 16);
+    Error error;
+    CHECK(stream.open(error));
+    CHECK(readFrames(stream, 0, 4, samples));
+    CHECK(readFrames(stream, 4, 12, samples));
+    CHECK(stream.numWindowReads() == 1);
+    CHECK(readFrames(stream, 16, 1, samples));
+    CHECK(stream.numWindowReads() == 2);
+    /* backward seek outside of the window refills it */
+    CHECK(readFrames(stream, 2, 2, samples));
+    CHECK(stream.numWindowReads() == 3);
+    nanoem_u8_t data[16];
+    stream.seek(99);
+    CHECK(stream.read(data, 8, error) == 1);
+    CHECK(stream.read(data, 8, error) == 0);
+    CHECK_FALSE(error.hasReason());
+}
+
+TEST_CASE("linearpcmstream_seek", "[emapp][misc]")
+{
+    ByteArray samples, bytes;
+    generateSamples(4800, 1, samples);
+    createWAV(samples, static_cast<nanoem_u32_t>(samples.size()), 1, 48000, bytes);
+    MemoryReader reader(&bytes);
+    internal::LinearPCMStream stream(&reader);
+    Error error;
+    CHECK(stream.open(error));
+    IAudioPlayer::Rational rational = { 1, 30 };
+    CHECK(internal::LinearPCMStream::toFrameOffset(rational, 48000) == 1600);
+    CHECK(stream.seek(rational));
+    CHECK(stream.currentFrame() == 1600);
+    rational.m_numerator = 1001;
+    rational.m_denominator = 30000;
+    CHECK(internal::LinearPCMStream::toFrameOffset(rational, 48000) == 1601);
+    rational.m_numerator = 3003;
+    CHECK(internal::LinearPCMStream::toFrameOffset(rational, 48000) == 4804);
+    CHECK_FALSE(stream.seek(rational));
+    CHECK(stream.currentFrame() == 4800);
+    CHECK(stream.seek(nanoem_u64_t(4800)));
+    CHECK_FALSE(stream.seek(nanoem_u64_t(4801)));
+    CHECK(stream.currentFrame() == 4800);
+}
+
+TEST_CASE("linearpcmstream_truncated_payload", "[emapp][misc]")
+{
+    ByteArray samples, bytes;
+    generateSamples(100, 2, samples);
+    /* data chunk declares more than the actual payload */
+    createWAV(samples, static_cast<nanoem_u32_t>(samples.size() + 32), 2, 44100, bytes);
+    MemoryReader reader(&bytes);
+    internal::LinearPCMStream stream(&reader);
+    Error error;
+    CHECK(stream.open(error));
+    CHECK(stream.numFrames() == 100);
+    ByteArray all;
+    CHECK(stream.readAll(all, error));
+    CHECK(all.size() == samples.size());
+    CHECK(memcmp(all.data(), samples.data(), samples.size()) == 0);
+}
+
+TEST_CASE("linearpcmstream_invalid", "[emapp][misc]")
+{
+    ByteArray samples, bytes;
+    generateSamples(100, 2, samples);
+    SECTION("invalid header")
+    {
+        bytes.assign(64, 0);
+        MemoryReader reader(&bytes);
+        internal::LinearPCMStream stream(&reader);
+        Error error;
+        CHECK_FALSE(stream.open(error));
+        CHECK(error.hasReason());
+    }
+    SECTION("no data chunk")
+    {
+        createWAV(samples, static_cast<nanoem_u32_t>(samples.size()), 2, 44100, bytes);
+        bytes.resize(sizeof(IAudioPlayer::WAVHeader));
+        MemoryReader reader(&bytes);
+        internal::LinearPCMStream stream(&reader);
+        Error error;
+        CHECK_FALSE(stream.open(error));
+        CHECK(error.hasReason());
+    }
+}
+
+TEST_CASE("linearpcmstream_audio_player_load", "[emapp][misc]")
+{
+    ByteArray samples, bytes;
+    generateSamples(1000, 2, samples);
+    createWAV(samples, static_cast<nanoem_u32_t>(samples.size()), 2, 44100, bytes);
+    /* trailing chunk keeps bytes after the payload in the buffer that load(const ByteArray &) passes */
+    const char kTrailer[] = "trailing chunk";
+    appendChunk(nanoem_fourcc('L', 'I', 'S', 'T'), kTrailer, sizeof(kTrailer), sizeof(kTrailer), bytes);
+    RecordingAudioPlayer bytesPlayer, streamPlayer;
+    Error error;
+    CHECK(bytesPlayer.load(bytes, error));
+    MemoryReader reader(&bytes);
+    CHECK(streamPlayer.load(&reader, error));
+    CHECK_FALSE(error.hasReason());
+    const ByteArray *expected = bytesPlayer.linearPCMSamples(), *actual = streamPlayer.linearPCMSamples();
+    CHECK(actual->size() == samples.size() + sizeof(IAudioPlayer::WAVHeader));
+    CHECK(actual->size() == expected->size());
+    CHECK(memcmp(actual->data(), samples.data(), samples.size()) == 0);
+    CHECK(memcmp(&streamPlayer.m_loadedDescription, &bytesPlayer.m_loadedDescription,
+              sizeof(IAudioPlayer::WAVDescription)) == 0);
+}
+
+TEST_CASE("linearpcmstream_audio_player_load_in_chunks", "[emapp][misc]")
+{
+    /* longer than the chunk the player is fed from the stream at once */
+    ByteArray samples, bytes;
+    generateSamples(0x10000 * 3 + 123, 2, samples);
+    createWAV(samples, static_cast<nanoem_u32_t>(samples.size()), 2, 48000, bytes);
+    RecordingAudioPlayer player;
+    Error error;
+    MemoryReader reader(&bytes);
+    CHECK(player.load(&reader, error));
+    CHECK_FALSE(error.hasReason());
+    const ByteArray *actual = player.linearPCMSamples();
+    CHECK(actual->size() == samples.size() + sizeof(IAudioPlayer::WAVHeader));
+    CHECK(memcmp(actual->data(), samples.data(), samples.size()) == 0);
+    /* the streamed buffer is taken over by the player instead of being copied */
+    CHECK(player.m_loadedData == actual->data());
+    /* loading again releases the previous samples and keeps the new ones */
+    generateSamples(1000, 2, samples);
+    createWAV(samples, static_cast<nanoem_u32_t>(samples.size()), 2, 48000, bytes);
+    MemoryReader reader2(&bytes);
+    CHECK(player.load(&reader2, error));
+    CHECK(actual->size() == samples.size() + sizeof(IAudioPlayer::WAVHeader));
+    CHECK(memcmp(actual->data(), samples.data(), samples.size()) == 0);
+}
@@ -0,0 +1,240 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Model.h"
+#include "emapp/PhysicsEngine.h"
+#include "nanoem/ext/mutable.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static const nanoem_rsize_t kNumMotionStates = 3;
+static const nanoem_rsize_t kNullMotionStateIndex = 1;
+static const nanoem_f32_t kSentinelValue = 42.0f;
+
+static void
+checkTransform(const Matrix4x4 &actual, const Matrix4x4 &expected)
+{
+    for (int i = 0; i < 4; i++) {
+        CHECK_THAT(actual[i], Equals(expected[i]));
+    }
+}
+
+static Matrix4x4
+createTranslation(const Vector3 &value)
+{
+    Matrix4x4 transform(1);
+    transform[3] = Vector4(value, 1);
+    return transform;
+}
+
+static void
+fillAllTransforms(Matrix4x4 *values, nanoem_rsize_t numValues)
+{
+    for (nanoem_rsize_t i = 0; i < numValues; i++) {
+        values[i] = Matrix4x4(kSentinelValue);
+    }
+}
+
+static void
+fillAllVertices(Vector4 *values, nanoem_rsize_t numValues)
+{
+    for (nanoem_rsize_t i = 0; i < numValues; i++) {
+        values[i] = Vector4(kSentinelValue);
+    }
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("physicsengine_bulk_motion_state_transforms_match_per_object", "[emapp][misc]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        PhysicsEngine *engine = o->m_project->physicsEngine();
+        Model *model = o->createSkinnedModel();
+        REQUIRE(model);
+        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+        nanoem_mutable_model_rigid_body_t *mutableRigidBodies[kNumMotionStates];
+        nanoem_physics_rigid_body_t *rigidBodies[kNumMotionStates];
+        nanoem_physics_motion_state_t *states[kNumMotionStates];
+        for (nanoem_rsize_t i = 0; i < kNumMotionStates; i++) {
+            nanoem_mutable_model_rigid_body_t *mutableRigidBody =
+                nanoemMutableModelRigidBodyCreate(model->data(), &status);
+            const nanoem_f32_t offset = nanoem_f32_t(i);
+            const Vector4 origin(offset, offset * 2, offset * 3, 1);
+            nanoemMutableModelRigidBodySetOrigin(mutableRigidBody, glm::value_ptr(origin));
+            nanoemMutableModelRigidBodySetShapeSize(mutableRigidBody, glm::value_ptr(Vector4(1, 1, 1, 0)));
+            nanoemMutableModelRigidBodySetShapeType(mutableRigidBody, NANOEM_MODEL_RIGID_BODY_SHAPE_TYPE_SPHERE);
+            nanoemMutableModelRigidBodySetMass(mutableRigidBody, 1.0f);
+            mutableRigidBodies[i] = mutableRigidBody;
+            const nanoem_model_rigid_body_t *rigidBody = nanoemMutableModelRigidBodyGetOriginObject(mutableRigidBody);
+            rigidBodies[i] = engine->createRigidBody(rigidBody, status);
+            states[i] = engine->motionState(rigidBodies[i]);
+        }
+        /* a rigid body may have no motion state and both paths must skip it */
+        states[kNullMotionStateIndex] = nullptr;
+        Matrix4x4 bulkValues[kNumMotionStates], singleValues[kNumMotionStates];
+        SECTION("initial transforms")
+        {
+            fillAllTransforms(bulkValues, kNumMotionStates);
+            fillAllTransforms(singleValues, kNumMotionStates);
+            engine->getAllInitialTransforms(states, kNumMotionStates, glm::value_ptr(bulkValues[0]));
+            for (nanoem_rsize_t i = 0; i < kNumMotionStates; i++) {
+                engine->getInitialTransform(states[i], glm::value_ptr(singleValues[i]));
+                checkTransform(bulkValues[i], singleValues[i]);
+            }
+            checkTransform(bulkValues[kNullMotionStateIndex], Matrix4x4(kSentinelValue));
+            if (engine->isAvailable()) {
+                CHECK_THAT(Vector3(bulkValues[2][3]), Equals(Vector3(2, 4, 6)));
+            }
+        }
+        SECTION("set all transforms and get each transform")
+        {
+            for (nanoem_rsize_t i = 0; i < kNumMotionStates; i++) {
+                bulkValues[i] = createTranslation(Vector3(nanoem_f32_t(i + 1), 0, 0));
+            }
+            engine->setAllWorldTransforms(states, kNumMotionStates, glm::value_ptr(bulkValues[0]));
+            fillAllTransforms(singleValues, kNumMotionStates);
+            for (nanoem_rsize_t i = 0; i < kNumMotionStates; i++) {
+                engine->getWorldTransform(states[i], glm::value_ptr(singleValues[i]));
+            }
+            checkTransform(singleValues[kNullMotionStateIndex], Matrix4x4(kSentinelValue));
+            if (engine->isAvailable()) {
+                checkTransform(singleValues[0], bulkValues[0]);
+                checkTransform(singleValues[2], bulkValues[2]);
+            }
+            else {
+                /* every call is no-op while the physics world is unavailable */
+                for (nanoem_rsize_t i = 0; i < kNumMotionStates; i++) {
+                    checkTransform(singleValues[i], Matrix4x4(kSentinelValue));
+                }
+            }
+        }
+        SECTION("set each transform and get all transforms")
+        {
+            for (nanoem_rsize_t i = 0; i < kNumMotionStates; i++) {
+                singleValues[i] = createTranslation(Vector3(0, nanoem_f32_t(i + 1), 0));
+                engine->setWorldTransform(states[i], glm::value_ptr(singleValues[i]));
+            }
+            fillAllTransforms(bulkValues, kNumMotionStates);
+            engine->getAllWorldTransforms(states, kNumMotionStates, glm::value_ptr(bulkValues[0]));
+            checkTransform(bulkValues[kNullMotionStateIndex], Matrix4x4(kSentinelValue));
+            if (engine->isAvailable()) {
+                checkTransform(bulkValues[0], singleValues[0]);
+                checkTransform(bulkValues[2], singleValues[2]);
+            }
+            else {
+                for (nanoem_rsize_t i = 0; i < kNumMotionStates; i++) {
+                    checkTransform(bulkValues[i], Matrix4x4(kSentinelValue));
+                }
+            }
+        }
+        for (nanoem_rsize_t i = 0; i < kNumMotionStates; i++) {
+            engine->destroyRigidBody(rigidBodies[i]);
+            nanoemMutableModelRigidBodyDestroy(mutableRigidBodies[i]);
+        }
+    }
+}
+
+TEST_CASE("physicsengine_bulk_soft_body_vertices_match_per_object", "[emapp][misc]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        PhysicsEngine *engine = o->m_project->physicsEngine();
+        Model *model = o->createSkinnedModel();
+        REQUIRE(model);
+        nanoem_rsize_t numMaterials, numVertices;
+        nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(model->data(), &numMaterials);
+        nanoemModelGetAllVertexObjects(model->data(), &numVertices);
+        REQUIRE(numMaterials == 1);
+        REQUIRE(numVertices == 4);
+        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+        nanoem_mutable_model_soft_body_t *mutableSoftBody = nanoemMutableModelSoftBodyCreate(model->data(), &status);
+        nanoemMutableModelSoftBodySetMaterialObject(mutableSoftBody, materials[0]);
+        nanoemMutableModelSoftBodySetShapeType(mutableSoftBody, NANOEM_MODEL_SOFT_BODY_SHAPE_TYPE_TRI_MESH);
+        nanoemMutableModelSoftBodySetTotalMass(mutableSoftBody, 1.0f);
+        nanoem_physics_soft_body_t *softBody =
+            engine->createSoftBody(nanoemMutableModelSoftBodyGetOriginObject(mutableSoftBody), status);
+        const int numSoftBodyVertices = engine->numSoftBodyVertices(softBody);
+        if (engine->isAvailable()) {
+            /* all four vertices of the material are distinct soft body nodes */
+            CHECK(numSoftBodyVertices == 4);
+        }
+        else {
+            CHECK(numSoftBodyVertices == 0);
+        }
+        Vector4 bulkValues[4], singleValues[4];
+        SECTION("positions")
+        {
+            fillAllVertices(bulkValues, BX_COUNTOF(bulkValues));
+            fillAllVertices(singleValues, BX_COUNTOF(singleValues));
+            engine->getAllSoftBodyVertexPositions(softBody, glm::value_ptr(bulkValues[0]));
+            for (int i = 0; i < numSoftBodyVertices; i++) {
+                engine->getSoftBodyVertexPosition(softBody, i, glm::value_ptr(singleValues[i]));
+            }
+            for (nanoem_rsize_t i = 0; i < BX_COUNTOF(bulkValues); i++) {
+                CHECK_THAT(bulkValues[i], Equals(singleValues[i]));
+            }
+        }
+        SECTION("normals")
+        {
+            fillAllVertices(bulkValues, BX_COUNTOF(bulkValues));
+            fillAllVertices(singleValues, BX_COUNTOF(singleValues));
+            engine->getAllSoftBodyVertexNormals(softBody, glm::value_ptr(bulkValues[0]));
+            for (int i = 0; i < numSoftBodyVertices; i++) {
+                engine->getSoftBodyVertexNormal(softBody, i, glm::value_ptr(singleValues[i]));
+            }
+            for (nanoem_rsize_t i = 0; i < BX_COUNTOF(bulkValues); i++) {
+                CHECK_THAT(bulkValues[i], Equals(singleValues[i]));
+            }
+        }
+        SECTION("set positions of the given offsets")
+        {
+            static const int kOffsets[] = { 3, 1 };
+            fillAllVertices(singleValues, BX_COUNTOF(singleValues));
+            engine->getAllSoftBodyVertexPositions(softBody, glm::value_ptr(singleValues[0]));
+            const Vector4 values[] = { Vector4(7, 8, 9, 0), Vector4(-1, -2, -3, 0) };
+            engine->setAllSoftBodyVertexPositions(softBody, kOffsets, BX_COUNTOF(kOffsets), glm::value_ptr(values[0]));
+            fillAllVertices(bulkValues, BX_COUNTOF(bulkValues));
+            for (int i = 0; i < numSoftBodyVertices; i++) {
+                engine->getSoftBodyVertexPosition(softBody, i, glm::value_ptr(bulkValues[i]));
+            }
+            if (engine->isAvailable()) {
+                CHECK_THAT(Vector3(bulkValues[3]), Equals(Vector3(values[0])));
+                CHECK_THAT(Vector3(bulkValues[1]), Equals(Vector3(values[1])));
+                /* vertices not in the offsets are kept as is */
+                CHECK_THAT(bulkValues[0], Equals(singleValues[0]));
+                CHECK_THAT(bulkValues[2], Equals(singleValues[2]));
+            }
+            else {
+                for (nanoem_rsize_t i = 0; i < BX_COUNTOF(bulkValues); i++) {
+                    CHECK_THAT(bulkValues[i], Equals(Vector4(kSentinelValue)));
+                }
+            }
+        }
+        SECTION("set normals of all vertices without offsets")
+        {
+            for (nanoem_rsize_t i = 0; i < BX_COUNTOF(singleValues); i++) {
+                singleValues[i] = Vector4(glm::normalize(Vector3(1, nanoem_f32_t(i), 1)), 0);
+            }
+            engine->setAllSoftBodyVertexNormals(
+                softBody, nullptr, nanoem_rsize_t(numSoftBodyVertices), glm::value_ptr(singleValues[0]));
+            fillAllVertices(bulkValues, BX_COUNTOF(bulkValues));
+            for (int i = 0; i < numSoftBodyVertices; i++) {
+                engine->getSoftBodyVertexNormal(softBody, i, glm::value_ptr(bulkValues[i]));
+                CHECK_THAT(Vector3(bulkValues[i]), Equals(Vector3(singleValues[i])));
+            }
+        }
+        engine->destroySoftBody(softBody);
+        nanoemMutableModelSoftBodyDestroy(mutableSoftBody);
+    }
+}
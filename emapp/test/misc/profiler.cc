@@ -0,0 +1,105 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/FileUtils.h"
+#include "emapp/Profiler.h"
+
+#include "bx/thread.h"
+
+#include <atomic>
+
+using namespace nanoem;
+
+namespace {
+
+static nanoem_i32_t
+recordAllScopes(bx::Thread * /* thread */, void *userData)
+{
+    const std::atomic<bool> *running = static_cast<const std::atomic<bool> *>(userData);
+    while (running->load()) {
+        EMAPP_PROFILE_SCOPE("profiler_worker");
+    }
+    return 0;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("profiler_export_chrome_trace", "[emapp][misc]")
+{
+    Profiler::terminate();
+    {
+        EMAPP_PROFILE_SCOPE("profiler_disabled");
+    }
+    Profiler::setEnabled(true);
+    {
+        EMAPP_PROFILE_SCOPE("profiler_outer");
+        {
+            EMAPP_PROFILE_SCOPE("profiler_\"inner\"");
+        }
+    }
+    Profiler::setEnabled(false);
+    {
+        EMAPP_PROFILE_SCOPE("profiler_disabled");
+    }
+    ByteArray bytes;
+    MemoryWriter writer(&bytes);
+    Error error;
+    REQUIRE(Profiler::exportChromeTrace(&writer, error));
+    const std::string trace(bytes.begin(), bytes.end());
+    JSON_Value *root = json_parse_string(trace.c_str());
+    REQUIRE(root);
+    const JSON_Array *events = json_object_get_array(json_object(root), "traceEvents");
+    REQUIRE(json_array_get_count(events) == 2);
+    /* inner scope is closed first so it is recorded first */
+    const JSON_Object *inner = json_array_get_object(events, 0), *outer = json_array_get_object(events, 1);
+    CHECK_THAT(json_object_get_string(inner, "name"), Catch::Equals("profiler_\"inner\""));
+    CHECK_THAT(json_object_get_string(outer, "name"), Catch::Equals("profiler_outer"));
+    CHECK_THAT(json_object_get_string(outer, "ph"), Catch::Equals("X"));
+    CHECK(json_object_get_number(inner, "ts") >= json_object_get_number(outer, "ts"));
+    CHECK(json_object_get_number(inner, "dur") <= json_object_get_number(outer, "dur"));
+    json_value_free(root);
+    Profiler::clear();
+    bytes.clear();
+    MemoryWriter emptyWriter(&bytes);
+    REQUIRE(Profiler::exportChromeTrace(&emptyWriter, error));
+    root = json_parse_string(std::string(bytes.begin(), bytes.end()).c_str());
+    REQUIRE(root);
+    CHECK(json_array_get_count(json_object_get_array(json_object(root), "traceEvents")) == 0);
+    json_value_free(root);
+    Profiler::terminate();
+}
+
+TEST_CASE("profiler_terminate_while_recording", "[emapp][misc]")
+{
+    Profiler::terminate();
+    Profiler::setEnabled(true);
+    std::atomic<bool> running(true);
+    bx::Thread thread;
+    thread.init(recordAllScopes, &running, 0, "profiler_worker");
+    for (int i = 0; i < 100; i++) {
+        /* the worker may still be writing to the buffer of the previous generation */
+        Profiler::terminate();
+        Profiler::setEnabled(true);
+    }
+    running.store(false);
+    thread.shutdown();
+    Profiler::setEnabled(false);
+    ByteArray bytes;
+    MemoryWriter writer(&bytes);
+    Error error;
+    REQUIRE(Profiler::exportChromeTrace(&writer, error));
+    JSON_Value *root = json_parse_string(std::string(bytes.begin(), bytes.end()).c_str());
+    REQUIRE(root);
+    const JSON_Array *events = json_object_get_array(json_object(root), "traceEvents");
+    for (size_t i = 0, numEvents = json_array_get_count(events); i < numEvents; i++) {
+        CHECK_THAT(json_object_get_string(json_array_get_object(events, i), "name"), Catch::Equals("profiler_worker"));
+    }
+    json_value_free(root);
+    Profiler::terminate();
+    Profiler::terminate();
+}
@@ -0,0 +1,146 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/internal/WaveFormPyramid.h"
+
+#include <random>
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static void
+generateAllSamples16(nanoem_rsize_t numFrames, nanoem_u32_t numChannels, std::mt19937 &engine, ByteArray &bytes)
+{
+    std::uniform_int_distribution<int> distribution(-32767, 32767);
+    bytes.resize(numFrames * numChannels * sizeof(nanoem_i16_t));
+    nanoem_i16_t *ptr = reinterpret_cast<nanoem_i16_t *>(bytes.data());
+    for (nanoem_rsize_t i = 0, numSamples = numFrames * numChannels; i < numSamples; i++) {
+        ptr[i] = static_cast<nanoem_i16_t>(distribution(engine));
+    }
+}
+
+static internal::WaveFormPyramid::Bin
+bruteForce16(const ByteArray &bytes, nanoem_u32_t numChannels, nanoem_rsize_t beginFrame, nanoem_rsize_t endFrame)
+{
+    internal::WaveFormPyramid::Bin bin;
+    const nanoem_i16_t *ptr = reinterpret_cast<const nanoem_i16_t *>(bytes.data());
+    for (nanoem_rsize_t i = beginFrame * numChannels, end = endFrame * numChannels; i < end; i++) {
+        bin.merge(ptr[i] / 32767.0f);
+    }
+    return bin;
+}
+
+static void
+checkBin(const internal::WaveFormPyramid::Bin &actual, const internal::WaveFormPyramid::Bin &expected)
+{
+    CHECK(actual.m_numSamples == expected.m_numSamples);
+    CHECK(actual.m_min == expected.m_min);
+    CHECK(actual.m_max == expected.m_max);
+    CHECK(actual.rms() == Approx(expected.rms()).epsilon(1e-4));
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("waveformpyramid_empty", "[emapp][misc]")
+{
+    internal::WaveFormPyramid pyramid;
+    ByteArray bytes;
+    pyramid.reset(&bytes, 16, 2);
+    CHECK(pyramid.update(1024));
+    CHECK(pyramid.numFrames() == 0);
+    CHECK(pyramid.numLevels() == 0);
+    CHECK(pyramid.query(0, 100).m_numSamples == 0);
+    CHECK(pyramid.query(0, 100).rms() == 0);
+}
+
+TEST_CASE("waveformpyramid_query_matches_brute_force", "[emapp][misc]")
+{
+    static const nanoem_u32_t kNumChannels = 2;
+    static const nanoem_rsize_t kNumFrames = 100003;
+    std::mt19937 engine(42);
+    ByteArray bytes;
+    generateAllSamples16(kNumFrames, kNumChannels, engine, bytes);
+    internal::WaveFormPyramid pyramid;
+    pyramid.reset(&bytes, 16, kNumChannels);
+    CHECK(pyramid.update(kNumFrames));
+    CHECK(pyramid.isCompleted());
+    CHECK(pyramid.numFrames() == kNumFrames);
+    CHECK(pyramid.numLevels() > 10);
+    checkBin(pyramid.query(0, kNumFrames), bruteForce16(bytes, kNumChannels, 0, kNumFrames));
+    checkBin(pyramid.query(5, 6), bruteForce16(bytes, kNumChannels, 5, 6));
+    checkBin(pyramid.query(31, 33), bruteForce16(bytes, kNumChannels, 31, 33));
+    checkBin(pyramid.query(64, 128), bruteForce16(bytes, kNumChannels, 64, 128));
+    checkBin(pyramid.query(kNumFrames - 7, kNumFrames + 100),
+        bruteForce16(bytes, kNumChannels, kNumFrames - 7, kNumFrames));
+    std::uniform_int_distribution<nanoem_rsize_t> distribution(0, kNumFrames);
+    for (int i = 0; i < 64; i++) {
+        nanoem_rsize_t begin = distribution(engine), end = distribution(engine);
+        if (begin > end) {
+            std::swap(begin, end);
+        }
+        checkBin(pyramid.query(begin, end), bruteForce16(bytes, kNumChannels, begin, end));
+    }
+}
+
+TEST_CASE("waveformpyramid_incremental_update", "[emapp][misc]")
+{
+    static const nanoem_u32_t kNumChannels = 1;
+    static const nanoem_rsize_t kNumFrames = 10000;
+    std::mt19937 engine(7);
+    ByteArray bytes;
+    generateAllSamples16(kNumFrames, kNumChannels, engine, bytes);
+    internal::WaveFormPyramid pyramid;
+    pyramid.reset(&bytes, 16, kNumChannels);
+    CHECK_FALSE(pyramid.update(1000));
+    CHECK(pyramid.numBuiltFrames() == 1024);
+    /* frames not summarized yet are excluded */
+    checkBin(pyramid.query(0, kNumFrames), bruteForce16(bytes, kNumChannels, 0, 1024));
+    int numUpdates = 1;
+    bool completed = false;
+    while (!completed) {
+        completed = pyramid.update(1000);
+        numUpdates++;
+    }
+    CHECK(numUpdates == 10);
+    CHECK(pyramid.numBuiltFrames() == kNumFrames);
+    checkBin(pyramid.query(0, kNumFrames), bruteForce16(bytes, kNumChannels, 0, kNumFrames));
+    checkBin(pyramid.query(777, 9999), bruteForce16(bytes, kNumChannels, 777, 9999));
+}
+
+TEST_CASE("waveformpyramid_reset_with_other_source", "[emapp][misc]")
+{
+    std::mt19937 engine(1);
+    ByteArray bytes, otherBytes;
+    generateAllSamples16(1000, 2, engine, bytes);
+    internal::WaveFormPyramid pyramid;
+    CHECK_FALSE(pyramid.isSameSource(&bytes, 16, 2));
+    pyramid.reset(&bytes, 16, 2);
+    CHECK(pyramid.isSameSource(&bytes, 16, 2));
+    CHECK_FALSE(pyramid.isSameSource(&bytes, 16, 1));
+    CHECK_FALSE(pyramid.isSameSource(&bytes, 8, 2));
+    CHECK_FALSE(pyramid.isSameSource(&otherBytes, 16, 2));
+    bytes.resize(2000);
+    CHECK_FALSE(pyramid.isSameSource(&bytes, 16, 2));
+    pyramid.reset(&bytes, 16, 1);
+    CHECK(pyramid.numFrames() == 1000);
+    pyramid.reset(&bytes, 0, 1);
+    CHECK(pyramid.numFrames() == 0);
+}
+
+TEST_CASE("waveformpyramid_decode_sample", "[emapp][misc]")
+{
+    const nanoem_u8_t sample8[] = { 0x81 }, sample16[] = { 0xff, 0x7f }, sample24[] = { 0x00, 0x00, 0xc0 },
+                      sample32[] = { 0x00, 0x00, 0x00, 0x40 };
+    CHECK(internal::WaveFormPyramid::decodeSample(sample8, 1) == Approx(-1.0f));
+    CHECK(internal::WaveFormPyramid::decodeSample(sample16, 2) == Approx(1.0f));
+    CHECK(internal::WaveFormPyramid::decodeSample(sample24, 3) == Approx(-0.5f).epsilon(1e-5));
+    CHECK(internal::WaveFormPyramid::decodeSample(sample32, 4) == Approx(0.5f).epsilon(1e-5));
+    CHECK(internal::WaveFormPyramid::decodeSample(sample32, 5) == 0);
+}
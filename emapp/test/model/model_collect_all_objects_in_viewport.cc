@@ -0,0 +1,85 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/ICamera.h"
+#include "emapp/Model.h"
+#include "emapp/model/Bone.h"
+
+#include <algorithm>
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static bool
+containsVertexAt(Model *model, const ICamera *camera, nanoem_u32_t index)
+{
+    const Vector2SI32 coord(camera->toDeviceScreenCoordinateInViewport(model->skinnedVertexPosition(index)));
+    VertexIndexList candidates;
+    model->collectAllVerticesInViewport(Vector4SI32(coord - 2, 4, 4), candidates);
+    return std::find(candidates.begin(), candidates.end(), index) != candidates.end();
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("model_collect_all_objects_in_viewport_follow_skinned_vertices", "[emapp][model]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        Project *project = o->m_project;
+        /* test.pmx has no vertices */
+        Model *activeModel = o->createSkinnedModel();
+        REQUIRE(activeModel);
+        project->addModel(activeModel);
+        project->setActiveModel(activeModel);
+        activeModel->performAllBonesTransform();
+        activeModel->updateStagingVertexBuffer();
+        const ICamera *camera = project->activeCamera();
+        nanoem_rsize_t numVertices;
+        nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(activeModel->data(), &numVertices);
+        REQUIRE(numVertices > 0);
+        const Vector3 origin(glm::make_vec3(nanoemModelVertexGetOrigin(vertices[0])));
+        CHECK(glm::all(glm::epsilonEqual(activeModel->skinnedVertexPosition(0), origin, Vector3(0.0001f))));
+        CHECK(containsVertexAt(activeModel, camera, 0));
+        const nanoem_model_bone_t *bonePtr = nanoemModelVertexGetBoneObject(vertices[0], 0);
+        model::Bone *bone = model::Bone::cast(bonePtr);
+        REQUIRE(bone);
+        bone->setLocalUserTranslation(Vector3(0, 5, 0));
+        activeModel->performAllBonesTransform();
+        activeModel->updateStagingVertexBuffer();
+        SECTION("vertices are picked at the skinned position")
+        {
+            CHECK_FALSE(glm::all(glm::epsilonEqual(activeModel->skinnedVertexPosition(0), origin, Vector3(0.0001f))));
+            CHECK(containsVertexAt(activeModel, camera, 0));
+        }
+        SECTION("faces are picked at the skinned center")
+        {
+            nanoem_rsize_t numIndices;
+            const nanoem_u32_t *indices = nanoemModelGetAllVertexIndices(activeModel->data(), &numIndices);
+            REQUIRE(numIndices >= 3);
+            const Vector3 &o0 = activeModel->skinnedVertexPosition(indices[0]),
+                          &o1 = activeModel->skinnedVertexPosition(indices[1]),
+                          &o2 = activeModel->skinnedVertexPosition(indices[2]);
+            const Vector2SI32 coord(
+                camera->toDeviceScreenCoordinateInViewport(o0 + (o1 - o0) * 0.5f + (o2 - o0) * 0.5f));
+            VertexIndexList candidates;
+            activeModel->collectAllFacesInViewport(Vector4SI32(coord - 2, 4, 4), candidates);
+            CHECK(std::find(candidates.begin(), candidates.end(), 0u) != candidates.end());
+        }
+        SECTION("bones are picked at the transformed position")
+        {
+            if (activeModel->isBoneSelectable(bonePtr) && !activeModel->isRigidBodyBound(bonePtr)) {
+                const Vector2 cursor(camera->toDeviceScreenCoordinateInWindow(bone->worldTransformOrigin()));
+                nanoem_rsize_t candidateBoneIndex = 0;
+                CHECK(activeModel->intersectsBone(cursor, candidateBoneIndex));
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Model.h"
+#include "emapp/model/Bone.h"
+#include "emapp/model/Morph.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static void
+checkAllSkinnedVerticesContained(Model *model)
+{
+    model->deformAllMorphs(false);
+    model->performAllBonesTransform();
+    model->updateStagingVertexBuffer();
+    nanoem_rsize_t numMaterials, numIndices, offset = 0;
+    const nanoem_model_t *opaque = model->data();
+    nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(opaque, &numMaterials);
+    const nanoem_u32_t *indices = nanoemModelGetAllVertexIndices(opaque, &numIndices);
+    for (nanoem_rsize_t i = 0; i < numMaterials; i++) {
+        const nanoem_model_material_t *materialPtr = materials[i];
+        const nanoem_rsize_t numMaterialIndices = nanoemModelMaterialGetNumVertexIndices(materialPtr);
+        REQUIRE(model->isMaterialCullable(materialPtr));
+        const BoundingBox box(model->materialBoundingBox(materialPtr));
+        for (nanoem_rsize_t j = offset; j < offset + numMaterialIndices; j++) {
+            const Vector3 &position = model->skinnedVertexPosition(indices[j]);
+            CHECK(glm::all(glm::lessThanEqual(box.m_min, position + Vector3(0.0001f))));
+            CHECK(glm::all(glm::lessThanEqual(position - Vector3(0.0001f), box.m_max)));
+        }
+        offset += numMaterialIndices;
+    }
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("model_material_bounds_contain_all_vertices", "[emapp][model]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        Model *activeModel = o->createModel();
+        activeModel->performAllBonesTransform();
+        activeModel->updateStagingVertexBuffer();
+        nanoem_rsize_t numMaterials, numVertices, numIndices, offset = 0;
+        const nanoem_model_t *opaque = activeModel->data();
+        nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(opaque, &numMaterials);
+        nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(opaque, &numVertices);
+        const nanoem_u32_t *indices = nanoemModelGetAllVertexIndices(opaque, &numIndices);
+        for (nanoem_rsize_t i = 0; i < numMaterials; i++) {
+            const nanoem_model_material_t *materialPtr = materials[i];
+            const nanoem_rsize_t numMaterialIndices = nanoemModelMaterialGetNumVertexIndices(materialPtr);
+            if (activeModel->isMaterialCullable(materialPtr)) {
+                const BoundingBox box(activeModel->materialBoundingBox(materialPtr));
+                for (nanoem_rsize_t j = offset; j < offset + numMaterialIndices; j++) {
+                    /* all bones are at rest so each vertex must be placed at its origin */
+                    const Vector3 origin(glm::make_vec3(nanoemModelVertexGetOrigin(vertices[indices[j]])));
+                    CHECK(glm::all(glm::lessThanEqual(box.m_min, origin + Vector3(0.0001f))));
+                    CHECK(glm::all(glm::lessThanEqual(origin - Vector3(0.0001f), box.m_max)));
+                }
+            }
+            offset += numMaterialIndices;
+        }
+    }
+}
+
+TEST_CASE("model_material_bounds_contain_all_skinned_vertices", "[emapp][model]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        /* test.pmx has no vertices */
+        Model *model = o->createSkinnedModel();
+        REQUIRE(model);
+        o->m_project->addModel(model);
+        nanoem_rsize_t numBones, numMorphs;
+        nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(model->data(), &numBones);
+        nanoem_model_morph_t *const *morphs = nanoemModelGetAllMorphObjects(model->data(), &numMorphs);
+        REQUIRE(numBones == 2);
+        REQUIRE(numMorphs == 1);
+        checkAllSkinnedVerticesContained(model);
+        SECTION("posed bones")
+        {
+            model::Bone::cast(bones[0])->setLocalUserOrientation(
+                glm::angleAxis(glm::radians(90.0f), Vector3(0, 0, 1)));
+            model::Bone::cast(bones[1])->setLocalUserTranslation(Vector3(3, 2, -1));
+            checkAllSkinnedVerticesContained(model);
+        }
+        SECTION("vertex morph weight above one")
+        {
+            /* weights are not clamped so the offset is scaled by the weight */
+            model::Morph *morph = model::Morph::cast(morphs[0]);
+            morph->setWeight(20.0f);
+            checkAllSkinnedVerticesContained(model);
+            CHECK_THAT(model->skinnedVertexPosition(0), Equals(Vector3(0, 20, 0)));
+            morph->setWeight(-20.0f);
+            checkAllSkinnedVerticesContained(model);
+            CHECK_THAT(model->skinnedVertexPosition(0), Equals(Vector3(0, -20, 0)));
+        }
+    }
+}
@@ -0,0 +1,133 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Model.h"
+#include "emapp/model/Bone.h"
+#include "emapp/model/Morph.h"
+#include "emapp/model/Vertex.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static Vector3
+skinnedVertexPositionWithoutCache(const Model *model, nanoem_rsize_t index)
+{
+    nanoem_rsize_t numVertices;
+    nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(model->data(), &numVertices);
+    bx::simd128_t position = bx::simd_zero(), normal = bx::simd_zero();
+    Model::VertexUnit::performSkinningByType(model::Vertex::cast(vertices[index]), &position, &normal);
+    return Vector3(bx::simd_x(position), bx::simd_y(position), bx::simd_z(position));
+}
+
+static void
+checkAllSkinnedVertexPositions(Model *model)
+{
+    nanoem_rsize_t numVertices;
+    nanoemModelGetAllVertexObjects(model->data(), &numVertices);
+    for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+        CHECK_THAT(model->skinnedVertexPosition(i), Equals(skinnedVertexPositionWithoutCache(model, i)));
+    }
+}
+
+static void
+updateAllVertices(Model *model)
+{
+    model->deformAllMorphs(false);
+    model->performAllBonesTransform();
+    model->updateStagingVertexBuffer();
+}
+
+static void
+testSkinnedVertexCache(Model *model)
+{
+    nanoem_rsize_t numBones, numMorphs;
+    nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(model->data(), &numBones);
+    nanoem_model_morph_t *const *morphs = nanoemModelGetAllMorphObjects(model->data(), &numMorphs);
+    REQUIRE(numBones == 2);
+    REQUIRE(numMorphs == 1);
+    updateAllVertices(model);
+    checkAllSkinnedVertexPositions(model);
+    CHECK_THAT(model->skinnedVertexPosition(2), Equals(Vector3(0, 5, 0)));
+    model::Bone *bone = model::Bone::cast(bones[1]);
+    bone->setLocalUserTranslation(Vector3(0, 2, 0));
+    updateAllVertices(model);
+    checkAllSkinnedVertexPositions(model);
+    CHECK_THAT(model->skinnedVertexPosition(2), Equals(Vector3(0, 7, 0)));
+    CHECK_THAT(model->skinnedVertexPosition(3), Equals(Vector3(1, 6, 0)));
+    model::Morph *morph = model::Morph::cast(morphs[0]);
+    morph->setWeight(1.0f);
+    updateAllVertices(model);
+    checkAllSkinnedVertexPositions(model);
+    CHECK_THAT(model->skinnedVertexPosition(0), Equals(Vector3(0, 1, 0)));
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("model_skinned_vertex_cache_matches_uncached_skinning", "[emapp][model]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        Model *model = o->createSkinnedModel();
+        REQUIRE(model);
+        o->m_project->addModel(model);
+        SECTION("vertices are skinned lazily while overlays are hidden")
+        {
+            model->setShowAllVertexPoints(false);
+            testSkinnedVertexCache(model);
+        }
+        SECTION("vertices are captured while skinning with overlays shown")
+        {
+            model->setShowAllVertexPoints(true);
+            testSkinnedVertexCache(model);
+        }
+    }
+}
+
+TEST_CASE("model_skinned_vertex_cache_invalidated_by_dirty_bone_and_morph", "[emapp][model]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        Model *model = o->createSkinnedModel();
+        REQUIRE(model);
+        o->m_project->addModel(model);
+        nanoem_rsize_t numBones, numMorphs;
+        nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(model->data(), &numBones);
+        nanoem_model_morph_t *const *morphs = nanoemModelGetAllMorphObjects(model->data(), &numMorphs);
+        REQUIRE(numBones == 2);
+        REQUIRE(numMorphs == 1);
+        updateAllVertices(model);
+        CHECK_FALSE(model->isStagingVertexBufferDirty());
+        const Vector3 restPosition(model->skinnedVertexPosition(2));
+        /* nothing is dirty so the staging buffer is not updated and the cache is kept */
+        model->updateStagingVertexBuffer();
+        CHECK_THAT(model->skinnedVertexPosition(2), Equals(restPosition));
+        SECTION("bone")
+        {
+            model::Bone::cast(bones[1])->setLocalUserTranslation(Vector3(0, 2, 0));
+            model->performAllBonesTransform();
+            CHECK(model->isStagingVertexBufferDirty());
+            model->updateStagingVertexBuffer();
+            CHECK_FALSE(model->isStagingVertexBufferDirty());
+            CHECK_THAT(model->skinnedVertexPosition(2), Equals(restPosition + Vector3(0, 2, 0)));
+        }
+        SECTION("morph")
+        {
+            const Vector3 origin(model->skinnedVertexPosition(0));
+            model::Morph::cast(morphs[0])->setWeight(0.5f);
+            model->deformAllMorphs(true);
+            model->performAllBonesTransform();
+            CHECK(model->isStagingVertexBufferDirty());
+            model->updateStagingVertexBuffer();
+            CHECK_THAT(model->skinnedVertexPosition(0), Equals(origin + Vector3(0, 0.5f, 0)));
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/model/Bone.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static void
+translateAllConstraintBones(Model *model, const Vector3 &value)
+{
+    nanoem_rsize_t numBones;
+    nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(model->data(), &numBones);
+    for (nanoem_rsize_t i = 0; i < numBones; i++) {
+        const nanoem_model_bone_t *bonePtr = bones[i];
+        if (nanoemModelBoneGetConstraintObject(bonePtr)) {
+            model::Bone::cast(bonePtr)->setLocalUserTranslation(value);
+        }
+    }
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("model_solve_constraint_converged_pose", "[emapp][model]")
+{
+    static const Vector3 kTranslations[] = {
+        Vector3(0), Vector3(0, 0.5f, -1), Vector3(1.5f, 2, 0.5f), Vector3(-1, 4, 2), Vector3(0, -0.25f, 3)
+    };
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->withRecoverable();
+    project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeDisable);
+    Model *tracedModel = o->createModel();
+    Model *model = o->createModel();
+    project->addModel(tracedModel);
+    project->addModel(model);
+    tracedModel->setConstraintIterationTraceEnabled(true);
+    CHECK(tracedModel->isConstraintIterationTraceEnabled());
+    CHECK_FALSE(model->isConstraintIterationTraceEnabled());
+    nanoem_rsize_t numBones;
+    nanoem_model_bone_t *const *tracedBones = nanoemModelGetAllBoneObjects(tracedModel->data(), &numBones);
+    nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(model->data(), &numBones);
+    for (const auto &translation : kTranslations) {
+        translateAllConstraintBones(tracedModel, translation);
+        translateAllConstraintBones(model, translation);
+        tracedModel->performAllBonesTransform();
+        model->performAllBonesTransform();
+        for (nanoem_rsize_t i = 0; i < numBones; i++) {
+            const model::Bone *tracedBone = model::Bone::cast(tracedBones[i]);
+            const model::Bone *bone = model::Bone::cast(bones[i]);
+            CHECK(glm::all(glm::epsilonEqual(
+                bone->worldTransformOrigin(), tracedBone->worldTransformOrigin(), Vector3(0.001f))));
+        }
+    }
+}
@@ -0,0 +1,226 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/StringUtils.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static const char kLeftArmInJapanese[] = { char(0xe5), char(0xb7), char(0xa6), char(0xe8), char(0x85), char(0x95), 0 };
+static const char kRightArmInJapanese[] = { char(0xe5), char(0x8f), char(0xb3), char(0xe8), char(0x85), char(0x95), 0 };
+
+static void
+addBoneKeyframe(Motion *motion, nanoem_unicode_string_factory_t *factory, const char *name,
+    nanoem_frame_index_t frameIndex, nanoem_f32_t x)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_motion_t *mutableMotion = nanoemMutableMotionCreateAsReference(motion->data(), &status);
+    nanoem_mutable_motion_bone_keyframe_t *keyframe = nanoemMutableMotionBoneKeyframeCreate(motion->data(), &status);
+    StringUtils::UnicodeStringScope scope(factory);
+    StringUtils::tryGetString(factory, name, scope);
+    nanoemMutableMotionBoneKeyframeSetTranslation(keyframe, glm::value_ptr(Vector4(x, 0, 0, 0)));
+    nanoemMutableMotionAddBoneKeyframe(mutableMotion, keyframe, scope.value(), frameIndex, &status);
+    nanoemMutableMotionBoneKeyframeDestroy(keyframe);
+    nanoemMutableMotionDestroy(mutableMotion);
+}
+
+static void
+addMorphKeyframe(Motion *motion, nanoem_unicode_string_factory_t *factory, const char *name,
+    nanoem_frame_index_t frameIndex, nanoem_f32_t weight)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_motion_t *mutableMotion = nanoemMutableMotionCreateAsReference(motion->data(), &status);
+    nanoem_mutable_motion_morph_keyframe_t *keyframe = nanoemMutableMotionMorphKeyframeCreate(motion->data(), &status);
+    StringUtils::UnicodeStringScope scope(factory);
+    StringUtils::tryGetString(factory, name, scope);
+    nanoemMutableMotionMorphKeyframeSetWeight(keyframe, weight);
+    nanoemMutableMotionAddMorphKeyframe(mutableMotion, keyframe, scope.value(), frameIndex, &status);
+    nanoemMutableMotionMorphKeyframeDestroy(keyframe);
+    nanoemMutableMotionDestroy(mutableMotion);
+}
+
+static void
+addCameraKeyframe(Motion *motion, nanoem_frame_index_t frameIndex, nanoem_f32_t distance)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_motion_t *mutableMotion = nanoemMutableMotionCreateAsReference(motion->data(), &status);
+    nanoem_mutable_motion_camera_keyframe_t *keyframe =
+        nanoemMutableMotionCameraKeyframeCreate(motion->data(), &status);
+    nanoemMutableMotionCameraKeyframeSetDistance(keyframe, distance);
+    nanoemMutableMotionAddCameraKeyframe(mutableMotion, keyframe, frameIndex, &status);
+    nanoemMutableMotionCameraKeyframeDestroy(keyframe);
+    nanoemMutableMotionSortAllKeyframes(mutableMotion);
+    nanoemMutableMotionDestroy(mutableMotion);
+}
+
+static nanoem_f32_t
+boneTranslationX(
+    const Motion *motion, nanoem_unicode_string_factory_t *factory, const char *name, nanoem_frame_index_t frameIndex)
+{
+    StringUtils::UnicodeStringScope scope(factory);
+    StringUtils::tryGetString(factory, name, scope);
+    const nanoem_motion_bone_keyframe_t *keyframe = motion->findBoneKeyframe(scope.value(), frameIndex);
+    return keyframe ? nanoemMotionBoneKeyframeGetTranslation(keyframe)[0] : -1000.0f;
+}
+
+static nanoem_f32_t
+morphWeight(
+    const Motion *motion, nanoem_unicode_string_factory_t *factory, const char *name, nanoem_frame_index_t frameIndex)
+{
+    StringUtils::UnicodeStringScope scope(factory);
+    StringUtils::tryGetString(factory, name, scope);
+    const nanoem_motion_morph_keyframe_t *keyframe = motion->findMorphKeyframe(scope.value(), frameIndex);
+    return keyframe ? nanoemMotionMorphKeyframeGetWeight(keyframe) : -1000.0f;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("motion_merge_all_keyframes", "[emapp][motion]")
+{
+    TestScope scope;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    nanoem_unicode_string_factory_t *factory = project->unicodeStringFactory();
+    Motion *source = project->createMotion();
+    Motion *dest = project->createMotion();
+    addBoneKeyframe(dest, factory, kLeftArmInJapanese, 0, 1);
+    addBoneKeyframe(dest, factory, kLeftArmInJapanese, 20, 2);
+    addCameraKeyframe(dest, 0, 10);
+    addCameraKeyframe(dest, 20, 20);
+    addBoneKeyframe(source, factory, kLeftArmInJapanese, 10, 3);
+    addBoneKeyframe(source, factory, kLeftArmInJapanese, 0, 4);
+    addBoneKeyframe(source, factory, kRightArmInJapanese, 0, 5);
+    addCameraKeyframe(source, 0, 30);
+    addCameraKeyframe(source, 10, 40);
+    SECTION("existing keyframes are kept")
+    {
+        dest->mergeAllKeyframes(source);
+        CHECK(dest->countAllKeyframes() == 7);
+        CHECK(boneTranslationX(dest, factory, kLeftArmInJapanese, 0) == Approx(1));
+        CHECK(boneTranslationX(dest, factory, kLeftArmInJapanese, 10) == Approx(3));
+        CHECK(boneTranslationX(dest, factory, kLeftArmInJapanese, 20) == Approx(2));
+        CHECK(boneTranslationX(dest, factory, kRightArmInJapanese, 0) == Approx(5));
+        CHECK(nanoemMotionCameraKeyframeGetDistance(dest->findCameraKeyframe(0)) == Approx(10));
+        CHECK(nanoemMotionCameraKeyframeGetDistance(dest->findCameraKeyframe(10)) == Approx(40));
+        CHECK(nanoemMotionCameraKeyframeGetDistance(dest->findCameraKeyframe(20)) == Approx(20));
+        CHECK(dest->isDirty());
+    }
+    SECTION("existing keyframes are overridden with the offset")
+    {
+        dest->overrideAllKeyframes(source, 10, false);
+        CHECK(dest->countAllKeyframes() == 7);
+        CHECK(boneTranslationX(dest, factory, kLeftArmInJapanese, 0) == Approx(1));
+        CHECK(boneTranslationX(dest, factory, kLeftArmInJapanese, 10) == Approx(4));
+        CHECK(boneTranslationX(dest, factory, kLeftArmInJapanese, 20) == Approx(3));
+        CHECK(boneTranslationX(dest, factory, kRightArmInJapanese, 10) == Approx(5));
+        CHECK(nanoemMotionCameraKeyframeGetDistance(dest->findCameraKeyframe(0)) == Approx(10));
+        CHECK(nanoemMotionCameraKeyframeGetDistance(dest->findCameraKeyframe(10)) == Approx(30));
+        CHECK(nanoemMotionCameraKeyframeGetDistance(dest->findCameraKeyframe(20)) == Approx(40));
+        CHECK(dest->duration() == 20);
+    }
+    SECTION("the first keyframe of each track in the source is mirrored")
+    {
+        dest->overrideAllKeyframes(source, 100, true);
+        /* the left arm keyframe at 110 is mirrored to the right arm and the right arm keyframe at 100 follows it */
+        CHECK(boneTranslationX(dest, factory, kLeftArmInJapanese, 100) == Approx(-5));
+        CHECK(boneTranslationX(dest, factory, kLeftArmInJapanese, 110) == Approx(3));
+        CHECK(boneTranslationX(dest, factory, kRightArmInJapanese, 100) == Approx(5));
+        CHECK(boneTranslationX(dest, factory, kRightArmInJapanese, 110) == Approx(-3));
+        CHECK(dest->duration() == 110);
+    }
+    project->destroyMotion(dest);
+    project->destroyMotion(source);
+}
+
+TEST_CASE("motion_merge_all_morph_keyframes", "[emapp][motion]")
+{
+    TestScope scope;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    nanoem_unicode_string_factory_t *factory = project->unicodeStringFactory();
+    Motion *source = project->createMotion();
+    Motion *dest = project->createMotion();
+    addMorphKeyframe(dest, factory, "a", 0, 0.1f);
+    addMorphKeyframe(dest, factory, "a", 20, 0.2f);
+    addMorphKeyframe(source, factory, "a", 10, 0.3f);
+    addMorphKeyframe(source, factory, "a", 0, 0.4f);
+    addMorphKeyframe(source, factory, "b", 0, 0.5f);
+    SECTION("existing keyframes are kept")
+    {
+        dest->mergeAllKeyframes(source);
+        CHECK(dest->countAllKeyframes() == 4);
+        CHECK(morphWeight(dest, factory, "a", 0) == Approx(0.1f));
+        CHECK(morphWeight(dest, factory, "a", 10) == Approx(0.3f));
+        CHECK(morphWeight(dest, factory, "a", 20) == Approx(0.2f));
+        CHECK(morphWeight(dest, factory, "b", 0) == Approx(0.5f));
+        CHECK(dest->duration() == 20);
+    }
+    SECTION("existing keyframes are overridden with the offset")
+    {
+        dest->overrideAllKeyframes(source, 10, false);
+        CHECK(dest->countAllKeyframes() == 4);
+        CHECK(morphWeight(dest, factory, "a", 0) == Approx(0.1f));
+        CHECK(morphWeight(dest, factory, "a", 10) == Approx(0.4f));
+        CHECK(morphWeight(dest, factory, "a", 20) == Approx(0.3f));
+        CHECK(morphWeight(dest, factory, "b", 10) == Approx(0.5f));
+        CHECK(morphWeight(dest, factory, "b", 0) == Approx(-1000.0f));
+    }
+    SECTION("morph keyframes are never mirrored")
+    {
+        dest->overrideAllKeyframes(source, true);
+        CHECK(dest->countAllKeyframes() == 4);
+        CHECK(morphWeight(dest, factory, "a", 0) == Approx(0.4f));
+        CHECK(morphWeight(dest, factory, "b", 0) == Approx(0.5f));
+    }
+    project->destroyMotion(dest);
+    project->destroyMotion(source);
+}
+
+TEST_CASE("motion_merge_all_keyframes_sorted", "[emapp][motion]")
+{
+    TestScope scope;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    Motion *source = project->createMotion();
+    Motion *dest = project->createMotion();
+    addCameraKeyframe(dest, 0, 10);
+    addCameraKeyframe(dest, 10, 20);
+    addCameraKeyframe(dest, 20, 30);
+    addCameraKeyframe(source, 1, 40);
+    addCameraKeyframe(source, 2, 50);
+    addCameraKeyframe(source, 3, 60);
+    addCameraKeyframe(source, 4, 70);
+    addCameraKeyframe(source, 20, 80);
+    const nanoem_frame_index_t expected[] = { 0, 1, 2, 3, 4, 10, 20 };
+    /* the last keyframe could not be found with binary search over the appended keyframes and was duplicated */
+    SECTION("existing keyframes are kept")
+    {
+        dest->mergeAllKeyframes(source);
+        CHECK(nanoemMotionCameraKeyframeGetDistance(dest->findCameraKeyframe(20)) == Approx(30));
+    }
+    SECTION("existing keyframes are overridden")
+    {
+        dest->overrideAllKeyframes(source, false);
+        CHECK(nanoemMotionCameraKeyframeGetDistance(dest->findCameraKeyframe(20)) == Approx(80));
+    }
+    nanoem_rsize_t numKeyframes;
+    nanoem_motion_camera_keyframe_t *const *keyframes =
+        nanoemMotionGetAllCameraKeyframeObjects(dest->data(), &numKeyframes);
+    REQUIRE(numKeyframes == BX_COUNTOF(expected));
+    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(keyframes[i])) ==
+            expected[i]);
+    }
+    CHECK(nanoemMotionCameraKeyframeGetDistance(dest->findCameraKeyframe(1)) == Approx(40));
+    CHECK(nanoemMotionCameraKeyframeGetDistance(dest->findCameraKeyframe(4)) == Approx(70));
+    CHECK(dest->duration() == 20);
+    project->destroyMotion(dest);
+    project->destroyMotion(source);
+}
@@ -0,0 +1,629 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/StringUtils.h"
+
+#include <random>
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+/* names in the VMD are encoded in Shift_JIS and both of the left and the right arms are mirrored each other */
+static const char kLeftArmInShiftJIS[] = { char(0x8d), char(0xb6), char(0x98), char(0x72), 0 };
+static const char kRightArmInShiftJIS[] = { char(0x89), char(0x45), char(0x98), char(0x72), 0 };
+static const char kLeftLegInShiftJIS[] = { char(0x8d), char(0xb6), char(0x91), char(0xab), 0 };
+static const char kRightLegInShiftJIS[] = { char(0x89), char(0x45), char(0x91), char(0xab), 0 };
+static const char *const kAllBoneNames[] = { kLeftArmInShiftJIS, kRightArmInShiftJIS, kLeftLegInShiftJIS,
+    kRightLegInShiftJIS, "center", "neck" };
+static const char *const kAllMorphNames[] = { "a", "i", "u", "blink" };
+
+/* the merger before walking tracks with the zipper that looks up the destination motion per keyframe */
+struct ReferenceMerger {
+    ReferenceMerger(const nanoem_motion_t *source, nanoem_unicode_string_factory_t *factory, nanoem_motion_t *dest,
+        nanoem_frame_index_t offset, bool _override);
+    ~ReferenceMerger();
+
+    void mergeAllKeyframes(bool reverse);
+
+    nanoem_frame_index_t frameIndexOf(const nanoem_motion_keyframe_object_t *keyframe) const;
+    void reverseBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, const String &newName);
+    void reverseBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, StringSet &reversedBoneNameSet);
+    void addBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, bool reverse, StringSet &reversedBoneNameSet);
+    void mergeAllAccessoryKeyframes();
+    void mergeAllBoneKeyframes(bool reverse);
+    void mergeAllCameraKeyframes();
+    void mergeAllLightKeyframes();
+    void mergeAllModelKeyframes();
+    void mergeAllMorphKeyframes();
+    void mergeAllSelfShadowKeyframes();
+
+    const nanoem_motion_t *m_source;
+    nanoem_unicode_string_factory_t *m_factory;
+    nanoem_motion_t *m_origin;
+    nanoem_mutable_motion_t *m_dest;
+    const nanoem_frame_index_t m_offset;
+    const bool m_override;
+    nanoem_status_t m_status;
+};
+
+ReferenceMerger::ReferenceMerger(const nanoem_motion_t *source, nanoem_unicode_string_factory_t *factory,
+    nanoem_motion_t *dest, nanoem_frame_index_t offset, bool _override)
+    : m_source(source)
+    , m_factory(factory)
+    , m_origin(dest)
+    , m_dest(nullptr)
+    , m_offset(offset)
+    , m_override(_override)
+    , m_status(NANOEM_STATUS_SUCCESS)
+{
+    m_dest = nanoemMutableMotionCreateAsReference(dest, &m_status);
+}
+
+ReferenceMerger::~ReferenceMerger()
+{
+    nanoemMutableMotionDestroy(m_dest);
+}
+
+void
+ReferenceMerger::mergeAllKeyframes(bool reverse)
+{
+    mergeAllAccessoryKeyframes();
+    mergeAllBoneKeyframes(reverse);
+    mergeAllCameraKeyframes();
+    mergeAllLightKeyframes();
+    mergeAllModelKeyframes();
+    mergeAllMorphKeyframes();
+    mergeAllSelfShadowKeyframes();
+}
+
+nanoem_frame_index_t
+ReferenceMerger::frameIndexOf(const nanoem_motion_keyframe_object_t *keyframe) const
+{
+    return nanoemMotionKeyframeObjectGetFrameIndex(keyframe) + m_offset;
+}
+
+void
+ReferenceMerger::reverseBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, const String &newName)
+{
+    StringUtils::UnicodeStringScope scope(m_factory);
+    if (StringUtils::tryGetString(m_factory, newName, scope)) {
+        const nanoem_frame_index_t frameIndex = frameIndexOf(nanoemMotionBoneKeyframeGetKeyframeObject(origin));
+        nanoem_mutable_motion_bone_keyframe_t *keyframe =
+            nanoemMutableMotionBoneKeyframeCreateByFound(m_origin, scope.value(), frameIndex, &m_status);
+        const bool found = keyframe != nullptr;
+        if (!found) {
+            keyframe = nanoemMutableMotionBoneKeyframeCreate(m_origin, &m_status);
+        }
+        nanoemMutableMotionBoneKeyframeCopy(keyframe, origin);
+        const nanoem_f32_t *translation = nanoemMotionBoneKeyframeGetTranslation(origin);
+        const nanoem_f32_t *orientation = nanoemMotionBoneKeyframeGetOrientation(origin);
+        nanoemMutableMotionBoneKeyframeSetTranslation(
+            keyframe, glm::value_ptr(Vector4(-translation[0], translation[1], translation[2], 0)));
+        nanoemMutableMotionBoneKeyframeSetOrientation(
+            keyframe, glm::value_ptr(Quaternion(orientation[3], orientation[0], -orientation[1], -orientation[2])));
+        if (!found) {
+            nanoemMutableMotionAddBoneKeyframe(m_dest, keyframe, scope.value(), frameIndex, &m_status);
+        }
+        nanoemMutableMotionBoneKeyframeDestroy(keyframe);
+    }
+}
+
+void
+ReferenceMerger::reverseBoneKeyframe(const nanoem_motion_bone_keyframe_t *origin, StringSet &reversedBoneNameSet)
+{
+    static const nanoem_u8_t kLeftInJapanese[] = { 0xe5, 0xb7, 0xa6, 0x0 },
+                             kRightInJapanese[] = { 0xe5, 0x8f, 0xb3, 0x0 };
+    const char *left = reinterpret_cast<const char *>(kLeftInJapanese),
+               *right = reinterpret_cast<const char *>(kRightInJapanese);
+    String utf8Name, newName;
+    StringUtils::getUtf8String(nanoemMotionBoneKeyframeGetName(origin), m_factory, utf8Name);
+    if (StringUtils::hasPrefix(utf8Name.c_str(), left)) {
+        newName = StringUtils::substitutedPrefixString(right, utf8Name.c_str());
+    }
+    else if (StringUtils::hasPrefix(utf8Name.c_str(), right)) {
+        newName = StringUtils::substitutedPrefixString(left, utf8Name.c_str());
+    }
+    if (!newName.empty() && reversedBoneNameSet.find(newName) == reversedBoneNameSet.end()) {
+        reverseBoneKeyframe(origin, newName);
+        reversedBoneNameSet.insert(newName);
+    }
+}
+
+void
+ReferenceMerger::addBoneKeyframe(
+    const nanoem_motion_bone_keyframe_t *origin, bool reverse, StringSet &reversedBoneNameSet)
+{
+    nanoem_mutable_motion_bone_keyframe_t *newKeyframe = nanoemMutableMotionBoneKeyframeCreate(m_origin, &m_status);
+    nanoemMutableMotionBoneKeyframeCopy(newKeyframe, origin);
+    if (reverse) {
+        reverseBoneKeyframe(origin, reversedBoneNameSet);
+    }
+    const nanoem_frame_index_t frameIndex = frameIndexOf(nanoemMotionBoneKeyframeGetKeyframeObject(origin));
+    nanoemMutableMotionAddBoneKeyframe(
+        m_dest, newKeyframe, nanoemMotionBoneKeyframeGetName(origin), frameIndex, &m_status);
+    nanoemMutableMotionBoneKeyframeDestroy(newKeyframe);
+}
+
+void
+ReferenceMerger::mergeAllAccessoryKeyframes()
+{
+    nanoem_rsize_t numKeyframes;
+    nanoem_motion_accessory_keyframe_t *const *keyframes =
+        nanoemMotionGetAllAccessoryKeyframeObjects(m_source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+        const nanoem_motion_accessory_keyframe_t *keyframe = keyframes[i];
+        const nanoem_frame_index_t frameIndex =
+            frameIndexOf(nanoemMotionAccessoryKeyframeGetKeyframeObject(keyframe));
+        nanoem_mutable_motion_accessory_keyframe_t *newKeyframe = m_override
+            ? nanoemMutableMotionAccessoryKeyframeCreateByFound(m_origin, frameIndex, &m_status)
+            : nullptr;
+        if (newKeyframe) {
+            nanoemMutableMotionAccessoryKeyframeCopy(newKeyframe, keyframe, &m_status);
+        }
+        else if (m_override || !nanoemMotionFindAccessoryKeyframeObject(m_origin, frameIndex)) {
+            newKeyframe = nanoemMutableMotionAccessoryKeyframeCreate(m_origin, &m_status);
+            nanoemMutableMotionAccessoryKeyframeCopy(newKeyframe, keyframe, &m_status);
+            nanoemMutableMotionAddAccessoryKeyframe(m_dest, newKeyframe, frameIndex, &m_status);
+        }
+        nanoemMutableMotionAccessoryKeyframeDestroy(newKeyframe);
+    }
+}
+
+void
+ReferenceMerger::mergeAllBoneKeyframes(bool reverse)
+{
+    nanoem_rsize_t numKeyframes;
+    nanoem_motion_bone_keyframe_t *const *keyframes = nanoemMotionGetAllBoneKeyframeObjects(m_source, &numKeyframes);
+    StringSet reversedBoneNameSet;
+    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+        const nanoem_motion_bone_keyframe_t *keyframe = keyframes[i];
+        const nanoem_frame_index_t frameIndex = frameIndexOf(nanoemMotionBoneKeyframeGetKeyframeObject(keyframe));
+        const nanoem_unicode_string_t *name = nanoemMotionBoneKeyframeGetName(keyframe);
+        nanoem_mutable_motion_bone_keyframe_t *newKeyframe =
+            m_override ? nanoemMutableMotionBoneKeyframeCreateByFound(m_origin, name, frameIndex, &m_status) : nullptr;
+        if (newKeyframe) {
+            nanoemMutableMotionBoneKeyframeCopy(newKeyframe, keyframe);
+            if (reverse) {
+                reverseBoneKeyframe(keyframe, reversedBoneNameSet);
+            }
+            nanoemMutableMotionBoneKeyframeDestroy(newKeyframe);
+        }
+        else if (m_override || !nanoemMotionFindBoneKeyframeObject(m_origin, name, frameIndex)) {
+            addBoneKeyframe(keyframe, reverse, reversedBoneNameSet);
+        }
+    }
+}
+
+void
+ReferenceMerger::mergeAllCameraKeyframes()
+{
+    nanoem_rsize_t numKeyframes;
+    nanoem_motion_camera_keyframe_t *const *keyframes =
+        nanoemMotionGetAllCameraKeyframeObjects(m_source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+        const nanoem_motion_camera_keyframe_t *keyframe = keyframes[i];
+        const nanoem_frame_index_t frameIndex = frameIndexOf(nanoemMotionCameraKeyframeGetKeyframeObject(keyframe));
+        nanoem_mutable_motion_camera_keyframe_t *newKeyframe =
+            m_override ? nanoemMutableMotionCameraKeyframeCreateByFound(m_origin, frameIndex, &m_status) : nullptr;
+        if (newKeyframe) {
+            nanoemMutableMotionCameraKeyframeCopy(newKeyframe, keyframe);
+        }
+        else if (m_override || !nanoemMotionFindCameraKeyframeObject(m_origin, frameIndex)) {
+            newKeyframe = nanoemMutableMotionCameraKeyframeCreate(m_origin, &m_status);
+            nanoemMutableMotionCameraKeyframeCopy(newKeyframe, keyframe);
+            nanoemMutableMotionAddCameraKeyframe(m_dest, newKeyframe, frameIndex, &m_status);
+        }
+        nanoemMutableMotionCameraKeyframeDestroy(newKeyframe);
+    }
+}
+
+void
+ReferenceMerger::mergeAllLightKeyframes()
+{
+    nanoem_rsize_t numKeyframes;
+    nanoem_motion_light_keyframe_t *const *keyframes = nanoemMotionGetAllLightKeyframeObjects(m_source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+        const nanoem_motion_light_keyframe_t *keyframe = keyframes[i];
+        const nanoem_frame_index_t frameIndex = frameIndexOf(nanoemMotionLightKeyframeGetKeyframeObject(keyframe));
+        nanoem_mutable_motion_light_keyframe_t *newKeyframe =
+            m_override ? nanoemMutableMotionLightKeyframeCreateByFound(m_origin, frameIndex, &m_status) : nullptr;
+        if (newKeyframe) {
+            nanoemMutableMotionLightKeyframeCopy(newKeyframe, keyframe);
+        }
+        else if (m_override || !nanoemMotionFindLightKeyframeObject(m_origin, frameIndex)) {
+            newKeyframe = nanoemMutableMotionLightKeyframeCreate(m_origin, &m_status);
+            nanoemMutableMotionLightKeyframeCopy(newKeyframe, keyframe);
+            nanoemMutableMotionAddLightKeyframe(m_dest, newKeyframe, frameIndex, &m_status);
+        }
+        nanoemMutableMotionLightKeyframeDestroy(newKeyframe);
+    }
+}
+
+void
+ReferenceMerger::mergeAllModelKeyframes()
+{
+    nanoem_rsize_t numKeyframes;
+    nanoem_motion_model_keyframe_t *const *keyframes = nanoemMotionGetAllModelKeyframeObjects(m_source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+        const nanoem_motion_model_keyframe_t *keyframe = keyframes[i];
+        const nanoem_frame_index_t frameIndex = frameIndexOf(nanoemMotionModelKeyframeGetKeyframeObject(keyframe));
+        nanoem_mutable_motion_model_keyframe_t *newKeyframe =
+            m_override ? nanoemMutableMotionModelKeyframeCreateByFound(m_origin, frameIndex, &m_status) : nullptr;
+        if (newKeyframe) {
+            nanoemMutableMotionModelKeyframeCopy(newKeyframe, keyframe, &m_status);
+        }
+        else if (m_override || !nanoemMotionFindModelKeyframeObject(m_origin, frameIndex)) {
+            newKeyframe = nanoemMutableMotionModelKeyframeCreate(m_origin, &m_status);
+            nanoemMutableMotionModelKeyframeCopy(newKeyframe, keyframe, &m_status);
+            nanoemMutableMotionAddModelKeyframe(m_dest, newKeyframe, frameIndex, &m_status);
+        }
+        nanoemMutableMotionModelKeyframeDestroy(newKeyframe);
+    }
+}
+
+void
+ReferenceMerger::mergeAllMorphKeyframes()
+{
+    nanoem_rsize_t numKeyframes;
+    nanoem_motion_morph_keyframe_t *const *keyframes = nanoemMotionGetAllMorphKeyframeObjects(m_source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+        const nanoem_motion_morph_keyframe_t *keyframe = keyframes[i];
+        const nanoem_frame_index_t frameIndex = frameIndexOf(nanoemMotionMorphKeyframeGetKeyframeObject(keyframe));
+        const nanoem_unicode_string_t *name = nanoemMotionMorphKeyframeGetName(keyframe);
+        nanoem_mutable_motion_morph_keyframe_t *newKeyframe =
+            m_override ? nanoemMutableMotionMorphKeyframeCreateByFound(m_origin, name, frameIndex, &m_status) : nullptr;
+        if (newKeyframe) {
+            nanoemMutableMotionMorphKeyframeCopy(newKeyframe, keyframe);
+        }
+        else if (m_override || !nanoemMotionFindMorphKeyframeObject(m_origin, name, frameIndex)) {
+            newKeyframe = nanoemMutableMotionMorphKeyframeCreate(m_origin, &m_status);
+            nanoemMutableMotionMorphKeyframeCopy(newKeyframe, keyframe);
+            nanoemMutableMotionAddMorphKeyframe(m_dest, newKeyframe, name, frameIndex, &m_status);
+        }
+        nanoemMutableMotionMorphKeyframeDestroy(newKeyframe);
+    }
+}
+
+void
+ReferenceMerger::mergeAllSelfShadowKeyframes()
+{
+    nanoem_rsize_t numKeyframes;
+    nanoem_motion_self_shadow_keyframe_t *const *keyframes =
+        nanoemMotionGetAllSelfShadowKeyframeObjects(m_source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+        const nanoem_motion_self_shadow_keyframe_t *keyframe = keyframes[i];
+        const nanoem_frame_index_t frameIndex =
+            frameIndexOf(nanoemMotionSelfShadowKeyframeGetKeyframeObject(keyframe));
+        nanoem_mutable_motion_self_shadow_keyframe_t *newKeyframe = m_override
+            ? nanoemMutableMotionSelfShadowKeyframeCreateByFound(m_origin, frameIndex, &m_status)
+            : nullptr;
+        if (newKeyframe) {
+            nanoemMutableMotionSelfShadowKeyframeCopy(newKeyframe, keyframe);
+        }
+        else if (m_override || !nanoemMotionFindSelfShadowKeyframeObject(m_origin, frameIndex)) {
+            newKeyframe = nanoemMutableMotionSelfShadowKeyframeCreate(m_origin, &m_status);
+            nanoemMutableMotionSelfShadowKeyframeCopy(newKeyframe, keyframe);
+            nanoemMutableMotionAddSelfShadowKeyframe(m_dest, newKeyframe, frameIndex, &m_status);
+        }
+        nanoemMutableMotionSelfShadowKeyframeDestroy(newKeyframe);
+    }
+}
+
+static void
+writeInt(nanoem_u32_t value, ByteArray &bytes)
+{
+    for (int i = 0; i < 4; i++) {
+        bytes.push_back(nanoem_u8_t((value >> (i * 8)) & 0xff));
+    }
+}
+
+static void
+writeFloat(std::mt19937 &engine, ByteArray &bytes)
+{
+    const nanoem_f32_t value = nanoem_f32_t(engine() % 1000) / 7.0f;
+    nanoem_u32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    writeInt(bits, bytes);
+}
+
+static void
+writeString(const char *value, nanoem_rsize_t size, ByteArray &bytes)
+{
+    const nanoem_rsize_t length = StringUtils::length(value);
+    for (nanoem_rsize_t i = 0; i < size; i++) {
+        bytes.push_back(i < length ? nanoem_u8_t(value[i]) : 0);
+    }
+}
+
+static void
+writeBytes(nanoem_u8_t value, nanoem_rsize_t size, ByteArray &bytes)
+{
+    for (nanoem_rsize_t i = 0; i < size; i++) {
+        bytes.push_back(value);
+    }
+}
+
+/* keyframes are written in random order and the ones at the same frame are kept as VMD allows them */
+static void
+generateMotion(std::mt19937 &engine, nanoem_u32_t maxKeyframes, nanoem_frame_index_t maxFrameIndex, ByteArray &bytes)
+{
+    writeString("Vocaloid Motion Data 0002", 30, bytes);
+    writeString("model", 20, bytes);
+    nanoem_u32_t numKeyframes = engine() % maxKeyframes;
+    writeInt(numKeyframes, bytes);
+    for (nanoem_u32_t i = 0; i < numKeyframes; i++) {
+        writeString(kAllBoneNames[engine() % BX_COUNTOF(kAllBoneNames)], 15, bytes);
+        writeInt(engine() % maxFrameIndex, bytes);
+        for (int j = 0; j < 7; j++) {
+            writeFloat(engine, bytes);
+        }
+        writeBytes(20, 64, bytes);
+    }
+    numKeyframes = engine() % maxKeyframes;
+    writeInt(numKeyframes, bytes);
+    for (nanoem_u32_t i = 0; i < numKeyframes; i++) {
+        writeString(kAllMorphNames[engine() % BX_COUNTOF(kAllMorphNames)], 15, bytes);
+        writeInt(engine() % maxFrameIndex, bytes);
+        writeFloat(engine, bytes);
+    }
+    numKeyframes = engine() % maxKeyframes;
+    writeInt(numKeyframes, bytes);
+    for (nanoem_u32_t i = 0; i < numKeyframes; i++) {
+        writeInt(engine() % maxFrameIndex, bytes);
+        for (int j = 0; j < 7; j++) {
+            writeFloat(engine, bytes);
+        }
+        writeBytes(20, 24, bytes);
+        writeInt(30, bytes);
+        writeBytes(0, 1, bytes);
+    }
+    numKeyframes = engine() % maxKeyframes;
+    writeInt(numKeyframes, bytes);
+    for (nanoem_u32_t i = 0; i < numKeyframes; i++) {
+        writeInt(engine() % maxFrameIndex, bytes);
+        for (int j = 0; j < 6; j++) {
+            writeFloat(engine, bytes);
+        }
+    }
+    numKeyframes = engine() % maxKeyframes;
+    writeInt(numKeyframes, bytes);
+    for (nanoem_u32_t i = 0; i < numKeyframes; i++) {
+        writeInt(engine() % maxFrameIndex, bytes);
+        writeBytes(1, 1, bytes);
+        writeFloat(engine, bytes);
+    }
+    numKeyframes = engine() % maxKeyframes;
+    writeInt(numKeyframes, bytes);
+    for (nanoem_u32_t i = 0; i < numKeyframes; i++) {
+        writeInt(engine() % maxFrameIndex, bytes);
+        writeBytes(nanoem_u8_t(engine() % 2), 1, bytes);
+        writeInt(0, bytes);
+    }
+}
+
+static Motion *
+createMotion(Project *project, const ByteArray &bytes, nanoem_frame_index_t accessoryFrameIndex)
+{
+    Motion *motion = project->createMotion();
+    Error error;
+    motion->setFormat(NANOEM_MOTION_FORMAT_TYPE_VMD);
+    CHECK(motion->load(bytes, 0, error));
+    /* VMD has no accessory keyframes so one of them is added to cover merging accessory keyframes */
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_motion_t *mutableMotion = nanoemMutableMotionCreateAsReference(motion->data(), &status);
+    nanoem_mutable_motion_accessory_keyframe_t *keyframe =
+        nanoemMutableMotionAccessoryKeyframeCreate(motion->data(), &status);
+    nanoemMutableMotionAccessoryKeyframeSetTranslation(
+        keyframe, glm::value_ptr(Vector4(nanoem_f32_t(accessoryFrameIndex), 0, 0, 0)));
+    nanoemMutableMotionAddAccessoryKeyframe(mutableMotion, keyframe, accessoryFrameIndex, &status);
+    nanoemMutableMotionAccessoryKeyframeDestroy(keyframe);
+    nanoemMutableMotionDestroy(mutableMotion);
+    return motion;
+}
+
+static bool
+equalsVector(const nanoem_f32_t *left, const nanoem_f32_t *right)
+{
+    return memcmp(left, right, sizeof(*left) * 4) == 0;
+}
+
+static void
+compareAllTrackKeyframes(const Motion *expected, const Motion *actual)
+{
+    nanoem_rsize_t numExpectedKeyframes, numActualKeyframes;
+    nanoem_motion_bone_keyframe_t *const *boneKeyframes =
+        nanoemMotionGetAllBoneKeyframeObjects(expected->data(), &numExpectedKeyframes);
+    nanoemMotionGetAllBoneKeyframeObjects(actual->data(), &numActualKeyframes);
+    CHECK(numActualKeyframes == numExpectedKeyframes);
+    for (nanoem_rsize_t i = 0; i < numExpectedKeyframes; i++) {
+        const nanoem_unicode_string_t *name = nanoemMotionBoneKeyframeGetName(boneKeyframes[i]);
+        const nanoem_frame_index_t frameIndex =
+            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(boneKeyframes[i]));
+        const nanoem_motion_bone_keyframe_t *left = expected->findBoneKeyframe(name, frameIndex),
+                                            *right = actual->findBoneKeyframe(name, frameIndex);
+        REQUIRE(right);
+        CHECK(equalsVector(
+            nanoemMotionBoneKeyframeGetTranslation(left), nanoemMotionBoneKeyframeGetTranslation(right)));
+        CHECK(equalsVector(
+            nanoemMotionBoneKeyframeGetOrientation(left), nanoemMotionBoneKeyframeGetOrientation(right)));
+    }
+    nanoem_motion_morph_keyframe_t *const *morphKeyframes =
+        nanoemMotionGetAllMorphKeyframeObjects(expected->data(), &numExpectedKeyframes);
+    nanoemMotionGetAllMorphKeyframeObjects(actual->data(), &numActualKeyframes);
+    CHECK(numActualKeyframes == numExpectedKeyframes);
+    for (nanoem_rsize_t i = 0; i < numExpectedKeyframes; i++) {
+        const nanoem_unicode_string_t *name = nanoemMotionMorphKeyframeGetName(morphKeyframes[i]);
+        const nanoem_frame_index_t frameIndex =
+            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionMorphKeyframeGetKeyframeObject(morphKeyframes[i]));
+        const nanoem_motion_morph_keyframe_t *left = expected->findMorphKeyframe(name, frameIndex),
+                                             *right = actual->findMorphKeyframe(name, frameIndex);
+        REQUIRE(right);
+        CHECK(nanoemMotionMorphKeyframeGetWeight(right) == nanoemMotionMorphKeyframeGetWeight(left));
+    }
+}
+
+template <typename TKeyframe, typename TGetAll, typename TGetObject, typename TEquals>
+static void
+compareAllKeyframes(
+    const Motion *expected, const Motion *actual, TGetAll getAllKeyframes, TGetObject getObject, TEquals equals)
+{
+    nanoem_rsize_t numExpectedKeyframes, numActualKeyframes;
+    TKeyframe *const *expectedKeyframes = getAllKeyframes(expected->data(), &numExpectedKeyframes);
+    TKeyframe *const *actualKeyframes = getAllKeyframes(actual->data(), &numActualKeyframes);
+    REQUIRE(numActualKeyframes == numExpectedKeyframes);
+    for (nanoem_rsize_t i = 0; i < numExpectedKeyframes; i++) {
+        const TKeyframe *left = expectedKeyframes[i], *right = actualKeyframes[i];
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(getObject(right)) ==
+            nanoemMotionKeyframeObjectGetFrameIndex(getObject(left)));
+        CHECK(equals(left, right));
+    }
+}
+
+static bool
+equalsAccessoryKeyframe(const nanoem_motion_accessory_keyframe_t *left, const nanoem_motion_accessory_keyframe_t *right)
+{
+    return equalsVector(
+        nanoemMotionAccessoryKeyframeGetTranslation(left), nanoemMotionAccessoryKeyframeGetTranslation(right));
+}
+
+static bool
+equalsCameraKeyframe(const nanoem_motion_camera_keyframe_t *left, const nanoem_motion_camera_keyframe_t *right)
+{
+    return equalsVector(nanoemMotionCameraKeyframeGetLookAt(left), nanoemMotionCameraKeyframeGetLookAt(right)) &&
+        nanoemMotionCameraKeyframeGetDistance(left) == nanoemMotionCameraKeyframeGetDistance(right);
+}
+
+static bool
+equalsLightKeyframe(const nanoem_motion_light_keyframe_t *left, const nanoem_motion_light_keyframe_t *right)
+{
+    return equalsVector(nanoemMotionLightKeyframeGetColor(left), nanoemMotionLightKeyframeGetColor(right)) &&
+        equalsVector(nanoemMotionLightKeyframeGetDirection(left), nanoemMotionLightKeyframeGetDirection(right));
+}
+
+static bool
+equalsModelKeyframe(const nanoem_motion_model_keyframe_t *left, const nanoem_motion_model_keyframe_t *right)
+{
+    return nanoemMotionModelKeyframeIsVisible(left) == nanoemMotionModelKeyframeIsVisible(right);
+}
+
+static bool
+equalsSelfShadowKeyframe(
+    const nanoem_motion_self_shadow_keyframe_t *left, const nanoem_motion_self_shadow_keyframe_t *right)
+{
+    return nanoemMotionSelfShadowKeyframeGetDistance(left) == nanoemMotionSelfShadowKeyframeGetDistance(right);
+}
+
+static void
+compareAllGlobalKeyframes(const Motion *expected, const Motion *actual)
+{
+    compareAllKeyframes<nanoem_motion_accessory_keyframe_t>(expected, actual,
+        nanoemMotionGetAllAccessoryKeyframeObjects, nanoemMotionAccessoryKeyframeGetKeyframeObject,
+        equalsAccessoryKeyframe);
+    compareAllKeyframes<nanoem_motion_camera_keyframe_t>(expected, actual, nanoemMotionGetAllCameraKeyframeObjects,
+        nanoemMotionCameraKeyframeGetKeyframeObject, equalsCameraKeyframe);
+    compareAllKeyframes<nanoem_motion_light_keyframe_t>(expected, actual, nanoemMotionGetAllLightKeyframeObjects,
+        nanoemMotionLightKeyframeGetKeyframeObject, equalsLightKeyframe);
+    compareAllKeyframes<nanoem_motion_model_keyframe_t>(expected, actual, nanoemMotionGetAllModelKeyframeObjects,
+        nanoemMotionModelKeyframeGetKeyframeObject, equalsModelKeyframe);
+    compareAllKeyframes<nanoem_motion_self_shadow_keyframe_t>(expected, actual,
+        nanoemMotionGetAllSelfShadowKeyframeObjects, nanoemMotionSelfShadowKeyframeGetKeyframeObject,
+        equalsSelfShadowKeyframe);
+}
+
+template <typename TKeyframe, typename TGetAll, typename TGetObject>
+static nanoem_rsize_t
+countAllDuplicatedKeyframes(const Motion *motion, TGetAll getAllKeyframes, TGetObject getObject)
+{
+    nanoem_rsize_t numKeyframes, numDuplicates = 0;
+    TKeyframe *const *keyframes = getAllKeyframes(motion->data(), &numKeyframes);
+    for (nanoem_rsize_t i = 1; i < numKeyframes; i++) {
+        const nanoem_frame_index_t previousFrameIndex =
+            nanoemMotionKeyframeObjectGetFrameIndex(getObject(keyframes[i - 1]));
+        const nanoem_frame_index_t frameIndex = nanoemMotionKeyframeObjectGetFrameIndex(getObject(keyframes[i]));
+        CHECK(previousFrameIndex <= frameIndex);
+        numDuplicates += previousFrameIndex == frameIndex;
+    }
+    return numDuplicates;
+}
+
+static nanoem_rsize_t
+countAllDuplicatedGlobalKeyframes(const Motion *motion)
+{
+    return countAllDuplicatedKeyframes<nanoem_motion_accessory_keyframe_t>(
+               motion, nanoemMotionGetAllAccessoryKeyframeObjects, nanoemMotionAccessoryKeyframeGetKeyframeObject) +
+        countAllDuplicatedKeyframes<nanoem_motion_camera_keyframe_t>(
+            motion, nanoemMotionGetAllCameraKeyframeObjects, nanoemMotionCameraKeyframeGetKeyframeObject) +
+        countAllDuplicatedKeyframes<nanoem_motion_light_keyframe_t>(
+            motion, nanoemMotionGetAllLightKeyframeObjects, nanoemMotionLightKeyframeGetKeyframeObject) +
+        countAllDuplicatedKeyframes<nanoem_motion_model_keyframe_t>(
+            motion, nanoemMotionGetAllModelKeyframeObjects, nanoemMotionModelKeyframeGetKeyframeObject) +
+        countAllDuplicatedKeyframes<nanoem_motion_self_shadow_keyframe_t>(
+            motion, nanoemMotionGetAllSelfShadowKeyframeObjects, nanoemMotionSelfShadowKeyframeGetKeyframeObject);
+}
+
+static void
+sortAllKeyframes(Motion *motion)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_motion_t *mutableMotion = nanoemMutableMotionCreateAsReference(motion->data(), &status);
+    nanoemMutableMotionSortAllKeyframes(mutableMotion);
+    nanoemMutableMotionDestroy(mutableMotion);
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("motion_merge_all_keyframes_randomized", "[emapp][motion]")
+{
+    TestScope scope;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    nanoem_unicode_string_factory_t *factory = project->unicodeStringFactory();
+    std::mt19937 engine(42);
+    for (nanoem_u32_t i = 0; i < 300; i++) {
+        const nanoem_u32_t maxKeyframes = 4 + i % 60;
+        const nanoem_frame_index_t maxFrameIndex = 5 + i % 40;
+        ByteArray sourceBytes, destBytes;
+        generateMotion(engine, maxKeyframes, maxFrameIndex, sourceBytes);
+        generateMotion(engine, maxKeyframes, maxFrameIndex, destBytes);
+        const nanoem_frame_index_t offset = engine() % 20, sourceAccessoryFrameIndex = engine() % maxFrameIndex,
+                                   destAccessoryFrameIndex = engine() % maxFrameIndex;
+        for (int mode = 0; mode < 3; mode++) {
+            const bool _override = mode > 0, reverse = mode > 1;
+            Motion *source = createMotion(project, sourceBytes, sourceAccessoryFrameIndex);
+            Motion *expected = createMotion(project, destBytes, destAccessoryFrameIndex);
+            Motion *actual = createMotion(project, destBytes, destAccessoryFrameIndex);
+            const nanoem_rsize_t numDuplicates = countAllDuplicatedGlobalKeyframes(actual);
+            if (_override) {
+                ReferenceMerger merger(source->data(), factory, expected->data(), offset, true);
+                merger.mergeAllKeyframes(reverse);
+                actual->overrideAllKeyframes(source, offset, reverse);
+            }
+            else {
+                ReferenceMerger merger(source->data(), factory, expected->data(), 0, false);
+                merger.mergeAllKeyframes(false);
+                actual->mergeAllKeyframes(source);
+            }
+            compareAllTrackKeyframes(expected, actual);
+            compareAllTrackKeyframes(actual, expected);
+            /*
+             * the previous merger appended global keyframes that binary search over the unsorted keyframes missed
+             * and kept them unsorted so the result is compared after sorting only when it has no duplicates
+             */
+            sortAllKeyframes(expected);
+            CHECK(countAllDuplicatedGlobalKeyframes(actual) == numDuplicates);
+            if (countAllDuplicatedGlobalKeyframes(expected) == 0) {
+                compareAllGlobalKeyframes(expected, actual);
+            }
+            project->destroyMotion(actual);
+            project->destroyMotion(expected);
+            project->destroyMotion(source);
+        }
+    }
+}
@@ -144,6 +144,66 @@ TEST_CASE("project_copy_paste_bone_parameters", "[emapp][project]")
     }
 }
 
+TEST_CASE("project_copy_paste_bone_parameters_between_models", "[emapp][project]")
+{
+    TestScope scope;
+    Error error;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    Model *sourceModel = first->createModel(), *destModel = first->createModel();
+    project->addModel(sourceModel);
+    project->addModel(destModel);
+    project->setActiveModel(sourceModel);
+    StringScope ls(kLeftWristBoneName, project), rs(kRightWristBoneName, project);
+    const nanoem_model_bone_t *sourceBonePtr = sourceModel->findBone(ls.m_value);
+    model::Bone *sourceBone = model::Bone::cast(sourceBonePtr);
+    sourceBone->setLocalUserTranslation(Vector3(1, 2, 3));
+    sourceBone->setLocalUserOrientation(Quaternion(0.1f, 0.2f, 0.3f, 0.4f));
+    sourceModel->selection()->addBone(sourceBonePtr);
+    SECTION("paste")
+    {
+        project->copyAllSelectedBones(sourceModel, error);
+        CHECK_FALSE(error.hasReason());
+        CHECK_FALSE(project->isModelClipboardEmpty());
+        /* bones are resolved by name so the clipboard can be pasted to the other model */
+        project->pasteAllSelectedBones(destModel, error);
+        CHECK_FALSE(error.hasReason());
+        model::Bone *destBone = model::Bone::cast(destModel->findBone(ls.m_value));
+        CHECK(destBone->localUserTranslation() == Vector3(1, 2, 3));
+        CHECK(destBone->localUserOrientation() == Quaternion(0.1f, 0.2f, 0.3f, 0.4f));
+        CHECK(model::Bone::cast(destModel->findBone(rs.m_value))->localUserTranslation() == Constants::kZeroV3);
+        CHECK_FALSE(scope.hasAnyError());
+    }
+    SECTION("paste with reverse")
+    {
+        project->copyAllSelectedBones(sourceModel, error);
+        CHECK_FALSE(error.hasReason());
+        project->symmetricPasteAllSelectedBones(destModel, error);
+        CHECK_FALSE(error.hasReason());
+        model::Bone *destBone = model::Bone::cast(destModel->findBone(rs.m_value));
+        CHECK(destBone->localUserTranslation() == Vector3(-1, 2, 3));
+        CHECK(destBone->localUserOrientation() == Quaternion(0.1f, 0.2f, -0.3f, -0.4f));
+        CHECK(model::Bone::cast(destModel->findBone(ls.m_value))->localUserTranslation() == Constants::kZeroV3);
+        CHECK_FALSE(scope.hasAnyError());
+    }
+    SECTION("copy without selected bones")
+    {
+        sourceModel->selection()->removeAllBones();
+        project->copyAllSelectedBones(sourceModel, error);
+        CHECK(error.hasReason());
+        CHECK(project->isModelClipboardEmpty());
+    }
+    SECTION("paste to the model without copied bones")
+    {
+        Model *skinnedModel = first->createSkinnedModel();
+        project->addModel(skinnedModel);
+        project->copyAllSelectedBones(sourceModel, error);
+        CHECK_FALSE(error.hasReason());
+        project->pasteAllSelectedBones(skinnedModel, error);
+        CHECK(error.hasReason());
+    }
+}
+
 TEST_CASE("project_copy_paste_bone_parameters_redo", "[emapp][project]")
 {
     TestScope scope;
@@ -444,3 +444,36 @@ TEST_CASE("project_copy_paste_motion_keyframes_redo", "[emapp][project]")
         CHECK_FALSE(scope.hasAnyError());
     }
 }
+
+TEST_CASE("project_paste_motion_keyframes_repeatedly", "[emapp][project]")
+{
+    TestScope scope;
+    Error error;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    CommandRegistrator registrator(project);
+    for (auto it : kKeyframeIndexRegistrationOrder) {
+        project->seek(it, true);
+        registrator.registerAddCameraKeyframesCommandByCurrentLocalFrameIndex();
+    }
+    project->setSelectedTrack(project->allTracks()->data()[0]);
+    project->selectAllMotionKeyframesIn(createSegment());
+    project->copyAllSelectedKeyframes(error);
+    CHECK_FALSE(error.hasReason());
+    /* pasting must not move keyframes in the clipboard */
+    project->pasteAllSelectedKeyframes(2672, error);
+    project->pasteAllSelectedKeyframes(4000, error);
+    CHECK_FALSE(error.hasReason());
+    CHECK_FALSE(project->isMotionClipboardEmpty());
+    Motion *motion = project->cameraMotion();
+    CHECK(motion->findCameraKeyframe(2672));
+    CHECK(motion->findCameraKeyframe(2674));
+    CHECK_FALSE(motion->findCameraKeyframe(3999));
+    CHECK(motion->findCameraKeyframe(4000));
+    CHECK(motion->findCameraKeyframe(4002));
+    CHECK_FALSE(motion->findCameraKeyframe(4003));
+    CHECK(motion->duration() == 4002);
+    project->clearMotionClipboard();
+    CHECK(project->isMotionClipboardEmpty());
+    CHECK_FALSE(scope.hasAnyError());
+}
@@ -0,0 +1,116 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Accessory.h"
+#include "emapp/Effect.h"
+#include "emapp/Model.h"
+#include "emapp/Progress.h"
+#include "emapp/effect/GlobalUniform.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static nanoem_f32_t
+extractControlObjectValue(Project *project, Model *owner, Effect *effect, IPass *pass, const char *name)
+{
+    /* parameter blocks are retained until the end of the frame */
+    effect->globalUniform()->endFrame();
+    pass->setAllModelParameters(owner, project);
+    Effect::PassUniformBufferMap passUniformBuffer;
+    effect->getPassUniformBuffer(passUniformBuffer);
+    const Effect::NamedByteArrayMap &uniformBuffer = passUniformBuffer["P"];
+    Effect::NamedByteArrayMap::const_iterator it = uniformBuffer.find(name);
+    return it != uniformBuffer.end() ? *reinterpret_cast<const nanoem_f32_t *>(it->second.data()) : FLT_MAX;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("project_object_binding_generation", "[emapp][project]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    nanoem_u32_t generation = project->objectBindingGeneration();
+    CHECK(generation != 0);
+    Model *model = o->createModel();
+    generation = project->objectBindingGeneration();
+    project->addModel(model);
+    CHECK(project->objectBindingGeneration() != generation);
+    generation = project->objectBindingGeneration();
+    Accessory *accessory = o->createAccessory();
+    project->addAccessory(accessory);
+    CHECK(project->objectBindingGeneration() != generation);
+    generation = project->objectBindingGeneration();
+    /* transforming drawables must not invalidate resolved bindings */
+    accessory->setTranslation(Vector3(1, 2, 3));
+    model->performAllBonesTransform();
+    CHECK(project->objectBindingGeneration() == generation);
+    model->setFileURI(URI::createFromFilePath("/path/to/renamed.pmx"));
+    CHECK(project->objectBindingGeneration() != generation);
+    generation = project->objectBindingGeneration();
+    model->removeBoneReference(String("no_such_bone"));
+    CHECK(project->objectBindingGeneration() == generation);
+    project->removeAccessory(accessory);
+    CHECK(project->objectBindingGeneration() != generation);
+    generation = project->objectBindingGeneration();
+    project->removeModel(model);
+    CHECK(project->objectBindingGeneration() != generation);
+    project->destroyAccessory(accessory);
+    project->destroyModel(model);
+}
+
+TEST_CASE("project_object_binding_generation_control_object_values", "[emapp][project]")
+{
+    TestScope scope;
+    ProjectPtr o = scope.createProject();
+    Project *project = o->m_project;
+    Model *owner = o->createModel();
+    project->addModel(owner);
+    Effect *effect = o->createSourceEffect(owner, "effects/parameters/controlobjects/binding.fx", true);
+    Progress progress(project, 0);
+    Error error;
+    effect->upload(effect::kAttachmentTypeNone, progress, error);
+    nanoem_rsize_t numMaterials;
+    nanoem_model_material_t *const *materials = nanoemModelGetAllMaterialObjects(owner->data(), &numMaterials);
+    ITechnique *technique = effect->findTechnique(Effect::kPassTypeObject, materials[0], 0, numMaterials, owner);
+    REQUIRE(technique);
+    IPass *pass = technique->execute(owner, false);
+    REQUIRE(pass);
+    CHECK(extractControlObjectValue(project, owner, effect, pass, "target_model_visible") == 0.0f);
+    CHECK(extractControlObjectValue(project, owner, effect, pass, "target_accessory_visible") == 0.0f);
+    SECTION("model")
+    {
+        Model *model = o->createModel();
+        model->setFileURI(URI::createFromFilePath("/path/to/target.pmx"));
+        project->addModel(model);
+        CHECK(extractControlObjectValue(project, owner, effect, pass, "target_model_visible") == 1.0f);
+        model->setFileURI(URI::createFromFilePath("/path/to/renamed.pmx"));
+        CHECK(extractControlObjectValue(project, owner, effect, pass, "target_model_visible") == 0.0f);
+        model->setFileURI(URI::createFromFilePath("/path/to/target.pmx"));
+        CHECK(extractControlObjectValue(project, owner, effect, pass, "target_model_visible") == 1.0f);
+        project->removeModel(model);
+        CHECK(extractControlObjectValue(project, owner, effect, pass, "target_model_visible") == 0.0f);
+        project->destroyModel(model);
+    }
+    SECTION("accessory")
+    {
+        Accessory *accessory = o->createAccessory();
+        accessory->setFileURI(URI::createFromFilePath("/path/to/target.x"));
+        project->addAccessory(accessory);
+        CHECK(extractControlObjectValue(project, owner, effect, pass, "target_accessory_visible") == 1.0f);
+        accessory->setFileURI(URI::createFromFilePath("/path/to/renamed.x"));
+        CHECK(extractControlObjectValue(project, owner, effect, pass, "target_accessory_visible") == 0.0f);
+        accessory->setFileURI(URI::createFromFilePath("/path/to/target.x"));
+        CHECK(extractControlObjectValue(project, owner, effect, pass, "target_accessory_visible") == 1.0f);
+        project->removeAccessory(accessory);
+        CHECK(extractControlObjectValue(project, owner, effect, pass, "target_accessory_visible") == 0.0f);
+        project->destroyAccessory(accessory);
+    }
+}
@@ -0,0 +1,124 @@
+/*
+   Copyright (c) 2015-2023 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Effect.h"
+#include "emapp/Model.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static const Project::OffscreenRenderTargetPlan::Item *
+findPlanItem(Project *project, Effect *ownerEffect, const IDrawable *drawable, int &index)
+{
+    const Project::OffscreenRenderTargetPlanList &plans = project->resolveOffscreenRenderTargetPlans(ownerEffect);
+    for (Project::OffscreenRenderTargetPlanList::const_iterator it = plans.begin(), end = plans.end(); it != end;
+         ++it) {
+        const Project::OffscreenRenderTargetPlan::ItemList &items = it->m_items;
+        for (Project::OffscreenRenderTargetPlan::ItemList::const_iterator it2 = items.begin(), end2 = items.end();
+             it2 != end2; ++it2) {
+            if (it2->m_drawable == drawable) {
+                index = int(it2 - items.begin());
+                return it2;
+            }
+        }
+    }
+    index = -1;
+    return nullptr;
+}
+
+static int
+findPlanItemIndex(Project *project, Effect *ownerEffect, const IDrawable *drawable)
+{
+    int index;
+    findPlanItem(project, ownerEffect, drawable, index);
+    return index;
+}
+
+static const IEffect *
+findPlanPassiveEffect(Project *project, Effect *ownerEffect, const IDrawable *drawable)
+{
+    int index;
+    const Project::OffscreenRenderTargetPlan::Item *item = findPlanItem(project, ownerEffect, drawable, index);
+    return item ? item->m_passiveEffect : nullptr;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("project_offscreen_render_target_plans_rebuild_after_changes", "[emapp][project]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        Project *project = o->m_project;
+        Model *owner = o->createModel("effects/offscreen.pmx");
+        Effect *ownerEffect = o->createSourceEffect(owner, "effects/offscreen.fx");
+        REQUIRE(ownerEffect);
+        project->addModel(owner);
+        const Project::OffscreenRenderTargetPlanList &plans = project->resolveOffscreenRenderTargetPlans(ownerEffect);
+        REQUIRE_FALSE(plans.empty());
+        const String name(plans[0].m_option.m_name);
+        Model *other = o->createModel();
+        Effect *otherEffect = o->createSourceEffect(other, "effects/main.fx");
+        REQUIRE(otherEffect);
+        project->addModel(other);
+        project->setOffscreenPassiveRenderTargetEffect(name, other, otherEffect);
+        other->setOffscreenPassiveRenderTargetEffectEnabled(name, true);
+        /* assigned before adding since the default effect of the owner may not be loadable */
+        Model *model = o->createModel();
+        Effect *passiveEffect = o->createSourceEffect(model, "effects/main.fx");
+        REQUIRE(passiveEffect);
+        model->setOffscreenPassiveRenderTargetEffect(name, passiveEffect);
+        model->setOffscreenPassiveRenderTargetEffectEnabled(name, true);
+        CHECK(findPlanItemIndex(project, ownerEffect, other) >= 0);
+        CHECK(findPlanItemIndex(project, ownerEffect, model) == -1);
+        SECTION("adding and removing the drawable")
+        {
+            project->addModel(model);
+            CHECK(findPlanItemIndex(project, ownerEffect, model) >= 0);
+            project->removeModel(model);
+            CHECK(findPlanItemIndex(project, ownerEffect, model) == -1);
+            CHECK(findPlanItemIndex(project, ownerEffect, other) >= 0);
+            project->destroyModel(model);
+        }
+        SECTION("reordering drawables")
+        {
+            project->addModel(model);
+            CHECK(findPlanItemIndex(project, ownerEffect, other) < findPlanItemIndex(project, ownerEffect, model));
+            const Project::DrawableList *drawables = project->drawableOrderList();
+            Project::DrawableList reversed;
+            for (nanoem_rsize_t i = drawables->size(); i > 0; i--) {
+                reversed.push_back((*drawables)[i - 1]);
+            }
+            project->setDrawableOrderList(reversed);
+            CHECK(findPlanItemIndex(project, ownerEffect, model) < findPlanItemIndex(project, ownerEffect, other));
+        }
+        SECTION("changing the passive effect assignment")
+        {
+            project->addModel(model);
+            CHECK(findPlanItemIndex(project, ownerEffect, model) >= 0);
+            project->setOffscreenPassiveRenderTargetEffect(name, model, otherEffect);
+            CHECK(findPlanPassiveEffect(project, ownerEffect, model) == otherEffect);
+            model->setOffscreenPassiveRenderTargetEffectEnabled(name, false);
+            CHECK(findPlanItemIndex(project, ownerEffect, model) == -1);
+            model->setOffscreenPassiveRenderTargetEffectEnabled(name, true);
+            CHECK(findPlanPassiveEffect(project, ownerEffect, model) == otherEffect);
+        }
+        SECTION("restoring the state after adding the drawable")
+        {
+            Project::SaveState *state = nullptr;
+            project->saveState(state);
+            project->addModel(model);
+            /* restoring the state must not discard pending invalidation of the plans */
+            project->restoreState(state, false);
+            project->destroyState(state);
+            CHECK(findPlanItemIndex(project, ownerEffect, model) >= 0);
+        }
+    }
+}
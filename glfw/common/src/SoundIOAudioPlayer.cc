@@ -60,7 +60,7 @@ SoundIOAudioPlayer::loadAllLinearPCMSamples(const nanoem_u8_t *data, size_t size
     destroySoundIOContext();
     if (createSoundIOContext(error)) {
         m_loaded = true;
-        m_linearPCMSamples.assign(data, data + size);
+        assignLinearPCMSamples(data, size);
         m_currentRational.m_denominator = m_description.m_formatData.m_sampleRate;
         m_durationRational.m_numerator = size;
         m_durationRational.m_denominator = m_description.m_formatData.m_bytesPerSecond;
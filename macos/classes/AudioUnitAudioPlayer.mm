@@ -94,7 +94,7 @@ AudioUnitAudioPlayer::loadAllLinearPCMSamples(const nanoem_u8_t *data, size_t si
     wrapCall(AudioUnitInitialize(m_outputUnit), error);
     m_offset = 0;
     m_loaded = true;
-    m_linearPCMSamples.assign(data, data + size);
+    assignLinearPCMSamples(data, size);
     return !error.hasReason();
 }
 
@@ -11,19 +11,51 @@
 #include <unicode/ucnv.h>
 #include <unicode/ustring.h>
 
-struct nanoem_unicode_factory_opaque_data_icu_t {
-    UConverter *cp932;
-    UConverter *utf8;
-    UConverter *utf16;
-};
+#if defined(_WIN32)
+#include <windows.h>
+typedef SRWLOCK nanoem_unicode_string_icu_lock_t;
+#define nanoem_unicode_string_icu_lock_init(lock) InitializeSRWLock((lock))
+#define nanoem_unicode_string_icu_lock_destroy(lock) ((void) (lock))
+#define nanoem_unicode_string_icu_lock_acquire(lock) AcquireSRWLockExclusive((lock))
+#define nanoem_unicode_string_icu_lock_release(lock) ReleaseSRWLockExclusive((lock))
+#else
+#include <pthread.h>
+typedef pthread_mutex_t nanoem_unicode_string_icu_lock_t;
+#define nanoem_unicode_string_icu_lock_init(lock) pthread_mutex_init((lock), NULL)
+#define nanoem_unicode_string_icu_lock_destroy(lock) pthread_mutex_destroy((lock))
+#define nanoem_unicode_string_icu_lock_acquire(lock) pthread_mutex_lock((lock))
+#define nanoem_unicode_string_icu_lock_release(lock) pthread_mutex_unlock((lock))
+#endif
+
+/* strings up to this length are decoded on stack and not allocated when already interned */
+#define NANOEM_UNICODE_STRING_ICU_STACK_CAPACITY 256
 
 struct nanoem_unicode_string_icu_t {
     UChar *data;
     int length;
+    int num_references;
+    nanoem_u32_t hash;
+    /* caches are built once per codec and kept until the string is destroyed as the pointers are handed out */
     struct nanoem_unicode_string_icu_cache_t {
         nanoem_u8_t *data;
         nanoem_rsize_t length;
-    } cache;
+    } caches[NANOEM_CODEC_TYPE_MAX_ENUM];
+};
+
+#define nanoem_unicode_string_icu_hash_func(a) ((a)->hash)
+#define nanoem_unicode_string_icu_hash_equal(a, b) ((a)->hash == (b)->hash && (a)->length == (b)->length && memcmp((a)->data, (b)->data, (a)->length * sizeof(*(a)->data)) == 0)
+KHASH_INIT(unicode_string_icu, nanoem_unicode_string_icu_t *, char, 0, nanoem_unicode_string_icu_hash_func, nanoem_unicode_string_icu_hash_equal)
+
+/*
+ * interned strings may be released from the other thread so the table, the reference counts and the caches are
+ * guarded, but converters are not thread safe and conversions from/to strings must be done by one thread at a time
+ */
+struct nanoem_unicode_factory_opaque_data_icu_t {
+    UConverter *cp932;
+    UConverter *utf8;
+    UConverter *utf16;
+    kh_unicode_string_icu_t *strings;
+    nanoem_unicode_string_icu_lock_t lock;
 };
 
 //-----------------------------------------------------------------------------
@@ -100,16 +132,61 @@ MurmurHash(const void *key, int len, unsigned int seed)
 }
 
 static nanoem_unicode_string_icu_t *
-nanoemUnicodeStringFactoryFromStringICU(UConverter *converter, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
+nanoemUnicodeStringFactoryInternStringICU(nanoem_unicode_factory_opaque_data_icu_t *opaque, const UChar *data, int length, nanoem_status_t *status)
+{
+    kh_unicode_string_icu_t *strings = opaque->strings;
+    nanoem_unicode_string_icu_t key, *s = NULL;
+    khiter_t it;
+    int ret;
+    key.data = (UChar *) data;
+    key.length = length;
+    key.hash = MurmurHash(data, length * sizeof(*data), 0);
+    nanoem_unicode_string_icu_lock_acquire(&opaque->lock);
+    it = kh_get_unicode_string_icu(strings, &key);
+    if (it != kh_end(strings)) {
+        s = kh_key(strings, it);
+        s->num_references++;
+    }
+    else {
+        s = (nanoem_unicode_string_icu_t *) nanoem_calloc(1, sizeof(*s), status);
+        if (nanoem_is_not_null(s)) {
+            s->data = (UChar *) nanoem_calloc(length + 1, sizeof(*s->data), status);
+            if (nanoem_is_not_null(s->data)) {
+                memcpy(s->data, data, length * sizeof(*data));
+                s->length = length;
+                s->hash = key.hash;
+                s->num_references = 1;
+                kh_put_unicode_string_icu(strings, s, &ret);
+            }
+            else {
+                nanoem_free(s);
+                s = NULL;
+            }
+        }
+    }
+    nanoem_unicode_string_icu_lock_release(&opaque->lock);
+    return s;
+}
+
+static nanoem_unicode_string_icu_t *
+nanoemUnicodeStringFactoryFromStringICU(nanoem_unicode_factory_opaque_data_icu_t *opaque, UConverter *converter, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
 {
-    nanoem_unicode_string_icu_t *s;
+    nanoem_unicode_string_icu_t *s = NULL;
+    UChar stack_buffer[NANOEM_UNICODE_STRING_ICU_STACK_CAPACITY], *data = stack_buffer;
     UErrorCode code = U_ZERO_ERROR;
-    int capacity = length * ucnv_getMinCharSize(converter) + 1;
-    s = (nanoem_unicode_string_icu_t *) nanoem_calloc(1, sizeof(*s), status);
-    if (nanoem_is_not_null(s)) {
-        s->data = (UChar *) nanoem_calloc(capacity, sizeof(*s->data), status);
-        s->length = ucnv_toUChars(converter, s->data, capacity, (const char *) string, length, &code);
-        nanoem_status_ptr_assign(status, U_SUCCESS(code) ? NANOEM_STATUS_SUCCESS : NANOEM_STATUS_ERROR_DECODE_UNICODE_STRING_FAILED);
+    int capacity = length * ucnv_getMinCharSize(converter) + 1, actual_length;
+    if (capacity > NANOEM_UNICODE_STRING_ICU_STACK_CAPACITY) {
+        data = (UChar *) nanoem_calloc(capacity, sizeof(*data), status);
+    }
+    if (nanoem_is_not_null(data)) {
+        actual_length = ucnv_toUChars(converter, data, capacity, (const char *) string, length, &code);
+        s = nanoemUnicodeStringFactoryInternStringICU(opaque, data, U_SUCCESS(code) ? actual_length : 0, status);
+        if (data != stack_buffer) {
+            nanoem_free(data);
+        }
+        if (nanoem_is_not_null(s)) {
+            nanoem_status_ptr_assign(status, U_SUCCESS(code) ? NANOEM_STATUS_SUCCESS : NANOEM_STATUS_ERROR_DECODE_UNICODE_STRING_FAILED);
+        }
     }
     return s;
 }
@@ -145,21 +222,21 @@ static nanoem_unicode_string_t *
 nanoemUnicodeStringFactoryFromCp932CallbackICU(void *opaque, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
 {
     nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
-    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data->cp932, string, length, status);
+    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data, data->cp932, string, length, status);
 }
 
 static nanoem_unicode_string_t *
 nanoemUnicodeStringFactoryFromUtf8CallbackICU(void *opaque, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
 {
     nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
-    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data->utf8, string, length, status);
+    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data, data->utf8, string, length, status);
 }
 
 static nanoem_unicode_string_t *
 nanoemUnicodeStringFactoryFromUtf16CallbackICU(void *opaque, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
 {
     nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
-    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data->utf16, string, length, status);
+    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data, data->utf16, string, length, status);
 }
 
 static nanoem_u8_t *
@@ -187,7 +264,7 @@ static nanoem_i32_t
 nanoemUnicodeStringFactoryHashCallbackICU(void *opaque, const nanoem_unicode_string_t *string)
 {
     const nanoem_unicode_string_icu_t *s = (const nanoem_unicode_string_icu_t *) string;
-    nanoem_i32_t hash = s ? (nanoem_i32_t) MurmurHash(s->data, u_strlen(s->data) * sizeof(*s->data), 0) : -1;
+    nanoem_i32_t hash = s ? (nanoem_i32_t) s->hash : -1;
     nanoem_mark_unused(opaque);
     return hash;
 }
@@ -198,59 +275,95 @@ nanoemUnicodeStringFactoryCompareCallbackICU(void *opaque, const nanoem_unicode_
     const nanoem_unicode_string_icu_t *lvalue = (const nanoem_unicode_string_icu_t *) left,
                                       *rvalue = (const nanoem_unicode_string_icu_t *) right;
     nanoem_mark_unused(opaque);
-    return nanoem_is_not_null(lvalue) && nanoem_is_not_null(rvalue) ? u_strcmp(lvalue->data, rvalue->data) : -1;
+    if (nanoem_is_not_null(lvalue) && nanoem_is_not_null(rvalue)) {
+        /* interned strings are unique so the same contents always share the same instance */
+        return lvalue != rvalue ? u_strcmp(lvalue->data, rvalue->data) : 0;
+    }
+    return -1;
 }
 
 static const nanoem_u8_t *
 nanoemUnicodeStringFactoryGetCacheCallbackICU(void *opaque, const nanoem_unicode_string_t *string, nanoem_rsize_t *length, nanoem_codec_type_t codec, nanoem_status_t *status)
 {
+    nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
     const nanoem_unicode_string_icu_t *s = (const nanoem_unicode_string_icu_t *) string;
-    nanoem_mark_unused(opaque);
-    nanoem_mark_unused(codec);
-    if (s->cache.data) {
-        *length = s->cache.length;
-        nanoem_status_ptr_assign(status, NANOEM_STATUS_SUCCESS);
+    const nanoem_u8_t *cache = NULL;
+    if (codec >= NANOEM_CODEC_TYPE_FIRST_ENUM && codec < NANOEM_CODEC_TYPE_MAX_ENUM) {
+        nanoem_unicode_string_icu_lock_acquire(&data->lock);
+        cache = s->caches[codec].data;
+        if (cache) {
+            *length = s->caches[codec].length;
+        }
+        nanoem_unicode_string_icu_lock_release(&data->lock);
+    }
+    if (cache) {
+        nanoem_status_ptr_assign_succeeded(status);
     }
     else {
-        nanoem_status_ptr_assign(status, NANOEM_STATUS_ERROR_NULL_OBJECT);
+        nanoem_status_ptr_assign_null_object(status);
     }
-    return s->cache.data;
+    return cache;
 }
 
 static void
 nanoemUnicodeStringFactorySetCacheCallbackICU(void *opaque, nanoem_unicode_string_t *string, nanoem_rsize_t *length, nanoem_codec_type_t codec, nanoem_status_t *status)
 {
+    nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
     nanoem_unicode_string_icu_t *s = (nanoem_unicode_string_icu_t *) string;
-    nanoem_mark_unused(opaque);
-    if (s->cache.data) {
-        nanoem_free(s->cache.data);
-        s->cache.data = NULL;
-        s->cache.length = 0;
+    struct nanoem_unicode_string_icu_cache_t *cache;
+    if (codec < NANOEM_CODEC_TYPE_FIRST_ENUM || codec >= NANOEM_CODEC_TYPE_MAX_ENUM) {
+        nanoem_status_ptr_assign_null_object(status);
+        return;
     }
-    switch (codec) {
-    case NANOEM_CODEC_TYPE_SJIS:
-        s->cache.data = nanoemUnicodeStringFactoryToCp932CallbackICU(opaque, string, &s->cache.length, status);
-        break;
-    case NANOEM_CODEC_TYPE_UTF8:
-        s->cache.data = nanoemUnicodeStringFactoryToUtf8CallbackICU(opaque, string, &s->cache.length, status);
-        break;
-    case NANOEM_CODEC_TYPE_UTF16:
-        s->cache.data = nanoemUnicodeStringFactoryToUtf16CallbackICU(opaque, string, &s->cache.length, status);
-        break;
-    default:
-        break;
+    cache = &s->caches[codec];
+    nanoem_unicode_string_icu_lock_acquire(&data->lock);
+    if (cache->data) {
+        /* an interned string is shared so the cache may already be built by the other owner */
+        nanoem_status_ptr_assign_succeeded(status);
+    }
+    else {
+        switch (codec) {
+        case NANOEM_CODEC_TYPE_SJIS:
+            cache->data = nanoemUnicodeStringFactoryToCp932CallbackICU(opaque, string, &cache->length, status);
+            break;
+        case NANOEM_CODEC_TYPE_UTF8:
+            cache->data = nanoemUnicodeStringFactoryToUtf8CallbackICU(opaque, string, &cache->length, status);
+            break;
+        case NANOEM_CODEC_TYPE_UTF16:
+            cache->data = nanoemUnicodeStringFactoryToUtf16CallbackICU(opaque, string, &cache->length, status);
+            break;
+        default:
+            break;
+        }
     }
-    *length = s->cache.length;
+    *length = cache->length;
+    nanoem_unicode_string_icu_lock_release(&data->lock);
 }
 
 static void
 nanoemUnicodeStringFactoryDestroyStringCallbackICU(void *opaque, nanoem_unicode_string_t *string)
 {
+    nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
     nanoem_unicode_string_icu_t *s = (nanoem_unicode_string_icu_t *) string;
-    nanoem_mark_unused(opaque);
+    khiter_t it;
+    int i;
+    nanoem_bool_t unreferenced = nanoem_false;
     if (s) {
+        nanoem_unicode_string_icu_lock_acquire(&data->lock);
+        if (--s->num_references <= 0) {
+            it = kh_get_unicode_string_icu(data->strings, s);
+            if (it != kh_end(data->strings) && kh_key(data->strings, it) == s) {
+                kh_del_unicode_string_icu(data->strings, it);
+            }
+            unreferenced = nanoem_true;
+        }
+        nanoem_unicode_string_icu_lock_release(&data->lock);
+    }
+    if (unreferenced) {
+        for (i = NANOEM_CODEC_TYPE_FIRST_ENUM; i < NANOEM_CODEC_TYPE_MAX_ENUM; i++) {
+            nanoem_free(s->caches[i].data);
+        }
         nanoem_free(s->data);
-        nanoem_free(s->cache.data);
         nanoem_free(s);
     }
 }
@@ -275,6 +388,8 @@ nanoemUnicodeStringFactoryCreateICU(nanoem_status_t *status)
         opaque->cp932 = ucnv_open("ibm-943_P15A-2003", &code);
         opaque->utf8 = ucnv_open("utf8", &code);
         opaque->utf16 = ucnv_open("utf16le", &code);
+        opaque->strings = kh_init_unicode_string_icu();
+        nanoem_unicode_string_icu_lock_init(&opaque->lock);
         if (U_SUCCESS(code)) {
             factory = nanoemUnicodeStringFactoryCreate(status);
             nanoemUnicodeStringFactorySetGetCacheCallback(factory, nanoemUnicodeStringFactoryGetCacheCallbackICU);
@@ -292,6 +407,8 @@ nanoemUnicodeStringFactoryCreateICU(nanoem_status_t *status)
             nanoemUnicodeStringFactorySetOpaqueData(factory, opaque);
         }
         else {
+            kh_destroy_unicode_string_icu(opaque->strings);
+            nanoem_unicode_string_icu_lock_destroy(&opaque->lock);
             nanoem_free(opaque);
             nanoem_status_ptr_assign_null_object(status);
         }
@@ -309,6 +426,9 @@ nanoemUnicodeStringFactoryDestroyICU(nanoem_unicode_string_factory_t *factory)
         ucnv_close(opaque->utf8);
         ucnv_close(opaque->utf16);
         ucnv_flushCache();
+        /* strings still referenced are owned by their holders like before and only detached from the table */
+        kh_destroy_unicode_string_icu(opaque->strings);
+        nanoem_unicode_string_icu_lock_destroy(&opaque->lock);
         nanoem_free(opaque);
     }
     nanoemUnicodeStringFactoryDestroy(factory);
@@ -14,13 +14,29 @@
 static const UINT NANOEM_MBSC_CP_SJIS = 932;
 static const UINT NANOEM_MBSC_CP_UTF8 = CP_UTF8;
 
+/* strings up to this length are decoded on stack and not allocated when already interned */
+#define NANOEM_UNICODE_STRING_MBWC_STACK_CAPACITY 256
+
 struct nanoem_unicode_string_mbwc_t {
     wchar_t *data;
     int length;
+    int num_references;
+    nanoem_u32_t hash;
+    /* caches are built once per codec and kept until the string is destroyed as the pointers are handed out */
     struct nanoem_unicode_string_mbwc_cache_t {
         nanoem_u8_t *data;
         nanoem_rsize_t length;
-    } cache;
+    } caches[NANOEM_CODEC_TYPE_MAX_ENUM];
+};
+
+#define nanoem_unicode_string_mbwc_hash_func(a) ((a)->hash)
+#define nanoem_unicode_string_mbwc_hash_equal(a, b) ((a)->hash == (b)->hash && (a)->length == (b)->length && memcmp((a)->data, (b)->data, (a)->length * sizeof(*(a)->data)) == 0)
+KHASH_INIT(unicode_string_mbwc, nanoem_unicode_string_mbwc_t *, char, 0, nanoem_unicode_string_mbwc_hash_func, nanoem_unicode_string_mbwc_hash_equal)
+
+/* interned strings are shared between threads so the table, the reference counts and the caches are guarded */
+struct nanoem_unicode_factory_opaque_data_mbwc_t {
+    kh_unicode_string_mbwc_t *strings;
+    SRWLOCK lock;
 };
 
 //-----------------------------------------------------------------------------
@@ -92,15 +108,61 @@ MurmurHash(const void *key, int len, unsigned int seed)
 }
 
 static nanoem_unicode_string_mbwc_t *
-nanoemUnicodeStringFactoryFromStringMBWC(const nanoem_u8_t *string, nanoem_rsize_t length, UINT codepage, nanoem_status_t *status)
+nanoemUnicodeStringFactoryInternStringMBWC(void *opaque, const wchar_t *data, int length, nanoem_status_t *status)
 {
-    nanoem_unicode_string_mbwc_t *s;
-    int capacity = MultiByteToWideChar(codepage, 0, (const char *) string, (int) length, NULL, 0);
-    s = (nanoem_unicode_string_mbwc_t *) nanoem_calloc(1, sizeof(*s), status);
-    if (nanoem_is_not_null(s)) {
-        s->data = (wchar_t *) nanoem_calloc(capacity + 1, sizeof(*s->data), status);
-        s->length = MultiByteToWideChar(codepage, 0, (const char *) string, (int) length, s->data, capacity);
-        nanoem_status_ptr_assign(status, s->length != 0 || GetLastError() != 0 ? NANOEM_STATUS_SUCCESS : NANOEM_STATUS_ERROR_DECODE_UNICODE_STRING_FAILED);
+    nanoem_unicode_factory_opaque_data_mbwc_t *opaque_data = (nanoem_unicode_factory_opaque_data_mbwc_t *) opaque;
+    kh_unicode_string_mbwc_t *strings = opaque_data->strings;
+    nanoem_unicode_string_mbwc_t key, *s = NULL;
+    khiter_t it;
+    int ret;
+    key.data = (wchar_t *) data;
+    key.length = length;
+    key.hash = MurmurHash(data, length * sizeof(*data), 0);
+    AcquireSRWLockExclusive(&opaque_data->lock);
+    it = kh_get_unicode_string_mbwc(strings, &key);
+    if (it != kh_end(strings)) {
+        s = kh_key(strings, it);
+        s->num_references++;
+    }
+    else {
+        s = (nanoem_unicode_string_mbwc_t *) nanoem_calloc(1, sizeof(*s), status);
+        if (nanoem_is_not_null(s)) {
+            s->data = (wchar_t *) nanoem_calloc(length + 1, sizeof(*s->data), status);
+            if (nanoem_is_not_null(s->data)) {
+                memcpy(s->data, data, length * sizeof(*data));
+                s->length = length;
+                s->hash = key.hash;
+                s->num_references = 1;
+                kh_put_unicode_string_mbwc(strings, s, &ret);
+            }
+            else {
+                nanoem_free(s);
+                s = NULL;
+            }
+        }
+    }
+    ReleaseSRWLockExclusive(&opaque_data->lock);
+    return s;
+}
+
+static nanoem_unicode_string_mbwc_t *
+nanoemUnicodeStringFactoryFromStringMBWC(void *opaque, const nanoem_u8_t *string, nanoem_rsize_t length, UINT codepage, nanoem_status_t *status)
+{
+    nanoem_unicode_string_mbwc_t *s = NULL;
+    wchar_t stack_buffer[NANOEM_UNICODE_STRING_MBWC_STACK_CAPACITY], *data = stack_buffer;
+    int capacity = MultiByteToWideChar(codepage, 0, (const char *) string, (int) length, NULL, 0), actual_length;
+    if (capacity >= NANOEM_UNICODE_STRING_MBWC_STACK_CAPACITY) {
+        data = (wchar_t *) nanoem_calloc(capacity + 1, sizeof(*data), status);
+    }
+    if (nanoem_is_not_null(data)) {
+        actual_length = MultiByteToWideChar(codepage, 0, (const char *) string, (int) length, data, capacity);
+        s = nanoemUnicodeStringFactoryInternStringMBWC(opaque, data, actual_length, status);
+        if (data != stack_buffer) {
+            nanoem_free(data);
+        }
+        if (nanoem_is_not_null(s)) {
+            nanoem_status_ptr_assign(status, actual_length != 0 || GetLastError() != 0 ? NANOEM_STATUS_SUCCESS : NANOEM_STATUS_ERROR_DECODE_UNICODE_STRING_FAILED);
+        }
     }
     return s;
 }
@@ -132,28 +194,34 @@ nanoemUnicodeStringFactoryToStringMBWC(const nanoem_unicode_string_t *string, UI
 static nanoem_unicode_string_t *
 nanoemUnicodeStringFactoryFromCp932CallbackMBWC(void *opaque, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
 {
-    nanoem_mark_unused(opaque);
-    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringMBWC(string, length, NANOEM_MBSC_CP_SJIS, status);
+    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringMBWC(opaque, string, length, NANOEM_MBSC_CP_SJIS, status);
 }
 
 static nanoem_unicode_string_t *
 nanoemUnicodeStringFactoryFromUtf8CallbackMBWC(void *opaque, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
 {
-    nanoem_mark_unused(opaque);
-    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringMBWC(string, length, NANOEM_MBSC_CP_UTF8, status);
+    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringMBWC(opaque, string, length, NANOEM_MBSC_CP_UTF8, status);
 }
 
 static nanoem_unicode_string_t *
 nanoemUnicodeStringFactoryFromUtf16CallbackMBWC(void *opaque, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
 {
     nanoem_unicode_string_mbwc_t *s;
-    nanoem_mark_unused(opaque);
-    s = (nanoem_unicode_string_mbwc_t *) nanoem_calloc(1, sizeof(*s), status);
-    if (nanoem_is_not_null(s)) {
-        s->data = (wchar_t *) nanoem_calloc(length, sizeof(*s->data), status);
-        s->length = (int) length / sizeof(*s->data);
-        memcpy(s->data, string, length);
-        nanoem_status_ptr_assign_succeeded(status);
+    wchar_t stack_buffer[NANOEM_UNICODE_STRING_MBWC_STACK_CAPACITY], *data = stack_buffer;
+    int num_chars = (int) (length / sizeof(*data));
+    if (num_chars > NANOEM_UNICODE_STRING_MBWC_STACK_CAPACITY) {
+        data = (wchar_t *) nanoem_calloc(num_chars, sizeof(*data), status);
+    }
+    if (nanoem_is_not_null(data)) {
+        /* copied to keep wchar_t alignment since the source buffer may be unaligned */
+        memcpy(data, string, num_chars * sizeof(*data));
+        s = nanoemUnicodeStringFactoryInternStringMBWC(opaque, data, num_chars, status);
+        if (data != stack_buffer) {
+            nanoem_free(data);
+        }
+        if (nanoem_is_not_null(s)) {
+            nanoem_status_ptr_assign_succeeded(status);
+        }
     }
     return (nanoem_unicode_string_t *) s;
 }
@@ -203,7 +271,7 @@ static nanoem_i32_t
 nanoemUnicodeStringFactoryHashCallbackMBWC(void *opaque, const nanoem_unicode_string_t *string)
 {
     const nanoem_unicode_string_mbwc_t *s = (const nanoem_unicode_string_mbwc_t *) string;
-    nanoem_i32_t hash = s ? (nanoem_i32_t) MurmurHash(s->data, s->length * sizeof(*s->data), 0) : -1;
+    nanoem_i32_t hash = s ? (nanoem_i32_t) s->hash : -1;
     nanoem_mark_unused(opaque);
     return hash;
 }
@@ -214,57 +282,94 @@ nanoemUnicodeStringFactoryCompareCallbackMBWC(void *opaque, const nanoem_unicode
     const nanoem_unicode_string_mbwc_t *lvalue = (const nanoem_unicode_string_mbwc_t *) left,
                                        *rvalue = (const nanoem_unicode_string_mbwc_t *) right;
     nanoem_mark_unused(opaque);
-    return (nanoem_is_not_null(rvalue) && nanoem_is_not_null(lvalue)) && nanoem_is_not_null(rvalue->data) && nanoem_is_not_null(lvalue->data) ? wcscmp(lvalue->data, rvalue->data) : -1;
+    if ((nanoem_is_not_null(rvalue) && nanoem_is_not_null(lvalue)) && nanoem_is_not_null(rvalue->data) && nanoem_is_not_null(lvalue->data)) {
+        /* interned strings are unique so the same contents always share the same instance */
+        return lvalue != rvalue ? wcscmp(lvalue->data, rvalue->data) : 0;
+    }
+    return -1;
 }
 
 static const nanoem_u8_t *
 nanoemUnicodeStringFactoryGetCacheCallbackMBWC(void *opaque, const nanoem_unicode_string_t *string, nanoem_rsize_t *length, nanoem_codec_type_t codec, nanoem_status_t *status)
 {
+    nanoem_unicode_factory_opaque_data_mbwc_t *data = (nanoem_unicode_factory_opaque_data_mbwc_t *) opaque;
     const nanoem_unicode_string_mbwc_t *s = (const nanoem_unicode_string_mbwc_t *) string;
-    nanoem_mark_unused(opaque);
-    nanoem_mark_unused(codec);
-    if (s->cache.data) {
-        *length = s->cache.length;
+    const nanoem_u8_t *cache = NULL;
+    if (codec >= NANOEM_CODEC_TYPE_FIRST_ENUM && codec < NANOEM_CODEC_TYPE_MAX_ENUM) {
+        AcquireSRWLockShared(&data->lock);
+        cache = s->caches[codec].data;
+        if (cache) {
+            *length = s->caches[codec].length;
+        }
+        ReleaseSRWLockShared(&data->lock);
+    }
+    if (cache) {
         nanoem_status_ptr_assign_succeeded(status);
     }
     else {
         nanoem_status_ptr_assign_null_object(status);
     }
-    return s->cache.data;
+    return cache;
 }
 
 static void
 nanoemUnicodeStringFactorySetCacheCallbackMBWC(void *opaque, nanoem_unicode_string_t *string, nanoem_rsize_t *length, nanoem_codec_type_t codec, nanoem_status_t *status)
 {
+    nanoem_unicode_factory_opaque_data_mbwc_t *data = (nanoem_unicode_factory_opaque_data_mbwc_t *) opaque;
     nanoem_unicode_string_mbwc_t *s = (nanoem_unicode_string_mbwc_t *) string;
-    nanoem_mark_unused(opaque);
-    if (s->cache.data) {
-        nanoem_free(s->cache.data);
-        s->cache.data = 0;
-        *length = 0;
+    struct nanoem_unicode_string_mbwc_cache_t *cache;
+    if (codec < NANOEM_CODEC_TYPE_FIRST_ENUM || codec >= NANOEM_CODEC_TYPE_MAX_ENUM) {
+        nanoem_status_ptr_assign_null_object(status);
+        return;
     }
-    switch (codec) {
-    case NANOEM_CODEC_TYPE_SJIS:
-        s->cache.data = nanoemUnicodeStringFactoryToCp932CallbackMBWC(opaque, string, length, status);
-        break;
-    case NANOEM_CODEC_TYPE_UTF8:
-        s->cache.data = nanoemUnicodeStringFactoryToUtf8CallbackMBWC(opaque, string, length, status);
-        break;
-    case NANOEM_CODEC_TYPE_UTF16:
-        s->cache.data = nanoemUnicodeStringFactoryToUtf16CallbackMBWC(opaque, string, length, status);
-        break;
-    default:
-        break;
+    cache = &s->caches[codec];
+    AcquireSRWLockExclusive(&data->lock);
+    if (cache->data) {
+        /* an interned string is shared so the cache may already be built by the other owner */
+        nanoem_status_ptr_assign_succeeded(status);
+    }
+    else {
+        switch (codec) {
+        case NANOEM_CODEC_TYPE_SJIS:
+            cache->data = nanoemUnicodeStringFactoryToCp932CallbackMBWC(opaque, string, &cache->length, status);
+            break;
+        case NANOEM_CODEC_TYPE_UTF8:
+            cache->data = nanoemUnicodeStringFactoryToUtf8CallbackMBWC(opaque, string, &cache->length, status);
+            break;
+        case NANOEM_CODEC_TYPE_UTF16:
+            cache->data = nanoemUnicodeStringFactoryToUtf16CallbackMBWC(opaque, string, &cache->length, status);
+            break;
+        default:
+            break;
+        }
     }
-    s->cache.length = *length;
+    *length = cache->length;
+    ReleaseSRWLockExclusive(&data->lock);
 }
 
 static void
 nanoemUnicodeStringFactoryDestroyStringCallbackMBWC(void *opaque, nanoem_unicode_string_t *string)
 {
+    nanoem_unicode_factory_opaque_data_mbwc_t *data = (nanoem_unicode_factory_opaque_data_mbwc_t *) opaque;
     nanoem_unicode_string_mbwc_t *s = (nanoem_unicode_string_mbwc_t *) string;
-    nanoem_mark_unused(opaque);
+    khiter_t it;
+    int i;
+    nanoem_bool_t unreferenced = nanoem_false;
     if (s) {
+        AcquireSRWLockExclusive(&data->lock);
+        if (--s->num_references <= 0) {
+            it = kh_get_unicode_string_mbwc(data->strings, s);
+            if (it != kh_end(data->strings) && kh_key(data->strings, it) == s) {
+                kh_del_unicode_string_mbwc(data->strings, it);
+            }
+            unreferenced = nanoem_true;
+        }
+        ReleaseSRWLockExclusive(&data->lock);
+    }
+    if (unreferenced) {
+        for (i = NANOEM_CODEC_TYPE_FIRST_ENUM; i < NANOEM_CODEC_TYPE_MAX_ENUM; i++) {
+            nanoem_free(s->caches[i].data);
+        }
         nanoem_free(s->data);
         nanoem_free(s);
     }
@@ -282,20 +387,27 @@ nanoemUnicodeStringFactoryDestroyByteArrayCallbackMBWC(void *opaque, nanoem_u8_t
 nanoem_unicode_string_factory_t *APIENTRY
 nanoemUnicodeStringFactoryCreateMBWC(nanoem_status_t *status)
 {
-    nanoem_unicode_string_factory_t *factory;
-    factory = nanoemUnicodeStringFactoryCreate(status);
-    nanoemUnicodeStringFactorySetGetCacheCallback(factory, nanoemUnicodeStringFactoryGetCacheCallbackMBWC);
-    nanoemUnicodeStringFactorySetSetCacheCallback(factory, nanoemUnicodeStringFactorySetCacheCallbackMBWC);
-    nanoemUnicodeStringFactorySetCompareCallback(factory, nanoemUnicodeStringFactoryCompareCallbackMBWC);
-    nanoemUnicodeStringFactorySetConvertFromCp932Callback(factory, nanoemUnicodeStringFactoryFromCp932CallbackMBWC);
-    nanoemUnicodeStringFactorySetConvertFromUtf8Callback(factory, nanoemUnicodeStringFactoryFromUtf8CallbackMBWC);
-    nanoemUnicodeStringFactorySetConvertFromUtf16Callback(factory, nanoemUnicodeStringFactoryFromUtf16CallbackMBWC);
-    nanoemUnicodeStringFactorySetConvertToCp932Callback(factory, nanoemUnicodeStringFactoryToCp932CallbackMBWC);
-    nanoemUnicodeStringFactorySetConvertToUtf8Callback(factory, nanoemUnicodeStringFactoryToUtf8CallbackMBWC);
-    nanoemUnicodeStringFactorySetConvertToUtf16Callback(factory, nanoemUnicodeStringFactoryToUtf16CallbackMBWC);
-    nanoemUnicodeStringFactorySetDestroyStringCallback(factory, nanoemUnicodeStringFactoryDestroyStringCallbackMBWC);
-    nanoemUnicodeStringFactorySetDestroyByteArrayCallback(factory, nanoemUnicodeStringFactoryDestroyByteArrayCallbackMBWC);
-    nanoemUnicodeStringFactorySetHashCallback(factory, nanoemUnicodeStringFactoryHashCallbackMBWC);
+    nanoem_unicode_factory_opaque_data_mbwc_t *opaque;
+    nanoem_unicode_string_factory_t *factory = NULL;
+    opaque = (nanoem_unicode_factory_opaque_data_mbwc_t *) nanoem_calloc(1, sizeof(*opaque), status);
+    if (nanoem_is_not_null(opaque)) {
+        opaque->strings = kh_init_unicode_string_mbwc();
+        InitializeSRWLock(&opaque->lock);
+        factory = nanoemUnicodeStringFactoryCreate(status);
+        nanoemUnicodeStringFactorySetGetCacheCallback(factory, nanoemUnicodeStringFactoryGetCacheCallbackMBWC);
+        nanoemUnicodeStringFactorySetSetCacheCallback(factory, nanoemUnicodeStringFactorySetCacheCallbackMBWC);
+        nanoemUnicodeStringFactorySetCompareCallback(factory, nanoemUnicodeStringFactoryCompareCallbackMBWC);
+        nanoemUnicodeStringFactorySetConvertFromCp932Callback(factory, nanoemUnicodeStringFactoryFromCp932CallbackMBWC);
+        nanoemUnicodeStringFactorySetConvertFromUtf8Callback(factory, nanoemUnicodeStringFactoryFromUtf8CallbackMBWC);
+        nanoemUnicodeStringFactorySetConvertFromUtf16Callback(factory, nanoemUnicodeStringFactoryFromUtf16CallbackMBWC);
+        nanoemUnicodeStringFactorySetConvertToCp932Callback(factory, nanoemUnicodeStringFactoryToCp932CallbackMBWC);
+        nanoemUnicodeStringFactorySetConvertToUtf8Callback(factory, nanoemUnicodeStringFactoryToUtf8CallbackMBWC);
+        nanoemUnicodeStringFactorySetConvertToUtf16Callback(factory, nanoemUnicodeStringFactoryToUtf16CallbackMBWC);
+        nanoemUnicodeStringFactorySetDestroyStringCallback(factory, nanoemUnicodeStringFactoryDestroyStringCallbackMBWC);
+        nanoemUnicodeStringFactorySetDestroyByteArrayCallback(factory, nanoemUnicodeStringFactoryDestroyByteArrayCallbackMBWC);
+        nanoemUnicodeStringFactorySetHashCallback(factory, nanoemUnicodeStringFactoryHashCallbackMBWC);
+        nanoemUnicodeStringFactorySetOpaqueData(factory, opaque);
+    }
     return factory;
 }
 
@@ -305,6 +417,8 @@ nanoemUnicodeStringFactoryDestroyMBWC(nanoem_unicode_string_factory_t *factory)
     nanoem_unicode_factory_opaque_data_mbwc_t *opaque;
     opaque = (nanoem_unicode_factory_opaque_data_mbwc_t *) nanoemUnicodeStringFactoryGetOpaqueData(factory);
     if (opaque) {
+        /* strings still referenced are owned by their holders like before and only detached from the table */
+        kh_destroy_unicode_string_mbwc(opaque->strings);
         nanoem_free(opaque);
     }
     nanoemUnicodeStringFactoryDestroy(factory);
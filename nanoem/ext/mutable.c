@@ -2832,6 +2832,147 @@ nanoemMutableMotionSortAllKeyframes(nanoem_mutable_motion_t *motion)
     }
 }
 
+static nanoem_frame_index_t
+nanoemMutableMotionFindUnoccupiedFrameIndex(kh_keyframe_map_t *keyframes_map, nanoem_frame_index_t frame_index)
+{
+    nanoem_frame_index_t candidate = frame_index;
+    khiter_t end = kh_end(keyframes_map);
+    while (kh_get_keyframe_map(keyframes_map, candidate) != end && candidate < NANOEM_FRAME_INDEX_MAX_SIZE) {
+        candidate++;
+    }
+    /* all frames up to the maximum are occupied so look for the previous free frame instead of wrapping around */
+    if (kh_get_keyframe_map(keyframes_map, candidate) != end) {
+        candidate = frame_index;
+        while (kh_get_keyframe_map(keyframes_map, candidate) != end && candidate > 0) {
+            candidate--;
+        }
+    }
+    return candidate;
+}
+
+static void
+nanoemMutableMotionRemapKeyframesMap(kh_keyframe_map_t *keyframes_map, nanoem_motion_keyframe_object_t **remapping, nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_mutable_motion_remap_frame_index_t callback, void *user_data, nanoem_status_t *status)
+{
+    nanoem_motion_keyframe_object_t *keyframe;
+    nanoem_frame_index_t frame_index;
+    nanoem_rsize_t num_remapping = 0, i;
+    khiter_t it, end = kh_end(keyframes_map);
+    int ret;
+    for (it = kh_begin(keyframes_map); it != end; it++) {
+        if (kh_exist(keyframes_map, it)) {
+            frame_index = kh_key(keyframes_map, it);
+            if (frame_index >= from && frame_index <= to) {
+                remapping[num_remapping++] = kh_val(keyframes_map, it);
+                kh_del_keyframe_map(keyframes_map, it);
+            }
+        }
+    }
+    /* destinations are resolved in source order and a colliding keyframe moves to the next free frame */
+    nanoem_crt_qsort(remapping, num_remapping, sizeof(*remapping), nanoemMotionCompareKeyframe);
+    for (i = 0; i < num_remapping; i++) {
+        keyframe = remapping[i];
+        frame_index = nanoemMutableMotionFindUnoccupiedFrameIndex(keyframes_map, callback(user_data, keyframe->frame_index));
+        it = kh_put_keyframe_map(keyframes_map, frame_index, &ret);
+        if (ret < 0) {
+            nanoem_status_ptr_assign(status, NANOEM_STATUS_ERROR_MALLOC_FAILED);
+            break;
+        }
+        kh_val(keyframes_map, it) = keyframe;
+        keyframe->frame_index = frame_index;
+    }
+}
+
+static void
+nanoemMutableMotionRemapTrackBundle(kh_motion_track_bundle_t *bundle, nanoem_rsize_t num_keyframes, nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_mutable_motion_remap_frame_index_t callback, void *user_data, nanoem_status_t *status)
+{
+    nanoem_motion_keyframe_object_t **remapping;
+    khiter_t it, end;
+    if (nanoem_is_not_null(bundle) && num_keyframes > 0) {
+        remapping = (nanoem_motion_keyframe_object_t **) nanoem_malloc(sizeof(*remapping) * num_keyframes, status);
+        if (nanoem_is_not_null(remapping)) {
+            end = kh_end(bundle);
+            for (it = kh_begin(bundle); it != end && !nanoem_status_ptr_has_error(status); it++) {
+                if (kh_exist(bundle, it)) {
+                    nanoemMutableMotionRemapKeyframesMap(kh_key(bundle, it).keyframes, remapping, from, to, callback, user_data, status);
+                }
+            }
+            nanoem_free(remapping);
+        }
+    }
+}
+
+static void
+nanoemMutableMotionRemapKeyframeObjectArray(void *const *items, nanoem_rsize_t num_items, nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_mutable_motion_remap_frame_index_t callback, void *user_data, nanoem_status_t *status)
+{
+    nanoem_motion_keyframe_object_t **remapping, *item;
+    kh_keyframe_map_t *keyframes_map;
+    nanoem_rsize_t i;
+    khiter_t it;
+    int ret = 0;
+    if (num_items > 0) {
+        /* global keyframes have no track so the occupied frames are built from the array */
+        keyframes_map = kh_init_keyframe_map();
+        remapping = (nanoem_motion_keyframe_object_t **) nanoem_malloc(sizeof(*remapping) * num_items, status);
+        if (nanoem_is_not_null(keyframes_map) && nanoem_is_not_null(remapping)) {
+            for (i = 0; i < num_items && ret >= 0; i++) {
+                item = (nanoem_motion_keyframe_object_t *) items[i];
+                it = kh_put_keyframe_map(keyframes_map, item->frame_index, &ret);
+                if (ret >= 0) {
+                    kh_val(keyframes_map, it) = item;
+                }
+            }
+            if (ret >= 0) {
+                nanoemMutableMotionRemapKeyframesMap(keyframes_map, remapping, from, to, callback, user_data, status);
+            }
+            else {
+                nanoem_status_ptr_assign(status, NANOEM_STATUS_ERROR_MALLOC_FAILED);
+            }
+        }
+        else {
+            nanoem_status_ptr_assign(status, NANOEM_STATUS_ERROR_MALLOC_FAILED);
+        }
+        nanoem_free(remapping);
+        kh_destroy_keyframe_map(keyframes_map);
+    }
+}
+
+void APIENTRY
+nanoemMutableMotionRemapAllKeyframes(nanoem_mutable_motion_t *motion, nanoem_u32_t types, nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_mutable_motion_remap_frame_index_t callback, void *user_data, nanoem_status_t *status)
+{
+    nanoem_motion_t *origin;
+    if (nanoem_is_not_null(motion) && nanoem_is_not_null(callback)) {
+        origin = motion->origin;
+        nanoem_status_ptr_assign_succeeded(status);
+        if (from <= to) {
+            if ((types & NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ACCESSORY) != 0 && !nanoem_status_ptr_has_error(status)) {
+                nanoemMutableMotionRemapKeyframeObjectArray((void *const *) origin->accessory_keyframes, origin->num_accessory_keyframes, from, to, callback, user_data, status);
+            }
+            if ((types & NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE) != 0 && !nanoem_status_ptr_has_error(status)) {
+                nanoemMutableMotionRemapTrackBundle(origin->local_bone_motion_track_bundle, origin->num_bone_keyframes, from, to, callback, user_data, status);
+            }
+            if ((types & NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_CAMERA) != 0 && !nanoem_status_ptr_has_error(status)) {
+                nanoemMutableMotionRemapKeyframeObjectArray((void *const *) origin->camera_keyframes, origin->num_camera_keyframes, from, to, callback, user_data, status);
+            }
+            if ((types & NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_LIGHT) != 0 && !nanoem_status_ptr_has_error(status)) {
+                nanoemMutableMotionRemapKeyframeObjectArray((void *const *) origin->light_keyframes, origin->num_light_keyframes, from, to, callback, user_data, status);
+            }
+            if ((types & NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MODEL) != 0 && !nanoem_status_ptr_has_error(status)) {
+                nanoemMutableMotionRemapKeyframeObjectArray((void *const *) origin->model_keyframes, origin->num_model_keyframes, from, to, callback, user_data, status);
+            }
+            if ((types & NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MORPH) != 0 && !nanoem_status_ptr_has_error(status)) {
+                nanoemMutableMotionRemapTrackBundle(origin->local_morph_motion_track_bundle, origin->num_morph_keyframes, from, to, callback, user_data, status);
+            }
+            if ((types & NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_SELFSHADOW) != 0 && !nanoem_status_ptr_has_error(status)) {
+                nanoemMutableMotionRemapKeyframeObjectArray((void *const *) origin->self_shadow_keyframes, origin->num_self_shadow_keyframes, from, to, callback, user_data, status);
+            }
+            nanoemMutableMotionSortAllKeyframes(motion);
+        }
+    }
+    else {
+        nanoem_status_ptr_assign_null_object(status);
+    }
+}
+
 void APIENTRY
 nanoemMutableMotionSetAnnotation(nanoem_mutable_motion_t *motion, const char *key, const char *value, nanoem_status_t *status)
 {
@@ -146,6 +146,11 @@ NANOEM_DECL_ENUM(nanoem_i32_t, nanoem_mutable_motion_keyframe_type_t){
     NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_MAX_ENUM = 0x80
 };
 
+/**
+ * \brief Callback to map the source frame index to the destination frame index
+ */
+typedef nanoem_frame_index_t (*nanoem_mutable_motion_remap_frame_index_t)(void *, nanoem_frame_index_t);
+
 /**
  * \defgroup nanoem_mutable_motion_effect_parameter Mutable Motion Effect Parameter
  * @{
@@ -1448,6 +1453,25 @@ nanoemMutableMotionRemoveSelfShadowKeyframe(nanoem_mutable_motion_t *motion, nan
 NANOEM_DECL_API void APIENTRY
 nanoemMutableMotionSortAllKeyframes(nanoem_mutable_motion_t *motion);
 
+/**
+ * \brief Move all motion keyframe objects in the given frame range to the frame index returned from the callback
+ *
+ * Each keyframe whose frame index is between \b from and \b to (inclusive) is moved in one pass per track.
+ * Destinations are resolved in ascending order of the source frame index and a keyframe whose destination is
+ * already occupied is moved to the next unoccupied frame index (or the previous one when every frame up to the
+ * maximum frame index is occupied). All keyframes are sorted after remapping.
+ *
+ * \param motion The opaque motion object
+ * \param types Bitset of ::nanoem_mutable_motion_keyframe_type_t to remap
+ * \param from The first frame index to remap
+ * \param to The last frame index to remap
+ * \param callback The callback to map the source frame index
+ * \param user_data The opaque data passed to the callback
+ * \param[in,out] status \b NANOEM_STATUS_SUCCESS is set if succeeded, otherwise sets the others
+ */
+NANOEM_DECL_API void APIENTRY
+nanoemMutableMotionRemapAllKeyframes(nanoem_mutable_motion_t *motion, nanoem_u32_t types, nanoem_frame_index_t from, nanoem_frame_index_t to, nanoem_mutable_motion_remap_frame_index_t callback, void *user_data, nanoem_status_t *status);
+
 /**
  * \brief Set the annotation value to the given opaque motion object and the key
  *
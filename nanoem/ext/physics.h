@@ -427,6 +427,45 @@ nanoemPhysicsMotionStateGetCurrentWorldTransform(const nanoem_physics_motion_sta
 NANOEM_DECL_API void APIENTRY
 nanoemPhysicsMotionStateSetCurrentWorldTransform(nanoem_physics_motion_state_t *motion_state, const nanoem_f32_t *value);
 
+/**
+ * \brief Get all initial world transform matrices from the given opaque physics motion state objects
+ *
+ * \param motion_states The opaque physics motion state objects
+ * \param num_objects Number of the opaque physics motion state objects
+ * \param[out] values The values to set
+ * \remark \b values must be at least \b num_objects * 16 components float array
+ * \remark matrix of \b NULL motion state object is left untouched
+ * \remark Do nothing when ::nanoemPhysicsWorldIsAvailable is \b false
+ */
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsMotionStateGetAllInitialWorldTransforms(nanoem_physics_motion_state_t *const *motion_states, nanoem_rsize_t num_objects, nanoem_f32_t *values);
+
+/**
+ * \brief Get all current world transform matrices from the given opaque physics motion state objects
+ *
+ * \param motion_states The opaque physics motion state objects
+ * \param num_objects Number of the opaque physics motion state objects
+ * \param[out] values The values to set
+ * \remark \b values must be at least \b num_objects * 16 components float array
+ * \remark matrix of \b NULL motion state object is left untouched
+ * \remark Do nothing when ::nanoemPhysicsWorldIsAvailable is \b false
+ */
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsMotionStateGetAllCurrentWorldTransforms(nanoem_physics_motion_state_t *const *motion_states, nanoem_rsize_t num_objects, nanoem_f32_t *values);
+
+/**
+ * \brief Set all current world transform matrices to the given opaque physics motion state objects
+ *
+ * \param motion_states The opaque physics motion state objects
+ * \param num_objects Number of the opaque physics motion state objects
+ * \param values The values to set
+ * \remark \b values must be at least \b num_objects * 16 components float array
+ * \remark \b NULL motion state object is skipped
+ * \remark Do nothing when ::nanoemPhysicsWorldIsAvailable is \b false
+ */
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsMotionStateSetAllCurrentWorldTransforms(nanoem_physics_motion_state_t *const *motion_states, nanoem_rsize_t num_objects, const nanoem_f32_t *values);
+
 /**
  * \brief Get the center of mass offset vector from the given opaque physics motion state object
  *
@@ -662,6 +701,54 @@ nanoemPhysicsSoftBodySetVertexPosition(nanoem_physics_soft_body_t *soft_body, in
 NANOEM_DECL_API void APIENTRY
 nanoemPhysicsSoftBodySetVertexNormal(nanoem_physics_soft_body_t *soft_body, int offset, const nanoem_f32_t *value);
 
+/**
+ * \brief Get all vertex position vectors from the given opaque physics soft body object
+ *
+ * \param soft_body The opaque physics soft body object
+ * \param[out] values The values to set
+ * \remark \b values must be at least ::nanoemPhysicsSoftBodyGetNumVertexObjects * 4 components float array
+ * \remark Do nothing when ::nanoemPhysicsWorldIsAvailable is \b false
+ */
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsSoftBodyGetAllVertexPositions(const nanoem_physics_soft_body_t *soft_body, nanoem_f32_t *values);
+
+/**
+ * \brief Get all vertex normal vectors from the given opaque physics soft body object
+ *
+ * \param soft_body The opaque physics soft body object
+ * \param[out] values The values to set
+ * \remark \b values must be at least ::nanoemPhysicsSoftBodyGetNumVertexObjects * 4 components float array
+ * \remark Do nothing when ::nanoemPhysicsWorldIsAvailable is \b false
+ */
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsSoftBodyGetAllVertexNormals(const nanoem_physics_soft_body_t *soft_body, nanoem_f32_t *values);
+
+/**
+ * \brief Set vertex position vectors to the given opaque physics soft body object and offsets
+ *
+ * \param soft_body The opaque physics soft body object
+ * \param offsets The offsets to set the vertex position vectors or \b NULL to set from the first vertex in order
+ * \param num_offsets Number of the vertex position vectors to set
+ * \param values The values to set
+ * \remark \b values must be at least \b num_offsets * 4 components float array
+ * \remark Do nothing when ::nanoemPhysicsWorldIsAvailable is \b false
+ */
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsSoftBodySetAllVertexPositions(nanoem_physics_soft_body_t *soft_body, const int *offsets, nanoem_rsize_t num_offsets, const nanoem_f32_t *values);
+
+/**
+ * \brief Set vertex normal vectors to the given opaque physics soft body object and offsets
+ *
+ * \param soft_body The opaque physics soft body object
+ * \param offsets The offsets to set the vertex normal vectors or \b NULL to set from the first vertex in order
+ * \param num_offsets Number of the vertex normal vectors to set
+ * \param values The values to set
+ * \remark \b values must be at least \b num_offsets * 4 components float array
+ * \remark Do nothing when ::nanoemPhysicsWorldIsAvailable is \b false
+ */
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsSoftBodySetAllVertexNormals(nanoem_physics_soft_body_t *soft_body, const int *offsets, nanoem_rsize_t num_offsets, const nanoem_f32_t *values);
+
 /**
  * \brief Get whether the visualization is enabled from the given opaque physics soft body object
  *
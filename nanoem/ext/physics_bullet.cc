@@ -992,6 +992,22 @@ struct nanoem_physics_soft_body_t {
         }
     }
     void
+    getAllVertexPositions(nanoem_f32_t *values) const
+    {
+        const int numNodes = verticesLength();
+        for (int i = 0; i < numNodes; i++) {
+            memcpy(values + i * 4, m_internalSoftBody->m_nodes[i].m_x, sizeof(btVector3));
+        }
+    }
+    void
+    getAllVertexNormals(nanoem_f32_t *values) const
+    {
+        const int numNodes = verticesLength();
+        for (int i = 0; i < numNodes; i++) {
+            memcpy(values + i * 4, m_internalSoftBody->m_nodes[i].m_n, sizeof(btVector3));
+        }
+    }
+    void
     setVertexPosition(int offset, const nanoem_f32_t *value) const
     {
         if (nanoem_likely(offset >= 0 && offset < m_internalSoftBody->m_nodes.size())) {
@@ -1392,6 +1408,42 @@ nanoemPhysicsMotionStateSetCurrentWorldTransform(nanoem_physics_motion_state_t *
     }
 }
 
+void APIENTRY
+nanoemPhysicsMotionStateGetAllInitialWorldTransforms(nanoem_physics_motion_state_t *const *motion_states, nanoem_rsize_t num_objects, nanoem_f32_t *values)
+{
+    if (nanoem_is_not_null(motion_states) && nanoem_is_not_null(values)) {
+        for (nanoem_rsize_t i = 0; i < num_objects; i++) {
+            if (const btDefaultMotionState *state = reinterpret_cast<const btDefaultMotionState *>(motion_states[i])) {
+                state->m_startWorldTrans.getOpenGLMatrix(values + i * 16);
+            }
+        }
+    }
+}
+
+void APIENTRY
+nanoemPhysicsMotionStateGetAllCurrentWorldTransforms(nanoem_physics_motion_state_t *const *motion_states, nanoem_rsize_t num_objects, nanoem_f32_t *values)
+{
+    if (nanoem_is_not_null(motion_states) && nanoem_is_not_null(values)) {
+        for (nanoem_rsize_t i = 0; i < num_objects; i++) {
+            if (const btDefaultMotionState *state = reinterpret_cast<const btDefaultMotionState *>(motion_states[i])) {
+                state->m_graphicsWorldTrans.getOpenGLMatrix(values + i * 16);
+            }
+        }
+    }
+}
+
+void APIENTRY
+nanoemPhysicsMotionStateSetAllCurrentWorldTransforms(nanoem_physics_motion_state_t *const *motion_states, nanoem_rsize_t num_objects, const nanoem_f32_t *values)
+{
+    if (nanoem_is_not_null(motion_states) && nanoem_is_not_null(values)) {
+        for (nanoem_rsize_t i = 0; i < num_objects; i++) {
+            if (btDefaultMotionState *state = reinterpret_cast<btDefaultMotionState *>(motion_states[i])) {
+                state->m_graphicsWorldTrans.setFromOpenGLMatrix(values + i * 16);
+            }
+        }
+    }
+}
+
 void APIENTRY
 nanoemPhysicsMotionStateGetCenterOfMassOffset(const nanoem_physics_motion_state_t *motion_state, nanoem_f32_t *value)
 {
@@ -1563,6 +1615,42 @@ nanoemPhysicsSoftBodySetVertexNormal(nanoem_physics_soft_body_t *soft_body, int
     }
 }
 
+void APIENTRY
+nanoemPhysicsSoftBodyGetAllVertexPositions(const nanoem_physics_soft_body_t *soft_body, nanoem_f32_t *values)
+{
+    if (nanoem_is_not_null(soft_body) && nanoem_is_not_null(values)) {
+        soft_body->getAllVertexPositions(values);
+    }
+}
+
+void APIENTRY
+nanoemPhysicsSoftBodyGetAllVertexNormals(const nanoem_physics_soft_body_t *soft_body, nanoem_f32_t *values)
+{
+    if (nanoem_is_not_null(soft_body) && nanoem_is_not_null(values)) {
+        soft_body->getAllVertexNormals(values);
+    }
+}
+
+void APIENTRY
+nanoemPhysicsSoftBodySetAllVertexPositions(nanoem_physics_soft_body_t *soft_body, const int *offsets, nanoem_rsize_t num_offsets, const nanoem_f32_t *values)
+{
+    if (nanoem_is_not_null(soft_body) && nanoem_is_not_null(values)) {
+        for (nanoem_rsize_t i = 0; i < num_offsets; i++) {
+            soft_body->setVertexPosition(offsets ? offsets[i] : int(i), values + i * 4);
+        }
+    }
+}
+
+void APIENTRY
+nanoemPhysicsSoftBodySetAllVertexNormals(nanoem_physics_soft_body_t *soft_body, const int *offsets, nanoem_rsize_t num_offsets, const nanoem_f32_t *values)
+{
+    if (nanoem_is_not_null(soft_body) && nanoem_is_not_null(values)) {
+        for (nanoem_rsize_t i = 0; i < num_offsets; i++) {
+            soft_body->setVertexNormal(offsets ? offsets[i] : int(i), values + i * 4);
+        }
+    }
+}
+
 nanoem_bool_t APIENTRY
 nanoemPhysicsSoftBodyIsVisualizeEnabled(const nanoem_physics_soft_body_t *soft_body)
 {
@@ -1794,6 +1882,46 @@ nanoemPhysicsMotionStateSetCurrentWorldTransform(
 {
 }
 
+void APIENTRY
+nanoemPhysicsMotionStateGetAllInitialWorldTransforms(
+    nanoem_physics_motion_state_t *const * /* motion_states */, nanoem_rsize_t /* num_objects */, nanoem_f32_t * /* values */)
+{
+}
+
+void APIENTRY
+nanoemPhysicsMotionStateGetAllCurrentWorldTransforms(
+    nanoem_physics_motion_state_t *const * /* motion_states */, nanoem_rsize_t /* num_objects */, nanoem_f32_t * /* values */)
+{
+}
+
+void APIENTRY
+nanoemPhysicsMotionStateSetAllCurrentWorldTransforms(
+    nanoem_physics_motion_state_t *const * /* motion_states */, nanoem_rsize_t /* num_objects */, const nanoem_f32_t * /* values */)
+{
+}
+
+void APIENTRY
+nanoemPhysicsSoftBodyGetAllVertexPositions(const nanoem_physics_soft_body_t * /* soft_body */, nanoem_f32_t * /* values */)
+{
+}
+
+void APIENTRY
+nanoemPhysicsSoftBodyGetAllVertexNormals(const nanoem_physics_soft_body_t * /* soft_body */, nanoem_f32_t * /* values */)
+{
+}
+
+void APIENTRY
+nanoemPhysicsSoftBodySetAllVertexPositions(nanoem_physics_soft_body_t * /* soft_body */, const int * /* offsets */,
+    nanoem_rsize_t /* num_offsets */, const nanoem_f32_t * /* values */)
+{
+}
+
+void APIENTRY
+nanoemPhysicsSoftBodySetAllVertexNormals(nanoem_physics_soft_body_t * /* soft_body */, const int * /* offsets */,
+    nanoem_rsize_t /* num_offsets */, const nanoem_f32_t * /* values */)
+{
+}
+
 void APIENTRY
 nanoemPhysicsMotionStateGetCenterOfMassOffset(
     const nanoem_physics_motion_state_t * /* motion_state */, nanoem_f32_t * /* value */)
@@ -134,3 +134,165 @@ TEST_CASE("mutable_motion_null_values", "[nanoem]")
     CHECK_FALSE(nanoemMutableMotionSaveToBuffer(mutable_motion, NULL, &status));
     CHECK_FALSE(nanoemMutableMotionSaveToBufferNMD(mutable_motion, NULL, &status));
 }
+
+namespace {
+
+static nanoem_frame_index_t
+halveFrameIndex(void * /* user_data */, nanoem_frame_index_t frame_index)
+{
+    return frame_index / 2;
+}
+
+static nanoem_frame_index_t
+shiftFrameIndex(void *user_data, nanoem_frame_index_t frame_index)
+{
+    return frame_index + *static_cast<const int *>(user_data);
+}
+
+static nanoem_frame_index_t
+maxFrameIndex(void * /* user_data */, nanoem_frame_index_t /* frame_index */)
+{
+    return UINT32_MAX;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("mutable_motion_remap_all_keyframes", "[nanoem]")
+{
+    static const nanoem_frame_index_t kBoneFrameIndices[] = { 0, 2, 4, 6, 10 };
+    static const nanoem_frame_index_t kCameraFrameIndices[] = { 0, 3, 4, 8 };
+    MotionScope scope;
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_motion_t *motion = scope.newMotion();
+    nanoem_motion_t *origin = nanoemMutableMotionGetOriginObject(motion);
+    nanoem_unicode_string_t *a = scope.newString("a"), *b = scope.newString("b");
+    for (size_t i = 0; i < sizeof(kBoneFrameIndices) / sizeof(kBoneFrameIndices[0]); i++) {
+        nanoemMutableMotionAddBoneKeyframe(motion, scope.newBoneKeyframe(), a, kBoneFrameIndices[i], &status);
+    }
+    nanoemMutableMotionAddBoneKeyframe(motion, scope.newBoneKeyframe(), b, 4, &status);
+    nanoemMutableMotionAddBoneKeyframe(motion, scope.newBoneKeyframe(), b, 5, &status);
+    for (size_t i = 0; i < sizeof(kCameraFrameIndices) / sizeof(kCameraFrameIndices[0]); i++) {
+        nanoemMutableMotionAddCameraKeyframe(motion, scope.newCameraKeyframe(), kCameraFrameIndices[i], &status);
+    }
+    nanoemMutableMotionSortAllKeyframes(motion);
+    SECTION("null")
+    {
+        nanoemMutableMotionRemapAllKeyframes(NULL, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, 0, 1, halveFrameIndex, NULL, &status);
+        CHECK(status == NANOEM_STATUS_ERROR_NULL_OBJECT);
+        nanoemMutableMotionRemapAllKeyframes(motion, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, 0, 1, NULL, NULL, &status);
+        CHECK(status == NANOEM_STATUS_ERROR_NULL_OBJECT);
+    }
+    SECTION("shrink with collision")
+    {
+        nanoemMutableMotionRemapAllKeyframes(motion, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, 2, 6, halveFrameIndex, NULL, &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        nanoem_rsize_t num_keyframes;
+        nanoemMotionGetAllBoneKeyframeObjects(origin, &num_keyframes);
+        CHECK(num_keyframes == 7);
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, 0));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, 1));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, 2));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, 3));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, 10));
+        CHECK_FALSE(nanoemMotionFindBoneKeyframeObject(origin, a, 4));
+        CHECK_FALSE(nanoemMotionFindBoneKeyframeObject(origin, a, 6));
+        /* both 4 and 5 are mapped to 2 and the latter is moved to the next free frame */
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, b, 2));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, b, 3));
+        CHECK_FALSE(nanoemMotionFindBoneKeyframeObject(origin, b, 4));
+        CHECK_FALSE(nanoemMotionFindBoneKeyframeObject(origin, b, 5));
+        /* 3 is mapped to 1 and 4 is mapped to 2 while 0 and 8 are not in the range */
+        CHECK(nanoemMotionFindCameraKeyframeObject(origin, 0));
+        CHECK(nanoemMotionFindCameraKeyframeObject(origin, 1));
+        CHECK(nanoemMotionFindCameraKeyframeObject(origin, 2));
+        CHECK(nanoemMotionFindCameraKeyframeObject(origin, 8));
+        CHECK_FALSE(nanoemMotionFindCameraKeyframeObject(origin, 3));
+        CHECK(nanoemMotionGetMaxFrameIndex(origin) == 10);
+    }
+    SECTION("shift forward and backward")
+    {
+        int offset = 1;
+        nanoemMutableMotionRemapAllKeyframes(motion, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE, 4, UINT32_MAX - 1, shiftFrameIndex, &offset, &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, 2));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, 5));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, 7));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, 11));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, b, 5));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, b, 6));
+        CHECK_FALSE(nanoemMotionFindBoneKeyframeObject(origin, b, 4));
+        /* camera keyframes are not the target */
+        CHECK(nanoemMotionFindCameraKeyframeObject(origin, 4));
+        CHECK(nanoemMotionGetMaxFrameIndex(origin) == 11);
+        offset = -1;
+        nanoemMutableMotionRemapAllKeyframes(motion, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE, 5, UINT32_MAX, shiftFrameIndex, &offset, &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        for (size_t i = 0; i < sizeof(kBoneFrameIndices) / sizeof(kBoneFrameIndices[0]); i++) {
+            CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, kBoneFrameIndices[i]));
+        }
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, b, 4));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, b, 5));
+    }
+    SECTION("collision at the maximum frame index")
+    {
+        nanoemMutableMotionAddBoneKeyframe(motion, scope.newBoneKeyframe(), a, UINT32_MAX, &status);
+        nanoemMutableMotionSortAllKeyframes(motion);
+        /* 10 is mapped to the occupied maximum frame index and moved to the previous free frame */
+        nanoemMutableMotionRemapAllKeyframes(motion, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_BONE, 10, 10, maxFrameIndex, NULL, &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, UINT32_MAX));
+        CHECK(nanoemMotionFindBoneKeyframeObject(origin, a, UINT32_MAX - 1));
+        CHECK_FALSE(nanoemMotionFindBoneKeyframeObject(origin, a, 10));
+        CHECK_FALSE(nanoemMotionFindBoneKeyframeObject(origin, a, 0));
+    }
+}
+
+TEST_CASE("motion_find_keyframe_with_equal_name", "[nanoem]")
+{
+    MotionScope scope;
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_motion_t *motion = scope.newMotion();
+    nanoem_motion_t *origin = nanoemMutableMotionGetOriginObject(motion);
+    nanoem_unicode_string_t *name = scope.newString("center"), *same = scope.newString("center"),
+                            *other = scope.newString("centre");
+#if defined(NANOEM_ENABLE_ICU) || defined(NANOEM_ENABLE_MBWC)
+    /* the same contents are interned as the same instance */
+    CHECK(name == same);
+    CHECK(name != other);
+#endif
+    nanoemMutableMotionAddBoneKeyframe(motion, scope.newBoneKeyframe(), name, 1, &status);
+    nanoemMutableMotionAddMorphKeyframe(motion, scope.newMorphKeyframe(), name, 2, &status);
+    nanoemMutableMotionSortAllKeyframes(motion);
+    CHECK(nanoemMotionFindBoneKeyframeObject(origin, same, 1));
+    CHECK(nanoemMotionFindMorphKeyframeObject(origin, same, 2));
+    CHECK_FALSE(nanoemMotionFindBoneKeyframeObject(origin, other, 1));
+    CHECK_FALSE(nanoemMotionFindMorphKeyframeObject(origin, other, 2));
+}
+
+#if defined(NANOEM_ENABLE_ICU) || defined(NANOEM_ENABLE_MBWC)
+TEST_CASE("unicode_string_factory_cache_with_codec", "[nanoem]")
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_unicode_string_factory_t *factory = nanoemUnicodeStringFactoryCreateEXT(&status);
+    nanoem_unicode_string_t *name = nanoemUnicodeStringFactoryCreateString(factory, (const nanoem_u8_t *) "center", 6, &status);
+    nanoem_rsize_t length = 0;
+    nanoemUnicodeStringFactorySetCacheString(factory, name, &length, NANOEM_CODEC_TYPE_UTF8, &status);
+    CHECK(status == NANOEM_STATUS_SUCCESS);
+    CHECK(length == 6);
+    CHECK(nanoemUnicodeStringFactoryGetCacheString(factory, name, &length, NANOEM_CODEC_TYPE_UTF8, &status));
+    CHECK(status == NANOEM_STATUS_SUCCESS);
+    /* the cache built for UTF-8 must not be returned for the other codec */
+    CHECK_FALSE(nanoemUnicodeStringFactoryGetCacheString(factory, name, &length, NANOEM_CODEC_TYPE_UTF16, &status));
+    CHECK(status == NANOEM_STATUS_ERROR_NULL_OBJECT);
+    /* building the cache for the other codec must keep the one already handed out alive */
+    const nanoem_u8_t *utf8 = nanoemUnicodeStringFactoryGetCacheString(factory, name, &length, NANOEM_CODEC_TYPE_UTF8, &status);
+    nanoemUnicodeStringFactorySetCacheString(factory, name, &length, NANOEM_CODEC_TYPE_UTF16, &status);
+    CHECK(status == NANOEM_STATUS_SUCCESS);
+    CHECK(length == 12);
+    CHECK(nanoemUnicodeStringFactoryGetCacheString(factory, name, &length, NANOEM_CODEC_TYPE_UTF8, &status) == utf8);
+    CHECK(length == 6);
+    CHECK(memcmp(utf8, "center", 6) == 0);
+    nanoemUnicodeStringFactoryDestroyString(factory, name);
+    nanoemUnicodeStringFactoryDestroyEXT(factory);
+}
+#endif
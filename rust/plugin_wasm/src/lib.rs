@@ -99,12 +99,13 @@ fn inner_set_data_internal(
     data: &[u8],
     component_size: usize,
     name: &str,
+    buffer: &mut GuestBuffer,
     mut store: impl AsContextMut,
 ) -> Result<()> {
     if let Ok(set_input_model_data) = instance
         .get_typed_func::<(OpaquePtr, ByteArray, u32, StatusPtr), ()>(store.as_context_mut(), name)
     {
-        let data_ptr = allocate_byte_array_with_data(instance, data, store.as_context_mut())?;
+        let data_ptr = buffer.write(instance, data, store.as_context_mut())?;
         let status_ptr = allocate_status_ptr(instance, store.as_context_mut())?;
         set_input_model_data.call(
             store.as_context_mut(),
@@ -119,7 +120,6 @@ fn inner_set_data_internal(
                 status_ptr,
             ),
         )?;
-        release_byte_array(instance, data_ptr, store.as_context_mut())?;
         release_status_ptr(instance, status_ptr, store.as_context_mut())?;
     } else {
         notify_export_function_error(name);
@@ -127,6 +127,55 @@ fn inner_set_data_internal(
     Ok(())
 }
 
+/// Guest memory kept by each plugin to pass input data without allocating it on every call.
+#[derive(Debug, Default)]
+pub(crate) struct GuestBuffer {
+    ptr: ByteArray,
+    capacity: u32,
+}
+
+impl GuestBuffer {
+    pub(crate) fn write(
+        &mut self,
+        instance: &Instance,
+        data: &[u8],
+        mut store: impl AsContextMut,
+    ) -> Result<ByteArray> {
+        let data_size = u32::try_from(data.len())
+            .map_err(|_| anyhow::anyhow!("Input data is too large: {} bytes", data.len()))?;
+        if self.ptr == 0 || self.capacity < data_size {
+            self.release(instance, store.as_context_mut())?;
+            let capacity = data_size
+                .checked_next_power_of_two()
+                .ok_or(anyhow::anyhow!(
+                    "Cannot allocate guest buffer: {} bytes",
+                    data_size
+                ))?;
+            self.ptr = allocate_byte_array(instance, capacity, store.as_context_mut())?;
+            self.capacity = capacity;
+        }
+        // copies the data from the caller into the guest memory directly
+        inner_memory(instance, store.as_context_mut())?.write(
+            store.as_context_mut(),
+            self.ptr as usize,
+            data,
+        )?;
+        Ok(self.ptr)
+    }
+    pub(crate) fn release(
+        &mut self,
+        instance: &Instance,
+        mut store: impl AsContextMut,
+    ) -> Result<()> {
+        if self.ptr != 0 {
+            release_byte_array(instance, self.ptr, store.as_context_mut())?;
+            self.ptr = 0;
+            self.capacity = 0;
+        }
+        Ok(())
+    }
+}
+
 pub(crate) fn initialize_env_logger() {
     tracing_subscriber::fmt::try_init().unwrap_or_default();
 }
@@ -379,13 +428,14 @@ pub(crate) fn inner_set_data<T>(
     opaque: &Option<OpaquePtr>,
     data: &[T],
     name: &str,
+    buffer: &mut GuestBuffer,
     store: &mut Store,
 ) -> Result<()> {
     if let Some(opaque) = opaque {
         let component_size = size_of::<T>();
         let len = std::mem::size_of_val(data);
         let data = unsafe { slice::from_raw_parts(data.as_ptr() as *const u8, len) };
-        inner_set_data_internal(instance, opaque, data, component_size, name, store)?;
+        inner_set_data_internal(instance, opaque, data, component_size, name, buffer, store)?;
         tracing::debug!(name = name, opaque = ?opaque, size = len, "Called setting data");
     }
     Ok(())
@@ -593,4 +643,5 @@ pub(crate) fn inner_set_ui_component_layout(
 }
 
 mod model;
+mod module_cache;
 mod motion;
@@ -4,16 +4,23 @@
   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
 */
 
-use std::{ffi::CString, path::Path, sync::Arc};
+use std::{
+    ffi::CString,
+    path::{Path, PathBuf},
+    sync::Arc,
+};
 
 use anyhow::Result;
 use notify::Watcher;
 use parking_lot::Mutex;
 use walkdir::WalkDir;
 use wasi_common::sync::WasiCtxBuilder;
-use wasmtime::{Engine, Linker};
+use wasmtime::Engine;
 
-use crate::Store;
+use crate::{
+    module_cache::{self, ModuleCache},
+    Store,
+};
 
 use super::plugin::ModelIOPlugin;
 
@@ -22,6 +29,7 @@ pub struct ModelIOPluginController {
     function_indices: Vec<(usize, i32, CString)>,
     _watcher: notify::RecommendedWatcher,
     plugin_index: Option<usize>,
+    output_data: Option<Vec<u8>>,
     failure_reason: Option<String>,
     recovery_suggestion: Option<String>,
 }
@@ -37,20 +45,31 @@ impl ModelIOPluginController {
             function_indices,
             _watcher: watcher,
             plugin_index: None,
+            output_data: None,
             failure_reason: None,
             recovery_suggestion: None,
         }
     }
     pub fn from_path<F>(path: &Path, callback: F) -> Result<Self>
+    where
+        F: Fn(&mut WasiCtxBuilder) + Copy + std::marker::Sync + std::marker::Send + 'static,
+    {
+        Self::from_path_with_cache_directory(path, module_cache::user_cache_directory(), callback)
+    }
+    pub(crate) fn from_path_with_cache_directory<F>(
+        path: &Path,
+        cache_directory: Option<PathBuf>,
+        callback: F,
+    ) -> Result<Self>
     where
         F: Fn(&mut WasiCtxBuilder) + Copy + std::marker::Sync + std::marker::Send + 'static,
     {
         let engine = Engine::default();
+        let directory = path.parent().unwrap();
+        let cache = Arc::new(ModuleCache::new(&engine, cache_directory)?);
+        let cache_inner = Arc::clone(&cache);
         let plugins = Arc::new(Mutex::new(vec![]));
         let plugins_inner = Arc::clone(&plugins);
-        let mut linker = Linker::new(&engine);
-        let linker_inner = linker.clone();
-        wasi_common::sync::add_to_linker(&mut linker, |ctx| ctx)?;
         let event_handler = move |res: notify::Result<notify::Event>| match res {
             Ok(ev) => {
                 let create_plugin = |path: &Path| -> Result<ModelIOPlugin> {
@@ -58,8 +77,9 @@ impl ModelIOPluginController {
                     let mut builder = WasiCtxBuilder::new();
                     callback(&mut builder);
                     let data = builder.build();
-                    let store = Store::new(linker_inner.engine(), data);
-                    let mut plugin = ModelIOPlugin::new(&linker_inner, path, &bytes, store)?;
+                    let store = Store::new(cache_inner.engine(), data);
+                    let instance_pre = cache_inner.instantiate_pre(path, &bytes)?;
+                    let mut plugin = ModelIOPlugin::from_instance_pre(&instance_pre, path, store)?;
                     plugin.initialize()?;
                     plugin.create()?;
                     Ok(plugin)
@@ -129,6 +149,7 @@ impl ModelIOPluginController {
                             .collect::<Vec<_>>();
                         for index in indices {
                             let mut plugin = guard.remove(index);
+                            cache_inner.remove(plugin.path());
                             tracing::info!(
                                 path = %plugin.path().display(),
                                 "WASM model I/O is removed",
@@ -143,7 +164,7 @@ impl ModelIOPluginController {
             Err(e) => tracing::warn!(error = ?e, "Catched an watch error"),
         };
         let mut watcher = notify::recommended_watcher(event_handler)?;
-        for entry in WalkDir::new(path.parent().unwrap()) {
+        for entry in WalkDir::new(directory) {
             let entry = entry?;
             let filename = entry.file_name().to_str();
             if filename.map(|s| s.ends_with(".wasm")).unwrap_or(false) {
@@ -151,9 +172,13 @@ impl ModelIOPluginController {
                 let mut builder = WasiCtxBuilder::new();
                 callback(&mut builder);
                 let data = builder.build();
-                let store = Store::new(linker.engine(), data);
+                let store = Store::new(&engine, data);
                 let path = entry.path();
-                match ModelIOPlugin::new(&linker, path, &bytes, store) {
+                match cache
+                    .instantiate_pre(path, &bytes)
+                    .and_then(|instance_pre| {
+                        ModelIOPlugin::from_instance_pre(&instance_pre, path, store)
+                    }) {
                     Ok(plugin) => {
                         watcher.watch(path, notify::RecursiveMode::NonRecursive)?;
                         plugins.lock().push(plugin);
@@ -238,6 +263,7 @@ impl ModelIOPluginController {
             self.function_indices.get(index as usize).cloned()
         {
             let result = self.plugins.lock()[plugin_index].set_function(function_index);
+            self.output_data = None;
             match result {
                 Ok(0) => {
                     self.plugin_index = Some(plugin_index);
@@ -291,6 +317,7 @@ impl ModelIOPluginController {
     }
     pub fn execute(&mut self) -> Result<()> {
         let mut result = Ok(0);
+        self.output_data = None;
         self.current_plugin(|plugin| {
             result = plugin.execute();
             Ok(())
@@ -302,12 +329,19 @@ impl ModelIOPluginController {
         }
     }
     pub fn get_output_data(&mut self) -> Result<Vec<u8>> {
-        let mut bytes = vec![];
-        self.current_plugin(|plugin| {
-            bytes = plugin.get_output_data()?;
-            Ok(())
-        })?;
-        Ok(bytes)
+        Ok(self.output_data()?.to_vec())
+    }
+    pub fn output_data(&mut self) -> Result<&[u8]> {
+        // the output is retrieved only once since both its size and its body are queried
+        if self.output_data.is_none() {
+            let mut bytes = vec![];
+            self.current_plugin(|plugin| {
+                bytes = plugin.get_output_data()?;
+                Ok(())
+            })?;
+            self.output_data = Some(bytes);
+        }
+        Ok(self.output_data.as_deref().unwrap_or_default())
     }
     pub fn load_ui_window_layout(&mut self) -> Result<()> {
         let mut result = Ok(0);
@@ -120,8 +120,8 @@ impl nanoem_application_plugin_model_io_t {
     pub fn execute(&mut self) -> Result<()> {
         self.controller.execute()
     }
-    pub fn output_slice(&mut self) -> Vec<u8> {
-        self.controller.get_output_data().unwrap_or_default()
+    pub fn output_slice(&mut self) -> &[u8] {
+        self.controller.output_data().unwrap_or_default()
     }
     pub fn load_window_layout(&mut self) -> Result<()> {
         self.controller.load_ui_window_layout()
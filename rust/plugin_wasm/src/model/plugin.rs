@@ -8,14 +8,14 @@ use std::path::{Path, PathBuf};
 
 use anyhow::Result;
 use wasi_common::WasiCtx;
-use wasmtime::{AsContextMut, Instance, Linker, Module};
+use wasmtime::{AsContextMut, Instance, InstancePre, Linker, Module};
 
 use crate::{
     inner_count_all_functions, inner_create_opaque, inner_destroy_opaque, inner_execute,
     inner_get_data, inner_get_function_name, inner_get_string, inner_initialize_function,
     inner_load_ui_window, inner_set_data, inner_set_function, inner_set_language,
-    inner_set_ui_component_layout, inner_terminate_function, ByteArray, OpaquePtr, SizePtr,
-    StatusPtr, Store, FREE_FN, MALLOC_FN,
+    inner_set_ui_component_layout, inner_terminate_function, ByteArray, GuestBuffer, OpaquePtr,
+    SizePtr, StatusPtr, Store, FREE_FN, MALLOC_FN,
 };
 
 fn validate_plugin(instance: &Instance, mut store: impl AsContextMut) -> Result<()> {
@@ -84,17 +84,20 @@ pub struct ModelIOPlugin {
     store: Store,
     path: PathBuf,
     opaque: Option<OpaquePtr>,
+    input_buffer: GuestBuffer,
 }
 
 impl ModelIOPlugin {
-    pub fn new(
-        linker: &Linker<WasiCtx>,
+    pub fn new(linker: &Linker<WasiCtx>, path: &Path, bytes: &[u8], store: Store) -> Result<Self> {
+        let module = Module::new(linker.engine(), bytes)?;
+        Self::from_instance_pre(&linker.instantiate_pre(&module)?, path, store)
+    }
+    pub fn from_instance_pre(
+        instance_pre: &InstancePre<WasiCtx>,
         path: &Path,
-        bytes: &[u8],
         mut store: Store,
     ) -> Result<Self> {
-        let module = Module::new(linker.engine(), bytes)?;
-        let instance = linker.instantiate(store.as_context_mut(), &module)?;
+        let instance = instance_pre.instantiate(store.as_context_mut())?;
         validate_plugin(&instance, store.as_context_mut())?;
         let path = path.to_path_buf();
         Ok(Self {
@@ -102,6 +105,7 @@ impl ModelIOPlugin {
             store,
             path,
             opaque: None,
+            input_buffer: GuestBuffer::default(),
         })
     }
     pub fn initialize(&mut self) -> Result<()> {
@@ -185,6 +189,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetAllSelectedVertexObjectIndices",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -194,6 +199,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetAllSelectedMaterialObjectIndices",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -203,6 +209,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetAllSelectedBoneObjectIndices",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -212,6 +219,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetAllSelectedMorphObjectIndices",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -221,6 +229,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetAllSelectedLabelObjectIndices",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -230,6 +239,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetAllSelectedRigidBodyObjectIndices",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -239,6 +249,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetAllSelectedJointObjectIndices",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -248,6 +259,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetAllSelectedSoftBodyObjectIndices",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -257,6 +269,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetAudioDescription",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -266,6 +279,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetCameraDescription",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -275,6 +289,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetLightDescription",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -284,6 +299,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetInputAudioData",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -293,6 +309,7 @@ impl ModelIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginModelIOSetInputModelData",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -363,6 +380,9 @@ impl ModelIOPlugin {
         )
     }
     pub fn destroy(&mut self) {
+        self.input_buffer
+            .release(&self.instance, &mut self.store)
+            .unwrap_or_default();
         inner_destroy_opaque(
             &self.instance,
             &self.opaque,
@@ -0,0 +1,151 @@
+/*
+  Copyright (c) 2015-2023 hkrn All rights reserved
+
+  This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+*/
+
+//! Timings of loading and executing WASM plugins with the prebuilt test plugins only.
+//!
+//! These are ignored by default and run with
+//! `cargo test --profile release-lto --package plugin_wasm bench_ -- --ignored --nocapture`
+
+use std::{
+    path::Path,
+    sync::Arc,
+    time::{Duration, Instant},
+};
+
+use anyhow::Result;
+use parking_lot::Mutex;
+use wasi_common::sync::WasiCtxBuilder;
+use wasmtime::{Engine, Linker};
+
+use crate::{
+    model::{controller::ModelIOPluginController, plugin::ModelIOPlugin},
+    module_cache::{ModuleCache, MODULE_CACHE_DIRECTORY_NAME},
+    Store,
+};
+
+use super::{
+    cache::{create_cache_directory, plugin_path},
+    create_random_data,
+};
+
+const NUM_PLUGINS: usize = 16;
+const NUM_STARTUP_ITERATIONS: u32 = 5;
+const NUM_EXECUTE_ITERATIONS: u32 = 100;
+
+fn report(name: &str, elapsed: Duration, iterations: u32) {
+    println!(
+        "{name}: {:?}/iter ({iterations} iterations)",
+        elapsed / iterations
+    );
+}
+
+fn measure_startup(path: &Path, cache_directory: &Path) -> Result<Duration> {
+    let start = Instant::now();
+    let mut controller = ModelIOPluginController::from_path_with_cache_directory(
+        path,
+        Some(cache_directory.to_path_buf()),
+        |_builder| (),
+    )?;
+    controller.initialize()?;
+    controller.create()?;
+    let elapsed = start.elapsed();
+    assert_eq!(NUM_PLUGINS as i32 * 2, controller.count_all_functions());
+    controller.destroy();
+    controller.terminate();
+    Ok(elapsed)
+}
+
+#[test]
+#[ignore]
+fn bench_startup() -> Result<()> {
+    let directory = create_cache_directory("plugin_wasm_bench_startup")?;
+    let bytes = std::fs::read(plugin_path("plugin_wasm_test_model_minimum")?)?;
+    for i in 0..NUM_PLUGINS {
+        std::fs::write(directory.join(format!("plugin{i}.wasm")), &bytes)?;
+    }
+    let engine = Engine::default();
+    let mut linker = Linker::new(&engine);
+    wasi_common::sync::add_to_linker(&mut linker, |ctx| ctx)?;
+    let mut elapsed = Duration::ZERO;
+    for _ in 0..NUM_STARTUP_ITERATIONS {
+        let start = Instant::now();
+        for i in 0..NUM_PLUGINS {
+            let path = directory.join(format!("plugin{i}.wasm"));
+            let store = Store::new(&engine, WasiCtxBuilder::new().build());
+            let mut plugin = ModelIOPlugin::new(&linker, &path, &bytes, store)?;
+            plugin.initialize()?;
+            plugin.create()?;
+            plugin.destroy();
+            plugin.terminate();
+        }
+        elapsed += start.elapsed();
+    }
+    report(
+        "startup (compile every plugin)",
+        elapsed,
+        NUM_STARTUP_ITERATIONS,
+    );
+    let path = directory.join("plugin_wasm");
+    let cache_directory = directory.join(MODULE_CACHE_DIRECTORY_NAME);
+    let mut elapsed = Duration::ZERO;
+    for _ in 0..NUM_STARTUP_ITERATIONS {
+        if cache_directory.exists() {
+            std::fs::remove_dir_all(&cache_directory)?;
+        }
+        elapsed += measure_startup(&path, &cache_directory)?;
+    }
+    report(
+        "startup (cold module cache)",
+        elapsed,
+        NUM_STARTUP_ITERATIONS,
+    );
+    let mut elapsed = Duration::ZERO;
+    for _ in 0..NUM_STARTUP_ITERATIONS {
+        elapsed += measure_startup(&path, &cache_directory)?;
+    }
+    report(
+        "startup (warm module cache)",
+        elapsed,
+        NUM_STARTUP_ITERATIONS,
+    );
+    std::fs::remove_dir_all(&directory)?;
+    Ok(())
+}
+
+#[test]
+#[ignore]
+fn bench_execute() -> Result<()> {
+    let path = plugin_path("plugin_wasm_test_model_minimum")?;
+    let bytes = std::fs::read(&path)?;
+    let cache = ModuleCache::new(&Engine::default(), None)?;
+    let store = Store::new(cache.engine(), WasiCtxBuilder::new().build());
+    let instance_pre = cache.instantiate_pre(&path, &bytes)?;
+    let plugin = ModelIOPlugin::from_instance_pre(&instance_pre, &path, store)?;
+    let watcher = notify::recommended_watcher(|_res| {})?;
+    let mut controller = ModelIOPluginController::new(Arc::new(Mutex::new(vec![plugin])), watcher);
+    controller.initialize()?;
+    controller.create()?;
+    for size in [4096, 65536] {
+        let data = create_random_data(size);
+        let start = Instant::now();
+        for _ in 0..NUM_EXECUTE_ITERATIONS {
+            controller.set_function(0)?;
+            controller.set_input_model_data(&data)?;
+            controller.execute()?;
+            // both size and body are retrieved as the plugin loader does
+            let length = controller.output_data()?.len();
+            assert_eq!(length, controller.output_data()?.len());
+        }
+        report(
+            &format!("execute ({size} bytes)"),
+            start.elapsed(),
+            NUM_EXECUTE_ITERATIONS,
+        );
+    }
+    controller.destroy();
+    controller.terminate();
+    Ok(())
+}
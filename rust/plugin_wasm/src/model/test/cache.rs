@@ -0,0 +1,182 @@
+/*
+  Copyright (c) 2015-2023 hkrn All rights reserved
+
+  This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+*/
+
+use std::{
+    env::current_dir,
+    path::{Path, PathBuf},
+};
+
+use anyhow::Result;
+use pretty_assertions::assert_eq;
+use wasi_common::sync::WasiCtxBuilder;
+use wasmtime::Engine;
+
+use crate::{
+    model::plugin::ModelIOPlugin,
+    module_cache::{ModuleCache, ModuleCacheStatistics},
+    Store,
+};
+
+use super::build_type_and_flags;
+
+pub(super) fn plugin_path(package: &str) -> Result<PathBuf> {
+    let (ty, _) = build_type_and_flags();
+    Ok(current_dir()?
+        .parent()
+        .unwrap()
+        .join(format!("target/wasm32-wasip1/{ty}/{package}.wasm")))
+}
+
+pub(super) fn create_cache_directory(name: &str) -> Result<PathBuf> {
+    let directory = std::env::temp_dir().join(format!("{name}_{}", std::process::id()));
+    if directory.exists() {
+        std::fs::remove_dir_all(&directory)?;
+    }
+    std::fs::create_dir_all(&directory)?;
+    Ok(directory)
+}
+
+fn create_plugin(cache: &ModuleCache, path: &Path, bytes: &[u8]) -> Result<ModelIOPlugin> {
+    let store = Store::new(cache.engine(), WasiCtxBuilder::new().build());
+    let instance_pre = cache.instantiate_pre(path, bytes)?;
+    let mut plugin = ModelIOPlugin::from_instance_pre(&instance_pre, path, store)?;
+    plugin.initialize()?;
+    plugin.create()?;
+    Ok(plugin)
+}
+
+#[test]
+fn module_cache() -> Result<()> {
+    let path = plugin_path("plugin_wasm_test_model_minimum")?;
+    let bytes = std::fs::read(&path)?;
+    let directory = create_cache_directory("plugin_wasm_module_cache")?;
+    let engine = Engine::default();
+    {
+        let cache = ModuleCache::new(&engine, Some(directory.clone()))?;
+        let mut plugin = create_plugin(&cache, &path, &bytes)?;
+        assert_eq!("plugin_wasm_test_model_minimum", plugin.name()?);
+        plugin.destroy();
+        plugin.terminate();
+        let mut plugin = create_plugin(&cache, &path, &bytes)?;
+        plugin.destroy();
+        plugin.terminate();
+        assert_eq!(
+            ModuleCacheStatistics {
+                num_memory_hits: 1,
+                num_disk_hits: 0,
+                num_compiles: 1,
+            },
+            cache.statistics()
+        );
+    }
+    {
+        // the precompiled module is loaded from the disk instead of compiling it again
+        let cache = ModuleCache::new(&engine, Some(directory.clone()))?;
+        let mut plugin = create_plugin(&cache, &path, &bytes)?;
+        assert_eq!("plugin_wasm_test_model_minimum", plugin.name()?);
+        plugin.destroy();
+        plugin.terminate();
+        assert_eq!(
+            ModuleCacheStatistics {
+                num_memory_hits: 0,
+                num_disk_hits: 1,
+                num_compiles: 0,
+            },
+            cache.statistics()
+        );
+    }
+    std::fs::remove_dir_all(&directory)?;
+    Ok(())
+}
+
+fn list_all_module_files(directory: &Path) -> Result<Vec<PathBuf>> {
+    let mut files = vec![];
+    for entry in std::fs::read_dir(directory)? {
+        let path = entry?.path();
+        if path.extension().and_then(|s| s.to_str()) == Some("cwasm") {
+            files.push(path);
+        }
+    }
+    Ok(files)
+}
+
+#[test]
+fn module_cache_corrupted() -> Result<()> {
+    let path = plugin_path("plugin_wasm_test_model_minimum")?;
+    let bytes = std::fs::read(&path)?;
+    let directory = create_cache_directory("plugin_wasm_module_cache_corrupted")?;
+    let engine = Engine::default();
+    ModuleCache::new(&engine, Some(directory.clone()))?.instantiate_pre(&path, &bytes)?;
+    let files = list_all_module_files(&directory)?;
+    assert_eq!(1, files.len());
+    let mut content = std::fs::read(&files[0])?;
+    let last = content.len() - 1;
+    content[last] ^= 0xff;
+    std::fs::write(&files[0], &content)?;
+    // the digest mismatches so the module is compiled again instead of being deserialized
+    let cache = ModuleCache::new(&engine, Some(directory.clone()))?;
+    let mut plugin = create_plugin(&cache, &path, &bytes)?;
+    assert_eq!("plugin_wasm_test_model_minimum", plugin.name()?);
+    plugin.destroy();
+    plugin.terminate();
+    assert_eq!(
+        ModuleCacheStatistics {
+            num_memory_hits: 0,
+            num_disk_hits: 0,
+            num_compiles: 1,
+        },
+        cache.statistics()
+    );
+    std::fs::remove_dir_all(&directory)?;
+    Ok(())
+}
+
+#[test]
+fn module_cache_pruned() -> Result<()> {
+    let path = plugin_path("plugin_wasm_test_model_minimum")?;
+    let other_path = plugin_path("plugin_wasm_test_model_full")?;
+    let bytes = std::fs::read(&path)?;
+    let other_bytes = std::fs::read(&other_path)?;
+    let directory = create_cache_directory("plugin_wasm_module_cache_pruned")?;
+    let stale_path = directory.join("0000000000000000-0000-0000.cwasm");
+    std::fs::write(&stale_path, b"stale")?;
+    let cache = ModuleCache::new(&Engine::default(), Some(directory.clone()))?;
+    cache.instantiate_pre(&path, &bytes)?;
+    cache.instantiate_pre(&other_path, &other_bytes)?;
+    // modules precompiled by another engine configuration are removed
+    assert!(!stale_path.exists());
+    assert_eq!(2, list_all_module_files(&directory)?.len());
+    // only the latest content of the same plugin is kept
+    cache.instantiate_pre(&path, &other_bytes)?;
+    assert_eq!(2, list_all_module_files(&directory)?.len());
+    std::fs::remove_dir_all(&directory)?;
+    Ok(())
+}
+
+#[test]
+fn module_cache_modified() -> Result<()> {
+    let path = plugin_path("plugin_wasm_test_model_minimum")?;
+    let other_bytes = std::fs::read(plugin_path("plugin_wasm_test_model_full")?)?;
+    let bytes = std::fs::read(&path)?;
+    let cache = ModuleCache::new(&Engine::default(), None)?;
+    create_plugin(&cache, &path, &bytes)?.terminate();
+    // the same path with different content must not reuse the previous module
+    let mut plugin = create_plugin(&cache, &path, &other_bytes)?;
+    assert_eq!("plugin_wasm_test_model_full", plugin.name()?);
+    plugin.destroy();
+    plugin.terminate();
+    cache.remove(&path);
+    create_plugin(&cache, &path, &bytes)?.terminate();
+    assert_eq!(
+        ModuleCacheStatistics {
+            num_memory_hits: 0,
+            num_disk_hits: 0,
+            num_compiles: 3,
+        },
+        cache.statistics()
+    );
+    Ok(())
+}
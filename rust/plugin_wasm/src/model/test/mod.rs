@@ -170,5 +170,7 @@ fn from_path() -> Result<()> {
     Ok(())
 }
 
+mod bench;
+mod cache;
 mod full;
 mod minimum;
@@ -0,0 +1,291 @@
+/*
+  Copyright (c) 2015-2023 hkrn All rights reserved
+
+  This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+*/
+
+use std::{
+    collections::HashMap,
+    hash::{Hash, Hasher},
+    path::{Path, PathBuf},
+};
+
+use anyhow::Result;
+use parking_lot::Mutex;
+use sha2::{Digest, Sha256};
+use wasi_common::WasiCtx;
+use wasmtime::{Engine, InstancePre, Linker, Module};
+
+pub(crate) const MODULE_CACHE_DIRECTORY_NAME: &str = "plugin_wasm";
+
+const APPLICATION_CACHE_DIRECTORY_NAME: &str = "nanoem";
+const MODULE_FILE_EXTENSION: &str = "cwasm";
+const PATH_PREFIX_LENGTH: usize = 8;
+
+type Sha256Digest = [u8; 32];
+
+#[derive(Copy, Clone, Debug, Default, Eq, PartialEq)]
+pub(crate) struct ModuleCacheStatistics {
+    pub num_memory_hits: u32,
+    pub num_disk_hits: u32,
+    pub num_compiles: u32,
+}
+
+struct Entry {
+    module_digest: Sha256Digest,
+    instance_pre: InstancePre<WasiCtx>,
+}
+
+/// Feeds every value passed to `Hash::hash` into SHA-256 so the result does not depend on
+/// `DefaultHasher`, whose algorithm may change between Rust releases.
+struct Sha256Hasher(Sha256);
+
+impl Hasher for Sha256Hasher {
+    fn finish(&self) -> u64 {
+        let digest = self.0.clone().finalize();
+        u64::from_le_bytes(digest[..8].try_into().unwrap())
+    }
+    fn write(&mut self, bytes: &[u8]) {
+        self.0.update(bytes);
+    }
+}
+
+/// Returns the directory to save precompiled modules of the current user.
+///
+/// Precompiled modules are deserialized without validation, so they must not be placed next to
+/// plugins where other users may be able to write them.
+pub(crate) fn user_cache_directory() -> Option<PathBuf> {
+    let home_directory = || std::env::var_os("HOME").map(PathBuf::from);
+    let directory = if cfg!(target_os = "windows") {
+        std::env::var_os("LOCALAPPDATA").map(PathBuf::from)
+    } else if cfg!(target_os = "macos") {
+        home_directory().map(|path| path.join("Library").join("Caches"))
+    } else {
+        std::env::var_os("XDG_CACHE_HOME")
+            .map(PathBuf::from)
+            .filter(|path| path.is_absolute())
+            .or_else(|| home_directory().map(|path| path.join(".cache")))
+    };
+    directory.filter(|path| path.is_absolute()).map(|path| {
+        path.join(APPLICATION_CACHE_DIRECTORY_NAME)
+            .join(MODULE_CACHE_DIRECTORY_NAME)
+    })
+}
+
+fn to_hex_string(bytes: &[u8]) -> String {
+    bytes.iter().map(|byte| format!("{byte:02x}")).collect()
+}
+
+/// Keeps compiled WASM plugins both in memory and on disk.
+///
+/// Each module is keyed by the SHA-256 digest of its bytes and the compatibility hash of the engine
+/// so a precompiled module is never loaded by an engine configured differently. A precompiled
+/// module file starts with the digest of the key and its content, which is verified before the
+/// module is deserialized. Modules are kept in memory as `InstancePre` so reloading or recreating
+/// a plugin instantiates it without compiling and resolving its imports again.
+///
+/// Instances themselves are not pooled: each plugin still creates its own `Store` and `Instance`
+/// and keeps them until it is terminated.
+pub(crate) struct ModuleCache {
+    linker: Linker<WasiCtx>,
+    directory: Option<PathBuf>,
+    engine_digest: Sha256Digest,
+    entries: Mutex<HashMap<PathBuf, Entry>>,
+    statistics: Mutex<ModuleCacheStatistics>,
+}
+
+impl ModuleCache {
+    pub fn new(engine: &Engine, directory: Option<PathBuf>) -> Result<Self> {
+        let mut linker = Linker::new(engine);
+        wasi_common::sync::add_to_linker(&mut linker, |ctx| ctx)?;
+        let mut hasher = Sha256Hasher(Sha256::new());
+        engine.precompile_compatibility_hash().hash(&mut hasher);
+        Ok(Self {
+            linker,
+            directory,
+            engine_digest: hasher.0.finalize().into(),
+            entries: Mutex::new(HashMap::new()),
+            statistics: Mutex::new(ModuleCacheStatistics::default()),
+        })
+    }
+    pub fn engine(&self) -> &Engine {
+        self.linker.engine()
+    }
+    pub fn instantiate_pre(&self, path: &Path, bytes: &[u8]) -> Result<InstancePre<WasiCtx>> {
+        let module_digest: Sha256Digest = Sha256::digest(bytes).into();
+        if let Some(entry) = self.entries.lock().get(path) {
+            if entry.module_digest == module_digest {
+                self.statistics.lock().num_memory_hits += 1;
+                return Ok(entry.instance_pre.clone());
+            }
+        }
+        let module = self.load_module(path, &module_digest, bytes)?;
+        let instance_pre = self.linker.instantiate_pre(&module)?;
+        self.entries.lock().insert(
+            path.to_path_buf(),
+            Entry {
+                module_digest,
+                instance_pre: instance_pre.clone(),
+            },
+        );
+        Ok(instance_pre)
+    }
+    pub fn remove(&self, path: &Path) {
+        self.entries.lock().remove(path);
+    }
+    pub fn statistics(&self) -> ModuleCacheStatistics {
+        *self.statistics.lock()
+    }
+    fn load_module(
+        &self,
+        path: &Path,
+        module_digest: &Sha256Digest,
+        bytes: &[u8],
+    ) -> Result<Module> {
+        let engine = self.linker.engine();
+        if let Some(directory) = &self.directory {
+            let path_prefix = to_hex_string(
+                &Sha256::digest(path.as_os_str().as_encoded_bytes())[..PATH_PREFIX_LENGTH],
+            );
+            let filename = format!(
+                "{path_prefix}-{}-{}.{MODULE_FILE_EXTENSION}",
+                to_hex_string(module_digest),
+                to_hex_string(&self.engine_digest)
+            );
+            let module_path = directory.join(&filename);
+            match std::fs::read(&module_path) {
+                Ok(content) => match self.verify_content(module_digest, &content) {
+                    Some(serialized) => {
+                        // SAFETY: the digest proves that the content is produced by
+                        // precompile_module for the same module and the same engine configuration
+                        match unsafe { Module::deserialize(engine, serialized) } {
+                            Ok(module) => {
+                                self.statistics.lock().num_disk_hits += 1;
+                                return Ok(module);
+                            }
+                            Err(err) => tracing::warn!(
+                                path = ?module_path,
+                                error = %err,
+                                "Cannot load precompiled WASM module"
+                            ),
+                        }
+                    }
+                    None => tracing::warn!(
+                        path = ?module_path,
+                        "Precompiled WASM module is corrupted and compiled again"
+                    ),
+                },
+                Err(err) if err.kind() == std::io::ErrorKind::NotFound => {}
+                Err(err) => tracing::warn!(
+                    path = ?module_path,
+                    error = %err,
+                    "Cannot read precompiled WASM module"
+                ),
+            }
+            let serialized = engine.precompile_module(bytes)?;
+            self.statistics.lock().num_compiles += 1;
+            let content_digest = self.content_digest(module_digest, &serialized);
+            match Self::write_atomically(directory, &module_path, &content_digest, &serialized) {
+                Ok(()) => self.prune_outdated_modules(directory, &path_prefix, &filename),
+                Err(err) => tracing::debug!(
+                    path = ?module_path,
+                    error = %err,
+                    "Cannot save precompiled WASM module"
+                ),
+            }
+            // SAFETY: serialized is just produced by the same engine above
+            unsafe { Module::deserialize(engine, &serialized) }
+        } else {
+            self.statistics.lock().num_compiles += 1;
+            Module::new(engine, bytes)
+        }
+    }
+    fn content_digest(&self, module_digest: &Sha256Digest, serialized: &[u8]) -> Sha256Digest {
+        let mut hasher = Sha256::new();
+        hasher.update(module_digest);
+        hasher.update(self.engine_digest);
+        hasher.update(serialized);
+        hasher.finalize().into()
+    }
+    fn verify_content<'a>(
+        &self,
+        module_digest: &Sha256Digest,
+        content: &'a [u8],
+    ) -> Option<&'a [u8]> {
+        if content.len() < std::mem::size_of::<Sha256Digest>() {
+            return None;
+        }
+        let (expected, serialized) = content.split_at(std::mem::size_of::<Sha256Digest>());
+        (self.content_digest(module_digest, serialized)[..] == *expected).then_some(serialized)
+    }
+    /// Removes precompiled modules of the previous content of the same plugin and the ones
+    /// precompiled by an engine configured differently.
+    fn prune_outdated_modules(&self, directory: &Path, path_prefix: &str, filename: &str) {
+        let engine_digest = to_hex_string(&self.engine_digest);
+        let entries = match std::fs::read_dir(directory) {
+            Ok(entries) => entries,
+            Err(err) => {
+                tracing::debug!(
+                    path = ?directory,
+                    error = %err,
+                    "Cannot list precompiled WASM modules"
+                );
+                return;
+            }
+        };
+        for entry in entries.flatten() {
+            let path = entry.path();
+            if path.extension().and_then(|s| s.to_str()) != Some(MODULE_FILE_EXTENSION) {
+                continue;
+            }
+            let name = entry.file_name();
+            let name = name.to_string_lossy();
+            let components = path
+                .file_stem()
+                .map(|s| {
+                    s.to_string_lossy()
+                        .split('-')
+                        .map(str::to_owned)
+                        .collect::<Vec<_>>()
+                })
+                .unwrap_or_default();
+            let outdated = match components.as_slice() {
+                [prefix, _, engine] => {
+                    *engine != engine_digest || (prefix == path_prefix && name != filename)
+                }
+                _ => true,
+            };
+            if outdated {
+                if let Err(err) = std::fs::remove_file(&path) {
+                    tracing::debug!(
+                        path = ?path,
+                        error = %err,
+                        "Cannot remove outdated WASM module"
+                    );
+                }
+            }
+        }
+    }
+    fn write_atomically(
+        directory: &Path,
+        path: &Path,
+        content_digest: &Sha256Digest,
+        serialized: &[u8],
+    ) -> Result<()> {
+        let mut builder = std::fs::DirBuilder::new();
+        builder.recursive(true);
+        #[cfg(unix)]
+        std::os::unix::fs::DirBuilderExt::mode(&mut builder, 0o700);
+        builder.create(directory)?;
+        let temp_path = path.with_extension(format!("{}.tmp", std::process::id()));
+        let mut content = Vec::with_capacity(content_digest.len() + serialized.len());
+        content.extend_from_slice(content_digest);
+        content.extend_from_slice(serialized);
+        std::fs::write(&temp_path, content)?;
+        if let Err(err) = std::fs::rename(&temp_path, path) {
+            std::fs::remove_file(&temp_path).unwrap_or_default();
+            return Err(err.into());
+        }
+        Ok(())
+    }
+}
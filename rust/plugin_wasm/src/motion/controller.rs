@@ -11,9 +11,12 @@ use notify::Watcher;
 use parking_lot::Mutex;
 use walkdir::WalkDir;
 use wasi_common::sync::WasiCtxBuilder;
-use wasmtime::{Engine, Linker};
+use wasmtime::Engine;
 
-use crate::Store;
+use crate::{
+    module_cache::{self, ModuleCache},
+    Store,
+};
 
 use super::plugin::MotionIOPlugin;
 
@@ -22,6 +25,7 @@ pub struct MotionIOPluginController {
     function_indices: Vec<(usize, i32, CString)>,
     _watcher: notify::RecommendedWatcher,
     plugin_index: Option<usize>,
+    output_data: Option<Vec<u8>>,
     failure_reason: Option<String>,
     recovery_suggestion: Option<String>,
 }
@@ -37,6 +41,7 @@ impl MotionIOPluginController {
             function_indices,
             _watcher: watcher,
             plugin_index: None,
+            output_data: None,
             failure_reason: None,
             recovery_suggestion: None,
         }
@@ -46,11 +51,14 @@ impl MotionIOPluginController {
         F: Fn(&mut WasiCtxBuilder) + Copy + std::marker::Sync + std::marker::Send + 'static,
     {
         let engine = Engine::default();
+        let directory = path.parent().unwrap();
+        let cache = Arc::new(ModuleCache::new(
+            &engine,
+            module_cache::user_cache_directory(),
+        )?);
+        let cache_inner = Arc::clone(&cache);
         let plugins = Arc::new(Mutex::new(vec![]));
         let plugins_inner = Arc::clone(&plugins);
-        let mut linker = Linker::new(&engine);
-        let linker_inner = linker.clone();
-        wasi_common::sync::add_to_linker(&mut linker, |ctx| ctx)?;
         let event_handler = move |res: notify::Result<notify::Event>| match res {
             Ok(ev) => {
                 let create_plugin = |path: &Path| -> Result<MotionIOPlugin> {
@@ -58,8 +66,9 @@ impl MotionIOPluginController {
                     let mut builder = WasiCtxBuilder::new();
                     callback(&mut builder);
                     let data = builder.build();
-                    let store = Store::new(linker_inner.engine(), data);
-                    let mut plugin = MotionIOPlugin::new(&linker_inner, path, &bytes, store)?;
+                    let store = Store::new(cache_inner.engine(), data);
+                    let instance_pre = cache_inner.instantiate_pre(path, &bytes)?;
+                    let mut plugin = MotionIOPlugin::from_instance_pre(&instance_pre, path, store)?;
                     plugin.initialize()?;
                     plugin.create()?;
                     Ok(plugin)
@@ -129,6 +138,7 @@ impl MotionIOPluginController {
                             .collect::<Vec<_>>();
                         for index in indices {
                             let mut plugin = guard.remove(index);
+                            cache_inner.remove(plugin.path());
                             tracing::info!(
                                 path = %plugin.path().display(),
                                 "WASM motion I/O is removed",
@@ -143,7 +153,7 @@ impl MotionIOPluginController {
             Err(e) => tracing::warn!(error = ?e, "Catched an watch error"),
         };
         let mut watcher = notify::recommended_watcher(event_handler)?;
-        for entry in WalkDir::new(path.parent().unwrap()) {
+        for entry in WalkDir::new(directory) {
             let entry = entry?;
             let filename = entry.file_name().to_str();
             if filename.map(|s| s.ends_with(".wasm")).unwrap_or(false) {
@@ -152,7 +162,12 @@ impl MotionIOPluginController {
                 callback(&mut builder);
                 let data = builder.build();
                 let store = Store::new(&engine, data);
-                match MotionIOPlugin::new(&linker, path, &bytes, store) {
+                let path = entry.path();
+                match cache
+                    .instantiate_pre(path, &bytes)
+                    .and_then(|instance_pre| {
+                        MotionIOPlugin::from_instance_pre(&instance_pre, path, store)
+                    }) {
                     Ok(plugin) => {
                         watcher.watch(path, notify::RecursiveMode::NonRecursive)?;
                         plugins.lock().push(plugin);
@@ -237,6 +252,7 @@ impl MotionIOPluginController {
             self.function_indices.get(index as usize).cloned()
         {
             let result = self.plugins.lock()[plugin_index].set_function(function_index);
+            self.output_data = None;
             match result {
                 Ok(0) => {
                     self.plugin_index = Some(plugin_index);
@@ -298,6 +314,7 @@ impl MotionIOPluginController {
     }
     pub fn execute(&mut self) -> Result<()> {
         let mut result = Ok(0);
+        self.output_data = None;
         self.current_plugin(|plugin| {
             result = plugin.execute();
             Ok(())
@@ -309,12 +326,19 @@ impl MotionIOPluginController {
         }
     }
     pub fn get_output_data(&mut self) -> Result<Vec<u8>> {
-        let mut bytes = vec![];
-        self.current_plugin(|plugin| {
-            bytes = plugin.get_output_data()?;
-            Ok(())
-        })?;
-        Ok(bytes)
+        Ok(self.output_data()?.to_vec())
+    }
+    pub fn output_data(&mut self) -> Result<&[u8]> {
+        // the output is retrieved only once since both its size and its body are queried
+        if self.output_data.is_none() {
+            let mut bytes = vec![];
+            self.current_plugin(|plugin| {
+                bytes = plugin.get_output_data()?;
+                Ok(())
+            })?;
+            self.output_data = Some(bytes);
+        }
+        Ok(self.output_data.as_deref().unwrap_or_default())
     }
     pub fn load_ui_window_layout(&mut self) -> Result<()> {
         let mut result = Ok(0);
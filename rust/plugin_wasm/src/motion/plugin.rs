@@ -11,15 +11,15 @@ use std::{
 
 use anyhow::Result;
 use wasi_common::WasiCtx;
-use wasmtime::{AsContextMut, Instance, Linker, Module};
+use wasmtime::{AsContextMut, Instance, InstancePre, Linker, Module};
 
 use crate::{
     allocate_byte_array_with_data, allocate_status_ptr, inner_count_all_functions,
     inner_create_opaque, inner_destroy_opaque, inner_execute, inner_get_data,
     inner_get_function_name, inner_get_string, inner_initialize_function, inner_load_ui_window,
     inner_set_data, inner_set_function, inner_set_language, inner_set_ui_component_layout,
-    inner_terminate_function, release_byte_array, release_status_ptr, ByteArray, OpaquePtr,
-    SizePtr, StatusPtr, Store, FREE_FN, MALLOC_FN,
+    inner_terminate_function, release_byte_array, release_status_ptr, ByteArray, GuestBuffer,
+    OpaquePtr, SizePtr, StatusPtr, Store, FREE_FN, MALLOC_FN,
 };
 
 pub struct MotionIOPlugin {
@@ -27,6 +27,7 @@ pub struct MotionIOPlugin {
     store: Store,
     path: PathBuf,
     opaque: Option<OpaquePtr>,
+    input_buffer: GuestBuffer,
 }
 
 fn inner_set_named_data(
@@ -127,14 +128,16 @@ fn validate_plugin(instance: &Instance, mut store: impl AsContextMut) -> Result<
 }
 
 impl MotionIOPlugin {
-    pub fn new(
-        linker: &Linker<WasiCtx>,
+    pub fn new(linker: &Linker<WasiCtx>, path: &Path, bytes: &[u8], store: Store) -> Result<Self> {
+        let module = Module::new(linker.engine(), bytes)?;
+        Self::from_instance_pre(&linker.instantiate_pre(&module)?, path, store)
+    }
+    pub fn from_instance_pre(
+        instance_pre: &InstancePre<WasiCtx>,
         path: &Path,
-        bytes: &[u8],
         mut store: Store,
     ) -> Result<Self> {
-        let module = Module::new(linker.engine(), bytes)?;
-        let instance = linker.instantiate(store.as_context_mut(), &module)?;
+        let instance = instance_pre.instantiate(store.as_context_mut())?;
         validate_plugin(&instance, store.as_context_mut())?;
         let path = path.to_path_buf();
         Ok(Self {
@@ -142,6 +145,7 @@ impl MotionIOPlugin {
             path,
             store,
             opaque: None,
+            input_buffer: GuestBuffer::default(),
         })
     }
     pub fn initialize(&mut self) -> Result<()> {
@@ -226,6 +230,7 @@ impl MotionIOPlugin {
             &self.opaque,
             value,
             "nanoemApplicationPluginMotionIOSetAllSelectedAccessoryKeyframes",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -249,6 +254,7 @@ impl MotionIOPlugin {
             &self.opaque,
             value,
             "nanoemApplicationPluginMotionIOSetAllSelectedCameraKeyframes",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -258,6 +264,7 @@ impl MotionIOPlugin {
             &self.opaque,
             value,
             "nanoemApplicationPluginMotionIOSetAllSelectedLightKeyframes",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -267,6 +274,7 @@ impl MotionIOPlugin {
             &self.opaque,
             value,
             "nanoemApplicationPluginMotionIOSetAllSelectedModelKeyframes",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -290,6 +298,7 @@ impl MotionIOPlugin {
             &self.opaque,
             value,
             "nanoemApplicationPluginMotionIOSetAllSelectedSelfShadowKeyframes",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -299,6 +308,7 @@ impl MotionIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginMotionIOSetAudioDescription",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -308,6 +318,7 @@ impl MotionIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginMotionIOSetCameraDescription",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -317,6 +328,7 @@ impl MotionIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginMotionIOSetLightDescription",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -326,6 +338,7 @@ impl MotionIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginMotionIOSetInputAudioData",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -335,6 +348,7 @@ impl MotionIOPlugin {
             &self.opaque,
             data,
             "nanoemApplicationPluginMotionIOSetInputActiveModelData",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -344,6 +358,7 @@ impl MotionIOPlugin {
             &self.opaque,
             bytes,
             "nanoemApplicationPluginMotionIOSetInputMotionData",
+            &mut self.input_buffer,
             &mut self.store,
         )
     }
@@ -414,6 +429,9 @@ impl MotionIOPlugin {
         )
     }
     pub fn destroy(&mut self) {
+        self.input_buffer
+            .release(&self.instance, &mut self.store)
+            .unwrap_or_default();
         inner_destroy_opaque(
             &self.instance,
             &self.opaque,
@@ -62,7 +62,7 @@ struct AudioPlayer : BaseAudioPlayer {
     loadAllLinearPCMSamples(const nanoem_u8_t *data, size_t size, Error &error) NANOEM_DECL_OVERRIDE
     {
         m_loaded = true;
-        m_linearPCMSamples.assign(data, data + size);
+        assignLinearPCMSamples(data, size);
         m_currentRational.m_denominator = m_description.m_formatData.m_sampleRate;
         m_durationRational.m_numerator = size;
         m_durationRational.m_denominator = m_description.m_formatData.m_bytesPerSecond;
@@ -118,7 +118,7 @@ WASAPIAudioPlayer::loadAllLinearPCMSamples(const nanoem_u8_t *data, size_t size,
             m_durationRational.m_denominator =
                 m_nativeOutputDescription.nBlockAlign * m_nativeOutputDescription.nSamplesPerSec;
             m_running = true;
-            m_linearPCMSamples.assign(data, data + size);
+            assignLinearPCMSamples(data, size);
             m_offset = 0;
             m_numProceededPackets = 0;
             m_loaded = succeeded = true;